@@ -22,6 +22,8 @@
 #include <stdio.h>
 #include <string.h>
 #include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 
 #include "s3_memory_pool.h"
 
@@ -29,6 +31,27 @@ struct memory_pool_element {
   struct memory_pool_element *next;
 };
 
+/* Per-thread cache of free buffers, used with ENABLE_THREAD_CACHE. Only the
+   owner thread touches free_list, 'count' is also read (relaxed) by other
+   threads for pool statistics. */
+struct mempool_thread_cache {
+  struct mempool *pool;
+  struct memory_pool_element *free_list;
+  int count;
+  /* list of all caches of the pool, protected by pool lock */
+  struct mempool_thread_cache *prev;
+  struct mempool_thread_cache *next;
+};
+
+/* Large mapping carved into buffers, used with ENABLE_HUGEPAGE_ARENA. Arenas
+   are never unmapped before the pool is destroyed. */
+struct mempool_arena {
+  char *addr;    /* start of mapping */
+  size_t length; /* mapped length */
+  int node;      /* NUMA node the arena is bound to */
+  struct mempool_arena *next;
+};
+
 struct mempool {
   int flags;                 /* Buffer Bitflags */
   int free_bufs_in_pool;     /* Number of items on free list */
@@ -56,8 +79,17 @@ struct mempool {
   size_t mempool_item_size; /* Size of items managed by this pool */
   size_t expandable_size;   /* pool expansion rate when free list is empty */
   pthread_mutex_t lock;     /* lock, in case of synchronous operation */
-  struct memory_pool_element *free_list; /* list of free items available for
-                                            reuse */
+  struct memory_pool_element
+      *free_list[MEMPOOL_MAX_NUMA_NODES]; /* list of free items available for
+                                             reuse, one per NUMA node (only
+                                             free_list[0] is used unless
+                                             ENABLE_NUMA_LOCAL is set) */
+  int numa_nodes;                /* number of free lists in use */
+  size_t arena_slab_size;        /* distance between buffers in an arena */
+  struct mempool_arena *arenas;  /* ENABLE_HUGEPAGE_ARENA: all arenas */
+  pthread_key_t thread_cache_key; /* ENABLE_THREAD_CACHE: per-thread cache */
+  int thread_cache_size;          /* max buffers in a thread cache */
+  struct mempool_thread_cache *thread_caches; /* all thread caches of pool */
 };
 
 /**
@@ -87,6 +119,176 @@ static int pool_can_expand_by(struct mempool *pool) {
   return available_space / pool->mempool_item_size;
 }
 
+/**
+ * Returns number of NUMA nodes in the system (capped by
+ * MEMPOOL_MAX_NUMA_NODES), 1 if it can not be figured out.
+ */
+static int numa_nodes_count(void) {
+  FILE *fp;
+  char line[256];
+  char *token;
+  char *saveptr = NULL;
+  int first, last;
+  int max_node = 0;
+
+  fp = fopen("/sys/devices/system/node/online", "r");
+  if (fp == NULL) {
+    return 1;
+  }
+  if (fgets(line, sizeof(line), fp) == NULL) {
+    fclose(fp);
+    return 1;
+  }
+  fclose(fp);
+
+  /* Format is list of ranges, e.g. "0-1,3" */
+  for (token = strtok_r(line, ",\n", &saveptr); token != NULL;
+       token = strtok_r(NULL, ",\n", &saveptr)) {
+    if (sscanf(token, "%d-%d", &first, &last) == 2) {
+      if (last > max_node) {
+        max_node = last;
+      }
+    } else if (sscanf(token, "%d", &first) == 1 && first > max_node) {
+      max_node = first;
+    }
+  }
+  if (max_node >= MEMPOOL_MAX_NUMA_NODES) {
+    return MEMPOOL_MAX_NUMA_NODES;
+  }
+  return max_node + 1;
+}
+
+/* Returns free list index (NUMA node) of the calling thread */
+static int pool_current_node(struct mempool *pool) {
+  unsigned cpu = 0;
+  unsigned node = 0;
+
+  if (pool->numa_nodes <= 1) {
+    return 0;
+  }
+#ifdef SYS_getcpu
+  if (syscall(SYS_getcpu, &cpu, &node, NULL) != 0) {
+    return 0;
+  }
+#endif
+  return (int)(node % pool->numa_nodes);
+}
+
+/* Returns free list index (NUMA node) where given buffer belongs to */
+static int pool_item_node(struct mempool *pool, void *buf) {
+  struct mempool_arena *arena;
+
+  if (pool->numa_nodes <= 1) {
+    return 0;
+  }
+  for (arena = pool->arenas; arena != NULL; arena = arena->next) {
+    if ((char *)buf >= arena->addr &&
+        (char *)buf < arena->addr + arena->length) {
+      return arena->node;
+    }
+  }
+  return 0;
+}
+
+/**
+ * Internal function, maps one arena for at least 'items_count' buffers and
+ * puts all buffers of the arena to free list of 'node'. Tries MAP_HUGETLB
+ * (preallocated huge pages) first, then falls back to regular mapping
+ * advised for transparent huge pages. With ENABLE_NUMA_LOCAL the arena is
+ * bound (preferred policy) to the node before it is touched.
+ * returns:
+ * 0 on success, otherwise an error
+ */
+static int arena_allocate(struct mempool *pool, int items_count, int node) {
+  int i;
+  int hugetlb = 0;
+  size_t length;
+  size_t huge_length;
+  char *addr = MAP_FAILED;
+  struct mempool_arena *arena;
+  struct memory_pool_element *pool_item;
+  char *log_msg_fmt =
+      "mempool(%p): mmap arena(%p) length(%zu) items(%d) node(%d) "
+      "hugetlb(%d)";
+  char log_msg[200];
+
+  if (items_count <= 0) {
+    return 0;
+  }
+
+  /* Huge page rounded arena is carved whole and accounted to the pool, so
+     round up only when the pool may grow by the rounded size. Otherwise map
+     just the asked buffers and leave the arena to regular pages. */
+  length = (size_t)items_count * pool->arena_slab_size;
+  huge_length =
+      (length + MEMPOOL_HUGEPAGE_SIZE - 1) & ~(MEMPOOL_HUGEPAGE_SIZE - 1);
+  if (huge_length / pool->arena_slab_size <=
+      (size_t)pool_can_expand_by(pool)) {
+    length = huge_length;
+    items_count = (int)(length / pool->arena_slab_size);
+  }
+
+  arena = (struct mempool_arena *)calloc(1, sizeof(struct mempool_arena));
+  if (arena == NULL) {
+    return S3_MEMPOOL_ERROR;
+  }
+
+#ifdef MAP_HUGETLB
+  addr = (char *)mmap(NULL, length, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+  hugetlb = (addr != MAP_FAILED);
+#endif
+  if (addr == MAP_FAILED) {
+    addr = (char *)mmap(NULL, length, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (addr == MAP_FAILED) {
+      free(arena);
+      return S3_MEMPOOL_ERROR;
+    }
+#ifdef MADV_HUGEPAGE
+    madvise(addr, length, MADV_HUGEPAGE);
+#endif
+  }
+  /* exclude arena while geneating core dump*/
+  madvise(addr, length, MADV_DONTDUMP);
+
+#ifdef SYS_mbind
+  if ((pool->flags & ENABLE_NUMA_LOCAL) != 0 && pool->numa_nodes > 1) {
+    unsigned long nodemask = 1UL << node;
+    /* MPOL_PREFERRED: fall back to other nodes instead of failing */
+    syscall(SYS_mbind, addr, length, 1, &nodemask, sizeof(nodemask) * 8, 0);
+  }
+#endif
+
+  if (pool->log_callback_func) {
+    snprintf(log_msg, sizeof(log_msg), log_msg_fmt, (void *)pool,
+             (void *)addr, length, items_count, node, hugetlb);
+    pool->log_callback_func(MEMPOOL_LOG_INFO, log_msg);
+  }
+
+  arena->addr = addr;
+  arena->length = length;
+  arena->node = node;
+  arena->next = pool->arenas;
+  pool->arenas = arena;
+
+  /* Anonymous mapping is zero filled, no need to honour ZEROED_BUFFER here.
+     Carve from the end, so that free list starts at the arena start. */
+  for (i = items_count - 1; i >= 0; i--) {
+    pool_item = (struct memory_pool_element *)(
+        addr + (size_t)i * pool->arena_slab_size);
+    pool_item->next = pool->free_list[node];
+    pool->free_list[node] = pool_item;
+  }
+  pool->total_bufs_allocated_by_pool += items_count;
+  pool->free_bufs_in_pool += items_count;
+  if (pool->mem_mark_used_space_func) {
+    pool->mem_mark_used_space_func((size_t)items_count *
+                                   pool->mempool_item_size);
+  }
+  return 0;
+}
+
 /**
  * Internal function to preallocate items to memory pool.
  * args:
@@ -109,6 +311,12 @@ int freelist_allocate(struct mempool *pool, int items_count_to_allocate) {
     return S3_MEMPOOL_INVALID_ARG;
   }
 
+  if ((pool->flags & ENABLE_HUGEPAGE_ARENA) != 0) {
+    /* Expansion is done on behalf of the calling thread, place it locally */
+    return arena_allocate(pool, items_count_to_allocate,
+                          pool_current_node(pool));
+  }
+
   for (i = 0; i < items_count_to_allocate; i++) {
     if (pool->flags & CREATE_ALIGNED_MEMORY) {
       buf = NULL;
@@ -144,8 +352,8 @@ int freelist_allocate(struct mempool *pool, int items_count_to_allocate) {
     /* Put the allocated memory into the list */
     pool_item = (struct memory_pool_element *)buf;
 
-    pool_item->next = pool->free_list;
-    pool->free_list = pool_item;
+    pool_item->next = pool->free_list[0];
+    pool->free_list[0] = pool_item;
     /* memory is pre appended to list */
 
     /* Increase the free list count */
@@ -157,12 +365,199 @@ int freelist_allocate(struct mempool *pool, int items_count_to_allocate) {
   return 0;
 }
 
+/**
+ * Internal function to take one item from pool's free list, expanding the
+ * free list if it is empty and 'can_expand' is set. With ENABLE_NUMA_LOCAL
+ * the free list of the caller's node is preferred, other nodes are used
+ * before the pool is expanded.
+ * Must be called with pool lock held (if locking is enabled).
+ */
+static struct memory_pool_element *freelist_take(struct mempool *pool,
+                                                 int can_expand) {
+  int rc;
+  int node;
+  int i;
+  int bufs_to_allocate;
+  int bufs_that_can_be_allocated = 0;
+  struct memory_pool_element *pool_item = NULL;
+
+  /* If the free list is empty then expand the pool's free list */
+  if (pool->free_bufs_in_pool == 0) {
+    if (!can_expand) {
+      return NULL;
+    }
+    bufs_to_allocate = pool->expandable_size / pool->mempool_item_size;
+    bufs_that_can_be_allocated = pool_can_expand_by(pool);
+    if (bufs_that_can_be_allocated > 0) {
+      /* We can at least allocate
+         min(bufs_that_can_be_allocated, bufs_to_allocate) */
+      bufs_to_allocate = ((bufs_to_allocate > bufs_that_can_be_allocated)
+                              ? bufs_that_can_be_allocated
+                              : bufs_to_allocate);
+
+      rc = freelist_allocate(pool, bufs_to_allocate);
+      if (rc != 0) {
+        return NULL;
+      }
+    } else {
+      /* We cannot allocate any more buffers, reached max threshold */
+      return NULL;
+    }
+  }
+
+  /* Done with expansion of pool in case of pre allocated pools */
+
+  /* Logic of allocation from free list */
+  /* If there is an item on the pool's free list, then take that... */
+  node = pool_current_node(pool);
+  for (i = 0; i < pool->numa_nodes; i++) {
+    if (pool->free_list[node] != NULL) {
+      pool_item = pool->free_list[node];
+      pool->free_list[node] = pool_item->next;
+      pool_item->next = (struct memory_pool_element *)NULL;
+      pool->free_bufs_in_pool--;
+      break;
+    }
+    node = (node + 1) % pool->numa_nodes;
+  }
+
+  if (pool_item) {
+    pool->number_of_bufs_shared++;
+  }
+  return pool_item;
+}
+
+/**
+ * Internal function to put item back to pool's free list.
+ * Must be called with pool lock held (if locking is enabled).
+ */
+static void freelist_put(struct mempool *pool,
+                         struct memory_pool_element *pool_item) {
+  int node = pool_item_node(pool, pool_item);
+
+  pool_item->next = pool->free_list[node];
+  pool->free_list[node] = pool_item;
+  pool->free_bufs_in_pool++;
+  pool->number_of_bufs_shared--;
+}
+
+/**
+ * Internal function, returns number of free buffers held in thread caches.
+ * Buffers in thread caches are accounted as shared in the pool counters, and
+ * reported apart from shared and free ones.
+ * Must be called with pool lock held.
+ */
+static int thread_caches_count(struct mempool *pool) {
+  int count = 0;
+  struct mempool_thread_cache *cache;
+
+  for (cache = pool->thread_caches; cache != NULL; cache = cache->next) {
+    count += __atomic_load_n(&cache->count, __ATOMIC_RELAXED);
+  }
+  return count;
+}
+
+/**
+ * Internal function, moves 'count' buffers from thread cache to the pool's
+ * free list. Must be called with pool lock held.
+ */
+static void thread_cache_flush_locked(struct mempool_thread_cache *cache,
+                                      int count) {
+  struct memory_pool_element *pool_item;
+
+  while (count-- > 0 && cache->free_list != NULL) {
+    pool_item = cache->free_list;
+    cache->free_list = pool_item->next;
+    __atomic_store_n(&cache->count, cache->count - 1, __ATOMIC_RELAXED);
+    freelist_put(cache->pool, pool_item);
+  }
+}
+
+/* Called by pthread on thread exit, returns cached buffers to the pool */
+static void thread_cache_destructor(void *arg) {
+  struct mempool_thread_cache *cache = (struct mempool_thread_cache *)arg;
+  struct mempool *pool;
+
+  if (cache == NULL) {
+    return;
+  }
+  pool = cache->pool;
+
+  pthread_mutex_lock(&pool->lock);
+  thread_cache_flush_locked(cache, cache->count);
+  if (cache->prev != NULL) {
+    cache->prev->next = cache->next;
+  } else {
+    pool->thread_caches = cache->next;
+  }
+  if (cache->next != NULL) {
+    cache->next->prev = cache->prev;
+  }
+  pthread_mutex_unlock(&pool->lock);
+
+  free(cache);
+}
+
+/* Returns cache of the calling thread, creates it on first use */
+static struct mempool_thread_cache *thread_cache_get(struct mempool *pool) {
+  struct mempool_thread_cache *cache;
+
+  cache = (struct mempool_thread_cache *)pthread_getspecific(
+      pool->thread_cache_key);
+  if (cache != NULL) {
+    return cache;
+  }
+
+  cache = (struct mempool_thread_cache *)calloc(
+      1, sizeof(struct mempool_thread_cache));
+  if (cache == NULL) {
+    return NULL;
+  }
+  cache->pool = pool;
+  if (pthread_setspecific(pool->thread_cache_key, cache) != 0) {
+    free(cache);
+    return NULL;
+  }
+
+  pthread_mutex_lock(&pool->lock);
+  cache->next = pool->thread_caches;
+  if (pool->thread_caches != NULL) {
+    pool->thread_caches->prev = cache;
+  }
+  pool->thread_caches = cache;
+  pthread_mutex_unlock(&pool->lock);
+
+  return cache;
+}
+
+/* Moves up to half of thread cache size buffers from pool to thread cache */
+static void thread_cache_refill(struct mempool_thread_cache *cache) {
+  int i;
+  struct mempool *pool = cache->pool;
+  struct memory_pool_element *pool_item;
+
+  pthread_mutex_lock(&pool->lock);
+  for (i = 0; i < pool->thread_cache_size / 2; i++) {
+    /* Expand the pool only if nothing is available, same as without cache */
+    pool_item = freelist_take(pool, i == 0);
+    if (pool_item == NULL) {
+      break;
+    }
+    pool_item->next = cache->free_list;
+    cache->free_list = pool_item;
+    __atomic_store_n(&cache->count, cache->count + 1, __ATOMIC_RELAXED);
+  }
+  pthread_mutex_unlock(&pool->lock);
+}
+
 int mempool_create(size_t pool_item_size, size_t pool_initial_size,
                    size_t pool_expansion_size, size_t pool_max_threshold_size,
                    func_log_callback_type log_callback_func, int flags,
                    MemoryPoolHandle *handle) {
   int rc;
+  int node;
   int bufs_to_allocate;
+  size_t align;
   struct mempool *pool = NULL;
 
   /* pool_max_threshold_size == 0 is possible when
@@ -184,10 +579,36 @@ int mempool_create(size_t pool_item_size, size_t pool_initial_size,
   }
 
   pool->flags |= flags;
+  if ((pool->flags & ENABLE_THREAD_CACHE) != 0) {
+    /* Global free list is shared by threads */
+    pool->flags |= ENABLE_LOCKING;
+    /* Bound the memory a thread can hold, rather than strand a lot of it in
+       caches of threads which do not need it anymore */
+    pool->thread_cache_size = MEMPOOL_THREAD_CACHE_MAX_BYTES / pool_item_size;
+    if (pool->thread_cache_size > MEMPOOL_THREAD_CACHE_SIZE) {
+      pool->thread_cache_size = MEMPOOL_THREAD_CACHE_SIZE;
+    }
+    if (pool->thread_cache_size < 2) {
+      pool->flags &= ~ENABLE_THREAD_CACHE;
+    }
+  }
+  if ((pool->flags & ENABLE_NUMA_LOCAL) != 0) {
+    /* Node placement is done per arena */
+    pool->flags |= ENABLE_HUGEPAGE_ARENA;
+  }
   pool->mempool_item_size = pool_item_size;
   if (flags & CREATE_ALIGNED_MEMORY) {
     pool->alignment = MEMORY_ALIGNMENT;
   }
+  pool->numa_nodes = 1;
+  if ((pool->flags & ENABLE_NUMA_LOCAL) != 0) {
+    pool->numa_nodes = numa_nodes_count();
+  }
+  if ((pool->flags & ENABLE_HUGEPAGE_ARENA) != 0) {
+    /* Keep buffers in arena aligned same as posix_memalign would do */
+    align = pool->alignment ? pool->alignment : sizeof(void *);
+    pool->arena_slab_size = (pool_item_size + align - 1) / align * align;
+  }
 
   if ((pool->flags & ENABLE_LOCKING) != 0) {
     rc = pthread_mutex_init(&pool->lock, NULL);
@@ -197,6 +618,15 @@ int mempool_create(size_t pool_item_size, size_t pool_initial_size,
     }
   }
 
+  if ((pool->flags & ENABLE_THREAD_CACHE) != 0) {
+    rc = pthread_key_create(&pool->thread_cache_key, thread_cache_destructor);
+    if (rc != 0) {
+      pthread_mutex_destroy(&pool->lock);
+      free(pool);
+      return S3_MEMPOOL_ERROR;
+    }
+  }
+
   *handle = (MemoryPoolHandle)pool;
 
   pool->log_callback_func = log_callback_func;
@@ -207,7 +637,18 @@ int mempool_create(size_t pool_item_size, size_t pool_initial_size,
   bufs_to_allocate = pool_initial_size / pool_item_size;
 
   /* Allocate the free list */
-  if (bufs_to_allocate > 0) {
+  if (bufs_to_allocate > 0 && pool->numa_nodes > 1) {
+    /* Spread initial buffers over all nodes, one arena per node */
+    for (node = 0; node < pool->numa_nodes; node++) {
+      rc = arena_allocate(pool,
+                          bufs_to_allocate / pool->numa_nodes +
+                              (node < bufs_to_allocate % pool->numa_nodes),
+                          node);
+      if (rc != 0) {
+        goto fail;
+      }
+    }
+  } else if (bufs_to_allocate > 0) {
     rc = freelist_allocate(pool, bufs_to_allocate);
     if (rc != 0) {
       goto fail;
@@ -260,10 +701,8 @@ int mempool_create_with_shared_mem(
 }
 
 void *mempool_getbuffer(MemoryPoolHandle handle, size_t expected_buffer_size) {
-  int rc;
-  int bufs_to_allocate;
-  int bufs_that_can_be_allocated = 0;
   struct memory_pool_element *pool_item = NULL;
+  struct mempool_thread_cache *cache = NULL;
   struct mempool *pool = (struct mempool *)handle;
   char *log_msg_fmt =
       "mempool(%p): mempool_getbuffer called for invalid "
@@ -285,51 +724,29 @@ void *mempool_getbuffer(MemoryPoolHandle handle, size_t expected_buffer_size) {
     }
   }
 
-  if ((pool->flags & ENABLE_LOCKING) != 0) {
-    pthread_mutex_lock(&pool->lock);
+  if ((pool->flags & ENABLE_THREAD_CACHE) != 0) {
+    cache = thread_cache_get(pool);
   }
 
-  /* If the free list is empty then expand the pool's free list */
-  if (pool->free_bufs_in_pool == 0) {
-    bufs_to_allocate = pool->expandable_size / pool->mempool_item_size;
-    bufs_that_can_be_allocated = pool_can_expand_by(pool);
-    if (bufs_that_can_be_allocated > 0) {
-      /* We can at least allocate
-         min(bufs_that_can_be_allocated, bufs_to_allocate) */
-      bufs_to_allocate = ((bufs_to_allocate > bufs_that_can_be_allocated)
-                              ? bufs_that_can_be_allocated
-                              : bufs_to_allocate);
-
-      rc = freelist_allocate(pool, bufs_to_allocate);
-      if (rc != 0) {
-        if ((pool->flags & ENABLE_LOCKING) != 0) {
-          pthread_mutex_unlock(&pool->lock);
-        }
-        return NULL;
-      }
-    } else {
-      /* We cannot allocate any more buffers, reached max threshold */
-      if ((pool->flags & ENABLE_LOCKING) != 0) {
-        pthread_mutex_unlock(&pool->lock);
-      }
-      return NULL;
+  if (cache != NULL) {
+    /* Lock free fast path, lock is taken only to refill the cache */
+    if (cache->free_list == NULL) {
+      thread_cache_refill(cache);
     }
+    pool_item = cache->free_list;
+    if (pool_item != NULL) {
+      cache->free_list = pool_item->next;
+      pool_item->next = (struct memory_pool_element *)NULL;
+      __atomic_store_n(&cache->count, cache->count - 1, __ATOMIC_RELAXED);
+    }
+    return (void *)pool_item;
   }
 
-  /* Done with expansion of pool in case of pre allocated pools */
-
-  /* Logic of allocation from free list */
-  /* If there is an item on the pool's free list, then take that... */
-  if (pool->free_list != NULL) {
-    pool_item = pool->free_list;
-    pool->free_list = pool_item->next;
-    pool_item->next = (struct memory_pool_element *)NULL;
-    pool->free_bufs_in_pool--;
+  if ((pool->flags & ENABLE_LOCKING) != 0) {
+    pthread_mutex_lock(&pool->lock);
   }
 
-  if (pool_item) {
-    pool->number_of_bufs_shared++;
-  }
+  pool_item = freelist_take(pool, 1);
 
   if ((pool->flags & ENABLE_LOCKING) != 0) {
     pthread_mutex_unlock(&pool->lock);
@@ -342,6 +759,7 @@ int mempool_releasebuffer(MemoryPoolHandle handle, void *buf,
                           size_t released_buffer_size) {
   struct mempool *pool = (struct mempool *)handle;
   struct memory_pool_element *pool_item = (struct memory_pool_element *)buf;
+  struct mempool_thread_cache *cache = NULL;
   char *log_msg_fmt =
       "mempool(%p): mempool_releasebuffer called for invalid "
       "released_buffer_size(%zu), current pool manages only "
@@ -362,6 +780,26 @@ int mempool_releasebuffer(MemoryPoolHandle handle, void *buf,
     }
   }
 
+  if ((pool->flags & ENABLE_THREAD_CACHE) != 0) {
+    cache = thread_cache_get(pool);
+  }
+
+  if (cache != NULL) {
+    if ((pool->flags & ZEROED_BUFFER) != 0) {
+      memset(pool_item, 0, pool->mempool_item_size);
+    }
+    /* Cache is full, return a batch to the pool */
+    if (cache->count >= pool->thread_cache_size) {
+      pthread_mutex_lock(&pool->lock);
+      thread_cache_flush_locked(cache, pool->thread_cache_size / 2);
+      pthread_mutex_unlock(&pool->lock);
+    }
+    pool_item->next = cache->free_list;
+    cache->free_list = pool_item;
+    __atomic_store_n(&cache->count, cache->count + 1, __ATOMIC_RELAXED);
+    return 0;
+  }
+
   if ((pool->flags & ENABLE_LOCKING) != 0) {
     pthread_mutex_lock(&pool->lock);
   }
@@ -373,13 +811,9 @@ int mempool_releasebuffer(MemoryPoolHandle handle, void *buf,
   }
 
   // Add the buffer back to pool
-  pool_item->next = pool->free_list;
-  pool->free_list = pool_item;
-  pool->free_bufs_in_pool++;
+  freelist_put(pool, pool_item);
   pool_item = NULL;
 
-  pool->number_of_bufs_shared--;
-
   if ((pool->flags & ENABLE_LOCKING) != 0) {
     pthread_mutex_unlock(&pool->lock);
   }
@@ -389,6 +823,7 @@ int mempool_releasebuffer(MemoryPoolHandle handle, void *buf,
 
 int mempool_getinfo(MemoryPoolHandle handle, struct pool_info *poolinfo) {
   struct mempool *pool = (struct mempool *)handle;
+  int cached_bufs = 0;
 
   if ((pool == NULL) || (poolinfo == NULL)) {
     return S3_MEMPOOL_INVALID_ARG;
@@ -398,9 +833,14 @@ int mempool_getinfo(MemoryPoolHandle handle, struct pool_info *poolinfo) {
     pthread_mutex_lock(&pool->lock);
   }
 
+  if ((pool->flags & ENABLE_THREAD_CACHE) != 0) {
+    cached_bufs = thread_caches_count(pool);
+  }
+
   poolinfo->mempool_item_size = pool->mempool_item_size;
   poolinfo->free_bufs_in_pool = pool->free_bufs_in_pool;
-  poolinfo->number_of_bufs_shared = pool->number_of_bufs_shared;
+  poolinfo->number_of_bufs_shared = pool->number_of_bufs_shared - cached_bufs;
+  poolinfo->bufs_in_thread_caches = cached_bufs;
   poolinfo->expandable_size = pool->expandable_size;
   poolinfo->total_bufs_allocated_by_pool = pool->total_bufs_allocated_by_pool;
   poolinfo->flags = pool->flags;
@@ -422,6 +862,7 @@ int mempool_reserved_space(MemoryPoolHandle handle, size_t *free_bytes) {
     pthread_mutex_lock(&pool->lock);
   }
 
+  /* Buffers in thread caches can not be used by other threads */
   *free_bytes = pool->mempool_item_size * pool->free_bufs_in_pool;
 
   if ((pool->flags & ENABLE_LOCKING) != 0) {
@@ -438,6 +879,8 @@ int mempool_available_space(MemoryPoolHandle p_pool, size_t *p_avail_bytes) {
   if (p_pool->flags & ENABLE_LOCKING) {
     pthread_mutex_lock(&p_pool->lock);
   }
+  /* Includes buffers in thread caches, they can not be used by other
+     threads */
   const size_t used_space =
       p_pool->number_of_bufs_shared * p_pool->mempool_item_size;
   const size_t max_memory_threshold = p_pool->max_memory_threshold;
@@ -481,6 +924,11 @@ int mempool_downsize(MemoryPoolHandle handle, size_t mem_to_free) {
     return S3_MEMPOOL_INVALID_ARG;
   }
 
+  /* Buffers carved from arena can not be returned to the system one by one */
+  if ((pool->flags & ENABLE_HUGEPAGE_ARENA) != 0) {
+    return S3_MEMPOOL_NOT_SUPPORTED;
+  }
+
   if ((pool->flags & ENABLE_LOCKING) != 0) {
     pthread_mutex_lock(&pool->lock);
   }
@@ -493,11 +941,11 @@ int mempool_downsize(MemoryPoolHandle handle, size_t mem_to_free) {
 
   /* Free the items in free list */
   if (bufs_to_free > 0) {
-    pool_item = pool->free_list;
+    pool_item = pool->free_list[0];
     count = 0;
     while (count < bufs_to_free && pool_item != NULL) {
       count++;
-      pool->free_list = pool_item->next;
+      pool->free_list[0] = pool_item->next;
       /* Log message about free()'ed item */
       if (pool->log_callback_func) {
         snprintf(log_msg, sizeof(log_msg), log_msg_fmt, (void *)pool,
@@ -507,7 +955,7 @@ int mempool_downsize(MemoryPoolHandle handle, size_t mem_to_free) {
       free(pool_item);
       pool->total_bufs_allocated_by_pool--;
       pool->free_bufs_in_pool--;
-      pool_item = pool->free_list;
+      pool_item = pool->free_list[0];
     }
     if (pool->mem_mark_free_space_func) {
       pool->mem_mark_free_space_func(bufs_to_free * pool->mempool_item_size);
@@ -523,7 +971,13 @@ int mempool_downsize(MemoryPoolHandle handle, size_t mem_to_free) {
 int mempool_destroy(MemoryPoolHandle *handle) {
   struct mempool *pool = NULL;
   struct memory_pool_element *pool_item;
+  struct mempool_thread_cache *cache;
+  struct mempool_arena *arena;
   char *log_msg_fmt = "mempool(%p): free(%p) called for buffer size(%zu)";
+  char *arena_log_msg_fmt = "mempool(%p): munmap(%p) called for length(%zu)";
+  char *in_use_log_msg_fmt =
+      "mempool(%p): not destroyed, %d buffers are in use in its arenas";
+  int bufs_in_use;
   char log_msg[200];
 
   if (handle == NULL) {
@@ -543,12 +997,60 @@ int mempool_destroy(MemoryPoolHandle *handle) {
     return S3_MEMPOOL_INVALID_ARG;
   }
 
+  /* Unmapping arenas would pull the memory from under buffers still in use,
+     keep the pool instead. */
+  if ((pool->flags & ENABLE_HUGEPAGE_ARENA) != 0) {
+    bufs_in_use = pool->number_of_bufs_shared;
+    if ((pool->flags & ENABLE_THREAD_CACHE) != 0) {
+      bufs_in_use -= thread_caches_count(pool);
+    }
+    if (bufs_in_use > 0) {
+      if (pool->log_callback_func) {
+        snprintf(log_msg, sizeof(log_msg), in_use_log_msg_fmt, (void *)pool,
+                 bufs_in_use);
+        pool->log_callback_func(MEMPOOL_LOG_ERROR, log_msg);
+      }
+      if ((pool->flags & ENABLE_LOCKING) != 0) {
+        pthread_mutex_unlock(&pool->lock);
+      }
+      return S3_MEMPOOL_ERROR;
+    }
+  }
+
   /* reset the handle */
   *handle = NULL;
+
+  /* Return buffers from thread caches to the free list, caches of alive
+     threads must not be used after pool is destroyed. */
+  if ((pool->flags & ENABLE_THREAD_CACHE) != 0) {
+    pthread_key_delete(pool->thread_cache_key);
+    while (pool->thread_caches != NULL) {
+      cache = pool->thread_caches;
+      pool->thread_caches = cache->next;
+      thread_cache_flush_locked(cache, cache->count);
+      free(cache);
+    }
+  }
+  if ((pool->flags & ENABLE_HUGEPAGE_ARENA) != 0) {
+    /* Buffers live in arenas, unmap them as a whole */
+    while (pool->arenas != NULL) {
+      arena = pool->arenas;
+      pool->arenas = arena->next;
+      if (pool->log_callback_func) {
+        snprintf(log_msg, sizeof(log_msg), arena_log_msg_fmt, (void *)pool,
+                 (void *)arena->addr, arena->length);
+        pool->log_callback_func(MEMPOOL_LOG_DEBUG, log_msg);
+      }
+      munmap(arena->addr, arena->length);
+      free(arena);
+    }
+    memset(pool->free_list, 0, sizeof(pool->free_list));
+  }
+
   /* Free the items in free list */
-  pool_item = pool->free_list;
+  pool_item = pool->free_list[0];
   while (pool_item != NULL) {
-    pool->free_list = pool_item->next;
+    pool->free_list[0] = pool_item->next;
     /* Log message about free()'ed item */
     if (pool->log_callback_func) {
       snprintf(log_msg, sizeof(log_msg), log_msg_fmt, (void *)pool,
@@ -561,9 +1063,9 @@ int mempool_destroy(MemoryPoolHandle *handle) {
     pool->total_bufs_allocated_by_pool--;
     pool->free_bufs_in_pool--;
 #endif
-    pool_item = pool->free_list;
+    pool_item = pool->free_list[0];
   }
-  pool->free_list = NULL;
+  pool->free_list[0] = NULL;
 
   /* TODO: libevhtp/libevent seems to hold some references and not release back
    * to pool. Bug will be logged for this to investigate.
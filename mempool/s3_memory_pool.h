@@ -34,11 +34,35 @@ extern "C" {
 #define CREATE_ALIGNED_MEMORY 0x0001
 #define ENABLE_LOCKING 0x0002
 #define ZEROED_BUFFER 0x0004
+/* Serve buffers from per-thread caches (magazines), global free list is
+   touched (under lock) only to refill/flush a batch of buffers. Implies
+   ENABLE_LOCKING. */
+#define ENABLE_THREAD_CACHE 0x0008
+/* Carve buffers from large anonymous mappings (arenas) instead of allocating
+   each buffer with malloc/posix_memalign. Arena is backed by preallocated
+   huge pages (MAP_HUGETLB) when available, otherwise it is advised for
+   transparent huge pages. */
+#define ENABLE_HUGEPAGE_ARENA 0x0010
+/* Keep per NUMA node arenas and free lists, buffers are served from the node
+   of the calling thread when possible. Implies ENABLE_HUGEPAGE_ARENA. */
+#define ENABLE_NUMA_LOCAL 0x0020
+
+/* Max buffers held by a thread cache, refill/flush moves half of it. Cache
+   is also bounded to MEMPOOL_THREAD_CACHE_MAX_BYTES, pools whose buffers are
+   too large to cache at least two of them do not use thread caches. */
+#define MEMPOOL_THREAD_CACHE_SIZE 64
+#define MEMPOOL_THREAD_CACHE_MAX_BYTES ((size_t)256 * 1024)
+
+/* Arena length is rounded up to the huge page size when the pool may grow by
+   that much */
+#define MEMPOOL_HUGEPAGE_SIZE ((size_t)2 * 1024 * 1024)
+#define MEMPOOL_MAX_NUMA_NODES 8
 
 #define MEMORY_ALIGNMENT 4096
 #define S3_MEMPOOL_ERROR -1
 #define S3_MEMPOOL_INVALID_ARG -2
 #define S3_MEMPOOL_THRESHOLD_EXCEEDED -3
+#define S3_MEMPOOL_NOT_SUPPORTED -4
 
 struct mempool;
 typedef struct mempool *MemoryPoolHandle;
@@ -66,6 +90,7 @@ struct pool_info {
   int total_bufs_allocated_by_pool;
   size_t mempool_item_size;
   size_t expandable_size;
+  int bufs_in_thread_caches; /* free, but only for the thread holding them */
 };
 
 /**
@@ -123,6 +148,23 @@ struct pool_info {
  * app. + free list in pool)
  * when done via the pool
  * flags (in) if ENABLE_LOCKING then pool synchronization with lock
+ * if ENABLE_THREAD_CACHE then each thread keeps up to
+ * MEMPOOL_THREAD_CACHE_SIZE free buffers, and at most
+ * MEMPOOL_THREAD_CACHE_MAX_BYTES, in its own cache, so that most get/release
+ * calls do not take the pool lock. The flag is dropped for pools of larger
+ * buffers. Buffers held in thread caches are reported separately by
+ * mempool_getinfo, they are neither free nor shared, and are not counted as
+ * free space by mempool_reserved_space/mempool_available_space. They can not
+ * be released by mempool_downsize. Thread cache is returned to the pool when
+ * thread exits.
+ * if ENABLE_HUGEPAGE_ARENA then initial allocation and every expansion is a
+ * single arena. Arena is rounded up to MEMPOOL_HUGEPAGE_SIZE and carved whole
+ * when max threshold allows it, so the pool may hold up to a huge page more
+ * buffers than asked. Arenas are unmapped only by mempool_destroy, so
+ * mempool_downsize is not supported for such pool, and mempool_destroy
+ * refuses to destroy it while its buffers are in use.
+ * if ENABLE_NUMA_LOCAL then initial size is split evenly between NUMA nodes,
+ * expansion arena is placed on the node of the thread which expands the pool.
  * p_handle (out) On success pool handle is returned here
  * returns:
  * 0 on success, otherwise an error
@@ -211,7 +253,8 @@ int mempool_getbuffer_size(MemoryPoolHandle handle, size_t *buffer_size);
  * handle (in) Pool handle as returned by mempool_create
  * mem_to_free (in) Bytes to free, MUST be multiple of pool_item_size
  * returns:
- * 0 on success, otherwise an error
+ * 0 on success, otherwise an error. ENABLE_HUGEPAGE_ARENA pool frees
+ * nothing and returns S3_MEMPOOL_NOT_SUPPORTED.
  */
 int mempool_downsize(MemoryPoolHandle handle, size_t mem_to_free);
 
@@ -236,8 +279,11 @@ int mempool_resize(MemoryPoolHandle handle, int new_max_threshold);
  * Call this api when the application is shutting down, Api will assert in case
  * if there is memory allocation done via pool api and it being freed without
  * pool's free api
+ * ENABLE_HUGEPAGE_ARENA pool is not destroyed while any of its buffers are
+ * in use, as they live in its arenas. S3_MEMPOOL_ERROR is returned and the
+ * handle is kept.
  * args:
- * p_handle (in/out) pointer to handle, on return this will be set to NULL
+ * p_handle (in/out) pointer to handle, on success this will be set to NULL
  * returns:
  * 0 on success, otherwise an error
  */
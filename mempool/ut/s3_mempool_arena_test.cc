@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "s3_memory_pool.h"
+
+#define FOUR_KB 4096
+#define SIXTEEN_KB (4 * FOUR_KB)
+#define SIXTEEN_MB (16 * 1024 * 1024)
+
+class MempoolArenaTestSuite : public testing::Test {
+ protected:
+  void SetUp() { handle = NULL; }
+
+  void TearDown() {
+    if (handle != NULL) {
+      mempool_destroy(&handle);
+    }
+  }
+
+  MemoryPoolHandle handle;
+  struct pool_info pool_details;
+};
+
+TEST_F(MempoolArenaTestSuite, BuffersAreCarvedFromArenaTest) {
+  // Threshold allows it, so whole huge page arena is carved
+  const int bufs_count = MEMPOOL_HUGEPAGE_SIZE / SIXTEEN_KB;
+  std::vector<void *> bufs;
+
+  EXPECT_EQ(0, mempool_create(SIXTEEN_KB, 16 * SIXTEEN_KB, SIXTEEN_KB,
+                              SIXTEEN_MB, (func_log_callback_type)NULL,
+                              CREATE_ALIGNED_MEMORY | ENABLE_HUGEPAGE_ARENA,
+                              &handle));
+  EXPECT_EQ(0, mempool_getinfo(handle, &pool_details));
+  EXPECT_EQ(bufs_count, pool_details.total_bufs_allocated_by_pool);
+  EXPECT_EQ(bufs_count, pool_details.free_bufs_in_pool);
+
+  for (int i = 0; i < bufs_count; ++i) {
+    bufs.push_back(mempool_getbuffer(handle, SIXTEEN_KB));
+    ASSERT_TRUE(bufs.back() != NULL);
+    EXPECT_EQ(0, (uintptr_t)bufs.back() % MEMORY_ALIGNMENT);
+    // Arena memory is zero filled and writable
+    EXPECT_EQ(0, ((char *)bufs.back())[SIXTEEN_KB - 1]);
+    memset(bufs.back(), 0xab, SIXTEEN_KB);
+  }
+  // All buffers are adjacent slabs of one mapping
+  std::sort(bufs.begin(), bufs.end());
+  EXPECT_EQ((bufs_count - 1) * SIXTEEN_KB,
+            (char *)bufs.back() - (char *)bufs.front());
+
+  for (auto buf : bufs) {
+    EXPECT_EQ(0, mempool_releasebuffer(handle, buf, SIXTEEN_KB));
+  }
+  EXPECT_EQ(0, mempool_getinfo(handle, &pool_details));
+  EXPECT_EQ(0, pool_details.number_of_bufs_shared);
+  EXPECT_EQ(bufs_count, pool_details.free_bufs_in_pool);
+}
+
+TEST_F(MempoolArenaTestSuite, ExpansionAddsArenaTest) {
+  EXPECT_EQ(0, mempool_create(FOUR_KB, 0, 4 * FOUR_KB, 8 * FOUR_KB,
+                              (func_log_callback_type)NULL,
+                              ENABLE_HUGEPAGE_ARENA, &handle));
+  EXPECT_EQ(0, mempool_getinfo(handle, &pool_details));
+  EXPECT_EQ(0, pool_details.total_bufs_allocated_by_pool);
+
+  std::vector<void *> bufs;
+  for (int i = 0; i < 8; ++i) {
+    bufs.push_back(mempool_getbuffer(handle, FOUR_KB));
+    ASSERT_TRUE(bufs.back() != NULL);
+  }
+  EXPECT_EQ(0, mempool_getinfo(handle, &pool_details));
+  EXPECT_EQ(8, pool_details.total_bufs_allocated_by_pool);
+  EXPECT_EQ(8, pool_details.number_of_bufs_shared);
+
+  // Max threshold is reached
+  EXPECT_TRUE(mempool_getbuffer(handle, FOUR_KB) == NULL);
+
+  for (auto buf : bufs) {
+    EXPECT_EQ(0, mempool_releasebuffer(handle, buf, FOUR_KB));
+  }
+  // Arena buffers are not given back one by one
+  EXPECT_EQ(S3_MEMPOOL_NOT_SUPPORTED, mempool_downsize(handle, 4 * FOUR_KB));
+  EXPECT_EQ(0, mempool_getinfo(handle, &pool_details));
+  EXPECT_EQ(8, pool_details.total_bufs_allocated_by_pool);
+  EXPECT_EQ(8, pool_details.free_bufs_in_pool);
+}
+
+TEST_F(MempoolArenaTestSuite, DestroyKeepsPoolWithBuffersInUseTest) {
+  EXPECT_EQ(0, mempool_create(FOUR_KB, 4 * FOUR_KB, FOUR_KB, 4 * FOUR_KB,
+                              (func_log_callback_type)NULL,
+                              ENABLE_HUGEPAGE_ARENA | ENABLE_THREAD_CACHE,
+                              &handle));
+  char *buf = (char *)mempool_getbuffer(handle, FOUR_KB);
+  ASSERT_TRUE(buf != NULL);
+
+  EXPECT_EQ(S3_MEMPOOL_ERROR, mempool_destroy(&handle));
+  ASSERT_TRUE(handle != NULL);
+  // Buffer and pool are still usable
+  memset(buf, 0xab, FOUR_KB);
+  EXPECT_EQ(0, mempool_releasebuffer(handle, buf, FOUR_KB));
+
+  // Buffers left in the thread cache are not in use
+  EXPECT_EQ(0, mempool_destroy(&handle));
+  EXPECT_TRUE(handle == NULL);
+}
+
+TEST_F(MempoolArenaTestSuite, ZeroedBufferTest) {
+  EXPECT_EQ(0, mempool_create(FOUR_KB, FOUR_KB, FOUR_KB, FOUR_KB,
+                              (func_log_callback_type)NULL,
+                              ENABLE_HUGEPAGE_ARENA | ZEROED_BUFFER, &handle));
+  char *buf = (char *)mempool_getbuffer(handle, FOUR_KB);
+  ASSERT_TRUE(buf != NULL);
+  memset(buf, 0xab, FOUR_KB);
+  EXPECT_EQ(0, mempool_releasebuffer(handle, buf, FOUR_KB));
+
+  buf = (char *)mempool_getbuffer(handle, FOUR_KB);
+  ASSERT_TRUE(buf != NULL);
+  EXPECT_EQ(0, buf[0]);
+  EXPECT_EQ(0, buf[FOUR_KB - 1]);
+  EXPECT_EQ(0, mempool_releasebuffer(handle, buf, FOUR_KB));
+}
+
+TEST_F(MempoolArenaTestSuite, NumaLocalWithThreadCacheTest) {
+  const int bufs_count = 64;
+
+  EXPECT_EQ(0, mempool_create(FOUR_KB, bufs_count * FOUR_KB, 16 * FOUR_KB,
+                              SIXTEEN_MB, (func_log_callback_type)NULL,
+                              CREATE_ALIGNED_MEMORY | ENABLE_NUMA_LOCAL |
+                                  ENABLE_THREAD_CACHE,
+                              &handle));
+  EXPECT_EQ(0, mempool_getinfo(handle, &pool_details));
+  // NUMA locality implies arenas
+  EXPECT_TRUE(ENABLE_HUGEPAGE_ARENA & pool_details.flags);
+  // Initial buffers are spread over nodes, each node arena is carved whole
+  EXPECT_LE(bufs_count, pool_details.total_bufs_allocated_by_pool);
+  EXPECT_EQ(0, pool_details.total_bufs_allocated_by_pool %
+                   (MEMPOOL_HUGEPAGE_SIZE / FOUR_KB));
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([this]() {
+      void *bufs[8];
+      for (int i = 0; i < 1000; ++i) {
+        for (int j = 0; j < 8; ++j) {
+          bufs[j] = mempool_getbuffer(handle, FOUR_KB);
+          ASSERT_TRUE(bufs[j] != NULL);
+        }
+        for (int j = 0; j < 8; ++j) {
+          mempool_releasebuffer(handle, bufs[j], FOUR_KB);
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(0, mempool_getinfo(handle, &pool_details));
+  EXPECT_EQ(0, pool_details.number_of_bufs_shared);
+  EXPECT_EQ(pool_details.total_bufs_allocated_by_pool,
+            pool_details.free_bufs_in_pool);
+}
@@ -0,0 +1,232 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "s3_memory_pool.h"
+
+#define FOUR_KB 4096
+#define SIXTEEN_MB (16 * 1024 * 1024)
+
+#define BENCH_THREADS 8
+#define BENCH_ITERATIONS 100000
+// Buffers each thread holds at a time
+#define BENCH_WINDOW 4
+
+class MempoolThreadCacheTestSuite : public testing::Test {
+ protected:
+  void SetUp() { handle = NULL; }
+
+  void TearDown() {
+    if (handle != NULL) {
+      mempool_destroy(&handle);
+    }
+  }
+
+  // Runs BENCH_THREADS threads doing get/release on the pool, returns elapsed
+  // time in ms. Number of failed allocations is returned in 'failures'.
+  long run_contention(int *failures) {
+    std::atomic<int> failed(0);
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+
+    for (int t = 0; t < BENCH_THREADS; ++t) {
+      threads.emplace_back([this, &failed]() {
+        void *bufs[BENCH_WINDOW];
+        for (int i = 0; i < BENCH_ITERATIONS; ++i) {
+          for (int j = 0; j < BENCH_WINDOW; ++j) {
+            bufs[j] = mempool_getbuffer(handle, FOUR_KB);
+            if (bufs[j] == NULL) {
+              failed++;
+            }
+          }
+          for (int j = 0; j < BENCH_WINDOW; ++j) {
+            if (bufs[j] != NULL) {
+              mempool_releasebuffer(handle, bufs[j], FOUR_KB);
+            }
+          }
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    *failures = failed;
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now() - start).count();
+  }
+
+  MemoryPoolHandle handle;
+  struct pool_info pool_details;
+};
+
+TEST_F(MempoolThreadCacheTestSuite, GetReleaseAccountingTest) {
+  EXPECT_EQ(0, mempool_create(FOUR_KB, 0, FOUR_KB, SIXTEEN_MB,
+                              (func_log_callback_type)NULL,
+                              CREATE_ALIGNED_MEMORY | ENABLE_THREAD_CACHE,
+                              &handle));
+  EXPECT_EQ(0, mempool_getinfo(handle, &pool_details));
+  // Thread cache implies locking of the global free list
+  EXPECT_TRUE(ENABLE_LOCKING & pool_details.flags);
+
+  void *buf = mempool_getbuffer(handle, FOUR_KB);
+  ASSERT_TRUE(buf != NULL);
+  EXPECT_EQ(0, mempool_getinfo(handle, &pool_details));
+  EXPECT_EQ(1, pool_details.number_of_bufs_shared);
+  EXPECT_EQ(pool_details.total_bufs_allocated_by_pool - 1,
+            pool_details.free_bufs_in_pool);
+
+  EXPECT_EQ(0, mempool_releasebuffer(handle, buf, FOUR_KB));
+  EXPECT_EQ(0, mempool_getinfo(handle, &pool_details));
+  EXPECT_EQ(0, pool_details.number_of_bufs_shared);
+  // Released buffer stays in the thread cache, it is not free for others.
+  EXPECT_EQ(1, pool_details.bufs_in_thread_caches);
+  EXPECT_EQ(pool_details.total_bufs_allocated_by_pool - 1,
+            pool_details.free_bufs_in_pool);
+
+  size_t free_bytes = 0;
+  EXPECT_EQ(0, mempool_reserved_space(handle, &free_bytes));
+  EXPECT_EQ(pool_details.free_bufs_in_pool * FOUR_KB, free_bytes);
+  size_t avail_bytes = 0;
+  EXPECT_EQ(0, mempool_available_space(handle, &avail_bytes));
+  EXPECT_EQ(SIXTEEN_MB - FOUR_KB, avail_bytes);
+}
+
+TEST_F(MempoolThreadCacheTestSuite, CacheIsBoundedTest) {
+  const int bufs_count = 4 * MEMPOOL_THREAD_CACHE_SIZE;
+  std::vector<void *> bufs;
+  EXPECT_EQ(0, mempool_create(FOUR_KB, 0, FOUR_KB, SIXTEEN_MB,
+                              (func_log_callback_type)NULL, ENABLE_THREAD_CACHE,
+                              &handle));
+  for (int i = 0; i < bufs_count; ++i) {
+    bufs.push_back(mempool_getbuffer(handle, FOUR_KB));
+    ASSERT_TRUE(bufs.back() != NULL);
+  }
+  for (auto buf : bufs) {
+    EXPECT_EQ(0, mempool_releasebuffer(handle, buf, FOUR_KB));
+  }
+  EXPECT_EQ(0, mempool_getinfo(handle, &pool_details));
+  EXPECT_EQ(bufs_count, pool_details.total_bufs_allocated_by_pool);
+  EXPECT_EQ(0, pool_details.number_of_bufs_shared);
+  EXPECT_GT(pool_details.bufs_in_thread_caches, 0);
+  EXPECT_LE(pool_details.bufs_in_thread_caches, MEMPOOL_THREAD_CACHE_SIZE);
+  EXPECT_EQ(bufs_count, pool_details.free_bufs_in_pool +
+                            pool_details.bufs_in_thread_caches);
+
+  // Only buffers outside of thread cache can be downsized.
+  EXPECT_EQ(0, mempool_downsize(handle, (size_t)bufs_count * FOUR_KB));
+  EXPECT_EQ(0, mempool_getinfo(handle, &pool_details));
+  EXPECT_EQ(0, pool_details.free_bufs_in_pool);
+  EXPECT_EQ(pool_details.total_bufs_allocated_by_pool,
+            pool_details.bufs_in_thread_caches);
+}
+
+TEST_F(MempoolThreadCacheTestSuite, CacheIsBoundedInBytesTest) {
+  const size_t item_size = MEMPOOL_THREAD_CACHE_MAX_BYTES / 4;
+  std::vector<void *> bufs;
+  EXPECT_EQ(0, mempool_create(item_size, 0, item_size, SIXTEEN_MB,
+                              (func_log_callback_type)NULL, ENABLE_THREAD_CACHE,
+                              &handle));
+  for (int i = 0; i < 16; ++i) {
+    bufs.push_back(mempool_getbuffer(handle, item_size));
+    ASSERT_TRUE(bufs.back() != NULL);
+  }
+  for (auto buf : bufs) {
+    EXPECT_EQ(0, mempool_releasebuffer(handle, buf, item_size));
+  }
+  EXPECT_EQ(0, mempool_getinfo(handle, &pool_details));
+  EXPECT_LE(pool_details.bufs_in_thread_caches * item_size,
+            MEMPOOL_THREAD_CACHE_MAX_BYTES);
+  EXPECT_EQ(16, pool_details.free_bufs_in_pool +
+                    pool_details.bufs_in_thread_caches);
+}
+
+TEST_F(MempoolThreadCacheTestSuite, LargeBuffersAreNotCachedTest) {
+  const size_t item_size = MEMPOOL_THREAD_CACHE_MAX_BYTES;
+  EXPECT_EQ(0, mempool_create(item_size, 0, item_size, SIXTEEN_MB,
+                              (func_log_callback_type)NULL, ENABLE_THREAD_CACHE,
+                              &handle));
+  EXPECT_EQ(0, mempool_getinfo(handle, &pool_details));
+  EXPECT_FALSE(ENABLE_THREAD_CACHE & pool_details.flags);
+  EXPECT_TRUE(ENABLE_LOCKING & pool_details.flags);
+
+  void *buf = mempool_getbuffer(handle, item_size);
+  ASSERT_TRUE(buf != NULL);
+  EXPECT_EQ(0, mempool_releasebuffer(handle, buf, item_size));
+  EXPECT_EQ(0, mempool_getinfo(handle, &pool_details));
+  EXPECT_EQ(0, pool_details.bufs_in_thread_caches);
+  EXPECT_EQ(pool_details.total_bufs_allocated_by_pool,
+            pool_details.free_bufs_in_pool);
+}
+
+TEST_F(MempoolThreadCacheTestSuite, ThreadExitReturnsCacheTest) {
+  EXPECT_EQ(0, mempool_create(FOUR_KB, 0, FOUR_KB, SIXTEEN_MB,
+                              (func_log_callback_type)NULL, ENABLE_THREAD_CACHE,
+                              &handle));
+  std::thread worker([this]() {
+    void *buf = mempool_getbuffer(handle, FOUR_KB);
+    ASSERT_TRUE(buf != NULL);
+    mempool_releasebuffer(handle, buf, FOUR_KB);
+  });
+  worker.join();
+
+  EXPECT_EQ(0, mempool_getinfo(handle, &pool_details));
+  EXPECT_EQ(0, pool_details.number_of_bufs_shared);
+  EXPECT_EQ(pool_details.total_bufs_allocated_by_pool,
+            pool_details.free_bufs_in_pool);
+}
+
+// Contention benchmark: compare global lock with thread caches.  Disabled,
+// run with --gtest_also_run_disabled_tests.
+TEST_F(MempoolThreadCacheTestSuite, DISABLED_ContentionBenchmarkTest) {
+  int failures = 0;
+
+  EXPECT_EQ(0, mempool_create(FOUR_KB, 0, FOUR_KB, SIXTEEN_MB,
+                              (func_log_callback_type)NULL, ENABLE_LOCKING,
+                              &handle));
+  long locked_ms = run_contention(&failures);
+  EXPECT_EQ(0, failures);
+  EXPECT_EQ(0, mempool_getinfo(handle, &pool_details));
+  EXPECT_EQ(0, pool_details.number_of_bufs_shared);
+  mempool_destroy(&handle);
+
+  EXPECT_EQ(0, mempool_create(FOUR_KB, 0, FOUR_KB, SIXTEEN_MB,
+                              (func_log_callback_type)NULL, ENABLE_THREAD_CACHE,
+                              &handle));
+  long cached_ms = run_contention(&failures);
+  EXPECT_EQ(0, failures);
+  // Worker threads are gone, their caches must be back in the pool.
+  EXPECT_EQ(0, mempool_getinfo(handle, &pool_details));
+  EXPECT_EQ(0, pool_details.number_of_bufs_shared);
+  EXPECT_EQ(pool_details.total_bufs_allocated_by_pool,
+            pool_details.free_bufs_in_pool);
+
+  std::cout << "[ BENCH    ] " << BENCH_THREADS << " threads x "
+            << BENCH_ITERATIONS * BENCH_WINDOW
+            << " get/release: ENABLE_LOCKING " << locked_ms
+            << " ms, ENABLE_THREAD_CACHE " << cached_ms << " ms" << std::endl;
+}
@@ -43,6 +43,7 @@ extern "C" {
 struct m0_uint128 global_bucket_list_index_oid;
 struct m0_uint128 bucket_metadata_list_index_oid;
 struct m0_uint128 global_probable_dead_object_list_index_oid;
+struct m0_uint128 bucket_usage_index_oid;
 struct m0_uint128 global_instance_id;
 pthread_t global_tid_indexop;
 pthread_t global_tid_objop;
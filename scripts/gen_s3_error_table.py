@@ -0,0 +1,135 @@
+#!/usr/bin/python3.6
+#
+# Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#    http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+# For any questions about this software or licensing,
+# please email opensource@seagate.com or cortx-questions@seagate.com.
+
+"""Generates server/s3_error_table.h from resources/s3_error_messages.json.
+
+Run from the repository root after editing the JSON:
+    python3 scripts/gen_s3_error_table.py
+"""
+
+import json
+import os
+import re
+import sys
+
+JSON_PATH = "resources/s3_error_messages.json"
+HEADER_PATH = "server/s3_error_table.h"
+WIDTH = 80
+
+LICENSE = """/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+"""
+
+PROLOGUE = """
+// Generated by scripts/gen_s3_error_table.py from
+// resources/s3_error_messages.json, do not edit.
+
+#pragma once
+
+#ifndef __S3_SERVER_S3_ERROR_TABLE_H__
+#define __S3_SERVER_S3_ERROR_TABLE_H__
+
+// X(code, HTTP status, description, <Message> element as S3XmlWriter
+// renders it), sorted by code.
+"""
+
+EPILOGUE = """
+#endif
+"""
+
+
+def xml_escape(value):
+    """Escapes the same characters as S3XmlWriter::escape()."""
+    entities = {"<": "&lt;", ">": "&gt;", "&": "&amp;", '"': "&quot;",
+                "\r": "&#13;"}
+    return "".join(entities.get(c, c) for c in value)
+
+
+def message_element(description):
+    if not description:
+        return "<Message/>"
+    return "<Message>" + xml_escape(description) + "</Message>"
+
+
+def c_literals(value, indent):
+    """Splits 'value' into C string literals which fit the line width."""
+    room = WIDTH - indent - len('"",  \\')
+    words = re.findall(r"\S*\s*", value)
+    chunks = [""]
+    for word in words:
+        if chunks[-1] and len(chunks[-1]) + len(word) > room:
+            chunks.append("")
+        chunks[-1] += word
+    return ['"' + chunk.replace("\\", "\\\\").replace('"', '\\"') + '"'
+            for chunk in chunks]
+
+
+def macro_lines(code, http_code, description):
+    indent = 4
+    lines = ["  X(%s, %d," % (code, http_code)]
+    for value in (description, message_element(description)):
+        literals = c_literals(value, indent)
+        lines += [" " * indent + literal for literal in literals]
+        lines[-1] += ","
+    lines[-1] = lines[-1][:-1] + ")"
+    return lines
+
+
+def main():
+    with open(JSON_PATH) as json_file:
+        errors = json.load(json_file)
+    for code, details in errors.items():
+        if not re.match(r"^[A-Za-z_][A-Za-z0-9_]*$", code):
+            sys.exit("Error code %s is not an identifier" % code)
+        if not isinstance(details.get("httpcode"), int):
+            sys.exit("Error code %s has no httpcode" % code)
+
+    lines = ["#define S3_ERROR_TABLE(X)"]
+    for code in sorted(errors):
+        # Entries without "Description" have always had empty message.
+        lines += macro_lines(code, errors[code]["httpcode"],
+                             errors[code].get("Description", ""))
+    body = "\n".join(line.ljust(WIDTH - 2) + " \\" for line in lines)
+    # Last line of the macro has no continuation.
+    body = body[:body.rindex("\\")].rstrip() + "\n"
+
+    with open(HEADER_PATH + ".tmp", "w") as header:
+        header.write(LICENSE + PROLOGUE + body + EPILOGUE)
+    os.rename(HEADER_PATH + ".tmp", HEADER_PATH)
+
+
+if __name__ == "__main__":
+    main()
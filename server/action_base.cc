@@ -62,6 +62,8 @@ Action::Action(std::shared_ptr<RequestObject> req, bool check_shutdown,
   s3_log(S3_LOG_DEBUG, request_id, "%s Ctor\n", __func__);
   task_iteration_index = 0;
   rollback_index = 0;
+  task_span = -1;
+  rollback_span = -1;
 
   state = ACTS_START;
   rollback_state = ACTS_START;
@@ -151,6 +153,7 @@ void Action::start() {
   if (task_list.size() > 0) {
     ADDB(get_addb_action_type_id(), addb_request_id,
          task_addb_id_list[task_iteration_index]);
+    track_next_task();
 
     task_list[task_iteration_index++]();
   }
@@ -174,6 +177,7 @@ void Action::next() {
       // independent of S3 client connection.
       ADDB(get_addb_action_type_id(), addb_request_id,
            task_addb_id_list[task_iteration_index]);
+      track_next_task();
 
       task_list[task_iteration_index++]();
     } else {
@@ -188,9 +192,18 @@ void Action::next() {
   }
 }
 
+void Action::track_next_task() {
+  const char* task_name = task_name_list[task_iteration_index];
+  S3RequestTrace& trace = base_request->get_trace();
+  trace.end(task_span);
+  task_span = trace.begin(task_name, S3TraceCategory::action);
+  base_request->set_current_task(task_name);
+}
+
 void Action::done() {
   task_iteration_index = 0;
   state = ACTS_COMPLETE;
+  base_request->get_trace().end(task_span);
   ADDB(get_addb_action_type_id(), addb_request_id, (uint64_t)state);
   i_am_done();
 }
@@ -211,6 +224,7 @@ void Action::abort() {
   // Mark state as Aborted.
   task_iteration_index = 0;
   state = ACTS_STOPPED;
+  base_request->get_trace().end(task_span);
   ADDB(get_addb_action_type_id(), addb_request_id, (uint64_t)state);
 }
 
@@ -225,6 +239,10 @@ void Action::rollback_start() {
   }
   rollback_index = 0;
   rollback_state = ACTS_RUNNING;
+  S3RequestTrace& trace = base_request->get_trace();
+  trace.end(task_span);
+  rollback_span = trace.begin("rollback", S3TraceCategory::action);
+  base_request->set_current_task("rollback");
   if (rollback_list.size())
     rollback_list[rollback_index++]();
   else {
@@ -249,6 +267,7 @@ void Action::rollback_done() {
   s3_log(S3_LOG_DEBUG, request_id, "%s Entry\n", __func__);
   rollback_index = 0;
   rollback_state = ACTS_COMPLETE;
+  base_request->get_trace().end(rollback_span);
   rollback_exit();
   s3_log(S3_LOG_DEBUG, "", "%s Exit", __func__);
 }
@@ -101,7 +101,12 @@ class Action {
   std::vector<std::function<void()>> task_list;
   // Holds task's addb index
   std::vector<uint64_t> task_addb_id_list;
+  // Holds task's name, used as span name in request trace
+  std::vector<const char*> task_name_list;
   size_t task_iteration_index;
+  // Request trace spans of the running task and of rollback
+  int task_span;
+  int rollback_span;
 
   // Hold member functions that will rollback
   // changes in event of error
@@ -128,6 +133,9 @@ class Action {
   S3Timer auth_timer;
 
   bool is_date_header_present_in_request() const;
+  // Ends trace span of the previous task and begins one for the task at
+  // task_iteration_index, which is also shown by in-flight request registry.
+  void track_next_task();
 
  protected:
   std::string request_id;
@@ -182,11 +190,13 @@ class Action {
     }
     task_list.push_back(std::move(task));
     task_addb_id_list.push_back(s3_task_name_to_addb_task_id_map[func_name]);
+    task_name_list.push_back(func_name);
   }
 
   void clear_tasks() {
     task_list.clear();
     task_addb_id_list.clear();
+    task_name_list.clear();
     task_iteration_index = 0;
   }
 
@@ -22,69 +22,246 @@
 #include <cctype>
 #include <string>
 #include "base64.h"
+#include "s3_simd.h"
+
+#ifdef S3_SIMD_X86
+#include <immintrin.h>
+#endif
 
 const char base64_chars[] =
     "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
     "abcdefghijklmnopqrstuvwxyz"
     "0123456789+/";
 
-std::string base64_encode(unsigned char const* bytes_to_encode,
-                          unsigned in_len) {
+#ifdef S3_SIMD_X86
+// Vector kernels follow W. Mula, D. Lemire, "Faster Base64 Encoding and
+// Decoding Using AVX2 Instructions".  Each 3 bytes are spread into 4 bytes
+// holding 6 bit indices, which are turned into characters by adding an
+// offset looked up by the index range, and back.  256 bit kernels work on
+// two independent 128 bit lanes.
 
-  std::string ret;
-  ret.reserve((in_len + 2) / 3 << 2);  // exact size
+// 16 characters of 12 bytes, in first 12 bytes of each 16 byte lane.
+S3_TARGET_SSE42 static inline __m128i encode_block_sse42(__m128i bytes) {
+  bytes = _mm_shuffle_epi8(
+      bytes, _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10));
+  const __m128i index_ac = _mm_mulhi_epu16(
+      _mm_and_si128(bytes, _mm_set1_epi32(0x0fc0fc00)),
+      _mm_set1_epi32(0x04000040));
+  const __m128i index_bd = _mm_mullo_epi16(
+      _mm_and_si128(bytes, _mm_set1_epi32(0x003f03f0)),
+      _mm_set1_epi32(0x01000010));
+  const __m128i indices = _mm_or_si128(index_ac, index_bd);
+  // 0..25 -> 13, 26..51 -> 0, 52..61 -> 1..10, 62 -> 11, 63 -> 12.
+  __m128i range = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+  range = _mm_or_si128(range,
+                       _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), indices),
+                                     _mm_set1_epi8(13)));
+  const __m128i offsets = _mm_setr_epi8(
+      'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+      '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+  return _mm_add_epi8(indices, _mm_shuffle_epi8(offsets, range));
+}
 
-  unsigned modulo_3 = 0;
-  int for_next = 0;  // -Wall
+S3_TARGET_AVX2 static inline __m256i encode_block_avx2(__m256i bytes) {
+  bytes = _mm256_shuffle_epi8(
+      bytes, _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11,
+                              10, 1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9,
+                              11, 10));
+  const __m256i index_ac = _mm256_mulhi_epu16(
+      _mm256_and_si256(bytes, _mm256_set1_epi32(0x0fc0fc00)),
+      _mm256_set1_epi32(0x04000040));
+  const __m256i index_bd = _mm256_mullo_epi16(
+      _mm256_and_si256(bytes, _mm256_set1_epi32(0x003f03f0)),
+      _mm256_set1_epi32(0x01000010));
+  const __m256i indices = _mm256_or_si256(index_ac, index_bd);
+  __m256i range = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+  range = _mm256_or_si256(
+      range, _mm256_and_si256(_mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices),
+                              _mm256_set1_epi8(13)));
+  const __m256i offsets = _mm256_broadcastsi128_si256(_mm_setr_epi8(
+      'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+      '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0));
+  return _mm256_add_epi8(indices, _mm256_shuffle_epi8(offsets, range));
+}
 
-  for (unsigned i = 0; i < in_len; ++i) {
-    const int cur_ch = *(bytes_to_encode + i);
+// Encodes whole blocks, loads read 4 bytes past the 12 bytes encoded.
+S3_TARGET_SSE42 static void encode_sse42(const unsigned char*& in,
+                                         const unsigned char* end, char*& out) {
+  for (; end - in >= 16; in += 12, out += 16) {
+    const __m128i bytes = _mm_loadu_si128((const __m128i*)in);
+    _mm_storeu_si128((__m128i*)out, encode_block_sse42(bytes));
+  }
+}
 
-    switch (modulo_3) {
-      case 0:
-        ret += base64_chars[cur_ch >> 2 & 0x3F];
-        for_next = (cur_ch & 3) << 4;
-        break;
-      case 1:
-        assert(!(for_next & ~0x30));
-        ret += base64_chars[for_next | (cur_ch >> 4 & 0xF)];
-        for_next = (cur_ch & 0x0F) << 2;
-        break;
-      case 2:
-        assert(!(for_next & ~0x3C));
-        ret += base64_chars[for_next | (cur_ch >> 6 & 3)];
-        ret += base64_chars[cur_ch & 0x3F];
-        break;
-      default:
-        assert(0);
+S3_TARGET_AVX2 static void encode_avx2(const unsigned char*& in,
+                                       const unsigned char* end, char*& out) {
+  for (; end - in >= 28; in += 24, out += 32) {
+    const __m256i bytes = _mm256_inserti128_si256(
+        _mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)in)),
+        _mm_loadu_si128((const __m128i*)(in + 12)), 1);
+    _mm256_storeu_si256((__m256i*)out, encode_block_avx2(bytes));
+  }
+}
+
+// Decodes whole blocks of base64 characters, stops at a block with any other
+// character (padding, space or illegal) for the scalar code to handle it.
+// Stores write 4 (8 for AVX2) bytes past the decoded ones.
+S3_TARGET_SSE42 static void decode_sse42(const char*& in, const char* end,
+                                         char*& out) {
+  for (; end - in >= 16; in += 16, out += 12) {
+    const __m128i chars = _mm_loadu_si128((const __m128i*)in);
+    // Signed compares, so bytes above 0x7f are in no range.
+    const __m128i upper =
+        _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8('A' - 1)),
+                      _mm_cmplt_epi8(chars, _mm_set1_epi8('Z' + 1)));
+    const __m128i lower =
+        _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8('a' - 1)),
+                      _mm_cmplt_epi8(chars, _mm_set1_epi8('z' + 1)));
+    const __m128i digit =
+        _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8('0' - 1)),
+                      _mm_cmplt_epi8(chars, _mm_set1_epi8('9' + 1)));
+    const __m128i plus = _mm_cmpeq_epi8(chars, _mm_set1_epi8('+'));
+    const __m128i slash = _mm_cmpeq_epi8(chars, _mm_set1_epi8('/'));
+    const __m128i valid = _mm_or_si128(
+        _mm_or_si128(_mm_or_si128(upper, lower), _mm_or_si128(digit, plus)),
+        slash);
+    if (_mm_movemask_epi8(valid) != 0xFFFF) {
+      return;
     }
-    if (++modulo_3 > 2) {
-      modulo_3 = 0;
+    const __m128i offsets = _mm_or_si128(
+        _mm_or_si128(_mm_and_si128(upper, _mm_set1_epi8(-'A')),
+                     _mm_and_si128(lower, _mm_set1_epi8(26 - 'a'))),
+        _mm_or_si128(
+            _mm_or_si128(_mm_and_si128(digit, _mm_set1_epi8(52 - '0')),
+                         _mm_and_si128(plus, _mm_set1_epi8(62 - '+'))),
+            _mm_and_si128(slash, _mm_set1_epi8(63 - '/'))));
+    const __m128i indices = _mm_add_epi8(chars, offsets);
+    // 4 indices -> 24 bit value in each 32 bit word -> 3 big endian bytes.
+    const __m128i pairs =
+        _mm_maddubs_epi16(indices, _mm_set1_epi32(0x01400140));
+    const __m128i words = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+    const __m128i bytes = _mm_shuffle_epi8(
+        words,
+        _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+    _mm_storeu_si128((__m128i*)out, bytes);
+  }
+}
+
+S3_TARGET_AVX2 static void decode_avx2(const char*& in, const char* end,
+                                       char*& out) {
+  for (; end - in >= 32; in += 32, out += 24) {
+    const __m256i chars = _mm256_loadu_si256((const __m256i*)in);
+    const __m256i upper =
+        _mm256_and_si256(_mm256_cmpgt_epi8(chars, _mm256_set1_epi8('A' - 1)),
+                         _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), chars));
+    const __m256i lower =
+        _mm256_and_si256(_mm256_cmpgt_epi8(chars, _mm256_set1_epi8('a' - 1)),
+                         _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), chars));
+    const __m256i digit =
+        _mm256_and_si256(_mm256_cmpgt_epi8(chars, _mm256_set1_epi8('0' - 1)),
+                         _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), chars));
+    const __m256i plus = _mm256_cmpeq_epi8(chars, _mm256_set1_epi8('+'));
+    const __m256i slash = _mm256_cmpeq_epi8(chars, _mm256_set1_epi8('/'));
+    const __m256i valid = _mm256_or_si256(
+        _mm256_or_si256(_mm256_or_si256(upper, lower),
+                        _mm256_or_si256(digit, plus)),
+        slash);
+    if ((unsigned)_mm256_movemask_epi8(valid) != 0xFFFFFFFFu) {
+      return;
     }
+    const __m256i offsets = _mm256_or_si256(
+        _mm256_or_si256(_mm256_and_si256(upper, _mm256_set1_epi8(-'A')),
+                        _mm256_and_si256(lower, _mm256_set1_epi8(26 - 'a'))),
+        _mm256_or_si256(
+            _mm256_or_si256(
+                _mm256_and_si256(digit, _mm256_set1_epi8(52 - '0')),
+                _mm256_and_si256(plus, _mm256_set1_epi8(62 - '+'))),
+            _mm256_and_si256(slash, _mm256_set1_epi8(63 - '/'))));
+    const __m256i indices = _mm256_add_epi8(chars, offsets);
+    const __m256i pairs =
+        _mm256_maddubs_epi16(indices, _mm256_set1_epi32(0x01400140));
+    const __m256i words =
+        _mm256_madd_epi16(pairs, _mm256_set1_epi32(0x00011000));
+    const __m256i lane_bytes = _mm256_shuffle_epi8(
+        words, _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1,
+                                -1, -1, 2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12,
+                                -1, -1, -1, -1));
+    // Join 12 bytes of each lane.
+    const __m256i bytes = _mm256_permutevar8x32_epi32(
+        lane_bytes, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+    _mm256_storeu_si256((__m256i*)out, bytes);
   }
-  assert(modulo_3 < 3);
+}
+#endif
+
+std::string base64_encode(unsigned char const* bytes_to_encode,
+                          unsigned in_len) {
 
-  if (modulo_3) {
-    assert(!(for_next & ~0x3F));
-    ret += base64_chars[for_next];
-    ret += '=';
+  std::string ret((in_len + 2) / 3 << 2, '\0');  // exact size
+  char* out = &ret[0];
+  const unsigned char* in = bytes_to_encode;
+  const unsigned char* const end = in + in_len;
 
-    if (1 == modulo_3) {
-      ret += '=';
+#ifdef S3_SIMD_X86
+  const S3SimdLevel level = s3_simd_level();
+  if (level >= S3SimdLevel::avx2) {
+    encode_avx2(in, end, out);
+  }
+  if (level >= S3SimdLevel::sse42) {
+    encode_sse42(in, end, out);
+  }
+#endif
+  for (; end - in >= 3; in += 3, out += 4) {
+    out[0] = base64_chars[in[0] >> 2];
+    out[1] = base64_chars[(in[0] & 3) << 4 | in[1] >> 4];
+    out[2] = base64_chars[(in[1] & 0x0F) << 2 | in[2] >> 6];
+    out[3] = base64_chars[in[2] & 0x3F];
+  }
+  if (in < end) {
+    const int for_next = (in[0] & 3) << 4;
+    out[0] = base64_chars[in[0] >> 2];
+    if (end - in == 1) {
+      out[1] = base64_chars[for_next];
+      out[2] = '=';
+    } else {
+      out[1] = base64_chars[for_next | in[1] >> 4];
+      out[2] = base64_chars[(in[1] & 0x0F) << 2];
     }
+    out[3] = '=';
   }
   return ret;
 }
 
 std::string base64_decode(const std::string& encoded_string) {
 
-  std::string ret;
-  ret.reserve(((encoded_string.length() + 3) >> 2) * 3);  // roughly
+  // Vector kernels store whole registers past the decoded bytes.
+  std::string ret(((encoded_string.length() + 3) >> 2) * 3 + 8, '\0');
+  char* const begin = &ret[0];
+  char* out = begin;
+  const char* in = encoded_string.data();
+  const char* const end = in + encoded_string.length();
 
   unsigned modulo_4 = 0;
   int current_byte = 0;  // -Wall
+#ifdef S3_SIMD_X86
+  const S3SimdLevel level = s3_simd_level();
+#endif
 
-  for (const char ch : encoded_string) {
+  while (in < end) {
+#ifdef S3_SIMD_X86
+    if (!modulo_4) {
+      if (level >= S3SimdLevel::avx2) {
+        decode_avx2(in, end, out);
+      }
+      if (level >= S3SimdLevel::sse42) {
+        decode_sse42(in, end, out);
+      }
+      if (in == end) {
+        break;
+      }
+    }
+#endif
+    const char ch = *in++;
 
     if (isspace(ch)) {
       if (modulo_4) {
@@ -115,22 +292,23 @@ std::string base64_decode(const std::string& encoded_string) {
         break;
       case 1:
         assert(!(current_byte & 3));
-        ret += static_cast<char>(current_byte | (decoded >> 4 & 3));
+        *out++ = static_cast<char>(current_byte | (decoded >> 4 & 3));
         current_byte = decoded << 4;
         break;
       case 2:
         assert(!(current_byte & 0x0F));
-        ret += static_cast<char>(current_byte | (decoded >> 2 & 0x0F));
+        *out++ = static_cast<char>(current_byte | (decoded >> 2 & 0x0F));
         current_byte = decoded << 6;
         break;
       case 3:
         assert(!(current_byte & 0x3F));
-        ret += static_cast<char>(current_byte | (decoded & 0x3F));
+        *out++ = static_cast<char>(current_byte | (decoded & 0x3F));
         break;
       default:
         assert(0);
     }
     if (++modulo_4 > 3) modulo_4 = 0;
   }
+  ret.resize(out - begin);
   return ret;
 }
@@ -25,6 +25,7 @@
 #include "s3_m0_uint128_helper.h"
 #include "s3_factory.h"
 #include "s3_iem.h"
+#include "s3_motr_emulator.h"
 #define MAX_THREAD 20
 
 static struct m0_client *motr_instance = NULL;
@@ -50,6 +51,9 @@ int init_motr(void) {
   s3_log(S3_LOG_INFO, "", "%s Entry\n", __func__);
   int rc;
   S3Option *option_instance = S3Option::get_instance();
+  if (option_instance->is_motr_emulator_enabled()) {
+    return s3_motr_emulator_init();
+  }
   /* MOTR_DEFAULT_EP, MOTR_DEFAULT_HA_ADDR*/
   motr_conf.mc_is_oostore = option_instance->get_motr_is_oostore();
   motr_conf.mc_is_read_verify = option_instance->get_motr_is_read_verify();
@@ -131,6 +135,10 @@ int init_motr(void) {
 
 void fini_motr(void) {
   s3_log(S3_LOG_INFO, "", "%s Entry\n", __func__);
+  if (s3_motr_emulator()) {
+    s3_motr_emulator_fini();
+    return;
+  }
   m0_ufid_fini(&s3_ufid_generator);
   m0_client_fini(motr_instance, true);
   s3_log(S3_LOG_INFO, "", "%s Exit", __func__);
@@ -176,6 +184,10 @@ void teardown_motr_cancel_wait_op(struct m0_op *op, int sec) {
     free(op);
     return;
   }
+  if (S3MotrEmulator *emulator = s3_motr_emulator()) {
+    emulator->op_free(op);
+    return;
+  }
 
   if (M0_OS_LAUNCHED == op->op_sm.sm_state) {
     m0_op_cancel(&op, 1);
@@ -43,7 +43,9 @@ uint64_t RequestObject::addb_request_id_gc = S3_ADDB_FIRST_GENERIC_REQUESTS_ID;
 /* evhtp_kvs_iterator */
 extern "C" int consume_header(evhtp_kv_t* kvobj, void* arg) {
   RequestObject* request = (RequestObject*)arg;
-  request->in_headers_copy[kvobj->key] = kvobj->val ? kvobj->val : "";
+  auto header = request->in_headers_copy.emplace(kvobj->key, "").first;
+  header->second = kvobj->val ? kvobj->val : "";
+  request->in_headers_index.add(header->first.c_str(), &header->second);
   if (kvobj->key != NULL) {
     request->header_size += strlen(kvobj->key);
     if (strncasecmp(kvobj->key, "x-amz-meta-", strlen("x-amz-meta-")) == 0) {
@@ -127,7 +129,8 @@ RequestObject::RequestObject(
       // proper globally unique IDs here.  Specifically, we'll need to address
       // uniqueness across all instances of S3 Server.
       addb_request_id(++addb_request_id_gc),
-      reply_buffer(NULL) {
+      reply_buffer(NULL),
+      trace(g_option_instance->is_request_trace_enabled()) {
 
   S3Uuid uuid;
   request_id = uuid.get_string_uuid();
@@ -137,6 +140,7 @@ RequestObject::RequestObject(
   s3_log(S3_LOG_INFO, request_id, "stripped_request_id:%s\n",
          stripped_request_id.c_str());
   request_timer.start();
+  arrival_time = std::chrono::steady_clock::now();
 
   ADDB(S3_ADDB_REQUEST_ID, addb_request_id, *(const uint64_t*)(uuid.ptr()),
        *(const uint64_t*)(uuid.ptr() + sizeof(uint64_t)));
@@ -157,6 +161,7 @@ RequestObject::RequestObject(
       g_option_instance->get_libevent_pool_buffer_size());
 
   turn_around_time.start();
+  s3_request_registry_add(this);
   // Prepare timers for multiple resume()-stop() cycles.
   paused_timer.start();
   paused_timer.stop();
@@ -212,7 +217,7 @@ RequestObject::RequestObject(
 
 void RequestObject::initialise() {
   s3_log(S3_LOG_DEBUG, request_id, "Initializing the request.\n");
-  if (get_header_value("x-amz-content-sha256") ==
+  if (get_known_header(S3Header::x_amz_content_sha256) ==
       "STREAMING-AWS4-HMAC-SHA256-PAYLOAD") {
     is_chunked_upload = true;
   }
@@ -226,6 +231,7 @@ void RequestObject::initialise() {
 
 RequestObject::~RequestObject() {
   s3_log(S3_LOG_DEBUG, request_id, "%s\n", __func__);
+  s3_request_registry_remove(this);
 
   if (ev_req) {
     ev_req->cbarg = NULL;
@@ -236,6 +242,7 @@ RequestObject::~RequestObject() {
     reply_buffer = NULL;
   }
   free_client_read_timer();
+  trace.finish(request_id);
 }
 
 const std::map<std::string, std::string, compare>&
@@ -257,6 +264,37 @@ RequestObject::get_query_parameters() {
 
 S3HttpVerb RequestObject::http_verb() { return http_method; }
 
+void RequestObject::async_op_started(const char* op_name) {
+  async_op = op_name;
+  async_op_start_time = std::chrono::steady_clock::now();
+  ++async_ops_count;
+}
+
+void RequestObject::async_op_finished() {
+  if (async_ops_count && !--async_ops_count) {
+    async_op = nullptr;
+  }
+}
+
+void RequestObject::describe(S3InFlightRequestInfo& info) {
+  const auto now = std::chrono::steady_clock::now();
+  info.request_id = request_id;
+  info.method = get_http_verb_str(http_method);
+  info.uri = full_path_decoded_uri;
+  info.task = current_task ? current_task : "";
+  info.async_ops_count = async_ops_count;
+  info.async_op = async_op ? async_op : "";
+  info.async_op_elapsed_us =
+      async_ops_count ? std::chrono::duration_cast<std::chrono::microseconds>(
+                            now - async_op_start_time).count()
+                      : 0;
+  info.elapsed_us =
+      std::chrono::duration_cast<std::chrono::microseconds>(now - arrival_time)
+          .count();
+  info.bytes_received = total_bytes_received;
+  info.bytes_sent = bytes_sent;
+}
+
 const char* RequestObject::get_http_verb_str(S3HttpVerb method) {
   return htparser_get_methodstr_m((htp_method)method);
 }
@@ -377,21 +415,20 @@ std::map<std::string, std::string>& RequestObject::get_in_headers_copy() {
 }
 
 std::string RequestObject::get_header_value(std::string key) {
-
-  std::string val_str;
   if (!in_headers_copied) {
     get_in_headers_copy();
   }
+  const std::string* value = in_headers_index.find(key.c_str());
+  return value ? *value : std::string();
+}
 
-  auto header = in_headers_copy.begin();
-  while (header != in_headers_copy.end()) {
-    if (!strcasecmp(header->first.c_str(), key.c_str())) {
-      val_str = header->second.c_str();
-      break;
-    }
-    header++;
+const std::string& RequestObject::get_known_header(S3Header header) {
+  static const std::string empty;
+  if (!in_headers_copied) {
+    RequestObject::get_in_headers_copy();
   }
-  return val_str;
+  const std::string* value = in_headers_index.find(header);
+  return value ? *value : empty;
 }
 
 bool RequestObject::is_valid_ipaddress(std::string& ipaddr) {
@@ -410,8 +447,7 @@ bool RequestObject::is_valid_ipaddress(std::string& ipaddr) {
 }
 
 std::string RequestObject::get_host_header() {
-  std::string host = "Host";
-  return get_header_value(host);
+  return get_known_header(S3Header::host);
 }
 
 std::string RequestObject::get_host_name() {
@@ -465,9 +501,8 @@ void RequestObject::set_out_header_value(std::string key, std::string value) {
 }
 
 std::string RequestObject::get_data_length_str() {
-  std::string data_length_key = "x-amz-decoded-content-length";
-  std::string data_length = get_header_value(data_length_key);
-  data_length = S3CommonUtilities::trim(data_length);
+  std::string data_length = S3CommonUtilities::trim(
+      get_known_header(S3Header::x_amz_decoded_content_length));
   if (data_length.empty()) {
     // Normal request
     return get_content_length_str();
@@ -481,9 +516,8 @@ size_t RequestObject::get_data_length() {
 }
 
 std::string RequestObject::get_content_length_str() {
-  std::string content_length = "Content-Length";
-  std::string len = get_header_value(content_length);
-  len = S3CommonUtilities::trim(len);
+  std::string len =
+      S3CommonUtilities::trim(get_known_header(S3Header::content_length));
   if (len.empty()) {
     len = "0";
   }
@@ -530,8 +564,8 @@ bool RequestObject::validate_content_length() {
   // return if content length is not valid
   if (!is_content_length_valid) return is_content_length_valid;
 
-  std::string data_length_key = "x-amz-decoded-content-length";
-  std::string data_length = get_header_value(data_length_key);
+  const std::string& data_length =
+      get_known_header(S3Header::x_amz_decoded_content_length);
   if (!data_length.empty()) {
     is_content_length_valid =
         S3CommonUtilities::stoul(data_length, content_length);
@@ -698,6 +732,7 @@ void RequestObject::notify_incoming_data(evbuf_t* buf) {
   } else {
     pending_in_flight -= data_bytes_received;
   }
+  total_bytes_received += data_bytes_received;
   s3_log(S3_LOG_DEBUG, request_id, "pending_in_flight (after): %zu\n",
          pending_in_flight);
   if (pending_in_flight == 0) {
@@ -747,6 +782,7 @@ void RequestObject::send_response(int code, std::string body) {
 
   http_status = code;
   turn_around_time.stop();
+  trace.responded();
 
   if (code == S3HttpFailed500) {
     s3_stats_inc("internal_error_count");
@@ -805,6 +841,7 @@ void RequestObject::send_reply_start(int code) {
 
 void RequestObject::send_reply_body(const char* data, int length) {
   if (client_connected()) {
+    bytes_sent += length;
     evbuffer_add(reply_buffer, data, length);
     evhtp_obj->http_send_reply_body(ev_req, reply_buffer);
   } else {
@@ -821,6 +858,7 @@ void RequestObject::send_reply_body(struct evbuffer* p_reply_buffer) {
     return;
   }
   if (client_connected()) {
+    bytes_sent += evbuffer_get_length(p_reply_buffer);
     evhtp_obj->http_send_reply_body(ev_req, p_reply_buffer);
   } else {
     request_timer.stop();
@@ -836,6 +874,7 @@ void RequestObject::send_reply_body(struct evbuffer* p_reply_buffer) {
 }
 
 void RequestObject::send_reply_end() {
+  trace.responded();
   if (client_connected()) {
     evhtp_obj->http_send_reply_end(ev_req);
   }
@@ -942,18 +981,8 @@ void RequestObject::respond_retry_after(int retry_after_in_secs) {
 }
 
 bool RequestObject::is_header_present(const std::string& key) {
-  bool header_present = false;
   if (!in_headers_copied) {
     get_in_headers_copy();
   }
-
-  auto header = in_headers_copy.begin();
-  while (header != in_headers_copy.end()) {
-    if (!strcasecmp(header->first.c_str(), key.c_str())) {
-      header_present = true;
-      break;
-    }
-    header++;
-  }
-  return header_present;
+  return in_headers_index.find(key.c_str()) != nullptr;
 }
@@ -36,11 +36,15 @@
 #include "evhtp_wrapper.h"
 #include "event_wrapper.h"
 
+#include "s3_admission_controller.h"
 #include "s3_async_buffer_opt.h"
+#include "s3_header_index.h"
 #include "s3_chunk_payload_parser.h"
 #include "s3_log.h"
 #include "s3_option.h"
 #include "s3_perf_logger.h"
+#include "s3_request_registry.h"
+#include "s3_request_trace.h"
 #include "s3_timer.h"
 #include "s3_uuid.h"
 
@@ -116,6 +120,13 @@ class RequestObject {
   bool is_chunked_upload;
   S3ChunkPayloadParser chunk_parser;
   std::shared_ptr<S3AsyncBufferOptContainerFactory> async_buffer_factory;
+  // Memory footprint charged by admission control, returned when request
+  // object is destroyed.
+  std::unique_ptr<S3AdmissionTicket> admission_ticket;
+  // Admission queue the request waits in, the request leaves it when the
+  // client disconnects.
+  std::weak_ptr<S3AdmissionController> admission_queue;
+  uint64_t admission_waiter_id = 0;
 
   virtual void set_full_path(const char* full_path);
   virtual void set_file_name(const char* file_name);
@@ -150,6 +161,8 @@ class RequestObject {
  protected:
   // protected so mocks can override
   std::map<std::string, std::string> in_headers_copy;
+  // Case insensitive index of in_headers_copy.
+  S3HeaderIndex in_headers_index;
   std::map<std::string, std::string> out_headers_copy;
   // in_query_params_copy will have (eg:query: prefix=abc)
   // key as query parameter key (prefix)
@@ -171,6 +184,9 @@ class RequestObject {
   friend int consume_query_parameters(evhtp_kv_t* kvobj, void* arg);
 
   virtual std::string get_header_value(std::string key);
+  // Fast lookup of well-known header, returns empty string if the header is
+  // absent.  Unlike get_header_value() it can't be mocked.
+  const std::string& get_known_header(S3Header header);
   virtual std::string get_host_header();
   virtual std::string get_host_name();
 
@@ -290,6 +306,13 @@ class RequestObject {
       ev_req->cbarg = NULL;
       ev_req = NULL;
     }
+    if (admission_waiter_id) {
+      auto ctrl = admission_queue.lock();
+      if (ctrl) {
+        ctrl->cancel(admission_waiter_id);
+      }
+      admission_waiter_id = 0;
+    }
   }
 
   bool is_incoming_data_ignored() const { return ignore_incoming_data; }
@@ -301,6 +324,16 @@ class RequestObject {
 
   bool client_connected() const { return is_client_connected; }
 
+  void set_admission_ticket(std::unique_ptr<S3AdmissionTicket> ticket) {
+    admission_ticket = std::move(ticket);
+    admission_waiter_id = 0;
+  }
+  void set_admission_waiter(std::weak_ptr<S3AdmissionController> ctrl,
+                            uint64_t waiter_id) {
+    admission_queue = std::move(ctrl);
+    admission_waiter_id = waiter_id;
+  }
+
   bool is_s3_client_read_error() const { return !s3_client_read_error.empty(); }
   const std::string& get_s3_client_read_error() const {
     return s3_client_read_error;
@@ -348,6 +381,27 @@ class RequestObject {
   // Response Helpers
  private:
   struct evbuffer* reply_buffer;
+  // Timeline of the request, saved if the request is slow.
+  S3RequestTrace trace;
+
+  // Progress of the request, shown by S3RequestRegistry.
+  std::chrono::steady_clock::time_point arrival_time;
+  const char* current_task = nullptr;
+  const char* async_op = nullptr;
+  std::chrono::steady_clock::time_point async_op_start_time;
+  unsigned async_ops_count = 0;
+
+ public:
+  S3RequestTrace& get_trace() { return trace; }
+
+  std::chrono::steady_clock::time_point get_arrival_time() const {
+    return arrival_time;
+  }
+  // Arguments must be string literals.
+  void set_current_task(const char* task) { current_task = task; }
+  void async_op_started(const char* op_name);
+  void async_op_finished();
+  virtual void describe(S3InFlightRequestInfo& info);
 
  public:
   virtual void send_response(int code, std::string body = "");
@@ -54,6 +54,20 @@ void S3Action::setup_steps() {
 void S3Action::load_metadata() { next(); }
 void S3Action::set_authorization_meta() { next(); }
 
+bool S3Action::is_mgmt_api_admin() {
+  if (S3Option::get_instance()->is_auth_disabled()) {
+    return true;
+  }
+  // Every account has a root user, so only the one of the configured admin
+  // account is let in.  Authentication step, which sets the user name and
+  // account, is run only when Authorization header is present.
+  const std::string& admin_account_id =
+      S3Option::get_instance()->get_mgmt_api_admin_account_id();
+  return is_authorizationheader_present && !admin_account_id.empty() &&
+         request->get_account_id() == admin_account_id &&
+         request->get_user_name() == "root";
+}
+
 void S3Action::check_authorization() {
   s3_log(S3_LOG_DEBUG, request_id, "%s Entry\n", __func__);
 
@@ -70,6 +70,11 @@ class S3Action : public Action {
   void check_authorization_successful();
   void check_authorization_failed();
 
+  // Management APIs which expose data of all accounts are allowed only for
+  // the authenticated root user of S3_MGMT_API_ADMIN_ACCOUNT_ID account (or
+  // when auth is disabled).
+  bool is_mgmt_api_admin();
+
   void fetch_acl_policies();
   void fetch_acl_bucket_policies_failed();
   void fetch_acl_object_policies_failed();
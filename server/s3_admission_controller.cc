@@ -0,0 +1,327 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+#include <errno.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "atexit.h"
+#include "s3_admission_controller.h"
+#include "s3_log.h"
+#include "s3_memory_pool.h"
+#include "s3_option.h"
+#include "s3_stats.h"
+
+extern S3Option* g_option_instance;
+
+// Interval at which deadlines of queued requests are checked.
+#define S3_ADMISSION_TICK_INTERVAL_MSEC 50
+
+S3AdmissionTicket::~S3AdmissionTicket() {
+  auto ctrl = controller.lock();
+  if (ctrl) {
+    ctrl->release(footprint);
+  }
+}
+
+S3AdmissionPriority s3_admission_priority(size_t data_footprint,
+                                          size_t small_request_size) {
+  if (data_footprint == 0) {
+    return S3AdmissionPriority::metadata;
+  }
+  if (data_footprint <= small_request_size) {
+    return S3AdmissionPriority::small;
+  }
+  return S3AdmissionPriority::large;
+}
+
+S3AdmissionController::S3AdmissionController(
+    std::shared_ptr<EventInterface> event_obj_ptr, evbase_t* evbase_,
+    size_t budget_bytes, size_t reserve_bytes, size_t max_queue_len,
+    unsigned max_wait_ms, FreeSpaceCallback free_space_cb)
+    : RecurringEventBase(event_obj_ptr, evbase_),
+      event_obj(std::move(event_obj_ptr)),
+      evbase(evbase_),
+      budget(budget_bytes),
+      reserve(reserve_bytes),
+      max_queue_length(max_queue_len),
+      max_wait(max_wait_ms),
+      get_free_space(std::move(free_space_cb)) {
+  s3_log(S3_LOG_INFO, "",
+         "Admission control: budget = %zu reserve = %zu max queue length = "
+         "%zu max wait = %u ms\n",
+         budget, reserve, max_queue_length, max_wait_ms);
+  if (event_obj && evbase) {
+    drain_event = event_obj->new_event(evbase, -1, 0, drain_event_cb, this);
+  }
+}
+
+S3AdmissionController::~S3AdmissionController() {
+  if (drain_event && event_obj) {
+    event_obj->del_event(drain_event);
+    event_obj->free_event(drain_event);
+    drain_event = nullptr;
+  }
+}
+
+bool S3AdmissionController::fits(size_t footprint) {
+  // Let at least one request through, whatever its size, so that a request
+  // larger than the whole budget does not wait forever.
+  if (inflight_requests > 0 && inflight_footprint + footprint > budget) {
+    return false;
+  }
+  if (get_free_space && get_free_space() < reserve + footprint) {
+    return false;
+  }
+  return true;
+}
+
+void S3AdmissionController::admit(Waiter& waiter) {
+  inflight_footprint += waiter.footprint;
+  inflight_requests++;
+  std::unique_ptr<S3AdmissionTicket> ticket(
+      new S3AdmissionTicket(shared_from_this(), waiter.footprint));
+  waiter.on_admit(std::move(ticket));
+}
+
+void S3AdmissionController::shed(Waiter& waiter) {
+  s3_stats_inc("admission_shed_count");
+  if (waiter.on_shed) {
+    waiter.on_shed();
+  }
+}
+
+S3AdmissionResult S3AdmissionController::submit(size_t footprint,
+                                                S3AdmissionPriority priority,
+                                                AdmitCallback on_admit,
+                                                ShedCallback on_shed,
+                                                uint64_t* waiter_id) {
+  Waiter waiter;
+  waiter.id = next_waiter_id++;
+  waiter.footprint = footprint;
+  waiter.enqueue_time = std::chrono::steady_clock::now();
+  waiter.on_admit = std::move(on_admit);
+  waiter.on_shed = std::move(on_shed);
+
+  // Do not overtake queued requests of same or higher priority.
+  bool waiting_ahead = false;
+  for (int prio = 0; prio <= (int)priority; ++prio) {
+    if (!queues[prio].empty()) {
+      waiting_ahead = true;
+      break;
+    }
+  }
+  if (!waiting_ahead && fits(footprint)) {
+    admit(waiter);
+    publish_gauges();
+    return S3AdmissionResult::admitted;
+  }
+
+  if (queue_length >= max_queue_length) {
+    // Make room by shedding the newest waiter of the lowest priority class
+    // below the priority of this request.
+    int victim = (int)S3AdmissionPriority::count - 1;
+    while (victim > (int)priority && queues[victim].empty()) {
+      --victim;
+    }
+    if (victim <= (int)priority) {
+      s3_stats_inc("admission_rejected_count");
+      return S3AdmissionResult::rejected;
+    }
+    Waiter evicted = std::move(queues[victim].back());
+    queues[victim].pop_back();
+    queue_length--;
+    shed(evicted);
+  }
+
+  if (waiter_id) {
+    *waiter_id = waiter.id;
+  }
+  queues[(int)priority].push_back(std::move(waiter));
+  queue_length++;
+  s3_stats_inc("admission_queued_count");
+  publish_gauges();
+  return S3AdmissionResult::queued;
+}
+
+bool S3AdmissionController::cancel(uint64_t waiter_id) {
+  for (auto& queue : queues) {
+    for (auto it = queue.begin(); it != queue.end(); ++it) {
+      if (it->id != waiter_id) {
+        continue;
+      }
+      cancelled.push_back(std::move(*it));
+      queue.erase(it);
+      queue_length--;
+      s3_stats_inc("admission_cancelled_count");
+      publish_gauges();
+      // Lower priority waiters may fit now, and cancelled ones are freed.
+      schedule_drain();
+      return true;
+    }
+  }
+  return false;
+}
+
+void S3AdmissionController::free_cancelled() {
+  // Request object may be destroyed here, keep the list consistent for it.
+  std::vector<Waiter> waiters;
+  waiters.swap(cancelled);
+}
+
+void S3AdmissionController::release(size_t footprint) {
+  inflight_footprint -= std::min(footprint, inflight_footprint);
+  if (inflight_requests > 0) {
+    inflight_requests--;
+  }
+  if (queue_length > 0) {
+    schedule_drain();
+  }
+}
+
+void S3AdmissionController::schedule_drain() {
+  if (drain_scheduled || !drain_event) {
+    // Otherwise the next tick will pick it up.
+    return;
+  }
+  struct timeval tv = {0, 0};
+  event_obj->add_event(drain_event, &tv);
+  drain_scheduled = true;
+}
+
+void S3AdmissionController::drain_event_cb(evutil_socket_t fd, short event,
+                                           void* arg) {
+  S3AdmissionController* ctrl = static_cast<S3AdmissionController*>(arg);
+  ctrl->drain_scheduled = false;
+  ctrl->drain();
+}
+
+void S3AdmissionController::drain() {
+  free_cancelled();
+  for (auto& queue : queues) {
+    while (!queue.empty()) {
+      if (!fits(queue.front().footprint)) {
+        // Strict priority order, lower classes keep waiting as well.
+        publish_gauges();
+        return;
+      }
+      Waiter waiter = std::move(queue.front());
+      queue.pop_front();
+      queue_length--;
+      auto waited = std::chrono::duration_cast<std::chrono::milliseconds>(
+          std::chrono::steady_clock::now() - waiter.enqueue_time);
+      s3_stats_timing("admission_wait_time", waited.count());
+      admit(waiter);
+    }
+  }
+  publish_gauges();
+}
+
+void S3AdmissionController::shed_expired(
+    std::chrono::steady_clock::time_point now) {
+  for (auto& queue : queues) {
+    // Waiters of a class are in enqueue order, so expired ones are in front.
+    while (!queue.empty() && now - queue.front().enqueue_time >= max_wait) {
+      Waiter waiter = std::move(queue.front());
+      queue.pop_front();
+      queue_length--;
+      shed(waiter);
+    }
+  }
+}
+
+void S3AdmissionController::publish_gauges() {
+  s3_stats_set_gauge("admission_queue_length", (int)queue_length);
+  s3_stats_set_gauge("admission_inflight_requests", (int)inflight_requests);
+}
+
+void S3AdmissionController::action_callback(void) noexcept {
+  free_cancelled();
+  if (queue_length == 0) {
+    return;
+  }
+  // Memory may be returned to the pool without any request finishing.
+  drain();
+  shed_expired();
+  publish_gauges();
+}
+
+static std::shared_ptr<S3AdmissionController> gs_admission_controller;
+
+static size_t libevent_mempool_free_space() {
+  size_t free_space = 0;
+  event_mempool_free_space(&free_space);
+  return free_space;
+}
+
+int s3_admission_init(evbase_t* evbase) {
+  struct timeval tv;
+  if (!g_option_instance->is_admission_control_enabled()) {
+    return 0;
+  }
+  s3_log(S3_LOG_INFO, "", "%s Entry", __func__);
+
+  AtExit call_fini([]() { s3_admission_fini(); });
+
+  if (!evbase) {
+    return -EINVAL;
+  }
+  // Keep the same reserve the hard limit check uses (see S3MemoryProfile).
+  const size_t max_threshold =
+      g_option_instance->get_libevent_pool_max_threshold();
+  const size_t reserve = std::max(
+      (size_t)g_option_instance->get_libevent_pool_reserve_size(),
+      (size_t)(g_option_instance->get_libevent_pool_reserve_percent() / 100.0 *
+               max_threshold));
+  const size_t budget = max_threshold > reserve ? max_threshold - reserve : 0;
+
+  gs_admission_controller = std::make_shared<S3AdmissionController>(
+      std::make_shared<EventWrapper>(), evbase, budget, reserve,
+      g_option_instance->get_admission_queue_max_length(),
+      g_option_instance->get_admission_queue_max_wait_ms(),
+      libevent_mempool_free_space);
+  if (!gs_admission_controller) {
+    return -ENOMEM;
+  }
+  tv.tv_sec = 0;
+  tv.tv_usec = S3_ADMISSION_TICK_INTERVAL_MSEC * 1000;
+  int rc = gs_admission_controller->add_evtimer(tv);
+  if (rc != 0) {
+    return rc;
+  }
+
+  call_fini.cancel();
+
+  return 0;
+}
+
+void s3_admission_fini() {
+  if (!gs_admission_controller) {
+    return;
+  }
+  s3_log(S3_LOG_INFO, "", "%s Entry", __func__);
+  gs_admission_controller->del_evtimer();
+  gs_admission_controller.reset();
+}
+
+std::shared_ptr<S3AdmissionController> s3_admission_controller() {
+  return gs_admission_controller;
+}
@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+#pragma once
+
+#ifndef __S3_SERVER_S3_ADMISSION_CONTROLLER_H__
+#define __S3_SERVER_S3_ADMISSION_CONTROLLER_H__
+
+#include <gtest/gtest_prod.h>
+
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "event_utils.h"
+
+// Memory pressure admission control for S3 API requests.
+//
+// Every request is charged with its expected libevent mempool footprint
+// (buffers for request/response plus the read-ahead window of object data
+// transfer). A request is admitted while the sum of footprints of in-flight
+// requests stays within the budget and the mempool has more than the reserve
+// free. Otherwise it waits (paused) in a bounded queue. Queue is served in
+// priority order, metadata operations first, then small and then large data
+// transfers. Requests waiting longer than the deadline are shed with
+// ServiceUnavailable and Retry-After. Waiter whose client has disconnected
+// is cancelled and leaves the queue.
+
+enum class S3AdmissionPriority {
+  metadata = 0,
+  small,
+  large,
+  count
+};
+
+enum class S3AdmissionResult {
+  admitted,  // on_admit was already called
+  queued,    // on_admit or on_shed will be called later from event loop
+  rejected   // queue is full, caller must fail the request
+};
+
+class S3AdmissionController;
+
+// Footprint charged to an admitted request, returned to the controller when
+// the ticket is destroyed. Holder of the ticket is the request object.
+class S3AdmissionTicket {
+  std::weak_ptr<S3AdmissionController> controller;
+  size_t footprint;
+
+ public:
+  S3AdmissionTicket(std::weak_ptr<S3AdmissionController> ctrl, size_t bytes)
+      : controller(std::move(ctrl)), footprint(bytes) {}
+  ~S3AdmissionTicket();
+  size_t get_footprint() const { return footprint; }
+};
+
+class S3AdmissionController
+    : public RecurringEventBase,
+      public std::enable_shared_from_this<S3AdmissionController> {
+ public:
+  typedef std::function<void(std::unique_ptr<S3AdmissionTicket>)>
+      AdmitCallback;
+  typedef std::function<void()> ShedCallback;
+  // Returns free space in the mempool
+  typedef std::function<size_t()> FreeSpaceCallback;
+
+ private:
+  struct Waiter {
+    uint64_t id;
+    size_t footprint;
+    std::chrono::steady_clock::time_point enqueue_time;
+    AdmitCallback on_admit;
+    ShedCallback on_shed;
+  };
+
+  std::shared_ptr<EventInterface> event_obj;
+  evbase_t* evbase;
+  // One shot event used to admit waiters after release, outside of the
+  // call stack of the request being destroyed.
+  struct event* drain_event = nullptr;
+  bool drain_scheduled = false;
+
+  size_t budget;
+  size_t reserve;
+  size_t max_queue_length;
+  std::chrono::milliseconds max_wait;
+  FreeSpaceCallback get_free_space;
+
+  size_t inflight_footprint = 0;
+  size_t inflight_requests = 0;
+  size_t queue_length = 0;
+  uint64_t next_waiter_id = 1;
+  std::deque<Waiter> queues[(int)S3AdmissionPriority::count];
+  // Waiters removed by cancel(). Their callbacks own the request object, so
+  // they are destroyed from the event loop, not from the call stack of the
+  // request which cancels itself.
+  std::vector<Waiter> cancelled;
+
+  bool fits(size_t footprint);
+  void admit(Waiter& waiter);
+  void shed(Waiter& waiter);
+  void schedule_drain();
+  void free_cancelled();
+  static void drain_event_cb(evutil_socket_t fd, short event, void* arg);
+  void publish_gauges();
+
+ public:
+  S3AdmissionController(std::shared_ptr<EventInterface> event_obj_ptr,
+                        evbase_t* evbase_, size_t budget_bytes,
+                        size_t reserve_bytes, size_t max_queue_len,
+                        unsigned max_wait_ms, FreeSpaceCallback free_space_cb);
+  virtual ~S3AdmissionController();
+
+  // Admits the request right away or queues it. Id of queued waiter is
+  // returned in 'waiter_id', for cancel().
+  S3AdmissionResult submit(size_t footprint, S3AdmissionPriority priority,
+                           AdmitCallback on_admit, ShedCallback on_shed,
+                           uint64_t* waiter_id = nullptr);
+  // Removes the waiter from the queue, neither of its callbacks is called.
+  // Returns false if it is not queued anymore.
+  bool cancel(uint64_t waiter_id);
+  // Returns footprint of finished request.
+  void release(size_t footprint);
+  // Admits queued requests while they fit.
+  void drain();
+  // Sheds queued requests which waited longer than the deadline.
+  void shed_expired(std::chrono::steady_clock::time_point now =
+                        std::chrono::steady_clock::now());
+
+  virtual void action_callback(void) noexcept;
+
+  size_t get_inflight_footprint() const { return inflight_footprint; }
+  size_t get_inflight_requests() const { return inflight_requests; }
+  size_t get_queue_length() const { return queue_length; }
+
+  FRIEND_TEST(S3AdmissionControllerTest, QueueFullEvictsLowerPriority);
+  FRIEND_TEST(S3AdmissionControllerTest, CancelRemovesWaiter);
+};
+
+// Priority class of a request, 'data_footprint' is the part of footprint
+// charged for object data transfer (0 for metadata operations).
+S3AdmissionPriority s3_admission_priority(size_t data_footprint,
+                                          size_t small_request_size);
+
+int s3_admission_init(evbase_t* evbase);
+void s3_admission_fini();
+// Returns nullptr when admission control is disabled.
+std::shared_ptr<S3AdmissionController> s3_admission_controller();
+
+#endif
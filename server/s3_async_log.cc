@@ -0,0 +1,610 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <glog/logging.h>
+
+#include "s3_async_log.h"
+
+// Ring buffer space is allocated in units of this size, so the end of the
+// buffer always has room for a record header.
+#define S3_LOG_RECORD_ALIGN 32
+// How often the flusher thread looks for new messages.
+#define S3_LOG_FLUSH_INTERVAL_MSEC 10
+
+enum S3LogRecordKind : uint8_t {
+  S3_LOG_RECORD_PADDING = 0,
+  S3_LOG_RECORD_MESSAGE = 1
+};
+
+struct S3LogRecord {
+  uint32_t size;  // including this header, multiple of S3_LOG_RECORD_ALIGN
+  uint8_t level;
+  uint8_t kind;
+  uint16_t unused;
+  int32_t line;
+  uint32_t args_size;
+  const char* file;
+  const char* fmt;
+};
+static_assert(sizeof(S3LogRecord) <= S3_LOG_RECORD_ALIGN,
+              "Log record header must fit into alignment unit");
+
+// Follows header of a message record, before its arguments.
+struct S3LogStamp {
+  int64_t sec;
+  int32_t nsec;
+  int32_t tid;
+};
+
+// Single producer (owning thread), single consumer (flusher) ring buffer.
+struct S3LogRing {
+  std::unique_ptr<char[]> buffer;
+  size_t capacity;
+  std::atomic<uint64_t> head{0};  // written by producer
+  std::atomic<uint64_t> tail{0};  // written by consumer
+  unsigned sample_counter = 0;    // used by producer only
+
+  explicit S3LogRing(size_t capacity_)
+      : buffer(new char[capacity_]), capacity(capacity_) {}
+};
+
+namespace {
+
+struct S3AsyncLogState {
+  std::mutex rings_lock;
+  std::vector<std::shared_ptr<S3LogRing>> rings;
+  // Incremented on every start, threads register their rings again.
+  std::atomic<uint64_t> generation{0};
+
+  // Serializes consumers: flusher thread, flush() and stop().
+  std::mutex drain_lock;
+  S3AsyncLog::Sink sink;
+
+  std::mutex flusher_lock;
+  std::condition_variable flusher_cond;
+  std::thread flusher;
+  bool stopping = false;
+  std::atomic<bool> flush_requested{false};
+
+  size_t ring_size = 0;
+  unsigned sample_rate = 1;
+
+  std::atomic<uint64_t> dropped{0};
+  std::atomic<uint64_t> sampled_out{0};
+  uint64_t reported_dropped = 0;
+  uint64_t reported_sampled_out = 0;
+};
+
+struct S3LogThreadRing {
+  std::shared_ptr<S3LogRing> ring;
+  uint64_t generation = 0;
+  pid_t tid = 0;
+};
+
+thread_local S3LogThreadRing tl_ring;
+
+// Never freed, logging may happen during static destruction.
+S3AsyncLogState* gs_state = new S3AsyncLogState();
+
+// Writes the message as glog would have written it when it was logged:
+// the line prefix has time and thread of the caller, not of the flusher.
+void glog_sink(int level, const S3AsyncLog::Origin& origin,
+               const std::string& msg) {
+  // Same severity mapping as s3_log_msg().
+  google::LogSeverity severity = google::GLOG_INFO;
+  if (level >= 3) {
+    severity = google::GLOG_ERROR;
+  } else if (level == 2) {
+    severity = google::GLOG_WARNING;
+  }
+  struct tm tm_time = {};
+  localtime_r(&origin.time.tv_sec, &tm_time);
+  const char* base_name = strrchr(origin.file, '/');
+  base_name = base_name ? base_name + 1 : origin.file;
+  char prefix[256];
+  snprintf(prefix, sizeof(prefix),
+           "%c%02d%02d %02d:%02d:%02d.%06ld %5d %s:%d] ",
+           google::GetLogSeverityName(severity)[0], tm_time.tm_mon + 1,
+           tm_time.tm_mday, tm_time.tm_hour, tm_time.tm_min, tm_time.tm_sec,
+           origin.time.tv_nsec / 1000, (int)origin.tid, base_name,
+           origin.line);
+  std::string line = prefix + msg;
+  if (line.back() != '\n') {
+    line += '\n';
+  }
+  if (FLAGS_logtostderr || FLAGS_alsologtostderr ||
+      severity >= FLAGS_stderrthreshold) {
+    fwrite(line.data(), 1, line.size(), stderr);
+  }
+  if (FLAGS_logtostderr) {
+    return;
+  }
+  // Like glog, a message goes to log files of its severity and lower ones.
+  for (int s = severity; s >= google::GLOG_INFO; --s) {
+    google::base::GetLogger(s)->Write(severity > FLAGS_logbuflevel,
+                                      origin.time.tv_sec, line.data(),
+                                      line.size());
+  }
+}
+
+size_t align_record(size_t size) {
+  return (size + S3_LOG_RECORD_ALIGN - 1) & ~(size_t)(S3_LOG_RECORD_ALIGN - 1);
+}
+
+S3LogRing* get_thread_ring() {
+  uint64_t generation = gs_state->generation.load(std::memory_order_acquire);
+  if (!tl_ring.ring || tl_ring.generation != generation) {
+    tl_ring.ring = std::make_shared<S3LogRing>(gs_state->ring_size);
+    tl_ring.generation = generation;
+    tl_ring.tid = syscall(SYS_gettid);
+    std::lock_guard<std::mutex> guard(gs_state->rings_lock);
+    gs_state->rings.push_back(tl_ring.ring);
+  }
+  return tl_ring.ring.get();
+}
+
+// Writes out all complete records of 'ring', needs drain_lock.
+void drain_ring(S3LogRing* ring) {
+  uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+  uint64_t head = ring->head.load(std::memory_order_acquire);
+  while (tail != head) {
+    const char* data = ring->buffer.get() + tail % ring->capacity;
+    S3LogRecord record;
+    memcpy(&record, data, sizeof(record));
+    if (record.kind == S3_LOG_RECORD_MESSAGE) {
+      S3LogStamp stamp;
+      memcpy(&stamp, data + sizeof(record), sizeof(stamp));
+      S3AsyncLog::Origin origin;
+      origin.file = record.file;
+      origin.line = record.line;
+      origin.time.tv_sec = stamp.sec;
+      origin.time.tv_nsec = stamp.nsec;
+      origin.tid = stamp.tid;
+      const char* args = data + sizeof(record) + sizeof(stamp);
+      gs_state->sink(record.level, origin,
+                     S3AsyncLog::format(record.fmt, args,
+                                        args + record.args_size));
+    }
+    tail += record.size;
+    ring->tail.store(tail, std::memory_order_release);
+  }
+}
+
+// Needs drain_lock.
+void drain_all() {
+  std::vector<std::shared_ptr<S3LogRing>> rings;
+  {
+    std::lock_guard<std::mutex> guard(gs_state->rings_lock);
+    rings = gs_state->rings;
+  }
+  for (auto& ring : rings) {
+    drain_ring(ring.get());
+  }
+  {
+    // Rings of exited threads are not referenced by anyone else.
+    std::lock_guard<std::mutex> guard(gs_state->rings_lock);
+    auto& all = gs_state->rings;
+    for (auto it = all.begin(); it != all.end();) {
+      if (it->use_count() == 1 &&
+          (*it)->tail.load() == (*it)->head.load(std::memory_order_acquire)) {
+        it = all.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  uint64_t dropped = gs_state->dropped.load(std::memory_order_relaxed);
+  uint64_t sampled_out = gs_state->sampled_out.load(std::memory_order_relaxed);
+  if (dropped != gs_state->reported_dropped ||
+      sampled_out != gs_state->reported_sampled_out) {
+    char msg[128];
+    snprintf(msg, sizeof(msg),
+             "[%s] Log overload: %" PRIu64 " messages dropped, %" PRIu64
+             " sampled out\n",
+             __func__, dropped - gs_state->reported_dropped,
+             sampled_out - gs_state->reported_sampled_out);
+    S3AsyncLog::Origin origin = {__FILE__, __LINE__, {0, 0},
+                                 (pid_t)syscall(SYS_gettid)};
+    clock_gettime(CLOCK_REALTIME, &origin.time);
+    gs_state->sink(2, origin, msg);
+    gs_state->reported_dropped = dropped;
+    gs_state->reported_sampled_out = sampled_out;
+  }
+}
+
+void flusher_main() {
+  std::unique_lock<std::mutex> lock(gs_state->flusher_lock);
+  while (!gs_state->stopping) {
+    lock.unlock();
+    gs_state->flush_requested.store(false, std::memory_order_relaxed);
+    {
+      std::lock_guard<std::mutex> guard(gs_state->drain_lock);
+      drain_all();
+    }
+    lock.lock();
+    if (!gs_state->stopping) {
+      gs_state->flusher_cond.wait_for(
+          lock, std::chrono::milliseconds(S3_LOG_FLUSH_INTERVAL_MSEC));
+    }
+  }
+}
+
+// Appends 'spec' (e.g. "%-5ld") with the next argument to 'out'.
+// Length modifiers are honored by converting the argument to the type
+// printf() would have read.
+bool format_spec(std::string& out, std::string spec, char conversion,
+                 const std::string& length, S3LogArgs::Tag tag,
+                 const char* value) {
+  char buf[512];
+  int64_t i = 0;
+  uint64_t u = 0;
+  double d = 0;
+  const void* p = nullptr;
+  if (tag == S3LogArgs::INT) {
+    memcpy(&i, value, sizeof(i));
+    u = (uint64_t)i;
+    d = (double)i;
+  } else if (tag == S3LogArgs::UINT) {
+    memcpy(&u, value, sizeof(u));
+    i = (int64_t)u;
+    d = (double)u;
+  } else if (tag == S3LogArgs::DOUBLE) {
+    memcpy(&d, value, sizeof(d));
+  } else if (tag == S3LogArgs::POINTER) {
+    memcpy(&p, value, sizeof(p));
+    u = (uintptr_t)p;
+  }
+
+  int rc = -1;
+  switch (conversion) {
+    case 'd':
+    case 'i':
+      if (tag == S3LogArgs::STRING || tag == S3LogArgs::DOUBLE) {
+        return false;
+      }
+      if (length == "hh") {
+        i = (signed char)i;
+      } else if (length == "h") {
+        i = (short)i;
+      } else if (length.empty()) {
+        i = (int)i;
+      } else if (length == "l") {
+        i = (long)i;
+      }
+      spec += "jd";
+      rc = snprintf(buf, sizeof(buf), spec.c_str(), (intmax_t)i);
+      break;
+    case 'u':
+    case 'o':
+    case 'x':
+    case 'X':
+      if (tag == S3LogArgs::STRING || tag == S3LogArgs::DOUBLE) {
+        return false;
+      }
+      if (length == "hh") {
+        u = (unsigned char)u;
+      } else if (length == "h") {
+        u = (unsigned short)u;
+      } else if (length.empty()) {
+        u = (unsigned)u;
+      } else if (length == "l") {
+        u = (unsigned long)u;
+      }
+      spec += 'j';
+      spec += conversion;
+      rc = snprintf(buf, sizeof(buf), spec.c_str(), (uintmax_t)u);
+      break;
+    case 'c':
+      if (tag != S3LogArgs::INT && tag != S3LogArgs::UINT) {
+        return false;
+      }
+      spec += 'c';
+      rc = snprintf(buf, sizeof(buf), spec.c_str(), (int)i);
+      break;
+    case 'e':
+    case 'E':
+    case 'f':
+    case 'F':
+    case 'g':
+    case 'G':
+    case 'a':
+    case 'A':
+      if (tag == S3LogArgs::STRING || tag == S3LogArgs::POINTER) {
+        return false;
+      }
+      spec += conversion;
+      rc = snprintf(buf, sizeof(buf), spec.c_str(), d);
+      break;
+    case 'p':
+      if (tag != S3LogArgs::POINTER && tag != S3LogArgs::UINT &&
+          tag != S3LogArgs::INT) {
+        return false;
+      }
+      spec += 'p';
+      rc = snprintf(buf, sizeof(buf), spec.c_str(), (void*)(uintptr_t)u);
+      break;
+    case 's': {
+      if (tag != S3LogArgs::STRING) {
+        return false;
+      }
+      uint32_t len;
+      memcpy(&len, value, sizeof(len));
+      std::string str(value + sizeof(len), len);
+      if (spec == "%") {
+        // Common case, no width or precision.
+        out += str;
+        return true;
+      }
+      spec += 's';
+      std::vector<char> wide(len + spec.size() + 512);
+      rc = snprintf(wide.data(), wide.size(), spec.c_str(), str.c_str());
+      if (rc < 0) {
+        return false;
+      }
+      out.append(wide.data(), std::min((size_t)rc, wide.size() - 1));
+      return true;
+    }
+    default:
+      return false;
+  }
+  if (rc < 0) {
+    return false;
+  }
+  out.append(buf, std::min((size_t)rc, sizeof(buf) - 1));
+  return true;
+}
+
+// Reads next packed argument, returns its value or nullptr.
+const char* next_arg(const char*& args, const char* args_end,
+                     S3LogArgs::Tag* tag) {
+  if (args >= args_end) {
+    return nullptr;
+  }
+  *tag = (S3LogArgs::Tag)*args;
+  const char* value = args + 1;
+  size_t size = 8;
+  if (*tag == S3LogArgs::STRING) {
+    uint32_t len;
+    memcpy(&len, value, sizeof(len));
+    size = sizeof(len) + len;
+  } else if (*tag == S3LogArgs::POINTER) {
+    size = sizeof(void*);
+  }
+  args = value + size;
+  return value;
+}
+
+}  // namespace
+
+std::atomic<bool> S3AsyncLog::running{false};
+
+std::string S3AsyncLog::format(const char* fmt, const char* args,
+                               const char* args_end) {
+  std::string out;
+  const char* p = fmt;
+  while (*p) {
+    const char* percent = strchr(p, '%');
+    if (!percent) {
+      out += p;
+      break;
+    }
+    out.append(p, percent - p);
+    p = percent + 1;
+    if (*p == '%') {
+      out += '%';
+      ++p;
+      continue;
+    }
+    // %[flags][width][.precision][length]conversion
+    std::string spec = "%";
+    bool ok = true;
+    while (*p && strchr("-+ #0'", *p)) {
+      spec += *p++;
+    }
+    for (int part = 0; part < 2 && ok; ++part) {
+      if (part == 1) {
+        if (*p != '.') {
+          break;
+        }
+        spec += *p++;
+      }
+      if (*p == '*') {
+        S3LogArgs::Tag tag;
+        const char* value = next_arg(args, args_end, &tag);
+        if (!value || (tag != S3LogArgs::INT && tag != S3LogArgs::UINT)) {
+          ok = false;
+          break;
+        }
+        int64_t n;
+        memcpy(&n, value, sizeof(n));
+        spec += std::to_string((int)n);
+        ++p;
+      } else {
+        while (*p >= '0' && *p <= '9') {
+          spec += *p++;
+        }
+      }
+    }
+    std::string length;
+    while (*p && strchr("hlLqjzt", *p)) {
+      length += *p++;
+    }
+    char conversion = *p;
+    if (conversion) {
+      ++p;
+    }
+    if (ok) {
+      S3LogArgs::Tag tag;
+      const char* value = next_arg(args, args_end, &tag);
+      ok = value &&
+           format_spec(out, spec, conversion, length, tag, value);
+    }
+    if (!ok) {
+      // Mismatch of format and arguments, keep the specification.
+      out += "%?";
+    }
+  }
+  return out;
+}
+
+int S3AsyncLog::start(size_t ring_size, unsigned sample_rate) {
+  if (is_running()) {
+    return -EEXIST;
+  }
+  ring_size = align_record(ring_size);
+  if (ring_size < 4 * S3_LOG_RECORD_ALIGN) {
+    return -EINVAL;
+  }
+  gs_state->ring_size = ring_size;
+  gs_state->sample_rate = sample_rate ? sample_rate : 1;
+  if (!gs_state->sink) {
+    gs_state->sink = glog_sink;
+  }
+  {
+    std::lock_guard<std::mutex> guard(gs_state->rings_lock);
+    gs_state->rings.clear();
+  }
+  gs_state->generation++;
+  gs_state->stopping = false;
+  gs_state->flusher = std::thread(flusher_main);
+  running.store(true, std::memory_order_release);
+  return 0;
+}
+
+void S3AsyncLog::stop() {
+  if (!is_running()) {
+    return;
+  }
+  running.store(false, std::memory_order_release);
+  {
+    std::lock_guard<std::mutex> guard(gs_state->flusher_lock);
+    gs_state->stopping = true;
+  }
+  gs_state->flusher_cond.notify_one();
+  gs_state->flusher.join();
+  std::lock_guard<std::mutex> guard(gs_state->drain_lock);
+  drain_all();
+}
+
+void S3AsyncLog::flush() {
+  if (!is_running()) {
+    return;
+  }
+  std::lock_guard<std::mutex> guard(gs_state->drain_lock);
+  drain_all();
+}
+
+void S3AsyncLog::set_sink(Sink sink) {
+  std::lock_guard<std::mutex> guard(gs_state->drain_lock);
+  gs_state->sink = sink ? sink : glog_sink;
+}
+
+uint64_t S3AsyncLog::get_dropped_count() { return gs_state->dropped; }
+
+uint64_t S3AsyncLog::get_sampled_out_count() { return gs_state->sampled_out; }
+
+int S3AsyncLog::reserve(int level, const char* file, int line,
+                        const char* fmt, size_t args_size, Slot* slot) {
+  S3LogRing* ring = get_thread_ring();
+  size_t record_size =
+      align_record(sizeof(S3LogRecord) + sizeof(S3LogStamp) + args_size);
+  if (record_size > ring->capacity / 4) {
+    return -1;
+  }
+
+  uint64_t head = ring->head.load(std::memory_order_relaxed);
+  uint64_t used = head - ring->tail.load(std::memory_order_acquire);
+  // WARN and more severe messages are never dropped.
+  bool droppable = level < 2;
+  if (droppable && used > ring->capacity / 4 * 3 &&
+      ++ring->sample_counter % gs_state->sample_rate != 0) {
+    gs_state->sampled_out.fetch_add(1, std::memory_order_relaxed);
+    return 0;
+  }
+
+  size_t offset = head % ring->capacity;
+  size_t to_end = ring->capacity - offset;
+  size_t needed = record_size <= to_end ? record_size : to_end + record_size;
+  if (needed > ring->capacity - used) {
+    if (!gs_state->flush_requested.exchange(true)) {
+      gs_state->flusher_cond.notify_one();
+    }
+    if (droppable) {
+      gs_state->dropped.fetch_add(1, std::memory_order_relaxed);
+      return 0;
+    }
+    return -1;
+  }
+
+  char* data = ring->buffer.get() + offset;
+  if (needed != record_size) {
+    S3LogRecord padding = {};
+    padding.size = to_end;
+    padding.kind = S3_LOG_RECORD_PADDING;
+    memcpy(data, &padding, sizeof(padding));
+    data = ring->buffer.get();
+  }
+  S3LogRecord record = {};
+  record.size = record_size;
+  record.level = level;
+  record.kind = S3_LOG_RECORD_MESSAGE;
+  record.line = line;
+  record.args_size = args_size;
+  record.file = file;
+  record.fmt = fmt;
+  memcpy(data, &record, sizeof(record));
+  struct timespec now;
+  clock_gettime(CLOCK_REALTIME, &now);
+  S3LogStamp stamp;
+  stamp.sec = now.tv_sec;
+  stamp.nsec = now.tv_nsec;
+  stamp.tid = tl_ring.tid;
+  memcpy(data + sizeof(record), &stamp, sizeof(stamp));
+
+  slot->ring = ring;
+  slot->args = data + sizeof(record) + sizeof(stamp);
+  slot->size = needed;
+  return 1;
+}
+
+void S3AsyncLog::commit(const Slot& slot) {
+  S3LogRing* ring = slot.ring;
+  uint64_t head = ring->head.load(std::memory_order_relaxed) + slot.size;
+  ring->head.store(head, std::memory_order_release);
+  if (head - ring->tail.load(std::memory_order_relaxed) > ring->capacity / 2 &&
+      !gs_state->flush_requested.exchange(true)) {
+    gs_state->flusher_cond.notify_one();
+  }
+}
@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+#pragma once
+
+#ifndef __S3_SERVER_S3_ASYNC_LOG_H__
+#define __S3_SERVER_S3_ASYNC_LOG_H__
+
+#include <stdint.h>
+#include <string.h>
+#include <sys/types.h>
+#include <time.h>
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <type_traits>
+
+// Arguments of a log message, stored in binary form so that formatting can be
+// deferred to the flusher thread. Strings are copied, so arguments may be
+// temporaries (e.g. std::string::c_str()).
+class S3LogArgs {
+ public:
+  enum Tag : char {
+    INT = 'i',
+    UINT = 'u',
+    DOUBLE = 'f',
+    STRING = 's',
+    POINTER = 'p'
+  };
+
+  static size_t size() { return 0; }
+  template <typename T, typename... Rest>
+  static size_t size(T arg, Rest... rest) {
+    return arg_size(arg) + size(rest...);
+  }
+
+  static char* pack(char* out) { return out; }
+  template <typename T, typename... Rest>
+  static char* pack(char* out, T arg, Rest... rest) {
+    return pack(pack_arg(out, arg), rest...);
+  }
+
+ private:
+  template <typename T>
+  static char* put(char* out, Tag tag, T value) {
+    *out++ = tag;
+    memcpy(out, &value, sizeof(value));
+    return out + sizeof(value);
+  }
+
+  static const char* str_or_null(const char* s) { return s ? s : "(null)"; }
+
+  static size_t arg_size(const char* s) {
+    return 1 + sizeof(uint32_t) + strlen(str_or_null(s));
+  }
+  static size_t arg_size(char* s) { return arg_size((const char*)s); }
+  template <typename T>
+  static size_t arg_size(T*) {
+    return 1 + sizeof(void*);
+  }
+  template <typename T>
+  static typename std::enable_if<std::is_arithmetic<T>::value ||
+                                     std::is_enum<T>::value,
+                                 size_t>::type
+  arg_size(T) {
+    return 1 + 8;
+  }
+
+  static char* pack_arg(char* out, const char* s) {
+    s = str_or_null(s);
+    uint32_t len = strlen(s);
+    *out++ = STRING;
+    memcpy(out, &len, sizeof(len));
+    memcpy(out + sizeof(len), s, len);
+    return out + sizeof(len) + len;
+  }
+  static char* pack_arg(char* out, char* s) {
+    return pack_arg(out, (const char*)s);
+  }
+  template <typename T>
+  static char* pack_arg(char* out, T* p) {
+    return put(out, POINTER, (const void*)p);
+  }
+  template <typename T>
+  static typename std::enable_if<std::is_floating_point<T>::value, char*>::type
+  pack_arg(char* out, T value) {
+    return put(out, DOUBLE, (double)value);
+  }
+  template <typename T>
+  static typename std::enable_if<
+      (std::is_integral<T>::value && std::is_signed<T>::value) ||
+          std::is_enum<T>::value,
+      char*>::type
+  pack_arg(char* out, T value) {
+    return put(out, INT, (int64_t)value);
+  }
+  template <typename T>
+  static typename std::enable_if<
+      std::is_integral<T>::value && !std::is_signed<T>::value, char*>::type
+  pack_arg(char* out, T value) {
+    return put(out, UINT, (uint64_t)value);
+  }
+};
+
+struct S3LogRing;
+
+// Asynchronous backend of s3_log.
+//
+// Each logging thread appends messages (printf format and packed arguments)
+// to its own lock-free ring buffer. A background thread formats them and
+// writes them to glog, so log files and their rotation stay as they are.
+// Under overload DEBUG/INFO messages are sampled and then dropped, WARN and
+// more severe messages are written synchronously instead of being dropped.
+// Time and thread of a message are taken when it is queued.
+class S3AsyncLog {
+ public:
+  // Where, when and by which thread a message was logged.
+  struct Origin {
+    const char* file;
+    int line;
+    struct timespec time;
+    pid_t tid;
+  };
+
+  // Receives formatted messages, glog by default.
+  typedef std::function<void(int level, const Origin& origin,
+                             const std::string& msg)> Sink;
+
+  struct Slot {
+    S3LogRing* ring;
+    char* args;
+    size_t size;
+  };
+
+  // 'ring_size' is the size of ring buffer of each thread, 1 of
+  // 'sample_rate' DEBUG/INFO messages is kept while it is 3/4 full.
+  static int start(size_t ring_size, unsigned sample_rate);
+  static void stop();
+  static bool is_running() { return running.load(std::memory_order_acquire); }
+  // Writes out all messages logged so far.
+  static void flush();
+  static void set_sink(Sink sink);
+
+  static uint64_t get_dropped_count();
+  static uint64_t get_sampled_out_count();
+
+  // Returns false when the message has to be logged synchronously by the
+  // caller, true when it was queued or dropped.
+  template <typename... Args>
+  static bool write(int level, const char* file, int line, const char* fmt,
+                    Args... args) {
+    if (!is_running()) {
+      return false;
+    }
+    if (level >= S3_ASYNC_LOG_SYNC_LEVEL) {
+      // Keep order of messages before the program terminates.
+      flush();
+      return false;
+    }
+    Slot slot;
+    int rc = reserve(level, file, line, fmt, S3LogArgs::size(args...), &slot);
+    if (rc <= 0) {
+      return rc == 0;
+    }
+    S3LogArgs::pack(slot.args, args...);
+    commit(slot);
+    return true;
+  }
+
+  // printf() 'fmt' with arguments packed by S3LogArgs.
+  static std::string format(const char* fmt, const char* args,
+                            const char* args_end);
+
+ private:
+  // Same as S3_LOG_FATAL.
+  static const int S3_ASYNC_LOG_SYNC_LEVEL = 4;
+
+  static std::atomic<bool> running;
+
+  // Returns 1 when space for 'args_size' bytes of arguments was reserved,
+  // 0 when the message is dropped and -1 when it has to be written
+  // synchronously.
+  static int reserve(int level, const char* file, int line, const char* fmt,
+                     size_t args_size, Slot* slot);
+  static void commit(const Slot& slot);
+};
+
+#endif
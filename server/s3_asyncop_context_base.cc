@@ -23,6 +23,7 @@
 #include "s3_perf_logger.h"
 #include "s3_stats.h"
 #include "s3_log.h"
+#include "s3_metrics.h"
 
 S3AsyncOpContextBase::S3AsyncOpContextBase(std::shared_ptr<RequestObject> req,
                                            std::function<void(void)> success,
@@ -42,6 +43,15 @@ S3AsyncOpContextBase::S3AsyncOpContextBase(std::shared_ptr<RequestObject> req,
   ops_response.resize(ops_count);
 }
 
+S3AsyncOpContextBase::~S3AsyncOpContextBase() {
+  request->get_trace().end(trace_span);
+  if (metrics_op_in_flight) {
+    // Operation was never completed.
+    s3_metrics_motr_op_finished(metrics_op_key, false, -1);
+    request->async_op_finished();
+  }
+}
+
 void S3AsyncOpContextBase::reset_callbacks(std::function<void(void)> success,
                                            std::function<void(void)> failed) {
   on_success = success;
@@ -95,13 +105,24 @@ void S3AsyncOpContextBase::set_op_errno_for(int op_idx, int err) {
   }
 }
 
-void S3AsyncOpContextBase::start_timer_for(std::string op_key) {
+void S3AsyncOpContextBase::start_timer_for(const char* op_key,
+                                           S3TraceCategory category) {
   operation_key = op_key;
+  metrics_op_key = op_key;
+  if (!metrics_op_in_flight) {
+    metrics_op_in_flight = true;
+    s3_metrics_motr_op_started();
+    request->async_op_started(op_key);
+  }
+  S3RequestTrace& trace = request->get_trace();
+  trace.end(trace_span);
+  trace_span = trace.begin(op_key, category);
   timer.start();
 }
 
 void S3AsyncOpContextBase::stop_timer(bool success) {
   timer.stop();
+  metrics_op_success = success;
   if (operation_key.empty()) {
     return;
   }
@@ -113,6 +134,15 @@ void S3AsyncOpContextBase::stop_timer(bool success) {
 }
 
 void S3AsyncOpContextBase::log_timer() {
+  request->get_trace().end(trace_span);
+  trace_span = -1;
+  if (metrics_op_in_flight) {
+    metrics_op_in_flight = false;
+    request->async_op_finished();
+    int64_t elapsed_nsec = timer.elapsed_time_in_nanosec();
+    s3_metrics_motr_op_finished(metrics_op_key, metrics_op_success,
+                                elapsed_nsec < 0 ? -1 : elapsed_nsec / 1000);
+  }
   if (operation_key.empty()) {
     return;
   }
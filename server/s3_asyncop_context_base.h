@@ -65,6 +65,12 @@ class S3AsyncOpContextBase {
   // To measure performance
   S3Timer timer;
   std::string operation_key;  // used to identify operation(metric) name
+  // Operation reported to S3Metrics, operation_key is suffixed by outcome.
+  std::string metrics_op_key;
+  bool metrics_op_success = false;
+  bool metrics_op_in_flight = false;
+  // Request trace span of the operation
+  int trace_span = -1;
   // Used for mocking motr return calls.
   std::shared_ptr<MotrAPI> s3_motr_api;
 
@@ -76,7 +82,7 @@ class S3AsyncOpContextBase {
                        std::function<void(void)> success,
                        std::function<void(void)> failed, int ops_cnt = 1,
                        std::shared_ptr<MotrAPI> motr_api = nullptr);
-  virtual ~S3AsyncOpContextBase() {}
+  virtual ~S3AsyncOpContextBase();
 
   std::shared_ptr<RequestObject> get_request();
 
@@ -101,7 +107,9 @@ class S3AsyncOpContextBase {
   bool is_at_least_one_op_successful() { return at_least_one_success; }
   // virtual void consume(char* chars, size_t length) = 0;
 
-  void start_timer_for(std::string op_key);
+  // 'op_key' must be a string literal, it is used as request trace span name.
+  void start_timer_for(const char* op_key,
+                       S3TraceCategory category = S3TraceCategory::kvs);
   void stop_timer(bool success = true);  // arg indicates success/failed metric
   // Call the logging always on main thread, so we dont need synchronisation of
   // log file.
@@ -25,8 +25,10 @@
 
 #include <json/json.h>
 #include <time.h>
-#include <regex>
+#include <string.h>
+#include <mutex>
 #include <string>
+#include <unordered_set>
 #include <algorithm>
 #include <stdio.h>
 
@@ -41,19 +43,109 @@ std::string audit_format_type_to_string(enum AuditFormatType type) {
   }
 }
 
+namespace {
+
+// Strings which are copied into an encoded record, in this order.
+enum S3AuditRecordString {
+  AUDIT_BUCKET_OWNER,
+  AUDIT_BUCKET,
+  AUDIT_REMOTE_IP,
+  AUDIT_REQUESTER,
+  AUDIT_REQUEST_ID,
+  AUDIT_OBJECT_KEY,
+  AUDIT_REQUEST_URI,
+  AUDIT_REFERRER,
+  AUDIT_USER_AGENT,
+  AUDIT_VERSION_ID,
+  AUDIT_HOST_ID,
+  AUDIT_HOST_HEADER,
+  AUDIT_RECORD_STRINGS
+};
+
+// Fixed part of an encoded record, followed by the strings.
+struct S3AuditRecordHeader {
+  int64_t time_of_request_arrival;
+  UInt64 bytes_sent;
+  UInt64 object_size;
+  UInt64 bytes_received;
+  UInt64 total_time;
+  UInt64 turn_around_time;
+  const char* operation;
+  const char* error_code;
+  const char* signature_version;
+  const char* cipher_suite;
+  const char* authentication_type;
+  int32_t http_status;
+  uint32_t lengths[AUDIT_RECORD_STRINGS];
+};
+
+// Decoded record, strings point into the encoded one.
+struct S3AuditRecordView {
+  S3AuditRecordHeader header;
+  const char* strings[AUDIT_RECORD_STRINGS];
+
+  explicit S3AuditRecordView(const char* record) {
+    memcpy(&header, record, sizeof(header));
+    const char* str = record + sizeof(header);
+    for (int i = 0; i < AUDIT_RECORD_STRINGS; ++i) {
+      strings[i] = str;
+      str += header.lengths[i];
+    }
+  }
+
+  std::string get(S3AuditRecordString i) const {
+    return std::string(strings[i], header.lengths[i]);
+  }
+  void append(std::string& out, S3AuditRecordString i) const {
+    out.append(strings[i], header.lengths[i]);
+  }
+};
+
+std::string format_time(int64_t time_of_request_arrival) {
+  if (time_of_request_arrival < 0) {
+    return "-";
+  }
+  time_t request_time = (time_t)time_of_request_arrival;
+  struct tm request_time_struct;
+  char time_of_request[REQUEST_TIME_SIZE];
+  localtime_r(&request_time, &request_time_struct);
+
+  // Format specifiers required for strftime() as per
+  // https://docs.aws.amazon.com/AmazonS3/latest/dev/LogFormat.html :
+  //   %d = Day of the month (01-31)
+  //   %b = Abbreviated month name
+  //   %Y = The year as a decimal number including the century.
+  //   %H = Hour in 24h format (00-23)
+  //   %M = Minutes in decimal ranging from 00 to 59.
+  //   %S = The second as a decimal number (range 00 to 60).
+  //   %z = The +hhmm or -hhmm numeric timezone
+
+  strftime(time_of_request, sizeof(time_of_request), "[%d/%b/%Y:%H:%M:%S %z]",
+           &request_time_struct);
+  return time_of_request;
+}
+
+bool starts_with(const std::string& str, const char* prefix) {
+  return str.compare(0, strlen(prefix), prefix) == 0;
+}
+
+}  // namespace
+
 S3AuditInfo::S3AuditInfo()
     : bucket_owner_canonical_id("-"),
       bucket("-"),
-      time_of_request_arrival("-"),
+      time_of_request_arrival(-1),
       remote_ip("-"),
       requester("-"),
       request_id("-"),
       operation("-"),
       object_key("-"),
       request_uri("-"),
+      http_status(0),
       error_code("-"),
       bytes_sent(0),
       object_size(0),
+      bytes_received(0),
       total_time(0),
       turn_around_time(0),
       referrer("-"),
@@ -77,51 +169,142 @@ const std::string S3AuditInfo::to_string() {
   if (!S3AuditInfoLogger::is_enabled()) {
     return "";
   }
+  return to_string(S3Option::get_instance()->get_s3_audit_format_type());
+}
+
+std::string S3AuditInfo::to_string(AuditFormatType format_type) const {
+  std::string record(get_record_size(), '\0');
+  encode_record(&record[0]);
+  return format_record(record.data(), format_type);
+}
+
+size_t S3AuditInfo::get_record_size() const {
+  return sizeof(S3AuditRecordHeader) + bucket_owner_canonical_id.length() +
+         bucket.length() + remote_ip.length() + requester.length() +
+         request_id.length() + object_key.length() + request_uri.length() +
+         referrer.length() + user_agent.length() + version_id.length() +
+         host_id.length() + host_header.length();
+}
+
+void S3AuditInfo::encode_record(char* record) const {
+  const std::string* strings[AUDIT_RECORD_STRINGS] = {
+      &bucket_owner_canonical_id, &bucket,     &remote_ip,   &requester,
+      &request_id,                &object_key, &request_uri, &referrer,
+      &user_agent,                &version_id, &host_id,     &host_header};
+
+  S3AuditRecordHeader header;
+  header.time_of_request_arrival = time_of_request_arrival;
+  header.bytes_sent = convert_to_unsigned(bytes_sent);
+  header.object_size = convert_to_unsigned(object_size);
+  header.bytes_received = convert_to_unsigned(bytes_received);
+  header.total_time = convert_to_unsigned(total_time);
+  header.turn_around_time = convert_to_unsigned(turn_around_time);
+  header.operation = operation;
+  header.error_code = error_code;
+  header.signature_version = signature_version;
+  header.cipher_suite = cipher_suite;
+  header.authentication_type = authentication_type;
+  header.http_status = http_status;
+
+  char* str = record + sizeof(header);
+  for (int i = 0; i < AUDIT_RECORD_STRINGS; ++i) {
+    header.lengths[i] = strings[i]->length();
+    memcpy(str, strings[i]->data(), strings[i]->length());
+    str += strings[i]->length();
+  }
+  memcpy(record, &header, sizeof(header));
+}
 
-  AuditFormatType audit_format_type =
-      S3Option::get_instance()->get_s3_audit_format_type();
-  if (audit_format_type == AuditFormatType::S3_FORMAT) {
+std::string S3AuditInfo::get_record_request_id(const char* record) {
+  return S3AuditRecordView(record).get(AUDIT_REQUEST_ID);
+}
+
+std::string S3AuditInfo::format_record(const char* record,
+                                       AuditFormatType format_type) {
+  const S3AuditRecordView view(record);
+  const S3AuditRecordHeader& header = view.header;
+
+  if (format_type == AuditFormatType::S3_FORMAT) {
     // Logs audit information in S3 format.
-    const std::string formatted_log =
-        bucket_owner_canonical_id + " " + bucket + " " +
-        time_of_request_arrival + " " + remote_ip + " " + requester + " " +
-        request_id + " " + operation + " " + object_key + " \"" + request_uri +
-        "\" " + std::to_string(http_status) + " " + error_code + " " +
-        std::to_string(bytes_sent) + " " + std::to_string(object_size) + " " +
-        std::to_string(bytes_received) + " " + std::to_string(total_time) +
-        " " + std::to_string(turn_around_time) + " \"" + referrer + "\" \"" +
-        user_agent + "\" " + version_id + " " + host_id + " " +
-        signature_version + " " + cipher_suite + " " + authentication_type +
-        " " + host_header;
+    std::string formatted_log;
+    formatted_log.reserve(512);
+
+    view.append(formatted_log, AUDIT_BUCKET_OWNER);
+    formatted_log += ' ';
+    view.append(formatted_log, AUDIT_BUCKET);
+    formatted_log += ' ';
+    formatted_log += format_time(header.time_of_request_arrival);
+    formatted_log += ' ';
+    view.append(formatted_log, AUDIT_REMOTE_IP);
+    formatted_log += ' ';
+    view.append(formatted_log, AUDIT_REQUESTER);
+    formatted_log += ' ';
+    view.append(formatted_log, AUDIT_REQUEST_ID);
+    formatted_log += ' ';
+    formatted_log += header.operation;
+    formatted_log += ' ';
+    view.append(formatted_log, AUDIT_OBJECT_KEY);
+    formatted_log += " \"";
+    view.append(formatted_log, AUDIT_REQUEST_URI);
+    formatted_log += "\" ";
+    formatted_log += std::to_string(header.http_status);
+    formatted_log += ' ';
+    formatted_log += header.error_code;
+    formatted_log += ' ';
+    formatted_log += std::to_string(header.bytes_sent);
+    formatted_log += ' ';
+    formatted_log += std::to_string(header.object_size);
+    formatted_log += ' ';
+    formatted_log += std::to_string(header.bytes_received);
+    formatted_log += ' ';
+    formatted_log += std::to_string(header.total_time);
+    formatted_log += ' ';
+    formatted_log += std::to_string(header.turn_around_time);
+    formatted_log += " \"";
+    view.append(formatted_log, AUDIT_REFERRER);
+    formatted_log += "\" \"";
+    view.append(formatted_log, AUDIT_USER_AGENT);
+    formatted_log += "\" ";
+    view.append(formatted_log, AUDIT_VERSION_ID);
+    formatted_log += ' ';
+    view.append(formatted_log, AUDIT_HOST_ID);
+    formatted_log += ' ';
+    formatted_log += header.signature_version;
+    formatted_log += ' ';
+    formatted_log += header.cipher_suite;
+    formatted_log += ' ';
+    formatted_log += header.authentication_type;
+    formatted_log += ' ';
+    view.append(formatted_log, AUDIT_HOST_HEADER);
     return formatted_log;
-  } else if (audit_format_type == AuditFormatType::JSON) {
+  } else if (format_type == AuditFormatType::JSON) {
     // Logs audit information in Json format.
     Json::Value audit;
 
-    audit["bucket_owner"] = bucket_owner_canonical_id;
-    audit["bucket"] = bucket;
-    audit["time"] = time_of_request_arrival;
-    audit["remote_ip"] = remote_ip;
-    audit["requester"] = requester;
-    audit["request_id"] = request_id;
-    audit["operation"] = operation;
-    audit["key"] = object_key;
-    audit["request_uri"] = request_uri;
-    audit["http_status"] = http_status;
-    audit["error_code"] = error_code;
-    audit["bytes_sent"] = convert_to_unsigned(bytes_sent);
-    audit["object_size"] = convert_to_unsigned(object_size);
-    audit["bytes_received"] = convert_to_unsigned(bytes_received);
-    audit["total_time"] = convert_to_unsigned(total_time);
-    audit["turn_around_time"] = convert_to_unsigned(turn_around_time);
-    audit["referrer"] = referrer;
-    audit["user_agent"] = user_agent;
-    audit["version_id"] = version_id;
-    audit["host_id"] = host_id;
-    audit["signature_version"] = signature_version;
-    audit["cipher_suite"] = cipher_suite;
-    audit["authentication_type"] = authentication_type;
-    audit["host_header"] = host_header;
+    audit["bucket_owner"] = view.get(AUDIT_BUCKET_OWNER);
+    audit["bucket"] = view.get(AUDIT_BUCKET);
+    audit["time"] = format_time(header.time_of_request_arrival);
+    audit["remote_ip"] = view.get(AUDIT_REMOTE_IP);
+    audit["requester"] = view.get(AUDIT_REQUESTER);
+    audit["request_id"] = view.get(AUDIT_REQUEST_ID);
+    audit["operation"] = header.operation;
+    audit["key"] = view.get(AUDIT_OBJECT_KEY);
+    audit["request_uri"] = view.get(AUDIT_REQUEST_URI);
+    audit["http_status"] = header.http_status;
+    audit["error_code"] = header.error_code;
+    audit["bytes_sent"] = (Json::UInt64)header.bytes_sent;
+    audit["object_size"] = (Json::UInt64)header.object_size;
+    audit["bytes_received"] = (Json::UInt64)header.bytes_received;
+    audit["total_time"] = (Json::UInt64)header.total_time;
+    audit["turn_around_time"] = (Json::UInt64)header.turn_around_time;
+    audit["referrer"] = view.get(AUDIT_REFERRER);
+    audit["user_agent"] = view.get(AUDIT_USER_AGENT);
+    audit["version_id"] = view.get(AUDIT_VERSION_ID);
+    audit["host_id"] = view.get(AUDIT_HOST_ID);
+    audit["signature_version"] = header.signature_version;
+    audit["cipher_suite"] = header.cipher_suite;
+    audit["authentication_type"] = header.authentication_type;
+    audit["host_header"] = view.get(AUDIT_HOST_HEADER);
 
     Json::FastWriter fastWriter;
     return fastWriter.write(audit);
@@ -130,6 +313,16 @@ const std::string S3AuditInfo::to_string() {
   return "";
 }
 
+const char* S3AuditInfo::intern(const std::string& str) {
+  static std::mutex intern_lock;
+  // Never freed, records may be formatted during static destruction.
+  static std::unordered_set<std::string>* interned =
+      new std::unordered_set<std::string>();
+
+  std::lock_guard<std::mutex> guard(intern_lock);
+  return interned->insert(str).first->c_str();
+}
+
 void S3AuditInfo::set_bucket_owner_canonical_id(
     const std::string& bucket_owner_canonical_id_str) {
   bucket_owner_canonical_id = bucket_owner_canonical_id_str;
@@ -140,25 +333,8 @@ void S3AuditInfo::set_bucket_name(const std::string& bucket_str) {
 }
 
 void S3AuditInfo::set_time_of_request_arrival() {
-  time_t request_time;
-  struct tm* request_time_struct;
-  char time_of_request[REQUEST_TIME_SIZE];
-  time(&request_time);
-  request_time_struct = localtime(&request_time);
-
-  // Format specifiers required for strftime() as per
-  // https://docs.aws.amazon.com/AmazonS3/latest/dev/LogFormat.html :
-  //   %d = Day of the month (01-31)
-  //   %b = Abbreviated month name
-  //   %Y = The year as a decimal number including the century.
-  //   %H = Hour in 24h format (00-23)
-  //   %M = Minutes in decimal ranging from 00 to 59.
-  //   %S = The second as a decimal number (range 00 to 60).
-  //   %z = The +hhmm or -hhmm numeric timezone
-
-  strftime(time_of_request, sizeof(time_of_request), "[%d/%b/%Y:%H:%M:%S %z]",
-           request_time_struct);
-  time_of_request_arrival = time_of_request;
+  // Formatted together with the rest of the record.
+  time_of_request_arrival = time(nullptr);
 }
 
 void S3AuditInfo::set_remote_ip(const std::string& remote_ip_str) {
@@ -174,7 +350,7 @@ void S3AuditInfo::set_request_id(const std::string& request_id_str) {
 }
 
 void S3AuditInfo::set_operation(const std::string& operation_str) {
-  operation = operation_str;
+  operation = intern(operation_str);
 }
 
 void S3AuditInfo::set_object_key(const std::string& key_str) {
@@ -188,7 +364,7 @@ void S3AuditInfo::set_request_uri(const std::string& request_uri_str) {
 void S3AuditInfo::set_http_status(int httpstatus) { http_status = httpstatus; }
 
 void S3AuditInfo::set_error_code(const std::string& error_code_str) {
-  error_code = error_code_str;
+  error_code = intern(error_code_str);
 }
 
 void S3AuditInfo::set_bytes_sent(size_t total_bytes_sent) {
@@ -231,11 +407,9 @@ void S3AuditInfo::set_publish_flag(bool publish_flag) {
 
 void S3AuditInfo::set_signature_version(const std::string& authorization) {
   if (!authorization.empty()) {
-    std::regex auth_v2("(AWS )(.*)");
-    std::regex auth_v4("(AWS4-HMAC-SHA256)(.*)");
-    if (regex_match(authorization, auth_v2)) {
+    if (starts_with(authorization, "AWS ")) {
       signature_version = "SigV2";
-    } else if (regex_match(authorization, auth_v4)) {
+    } else if (starts_with(authorization, "AWS4-HMAC-SHA256")) {
       signature_version = "SigV4";
     } else {
       signature_version = "Unknown_Signature";
@@ -244,12 +418,12 @@ void S3AuditInfo::set_signature_version(const std::string& authorization) {
 }
 
 void S3AuditInfo::set_cipher_suite(const std::string& cipher_suite_str) {
-  cipher_suite = cipher_suite_str;
+  cipher_suite = intern(cipher_suite_str);
 }
 
 void S3AuditInfo::set_authentication_type(
     const std::string& authentication_type_str) {
-  authentication_type = authentication_type_str;
+  authentication_type = intern(authentication_type_str);
 }
 
 void S3AuditInfo::set_host_header(const std::string& host_header_str) {
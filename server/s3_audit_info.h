@@ -24,7 +24,9 @@
 #define __S3_SERVER_AUDIT_INFO_H__
 
 #include <iostream>
+#include <cstdint>
 #include <cstdlib>
+#include <ctime>
 #include <stdio.h>
 #include <string>
 #include <stdlib.h>
@@ -50,18 +52,19 @@ class S3AuditInfo {
                                           // bucket.
   std::string bucket;  // The name of the bucket that the request was processed
                        // against.
-  std::string time_of_request_arrival;  // The time at which the request was
-                                        // received.
+  time_t time_of_request_arrival;  // The time at which the request was
+                                   // received, -1 if not known.
   std::string remote_ip;   // The apparent internet address of s3 client.
   std::string requester;   // The canonical user ID of the requester
   std::string request_id;  // A string generated by S3 to uniquely identify each
                            // request.
-  std::string operation;   // The operation listed here is declared as
-                           // REST.HTTP_method.resource_type.
+  const char* operation;   // The operation listed here is declared as
+                           // REST.HTTP_method.resource_type. Interned.
   std::string object_key;  // The "key" part of the request
   std::string request_uri;  // The Request-URI part of the HTTP request message.
   int http_status;          // The numeric HTTP status code of the response.
-  std::string error_code;   // The S3 Error Code, or "-" if no error occurred.
+  const char* error_code;   // The S3 Error Code, or "-" if no error occurred.
+                            // Interned.
   size_t bytes_sent;        // The number of response bytes sent
   size_t object_size;       // The total size of the object in question.
   size_t bytes_received;    // The number of request bytes received by server.
@@ -74,13 +77,15 @@ class S3AuditInfo {
   std::string user_agent;  // The value of the HTTP User-Agent header.
   std::string version_id;  // The version ID in the request
   std::string host_id;     // The x-amz-id-2 or S3 extended request ID.
-  std::string signature_version;  // The signature version, SigV2 or SigV4, that
+  const char* signature_version;  // The signature version, SigV2 or SigV4, that
                                   // was used to authenticate the request.
-  std::string cipher_suite;  // The Secure Sockets Layer (SSL) cipher that was
-                             // negotiated for HTTPS request.
-  std::string authentication_type;  // The type of request authentication used,
+                                  // Interned.
+  const char* cipher_suite;  // The Secure Sockets Layer (SSL) cipher that was
+                             // negotiated for HTTPS request. Interned.
+  const char* authentication_type;  // The type of request authentication used,
                                     // AuthHeader for authentication headers,
                                     // QueryString for query string.
+                                    // Interned.
   std::string host_header;          // The endpoint used to connect to S3
 
   bool publish_log = true;  // Flag to disable audit log for healthchecks.
@@ -115,7 +120,22 @@ class S3AuditInfo {
   void set_publish_flag(bool publish_flag);
   bool get_publish_flag();
   const std::string to_string();
-  UInt64 convert_to_unsigned(size_t audit_member);
+  std::string to_string(AuditFormatType format_type) const;
+  static UInt64 convert_to_unsigned(size_t audit_member);
+
+  // Compact binary form of the record, so it can be queued with a memcpy
+  // and formatted later by another thread. Interned strings are referenced
+  // by pointer, other strings are copied.
+  size_t get_record_size() const;
+  void encode_record(char* record) const;
+  // Formats a record produced by encode_record().
+  static std::string format_record(const char* record,
+                                   AuditFormatType format_type);
+  static std::string get_record_request_id(const char* record);
+
+  // Returns a copy of 'str' which is never freed. It must only be used for
+  // strings which have a few distinct values.
+  static const char* intern(const std::string& str);
 };
 
 #endif
@@ -25,11 +25,13 @@
 #include "s3_audit_info_logger_log4cxx.h"
 #include "s3_audit_info_logger_syslog.h"
 #include "s3_audit_info_logger_kafka_web.h"
+#include "s3_audit_writer.h"
 
 #include <stdexcept>
 
 S3AuditInfoLoggerBase* S3AuditInfoLogger::audit_info_logger = nullptr;
 bool S3AuditInfoLogger::audit_info_logger_enabled = false;
+S3AuditWriter* S3AuditInfoLogger::audit_writer = nullptr;
 
 int S3AuditInfoLogger::init() {
   s3_log(S3_LOG_DEBUG, "", "%s Entry\n", __func__);
@@ -101,10 +103,31 @@ int S3AuditInfoLogger::init() {
     ret = -1;
   }
 
+  if (audit_info_logger) {
+    start_writer();
+  }
   s3_log(S3_LOG_DEBUG, "", "%s Exit ret %d\n", __func__, ret);
   return ret;
 }
 
+void S3AuditInfoLogger::start_writer() {
+  S3Option* option_instance = S3Option::get_instance();
+  if (!option_instance->is_audit_log_async_enabled()) {
+    return;
+  }
+  audit_writer = new S3AuditWriter(
+      audit_info_logger, option_instance->get_eventbase(),
+      option_instance->get_s3_audit_format_type(),
+      option_instance->get_audit_log_async_buffer_size_kb() * 1024);
+  int rc = audit_writer->start();
+  if (rc != 0) {
+    // Records are written synchronously.
+    s3_log(S3_LOG_ERROR, "", "Cannot start audit writer thread, rc %d\n", rc);
+    delete audit_writer;
+    audit_writer = nullptr;
+  }
+}
+
 int S3AuditInfoLogger::save_msg(std::string const& cur_request_id,
                                 std::string const& audit_logging_msg) {
   if (audit_info_logger) {
@@ -113,10 +136,21 @@ int S3AuditInfoLogger::save_msg(std::string const& cur_request_id,
   return 1;
 }
 
+int S3AuditInfoLogger::save_audit_info(std::string const& cur_request_id,
+                                       S3AuditInfo& audit_info) {
+  if (audit_writer && audit_writer->append(audit_info)) {
+    return 0;
+  }
+  return save_msg(cur_request_id, audit_info.to_string());
+}
+
 bool S3AuditInfoLogger::is_enabled() { return audit_info_logger_enabled; }
 
 void S3AuditInfoLogger::finalize() {
   s3_log(S3_LOG_DEBUG, "", "%s Entry\n", __func__);
+  // Writes out queued records.
+  delete audit_writer;
+  audit_writer = nullptr;
   delete audit_info_logger;
   audit_info_logger = nullptr;
   audit_info_logger_enabled = false;
@@ -23,20 +23,29 @@
 #ifndef __S3_SERVER_AUDIT_INFO_LOGGER__H__
 #define __S3_SERVER_AUDIT_INFO_LOGGER__H__
 
+#include "s3_audit_info.h"
 #include "s3_audit_info_logger_base.h"
 
 #include "gtest/gtest_prod.h"
 
+class S3AuditWriter;
+
 class S3AuditInfoLogger {
  private:
   static S3AuditInfoLoggerBase* audit_info_logger;
   static bool audit_info_logger_enabled;
+  static S3AuditWriter* audit_writer;
+
+  static void start_writer();
 
  public:
   static int init();
   static void finalize();
   static bool is_enabled();
   static int save_msg(std::string const&, std::string const&);
+  // Queues the record to be formatted and written by the writer thread,
+  // formats and writes it synchronously if the writer is not running.
+  static int save_audit_info(std::string const&, S3AuditInfo&);
   S3AuditInfoLogger() = delete;
 
  private:
@@ -29,6 +29,8 @@ class S3AuditInfoLoggerBase {
  public:
   virtual ~S3AuditInfoLoggerBase() = default;
   virtual int save_msg(std::string const&, std::string const&) = 0;
+  // Loggers which are not thread safe are called on the event loop only.
+  virtual bool is_thread_safe() const { return false; }
 };
 
 #endif
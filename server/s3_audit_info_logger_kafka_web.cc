@@ -22,6 +22,7 @@
 #include <map>
 
 #include "s3_log.h"
+#include "s3_option.h"
 #include "s3_audit_info_logger_kafka_web.h"
 #include "s3_http_post_queue.h"
 
@@ -34,8 +35,14 @@ S3AuditInfoLoggerKafkaWeb::S3AuditInfoLoggerKafkaWeb(evbase_t* p_base,
   std::map<std::string, std::string> headers;
   headers["Content-Type"] = "application/vnd.kafka.json.v2+json";
 
+  auto *option_instance = S3Option::get_instance();
+  // Records of a batch are sent as one Kafka REST produce request.
   p_s3_post_queue.reset(create_http_post_queue(
-      p_base, std::move(host_ip), port, std::move(path), std::move(headers)));
+      p_base, std::move(host_ip), port, std::move(path), std::move(headers),
+      S3HttpPostBatchFormat::json_array("{\"records\":[", "]}"),
+      option_instance->get_audit_logger_batch_max_records(),
+      option_instance->get_audit_logger_max_requests_in_flight(),
+      option_instance->is_audit_logger_compress_enabled()));
 }
 
 S3AuditInfoLoggerKafkaWeb::~S3AuditInfoLoggerKafkaWeb() = default;
@@ -45,8 +52,7 @@ int S3AuditInfoLoggerKafkaWeb::save_msg(std::string const& request_id,
   s3_log(S3_LOG_INFO, request_id, "%s Entry", __func__);
   s3_log(S3_LOG_DEBUG, request_id, "%s", msg.c_str());
 
-  std::string fmt_msg =
-      "{\"records\":[{\"key\":\"s3server\",\"value\":" + msg + "}]}";
+  std::string fmt_msg = "{\"key\":\"s3server\",\"value\":" + msg + "}";
   const bool fSucc = p_s3_post_queue->post(std::move(fmt_msg));
 
   s3_log(S3_LOG_DEBUG, request_id, "%s Exit", __func__);
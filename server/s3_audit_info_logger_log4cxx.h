@@ -32,6 +32,7 @@ class S3AuditInfoLoggerLog4cxx : public S3AuditInfoLoggerBase {
   S3AuditInfoLoggerLog4cxx(std::string const &, std::string const & = "");
   virtual ~S3AuditInfoLoggerLog4cxx();
   virtual int save_msg(std::string const &, std::string const &);
+  virtual bool is_thread_safe() const { return true; }
 
  private:
   log4cxx::LoggerPtr l4c_logger_ptr;
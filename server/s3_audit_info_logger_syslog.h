@@ -31,6 +31,7 @@ class S3AuditInfoLoggerSyslog : public S3AuditInfoLoggerBase {
                               "s3server-audit-logging");
   virtual ~S3AuditInfoLoggerSyslog();
   virtual int save_msg(std::string const &, std::string const &);
+  virtual bool is_thread_safe() const { return true; }
 
  private:
   std::string rsyslog_msg_filter;
@@ -0,0 +1,255 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include <chrono>
+
+#include <event2/event.h>
+
+#include "s3_audit_info_logger_base.h"
+#include "s3_audit_writer.h"
+#include "s3_log.h"
+
+// Ring buffer space is allocated in units of this size.
+#define S3_AUDIT_SLOT_ALIGN 8
+// How often the writer thread looks for new records.
+#define S3_AUDIT_WRITE_INTERVAL_MSEC 10
+
+// Precedes every record in the ring buffer, records which don't fit before
+// the end of the buffer are preceded by a padding slot.
+struct S3AuditSlot {
+  uint32_t size;  // including this header, multiple of S3_AUDIT_SLOT_ALIGN
+  uint32_t is_record;
+};
+static_assert(sizeof(S3AuditSlot) == S3_AUDIT_SLOT_ALIGN,
+              "Audit slot header must match alignment unit");
+
+static size_t align_slot(size_t size) {
+  return (size + S3_AUDIT_SLOT_ALIGN - 1) & ~(size_t)(S3_AUDIT_SLOT_ALIGN - 1);
+}
+
+S3AuditWriter::S3AuditWriter(S3AuditInfoLoggerBase* logger_,
+                             struct event_base* evbase_,
+                             AuditFormatType format_type_, size_t buffer_size)
+    : logger(logger_),
+      evbase(evbase_),
+      format_type(format_type_),
+      capacity(buffer_size & ~(size_t)(S3_AUDIT_SLOT_ALIGN - 1)) {}
+
+S3AuditWriter::~S3AuditWriter() { stop(); }
+
+int S3AuditWriter::start() {
+  if (running) {
+    return -EEXIST;
+  }
+  if (!logger || capacity < 2 * S3_AUDIT_SLOT_ALIGN) {
+    return -EINVAL;
+  }
+  if (!logger->is_thread_safe()) {
+    if (!evbase) {
+      s3_log(S3_LOG_ERROR, "", "Event base is needed to deliver audit logs\n");
+      return -EINVAL;
+    }
+    deliver_event = event_new(evbase, -1, 0, on_deliver_cb, this);
+    if (!deliver_event) {
+      s3_log(S3_LOG_ERROR, "", "event_new() failed\n");
+      return -ENOMEM;
+    }
+  }
+  buffer.reset(new char[capacity]);
+  ring_head = 0;
+  ring_tail = 0;
+  stopping = false;
+  flush_requested = false;
+  writer = std::thread(&S3AuditWriter::writer_main, this);
+  running = true;
+  return 0;
+}
+
+void S3AuditWriter::stop() {
+  if (!running) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> guard(writer_lock);
+    stopping = true;
+  }
+  writer_cond.notify_one();
+  writer.join();
+  running = false;
+
+  deliver();
+  if (deliver_event) {
+    event_free(deliver_event);
+    deliver_event = nullptr;
+  }
+  if (overflow_count) {
+    s3_log(S3_LOG_INFO, "", "%llu audit records were written synchronously\n",
+           (unsigned long long)overflow_count.load());
+  }
+  if (full_count) {
+    s3_log(S3_LOG_INFO, "", "Audit ring buffer was full %llu times\n",
+           (unsigned long long)full_count.load());
+  }
+}
+
+bool S3AuditWriter::has_space(size_t slot_size, size_t* padding) const {
+  const uint64_t head = ring_head.load(std::memory_order_relaxed);
+  const uint64_t tail = ring_tail.load(std::memory_order_acquire);
+  const size_t offset = head % capacity;
+
+  *padding = offset + slot_size > capacity ? capacity - offset : 0;
+  return head + *padding + slot_size - tail <= capacity;
+}
+
+bool S3AuditWriter::append(const S3AuditInfo& audit_info) {
+  if (!running) {
+    return false;
+  }
+  const size_t slot_size =
+      align_slot(sizeof(S3AuditSlot) + audit_info.get_record_size());
+  if (slot_size > capacity / 2) {
+    // Caller writes it after all queued records.
+    overflow_count.fetch_add(1, std::memory_order_relaxed);
+    flush();
+    deliver();
+    return false;
+  }
+  size_t padding = 0;
+  if (!has_space(slot_size, &padding)) {
+    full_count.fetch_add(1, std::memory_order_relaxed);
+    std::unique_lock<std::mutex> lock(writer_lock);
+    flush_requested = true;
+    writer_cond.notify_one();
+    flushed_cond.wait(lock, [this, slot_size, &padding]() {
+      return has_space(slot_size, &padding);
+    });
+  }
+  uint64_t head = ring_head.load(std::memory_order_relaxed);
+  size_t offset = head % capacity;
+  if (padding) {
+    const S3AuditSlot padding_slot = {(uint32_t)padding, 0};
+    memcpy(buffer.get() + offset, &padding_slot, sizeof(padding_slot));
+    head += padding;
+    offset = 0;
+  }
+  const S3AuditSlot slot = {(uint32_t)slot_size, 1};
+  memcpy(buffer.get() + offset, &slot, sizeof(slot));
+  audit_info.encode_record(buffer.get() + offset + sizeof(slot));
+
+  ring_head.store(head + slot_size, std::memory_order_release);
+  return true;
+}
+
+void S3AuditWriter::flush() {
+  if (!running) {
+    return;
+  }
+  const uint64_t head = ring_head.load(std::memory_order_acquire);
+  std::unique_lock<std::mutex> lock(writer_lock);
+  flush_requested = true;
+  writer_cond.notify_one();
+  flushed_cond.wait(lock, [this, head]() {
+    return ring_tail.load(std::memory_order_acquire) >= head;
+  });
+}
+
+void S3AuditWriter::writer_main() {
+  bool stop = false;
+  while (!stop) {
+    {
+      std::unique_lock<std::mutex> lock(writer_lock);
+      writer_cond.wait_for(
+          lock, std::chrono::milliseconds(S3_AUDIT_WRITE_INTERVAL_MSEC),
+          [this]() { return stopping || flush_requested; });
+      flush_requested = false;
+      // Records appended before stop() are drained below.
+      stop = stopping;
+    }
+    drain();
+    std::lock_guard<std::mutex> guard(writer_lock);
+    flushed_cond.notify_all();
+  }
+}
+
+void S3AuditWriter::drain() {
+  uint64_t tail = ring_tail.load(std::memory_order_relaxed);
+  const uint64_t head = ring_head.load(std::memory_order_acquire);
+  if (tail == head) {
+    return;
+  }
+  const bool on_loop = !logger->is_thread_safe();
+  std::vector<std::pair<std::string, std::string>> messages;
+
+  while (tail != head) {
+    const char* data = buffer.get() + tail % capacity;
+    S3AuditSlot slot;
+    memcpy(&slot, data, sizeof(slot));
+
+    if (slot.is_record) {
+      const char* record = data + sizeof(slot);
+      std::string request_id = S3AuditInfo::get_record_request_id(record);
+      std::string msg = S3AuditInfo::format_record(record, format_type);
+
+      if (on_loop) {
+        messages.emplace_back(std::move(request_id), std::move(msg));
+      } else {
+        save(request_id, msg);
+        // Free the space as soon as possible.
+        ring_tail.store(tail + slot.size, std::memory_order_release);
+      }
+    }
+    tail += slot.size;
+  }
+  if (on_loop) {
+    {
+      std::lock_guard<std::mutex> guard(deliver_lock);
+      for (auto& message : messages) {
+        to_deliver.push_back(std::move(message));
+      }
+    }
+    event_active(deliver_event, 0, 1);
+  }
+  ring_tail.store(tail, std::memory_order_release);
+}
+
+void S3AuditWriter::deliver() {
+  std::vector<std::pair<std::string, std::string>> messages;
+  {
+    std::lock_guard<std::mutex> guard(deliver_lock);
+    messages.swap(to_deliver);
+  }
+  for (auto& message : messages) {
+    save(message.first, message.second);
+  }
+}
+
+void S3AuditWriter::on_deliver_cb(evutil_socket_t, short, void* arg) {
+  static_cast<S3AuditWriter*>(arg)->deliver();
+}
+
+void S3AuditWriter::save(const std::string& request_id,
+                         const std::string& msg) {
+  if (logger->save_msg(request_id, msg) < 0) {
+    s3_log(S3_LOG_FATAL, request_id, "Audit Logger Error. STOP Server\n");
+  }
+}
@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+#pragma once
+
+#ifndef __S3_SERVER_S3_AUDIT_WRITER_H__
+#define __S3_SERVER_S3_AUDIT_WRITER_H__
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <event2/util.h>
+
+#include "s3_audit_info.h"
+
+class S3AuditInfoLoggerBase;
+struct event_base;
+struct event;
+
+// Formats and writes audit records in a dedicated thread.
+//
+// The event loop thread copies encoded records into a single producer,
+// single consumer ring buffer, the writer thread formats them and passes
+// them to the logger. Loggers which are not thread safe (rsyslog-tcp,
+// kafka-web) get formatted messages back on the event loop. When the ring
+// buffer is full, the event loop waits for the writer thread, so records
+// are neither dropped nor reordered.
+class S3AuditWriter {
+ public:
+  // 'evbase' is needed only for loggers which are not thread safe.
+  S3AuditWriter(S3AuditInfoLoggerBase* logger, struct event_base* evbase,
+                AuditFormatType format_type, size_t buffer_size);
+  ~S3AuditWriter();
+
+  int start();
+  // Writes out all queued records and stops the writer thread.
+  void stop();
+
+  // Must be called from the event loop thread. Returns false when the
+  // record wasn't queued and the caller has to write it synchronously,
+  // records queued before it are written out by then.
+  bool append(const S3AuditInfo& audit_info);
+  // Waits until all records appended so far are formatted.
+  void flush();
+  // Passes formatted messages to a logger which is not thread safe, called
+  // on the event loop.
+  void deliver();
+
+  uint64_t get_overflow_count() const {
+    return overflow_count.load(std::memory_order_relaxed);
+  }
+  uint64_t get_full_count() const {
+    return full_count.load(std::memory_order_relaxed);
+  }
+
+ private:
+  // Returns true if 'slot_size' bytes (with padding) fit into the ring.
+  bool has_space(size_t slot_size, size_t* padding) const;
+  void writer_main();
+  void drain();
+  void save(const std::string& request_id, const std::string& msg);
+
+  static void on_deliver_cb(evutil_socket_t, short, void* arg);
+
+  S3AuditInfoLoggerBase* const logger;
+  struct event_base* const evbase;
+  const AuditFormatType format_type;
+
+  std::unique_ptr<char[]> buffer;
+  size_t capacity;
+  std::atomic<uint64_t> ring_head{0};  // written by the event loop
+  std::atomic<uint64_t> ring_tail{0};  // written by the writer thread
+
+  std::atomic<bool> running{false};
+  std::mutex writer_lock;
+  std::condition_variable writer_cond;
+  std::condition_variable flushed_cond;
+  bool stopping = false;
+  bool flush_requested = false;
+  std::thread writer;
+
+  // Formatted messages waiting for the event loop, pair<request id, msg>
+  std::mutex deliver_lock;
+  std::vector<std::pair<std::string, std::string>> to_deliver;
+  struct event* deliver_event = nullptr;
+
+  // Records too big for the ring buffer, written synchronously.
+  std::atomic<uint64_t> overflow_count{0};
+  // Times append() waited for the writer thread to free space.
+  std::atomic<uint64_t> full_count{0};
+};
+
+#endif
@@ -945,6 +945,23 @@ void S3AuthClient::execute_authconnect_request(
   req_body_buffer = NULL;
 }
 
+static const char *get_op_name(S3AuthClientOpType op_type,
+                               bool is_chunked_auth) {
+  switch (op_type) {
+    case S3AuthClientOpType::authentication:
+      return is_chunked_auth ? "chunk_authentication" : "authentication";
+    case S3AuthClientOpType::authorization:
+      return "authorization";
+    case S3AuthClientOpType::combo_auth:
+      return "combo_auth";
+    case S3AuthClientOpType::aclvalidation:
+      return "acl_validation";
+    case S3AuthClientOpType::policyvalidation:
+      return "policy_validation";
+  }
+  return "auth";
+}
+
 void S3AuthClient::trigger_request() {
   s3_log(S3_LOG_DEBUG, request_id, "%s Entry\n", __func__);
 
@@ -987,6 +1004,9 @@ void S3AuthClient::trigger_request() {
            sz_request);
     ::free(sz_request);
   }
+  const char *op_name = get_op_name(op_type, is_chunked_auth);
+  trace_span = S3_TRACE_BEGIN(request, op_name, S3TraceCategory::auth);
+  request->async_op_started(op_name);
   execute_authconnect_request(auth_context->get_auth_op_ctx());
 
   at_exit_on_error.cancel();
@@ -1060,6 +1080,8 @@ void S3AuthClient::validate_policy(std::function<void(void)> on_success,
 
 void S3AuthClient::on_common_success() {
   s3_log(S3_LOG_DEBUG, request_id, "%s Entry\n", __func__);
+  S3_TRACE_END(request, trace_span);
+  request->async_op_finished();
   state = S3AuthClientOpState::succeded;
 
   unsigned addb_type;
@@ -1093,6 +1115,8 @@ void S3AuthClient::on_common_success() {
 
 void S3AuthClient::on_common_failed() {
   s3_log(S3_LOG_DEBUG, request_id, "%s Entry\n", __func__);
+  S3_TRACE_END(request, trace_span);
+  request->async_op_finished();
   state = S3AuthClientOpState::failed;
 
   unsigned addb_type;
@@ -1293,6 +1317,8 @@ void S3AuthClient::add_last_checksum_for_chunk(std::string current_sign,
 
 void S3AuthClient::chunk_auth_successful() {
   s3_log(S3_LOG_DEBUG, request_id, "%s Entry\n", __func__);
+  S3_TRACE_END(request, trace_span);
+  request->async_op_finished();
   state = S3AuthClientOpState::succeded;
 
   ADDB_AUTH(ACTS_AUTH_CLNT_CHUNK_AUTH_SUCC);
@@ -1322,6 +1348,8 @@ void S3AuthClient::chunk_auth_successful() {
 
 void S3AuthClient::chunk_auth_failed() {
   s3_log(S3_LOG_DEBUG, request_id, "%s Entry\n", __func__);
+  S3_TRACE_END(request, trace_span);
+  request->async_op_finished();
   state = S3AuthClientOpState::failed;
 
   ADDB_AUTH(ACTS_AUTH_CLNT_CHUNK_AUTH_FAILED);
@@ -171,6 +171,8 @@ class S3AuthClient {
   bool is_authheader_present;
 
   bool skip_authorization;
+  // Request trace span of the running auth request
+  int trace_span = -1;
 
   void trigger_request(std::function<void(void)> on_success,
                        std::function<void(void)> on_failed);
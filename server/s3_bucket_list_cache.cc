@@ -0,0 +1,345 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#include <utility>
+
+#include "s3_bucket_list_cache.h"
+#include "s3_log.h"
+
+// Reads JSON text without building values, only strings which are asked for
+// are copied out.
+class S3JsonScanner {
+  const char* pos;
+  const char* const end;
+
+  // Objects and arrays nested deeper are treated as invalid.
+  static const unsigned max_depth = 64;
+
+  static int hex_digit(char c) {
+    if (c >= '0' && c <= '9') {
+      return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+      return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+      return c - 'A' + 10;
+    }
+    return -1;
+  }
+
+  bool read_hex4(unsigned& code) {
+    if (end - pos < 4) {
+      return false;
+    }
+    code = 0;
+    for (int i = 0; i < 4; ++i) {
+      const int digit = hex_digit(*pos++);
+      if (digit < 0) {
+        return false;
+      }
+      code = (code << 4) | (unsigned)digit;
+    }
+    return true;
+  }
+
+  static void append_utf8(unsigned code, std::string& out) {
+    if (code < 0x80) {
+      out += (char)code;
+    } else if (code < 0x800) {
+      out += (char)(0xC0 | (code >> 6));
+      out += (char)(0x80 | (code & 0x3F));
+    } else if (code < 0x10000) {
+      out += (char)(0xE0 | (code >> 12));
+      out += (char)(0x80 | ((code >> 6) & 0x3F));
+      out += (char)(0x80 | (code & 0x3F));
+    } else {
+      out += (char)(0xF0 | (code >> 18));
+      out += (char)(0x80 | ((code >> 12) & 0x3F));
+      out += (char)(0x80 | ((code >> 6) & 0x3F));
+      out += (char)(0x80 | (code & 0x3F));
+    }
+  }
+
+  // \uXXXX after the backslash and 'u', including a surrogate pair.
+  bool read_unicode_escape(std::string* out) {
+    unsigned code;
+    if (!read_hex4(code)) {
+      return false;
+    }
+    if (code >= 0xD800 && code <= 0xDBFF) {
+      unsigned low;
+      if (end - pos < 2 || pos[0] != '\\' || pos[1] != 'u') {
+        return false;
+      }
+      pos += 2;
+      if (!read_hex4(low) || low < 0xDC00 || low > 0xDFFF) {
+        return false;
+      }
+      code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+    }
+    if (out) {
+      append_utf8(code, *out);
+    }
+    return true;
+  }
+
+ public:
+  explicit S3JsonScanner(const std::string& json)
+      : pos(json.data()), end(json.data() + json.size()) {}
+
+  void skip_spaces() {
+    while (pos < end &&
+           (*pos == ' ' || *pos == '\n' || *pos == '\r' || *pos == '\t')) {
+      ++pos;
+    }
+  }
+
+  // Skips spaces, then consumes 'c' if it is next.
+  bool consume(char c) {
+    skip_spaces();
+    if (pos < end && *pos == c) {
+      ++pos;
+      return true;
+    }
+    return false;
+  }
+
+  bool next_is(char c) {
+    skip_spaces();
+    return pos < end && *pos == c;
+  }
+
+  // Reads a string, unescaped into 'out' unless it is nullptr.
+  bool read_string(std::string* out) {
+    if (!consume('"')) {
+      return false;
+    }
+    while (pos < end) {
+      // Copy unescaped runs at once.
+      const char* run = pos;
+      while (pos < end && *pos != '"' && *pos != '\\') {
+        ++pos;
+      }
+      if (out) {
+        out->append(run, pos - run);
+      }
+      if (pos == end) {
+        break;
+      }
+      if (*pos++ == '"') {
+        return true;
+      }
+      if (pos == end) {
+        break;
+      }
+      char c = *pos++;
+      switch (c) {
+        case '"':
+        case '\\':
+        case '/':
+          break;
+        case 'b':
+          c = '\b';
+          break;
+        case 'f':
+          c = '\f';
+          break;
+        case 'n':
+          c = '\n';
+          break;
+        case 'r':
+          c = '\r';
+          break;
+        case 't':
+          c = '\t';
+          break;
+        case 'u':
+          if (!read_unicode_escape(out)) {
+            return false;
+          }
+          continue;
+        default:
+          return false;
+      }
+      if (out) {
+        *out += c;
+      }
+    }
+    return false;
+  }
+
+  // Reads members of an object, calls on_member(key) which has to read or
+  // skip the value.
+  template <typename OnMember>
+  bool read_object(OnMember on_member) {
+    if (!consume('{')) {
+      return false;
+    }
+    if (consume('}')) {
+      return true;
+    }
+    std::string key;
+    do {
+      key.clear();
+      if (!read_string(&key) || !consume(':') || !on_member(key)) {
+        return false;
+      }
+    } while (consume(','));
+    return consume('}');
+  }
+
+  bool skip_value(unsigned depth = 0) {
+    if (depth > max_depth) {
+      return false;
+    }
+    skip_spaces();
+    if (pos == end) {
+      return false;
+    }
+    switch (*pos) {
+      case '"':
+        return read_string(nullptr);
+      case '{':
+        return read_object([this, depth](const std::string&) {
+          return skip_value(depth + 1);
+        });
+      case '[':
+        ++pos;
+        if (consume(']')) {
+          return true;
+        }
+        do {
+          if (!skip_value(depth + 1)) {
+            return false;
+          }
+        } while (consume(','));
+        return consume(']');
+    }
+    // Number, true, false or null.
+    const char* start = pos;
+    while (pos < end && ((*pos >= '0' && *pos <= '9') ||
+                         (*pos >= 'a' && *pos <= 'z') || *pos == '-' ||
+                         *pos == '+' || *pos == '.' || *pos == 'E')) {
+      ++pos;
+    }
+    return pos != start;
+  }
+};
+
+bool s3_bucket_list_entry_from_json(const std::string& json,
+                                    S3BucketListEntry& entry) {
+  S3JsonScanner scanner(json);
+  entry.name.clear();
+  entry.creation_date.clear();
+
+  return scanner.read_object([&scanner, &entry](const std::string& key) {
+    if (key == "Bucket-Name" && scanner.next_is('"')) {
+      entry.name.clear();
+      return scanner.read_string(&entry.name);
+    }
+    if (key == "System-Defined" && scanner.next_is('{')) {
+      return scanner.read_object([&scanner, &entry](const std::string& key) {
+        if (key == "Date" && scanner.next_is('"')) {
+          entry.creation_date.clear();
+          return scanner.read_string(&entry.creation_date);
+        }
+        return scanner.skip_value();
+      });
+    }
+    return scanner.skip_value();
+  });
+}
+
+S3BucketListCache* S3BucketListCache::p_instance;
+
+S3BucketListCache::S3BucketListCache(unsigned max_accounts_,
+                                     unsigned expire_sec)
+    : max_accounts(max_accounts_),
+      expire_interval(std::chrono::seconds(expire_sec)) {
+  if (p_instance) {
+    s3_log(S3_LOG_FATAL, "",
+           "Only one instance of S3BucketListCache is allowed");
+  }
+  p_instance = this;
+}
+
+S3BucketListCache::~S3BucketListCache() { p_instance = nullptr; }
+
+const std::vector<S3BucketListEntry>* S3BucketListCache::find(
+    const std::string& account_id) {
+  auto it = accounts.find(account_id);
+  if (it == accounts.end()) {
+    return nullptr;
+  }
+  if (is_expired(it->second, Clock::now())) {
+    accounts.erase(it);
+    return nullptr;
+  }
+  return &it->second.buckets;
+}
+
+void S3BucketListCache::shrink(Clock::time_point now) {
+  auto oldest = accounts.end();
+  for (auto it = accounts.begin(); it != accounts.end();) {
+    if (is_expired(it->second, now)) {
+      it = accounts.erase(it);
+      continue;
+    }
+    if (oldest == accounts.end() ||
+        it->second.load_time < oldest->second.load_time) {
+      oldest = it;
+    }
+    ++it;
+  }
+  if (accounts.size() >= max_accounts && oldest != accounts.end()) {
+    accounts.erase(oldest);
+  }
+}
+
+void S3BucketListCache::add(const std::string& account_id, uint64_t token,
+                            std::vector<S3BucketListEntry> buckets) {
+  if (token != invalidations_count || max_accounts == 0) {
+    return;
+  }
+  const Clock::time_point now = Clock::now();
+  auto it = accounts.find(account_id);
+  if (it == accounts.end()) {
+    if (accounts.size() >= max_accounts) {
+      shrink(now);
+    }
+    it = accounts.emplace(account_id, AccountBuckets()).first;
+  }
+  it->second.buckets = std::move(buckets);
+  it->second.load_time = now;
+}
+
+void S3BucketListCache::invalidate(const std::string& account_id) {
+  ++invalidations_count;
+  accounts.erase(account_id);
+}
+
+void s3_bucket_list_cache_invalidate(const std::string& account_id) {
+  S3BucketListCache* cache = S3BucketListCache::get_instance();
+  if (cache) {
+    cache->invalidate(account_id);
+  }
+}
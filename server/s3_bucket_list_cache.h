@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#pragma once
+
+#ifndef __S3_SERVER_S3_BUCKET_LIST_CACHE_H__
+#define __S3_SERVER_S3_BUCKET_LIST_CACHE_H__
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// What ListBuckets (GET service) returns about a bucket.
+struct S3BucketListEntry {
+  std::string name;
+  std::string creation_date;
+};
+
+// Extracts "Bucket-Name" and "System-Defined"/"Date" from bucket metadata
+// JSON, see S3BucketMetadata::to_json(), skipping all other members without
+// building a JSON tree.  Members which are missing are left empty.  Returns
+// false if 'json' is not a valid JSON object.
+bool s3_bucket_list_entry_from_json(const std::string& json,
+                                    S3BucketListEntry& entry);
+
+// Bucket lists of accounts, sorted by bucket name as in the global bucket
+// list index, so that repeated ListBuckets of an account do not scan the
+// index.  A list is dropped when a bucket of the account is created or
+// deleted through this instance, and expires after expire_sec to bound how
+// long changes made through other instances are not seen.
+//
+// Single instance created in main() when S3_BUCKET_LIST_CACHE_MAX_ACCOUNTS is
+// not 0.  Used on the main thread only.
+class S3BucketListCache {
+  using Clock = std::chrono::steady_clock;
+
+  struct AccountBuckets {
+    std::vector<S3BucketListEntry> buckets;
+    Clock::time_point load_time;
+  };
+
+  static S3BucketListCache* p_instance;
+
+  size_t max_accounts;
+  Clock::duration expire_interval;
+  std::unordered_map<std::string, AccountBuckets> accounts;
+  // Incremented by invalidate(), see begin_load().
+  uint64_t invalidations_count = 0;
+
+  bool is_expired(const AccountBuckets& account, Clock::time_point now) const {
+    return now - account.load_time >= expire_interval;
+  }
+  // Makes room for one more account.
+  void shrink(Clock::time_point now);
+
+ public:
+  S3BucketListCache(unsigned max_accounts, unsigned expire_sec);
+  ~S3BucketListCache();
+
+  S3BucketListCache(const S3BucketListCache&) = delete;
+  S3BucketListCache& operator=(const S3BucketListCache&) = delete;
+
+  // Returns nullptr when the cache is disabled.
+  static S3BucketListCache* get_instance() { return p_instance; }
+
+  // Returns nullptr if the account's list is not cached or expired.
+  const std::vector<S3BucketListEntry>* find(const std::string& account_id);
+
+  // Called before the list is read from the index, returns the token to pass
+  // to add().
+  uint64_t begin_load() const { return invalidations_count; }
+  // Caches the list read since begin_load() returned 'token'.  The list is
+  // dropped if any account was invalidated meanwhile, since it may have been
+  // read before the change.
+  void add(const std::string& account_id, uint64_t token,
+           std::vector<S3BucketListEntry> buckets);
+  void invalidate(const std::string& account_id);
+
+  size_t get_count() const { return accounts.size(); }
+};
+
+// Called once a bucket of the account is created or deleted, no-op when the
+// cache is disabled.
+void s3_bucket_list_cache_invalidate(const std::string& account_id);
+
+#endif
@@ -0,0 +1,979 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#include <errno.h>
+#include <inttypes.h>
+#include <json/json.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "atexit.h"
+#include "motr_request_object.h"
+#include "s3_bucket_metadata.h"
+#include "s3_bucket_usage.h"
+#include "s3_log.h"
+#include "s3_m0_uint128_helper.h"
+#include "s3_motr_kvs_reader.h"
+#include "s3_motr_kvs_writer.h"
+#include "s3_object_metadata.h"
+#include "s3_option.h"
+#include "s3_stats.h"
+
+extern S3Option* g_option_instance;
+extern struct m0_uint128 bucket_usage_index_oid;
+extern struct m0_uint128 bucket_metadata_list_index_oid;
+
+void S3BucketUsageCounters::add(const S3BucketUsageCounters& other) {
+  objects_count += other.objects_count;
+  bytes_used += other.bytes_used;
+}
+
+std::string S3BucketUsageCounters::to_json() const {
+  Json::Value root;
+  root["objects_count"] = (Json::Int64)objects_count;
+  root["bytes_used"] = (Json::Int64)bytes_used;
+  Json::FastWriter fast_writer;
+  return fast_writer.write(root);
+}
+
+bool S3BucketUsageCounters::from_json(const std::string& json) {
+  Json::Value root;
+  Json::Reader reader;
+  if (!reader.parse(json, root) || !root.isObject()) {
+    return false;
+  }
+  objects_count = root["objects_count"].asInt64();
+  bytes_used = root["bytes_used"].asInt64();
+  return true;
+}
+
+S3BucketUsageQuery::S3BucketUsageQuery(
+    std::weak_ptr<S3BucketUsage> bucket_usage, std::string key,
+    CallbackType on_done)
+    : usage(std::move(bucket_usage)),
+      bucket_key(std::move(key)),
+      callback(std::move(on_done)) {}
+
+void S3BucketUsageQuery::run() { list_records(bucket_key + "/"); }
+
+void S3BucketUsageQuery::list_records(const std::string& marker) {
+  std::shared_ptr<S3BucketUsage> owner = usage.lock();
+  if (!owner) {
+    done(-ECANCELED);
+    return;
+  }
+  motr_kv_reader = owner->motr_kvs_reader_factory->create_motr_kvs_reader(
+      owner->request, owner->s3_motr_api);
+  auto self = shared_from_this();
+  motr_kv_reader->next_keyval(
+      owner->usage_index_oid, marker,
+      S3Option::get_instance()->get_motr_idx_fetch_count(),
+      [self]() { self->list_records_successful(); },
+      [self]() { self->list_records_failed(); });
+}
+
+void S3BucketUsageQuery::list_records_successful() {
+  std::shared_ptr<S3BucketUsage> owner = usage.lock();
+  if (!owner) {
+    done(-ECANCELED);
+    return;
+  }
+  const std::string prefix = bucket_key + "/";
+  const std::string own_key = owner->get_record_key(bucket_key);
+  const std::string reconciled_key =
+      S3BucketUsage::get_reconciled_key(bucket_key);
+  auto& kvps = motr_kv_reader->get_key_values();
+  std::string last_key;
+  for (auto& kv : kvps) {
+    if (kv.first.compare(0, prefix.length(), prefix) != 0) {
+      // Past the records of this bucket.
+      done(0);
+      return;
+    }
+    last_key = kv.first;
+    S3BucketUsageCounters counters;
+    if (!counters.from_json(kv.second.second)) {
+      s3_log(S3_LOG_ERROR, "", "Invalid bucket usage record %s\n",
+             kv.first.c_str());
+      continue;
+    }
+    if (kv.first == own_key) {
+      own_in_index = counters;
+    } else {
+      if (kv.first == reconciled_key) {
+        reconciled = counters;
+      }
+      total.add(counters);
+    }
+  }
+  if (kvps.size() < (size_t)S3Option::get_instance()
+                        ->get_motr_idx_fetch_count()) {
+    done(0);
+  } else {
+    list_records(last_key);
+  }
+}
+
+void S3BucketUsageQuery::list_records_failed() {
+  if (motr_kv_reader->get_state() == S3MotrKVSReaderOpState::missing) {
+    done(0);
+  } else {
+    s3_log(S3_LOG_ERROR, "", "Failed to list usage of bucket %s\n",
+           bucket_key.c_str());
+    done(motr_kv_reader->get_state() ==
+                 S3MotrKVSReaderOpState::failed_to_launch
+             ? -EAGAIN
+             : -EIO);
+  }
+}
+
+void S3BucketUsageQuery::done(int rc) {
+  S3BucketUsageCounters result;
+  std::shared_ptr<S3BucketUsage> owner = usage.lock();
+  if (!owner) {
+    // Stopped meanwhile.  The reader, if any, is left with this object, the
+    // process is exiting.
+    rc = -ECANCELED;
+  } else if (rc == 0) {
+    owner->summed[bucket_key] = {total, own_in_index, time(nullptr)};
+    result = owner->add_own(bucket_key, total, own_in_index);
+    if (result.objects_count < 0 || result.bytes_used < 0) {
+      // E.g. objects which existed before usage was enabled were deleted,
+      // kept as is until reconciliation corrects it.
+      s3_log(S3_LOG_WARN, "",
+             "Negative usage of bucket %s: %" PRId64 " objects, %" PRId64
+             " bytes\n",
+             bucket_key.c_str(), result.objects_count, result.bytes_used);
+    }
+  }
+  if (owner) {
+    owner->finished.push_back(shared_from_this());
+  }
+  callback(rc, result);
+}
+
+void S3BucketUsageQuery::release() { motr_kv_reader.reset(); }
+
+std::string S3BucketUsageLease::to_json() const {
+  Json::Value root;
+  root["instance_id"] = instance_id;
+  root["renewed"] = (Json::Int64)renewed;
+  root["last_run"] = (Json::Int64)last_run;
+  Json::FastWriter fast_writer;
+  return fast_writer.write(root);
+}
+
+bool S3BucketUsageLease::from_json(const std::string& json) {
+  Json::Value root;
+  Json::Reader reader;
+  if (!reader.parse(json, root) || !root.isObject()) {
+    return false;
+  }
+  instance_id = root["instance_id"].asString();
+  renewed = (time_t)root["renewed"].asInt64();
+  last_run = (time_t)root["last_run"].asInt64();
+  return true;
+}
+
+static time_t get_flush_interval() {
+  return std::max(
+      1U, S3Option::get_instance()->get_bucket_usage_flush_interval_sec());
+}
+
+S3BucketUsageReconciler::S3BucketUsageReconciler(
+    std::weak_ptr<S3BucketUsage> bucket_usage)
+    : usage(std::move(bucket_usage)) {}
+
+S3BucketUsageCounters S3BucketUsageReconciler::get_correction(
+    const S3BucketUsageCounters& counted, const S3BucketUsageCounters& total,
+    const S3BucketUsageCounters& reconciled) {
+  S3BucketUsageCounters correction = reconciled;
+  correction.objects_count += counted.objects_count - total.objects_count;
+  correction.bytes_used += counted.bytes_used - total.bytes_used;
+  return correction;
+}
+
+void S3BucketUsageReconciler::run() {
+  start_time = time(nullptr);
+  read_lease();
+}
+
+void S3BucketUsageReconciler::tick() {
+  if (resume && time(nullptr) >= resume_time) {
+    void (S3BucketUsageReconciler::*step)() = resume;
+    resume = nullptr;
+    (this->*step)();
+  }
+  // Lease is written from here only, never from a callback of lease writer.
+  if (!elected || lease_writing || finished) {
+    return;
+  }
+  if (finishing) {
+    release_lease();
+  } else {
+    renew_lease();
+  }
+}
+
+void S3BucketUsageReconciler::wait(time_t seconds,
+                                   void (S3BucketUsageReconciler::*step)()) {
+  resume_time = time(nullptr) + seconds;
+  resume = step;
+}
+
+void S3BucketUsageReconciler::read_lease() {
+  std::shared_ptr<S3BucketUsage> owner = usage.lock();
+  if (!owner || owner->stopped) {
+    done();
+    return;
+  }
+  motr_kv_reader = owner->motr_kvs_reader_factory->create_motr_kvs_reader(
+      owner->request, owner->s3_motr_api);
+  auto self = shared_from_this();
+  motr_kv_reader->get_keyval(owner->usage_index_oid,
+                             S3_BUCKET_USAGE_LEASE_RECORD,
+                             [self]() { self->read_lease_successful(); },
+                             [self]() { self->read_lease_failed(); });
+}
+
+void S3BucketUsageReconciler::read_lease_successful() {
+  S3BucketUsageLease current;
+  if (!current.from_json(motr_kv_reader->get_value())) {
+    // Taken over rather than never reconciling again.
+    s3_log(S3_LOG_ERROR, "", "Invalid bucket usage lease record\n");
+    current = S3BucketUsageLease();
+  }
+  lease_read(current);
+}
+
+void S3BucketUsageReconciler::read_lease_failed() {
+  if (motr_kv_reader->get_state() == S3MotrKVSReaderOpState::missing) {
+    lease_read(S3BucketUsageLease());
+  } else {
+    s3_log(S3_LOG_ERROR, "", "Failed to read bucket usage lease record\n");
+    done();
+  }
+}
+
+void S3BucketUsageReconciler::lease_read(const S3BucketUsageLease& current) {
+  std::shared_ptr<S3BucketUsage> owner = usage.lock();
+  if (!owner) {
+    done();
+    return;
+  }
+  if (claimed) {
+    if (current.instance_id != owner->instance_id) {
+      s3_log(S3_LOG_INFO, "", "Bucket usage is reconciled by instance %s\n",
+             current.instance_id.c_str());
+      done();
+      return;
+    }
+    elected = true;
+    s3_log(S3_LOG_INFO, "", "Bucket usage reconciliation started\n");
+    list_buckets("");
+    return;
+  }
+  time_t now = time(nullptr);
+  if (current.instance_id != owner->instance_id &&
+      now - current.renewed <
+          S3_BUCKET_USAGE_LEASE_TIMEOUT_FLUSHES * get_flush_interval()) {
+    s3_log(S3_LOG_DEBUG, "", "Bucket usage is reconciled by instance %s\n",
+           current.instance_id.c_str());
+    done();
+    return;
+  }
+  if (now - current.last_run <
+      (time_t)S3Option::get_instance()
+          ->get_bucket_usage_reconcile_interval_sec()) {
+    s3_log(S3_LOG_DEBUG, "", "Bucket usage was reconciled recently\n");
+    done();
+    return;
+  }
+  claimed = true;
+  lease.instance_id = owner->instance_id;
+  lease.renewed = now;
+  lease.last_run = current.last_run;
+  write_lease(&S3BucketUsageReconciler::lease_claimed);
+}
+
+void S3BucketUsageReconciler::write_lease(
+    void (S3BucketUsageReconciler::*on_done)(bool saved)) {
+  std::shared_ptr<S3BucketUsage> owner = usage.lock();
+  if (!owner) {
+    if (on_done) {
+      (this->*on_done)(false);
+    }
+    return;
+  }
+  lease_writing = true;
+  lease_writer = owner->motr_kvs_writer_factory->create_motr_kvs_writer(
+      owner->request, owner->s3_motr_api);
+  auto self = shared_from_this();
+  lease_writer->put_keyval(
+      owner->usage_index_oid, S3_BUCKET_USAGE_LEASE_RECORD, lease.to_json(),
+      [self, on_done]() {
+        self->lease_writing = false;
+        if (on_done) {
+          (self.get()->*on_done)(true);
+        }
+      },
+      [self, on_done]() {
+        s3_log(S3_LOG_ERROR, "", "Failed to write bucket usage lease record\n");
+        self->lease_writing = false;
+        if (on_done) {
+          (self.get()->*on_done)(false);
+        }
+      });
+}
+
+void S3BucketUsageReconciler::lease_claimed(bool saved) {
+  if (!saved) {
+    done();
+    return;
+  }
+  // Concurrent claims are written within a flush interval, the last one
+  // wins.
+  wait(get_flush_interval(), &S3BucketUsageReconciler::read_lease);
+}
+
+void S3BucketUsageReconciler::renew_lease() {
+  time_t now = time(nullptr);
+  if (now - lease.renewed < get_flush_interval()) {
+    return;
+  }
+  lease.renewed = now;
+  // Failure is not retried, the lease is renewed again on the next tick.
+  write_lease(nullptr);
+}
+
+void S3BucketUsageReconciler::release_lease() {
+  // Next run is due an interval after this one started, on any instance.
+  lease.renewed = 0;
+  lease.last_run = start_time;
+  write_lease(&S3BucketUsageReconciler::lease_released);
+}
+
+void S3BucketUsageReconciler::lease_released(bool saved) { finish(); }
+
+void S3BucketUsageReconciler::list_buckets(const std::string& marker) {
+  std::shared_ptr<S3BucketUsage> owner = usage.lock();
+  if (!owner) {
+    done();
+    return;
+  }
+  motr_kv_reader = owner->motr_kvs_reader_factory->create_motr_kvs_reader(
+      owner->request, owner->s3_motr_api);
+  auto self = shared_from_this();
+  motr_kv_reader->next_keyval(
+      bucket_metadata_list_index_oid, marker,
+      S3Option::get_instance()->get_motr_idx_fetch_count(),
+      [self]() { self->list_buckets_successful(); },
+      [self]() { self->list_buckets_failed(); });
+}
+
+void S3BucketUsageReconciler::list_buckets_successful() {
+  auto& kvps = motr_kv_reader->get_key_values();
+  std::string last_key;
+  for (auto& kv : kvps) {
+    last_key = kv.first;
+    Json::Value root;
+    Json::Reader reader;
+    if (!reader.parse(kv.second.second, root) || !root.isObject()) {
+      s3_log(S3_LOG_ERROR, "", "Invalid bucket metadata %s\n",
+             kv.first.c_str());
+      continue;
+    }
+    Bucket listed;
+    listed.list_index_oid = S3M0Uint128Helper::to_m0_uint128(
+        root["motr_object_list_index_oid"].asString());
+    if (S3M0Uint128Helper::zero(listed.list_index_oid)) {
+      continue;
+    }
+    listed.key = S3BucketUsage::get_bucket_key(listed.list_index_oid);
+    buckets.push_back(listed);
+  }
+  if (kvps.size() < (size_t)S3Option::get_instance()
+                        ->get_motr_idx_fetch_count()) {
+    next_bucket();
+  } else {
+    list_buckets(last_key);
+  }
+}
+
+void S3BucketUsageReconciler::list_buckets_failed() {
+  if (motr_kv_reader->get_state() == S3MotrKVSReaderOpState::missing) {
+    next_bucket();
+  } else {
+    s3_log(S3_LOG_ERROR, "", "Failed to list buckets for usage "
+                             "reconciliation\n");
+    done();
+  }
+}
+
+void S3BucketUsageReconciler::next_bucket() {
+  std::shared_ptr<S3BucketUsage> owner = usage.lock();
+  if (!owner || owner->stopped) {
+    done();
+    return;
+  }
+  if (buckets.empty()) {
+    // Every instance writes the changes counted by the scan within a flush
+    // interval.
+    wait(2 * get_flush_interval(), &S3BucketUsageReconciler::next_correction);
+    return;
+  }
+  bucket = buckets.front();
+  buckets.pop_front();
+  auto self = shared_from_this();
+  query = std::make_shared<S3BucketUsageQuery>(
+      usage, bucket.key, [self](int rc, const S3BucketUsageCounters& total) {
+        self->sum_before_done(rc, total);
+      });
+  query->run();
+}
+
+void S3BucketUsageReconciler::sum_before_done(
+    int rc, const S3BucketUsageCounters& total) {
+  if (rc != 0) {
+    next_bucket();
+    return;
+  }
+  bucket.before = total;
+  bucket.counted = S3BucketUsageCounters();
+  count_objects("");
+}
+
+void S3BucketUsageReconciler::count_objects(const std::string& marker) {
+  std::shared_ptr<S3BucketUsage> owner = usage.lock();
+  if (!owner) {
+    done();
+    return;
+  }
+  motr_kv_reader = owner->motr_kvs_reader_factory->create_motr_kvs_reader(
+      owner->request, owner->s3_motr_api);
+  auto self = shared_from_this();
+  motr_kv_reader->next_keyval(
+      bucket.list_index_oid, marker,
+      S3Option::get_instance()->get_motr_idx_fetch_count(),
+      [self]() { self->count_objects_successful(); },
+      [self]() { self->count_objects_failed(); });
+}
+
+void S3BucketUsageReconciler::count_objects_successful() {
+  auto& kvps = motr_kv_reader->get_key_values();
+  std::string last_key;
+  for (auto& kv : kvps) {
+    last_key = kv.first;
+    Json::Value root;
+    Json::Reader reader;
+    if (!reader.parse(kv.second.second, root) || !root.isObject()) {
+      s3_log(S3_LOG_ERROR, "", "Invalid object metadata %s\n",
+             kv.first.c_str());
+      continue;
+    }
+    bucket.counted.objects_count += 1;
+    bucket.counted.bytes_used +=
+        atoll(root["System-Defined"]["Content-Length"].asString().c_str());
+  }
+  if (kvps.size() < (size_t)S3Option::get_instance()
+                        ->get_motr_idx_fetch_count()) {
+    scanned.push_back(bucket);
+    next_bucket();
+  } else {
+    count_objects(last_key);
+  }
+}
+
+void S3BucketUsageReconciler::count_objects_failed() {
+  if (motr_kv_reader->get_state() != S3MotrKVSReaderOpState::missing) {
+    s3_log(S3_LOG_ERROR, "", "Failed to count objects of bucket %s\n",
+           bucket.key.c_str());
+  }
+  // Missing index means the bucket was deleted meanwhile.
+  next_bucket();
+}
+
+void S3BucketUsageReconciler::next_correction() {
+  std::shared_ptr<S3BucketUsage> owner = usage.lock();
+  if (!owner || owner->stopped || scanned.empty()) {
+    done();
+    return;
+  }
+  bucket = scanned.front();
+  scanned.pop_front();
+  auto self = shared_from_this();
+  query = std::make_shared<S3BucketUsageQuery>(
+      usage, bucket.key, [self](int rc, const S3BucketUsageCounters& total) {
+        self->get_usage_done(rc, total);
+      });
+  query->run();
+}
+
+void S3BucketUsageReconciler::get_usage_done(
+    int rc, const S3BucketUsageCounters& total) {
+  if (rc != 0) {
+    next_correction();
+    return;
+  }
+  std::shared_ptr<S3BucketUsage> owner = usage.lock();
+  if (!owner) {
+    done();
+    return;
+  }
+  if (total.objects_count != bucket.before.objects_count ||
+      total.bytes_used != bucket.before.bytes_used) {
+    // Changes written meanwhile may or may not have been counted.
+    s3_log(S3_LOG_INFO, "",
+           "Usage of bucket %s changed during reconciliation, left for the "
+           "next one\n",
+           bucket.key.c_str());
+    next_correction();
+    return;
+  }
+  const S3BucketUsageCounters& counted = bucket.counted;
+  const S3BucketUsageCounters& reconciled = query->get_reconciled();
+  S3BucketUsageCounters correction =
+      get_correction(counted, total, reconciled);
+  if (correction.objects_count == reconciled.objects_count &&
+      correction.bytes_used == reconciled.bytes_used) {
+    next_correction();
+    return;
+  }
+  s3_log(S3_LOG_INFO, "",
+         "Usage of bucket %s corrected by %" PRId64 " objects, %" PRId64
+         " bytes\n",
+         bucket.key.c_str(), counted.objects_count - total.objects_count,
+         counted.bytes_used - total.bytes_used);
+  motr_kv_writer = owner->motr_kvs_writer_factory->create_motr_kvs_writer(
+      owner->request, owner->s3_motr_api);
+  auto self = shared_from_this();
+  // Failure is not retried, the next run computes the correction again.
+  motr_kv_writer->put_keyval(
+      owner->usage_index_oid, S3BucketUsage::get_reconciled_key(bucket.key),
+      correction.to_json(), [self]() { self->next_correction(); },
+      [self]() {
+        s3_log(S3_LOG_ERROR, "", "Failed to save usage of bucket %s\n",
+               self->bucket.key.c_str());
+        self->next_correction();
+      });
+}
+
+void S3BucketUsageReconciler::done() {
+  resume = nullptr;
+  if (elected) {
+    // Lease is released on the next tick, once a renewal in progress ends.
+    finishing = true;
+  } else {
+    finish();
+  }
+}
+
+void S3BucketUsageReconciler::finish() {
+  if (elected) {
+    s3_log(S3_LOG_INFO, "", "Bucket usage reconciliation finished\n");
+    s3_stats_inc("bucket_usage_reconcile_count");
+  }
+  finished = true;
+}
+
+void S3BucketUsageReconciler::release() {
+  if (query) {
+    query->release();
+    query.reset();
+  }
+  motr_kv_reader.reset();
+  motr_kv_writer.reset();
+  lease_writer.reset();
+}
+
+S3BucketUsage::S3BucketUsage(
+    std::shared_ptr<EventInterface> event_obj_ptr, evbase_t* evbase_,
+    std::shared_ptr<RequestObject> req, const struct m0_uint128& index_oid,
+    std::string instance,
+    std::shared_ptr<S3MotrKVSReaderFactory> kv_reader_factory,
+    std::shared_ptr<S3MotrKVSWriterFactory> kv_writer_factory,
+    std::shared_ptr<MotrAPI> motr_api)
+    : RecurringEventBase(std::move(event_obj_ptr), evbase_),
+      request(std::move(req)),
+      s3_motr_api(std::move(motr_api)),
+      usage_index_oid(index_oid),
+      instance_id(std::move(instance)) {
+  s3_log(S3_LOG_DEBUG, "", "%s Ctor\n", __func__);
+  if (kv_reader_factory) {
+    motr_kvs_reader_factory = std::move(kv_reader_factory);
+  } else {
+    motr_kvs_reader_factory = std::make_shared<S3MotrKVSReaderFactory>();
+  }
+  if (kv_writer_factory) {
+    motr_kvs_writer_factory = std::move(kv_writer_factory);
+  } else {
+    motr_kvs_writer_factory = std::make_shared<S3MotrKVSWriterFactory>();
+  }
+}
+
+std::string S3BucketUsage::get_bucket_key(
+    const struct m0_uint128& list_index_oid) {
+  return S3M0Uint128Helper::to_string(list_index_oid);
+}
+
+void S3BucketUsage::update(const std::string& bucket_key,
+                           const S3BucketUsageCounters& delta) {
+  records[bucket_key].pending.add(delta);
+}
+
+void S3BucketUsage::forget(const std::string& bucket_key) {
+  records.erase(bucket_key);
+  summed.erase(bucket_key);
+  deleted_keys.push_back(get_record_key(bucket_key));
+  deleted_keys.push_back(get_reconciled_key(bucket_key));
+}
+
+S3BucketUsageCounters S3BucketUsage::add_own(
+    const std::string& bucket_key, const S3BucketUsageCounters& others,
+    const S3BucketUsageCounters& own_in_index) const {
+  // Own changes are taken from memory, they may not be written yet.
+  S3BucketUsageCounters result = others;
+  auto it = records.find(bucket_key);
+  if (it == records.end()) {
+    result.add(own_in_index);
+  } else {
+    const Record& record = it->second;
+    result.add(record.loaded ? record.persisted : own_in_index);
+    result.add(record.flushing);
+    result.add(record.pending);
+  }
+  return result;
+}
+
+void S3BucketUsage::get_usage(const std::string& bucket_key,
+                              S3BucketUsageQuery::CallbackType on_done) {
+  release_finished();
+  auto it = summed.find(bucket_key);
+  if (it != summed.end() &&
+      time(nullptr) - it->second.read_time < get_flush_interval()) {
+    on_done(0, add_own(bucket_key, it->second.others,
+                       it->second.own_in_index));
+    return;
+  }
+  auto query = std::make_shared<S3BucketUsageQuery>(
+      shared_from_this(), bucket_key, std::move(on_done));
+  query->run();
+}
+
+void S3BucketUsage::release_finished() {
+  for (auto& query : finished) {
+    query->release();
+  }
+  finished.clear();
+}
+
+void S3BucketUsage::reconcile_if_due() {
+  if (reconciler) {
+    if (!reconciler->is_finished()) {
+      reconciler->tick();
+      return;
+    }
+    reconciler->release();
+    reconciler.reset();
+  }
+  unsigned interval =
+      S3Option::get_instance()->get_bucket_usage_reconcile_interval_sec();
+  time_t now = time(nullptr);
+  if (interval == 0 ||
+      (reconcile_time != 0 && now - reconcile_time < (time_t)interval)) {
+    return;
+  }
+  reconcile_time = now;
+  reconciler = std::make_shared<S3BucketUsageReconciler>(shared_from_this());
+  reconciler->run();
+}
+
+void S3BucketUsage::stop() {
+  stopped = true;
+  release_finished();
+  if (reconciler && reconciler->is_finished()) {
+    reconciler->release();
+    reconciler.reset();
+  }
+  if (!flush_in_progress) {
+    motr_kv_reader.reset();
+    motr_kv_writer.reset();
+  }
+}
+
+void S3BucketUsage::action_callback(void) noexcept {
+  release_finished();
+  if (stopped) {
+    return;
+  }
+  time_t now = time(nullptr);
+  for (auto it = summed.begin(); it != summed.end();) {
+    if (now - it->second.read_time >= get_flush_interval()) {
+      it = summed.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  reconcile_if_due();
+  if (flush_in_progress) {
+    return;
+  }
+  for (auto& record : records) {
+    if (!record.second.pending.is_zero()) {
+      record.second.flushing = record.second.pending;
+      record.second.pending = S3BucketUsageCounters();
+      flushing_keys.push_back(record.first);
+    }
+  }
+  if (!flushing_keys.empty()) {
+    flush_in_progress = true;
+    load_records();
+  } else if (!deleted_keys.empty()) {
+    flush_in_progress = true;
+    delete_records();
+  }
+}
+
+void S3BucketUsage::load_records() {
+  std::vector<std::string> keys;
+  for (const auto& bucket_key : flushing_keys) {
+    auto it = records.find(bucket_key);
+    if (it != records.end() && !it->second.loaded) {
+      keys.push_back(get_record_key(bucket_key));
+    }
+  }
+  if (keys.empty()) {
+    save_records();
+    return;
+  }
+  s3_log(S3_LOG_DEBUG, "", "%s Entry with %zu records\n", __func__,
+         keys.size());
+  motr_kv_reader =
+      motr_kvs_reader_factory->create_motr_kvs_reader(request, s3_motr_api);
+  auto self = shared_from_this();
+  motr_kv_reader->get_keyval(usage_index_oid, keys,
+                             [self]() { self->load_records_successful(); },
+                             [self]() { self->load_records_failed(); });
+}
+
+void S3BucketUsage::load_records_successful() {
+  const bool all_missing =
+      motr_kv_reader->get_state() == S3MotrKVSReaderOpState::missing;
+  auto& kvps = motr_kv_reader->get_key_values();
+  for (const auto& bucket_key : flushing_keys) {
+    auto it = records.find(bucket_key);
+    if (it == records.end() || it->second.loaded) {
+      continue;
+    }
+    Record& record = it->second;
+    auto kv = kvps.find(get_record_key(bucket_key));
+    if (all_missing || kv == kvps.end() || kv->second.first == -ENOENT) {
+      record.persisted = S3BucketUsageCounters();
+      record.loaded = true;
+    } else if (kv->second.first == 0) {
+      if (!record.persisted.from_json(kv->second.second)) {
+        s3_log(S3_LOG_ERROR, "", "Invalid bucket usage record %s\n",
+               kv->first.c_str());
+        // Start over rather than never writing the record again.
+        record.persisted = S3BucketUsageCounters();
+      }
+      record.loaded = true;
+    }
+  }
+  save_records();
+}
+
+void S3BucketUsage::load_records_failed() {
+  if (motr_kv_reader->get_state() == S3MotrKVSReaderOpState::missing) {
+    load_records_successful();
+    return;
+  }
+  s3_log(S3_LOG_ERROR, "", "Failed to load bucket usage records\n");
+  save_records_failed();
+}
+
+void S3BucketUsage::save_records() {
+  std::map<std::string, std::string> kv_list;
+  for (const auto& bucket_key : flushing_keys) {
+    auto it = records.find(bucket_key);
+    if (it == records.end()) {
+      continue;
+    }
+    Record& record = it->second;
+    if (!record.loaded) {
+      // Could not be loaded, retried on next flush.
+      record.pending.add(record.flushing);
+      record.flushing = S3BucketUsageCounters();
+      continue;
+    }
+    S3BucketUsageCounters value = record.persisted;
+    value.add(record.flushing);
+    kv_list[get_record_key(bucket_key)] = value.to_json();
+  }
+  if (kv_list.empty()) {
+    flush_done();
+    return;
+  }
+  s3_log(S3_LOG_DEBUG, "", "%s Entry with %zu records\n", __func__,
+         kv_list.size());
+  motr_kv_writer =
+      motr_kvs_writer_factory->create_motr_kvs_writer(request, s3_motr_api);
+  auto self = shared_from_this();
+  motr_kv_writer->put_keyval(usage_index_oid, kv_list,
+                             [self]() { self->save_records_successful(); },
+                             [self]() { self->save_records_failed(); });
+}
+
+void S3BucketUsage::save_records_successful() {
+  for (const auto& bucket_key : flushing_keys) {
+    auto it = records.find(bucket_key);
+    if (it != records.end()) {
+      it->second.persisted.add(it->second.flushing);
+      it->second.flushing = S3BucketUsageCounters();
+    }
+  }
+  s3_stats_inc("bucket_usage_flush_count");
+  flush_done();
+}
+
+void S3BucketUsage::save_records_failed() {
+  s3_log(S3_LOG_ERROR, "", "Failed to save bucket usage records\n");
+  // Written values are absolute, so the next flush simply writes them again.
+  for (const auto& bucket_key : flushing_keys) {
+    auto it = records.find(bucket_key);
+    if (it != records.end()) {
+      it->second.pending.add(it->second.flushing);
+      it->second.flushing = S3BucketUsageCounters();
+    }
+  }
+  s3_stats_inc("bucket_usage_flush_failed_count");
+  flush_done();
+}
+
+void S3BucketUsage::delete_records() {
+  std::vector<std::string> keys;
+  keys.swap(deleted_keys);
+  motr_kv_writer =
+      motr_kvs_writer_factory->create_motr_kvs_writer(request, s3_motr_api);
+  auto self = shared_from_this();
+  // Missing record is not an error, a leftover one is never counted again.
+  motr_kv_writer->delete_keyval(usage_index_oid, keys,
+                                [self]() { self->flush_in_progress = false; },
+                                [self]() { self->flush_in_progress = false; });
+}
+
+void S3BucketUsage::flush_done() {
+  flushing_keys.clear();
+  // Deleted after the writes, which could have recreated them.
+  if (!deleted_keys.empty()) {
+    delete_records();
+  } else {
+    flush_in_progress = false;
+  }
+}
+
+static std::shared_ptr<S3BucketUsage> gs_bucket_usage;
+
+int s3_bucket_usage_init(evbase_t* evbase, const std::string& instance_id) {
+  struct timeval tv;
+  if (!g_option_instance->is_bucket_usage_enabled()) {
+    return 0;
+  }
+  s3_log(S3_LOG_INFO, "", "%s Entry", __func__);
+
+  AtExit call_fini([]() { s3_bucket_usage_fini(); });
+
+  if (!evbase || instance_id.empty()) {
+    return -EINVAL;
+  }
+  // Light weight request object used as a carrier for async motr operations.
+  std::shared_ptr<RequestObject> req = std::make_shared<MotrRequestObject>(
+      nullptr, new EvhtpWrapper(), nullptr, new EventWrapper());
+  gs_bucket_usage.reset(new S3BucketUsage(std::make_shared<EventWrapper>(),
+                                          evbase, req, bucket_usage_index_oid,
+                                          instance_id));
+  if (!gs_bucket_usage) {
+    return -ENOMEM;
+  }
+  tv.tv_sec =
+      std::max(1U, g_option_instance->get_bucket_usage_flush_interval_sec());
+  tv.tv_usec = 0;
+  int rc = gs_bucket_usage->add_evtimer(tv);
+  if (rc != 0) {
+    return rc;
+  }
+
+  call_fini.cancel();
+
+  return 0;
+}
+
+void s3_bucket_usage_fini() {
+  if (!gs_bucket_usage) {
+    return;
+  }
+  s3_log(S3_LOG_INFO, "", "%s Entry", __func__);
+  gs_bucket_usage->stop();
+  gs_bucket_usage->del_evtimer();
+  gs_bucket_usage.reset();
+}
+
+std::shared_ptr<S3BucketUsage> s3_bucket_usage() { return gs_bucket_usage; }
+
+void s3_bucket_usage_object_put(S3BucketMetadata& bucket,
+                                S3ObjectMetadata& object,
+                                S3ObjectMetadata* replaced) {
+  if (!gs_bucket_usage) {
+    return;
+  }
+  S3BucketUsageCounters delta;
+  delta.objects_count = 1;
+  delta.bytes_used = (int64_t)object.get_content_length();
+  if (replaced) {
+    delta.objects_count -= 1;
+    delta.bytes_used -= (int64_t)replaced->get_content_length();
+  }
+  gs_bucket_usage->update(
+      S3BucketUsage::get_bucket_key(bucket.get_object_list_index_oid()),
+      delta);
+}
+
+void s3_bucket_usage_object_deleted(S3BucketMetadata& bucket,
+                                    S3ObjectMetadata& object) {
+  if (!gs_bucket_usage) {
+    return;
+  }
+  S3BucketUsageCounters delta;
+  delta.objects_count = -1;
+  delta.bytes_used = -(int64_t)object.get_content_length();
+  gs_bucket_usage->update(
+      S3BucketUsage::get_bucket_key(bucket.get_object_list_index_oid()),
+      delta);
+}
+
+void s3_bucket_usage_bucket_deleted(S3BucketMetadata& bucket) {
+  if (gs_bucket_usage) {
+    gs_bucket_usage->forget(
+        S3BucketUsage::get_bucket_key(bucket.get_object_list_index_oid()));
+  }
+}
@@ -0,0 +1,350 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#pragma once
+
+#ifndef __S3_SERVER_S3_BUCKET_USAGE_H__
+#define __S3_SERVER_S3_BUCKET_USAGE_H__
+
+#include <gtest/gtest_prod.h>
+
+#include <cstdint>
+#include <ctime>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "event_utils.h"
+#include "s3_factory.h"
+
+#define S3_BUCKET_USAGE_PATH "/bucket-usage"
+// Name of the record written by reconciliation, in place of a process fid.
+#define S3_BUCKET_USAGE_RECONCILED_RECORD "reconciled"
+// Key of the record which elects the instance that reconciles.
+#define S3_BUCKET_USAGE_LEASE_RECORD "reconciler"
+// Lease not renewed for this many flush intervals has expired.
+#define S3_BUCKET_USAGE_LEASE_TIMEOUT_FLUSHES 3
+
+class S3BucketMetadata;
+class S3ObjectMetadata;
+
+struct S3BucketUsageCounters {
+  int64_t objects_count = 0;
+  int64_t bytes_used = 0;
+
+  void add(const S3BucketUsageCounters& other);
+  bool is_zero() const { return objects_count == 0 && bytes_used == 0; }
+
+  std::string to_json() const;
+  // Returns false if value could not be parsed.
+  bool from_json(const std::string& json);
+};
+
+class S3BucketUsage;
+
+// Sums up the records of all instances for one bucket.
+class S3BucketUsageQuery
+    : public std::enable_shared_from_this<S3BucketUsageQuery> {
+ public:
+  typedef std::function<void(int rc, const S3BucketUsageCounters& usage)>
+      CallbackType;
+
+ private:
+  // Not owned, the query may outlive s3_bucket_usage_fini().
+  std::weak_ptr<S3BucketUsage> usage;
+  std::string bucket_key;
+  CallbackType callback;
+  std::shared_ptr<S3MotrKVSReader> motr_kv_reader;
+  S3BucketUsageCounters total;
+  // Value of own record in the index, used until it is loaded by a flush.
+  S3BucketUsageCounters own_in_index;
+  // Value of the reconciled record, a part of the total.
+  S3BucketUsageCounters reconciled;
+
+  void list_records(const std::string& marker);
+  void list_records_successful();
+  void list_records_failed();
+  void done(int rc);
+
+ public:
+  // Calls back with -ECANCELED if bucket usage is stopped meanwhile.
+  S3BucketUsageQuery(std::weak_ptr<S3BucketUsage> bucket_usage,
+                     std::string key, CallbackType on_done);
+  void run();
+  const S3BucketUsageCounters& get_reconciled() const { return reconciled; }
+  // Drops motr reader, which holds callbacks referencing this object.
+  void release();
+
+  FRIEND_TEST(S3BucketUsageTest, ReconcileWritesCorrection);
+  FRIEND_TEST(S3BucketUsageTest, ReconcileSkipsChangedBucket);
+  FRIEND_TEST(S3BucketUsageTest, ReconcileSkipsDeletedBucket);
+};
+
+// Value of the lease record, which elects the instance that reconciles.
+struct S3BucketUsageLease {
+  std::string instance_id;
+  // Time the holder last renewed it, 0 once released.
+  time_t renewed = 0;
+  // Start time of the last finished reconciliation.
+  time_t last_run = 0;
+
+  std::string to_json() const;
+  // Returns false if value could not be parsed.
+  bool from_json(const std::string& json);
+};
+
+// Corrects drift of the usage, e.g. changes which an instance did not write
+// before it crashed.  Every bucket is recounted by scanning its object list
+// index, and the difference from the sum of records is written to the
+// bucket's "reconciled" record, which holds an absolute value.
+//
+// Changes of other instances reach their records up to a flush interval
+// after they are made, so the scan may count changes which the records do
+// not have yet.  Records are therefore summed before the scan and again two
+// flush intervals after the last bucket is scanned, when every instance has
+// written what it counted.  A bucket whose sum changed meanwhile is left for
+// the next run.  Own changes are taken from memory, they need no flush.
+//
+// One instance reconciles at a time.  An instance claims the lease record
+// unless another one holds it or the last run is more recent than
+// S3_BUCKET_USAGE_RECONCILE_INTERVAL_SEC, and proceeds if the record still
+// names it a flush interval later, when a concurrent claim would have been
+// written.  The holder renews the lease every flush interval; one not
+// renewed for S3_BUCKET_USAGE_LEASE_TIMEOUT_FLUSHES intervals has expired.
+class S3BucketUsageReconciler
+    : public std::enable_shared_from_this<S3BucketUsageReconciler> {
+  struct Bucket {
+    struct m0_uint128 list_index_oid;
+    std::string key;
+    // Sum of records before the scan and usage counted by it.
+    S3BucketUsageCounters before;
+    S3BucketUsageCounters counted;
+  };
+
+  // Not owned, reconciliation in progress ends once it is gone.
+  std::weak_ptr<S3BucketUsage> usage;
+  std::shared_ptr<S3MotrKVSReader> motr_kv_reader;
+  std::shared_ptr<S3MotrKVSWriter> motr_kv_writer;
+  std::shared_ptr<S3MotrKVSWriter> lease_writer;
+  std::shared_ptr<S3BucketUsageQuery> query;
+  // Buckets to scan, and scanned ones to correct.
+  std::deque<Bucket> buckets;
+  std::deque<Bucket> scanned;
+  // Bucket being scanned or corrected.
+  Bucket bucket;
+  time_t start_time = 0;
+  S3BucketUsageLease lease;
+  // Lease is claimed, and this instance is the elected one.
+  bool claimed = false;
+  bool elected = false;
+  bool lease_writing = false;
+  bool finishing = false;
+  bool finished = false;
+  // Step to resume with once resume_time has come, see tick().
+  void (S3BucketUsageReconciler::*resume)() = nullptr;
+  time_t resume_time = 0;
+
+  void read_lease();
+  void read_lease_successful();
+  void read_lease_failed();
+  void lease_read(const S3BucketUsageLease& current);
+  void write_lease(void (S3BucketUsageReconciler::*on_done)(bool saved));
+  void lease_claimed(bool saved);
+  void renew_lease();
+  void release_lease();
+  void lease_released(bool saved);
+  void wait(time_t seconds, void (S3BucketUsageReconciler::*step)());
+  void list_buckets(const std::string& marker);
+  void list_buckets_successful();
+  void list_buckets_failed();
+  void next_bucket();
+  void sum_before_done(int rc, const S3BucketUsageCounters& total);
+  void count_objects(const std::string& marker);
+  void count_objects_successful();
+  void count_objects_failed();
+  void next_correction();
+  void get_usage_done(int rc, const S3BucketUsageCounters& total);
+  void done();
+  void finish();
+
+ public:
+  explicit S3BucketUsageReconciler(std::weak_ptr<S3BucketUsage> bucket_usage);
+  void run();
+  // Called every flush interval, renews the lease and resumes waiting steps.
+  void tick();
+  bool is_finished() const { return finished; }
+  // Drops motr reader and writers, which hold callbacks referencing this
+  // object.
+  void release();
+
+  // Value of the reconciled record which makes the sum of records equal to
+  // the counted usage.
+  static S3BucketUsageCounters get_correction(
+      const S3BucketUsageCounters& counted, const S3BucketUsageCounters& total,
+      const S3BucketUsageCounters& reconciled);
+
+  FRIEND_TEST(S3BucketUsageTest, ReconcileElectsOneInstance);
+  FRIEND_TEST(S3BucketUsageTest, ReconcileWritesCorrection);
+  FRIEND_TEST(S3BucketUsageTest, ReconcileSkipsChangedBucket);
+  FRIEND_TEST(S3BucketUsageTest, ReconcileSkipsDeletedBucket);
+};
+
+// Object count and bytes used of every bucket, maintained incrementally.
+//
+// When enabled (S3_BUCKET_USAGE_ENABLE), requests which add, replace or
+// remove objects report the change here.  Changes are aggregated in memory
+// and written every S3_BUCKET_USAGE_FLUSH_INTERVAL_SEC to the bucket usage
+// index.  Each s3server instance owns a record per bucket, keyed as
+// "<object list index oid>/<process fid>", and writes absolute values into
+// it, so a retried or repeated write never counts a change twice and a
+// restarted instance continues from what it has written before.  Changes not
+// yet written when the instance crashes are lost until the next
+// reconciliation, see S3BucketUsageReconciler, which is disabled by default
+// and otherwise runs on one instance every
+// S3_BUCKET_USAGE_RECONCILE_INTERVAL_SEC.
+//
+// Usage of a bucket is the sum of records of all instances and of the
+// reconciled record.  The object list index oid is never reused, so records
+// of a deleted bucket are never counted for a new bucket with the same name.
+// Used on the main thread only.
+class S3BucketUsage : public RecurringEventBase,
+                      public std::enable_shared_from_this<S3BucketUsage> {
+  struct Record {
+    // Value of own record in the index, valid once loaded.
+    S3BucketUsageCounters persisted;
+    // Changes being written, and changes which came after.
+    S3BucketUsageCounters flushing;
+    S3BucketUsageCounters pending;
+    bool loaded = false;
+  };
+
+  std::shared_ptr<RequestObject> request;
+  std::shared_ptr<S3MotrKVSReaderFactory> motr_kvs_reader_factory;
+  std::shared_ptr<S3MotrKVSWriterFactory> motr_kvs_writer_factory;
+  std::shared_ptr<MotrAPI> s3_motr_api;
+  std::shared_ptr<S3MotrKVSReader> motr_kv_reader;
+  std::shared_ptr<S3MotrKVSWriter> motr_kv_writer;
+
+  struct m0_uint128 usage_index_oid;
+  std::string instance_id;
+  // Keyed by object list index oid of the bucket.
+  std::map<std::string, Record> records;
+  // Records of the flush in progress.
+  std::vector<std::string> flushing_keys;
+  // Own records of deleted buckets, removed after the next flush.
+  std::vector<std::string> deleted_keys;
+  bool flush_in_progress = false;
+  bool stopped = false;
+  // Queries which are done, released outside of the motr callback stack.
+  std::vector<std::shared_ptr<S3BucketUsageQuery>> finished;
+  std::shared_ptr<S3BucketUsageReconciler> reconciler;
+  // Records of other instances summed by recent queries, and own record as
+  // read, served again for a flush interval as they lag that much anyway.
+  struct Summed {
+    S3BucketUsageCounters others;
+    S3BucketUsageCounters own_in_index;
+    time_t read_time;
+  };
+  std::map<std::string, Summed> summed;
+  // Time of the last attempt to reconcile, 0 until the first one.
+  time_t reconcile_time = 0;
+
+  std::string get_record_key(const std::string& bucket_key) const {
+    return bucket_key + "/" + instance_id;
+  }
+  static std::string get_reconciled_key(const std::string& bucket_key) {
+    return bucket_key + "/" S3_BUCKET_USAGE_RECONCILED_RECORD;
+  }
+  // Sum of other records and of own changes, which may not be written yet.
+  S3BucketUsageCounters add_own(
+      const std::string& bucket_key, const S3BucketUsageCounters& others,
+      const S3BucketUsageCounters& own_in_index) const;
+  void release_finished();
+  void reconcile_if_due();
+  void load_records();
+  void load_records_successful();
+  void load_records_failed();
+  void save_records();
+  void save_records_successful();
+  void save_records_failed();
+  void delete_records();
+  void flush_done();
+
+ public:
+  S3BucketUsage(
+      std::shared_ptr<EventInterface> event_obj_ptr, evbase_t* evbase_,
+      std::shared_ptr<RequestObject> req, const struct m0_uint128& index_oid,
+      std::string instance,
+      std::shared_ptr<S3MotrKVSReaderFactory> kv_reader_factory = nullptr,
+      std::shared_ptr<S3MotrKVSWriterFactory> kv_writer_factory = nullptr,
+      std::shared_ptr<MotrAPI> motr_api = nullptr);
+
+  static std::string get_bucket_key(const struct m0_uint128& list_index_oid);
+
+  void update(const std::string& bucket_key,
+              const S3BucketUsageCounters& delta);
+  // Drops the bucket, called once it is deleted.
+  void forget(const std::string& bucket_key);
+  // Calls back with -errno and zero usage on failure.  Records summed less
+  // than a flush interval ago are not read again, it calls back at once.
+  void get_usage(const std::string& bucket_key,
+                 S3BucketUsageQuery::CallbackType on_done);
+
+  // Writes out changes.
+  virtual void action_callback(void) noexcept;
+
+  // Stops flushes and reconciliation.  Operations in progress hold their own
+  // reference and end on their own.
+  void stop();
+
+  friend class S3BucketUsageQuery;
+  friend class S3BucketUsageReconciler;
+
+  FRIEND_TEST(S3BucketUsageTest, FlushLoadsThenSavesAbsoluteValues);
+  FRIEND_TEST(S3BucketUsageTest, FailedSaveKeepsChanges);
+  FRIEND_TEST(S3BucketUsageTest, ForgetDeletesOwnRecord);
+  FRIEND_TEST(S3BucketUsageTest, QuerySumsInstances);
+  FRIEND_TEST(S3BucketUsageTest, QueryKeepsNegativeUsage);
+  FRIEND_TEST(S3BucketUsageTest, QueryResultIsReused);
+  FRIEND_TEST(S3BucketUsageTest, ReconcileElectsOneInstance);
+  FRIEND_TEST(S3BucketUsageTest, ReconcileWritesCorrection);
+  FRIEND_TEST(S3BucketUsageTest, ReconcileSkipsChangedBucket);
+  FRIEND_TEST(S3BucketUsageTest, ReconcileSkipsDeletedBucket);
+};
+
+int s3_bucket_usage_init(evbase_t* evbase, const std::string& instance_id);
+void s3_bucket_usage_fini();
+// Returns nullptr when bucket usage is disabled.
+std::shared_ptr<S3BucketUsage> s3_bucket_usage();
+
+// Helpers, no-op when bucket usage is disabled.  'replaced' is the object
+// which was overwritten, if any.
+void s3_bucket_usage_object_put(S3BucketMetadata& bucket,
+                                S3ObjectMetadata& object,
+                                S3ObjectMetadata* replaced);
+void s3_bucket_usage_object_deleted(S3BucketMetadata& bucket,
+                                    S3ObjectMetadata& object);
+void s3_bucket_usage_bucket_deleted(S3BucketMetadata& bucket);
+
+#endif
@@ -21,12 +21,12 @@
 #include <cctype>
 #include <sstream>
 #include <algorithm>
-#include <libxml/parser.h>
 #include <evhtp.h>
 
 #include "s3_common_utilities.h"
 #include "s3_log.h"
 #include "s3_option.h"
+#include "s3_xml_writer.h"
 
 namespace S3CommonUtilities {
 
@@ -76,26 +76,17 @@ std::string trim(const std::string &str) {
 }
 
 std::string s3xmlEncodeSpecialChars(const std::string &input) {
-  xmlChar *output = xmlEncodeSpecialChars(NULL, BAD_CAST input.c_str());
   std::string data;
-  if (output) {
-    data = reinterpret_cast<char *>(output);
-    xmlFree(output);
-  }
+  data.reserve(input.length());
+  S3XmlWriter::escape(input, data);
   return data;
 }
 
 std::string format_xml_string(std::string tag, const std::string &value,
                               bool append_quotes) {
-
-  std::string format_string = s3xmlEncodeSpecialChars(value);
-  if (format_string.empty()) {
-    return "<" + tag + "/>";
-  }
-  if (append_quotes) {
-    format_string = "\"" + format_string + "\"";
-  }
-  return "<" + tag + ">" + format_string + "</" + tag + ">";
+  std::string xml;
+  S3XmlWriter(xml).element(tag.c_str(), value, append_quotes);
+  return xml;
 }
 
 bool stoul(const std::string &str, unsigned long &value) {
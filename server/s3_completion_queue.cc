@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include "s3_completion_queue.h"
+#include "s3_log.h"
+#include "s3_option.h"
+
+S3CompletionQueue::S3CompletionQueue(size_t capacity, size_t max_batch_)
+    : mask([capacity]() {
+        size_t size = 2;
+        while (size < capacity) {
+          size <<= 1;
+        }
+        return size - 1;
+      }()),
+      max_batch(max_batch_ ? max_batch_ : 1),
+      enqueue_pos(0),
+      wakeup_pending(false) {
+  slots.reset(new Slot[mask + 1]);
+  for (size_t i = 0; i <= mask; ++i) {
+    slots[i].sequence.store(i, std::memory_order_relaxed);
+  }
+}
+
+S3CompletionQueue::~S3CompletionQueue() {
+  if (wakeup_event) {
+    event_free(wakeup_event);
+  }
+  if (event_fd >= 0) {
+    close(event_fd);
+  }
+}
+
+int S3CompletionQueue::attach(struct event_base *base) {
+  event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (event_fd < 0) {
+    return -errno;
+  }
+  wakeup_event =
+      event_new(base, event_fd, EV_READ | EV_PERSIST, on_wakeup, this);
+  if (!wakeup_event) {
+    return -ENOMEM;
+  }
+  return event_add(wakeup_event, NULL) == 0 ? 0 : -EINVAL;
+}
+
+bool S3CompletionQueue::push(s3_completion_callback callback, void *ctx) {
+  size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+  Slot *slot;
+  for (;;) {
+    slot = &slots[pos & mask];
+    const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+    const intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+    if (diff == 0) {
+      if (enqueue_pos.compare_exchange_weak(pos, pos + 1,
+                                            std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff < 0) {
+      // The slot still holds a completion from the previous lap.
+      return false;
+    } else {
+      pos = enqueue_pos.load(std::memory_order_relaxed);
+    }
+  }
+  slot->callback = callback;
+  slot->ctx = ctx;
+  slot->sequence.store(pos + 1, std::memory_order_release);
+
+  // Pairs with the fence in on_wakeup(): either the main thread sees this
+  // completion in the batch it is draining, or this thread sees the flag
+  // cleared and wakes it up again.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (event_fd >= 0 && !wakeup_pending.exchange(true)) {
+    const uint64_t one = 1;
+    if (write(event_fd, &one, sizeof(one)) != sizeof(one)) {
+      s3_log(S3_LOG_ERROR, "", "Cannot wake up main thread: %s\n",
+             strerror(errno));
+    }
+  }
+  return true;
+}
+
+size_t S3CompletionQueue::drain(size_t max_count) {
+  size_t count = 0;
+  while (count < max_count) {
+    Slot &slot = slots[dequeue_pos & mask];
+    if (slot.sequence.load(std::memory_order_acquire) != dequeue_pos + 1) {
+      break;
+    }
+    const s3_completion_callback callback = slot.callback;
+    void *const ctx = slot.ctx;
+    // Free the slot before the callback, which may push more completions.
+    slot.sequence.store(dequeue_pos + mask + 1, std::memory_order_release);
+    ++dequeue_pos;
+    ++count;
+    callback(ctx);
+  }
+  return count;
+}
+
+void S3CompletionQueue::on_wakeup(evutil_socket_t fd, short events,
+                                  void *arg) {
+  S3CompletionQueue *queue = (S3CompletionQueue *)arg;
+  uint64_t value;
+  // Resets the eventfd counter, EAGAIN when woken up by event_active().
+  if (read(fd, &value, sizeof(value)) < 0 && errno != EAGAIN) {
+    s3_log(S3_LOG_ERROR, "", "Cannot read completion queue eventfd: %s\n",
+           strerror(errno));
+  }
+  queue->wakeup_pending.store(false);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+
+  const size_t count = queue->drain(queue->max_batch);
+  s3_log(S3_LOG_DEBUG, "", "Handled %zu Motr completions\n", count);
+  if (count == queue->max_batch && !queue->wakeup_pending.exchange(true)) {
+    // There may be more, let the event loop run other events first.
+    event_active(queue->wakeup_event, EV_READ, 0);
+  }
+}
+
+static struct event_base *gs_completion_base;
+static std::unique_ptr<S3CompletionQueue> gs_completion_queue;
+
+int s3_completion_queue_init(struct event_base *base) {
+  gs_completion_base = base;
+  const unsigned size =
+      S3Option::get_instance()->get_motr_completion_queue_size();
+  if (!size) {
+    return 0;
+  }
+  s3_log(S3_LOG_INFO, "", "%s Entry", __func__);
+  if (!base) {
+    return -EINVAL;
+  }
+  std::unique_ptr<S3CompletionQueue> queue(new S3CompletionQueue(
+      size, S3Option::get_instance()->get_motr_completion_batch_size()));
+  const int rc = queue->attach(base);
+  if (rc != 0) {
+    return rc;
+  }
+  gs_completion_queue = std::move(queue);
+  return 0;
+}
+
+void s3_completion_queue_fini() {
+  if (!gs_completion_queue) {
+    return;
+  }
+  s3_log(S3_LOG_INFO, "", "%s Entry", __func__);
+  gs_completion_queue.reset();
+}
+
+// Completion posted as a libevent user event.
+struct s3_posted_completion {
+  struct event *user_event;
+  s3_completion_callback callback;
+  void *ctx;
+};
+
+static void run_posted_completion(evutil_socket_t, short, void *arg) {
+  s3_posted_completion *posted = (s3_posted_completion *)arg;
+  const s3_completion_callback callback = posted->callback;
+  void *const ctx = posted->ctx;
+  event_free(posted->user_event);
+  delete posted;
+  callback(ctx);
+}
+
+void s3_post_completion(s3_completion_callback callback, void *ctx,
+                        const std::string &request_id) {
+  if (gs_completion_queue && gs_completion_queue->push(callback, ctx)) {
+    return;
+  }
+  if (!gs_completion_base) {
+    s3_log(S3_LOG_ERROR, request_id, "ERROR: event base is NULL\n");
+    return;
+  }
+  if (gs_completion_queue) {
+    s3_log(S3_LOG_WARN, request_id,
+           "Completion queue is full, raise S3_MOTR_COMPLETION_QUEUE_SIZE\n");
+  }
+  s3_posted_completion *posted = new s3_posted_completion{nullptr, callback,
+                                                          ctx};
+  posted->user_event = event_new(gs_completion_base, -1, 0,
+                                 run_posted_completion, posted);
+  event_active(posted->user_event, EV_READ | EV_WRITE | EV_TIMEOUT, 1);
+}
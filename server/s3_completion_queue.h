@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+#pragma once
+
+#ifndef __S3_SERVER_S3_COMPLETION_QUEUE_H__
+#define __S3_SERVER_S3_COMPLETION_QUEUE_H__
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include <event2/event.h>
+
+// Run on the main thread for each completion.
+typedef void (*s3_completion_callback)(void *ctx);
+
+// Bounded lock-free multi-producer/single-consumer ring of completions,
+// which Motr threads pass to the main thread.
+//
+// Producers claim a slot with compare-and-swap on the enqueue position and
+// publish it with a per-slot sequence number, so push() takes no lock and
+// allocates nothing.  Only the first push after the main thread has started
+// draining writes to the eventfd, the main thread then handles all
+// completions queued by then in one batch.
+class S3CompletionQueue {
+  struct Slot {
+    std::atomic<size_t> sequence;
+    s3_completion_callback callback;
+    void *ctx;
+  };
+  std::unique_ptr<Slot[]> slots;
+  const size_t mask;
+  const size_t max_batch;
+
+  // Positions of producers and consumer are kept in separate cache lines.
+  char pad0[64];
+  std::atomic<size_t> enqueue_pos;
+  char pad1[64];
+  std::atomic<bool> wakeup_pending;
+  char pad2[64];
+  size_t dequeue_pos = 0;
+
+  int event_fd = -1;
+  struct event *wakeup_event = nullptr;
+
+  static void on_wakeup(evutil_socket_t fd, short events, void *arg);
+
+ public:
+  // 'capacity' is rounded up to a power of 2.
+  S3CompletionQueue(size_t capacity, size_t max_batch);
+  ~S3CompletionQueue();
+
+  // Creates the eventfd and registers its handler, which drains the queue.
+  int attach(struct event_base *base);
+
+  size_t get_capacity() const { return mask + 1; }
+
+  // Thread safe.  Returns false when the queue is full.
+  bool push(s3_completion_callback callback, void *ctx);
+
+  // Main thread only.  Runs at most 'max_count' completions in the order
+  // they were pushed, returns their count.
+  size_t drain(size_t max_count);
+};
+
+int s3_completion_queue_init(struct event_base *base);
+void s3_completion_queue_fini();
+
+// Runs callback(ctx) on the main thread.  Uses the completion queue when it
+// is enabled and not full, otherwise posts a libevent user event.  May be
+// called from any thread.
+void s3_post_completion(s3_completion_callback callback, void *ctx,
+                        const std::string &request_id = "");
+
+#endif
@@ -23,6 +23,7 @@
 #include <utility>
 #include <evhttp.h>
 
+#include "s3_bucket_usage.h"
 #include "s3_common.h"
 #include "s3_common_utilities.h"
 #include "s3_copy_object_action.h"
@@ -391,6 +392,10 @@ void S3CopyObjectAction::save_metadata() {
 void S3CopyObjectAction::save_object_metadata_success() {
   s3_log(S3_LOG_INFO, stripped_request_id, "%s Entry\n", __func__);
   s3_put_action_state = S3PutObjectActionState::metadataSaved;
+  s3_bucket_usage_object_put(*bucket_metadata, *new_object_metadata,
+                             (old_object_oid.u_hi || old_object_oid.u_lo)
+                                 ? object_metadata.get()
+                                 : nullptr);
   next();
 }
 
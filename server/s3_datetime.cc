@@ -19,10 +19,129 @@
  */
 
 #include "s3_datetime.h"
+#include <ctype.h>
 #include <string.h>
+#include <strings.h>
 #include "s3_log.h"
 
-S3DateTime::S3DateTime() : is_valid(true) {
+static const char *const s3_day_names[] = {
+    "Sunday", "Monday", "Tuesday", "Wednesday", "Thursday", "Friday",
+    "Saturday"};
+static const char *const s3_month_names[] = {
+    "January", "February", "March",     "April",   "May",      "June",
+    "July",    "August",   "September", "October", "November", "December"};
+// Days before the month in a non leap year.
+static const int s3_days_before_month[] = {0,   31,  59,  90,  120, 151,
+                                           181, 212, 243, 273, 304, 334};
+
+// Current time formatted by get_isoformat_string().
+static thread_local time_t iso_cache_time = -1;
+static thread_local char iso_cache[32];
+
+static bool is_leap_year(int year) {
+  return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+}
+
+// Days since 1970-01-01 of the proleptic Gregorian calendar date.
+static long days_from_civil(int year, unsigned month, unsigned day) {
+  year -= month <= 2;
+  const long era = (year >= 0 ? year : year - 399) / 400;
+  const unsigned year_of_era = (unsigned)(year - era * 400);
+  const unsigned day_of_year =
+      (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+  const unsigned day_of_era =
+      year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+  return era * 146097 + (long)day_of_era - 719468;
+}
+
+// Sets tm_yday and tm_wday from the date.
+static void set_day_of_year_and_week(struct tm &out) {
+  const int year = out.tm_year + 1900;
+  out.tm_yday = s3_days_before_month[out.tm_mon] + out.tm_mday - 1 +
+                (out.tm_mon > 1 && is_leap_year(year));
+  const long days = days_from_civil(year, out.tm_mon + 1, out.tm_mday);
+  // 1970-01-01 was Thursday.
+  const long wday = (days + 4) % 7;
+  out.tm_wday = (int)(wday < 0 ? wday + 7 : wday);
+}
+
+// Parses exactly 'digits' decimal digits.
+static bool parse_number(const char *&p, int digits, int &value) {
+  value = 0;
+  for (int i = 0; i < digits; ++i, ++p) {
+    if (!isdigit((unsigned char)*p)) {
+      return false;
+    }
+    value = value * 10 + (*p - '0');
+  }
+  return true;
+}
+
+static bool parse_char(const char *&p, char c) {
+  if (*p != c) {
+    return false;
+  }
+  ++p;
+  return true;
+}
+
+// Parses a full or 3 letter name, as %a and %b of strptime.
+static bool parse_name(const char *&p, const char *const *names, int count,
+                       int &value) {
+  for (int i = 0; i < count; ++i) {
+    if (strncasecmp(p, names[i], 3) != 0) {
+      continue;
+    }
+    const size_t length = strlen(names[i]);
+    if (strncasecmp(p, names[i], length) == 0) {
+      p += length;
+    } else {
+      p += 3;
+    }
+    value = i;
+    return true;
+  }
+  return false;
+}
+
+static bool parse_time(const char *&p, struct tm &out) {
+  return parse_number(p, 2, out.tm_hour) && parse_char(p, ':') &&
+         parse_number(p, 2, out.tm_min) && parse_char(p, ':') &&
+         parse_number(p, 2, out.tm_sec) && out.tm_hour <= 23 &&
+         out.tm_min <= 59 && out.tm_sec <= 60;
+}
+
+static bool is_date_valid(const struct tm &in) {
+  static const int days_in_month[] = {31, 29, 31, 30, 31, 30,
+                                      31, 31, 30, 31, 30, 31};
+  // Years of 4 digits only, as printed by %Y.
+  return in.tm_year >= 1000 - 1900 && in.tm_year <= 9999 - 1900 &&
+         in.tm_mon >= 0 && in.tm_mon <= 11 && in.tm_mday >= 1 &&
+         in.tm_mday <= days_in_month[in.tm_mon];
+}
+
+static char *format_number(char *p, int value, int digits) {
+  for (int i = digits - 1; i >= 0; --i) {
+    p[i] = '0' + value % 10;
+    value /= 10;
+  }
+  return p + digits;
+}
+
+static char *format_time(char *p, const struct tm &in) {
+  p = format_number(p, in.tm_hour, 2);
+  *p++ = ':';
+  p = format_number(p, in.tm_min, 2);
+  *p++ = ':';
+  return format_number(p, in.tm_sec, 2);
+}
+
+static bool is_time_valid(const struct tm &in) {
+  return in.tm_hour >= 0 && in.tm_hour <= 23 && in.tm_min >= 0 &&
+         in.tm_min <= 59 && in.tm_sec >= 0 && in.tm_sec <= 60;
+}
+
+S3DateTime::S3DateTime() : is_valid(true), current_time(-1) {
   memset(&point_in_time, 0, sizeof(struct tm));
 }
 
@@ -34,30 +153,154 @@ void S3DateTime::init_current_time() {
   if (tmp == NULL) {
     s3_log(S3_LOG_ERROR, "", "gmtime error\n");
     is_valid = false;
+    current_time = -1;
+  } else {
+    current_time = t;
   }
 }
 
 void S3DateTime::init_with_fmt(std::string time_str, std::string format) {
+  current_time = -1;
   memset(&point_in_time, 0, sizeof(struct tm));
   strptime(time_str.c_str(), format.c_str(), &point_in_time);
 }
 
 void S3DateTime::init_with_gmt(std::string time_str) {
-  init_with_fmt(time_str, S3_GMT_DATETIME_FORMAT);
+  current_time = -1;
+  if (!parse_gmt(time_str.c_str(), point_in_time)) {
+    init_with_fmt(time_str, S3_GMT_DATETIME_FORMAT);
+  }
 }
 
 void S3DateTime::init_with_iso(std::string time_str) {
-  init_with_fmt(time_str, S3_ISO_DATETIME_FORMAT);
+  current_time = -1;
+  if (!parse_iso(time_str.c_str(), point_in_time)) {
+    init_with_fmt(time_str, S3_ISO_DATETIME_FORMAT);
+  }
 }
 
 std::string S3DateTime::get_isoformat_string() {
-  return get_format_string(S3_ISO_DATETIME_FORMAT);
+  if (!is_OK()) {
+    return "";
+  }
+  if (current_time != -1 && current_time == iso_cache_time) {
+    return iso_cache;
+  }
+  char buf[32];
+  if (!format_iso(point_in_time, buf)) {
+    return get_format_string(S3_ISO_DATETIME_FORMAT);
+  }
+  if (current_time != -1) {
+    memcpy(iso_cache, buf, sizeof(iso_cache));
+    iso_cache_time = current_time;
+  }
+  return buf;
 }
 
 std::string S3DateTime::get_gmtformat_string() {
+  char buf[32];
+  if (is_OK() && format_gmt(point_in_time, buf)) {
+    return buf;
+  }
   return get_format_string(S3_GMT_DATETIME_FORMAT);
 }
 
+bool S3DateTime::parse_iso(const char *time_str, struct tm &out) {
+  struct tm parsed;
+  const char *p = time_str;
+  int year;
+  memset(&parsed, 0, sizeof(struct tm));
+  if (!(parse_number(p, 4, year) && parse_char(p, '-') &&
+        parse_number(p, 2, parsed.tm_mon) && parse_char(p, '-') &&
+        parse_number(p, 2, parsed.tm_mday) && parse_char(p, 'T') &&
+        parse_time(p, parsed))) {
+    return false;
+  }
+  // Fraction of a second is not kept, as by strptime.
+  if (parse_char(p, '.')) {
+    if (!isdigit((unsigned char)*p)) {
+      return false;
+    }
+    while (isdigit((unsigned char)*p)) {
+      ++p;
+    }
+  }
+  if (!parse_char(p, 'Z') || *p != '\0') {
+    return false;
+  }
+  parsed.tm_year = year - 1900;
+  parsed.tm_mon -= 1;
+  if (!is_date_valid(parsed)) {
+    return false;
+  }
+  set_day_of_year_and_week(parsed);
+  out = parsed;
+  return true;
+}
+
+bool S3DateTime::parse_gmt(const char *time_str, struct tm &out) {
+  struct tm parsed;
+  const char *p = time_str;
+  int year;
+  memset(&parsed, 0, sizeof(struct tm));
+  if (!(parse_name(p, s3_day_names, 7, parsed.tm_wday) &&
+        parse_char(p, ',') && parse_char(p, ' ') &&
+        parse_number(p, 2, parsed.tm_mday) && parse_char(p, ' ') &&
+        parse_name(p, s3_month_names, 12, parsed.tm_mon) &&
+        parse_char(p, ' ') && parse_number(p, 4, year) &&
+        parse_char(p, ' ') && parse_time(p, parsed) && parse_char(p, ' ') &&
+        strcmp(p, "GMT") == 0)) {
+    return false;
+  }
+  parsed.tm_year = year - 1900;
+  if (!is_date_valid(parsed)) {
+    return false;
+  }
+  // Day of the week is taken from the input, as by strptime.
+  const int wday = parsed.tm_wday;
+  set_day_of_year_and_week(parsed);
+  parsed.tm_wday = wday;
+  out = parsed;
+  return true;
+}
+
+bool S3DateTime::format_iso(const struct tm &in, char *buf) {
+  if (!is_date_valid(in) || !is_time_valid(in)) {
+    return false;
+  }
+  char *p = format_number(buf, in.tm_year + 1900, 4);
+  *p++ = '-';
+  p = format_number(p, in.tm_mon + 1, 2);
+  *p++ = '-';
+  p = format_number(p, in.tm_mday, 2);
+  *p++ = 'T';
+  p = format_time(p, in);
+  memcpy(p, ".000Z", sizeof(".000Z"));
+  return true;
+}
+
+bool S3DateTime::format_gmt(const struct tm &in, char *buf) {
+  if (!is_date_valid(in) || !is_time_valid(in) || in.tm_wday < 0 ||
+      in.tm_wday > 6) {
+    return false;
+  }
+  char *p = buf;
+  memcpy(p, s3_day_names[in.tm_wday], 3);
+  p += 3;
+  *p++ = ',';
+  *p++ = ' ';
+  p = format_number(p, in.tm_mday, 2);
+  *p++ = ' ';
+  memcpy(p, s3_month_names[in.tm_mon], 3);
+  p += 3;
+  *p++ = ' ';
+  p = format_number(p, in.tm_year + 1900, 4);
+  *p++ = ' ';
+  p = format_time(p, in);
+  memcpy(p, " GMT", sizeof(" GMT"));
+  return true;
+}
+
 std::string S3DateTime::get_format_string(std::string format) {
   std::string formatted_time = "";
   char timebuffer[100] = {0};
@@ -32,13 +32,27 @@
 #define S3_ISO_DATETIME_FORMAT "%Y-%m-%dT%T.000Z"
 
 // Helper to store DateTime in KV store in Json
+//
+// ISO and GMT formats are parsed and formatted without strptime/strftime,
+// other input falls back to them.  Current time in ISO format is formatted
+// once a second.
 class S3DateTime {
   struct tm point_in_time;
   bool is_valid;
+  // Seconds since the Epoch if initialised with current time, otherwise -1.
+  time_t current_time;
 
   void init_with_fmt(std::string time_str, std::string format);
   std::string get_format_string(std::string format);
 
+  // Fill fields for "2017-01-28T13:15:30.000Z" and
+  // "Sat, 28 Jan 2017 13:15:30 GMT", return false for any other input.
+  static bool parse_iso(const char* time_str, struct tm& out);
+  static bool parse_gmt(const char* time_str, struct tm& out);
+  // 'buf' must hold 32 chars, return false if fields are out of range.
+  static bool format_iso(const struct tm& in, char* buf);
+  static bool format_gmt(const struct tm& in, char* buf);
+
  public:
   S3DateTime();
   void init_current_time();
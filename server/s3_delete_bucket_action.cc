@@ -19,6 +19,8 @@
  */
 
 #include "s3_delete_bucket_action.h"
+#include "s3_bucket_list_cache.h"
+#include "s3_bucket_usage.h"
 #include "s3_error_codes.h"
 #include "s3_iem.h"
 #include "s3_log.h"
@@ -576,6 +578,9 @@ void S3DeleteBucketAction::delete_bucket() {
 void S3DeleteBucketAction::delete_bucket_successful() {
   s3_log(S3_LOG_INFO, stripped_request_id, "%s Entry\n", __func__);
   delete_successful = true;
+  s3_bucket_usage_bucket_deleted(*bucket_metadata);
+  s3_bucket_list_cache_invalidate(
+      bucket_metadata->get_bucket_owner_account_id());
   send_response_to_s3_client();
   s3_log(S3_LOG_DEBUG, "", "%s Exit", __func__);
 }
@@ -584,6 +589,9 @@ void S3DeleteBucketAction::delete_bucket_failed() {
   s3_log(S3_LOG_INFO, stripped_request_id, "%s Entry\n", __func__);
   s3_log(S3_LOG_ERROR, request_id, "Bucket deletion failed\n");
   delete_successful = false;
+  // Metadata may have been removed from the bucket list index only.
+  s3_bucket_list_cache_invalidate(
+      bucket_metadata->get_bucket_owner_account_id());
   if (bucket_metadata->get_state() == S3BucketMetadataState::missing) {
     set_s3_error("NoSuchBucket");
   } else if (bucket_metadata->get_state() ==
@@ -19,6 +19,7 @@
  */
 
 #include "s3_delete_multiple_objects_action.h"
+#include "s3_bucket_usage.h"
 #include "s3_error_codes.h"
 #include "s3_iem.h"
 #include "s3_option.h"
@@ -360,6 +361,7 @@ void S3DeleteMultipleObjectsAction::delete_objects_metadata_successful() {
   at_least_one_delete_successful = true;
   for (auto& obj : objects_metadata) {
     delete_objects_response.add_success(obj->get_object_name());
+    s3_bucket_usage_object_deleted(*bucket_metadata, *obj);
     oids_to_delete.push_back(obj->get_oid());
     layout_id_for_objs_to_delete.push_back(obj->get_layout_id());
     pv_ids_to_delete.push_back(obj->get_pvid());
@@ -390,6 +392,9 @@ void S3DeleteMultipleObjectsAction::delete_objects_metadata_failed() {
         at_least_one_delete_successful = true;
         delete_objects_response.add_success(obj->get_object_name());
       } else {
+        if (motr_kv_writer->get_op_ret_code_for_del_kv(obj_index) == 0) {
+          s3_bucket_usage_object_deleted(*bucket_metadata, *obj);
+        }
         delete_objects_response.add_failure(obj->get_object_name(),
                                             "InternalError");
       }
@@ -19,6 +19,7 @@
  */
 
 #include "s3_delete_object_action.h"
+#include "s3_bucket_usage.h"
 #include "s3_error_codes.h"
 #include "s3_iem.h"
 #include "s3_m0_uint128_helper.h"
@@ -172,6 +173,7 @@ void S3DeleteObjectAction::delete_metadata() {
 void S3DeleteObjectAction::delete_metadata_successful() {
   s3_log(S3_LOG_WARN, request_id, "Deleted Object metadata\n");
   s3_del_obj_action_state = S3DeleteObjectActionState::metadataDeleted;
+  s3_bucket_usage_object_deleted(*bucket_metadata, *object_metadata);
   next();
   s3_log(S3_LOG_DEBUG, "", "%s Exit", __func__);
 }
@@ -19,15 +19,15 @@
  */
 
 #include "s3_error_codes.h"
-#include "s3_common_utilities.h"
+#include "s3_xml_writer.h"
 
 S3Error::S3Error(std::string error_code, std::string req_id,
                  std::string res_key, std::string error_message)
-    : code(error_code),
+    : code(std::move(error_code)),
       request_id(std::move(req_id)),
       resource_key(std::move(res_key)),
       auth_error_message(std::move(error_message)),
-      details(S3ErrorMessages::get_instance()->get_details(error_code)) {}
+      details(s3_error_details(code)) {}
 
 int S3Error::get_http_status_code() { return details.get_http_status_code(); }
 
@@ -36,26 +36,29 @@ void S3Error::set_auth_error_message(const std::string& errmsg) {
 }
 
 std::string& S3Error::to_xml(bool no_decl) {
-  if (get_http_status_code() == -1) {
-    // Object state is invalid, Wrong error code.
-    return xml_message;
-  }
-  // clang-format off
-  if (!no_decl) {
-    xml_message = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
-  }
-  xml_message += "<Error>\n";
-  xml_message += S3CommonUtilities::format_xml_string("Code", code);
-  if (auth_error_message.empty()) {
-  xml_message +=
-      S3CommonUtilities::format_xml_string("Message", details.get_message());
+  const size_t decl_length = sizeof(S3_XML_DECLARATION) - 1;
+  xml_message.clear();
+  xml_message.reserve(details.xml_head_length + resource_key.length() +
+                      request_id.length() + 64);
+  S3XmlWriter writer(xml_message);
+  if (details.xml_head_length && auth_error_message.empty()) {
+    const size_t skip = no_decl ? decl_length : 0;
+    xml_message.append(details.xml_head + skip,
+                       details.xml_head_length - skip);
   } else {
-    xml_message +=
-        S3CommonUtilities::format_xml_string("Message", auth_error_message);
+    if (!no_decl) {
+      xml_message = S3_XML_DECLARATION;
+    }
+    xml_message += "<Error>\n";
+    writer.element("Code", code);
+    if (auth_error_message.empty()) {
+      writer.element("Message", details.get_message());
+    } else {
+      writer.element("Message", auth_error_message);
+    }
   }
-  xml_message += S3CommonUtilities::format_xml_string("Resource", resource_key);
-  xml_message += S3CommonUtilities::format_xml_string("RequestId", request_id);
+  writer.element("Resource", resource_key);
+  writer.element("RequestId", request_id);
   xml_message += "</Error>\n";
-  // clang-format on
   return xml_message;
 }
@@ -48,12 +48,14 @@
   </Error>
  */
 
+// XML up to the message is pre-rendered for each known error code, only
+// resource and request ID are escaped per response.
 class S3Error {
-  std::string code;  // Error codes are read from s3_error_messages.json
+  std::string code;  // Error codes are listed in s3_error_messages.json
   std::string request_id;
   std::string resource_key;
   std::string auth_error_message;
-  S3ErrorDetails& details;
+  const S3ErrorDetails& details;
 
   std::string xml_message;
 
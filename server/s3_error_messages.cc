@@ -18,59 +18,62 @@
  *
  */
 
-#include <json/json.h>
-#include <fstream>
-#include <iostream>
-
 #include "s3_error_messages.h"
 
-S3ErrorMessages* S3ErrorMessages::instance = NULL;
+#define S3_ERROR_XML_HEAD(code, message_xml) \
+  S3_XML_DECLARATION "<Error>\n<Code>" #code "</Code>" message_xml
 
-S3ErrorMessages::S3ErrorMessages(std::string config_file) {
-  Json::Value jsonroot;
-  Json::Reader reader;
-  std::ifstream json_file(config_file.c_str(), std::ifstream::binary);
-  bool parsingSuccessful = reader.parse(json_file, jsonroot);
-  if (!parsingSuccessful) {
-    s3_log(S3_LOG_FATAL, "", "Json Parsing failed for file: %s.\n",
-           config_file.c_str());
-    s3_log(S3_LOG_FATAL, "", "Error: %s\n",
-           reader.getFormattedErrorMessages().c_str());
-    exit(1);
-    return;
-  }
+#define S3_ERROR_DETAILS(code, http_code, description, message_xml) \
+  {#code, http_code, description, S3_ERROR_XML_HEAD(code, message_xml), \
+   sizeof(S3_ERROR_XML_HEAD(code, message_xml)) - 1},
 
-  Json::Value::Members members = jsonroot.getMemberNames();
-  for (auto it : members) {
-    error_list[it] = S3ErrorDetails(jsonroot[it]["Description"].asString(),
-                                    jsonroot[it]["httpcode"].asInt());
-  }
-}
+static constexpr S3ErrorDetails error_table[] = {
+    S3_ERROR_TABLE(S3_ERROR_DETAILS)
+    // S3ErrorCode::unknown
+    {"", 520, "Unknown Error", "", 0}};
 
-S3ErrorMessages::~S3ErrorMessages() {
-  // To keep jsoncpp happy in clean up.
-  error_list.clear();
-}
+#undef S3_ERROR_DETAILS
+#undef S3_ERROR_XML_HEAD
 
-S3ErrorDetails& S3ErrorMessages::get_details(std::string code) {
-  return error_list[code];
+static constexpr size_t known_codes_count =
+    sizeof(error_table) / sizeof(error_table[0]) - 1;
+
+static_assert(known_codes_count == (size_t)S3ErrorCode::unknown,
+              "Error table does not match S3ErrorCode");
+
+static constexpr int compare_codes(const char* a, const char* b) {
+  return *a != *b ? (unsigned char)*a - (unsigned char)*b
+                  : (*a ? compare_codes(a + 1, b + 1) : 0);
 }
 
-void S3ErrorMessages::init_messages(std::string config_file) {
-  if (!instance) {
-    instance = new S3ErrorMessages(config_file);
-  }
+static constexpr bool codes_are_sorted(size_t i) {
+  return i + 1 >= known_codes_count ||
+         (compare_codes(error_table[i].code, error_table[i + 1].code) < 0 &&
+          codes_are_sorted(i + 1));
 }
 
-void S3ErrorMessages::finalize() {
-  if (!instance) {
-    delete instance;
+// Lookup is a binary search.
+static_assert(codes_are_sorted(0), "Error table is not sorted by code");
+
+S3ErrorCode s3_error_code_from_string(const std::string& code) {
+  size_t low = 0;
+  size_t high = known_codes_count;
+  while (low < high) {
+    const size_t middle = (low + high) / 2;
+    const int cmp = code.compare(error_table[middle].code);
+    if (cmp == 0) {
+      return (S3ErrorCode)middle;
+    }
+    if (cmp < 0) {
+      high = middle;
+    } else {
+      low = middle + 1;
+    }
   }
+  return S3ErrorCode::unknown;
 }
 
-S3ErrorMessages* S3ErrorMessages::get_instance() {
-  if (!instance) {
-    S3ErrorMessages::init_messages();
-  }
-  return instance;
+const S3ErrorDetails& s3_error_details(S3ErrorCode code) {
+  const size_t index = (size_t)code;
+  return error_table[index < known_codes_count ? index : known_codes_count];
 }
@@ -23,53 +23,46 @@
 #ifndef __S3_SERVER_S3_ERROR_MESSAGES_H__
 #define __S3_SERVER_S3_ERROR_MESSAGES_H__
 
-#include <gtest/gtest_prod.h>
-#include <map>
+#include <cstddef>
 #include <string>
-#include "s3_log.h"
-
-class S3ErrorDetails {
-  std::string description;
-  int http_return_code;
 
- public:
-  S3ErrorDetails() : description("Unknown Error"), http_return_code(520) {}
-
-  S3ErrorDetails(std::string message, int http_code) {
-    description = message;
-    http_return_code = http_code;
-  }
-
-  std::string& get_message() { return description; }
+#include "s3_error_table.h"
+#include "s3_log.h"
 
-  int get_http_status_code() { return http_return_code; }
+// Error catalogue compiled from resources/s3_error_messages.json, see
+// scripts/gen_s3_error_table.py.
 
-  FRIEND_TEST(S3ErrorDetailsTest, DefaultConstructor);
-  FRIEND_TEST(S3ErrorDetailsTest, ConstructorWithMsg);
+enum class S3ErrorCode : unsigned short {
+#define S3_ERROR_CODE_ENUM(code, http_code, description, message_xml) code,
+  S3_ERROR_TABLE(S3_ERROR_CODE_ENUM)
+#undef S3_ERROR_CODE_ENUM
+  // Code which is not in the catalogue.
+  unknown
 };
 
-class S3ErrorMessages {
- private:
-  static S3ErrorMessages* instance;
-  S3ErrorMessages(std::string config_file);
-  ~S3ErrorMessages();
+#define S3_XML_DECLARATION "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
 
-  std::map<std::string, S3ErrorDetails> error_list;
-
- public:
-  // Loads messages and creates singleton
-  static void init_messages(
-      std::string config_file =
-          "/opt/seagate/cortx/s3/resources/s3_error_messages.json");
-
-  // Cleans up the singleton instance
-  static void finalize();
+struct S3ErrorDetails {
+  const char* code;
+  int http_return_code;
+  const char* description;
+  // Error XML up to and including the <Message> element, with XML
+  // declaration, empty for unknown code.
+  const char* xml_head;
+  size_t xml_head_length;
+
+  const char* get_message() const { return description; }
+  int get_http_status_code() const { return http_return_code; }
+};
 
-  static S3ErrorMessages* get_instance();
+// S3ErrorCode::unknown when 'code' is not in the catalogue.
+S3ErrorCode s3_error_code_from_string(const std::string& code);
 
-  S3ErrorDetails& get_details(std::string code);
+// Details of S3ErrorCode::unknown are "Unknown Error" and HTTP status 520.
+const S3ErrorDetails& s3_error_details(S3ErrorCode code);
 
-  FRIEND_TEST(S3ErrorMessagesTest, Constructor);
-};
+inline const S3ErrorDetails& s3_error_details(const std::string& code) {
+  return s3_error_details(s3_error_code_from_string(code));
+}
 
 #endif
@@ -0,0 +1,230 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+// Generated by scripts/gen_s3_error_table.py from
+// resources/s3_error_messages.json, do not edit.
+
+#pragma once
+
+#ifndef __S3_SERVER_S3_ERROR_TABLE_H__
+#define __S3_SERVER_S3_ERROR_TABLE_H__
+
+// X(code, HTTP status, description, <Message> element as S3XmlWriter
+// renders it), sorted by code.
+#define S3_ERROR_TABLE(X)                                                      \
+  X(AccessDenied, 403,                                                         \
+    "Access Denied",                                                           \
+    "<Message>Access Denied</Message>")                                        \
+  X(AccountNotEmpty, 409,                                                      \
+    "The Account you tried to delete is not empty and has at least one "       \
+    "bucket.",                                                                 \
+    "<Message>The Account you tried to delete is not empty and has at "        \
+    "least one bucket.</Message>")                                             \
+  X(BadDigest, 400,                                                            \
+    "The Content-MD5 you specified did not match what we received.",           \
+    "<Message>The Content-MD5 you specified did not match what we "            \
+    "received.</Message>")                                                     \
+  X(BadRequest, 400,                                                           \
+    "The request could not be understood by the server due to malformed "      \
+    "syntax. The client should not repeat the request without "                \
+    "modifications.",                                                          \
+    "<Message>The request could not be understood by the server due to "       \
+    "malformed syntax. The client should not repeat the request without "      \
+    "modifications.</Message>")                                                \
+  X(BucketAlreadyExists, 409,                                                  \
+    "The requested bucket name is not available. The bucket namespace is "     \
+    "shared by all users of the system. Please select a different name and "   \
+    "try again.",                                                              \
+    "<Message>The requested bucket name is not available. The bucket "         \
+    "namespace is shared by all users of the system. Please select a "         \
+    "different name and try again.</Message>")                                 \
+  X(BucketAlreadyOwnedByYou, 409,                                              \
+    "The bucket you tried to create already exists, and you own it.",          \
+    "<Message>The bucket you tried to create already exists, and you own "     \
+    "it.</Message>")                                                           \
+  X(BucketNotEmpty, 409,                                                       \
+    "The bucket you tried to delete is not empty.",                            \
+    "<Message>The bucket you tried to delete is not empty.</Message>")         \
+  X(EntityTooLarge, 413,                                                       \
+    "Your proposed upload exceeds the maximum allowed size.",                  \
+    "<Message>Your proposed upload exceeds the maximum allowed "               \
+    "size.</Message>")                                                         \
+  X(EntityTooSmall, 400,                                                       \
+    "Your proposed upload is smaller than the minimum allowed object size. "   \
+    "Each part must be at least 5 MB in size, except the last part.",          \
+    "<Message>Your proposed upload is smaller than the minimum allowed "       \
+    "object size. Each part must be at least 5 MB in size, except the last "   \
+    "part.</Message>")                                                         \
+  X(ExpiredToken, 400,                                                         \
+    "The provided token has expired.",                                         \
+    "<Message>The provided token has expired.</Message>")                      \
+  X(InternalError, 500,                                                        \
+    "We encountered an internal error. Please try again.",                     \
+    "<Message>We encountered an internal error. Please try again.</Message>")  \
+  X(InvalidAccessKeyId, 403,                                                   \
+    "The AWS access key Id you provided does not exist in our records.",       \
+    "<Message>The AWS access key Id you provided does not exist in our "       \
+    "records.</Message>")                                                      \
+  X(InvalidAccountForMgmtApi, 400,                                             \
+    "Supplied credentials are not owned by account id specified in action "    \
+    "URI.",                                                                    \
+    "<Message>Supplied credentials are not owned by account id specified "     \
+    "in action URI.</Message>")                                                \
+  X(InvalidArgument, 400,                                                      \
+    "Invalid Argument.",                                                       \
+    "<Message>Invalid Argument.</Message>")                                    \
+  X(InvalidBucketName, 400,                                                    \
+    "The specified bucket is not valid.",                                      \
+    "<Message>The specified bucket is not valid.</Message>")                   \
+  X(InvalidDigest, 400,                                                        \
+    "The Content-MD5 you specified is not valid",                              \
+    "<Message>The Content-MD5 you specified is not valid</Message>")           \
+  X(InvalidID, 400,                                                            \
+    "The provided ID is Invalid.",                                             \
+    "<Message>The provided ID is Invalid.</Message>")                          \
+  X(InvalidObjectState, 403,                                                   \
+    "",                                                                        \
+    "<Message/>")                                                              \
+  X(InvalidPart, 400,                                                          \
+    "One or more of the specified parts could not be found. The part might "   \
+    "not have been uploaded, or the specified entity tag might not have "      \
+    "matched the part's entity tag.",                                          \
+    "<Message>One or more of the specified parts could not be found. The "     \
+    "part might not have been uploaded, or the specified entity tag might "    \
+    "not have matched the part's entity tag.</Message>")                       \
+  X(InvalidPartOrder, 400,                                                     \
+    "The list of parts was not in ascending order. The parts list must be "    \
+    "specified in order by part number.",                                      \
+    "<Message>The list of parts was not in ascending order. The parts list "   \
+    "must be specified in order by part number.</Message>")                    \
+  X(InvalidPartSize, 400,                                                      \
+    "Part size must be multiple of unit_size. Refer s3 readme.",               \
+    "<Message>Part size must be multiple of unit_size. Refer s3 "              \
+    "readme.</Message>")                                                       \
+  X(InvalidRange, 416,                                                         \
+    "The requested range cannot be satisfied.",                                \
+    "<Message>The requested range cannot be satisfied.</Message>")             \
+  X(InvalidRequest, 400,                                                       \
+    "Specifying both Canned ACLs and Header Grants is not allowed",            \
+    "<Message>Specifying both Canned ACLs and Header Grants is not "           \
+    "allowed</Message>")                                                       \
+  X(InvalidTagError, 400,                                                      \
+    "The tag provided was not a valid tag. This error can occur if the tag "   \
+    "did not pass input validation.",                                          \
+    "<Message>The tag provided was not a valid tag. This error can occur "     \
+    "if the tag did not pass input validation.</Message>")                     \
+  X(InvalidToken, 400,                                                         \
+    "The provided token is malformed or otherwise invalid.",                   \
+    "<Message>The provided token is malformed or otherwise "                   \
+    "invalid.</Message>")                                                      \
+  X(KeyTooLongError, 400,                                                      \
+    "Your key is too long.",                                                   \
+    "<Message>Your key is too long.</Message>")                                \
+  X(MalformedACLError, 400,                                                    \
+    "The XML you provided was not well-formed or did not validate against "    \
+    "our published schema.",                                                   \
+    "<Message>The XML you provided was not well-formed or did not validate "   \
+    "against our published schema.</Message>")                                 \
+  X(MalformedFICmd, 400,                                                       \
+    "The fault injection command token is invalid.",                           \
+    "<Message>The fault injection command token is invalid.</Message>")        \
+  X(MalformedPolicy, 400,                                                      \
+    "The policy you provided is not valid",                                    \
+    "<Message>The policy you provided is not valid</Message>")                 \
+  X(MalformedXML, 400,                                                         \
+    "The XML you provided was not well-formed or did not validate against "    \
+    "our published schema.",                                                   \
+    "<Message>The XML you provided was not well-formed or did not validate "   \
+    "against our published schema.</Message>")                                 \
+  X(MaxMessageLengthExceeded, 400,                                             \
+    "Your request was too big.",                                               \
+    "<Message>Your request was too big.</Message>")                            \
+  X(MetaDataCorruption, 500,                                                   \
+    "Metadata corrupted",                                                      \
+    "<Message>Metadata corrupted</Message>")                                   \
+  X(MetadataTooLarge, 400,                                                     \
+    "Your metadata headers exceed the maximum allowed metadata size",          \
+    "<Message>Your metadata headers exceed the maximum allowed metadata "      \
+    "size</Message>")                                                          \
+  X(MethodNotAllowed, 405,                                                     \
+    "The specified method is not allowed against this resource",               \
+    "<Message>The specified method is not allowed against this "               \
+    "resource</Message>")                                                      \
+  X(MissingContentLength, 411,                                                 \
+    "You must provide the Content-Length HTTP header.",                        \
+    "<Message>You must provide the Content-Length HTTP header.</Message>")     \
+  X(NoSuchBucket, 404,                                                         \
+    "The specified bucket does not exist.",                                    \
+    "<Message>The specified bucket does not exist.</Message>")                 \
+  X(NoSuchBucketPolicy, 404,                                                   \
+    "The specified bucket does not have a bucket policy.",                     \
+    "<Message>The specified bucket does not have a bucket policy.</Message>")  \
+  X(NoSuchIndex, 404,                                                          \
+    "The specified index does not exist.",                                     \
+    "<Message>The specified index does not exist.</Message>")                  \
+  X(NoSuchKey, 404,                                                            \
+    "The specified key does not exist.",                                       \
+    "<Message>The specified key does not exist.</Message>")                    \
+  X(NoSuchTagSetError, 404,                                                    \
+    "There is no tag set associated with the bucket.",                         \
+    "<Message>There is no tag set associated with the bucket.</Message>")      \
+  X(NoSuchUpload, 404,                                                         \
+    "The specified multipart upload does not exist. The upload ID might be "   \
+    "invalid, or the multipart upload might have been aborted or completed.",  \
+    "<Message>The specified multipart upload does not exist. The upload ID "   \
+    "might be invalid, or the multipart upload might have been aborted or "    \
+    "completed.</Message>")                                                    \
+  X(NotImplemented, 501,                                                       \
+    "A header you provided implies functionality that is not implemented.",    \
+    "<Message>A header you provided implies functionality that is not "        \
+    "implemented.</Message>")                                                  \
+  X(OperationNotSupported, 401,                                                \
+    "The requested operation is not supported.",                               \
+    "<Message>The requested operation is not supported.</Message>")            \
+  X(RequestTimeTooSkewed, 403,                                                 \
+    "The difference between request time and current time is too large",       \
+    "<Message>The difference between request time and current time is too "    \
+    "large</Message>")                                                         \
+  X(RequestTimeout, 400,                                                       \
+    "The client did not produce a request within the time that the server "    \
+    "was prepared to wait.",                                                   \
+    "<Message>The client did not produce a request within the time that "      \
+    "the server was prepared to wait.</Message>")                              \
+  X(ServiceUnavailable, 503,                                                   \
+    "Reduce your request rate.",                                               \
+    "<Message>Reduce your request rate.</Message>")                            \
+  X(SignatureDoesNotMatch, 403,                                                \
+    "The request signature we calculated does not match the signature you "    \
+    "provided. Check your AWS secret access key and signing method. For "      \
+    "more information, see REST Authentication andSOAP Authentication for "    \
+    "details.",                                                                \
+    "<Message>The request signature we calculated does not match the "         \
+    "signature you provided. Check your AWS secret access key and signing "    \
+    "method. For more information, see REST Authentication andSOAP "           \
+    "Authentication for details.</Message>")                                   \
+  X(UnexpectedContent, 400,                                                    \
+    "This request does not support content.",                                  \
+    "<Message>This request does not support content.</Message>")               \
+  X(UnresolvableGrantByEmailAddress, 400,                                      \
+    "The email address you provided does not match any account on record.",    \
+    "<Message>The email address you provided does not match any account on "   \
+    "record.</Message>")
+
+#endif
@@ -75,6 +75,14 @@ void S3Evbuffer::to_motr_read_buffers(struct s3_motr_rw_op_context* rw_ctx,
   }
 }
 
+S3BufferSequence S3Evbuffer::get_buffers() const {
+  S3BufferSequence buffers;
+  for (size_t i = 0; i < nvecs; ++i) {
+    buffers.emplace_back(vec[i].iov_base, vec[i].iov_len);
+  }
+  return buffers;
+}
+
 // Releases ownership of evbuffer, caller needs to ensure evbuffer is freed
 // later point of time by owning a reference returned.
 struct evbuffer* S3Evbuffer::release_ownership() {
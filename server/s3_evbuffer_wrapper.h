@@ -26,6 +26,8 @@
 #include <evhtp.h>
 #include <string>
 
+#include "s3_buffer_sequence.h"
+
 // Usage example:
 //  Say for 32mb read operation with 1 mb unit size object.
 //  S3Evbuffer *evbuf = new S3Evbuffer(32 * 1048576/* 32mb */, 1048576 /* 1mb */
@@ -61,6 +63,8 @@ class S3Evbuffer {
   // owned by evbuffer
   void to_motr_read_buffers(struct s3_motr_rw_op_context *rw_ctx,
                             uint64_t *offset);
+  // Buffers of the evbuffer in order, see s3_motr_extents_set_up().
+  S3BufferSequence get_buffers() const;
 
   size_t get_evbuff_length();
   void read_drain_data_from_buffer(size_t read_data_start_offset);
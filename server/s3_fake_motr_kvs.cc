@@ -23,36 +23,59 @@
 #include "s3_fake_motr_kvs.h"
 #include "s3_log.h"
 
-#include <algorithm>
+#include <utility>
+#include <vector>
 
 std::unique_ptr<S3FakeMotrKvs> S3FakeMotrKvs::inst;
 
-S3FakeMotrKvs::S3FakeMotrKvs() : in_mem_kv() {}
+S3FakeMotrKvs::S3FakeMotrKvs() : indices() {}
+
+// Copies 'value' to a buffer which is freed by the upper level.
+static void *copy_to_buf(const std::string &value) {
+  char *buf = (char *)malloc(value.size() + 1);
+  memcpy(buf, value.data(), value.size());
+  buf[value.size()] = '\0';
+  return buf;
+}
+
+std::shared_ptr<S3FakeMotrKvs::Index> S3FakeMotrKvs::get_index(
+    struct m0_uint128 const &oid, bool create) {
+  std::lock_guard<std::mutex> lock(indices_mutex);
+  auto it = indices.find(oid);
+  if (it != indices.end()) {
+    return it->second;
+  }
+  if (!create) {
+    return nullptr;
+  }
+  return indices[oid] = std::make_shared<Index>();
+}
 
 int S3FakeMotrKvs::kv_read(struct m0_uint128 const &oid,
                            struct s3_motr_kvs_op_context const &kv) {
   s3_log(S3_LOG_DEBUG, "", "%s Entry with oid %" SCNx64 " : %" SCNx64 "\n",
          __func__, oid.u_hi, oid.u_lo);
-  if (in_mem_kv.count(oid) == 0) {
+  std::shared_ptr<Index> index = get_index(oid, false);
+  if (!index) {
     s3_log(S3_LOG_DEBUG, "", "%s Exit NOENT\n", __func__);
     return -ENOENT;
   }
 
-  KeyVal &obj_kv = in_mem_kv[oid];
+  std::lock_guard<std::mutex> lock(index->mutex);
+  std::string found_val;
   int cnt = kv.values->ov_vec.v_nr;
   for (int i = 0; i < cnt; ++i) {
     std::string search_key((char *)kv.keys->ov_buf[i],
                            kv.keys->ov_vec.v_count[i]);
-    if (obj_kv.count(search_key) == 0) {
+    if (!index->kvs.get(search_key, found_val)) {
       kv.rcs[i] = -ENOENT;
       s3_log(S3_LOG_DEBUG, "", "k:>%s v:>ENOENT\n", search_key.c_str());
       continue;
     }
 
-    std::string found_val = obj_kv[search_key];
     kv.rcs[i] = 0;
     kv.values->ov_vec.v_count[i] = found_val.length();
-    kv.values->ov_buf[i] = strdup(found_val.c_str());
+    kv.values->ov_buf[i] = copy_to_buf(found_val);
     s3_log(S3_LOG_DEBUG, "", "k:>%s v:>%s\n", search_key.c_str(),
            found_val.c_str());
   }
@@ -65,60 +88,46 @@ int S3FakeMotrKvs::kv_next(struct m0_uint128 const &oid,
                            struct s3_motr_kvs_op_context const &kv) {
   s3_log(S3_LOG_DEBUG, "", "%s Entry with oid %" SCNx64 " : %" SCNx64 "\n",
          __func__, oid.u_hi, oid.u_lo);
-  if (in_mem_kv.count(oid) == 0) {
+  std::shared_ptr<Index> index = get_index(oid, false);
+  if (!index) {
     s3_log(S3_LOG_DEBUG, "", "%s Exit ENOENT\n", __func__);
     return -ENOENT;
   }
 
-  KeyVal &obj_kv = in_mem_kv[oid];
-  int cnt = kv.values->ov_vec.v_nr;
-  auto val_it = std::begin(obj_kv);
+  std::string start_key;
+  bool exclude_start_key = false;
   if (kv.keys->ov_vec.v_count[0] > 0) {
-    std::string search_key((char *)kv.keys->ov_buf[0],
-                           kv.keys->ov_vec.v_count[0]);
+    start_key.assign((char *)kv.keys->ov_buf[0], kv.keys->ov_vec.v_count[0]);
+    exclude_start_key = (kv.flags & M0_OIF_EXCLUDE_START_KEY) != 0;
 
     kv.keys->ov_vec.v_count[0] = 0;
     // do not free - done in upper level
     kv.keys->ov_buf[0] = nullptr;
+  }
 
-    val_it = obj_kv.find(search_key);
-    if (val_it == std::end(obj_kv)) {
-      val_it = std::find_if(
-          std::begin(obj_kv), std::end(obj_kv),
-          [&search_key](const std::pair<std::string, std::string> & itv)
-              ->bool { return itv.first.find(search_key) == 0; });
-    } else {
-      // found full value, should take next
-      ++val_it;
-    }
-    if (val_it == std::end(obj_kv)) {
-      s3_log(S3_LOG_DEBUG, "", "%s Exit k:>%s ENOENT\n", __func__,
-             search_key.c_str());
-      return -ENOENT;
-    }
-    s3_log(S3_LOG_DEBUG, "", "Initial k:>%s found\n", search_key.c_str());
+  int cnt = kv.values->ov_vec.v_nr;
+  std::vector<std::pair<std::string, std::string>> found;
+  found.reserve(cnt);
+  {
+    std::lock_guard<std::mutex> lock(index->mutex);
+    index->kvs.next(start_key, exclude_start_key, cnt, found);
   }
 
+  // Remaining slots are reported as missing keys, like Motr does at the end
+  // of an index.
   for (int i = 0; i < cnt; ++i) {
-    kv.rcs[i] = -ENOENT;
-    if (val_it == std::end(obj_kv)) {
+    if ((size_t)i >= found.size()) {
+      kv.rcs[i] = -ENOENT;
       continue;
     }
-
     kv.rcs[i] = 0;
+    kv.keys->ov_vec.v_count[i] = found[i].first.length();
+    kv.keys->ov_buf[i] = copy_to_buf(found[i].first);
+    kv.values->ov_vec.v_count[i] = found[i].second.length();
+    kv.values->ov_buf[i] = copy_to_buf(found[i].second);
 
-    std::string tmp = val_it->first;
-    kv.keys->ov_vec.v_count[i] = tmp.length();
-    kv.keys->ov_buf[i] = strdup(tmp.c_str());
-
-    tmp = val_it->second;
-    kv.values->ov_vec.v_count[i] = tmp.length();
-    kv.values->ov_buf[i] = strdup(tmp.c_str());
-
-    s3_log(S3_LOG_DEBUG, "", "Got k:>%s v:>%s\n", (char *)kv.keys->ov_buf[i],
-           (char *)kv.values->ov_buf[i]);
-
-    ++val_it;
+    s3_log(S3_LOG_DEBUG, "", "Got k:>%s v:>%s\n", found[i].first.c_str(),
+           found[i].second.c_str());
   }
 
   s3_log(S3_LOG_DEBUG, "", "%s Exit 0\n", __func__);
@@ -129,14 +138,15 @@ int S3FakeMotrKvs::kv_write(struct m0_uint128 const &oid,
                             struct s3_motr_kvs_op_context const &kv) {
   s3_log(S3_LOG_DEBUG, "", "%s Entry with oid %" SCNx64 " : %" SCNx64 "\n",
          __func__, oid.u_hi, oid.u_lo);
-  KeyVal &obj_kv = in_mem_kv[oid];
+  std::shared_ptr<Index> index = get_index(oid, true);
 
+  std::lock_guard<std::mutex> lock(index->mutex);
   int cnt = kv.values->ov_vec.v_nr;
   for (int i = 0; i < cnt; ++i) {
     std::string nkey((char *)kv.keys->ov_buf[i], kv.keys->ov_vec.v_count[i]);
     std::string nval((char *)kv.values->ov_buf[i],
                      kv.values->ov_vec.v_count[i]);
-    obj_kv[nkey] = nval;
+    index->kvs.put(nkey, nval);
     kv.rcs[i] = 0;
 
     s3_log(S3_LOG_DEBUG, "", "Add k:>%s -> v:>%s\n", nkey.c_str(),
@@ -151,20 +161,17 @@ int S3FakeMotrKvs::kv_del(struct m0_uint128 const &oid,
                           struct s3_motr_kvs_op_context const &kv) {
   s3_log(S3_LOG_DEBUG, "", "%s Entry with oid %" SCNx64 " : %" SCNx64 "\n",
          __func__, oid.u_hi, oid.u_lo);
-  if (in_mem_kv.count(oid) == 0) {
+  std::shared_ptr<Index> index = get_index(oid, false);
+  if (!index) {
     s3_log(S3_LOG_DEBUG, "", "%s Exit NOENT\n", __func__);
     return -ENOENT;
   }
 
-  KeyVal &obj_kv = in_mem_kv[oid];
-
+  std::lock_guard<std::mutex> lock(index->mutex);
   int cnt = kv.values->ov_vec.v_nr;
   for (int i = 0; i < cnt; ++i) {
     std::string nkey((char *)kv.keys->ov_buf[i], kv.keys->ov_vec.v_count[i]);
-    kv.rcs[i] = -ENOENT;
-    if (obj_kv.erase(nkey) > 0) {
-      kv.rcs[i] = 0;
-    }
+    kv.rcs[i] = index->kvs.del(nkey) ? 0 : -ENOENT;
 
     s3_log(S3_LOG_DEBUG, "", "Del k:>%s -> %d\n", nkey.c_str(), kv.rcs[i]);
   }
@@ -24,15 +24,24 @@
 #define __S3_SERVER_FAKE_MOTR_KVS__H__
 
 #include "s3_motr_context.h"
+#include "s3_sorted_kv_store.h"
 
+#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 
+// In-process KVS used instead of Motr indices in fake KVS mode.  Indices are
+// created on first put.  Batches of keys of one index are applied under the
+// index lock, different indices are used concurrently.
 class S3FakeMotrKvs {
  private:
   S3FakeMotrKvs();
 
-  typedef std::map<std::string, std::string> KeyVal;
+  struct Index {
+    std::mutex mutex;
+    S3SortedKvStore kvs;
+  };
   struct Uint128Comp {
     bool operator()(struct m0_uint128 const &a,
                     struct m0_uint128 const &b) const {
@@ -40,7 +49,11 @@ class S3FakeMotrKvs {
     }
   };
 
-  std::map<struct m0_uint128, KeyVal, Uint128Comp> in_mem_kv;
+  std::mutex indices_mutex;
+  std::map<struct m0_uint128, std::shared_ptr<Index>, Uint128Comp> indices;
+
+  // Returns nullptr if there is no such index and 'create' is false.
+  std::shared_ptr<Index> get_index(struct m0_uint128 const &oid, bool create);
 
  private:
   static std::unique_ptr<S3FakeMotrKvs> inst;
@@ -51,6 +64,9 @@ class S3FakeMotrKvs {
   int kv_read(struct m0_uint128 const &oid,
               struct s3_motr_kvs_op_context const &kv);
 
+  // Follows Motr: returns keys starting from the one in keys->ov_buf[0], or
+  // after it with M0_OIF_EXCLUDE_START_KEY in kv.flags, or from the first
+  // key when it is empty.
   int kv_next(struct m0_uint128 const &oid,
               struct s3_motr_kvs_op_context const &kv);
 
@@ -0,0 +1,537 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <json/json.h>
+#include <time.h>
+
+#include <algorithm>
+#include <functional>
+#include <utility>
+
+#include "atexit.h"
+#include "motr_request_object.h"
+#include "s3_datetime.h"
+#include "s3_garbage_collector.h"
+#include "s3_log.h"
+#include "s3_m0_uint128_helper.h"
+#include "s3_motr_kvs_reader.h"
+#include "s3_motr_kvs_writer.h"
+#include "s3_motr_writer.h"
+#include "s3_option.h"
+#include "s3_stats.h"
+
+extern struct m0_uint128 global_probable_dead_object_list_index_oid;
+extern evbase_t* global_evbase_handle;
+
+// Interval at which collector refills tokens and dispatches queued records.
+#define S3_GC_TICK_INTERVAL_MSEC 100
+// How long s3_gc_fini waits for motr operations in flight.
+#define S3_GC_DRAIN_TIMEOUT_SEC 10
+
+static bool is_zero_oid(const struct m0_uint128& oid) {
+  return oid.u_hi == 0ULL && oid.u_lo == 0ULL;
+}
+
+static bool is_equal_oid(const struct m0_uint128& a,
+                         const struct m0_uint128& b) {
+  return a.u_hi == b.u_hi && a.u_lo == b.u_lo;
+}
+
+S3GCTokenBucket::S3GCTokenBucket(double rate_per_sec, double burst_size,
+                                 std::chrono::steady_clock::time_point now)
+    : rate(rate_per_sec),
+      burst(burst_size),
+      tokens(burst_size),
+      last_refill(now) {}
+
+void S3GCTokenBucket::refill(std::chrono::steady_clock::time_point now) {
+  if (now <= last_refill) {
+    return;
+  }
+  std::chrono::duration<double> elapsed = now - last_refill;
+  tokens = std::min(burst, tokens + elapsed.count() * rate);
+  last_refill = now;
+}
+
+bool S3GCTokenBucket::try_consume(double count,
+                                  std::chrono::steady_clock::time_point now) {
+  if (rate <= 0) {
+    // No I/O budget configured.
+    return true;
+  }
+  refill(now);
+  if (tokens < count) {
+    return false;
+  }
+  tokens -= count;
+  return true;
+}
+
+bool S3GCProbableDeleteEntry::is_old_object_record() const {
+  return old_object_record;
+}
+
+bool S3GCProbableDeleteEntry::from_json(const std::string& key,
+                                        const std::string& json) {
+  Json::Value root;
+  Json::Reader reader;
+
+  record_key = key;
+  if (!reader.parse(json, root) || !root.isObject()) {
+    s3_log(S3_LOG_ERROR, "", "Json parsing failed for record %s\n",
+           key.c_str());
+    return false;
+  }
+  // Key is prefixed with size based bucketing marker, followed by OID of the
+  // object which is candidate for deletion (encoded as "<hi>-<lo>"),
+  // optionally followed by '-' and OID of the new object.
+  if (key.length() < 2) {
+    return false;
+  }
+  std::string oid_str = key.substr(1);
+  size_t pos = oid_str.find('-');
+  if (pos == std::string::npos) {
+    return false;
+  }
+  pos = oid_str.find('-', pos + 1);
+  old_object_record = pos != std::string::npos;
+  if (old_object_record) {
+    oid_str.erase(pos);
+  }
+  oid = S3M0Uint128Helper::to_m0_uint128(oid_str);
+  if (is_zero_oid(oid)) {
+    return false;
+  }
+
+  old_oid = S3M0Uint128Helper::to_m0_uint128(root["old_oid"].asString());
+  object_key_in_index = root["object_key_in_index"].asString();
+  layout_id = root["object_layout_id"].asInt();
+  object_list_idx_oid =
+      S3M0Uint128Helper::to_m0_uint128(root["object_list_index_oid"].asString());
+  objects_version_list_idx_oid = S3M0Uint128Helper::to_m0_uint128(
+      root["objects_version_list_index_oid"].asString());
+  force_delete = root["force_delete"].asString() == "true";
+  is_multipart = root["is_multipart"].asString() == "true";
+  if (is_multipart) {
+    part_list_idx_oid =
+        S3M0Uint128Helper::to_m0_uint128(root["part_list_idx_oid"].asString());
+  } else {
+    version_key_in_index = root["version_key_in_index"].asString();
+  }
+
+  struct tm tm_create = {};
+  std::string create_timestamp = root["create_timestamp"].asString();
+  if (strptime(create_timestamp.c_str(), S3_ISO_DATETIME_FORMAT, &tm_create) ==
+      NULL) {
+    return false;
+  }
+  create_time = timegm(&tm_create);
+
+  return !object_key_in_index.empty() && !is_zero_oid(object_list_idx_oid);
+}
+
+S3GCAction S3GCProbableDeleteEntry::decide(
+    bool object_present, const struct m0_uint128& current_oid) const {
+  if (force_delete) {
+    return S3GCAction::delete_object;
+  }
+  if (is_multipart) {
+    // Needs multipart index lookup, left to s3backgrounddelete.
+    return S3GCAction::skip;
+  }
+  if (is_old_object_record()) {
+    // Old object was either deleted or replaced by a newer one.
+    if (!object_present || !is_equal_oid(oid, current_oid)) {
+      return S3GCAction::delete_object;
+    }
+    // Overwrite did not complete, old object is still live.
+    return S3GCAction::skip;
+  }
+  // Record for new object
+  if (object_present && is_equal_oid(oid, current_oid)) {
+    return S3GCAction::drop_record;
+  }
+  // Either PUT is still in progress or has failed; only instance liveness
+  // check in s3backgrounddelete can tell.
+  return S3GCAction::skip;
+}
+
+S3GCRecordProcessor::S3GCRecordProcessor(S3GarbageCollector* collector,
+                                         S3GCProbableDeleteEntry rec)
+    : gc(collector), entry(std::move(rec)) {}
+
+void S3GCRecordProcessor::run() {
+  s3_log(S3_LOG_DEBUG, "", "%s Entry with record %s\n", __func__,
+         entry.record_key.c_str());
+  start_time = std::chrono::steady_clock::now();
+  if (entry.force_delete) {
+    delete_object();
+  } else {
+    get_object_metadata();
+  }
+}
+
+void S3GCRecordProcessor::get_object_metadata() {
+  motr_kv_reader = gc->motr_kvs_reader_factory->create_motr_kvs_reader(
+      gc->request, gc->s3_motr_api);
+  auto self = shared_from_this();
+  motr_kv_reader->get_keyval(
+      entry.object_list_idx_oid, entry.object_key_in_index,
+      [self]() { self->get_object_metadata_successful(); },
+      [self]() { self->get_object_metadata_failed(); });
+}
+
+void S3GCRecordProcessor::get_object_metadata_successful() {
+  // Value is S3ObjectMetadata json, only the motr_oid is needed here.
+  Json::Value root;
+  Json::Reader reader;
+  if (!reader.parse(motr_kv_reader->get_value(), root) || !root.isObject()) {
+    s3_log(S3_LOG_ERROR, "", "Failed to parse metadata of object %s\n",
+           entry.object_key_in_index.c_str());
+    done(S3GCAction::skip, true);
+    return;
+  }
+  struct m0_uint128 current_oid =
+      S3M0Uint128Helper::to_m0_uint128(root["motr_oid"].asString());
+  S3GCAction action = entry.decide(true, current_oid);
+  if (action == S3GCAction::delete_object) {
+    delete_object();
+  } else if (action == S3GCAction::drop_record) {
+    delete_record();
+  } else {
+    done(action, false);
+  }
+}
+
+void S3GCRecordProcessor::get_object_metadata_failed() {
+  if (motr_kv_reader->get_state() == S3MotrKVSReaderOpState::missing) {
+    S3GCAction action = entry.decide(false, {0ULL, 0ULL});
+    if (action == S3GCAction::delete_object) {
+      delete_object();
+    } else {
+      done(action, false);
+    }
+  } else {
+    done(S3GCAction::skip, true);
+  }
+}
+
+void S3GCRecordProcessor::delete_object() {
+  s3_log(S3_LOG_INFO, "", "Deleting object with oid %" SCNx64 " : %" SCNx64
+                          "\n",
+         entry.oid.u_hi, entry.oid.u_lo);
+  motr_writer = gc->motr_writer_factory->create_motr_writer(gc->request);
+  auto self = shared_from_this();
+  motr_writer->delete_object([self]() { self->delete_object_successful(); },
+                             [self]() { self->delete_object_failed(); },
+                             entry.oid, entry.layout_id);
+}
+
+void S3GCRecordProcessor::delete_object_successful() {
+  object_deleted = true;
+  if (entry.force_delete && !entry.is_multipart &&
+      !entry.version_key_in_index.empty() &&
+      !is_zero_oid(entry.objects_version_list_idx_oid)) {
+    delete_version_entry();
+  } else if (entry.is_multipart && !is_zero_oid(entry.part_list_idx_oid)) {
+    delete_part_list_index();
+  } else {
+    delete_record();
+  }
+}
+
+void S3GCRecordProcessor::delete_object_failed() {
+  if (motr_writer->get_state() == S3MotrWiterOpState::missing) {
+    // Already deleted, proceed with the cleanup.
+    delete_object_successful();
+  } else {
+    s3_log(S3_LOG_ERROR, "", "Failed to delete object with oid %" SCNx64
+                             " : %" SCNx64 "\n",
+           entry.oid.u_hi, entry.oid.u_lo);
+    done(S3GCAction::delete_object, true);
+  }
+}
+
+void S3GCRecordProcessor::delete_version_entry() {
+  motr_kv_writer = gc->motr_kvs_writer_factory->create_motr_kvs_writer(
+      gc->request, gc->s3_motr_api);
+  auto self = shared_from_this();
+  // Missing version entry is not an error, continue in both cases.
+  motr_kv_writer->delete_keyval(entry.objects_version_list_idx_oid,
+                                entry.version_key_in_index,
+                                [self]() { self->delete_record(); },
+                                [self]() { self->delete_record(); });
+}
+
+void S3GCRecordProcessor::delete_part_list_index() {
+  motr_kv_writer = gc->motr_kvs_writer_factory->create_motr_kvs_writer(
+      gc->request, gc->s3_motr_api);
+  auto self = shared_from_this();
+  motr_kv_writer->delete_index(entry.part_list_idx_oid,
+                               [self]() { self->delete_record(); },
+                               [self]() { self->delete_record(); });
+}
+
+void S3GCRecordProcessor::delete_record() {
+  motr_kv_writer = gc->motr_kvs_writer_factory->create_motr_kvs_writer(
+      gc->request, gc->s3_motr_api);
+  auto self = shared_from_this();
+  motr_kv_writer->delete_keyval(
+      global_probable_dead_object_list_index_oid, entry.record_key,
+      [self]() { self->delete_record_successful(); },
+      [self]() {
+        self->done(self->object_deleted ? S3GCAction::delete_object
+                                        : S3GCAction::drop_record,
+                   self->motr_kv_writer->get_state() !=
+                       S3MotrKVSWriterOpState::missing);
+      });
+}
+
+void S3GCRecordProcessor::delete_record_successful() {
+  done(object_deleted ? S3GCAction::delete_object : S3GCAction::drop_record,
+       false);
+}
+
+void S3GCRecordProcessor::done(S3GCAction action, bool failed) {
+  std::chrono::duration<double, std::milli> elapsed =
+      std::chrono::steady_clock::now() - start_time;
+  gc->on_record_processed(shared_from_this(), action, failed,
+                          (size_t)elapsed.count());
+}
+
+void S3GCRecordProcessor::release() {
+  motr_kv_reader.reset();
+  motr_kv_writer.reset();
+  motr_writer.reset();
+}
+
+S3GarbageCollector::S3GarbageCollector(
+    std::shared_ptr<EventInterface> event_obj_ptr, evbase_t* evbase_,
+    std::shared_ptr<RequestObject> req,
+    std::shared_ptr<S3MotrKVSReaderFactory> kv_reader_factory,
+    std::shared_ptr<S3MotrKVSWriterFactory> kv_writer_factory,
+    std::shared_ptr<S3MotrWriterFactory> writer_factory,
+    std::shared_ptr<MotrAPI> motr_api)
+    : RecurringEventBase(std::move(event_obj_ptr), evbase_),
+      request(std::move(req)),
+      s3_motr_api(std::move(motr_api)),
+      token_bucket(S3Option::get_instance()->get_gc_max_deletes_per_sec(),
+                   std::max(1U, S3Option::get_instance()
+                                    ->get_gc_max_deletes_per_sec())),
+      batch_size(S3Option::get_instance()->get_gc_batch_size()),
+      max_inflight(S3Option::get_instance()->get_gc_max_inflight()),
+      scan_interval_sec(S3Option::get_instance()->get_gc_scan_interval_sec()),
+      min_record_age_sec(
+          S3Option::get_instance()->get_gc_min_record_age_sec()) {
+  s3_log(S3_LOG_DEBUG, "", "%s Ctor\n", __func__);
+  if (kv_reader_factory) {
+    motr_kvs_reader_factory = std::move(kv_reader_factory);
+  } else {
+    motr_kvs_reader_factory = std::make_shared<S3MotrKVSReaderFactory>();
+  }
+  if (kv_writer_factory) {
+    motr_kvs_writer_factory = std::move(kv_writer_factory);
+  } else {
+    motr_kvs_writer_factory = std::make_shared<S3MotrKVSWriterFactory>();
+  }
+  if (writer_factory) {
+    motr_writer_factory = std::move(writer_factory);
+  } else {
+    motr_writer_factory = std::make_shared<S3MotrWriterFactory>();
+  }
+}
+
+void S3GarbageCollector::action_callback(void) noexcept {
+  for (auto& processor : finished) {
+    processor->release();
+  }
+  finished.clear();
+  if (stopped) {
+    return;
+  }
+  dispatch();
+  if (pending.empty() && !scan_in_progress) {
+    // Continue current pass or start new one once scan interval is over.
+    if (!marker.empty() ||
+        (inflight == 0 &&
+         difftime(time(NULL), last_pass_end) >= scan_interval_sec)) {
+      scan_next_batch();
+    }
+  }
+}
+
+void S3GarbageCollector::scan_next_batch() {
+  s3_log(S3_LOG_DEBUG, "", "%s Entry with marker [%s]\n", __func__,
+         marker.c_str());
+  scan_in_progress = true;
+  scan_reader =
+      motr_kvs_reader_factory->create_motr_kvs_reader(request, s3_motr_api);
+  scan_reader->next_keyval(
+      global_probable_dead_object_list_index_oid, marker, batch_size,
+      std::bind(&S3GarbageCollector::scan_next_batch_successful, this),
+      std::bind(&S3GarbageCollector::scan_next_batch_failed, this));
+}
+
+void S3GarbageCollector::scan_next_batch_successful() {
+  scan_in_progress = false;
+  auto& kvps = scan_reader->get_key_values();
+  time_t now = time(NULL);
+  for (auto& kv : kvps) {
+    ++records_in_pass;
+    marker = kv.first;
+    S3GCProbableDeleteEntry entry;
+    if (!entry.from_json(kv.first, kv.second.second)) {
+      s3_stats_inc("gc_records_invalid_count");
+      continue;
+    }
+    // Young records most likely belong to requests still in progress.
+    if (difftime(now, entry.create_time) < min_record_age_sec) {
+      continue;
+    }
+    if (entry.is_multipart && !entry.force_delete) {
+      // Needs multipart index lookup, left to s3backgrounddelete.
+      s3_stats_inc("gc_records_skipped_count");
+      continue;
+    }
+    pending.push_back(std::move(entry));
+  }
+  if (kvps.size() < batch_size) {
+    end_of_pass();
+  }
+  dispatch();
+}
+
+void S3GarbageCollector::scan_next_batch_failed() {
+  scan_in_progress = false;
+  if (scan_reader->get_state() != S3MotrKVSReaderOpState::missing) {
+    s3_log(S3_LOG_ERROR, "", "Failed to list probable delete index\n");
+    s3_stats_inc("gc_failed_count");
+  }
+  end_of_pass();
+}
+
+void S3GarbageCollector::end_of_pass() {
+  backlog = records_in_pass;
+  s3_log(S3_LOG_INFO, "", "Probable delete index pass done, backlog %zu\n",
+         backlog);
+  s3_stats_set_gauge("gc_probable_delete_backlog", (int)backlog);
+  records_in_pass = 0;
+  marker.clear();
+  last_pass_end = time(NULL);
+}
+
+void S3GarbageCollector::dispatch() {
+  // Processing may complete synchronously (e.g. failed to launch), avoid
+  // recursion in that case.
+  if (dispatching) {
+    return;
+  }
+  dispatching = true;
+  while (!stopped && !pending.empty() && inflight < max_inflight &&
+         token_bucket.try_consume()) {
+    auto processor =
+        std::make_shared<S3GCRecordProcessor>(this, std::move(pending.front()));
+    pending.pop_front();
+    ++inflight;
+    processor->run();
+  }
+  dispatching = false;
+}
+
+void S3GarbageCollector::on_record_processed(
+    std::shared_ptr<S3GCRecordProcessor> processor, S3GCAction action,
+    bool failed, size_t elapsed_ms) {
+  assert(inflight > 0);
+  --inflight;
+  finished.push_back(std::move(processor));
+  if (failed) {
+    s3_stats_inc("gc_failed_count");
+  } else if (action == S3GCAction::delete_object) {
+    s3_stats_inc("gc_objects_deleted_count");
+  } else if (action == S3GCAction::drop_record) {
+    s3_stats_inc("gc_records_dropped_count");
+  } else {
+    s3_stats_inc("gc_records_skipped_count");
+  }
+  s3_stats_timing("gc_record_processing_time", elapsed_ms);
+  dispatch();
+}
+
+static std::shared_ptr<S3GarbageCollector> gs_garbage_collector;
+
+int s3_gc_init(evbase_t* evbase) {
+  struct timeval tv;
+  if (!g_option_instance->is_gc_enabled()) {
+    return 0;
+  }
+  s3_log(S3_LOG_INFO, "", "%s Entry", __func__);
+
+  AtExit call_fini([]() { s3_gc_fini(); });
+
+  if (!evbase) {
+    return -EINVAL;
+  }
+  // Light weight request object used as a carrier for async motr operations.
+  std::shared_ptr<RequestObject> req = std::make_shared<MotrRequestObject>(
+      nullptr, new EvhtpWrapper(), nullptr, new EventWrapper());
+  gs_garbage_collector.reset(
+      new S3GarbageCollector(std::make_shared<EventWrapper>(), evbase, req));
+  if (!gs_garbage_collector) {
+    return -ENOMEM;
+  }
+  tv.tv_sec = 0;
+  tv.tv_usec = S3_GC_TICK_INTERVAL_MSEC * 1000;
+  int rc = gs_garbage_collector->add_evtimer(tv);
+  if (rc != 0) {
+    return rc;
+  }
+
+  call_fini.cancel();
+
+  return 0;
+}
+
+void s3_gc_fini() {
+  if (!gs_garbage_collector) {
+    return;
+  }
+  s3_log(S3_LOG_INFO, "", "%s Entry", __func__);
+  gs_garbage_collector->stop();
+
+  // Scan and record processors call back into the collector, let their motr
+  // operations complete while motr is still up. The collector tick keeps
+  // the loop waking up, so the deadline is checked at least every tick.
+  const auto deadline = std::chrono::steady_clock::now() +
+                        std::chrono::seconds(S3_GC_DRAIN_TIMEOUT_SEC);
+  while (!gs_garbage_collector->is_idle() && global_evbase_handle &&
+         std::chrono::steady_clock::now() < deadline) {
+    event_base_loop(global_evbase_handle, EVLOOP_ONCE);
+  }
+  if (!gs_garbage_collector->is_idle()) {
+    // Event loop is not run anymore, their callbacks are never called.
+    s3_log(S3_LOG_ERROR, "",
+           "Garbage collector operations did not complete in %d sec\n",
+           S3_GC_DRAIN_TIMEOUT_SEC);
+  }
+  gs_garbage_collector->del_evtimer();
+  gs_garbage_collector.reset();
+}
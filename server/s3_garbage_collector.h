@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+#pragma once
+
+#ifndef __S3_SERVER_S3_GARBAGE_COLLECTOR_H__
+#define __S3_SERVER_S3_GARBAGE_COLLECTOR_H__
+
+#include <gtest/gtest_prod.h>
+#include <time.h>
+
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "event_utils.h"
+#include "s3_factory.h"
+#include "s3_motr_rw_common.h"
+
+// Native garbage collector for the global probable delete records list index.
+//
+// When enabled (S3_GC_ENABLE), s3server scans the probable delete index in
+// batches, validates every record against the object metadata stored in the
+// bucket object list index and deletes leaked motr objects without going
+// through the HTTP based s3backgrounddelete producer/consumer.
+//
+// The collector only acts on records whose fate is unambiguous (see
+// S3GCProbableDeleteEntry::decide), everything else is left in the index so
+// that s3backgrounddelete, which can check instance liveness and version
+// entries, still handles it.
+
+// Simple token bucket used to cap the number of records (and so motr delete
+// operations) processed per second.
+class S3GCTokenBucket {
+  double rate;
+  double burst;
+  double tokens;
+  std::chrono::steady_clock::time_point last_refill;
+
+ public:
+  S3GCTokenBucket(double rate_per_sec, double burst_size,
+                  std::chrono::steady_clock::time_point now =
+                      std::chrono::steady_clock::now());
+
+  void refill(std::chrono::steady_clock::time_point now);
+  // Returns true and consumes 'count' tokens if enough are available.
+  bool try_consume(double count = 1.0,
+                   std::chrono::steady_clock::time_point now =
+                       std::chrono::steady_clock::now());
+  double get_available_tokens() const { return tokens; }
+};
+
+enum class S3GCAction {
+  skip,           // Leave record for later/for s3backgrounddelete
+  drop_record,    // Object is live, only remove probable delete record
+  delete_object,  // Delete motr object (and indexes), then remove record
+};
+
+// Parsed value of a probable delete record, see S3ProbableDeleteRecord.
+struct S3GCProbableDeleteEntry {
+  std::string record_key;
+  // OID of the object which is candidate for deletion, taken from record key.
+  struct m0_uint128 oid = {0ULL, 0ULL};
+  // Non-zero only for the record of a new object which replaces old one.
+  struct m0_uint128 old_oid = {0ULL, 0ULL};
+  // Set from the shape of the record key, see is_old_object_record().
+  bool old_object_record = false;
+  int layout_id = 0;
+  std::string object_key_in_index;
+  struct m0_uint128 object_list_idx_oid = {0ULL, 0ULL};
+  struct m0_uint128 objects_version_list_idx_oid = {0ULL, 0ULL};
+  std::string version_key_in_index;
+  bool force_delete = false;
+  bool is_multipart = false;
+  struct m0_uint128 part_list_idx_oid = {0ULL, 0ULL};
+  time_t create_time = 0;
+
+  // Record for old object is keyed as "<old oid>-<new oid>", record for new
+  // object as "<new oid>".  old_oid cannot tell them apart, it is zero in
+  // both the old object record and the new object record of a fresh PUT.
+  bool is_old_object_record() const;
+
+  // Returns false if record could not be parsed.
+  bool from_json(const std::string& key, const std::string& json);
+
+  // Decides what to do with the record.
+  // 'object_present' - whether object_key_in_index is present in object list
+  // index, 'current_oid' - motr_oid from its S3ObjectMetadata.
+  S3GCAction decide(bool object_present,
+                    const struct m0_uint128& current_oid) const;
+};
+
+class S3GarbageCollector;
+
+// Processes a single probable delete record.
+class S3GCRecordProcessor
+    : public std::enable_shared_from_this<S3GCRecordProcessor> {
+  S3GarbageCollector* gc;
+  S3GCProbableDeleteEntry entry;
+  std::shared_ptr<S3MotrKVSReader> motr_kv_reader;
+  std::shared_ptr<S3MotrKVSWriter> motr_kv_writer;
+  std::shared_ptr<S3MotrWiter> motr_writer;
+  std::chrono::steady_clock::time_point start_time;
+  bool object_deleted = false;
+
+  void get_object_metadata();
+  void get_object_metadata_successful();
+  void get_object_metadata_failed();
+  void delete_object();
+  void delete_object_successful();
+  void delete_object_failed();
+  void delete_version_entry();
+  void delete_part_list_index();
+  void delete_record();
+  void delete_record_successful();
+  void done(S3GCAction action, bool failed);
+
+ public:
+  S3GCRecordProcessor(S3GarbageCollector* collector,
+                      S3GCProbableDeleteEntry rec);
+  void run();
+  // Drops motr readers/writers, which hold callbacks referencing this object.
+  void release();
+};
+
+class S3GarbageCollector : public RecurringEventBase {
+  std::shared_ptr<RequestObject> request;
+  std::shared_ptr<S3MotrKVSReaderFactory> motr_kvs_reader_factory;
+  std::shared_ptr<S3MotrKVSWriterFactory> motr_kvs_writer_factory;
+  std::shared_ptr<S3MotrWriterFactory> motr_writer_factory;
+  std::shared_ptr<MotrAPI> s3_motr_api;
+  std::shared_ptr<S3MotrKVSReader> scan_reader;
+
+  S3GCTokenBucket token_bucket;
+  size_t batch_size;
+  size_t max_inflight;
+  unsigned scan_interval_sec;
+  unsigned min_record_age_sec;
+
+  std::deque<S3GCProbableDeleteEntry> pending;
+  // Processors which are done, released on next tick (outside of the motr
+  // callback stack).
+  std::vector<std::shared_ptr<S3GCRecordProcessor>> finished;
+  size_t inflight = 0;
+  bool scan_in_progress = false;
+  bool dispatching = false;
+  bool stopped = false;
+  // Last key returned by the scan, empty when pass is complete.
+  std::string marker;
+  time_t last_pass_end = 0;
+  // Number of records seen in the current/last completed pass.
+  size_t records_in_pass = 0;
+  size_t backlog = 0;
+
+  void scan_next_batch();
+  void scan_next_batch_successful();
+  void scan_next_batch_failed();
+  void end_of_pass();
+  void dispatch();
+
+ public:
+  S3GarbageCollector(
+      std::shared_ptr<EventInterface> event_obj_ptr, evbase_t* evbase_,
+      std::shared_ptr<RequestObject> req,
+      std::shared_ptr<S3MotrKVSReaderFactory> kv_reader_factory = nullptr,
+      std::shared_ptr<S3MotrKVSWriterFactory> kv_writer_factory = nullptr,
+      std::shared_ptr<S3MotrWriterFactory> writer_factory = nullptr,
+      std::shared_ptr<MotrAPI> motr_api = nullptr);
+
+  virtual void action_callback(void) noexcept;
+
+  void stop() { stopped = true; }
+  // True when no scan or record processing is waiting for motr.
+  bool is_idle() const { return inflight == 0 && !scan_in_progress; }
+  size_t get_backlog() const { return backlog; }
+
+  // Called by S3GCRecordProcessor once the record is processed.
+  void on_record_processed(std::shared_ptr<S3GCRecordProcessor> processor,
+                           S3GCAction action, bool failed, size_t elapsed_ms);
+
+  friend class S3GCRecordProcessor;
+
+  FRIEND_TEST(S3GarbageCollectorTest, ScanQueuesOnlyOldRecords);
+  FRIEND_TEST(S3GarbageCollectorTest, DispatchHonoursMaxInflight);
+};
+
+int s3_gc_init(evbase_t* evbase);
+// Stops the collector and waits (running the event loop) for its motr
+// operations, must be called before motr teardown.
+void s3_gc_fini();
+
+#endif
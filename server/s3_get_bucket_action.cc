@@ -158,6 +158,11 @@ void S3GetBucketAction::get_next_objects() {
   if (motr_kv_reader == nullptr) {
     motr_kv_reader = s3_motr_kvs_reader_factory->create_motr_kvs_reader(
         request, s3_motr_api);
+    // Render each accepted key right away instead of holding its metadata
+    // until the response.
+    object_list->render_contents_on_add(request->get_canonical_id(),
+                                        bucket_metadata->get_owner_id(),
+                                        request->get_user_id());
   }
 
   if (motr_kv_reader->get_state() == S3MotrKVSReaderOpState::failed_e2big) {
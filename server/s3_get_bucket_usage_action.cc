@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#include <errno.h>
+#include <json/json.h>
+
+#include "s3_error_codes.h"
+#include "s3_get_bucket_usage_action.h"
+#include "s3_log.h"
+
+S3GetBucketUsageAction::S3GetBucketUsageAction(
+    std::shared_ptr<S3RequestObject> req,
+    std::shared_ptr<S3BucketMetadataFactory> bucket_meta_factory)
+    : S3Action(req, true, nullptr, false, true) {
+  s3_log(S3_LOG_DEBUG, request_id, "%s Ctor\n", __func__);
+
+  if (bucket_meta_factory) {
+    bucket_metadata_factory = std::move(bucket_meta_factory);
+  } else {
+    bucket_metadata_factory = std::make_shared<S3BucketMetadataFactory>();
+  }
+  setup_steps();
+}
+
+void S3GetBucketUsageAction::setup_steps() {
+  s3_log(S3_LOG_DEBUG, request_id, "Setting up the action\n");
+  ACTION_TASK_ADD(S3GetBucketUsageAction::validate_request, this);
+  ACTION_TASK_ADD(S3GetBucketUsageAction::fetch_bucket_info, this);
+  ACTION_TASK_ADD(S3GetBucketUsageAction::get_bucket_usage, this);
+  ACTION_TASK_ADD(S3GetBucketUsageAction::send_response_to_s3_client, this);
+  // ...
+}
+
+void S3GetBucketUsageAction::validate_request() {
+  s3_log(S3_LOG_DEBUG, request_id, "%s Entry\n", __func__);
+  // Polling by dashboards is not worth auditing.
+  request->get_audit_info().set_publish_flag(false);
+
+  bucket_name = request->get_query_string_value("bucket");
+  if (bucket_name.empty()) {
+    s3_log(S3_LOG_DEBUG, request_id, "bucket parameter is missing\n");
+    set_s3_error("InvalidArgument");
+    send_response_to_s3_client();
+  } else if (!s3_bucket_usage()) {
+    s3_log(S3_LOG_DEBUG, request_id, "Bucket usage is disabled\n");
+    set_s3_error("NotImplemented");
+    send_response_to_s3_client();
+  } else {
+    next();
+  }
+}
+
+void S3GetBucketUsageAction::fetch_bucket_info() {
+  s3_log(S3_LOG_DEBUG, request_id, "%s Entry\n", __func__);
+  bucket_metadata = bucket_metadata_factory->create_bucket_metadata_obj(
+      request, bucket_name);
+  bucket_metadata->load(
+      std::bind(&S3GetBucketUsageAction::fetch_bucket_info_successful, this),
+      std::bind(&S3GetBucketUsageAction::fetch_bucket_info_failed, this));
+}
+
+void S3GetBucketUsageAction::fetch_bucket_info_successful() {
+  s3_log(S3_LOG_DEBUG, request_id, "%s Entry\n", __func__);
+  if (is_bucket_usage_allowed()) {
+    next();
+  } else {
+    s3_log(S3_LOG_INFO, request_id,
+           "User %s is not allowed to get usage of bucket %s\n",
+           request->get_user_name().c_str(), bucket_name.c_str());
+    set_s3_error("AccessDenied");
+    send_response_to_s3_client();
+  }
+}
+
+bool S3GetBucketUsageAction::is_bucket_usage_allowed() {
+  if (is_mgmt_api_admin()) {
+    return true;
+  }
+  // Account id is set by the authentication step.
+  const std::string& account_id = request->get_account_id();
+  return is_authorizationheader_present && !account_id.empty() &&
+         account_id == bucket_metadata->get_bucket_owner_account_id();
+}
+
+void S3GetBucketUsageAction::fetch_bucket_info_failed() {
+  s3_log(S3_LOG_DEBUG, request_id, "%s Entry\n", __func__);
+  if (bucket_metadata->get_state() == S3BucketMetadataState::missing) {
+    set_s3_error("NoSuchBucket");
+  } else if (bucket_metadata->get_state() ==
+             S3BucketMetadataState::failed_to_launch) {
+    set_s3_error("ServiceUnavailable");
+  } else {
+    set_s3_error("InternalError");
+  }
+  send_response_to_s3_client();
+}
+
+void S3GetBucketUsageAction::get_bucket_usage() {
+  s3_log(S3_LOG_DEBUG, request_id, "%s Entry\n", __func__);
+  std::shared_ptr<S3BucketUsage> bucket_usage = s3_bucket_usage();
+  if (!bucket_usage) {
+    // Disabled meanwhile, i.e. shutting down.
+    set_s3_error("ServiceUnavailable");
+    send_response_to_s3_client();
+    return;
+  }
+  bucket_usage->get_usage(
+      S3BucketUsage::get_bucket_key(
+          bucket_metadata->get_object_list_index_oid()),
+      std::bind(&S3GetBucketUsageAction::get_bucket_usage_done, this,
+                std::placeholders::_1, std::placeholders::_2));
+}
+
+void S3GetBucketUsageAction::get_bucket_usage_done(
+    int rc, const S3BucketUsageCounters& counters) {
+  if (rc == 0) {
+    usage = counters;
+    next();
+    return;
+  }
+  set_s3_error(rc == -EAGAIN ? "ServiceUnavailable" : "InternalError");
+  send_response_to_s3_client();
+}
+
+std::string S3GetBucketUsageAction::to_json(
+    const std::string& bucket_name, const S3BucketUsageCounters& counters) {
+  Json::Value root;
+  root["bucket"] = bucket_name;
+  root["objects_count"] = (Json::Int64)counters.objects_count;
+  root["bytes_used"] = (Json::Int64)counters.bytes_used;
+  Json::FastWriter fast_writer;
+  return fast_writer.write(root);
+}
+
+void S3GetBucketUsageAction::send_response_to_s3_client() {
+  s3_log(S3_LOG_DEBUG, request_id, "%s Entry\n", __func__);
+
+  if (reject_if_shutting_down() ||
+      (is_error_state() && !get_s3_error_code().empty())) {
+    const char* full_path_uri = request->c_get_full_path();
+    S3Error error(get_s3_error_code(), request->get_request_id(),
+                  full_path_uri ? full_path_uri : "");
+    std::string& response_xml = error.to_xml();
+    request->set_out_header_value("Content-Type", "application/xml");
+    request->set_out_header_value("Content-Length",
+                                  std::to_string(response_xml.length()));
+    if (get_s3_error_code() == "ServiceUnavailable") {
+      request->set_out_header_value("Connection", "close");
+      request->set_out_header_value("Retry-After", "1");
+    }
+    request->send_response(error.get_http_status_code(), response_xml);
+  } else {
+    std::string response = to_json(bucket_name, usage);
+    request->set_out_header_value("Content-Type", "application/json");
+    request->set_out_header_value("Content-Length",
+                                  std::to_string(response.length()));
+    request->send_response(S3HttpSuccess200, response);
+  }
+  S3_RESET_SHUTDOWN_SIGNAL;  // for shutdown testcases
+  done();
+  s3_log(S3_LOG_DEBUG, "", "%s Exit", __func__);
+}
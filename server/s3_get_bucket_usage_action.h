@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#pragma once
+
+#ifndef __S3_SERVER_S3_GET_BUCKET_USAGE_ACTION_H__
+#define __S3_SERVER_S3_GET_BUCKET_USAGE_ACTION_H__
+
+#include <gtest/gtest_prod.h>
+
+#include <memory>
+#include <string>
+
+#include "s3_action_base.h"
+#include "s3_bucket_usage.h"
+#include "s3_factory.h"
+
+// Returns object count and bytes used of the bucket given by query parameter
+// "bucket" as JSON, see S3BucketUsage.  Allowed for the account which owns
+// the bucket and for the root user of S3_MGMT_API_ADMIN_ACCOUNT_ID account,
+// see S3Action::is_mgmt_api_admin().
+class S3GetBucketUsageAction : public S3Action {
+  std::shared_ptr<S3BucketMetadataFactory> bucket_metadata_factory;
+  std::shared_ptr<S3BucketMetadata> bucket_metadata;
+  std::string bucket_name;
+  S3BucketUsageCounters usage;
+
+ public:
+  S3GetBucketUsageAction(
+      std::shared_ptr<S3RequestObject> req,
+      std::shared_ptr<S3BucketMetadataFactory> bucket_meta_factory = nullptr);
+  void setup_steps();
+
+  void validate_request();
+  void fetch_bucket_info();
+  void fetch_bucket_info_successful();
+  void fetch_bucket_info_failed();
+  bool is_bucket_usage_allowed();
+  void get_bucket_usage();
+  void get_bucket_usage_done(int rc, const S3BucketUsageCounters& counters);
+  void send_response_to_s3_client();
+
+  static std::string to_json(const std::string& bucket_name,
+                             const S3BucketUsageCounters& counters);
+
+  FRIEND_TEST(S3GetBucketUsageActionTest, MissingBucketParameter);
+  FRIEND_TEST(S3GetBucketUsageActionTest, FetchBucketInfoMissing);
+  FRIEND_TEST(S3GetBucketUsageActionTest, SendResponse);
+  FRIEND_TEST(S3GetBucketUsageActionTest, AccessDeniedForOtherAccount);
+  FRIEND_TEST(S3GetBucketUsageActionTest, AccessDeniedForOtherAccountRoot);
+  FRIEND_TEST(S3GetBucketUsageActionTest, AllowedForAdminAccountRoot);
+};
+
+#endif
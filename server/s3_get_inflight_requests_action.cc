@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+#include "s3_common_utilities.h"
+#include "s3_error_codes.h"
+#include "s3_get_inflight_requests_action.h"
+#include "s3_log.h"
+#include "s3_request_registry.h"
+
+#define S3_INFLIGHT_REQUESTS_DEFAULT_LIMIT 100
+
+S3GetInFlightRequestsAction::S3GetInFlightRequestsAction(
+    std::shared_ptr<S3RequestObject> req)
+    : S3Action(req, true, nullptr, false, true) {
+  s3_log(S3_LOG_DEBUG, request_id, "%s Ctor\n", __func__);
+
+  setup_steps();
+}
+
+void S3GetInFlightRequestsAction::setup_steps() {
+  s3_log(S3_LOG_DEBUG, request_id, "Setting up the action\n");
+  ACTION_TASK_ADD(S3GetInFlightRequestsAction::send_response_to_s3_client,
+                  this);
+  // ...
+}
+
+void S3GetInFlightRequestsAction::send_error_response(
+    const std::string& error_code) {
+  const char* full_path_uri = request->c_get_full_path();
+  S3Error error(error_code, request->get_request_id(),
+                full_path_uri ? full_path_uri : "");
+  std::string& response_xml = error.to_xml();
+  request->set_out_header_value("Content-Type", "application/xml");
+  request->set_out_header_value("Content-Length",
+                                std::to_string(response_xml.length()));
+  if (error_code == "ServiceUnavailable") {
+    request->set_out_header_value("Connection", "close");
+    request->set_out_header_value("Retry-After", "1");
+  }
+  request->send_response(error.get_http_status_code(), response_xml);
+}
+
+void S3GetInFlightRequestsAction::send_response_to_s3_client() {
+  s3_log(S3_LOG_DEBUG, request_id, "%s Entry\n", __func__);
+
+  // Polling during incidents is not worth auditing.
+  request->get_audit_info().set_publish_flag(false);
+
+  std::shared_ptr<S3RequestRegistry> registry = s3_request_registry();
+  unsigned long limit = S3_INFLIGHT_REQUESTS_DEFAULT_LIMIT;
+  std::string limit_str = request->get_query_string_value("limit");
+
+  if (reject_if_shutting_down()) {
+    send_error_response("ServiceUnavailable");
+  } else if (!is_mgmt_api_admin()) {
+    s3_log(S3_LOG_INFO, request_id, "User %s is not allowed to list requests\n",
+           request->get_user_name().c_str());
+    send_error_response("AccessDenied");
+  } else if (!limit_str.empty() &&
+             !S3CommonUtilities::stoul(limit_str, limit)) {
+    s3_log(S3_LOG_DEBUG, request_id, "invalid limit = %s\n",
+           limit_str.c_str());
+    send_error_response("InvalidArgument");
+  } else if (!registry) {
+    s3_log(S3_LOG_DEBUG, request_id, "Request registry is disabled\n");
+    send_error_response("NotImplemented");
+  } else {
+    std::string response = S3RequestRegistry::to_json(
+        registry->get_slowest(limit), registry->get_count());
+    request->set_out_header_value("Content-Type", "application/json");
+    request->set_out_header_value("Content-Length",
+                                  std::to_string(response.length()));
+    request->send_response(S3HttpSuccess200, response);
+  }
+  S3_RESET_SHUTDOWN_SIGNAL;  // for shutdown testcases
+  done();
+  s3_log(S3_LOG_DEBUG, "", "%s Exit", __func__);
+}
@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+#pragma once
+
+#ifndef __S3_SERVER_S3_GET_METRICS_ACTION_H__
+#define __S3_SERVER_S3_GET_METRICS_ACTION_H__
+
+#include <gtest/gtest_prod.h>
+
+#include <memory>
+#include <string>
+
+#include "s3_action_base.h"
+
+#define S3_METRICS_PATH "/metrics"
+
+// Serves in-process metrics (see S3Metrics) as OpenMetrics text, so it can be
+// scraped by Prometheus. Metrics cover requests of all accounts, so allowed
+// only for the root user of S3_MGMT_API_ADMIN_ACCOUNT_ID account, see
+// S3Action::is_mgmt_api_admin().
+class S3GetMetricsAction : public S3Action {
+ public:
+  S3GetMetricsAction(std::shared_ptr<S3RequestObject> req);
+  void setup_steps();
+
+  void send_response_to_s3_client();
+
+ private:
+  void send_error_response(const std::string& error_code);
+
+  FRIEND_TEST(S3GetMetricsActionTest, AccessDeniedForOtherAccountRoot);
+  FRIEND_TEST(S3GetMetricsActionTest, AllowedForAdminAccountRoot);
+};
+
+#endif
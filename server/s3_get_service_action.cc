@@ -19,8 +19,8 @@
  */
 
 #include <string>
+#include <utility>
 
-#include "s3_bucket_metadata.h"
 #include "s3_error_codes.h"
 #include "s3_get_service_action.h"
 #include "s3_iem.h"
@@ -28,23 +28,23 @@
 #include "s3_option.h"
 
 extern struct m0_uint128 bucket_metadata_list_index_oid;
-#define BUCKET_KVS_FETCH_COUNT 12
 
 S3GetServiceAction::S3GetServiceAction(
     std::shared_ptr<S3RequestObject> req,
     std::shared_ptr<S3MotrKVSReaderFactory> motr_kvs_reader_factory,
-    std::shared_ptr<S3BucketMetadataFactory> bucket_meta_factory)
-    : S3Action(req), last_key(""), key_prefix(""), fetch_successful(false) {
+    S3BucketListCache* bucket_list_cache_)
+    : S3Action(req),
+      last_key(""),
+      key_prefix(""),
+      fetch_successful(false),
+      bucket_list_cache(bucket_list_cache_),
+      bucket_list_cache_token(0),
+      atleast_one_json_error(false) {
   s3_log(S3_LOG_DEBUG, request_id, "%s Ctor\n", __func__);
   s3_motr_api = std::make_shared<ConcreteMotrAPI>();
 
   s3_log(S3_LOG_INFO, stripped_request_id, "S3 API: Get Service.\n");
 
-  if (bucket_meta_factory) {
-    bucket_metadata_factory = bucket_meta_factory;
-  } else {
-    bucket_metadata_factory = std::make_shared<S3BucketMetadataFactory>();
-  }
   if (motr_kvs_reader_factory) {
     s3_motr_kvs_reader_factory = motr_kvs_reader_factory;
   } else {
@@ -74,6 +74,20 @@ void S3GetServiceAction::initialization() {
     bucket_list.set_owner_id(request->get_user_id());
     // to filter keys
     key_prefix = get_search_bucket_prefix();
+    if (bucket_list_cache) {
+      const std::vector<S3BucketListEntry>* cached_buckets =
+          bucket_list_cache->find(request->get_account_id());
+      if (cached_buckets) {
+        s3_log(S3_LOG_DEBUG, request_id, "Bucket list is cached\n");
+        for (const auto& bucket : *cached_buckets) {
+          bucket_list.add_bucket(bucket.name, bucket.creation_date);
+        }
+        fetch_successful = true;
+        send_response_to_s3_client();
+        return;
+      }
+      bucket_list_cache_token = bucket_list_cache->begin_load();
+    }
     // fetch the keys having account id as a prefix
     last_key = key_prefix;
     next();
@@ -90,7 +104,7 @@ void S3GetServiceAction::get_next_buckets() {
   }
 
   s3_log(S3_LOG_DEBUG, request_id, "Fetching bucket list from KV store\n");
-  size_t count = BUCKET_KVS_FETCH_COUNT;
+  size_t count = S3Option::get_instance()->get_motr_idx_fetch_count();
 
   motr_kv_reader =
       s3_motr_kvs_reader_factory->create_motr_kvs_reader(request, s3_motr_api);
@@ -112,17 +126,18 @@ void S3GetServiceAction::get_next_buckets_successful() {
   }
   s3_log(S3_LOG_DEBUG, request_id, "Found buckets listing\n");
   auto& kvps = motr_kv_reader->get_key_values();
-  size_t length = kvps.size();
-  bool atleast_one_json_error = false;
   bool retrived_all_keys = false;
+  S3BucketListEntry bucket;
   for (auto& kv : kvps) {
     // process the only keys which is having requested accountid as prefix
-    if (kv.first.find(key_prefix) == std::string::npos) {
+    if (kv.first.compare(0, key_prefix.length(), key_prefix) != 0) {
       retrived_all_keys = true;
       break;
     }
-    auto bucket = bucket_metadata_factory->create_bucket_metadata_obj(request);
-    if (bucket->from_json(kv.second.second) != 0) {
+    // Only name and creation date are needed, full bucket metadata is not
+    // parsed.
+    if (!s3_bucket_list_entry_from_json(kv.second.second, bucket) ||
+        s3_fi_is_enabled("bucket_metadata_corrupted")) {
       atleast_one_json_error = true;
       s3_log(S3_LOG_ERROR, request_id,
              "Json Parsing failed. Index oid = "
@@ -130,20 +145,24 @@ void S3GetServiceAction::get_next_buckets_successful() {
              bucket_list_index_oid.u_hi, bucket_list_index_oid.u_lo,
              kv.first.c_str(), kv.second.second.c_str());
     } else {
-      bucket_list.add_bucket(bucket);
-    }
-    if (--length == 0) {
-      // this is the last element returned.
-      last_key = kv.first;
+      bucket_list.add_bucket(bucket.name, bucket.creation_date);
+      if (bucket_list_cache) {
+        loaded_buckets.push_back(std::move(bucket));
+      }
     }
   }
-  if (atleast_one_json_error) {
-    s3_iem(LOG_ERR, S3_IEM_METADATA_CORRUPTED, S3_IEM_METADATA_CORRUPTED_STR,
-           S3_IEM_METADATA_CORRUPTED_JSON);
+  if (!kvps.empty()) {
+    last_key = kvps.rbegin()->first;
   }
   // We ask for more if there is any.
-  size_t count_we_requested = BUCKET_KVS_FETCH_COUNT;
+  size_t count_we_requested =
+      S3Option::get_instance()->get_motr_idx_fetch_count();
   if ((kvps.size() < count_we_requested) || retrived_all_keys) {
+    if (atleast_one_json_error) {
+      s3_iem(LOG_ERR, S3_IEM_METADATA_CORRUPTED, S3_IEM_METADATA_CORRUPTED_STR,
+             S3_IEM_METADATA_CORRUPTED_JSON);
+    }
+    cache_loaded_buckets();
     // Go ahead and respond.
     fetch_successful = true;
     send_response_to_s3_client();
@@ -152,10 +171,19 @@ void S3GetServiceAction::get_next_buckets_successful() {
   }
 }
 
+void S3GetServiceAction::cache_loaded_buckets() {
+  // Corrupted entries are not cached, so that they are reported again.
+  if (bucket_list_cache && !atleast_one_json_error) {
+    bucket_list_cache->add(request->get_account_id(), bucket_list_cache_token,
+                           std::move(loaded_buckets));
+  }
+}
+
 void S3GetServiceAction::get_next_buckets_failed() {
   s3_log(S3_LOG_INFO, stripped_request_id, "%s Entry\n", __func__);
   if (motr_kv_reader->get_state() == S3MotrKVSReaderOpState::missing) {
     s3_log(S3_LOG_DEBUG, request_id, "Buckets list is empty\n");
+    cache_loaded_buckets();
     fetch_successful = true;  // With no entries.
   } else if (motr_kv_reader->get_state() ==
              S3MotrKVSReaderOpState::failed_to_launch) {
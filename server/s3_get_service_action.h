@@ -24,8 +24,10 @@
 #define __S3_SERVER_S3_GET_SERVICE_ACTION_H__
 
 #include <memory>
+#include <vector>
 
 #include "s3_action_base.h"
+#include "s3_bucket_list_cache.h"
 #include "s3_motr_kvs_reader.h"
 #include "s3_service_list_response.h"
 
@@ -36,9 +38,14 @@ class S3GetServiceAction : public S3Action {
   std::string last_key;  // last key during each iteration
   std::string key_prefix;  // holds account id
   S3ServiceListResponse bucket_list;
-  std::shared_ptr<S3BucketMetadataFactory> bucket_metadata_factory;
   bool fetch_successful;
   std::shared_ptr<S3MotrKVSReaderFactory> s3_motr_kvs_reader_factory;
+  // Cache is not used if nullptr.
+  S3BucketListCache* bucket_list_cache;
+  uint64_t bucket_list_cache_token;
+  // Buckets read from the index so far, to be cached when all are read.
+  std::vector<S3BucketListEntry> loaded_buckets;
+  bool atleast_one_json_error;
 
   std::string get_search_bucket_prefix() {
     return request->get_account_id() + "/";
@@ -48,13 +55,14 @@ class S3GetServiceAction : public S3Action {
   S3GetServiceAction(
       std::shared_ptr<S3RequestObject> req,
       std::shared_ptr<S3MotrKVSReaderFactory> motr_kvs_reader_factory = nullptr,
-      std::shared_ptr<S3BucketMetadataFactory> bucket_metadata_factory =
-          nullptr);
+      S3BucketListCache* bucket_list_cache = S3BucketListCache::get_instance());
   void setup_steps();
   void initialization();
   void get_next_buckets();
   void get_next_buckets_successful();
   void get_next_buckets_failed();
+  // Caches the buckets read from the index, when all are read fine.
+  void cache_loaded_buckets();
 
   void send_response_to_s3_client();
   FRIEND_TEST(S3GetServiceActionTest, ConstructorTest);
@@ -63,6 +71,11 @@ class S3GetServiceAction : public S3Action {
   FRIEND_TEST(S3GetServiceActionTest,
               GetNextBucketDoesNotCallsGetBucketListIndexIfMetadataFailed);
   FRIEND_TEST(S3GetServiceActionTest, GetNextBucketSuccessful);
+  FRIEND_TEST(S3GetServiceActionTest, GetNextBucketSkipsCorruptedMetadata);
+  FRIEND_TEST(S3GetServiceActionTest, GetNextBucketFetchesNextPage);
+  FRIEND_TEST(S3GetServiceActionTest, InitializationServesCachedBuckets);
+  FRIEND_TEST(S3GetServiceActionTest, GetNextBucketSuccessfulFillsCache);
+  FRIEND_TEST(S3GetServiceActionTest, LoadedBucketsAreNotCachedIfInvalidated);
   FRIEND_TEST(S3GetServiceActionTest,
               GetNextBucketFailedMotrReaderStateMissing);
   FRIEND_TEST(S3GetServiceActionTest,
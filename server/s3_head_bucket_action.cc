@@ -19,6 +19,7 @@
  */
 
 #include "s3_head_bucket_action.h"
+#include "s3_bucket_usage.h"
 #include "s3_error_codes.h"
 #include "s3_log.h"
 
@@ -36,6 +37,9 @@ S3HeadBucketAction::S3HeadBucketAction(
 
 void S3HeadBucketAction::setup_steps() {
   s3_log(S3_LOG_DEBUG, request_id, "Setting up the action\n");
+  if (s3_bucket_usage()) {
+    ACTION_TASK_ADD(S3HeadBucketAction::get_bucket_usage, this);
+  }
   ACTION_TASK_ADD(S3HeadBucketAction::send_response_to_s3_client, this);
   // ...
 }
@@ -56,6 +60,31 @@ void S3HeadBucketAction::fetch_bucket_info_failed() {
   next();
 }
 
+// Records of the bucket are listed at most once a flush interval, see
+// S3BucketUsage::get_usage().
+void S3HeadBucketAction::get_bucket_usage() {
+  std::shared_ptr<S3BucketUsage> usage = s3_bucket_usage();
+  if (!usage || is_error_state()) {
+    next();
+    return;
+  }
+  s3_log(S3_LOG_INFO, stripped_request_id, "%s Entry\n", __func__);
+  usage->get_usage(
+      S3BucketUsage::get_bucket_key(
+          bucket_metadata->get_object_list_index_oid()),
+      [this](int rc, const S3BucketUsageCounters& counters) {
+        // Usage is informational, the bucket exists either way.
+        if (rc == 0) {
+          request->set_out_header_value(
+              "x-seagate-bucket-object-count",
+              std::to_string(counters.objects_count));
+          request->set_out_header_value("x-seagate-bucket-bytes-used",
+                                        std::to_string(counters.bytes_used));
+        }
+        next();
+      });
+}
+
 void S3HeadBucketAction::send_response_to_s3_client() {
   s3_log(S3_LOG_INFO, stripped_request_id, "%s Entry\n", __func__);
   if (reject_if_shutting_down() ||
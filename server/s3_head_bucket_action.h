@@ -36,6 +36,7 @@ class S3HeadBucketAction : public S3BucketAction {
 
   void setup_steps();
   void fetch_bucket_info_failed();
+  void get_bucket_usage();
   void send_response_to_s3_client();
 
   // For Testing purpose
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#include <ctype.h>
+#include <strings.h>
+
+#include "s3_header_index.h"
+
+static const char* const known_header_names[(size_t)S3Header::count] = {
+    "Authorization",                 // authorization
+    "Content-Length",                // content_length
+    "Content-MD5",                   // content_md5
+    "Content-Type",                  // content_type
+    "Host",                          // host
+    "Range",                         // range
+    "User-Agent",                    // user_agent
+    "x-amz-content-sha256",          // x_amz_content_sha256
+    "x-amz-copy-source",             // x_amz_copy_source
+    "x-amz-date",                    // x_amz_date
+    "x-amz-decoded-content-length",  // x_amz_decoded_content_length
+    "x-amz-metadata-directive",      // x_amz_metadata_directive
+    "x-amz-tagging",                 // x_amz_tagging
+    "x-amz-tagging-directive",       // x_amz_tagging_directive
+    "X-Forwarded-For",               // x_forwarded_for
+};
+
+size_t S3HeaderIndex::Hash::operator()(const char* name) const {
+  // FNV-1a of lower case name.
+  size_t hash = 14695981039346656037ULL;
+  for (; *name; ++name) {
+    hash ^= (unsigned char)tolower((unsigned char)*name);
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+bool S3HeaderIndex::Equal::operator()(const char* lhs, const char* rhs) const {
+  return strcasecmp(lhs, rhs) == 0;
+}
+
+typedef std::unordered_map<const char*, S3Header, S3HeaderIndex::Hash,
+                           S3HeaderIndex::Equal> S3KnownHeaders;
+
+// Well-known header for every name (in any case).
+static const S3KnownHeaders& get_known_headers() {
+  static const S3KnownHeaders known_headers = [] {
+    S3KnownHeaders headers;
+    for (size_t i = 0; i < (size_t)S3Header::count; ++i) {
+      headers.emplace(known_header_names[i], (S3Header)i);
+    }
+    return headers;
+  }();
+  return known_headers;
+}
+
+void S3HeaderIndex::add(const char* name, const std::string* value) {
+  if (!headers.emplace(name, value).second) {
+    return;
+  }
+  const auto& known = get_known_headers();
+  auto it = known.find(name);
+  if (it != known.end()) {
+    known_headers[(size_t)it->second] = value;
+  }
+}
+
+void S3HeaderIndex::clear() {
+  headers.clear();
+  for (auto& known_header : known_headers) {
+    known_header = nullptr;
+  }
+}
+
+const std::string* S3HeaderIndex::find(const char* name) const {
+  auto it = headers.find(name);
+  return it == headers.end() ? nullptr : it->second;
+}
+
+const char* S3HeaderIndex::get_name(S3Header header) {
+  return known_header_names[(size_t)header];
+}
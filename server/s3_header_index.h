@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#pragma once
+
+#ifndef __S3_SERVER_S3_HEADER_INDEX_H__
+#define __S3_SERVER_S3_HEADER_INDEX_H__
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+
+// Request headers which S3 server itself looks up, usually more than once
+// per request.  Keep in sync with the names in s3_header_index.cc.
+enum class S3Header {
+  authorization,
+  content_length,
+  content_md5,
+  content_type,
+  host,
+  range,
+  user_agent,
+  x_amz_content_sha256,
+  x_amz_copy_source,
+  x_amz_date,
+  x_amz_decoded_content_length,
+  x_amz_metadata_directive,
+  x_amz_tagging,
+  x_amz_tagging_directive,
+  x_forwarded_for,
+  count
+};
+
+// Index of request headers by case insensitive name.
+//
+// Doesn't own the headers: names and values must outlive the index and not
+// move, e.g. keys and values of std::map.
+// Lookup of well-known headers by S3Header is an array access.
+class S3HeaderIndex {
+ public:
+  // Case insensitive hash and comparison of header names.
+  struct Hash {
+    size_t operator()(const char* name) const;
+  };
+  struct Equal {
+    bool operator()(const char* lhs, const char* rhs) const;
+  };
+
+ private:
+  std::unordered_map<const char*, const std::string*, Hash, Equal> headers;
+  const std::string* known_headers[(size_t)S3Header::count] = {};
+
+ public:
+  // If the header is already indexed (in any case), first one is kept.
+  void add(const char* name, const std::string* value);
+  void clear();
+
+  size_t size() const { return headers.size(); }
+
+  // Return nullptr if there is no such header.
+  const std::string* find(const char* name) const;
+  const std::string* find(S3Header header) const {
+    return known_headers[(size_t)header];
+  }
+
+  static const char* get_name(S3Header header);
+};
+
+#endif
@@ -25,6 +25,7 @@
 
 #include <event2/util.h>
 #include <event2/dns.h>
+#include <zlib.h>
 
 #include "s3_log.h"
 #include "s3_http_post_queue_impl.h"
@@ -34,8 +35,23 @@ S3HttpPostQueue::~S3HttpPostQueue() = default;
 S3HttpPostEngine::~S3HttpPostEngine() = default;
 S3HttpPostQueueImpl::~S3HttpPostQueueImpl() = default;
 
-S3HttpPostQueueImpl::S3HttpPostQueueImpl(S3HttpPostEngine *http_post_engine_)
-    : http_post_engine(http_post_engine_) {
+S3HttpPostBatchFormat S3HttpPostBatchFormat::newline_delimited() {
+  return {"", "\n", "\n"};
+}
+
+S3HttpPostBatchFormat S3HttpPostBatchFormat::json_array(std::string prefix,
+                                                        std::string suffix) {
+  return {std::move(prefix), ",", std::move(suffix)};
+}
+
+S3HttpPostQueueImpl::S3HttpPostQueueImpl(S3HttpPostEngine *http_post_engine_,
+                                         S3HttpPostBatchFormat batch_format_,
+                                         unsigned max_batch_msgs_,
+                                         unsigned max_requests_in_flight_)
+    : batch_format(std::move(batch_format_)),
+      max_batch_msgs(std::max(max_batch_msgs_, 1u)),
+      max_requests_in_flight(std::max(max_requests_in_flight_, 1u)),
+      http_post_engine(http_post_engine_) {
 
   assert(http_post_engine_ != nullptr);
   http_post_engine->set_callbacks(
@@ -52,81 +68,142 @@ bool S3HttpPostQueueImpl::post(std::string msg) {
     s3_log(S3_LOG_INFO, nullptr, "Empty messages are not allowed");
     return false;
   }
-  if (msg_queue.size() >= MAX_MSG_IN_QUEUE) {
+  if (get_msgs_count() >= MAX_MSG_IN_QUEUE) {
     s3_log(S3_LOG_DEBUG, nullptr, "Too many messages in the queue");
     return false;
   }
   msg_queue.push(std::move(msg));
+  send_batches();
 
-  if (!msg_in_progress) {
-    send_front();
-  } else {
-    s3_log(S3_LOG_DEBUG, nullptr, "Another message is being processed");
-  }
   return true;
 }
 
 void S3HttpPostQueueImpl::on_msg_sent() {
-  assert(msg_in_progress);
-  assert(!msg_queue.empty());
+  assert(!in_flight.empty());
 
-  msg_in_progress = false;
   n_err = 0;
-  msg_queue.pop();
+  n_batched_msgs -= in_flight.front().n_msgs;
+  in_flight.pop_front();
 
-  if (!msg_queue.empty()) {
-    s3_log(S3_LOG_DEBUG, nullptr, "%zu message(s) in the queue",
-           msg_queue.size());
-    send_front();
-  }
+  send_batches();
 }
 
 void S3HttpPostQueueImpl::on_error() {
-  assert(msg_in_progress);
-  assert(!msg_queue.empty());
+  assert(!in_flight.empty());
 
-  msg_in_progress = false;
+  Batch batch = std::move(in_flight.front());
+  in_flight.pop_front();
 
   if (++n_err > MAX_ERR) {
-    s3_log(S3_LOG_ERROR, nullptr,
-           "The number of errors has exceeded the threshold");
-    while (!msg_queue.empty()) {
-      msg_queue.pop();
-    }
+    drop_undelivered(batch);
   } else {
     s3_log(S3_LOG_DEBUG, nullptr,
            "Message hasn't been sent %u times. Repeat...", n_err);
-    send_front();
+    failed.push_back(std::move(batch));
+    send_batches();
+  }
+}
+
+void S3HttpPostQueueImpl::drop_undelivered(const Batch &batch) {
+  s3_log(S3_LOG_ERROR, nullptr,
+         "The number of errors has exceeded the threshold");
+  n_batched_msgs -= batch.n_msgs;
+
+  for (const auto &failed_batch : failed) {
+    n_batched_msgs -= failed_batch.n_msgs;
+  }
+  failed.clear();
+
+  while (!msg_queue.empty()) {
+    msg_queue.pop();
   }
 }
 
-void S3HttpPostQueueImpl::send_front() {
-  assert(!msg_in_progress);
+S3HttpPostQueueImpl::Batch S3HttpPostQueueImpl::make_batch() {
   assert(!msg_queue.empty());
 
-  bool ret = http_post_engine->post(msg_queue.front());
-  assert(ret);
-  (void)ret;
+  Batch batch = {batch_format.prefix, 0};
 
-  msg_in_progress = true;
+  while (!msg_queue.empty() && batch.n_msgs < max_batch_msgs) {
+    const std::string &msg = msg_queue.front();
+
+    if (batch.n_msgs &&
+        batch.body.length() + batch_format.separator.length() + msg.length() +
+                batch_format.suffix.length() >
+            MAX_BATCH_SIZE) {
+      break;
+    }
+    if (batch.n_msgs) {
+      batch.body += batch_format.separator;
+    }
+    batch.body += msg;
+    ++batch.n_msgs;
+    msg_queue.pop();
+  }
+  batch.body += batch_format.suffix;
+  n_batched_msgs += batch.n_msgs;
+
+  return batch;
+}
+
+void S3HttpPostQueueImpl::send_batches() {
+  while (in_flight.size() < max_requests_in_flight) {
+    Batch batch;
+
+    if (!failed.empty()) {
+      batch = std::move(failed.front());
+      failed.pop_front();
+    } else if (!msg_queue.empty()) {
+      batch = make_batch();
+    } else {
+      return;
+    }
+    if (!http_post_engine->post(batch.body)) {
+      s3_log(S3_LOG_ERROR, nullptr, "Batch of %zu message(s) can't be posted",
+             batch.n_msgs);
+      // The engine won't call back for it, so the batch doesn't get in
+      // flight. It is retried first by the next post() or completion, until
+      // post() stops accepting messages and nothing would retry it anymore.
+      if (++n_err >= MAX_ERR) {
+        drop_undelivered(batch);
+      } else {
+        failed.push_front(std::move(batch));
+      }
+      return;
+    }
+    in_flight.push_back(std::move(batch));
+  }
+  if (!msg_queue.empty()) {
+    s3_log(S3_LOG_DEBUG, nullptr, "%zu message(s) in the queue",
+           msg_queue.size());
+  }
 }
 
 S3HttpPostEngineImpl::S3HttpPostEngineImpl(
     evbase_t *p_evbase_, std::string s_host_, uint16_t port_, std::string path_,
-    std::map<std::string, std::string> headers_)
+    std::map<std::string, std::string> headers_, unsigned max_connections,
+    bool compress_)
     : p_evbase(p_evbase_),
       s_host(std::move(s_host_)),
       port(port_),
       path(std::move(path_)),
-      headers(std::move(headers_)) {}
+      compress(compress_),
+      headers(std::move(headers_)) {
+
+  for (unsigned i = 0; i < std::max(max_connections, 1u); ++i) {
+    connections.emplace_back(new Connection(this));
+  }
+}
 
 S3HttpPostEngineImpl::~S3HttpPostEngineImpl() {
 
-  if (p_conn) {
-    if (p_conn->request) {
-      evhtp_unset_all_hooks(&p_conn->request->hooks);
+  for (auto &conn : connections) {
+    if (conn->p_conn) {
+      if (conn->p_conn->request) {
+        evhtp_unset_all_hooks(&conn->p_conn->request->hooks);
+      }
+      evhtp_unset_all_hooks(&conn->p_conn->hooks);
     }
-    evhtp_unset_all_hooks(&p_conn->hooks);
   }
   if (p_evdns_base) {
     evdns_base_free(p_evdns_base, 0);
@@ -135,6 +212,10 @@ S3HttpPostEngineImpl::~S3HttpPostEngineImpl() {
     event_del(p_event);
     event_free(p_event);
   }
+  if (p_retry_event) {
+    event_del(p_retry_event);
+    event_free(p_retry_event);
+  }
 }
 
 bool S3HttpPostEngineImpl::set_callbacks(std::function<void(void)> on_success,
@@ -149,6 +230,33 @@ bool S3HttpPostEngineImpl::set_callbacks(std::function<void(void)> on_success,
   return true;
 }
 
+bool S3HttpPostEngineImpl::gzip(const std::string &in, std::string &out) {
+  z_stream strm = {};
+
+  // 16 is added to window bits to get gzip header and trailer
+  if (deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8,
+                   Z_DEFAULT_STRATEGY) != Z_OK) {
+    s3_log(S3_LOG_ERROR, nullptr, "deflateInit2() failed");
+    return false;
+  }
+  out.resize(deflateBound(&strm, in.length()));
+
+  strm.next_in = (Bytef *)in.data();
+  strm.avail_in = in.length();
+  strm.next_out = (Bytef *)&out[0];
+  strm.avail_out = out.length();
+
+  const int rc = deflate(&strm, Z_FINISH);
+  out.resize(strm.total_out);
+  deflateEnd(&strm);
+
+  if (rc != Z_STREAM_END) {
+    s3_log(S3_LOG_ERROR, nullptr, "deflate() failed: %d", rc);
+    return false;
+  }
+  return true;
+}
+
 evhtp_res S3HttpPostEngineImpl::on_conn_err_cb(evhtp_connection_t *p_conn,
                                                evhtp_error_flags errtype,
                                                void *p_arg) noexcept {
@@ -156,7 +264,7 @@ evhtp_res S3HttpPostEngineImpl::on_conn_err_cb(evhtp_connection_t *p_conn,
   evhtp_unset_all_hooks(&p_conn->hooks);
 
   assert(p_arg != nullptr);
-  auto *p_inst = static_cast<S3HttpPostEngineImpl *>(p_arg);
+  auto *p_connection = static_cast<Connection *>(p_arg);
 
   try {
     if (errtype != (BEV_EVENT_READING | BEV_EVENT_EOF)) {
@@ -170,10 +278,10 @@ evhtp_res S3HttpPostEngineImpl::on_conn_err_cb(evhtp_connection_t *p_conn,
       s3_log(S3_LOG_DEBUG, nullptr,
              "Probably a client has closed the connection");
     }
-    assert(p_conn == p_inst->p_conn);
-    p_inst->p_conn = nullptr;
+    assert(p_conn == p_connection->p_conn);
+    p_connection->p_conn = nullptr;
 
-    p_inst->request_finished(p_conn->request);
+    p_connection->p_engine->request_finished(p_connection, p_conn->request);
   }
   catch (const std::exception &ex) {
     s3_log(S3_LOG_ERROR, nullptr, "%s", ex.what());
@@ -191,11 +299,11 @@ evhtp_res S3HttpPostEngineImpl::on_conn_fini_cb(evhtp_connection_t *p_conn,
 
   try {
     s3_log(S3_LOG_DEBUG, nullptr, "");
-    auto *p_inst = static_cast<S3HttpPostEngineImpl *>(p_arg);
+    auto *p_connection = static_cast<Connection *>(p_arg);
 
-    if (p_inst->p_conn) {
-      assert(p_inst->p_conn == p_conn);
-      p_inst->p_conn = nullptr;
+    if (p_connection->p_conn) {
+      assert(p_connection->p_conn == p_conn);
+      p_connection->p_conn = nullptr;
     }
   }
   catch (const std::exception &ex) {
@@ -207,8 +315,8 @@ evhtp_res S3HttpPostEngineImpl::on_conn_fini_cb(evhtp_connection_t *p_conn,
   return EVHTP_RES_OK;
 }
 
-bool S3HttpPostEngineImpl::connect() {
-  if (p_conn) {
+bool S3HttpPostEngineImpl::connect(Connection *p_connection) {
+  if (p_connection->p_conn) {
     return true;
   }
   if (!p_evdns_base) {
@@ -219,7 +327,7 @@ bool S3HttpPostEngineImpl::connect() {
       return false;
     }
   }
-  p_conn =
+  evhtp_connection_t *p_conn =
       evhtp_connection_new_dns(p_evbase, p_evdns_base, s_host.c_str(), port);
 
   if (!p_conn) {
@@ -227,9 +335,10 @@ bool S3HttpPostEngineImpl::connect() {
     return false;
   }
   evhtp_set_hook(&p_conn->hooks, evhtp_hook_on_conn_error,
-                 (evhtp_hook)on_conn_err_cb, this);
+                 (evhtp_hook)on_conn_err_cb, p_connection);
   evhtp_set_hook(&p_conn->hooks, evhtp_hook_on_connection_fini,
-                 (evhtp_hook)on_conn_fini_cb, this);
+                 (evhtp_hook)on_conn_fini_cb, p_connection);
+  p_connection->p_conn = p_conn;
   return true;
 }
 
@@ -262,8 +371,8 @@ evhtp_res S3HttpPostEngineImpl::on_header_cb(evhtp_request_t *p_evhtp_req,
     s3_log(S3_LOG_DEBUG, nullptr, "%s: %s", p_hdr->key, p_hdr->val);
 
     if (!strcasecmp(p_hdr->key, "Content-Length")) {
-      auto *p_inst = static_cast<S3HttpPostEngineImpl *>(p_arg);
-      p_inst->response_content_length = atol(p_hdr->val);
+      auto *p_connection = static_cast<Connection *>(p_arg);
+      p_connection->response_content_length = atol(p_hdr->val);
     }
   }
   catch (const std::exception &ex) {
@@ -282,11 +391,11 @@ evhtp_res S3HttpPostEngineImpl::on_headers_cb(evhtp_request_t *p_evhtp_req,
   assert(p_arg != nullptr);
 
   try {
-    auto *p_inst = static_cast<S3HttpPostEngineImpl *>(p_arg);
+    auto *p_connection = static_cast<Connection *>(p_arg);
 
-    if (!p_inst->response_content_length) {
+    if (!p_connection->response_content_length) {
       s3_log(S3_LOG_DEBUG, nullptr, "None data in the response");
-      p_inst->request_finished(p_evhtp_req);
+      p_connection->p_engine->request_finished(p_connection, p_evhtp_req);
     } else {
       s3_log(S3_LOG_DEBUG, nullptr, "Waiting data...");
     }
@@ -320,11 +429,11 @@ evhtp_res S3HttpPostEngineImpl::on_response_data_cb(
     }
     evbuffer_drain(p_evbuf, -1);
 
-    auto *p_inst = static_cast<S3HttpPostEngineImpl *>(p_arg);
-    p_inst->n_read += n_bytes;
+    auto *p_connection = static_cast<Connection *>(p_arg);
+    p_connection->n_read += n_bytes;
 
-    if (p_inst->n_read >= p_inst->response_content_length) {
-      p_inst->request_finished(p_evhtp_req);
+    if (p_connection->n_read >= p_connection->response_content_length) {
+      p_connection->p_engine->request_finished(p_connection, p_evhtp_req);
     }
   }
   catch (const std::exception &ex) {
@@ -336,11 +445,12 @@ evhtp_res S3HttpPostEngineImpl::on_response_data_cb(
   return EVHTP_RES_OK;
 }
 
-bool S3HttpPostEngineImpl::send_request(const std::string &msg) {
-  assert(!request_in_progress);
+bool S3HttpPostEngineImpl::send_request(Connection *p_connection,
+                                        const std::string &msg) {
+  assert(!p_connection->request_in_progress);
   assert(!msg.empty());
 
-  if (!connect()) {
+  if (!connect(p_connection)) {
     return false;
   }
   evbuf_t *p_ev_buf = evbuffer_new();
@@ -361,6 +471,11 @@ bool S3HttpPostEngineImpl::send_request(const std::string &msg) {
         p_evhtp_req->headers_out,
         evhtp_header_new(it->first.c_str(), it->second.c_str(), 0, 0));
   }
+  if (compress) {
+    evhtp_headers_add_header(
+        p_evhtp_req->headers_out,
+        evhtp_header_new("Content-Encoding", "gzip", 0, 0));
+  }
   if (!msg.empty()) {
     auto s_content_length = std::to_string(msg.length());
 
@@ -369,30 +484,50 @@ bool S3HttpPostEngineImpl::send_request(const std::string &msg) {
         evhtp_header_new("Content-Length", s_content_length.c_str(), 0, 1));
   }
   evhtp_set_hook(&p_evhtp_req->hooks, evhtp_hook_on_headers_start,
-                 (evhtp_hook)on_headers_start_cb, this);
+                 (evhtp_hook)on_headers_start_cb, p_connection);
   evhtp_set_hook(&p_evhtp_req->hooks, evhtp_hook_on_header,
-                 (evhtp_hook)on_header_cb, this);
+                 (evhtp_hook)on_header_cb, p_connection);
   evhtp_set_hook(&p_evhtp_req->hooks, evhtp_hook_on_headers,
-                 (evhtp_hook)on_headers_cb, this);
+                 (evhtp_hook)on_headers_cb, p_connection);
   evhtp_set_hook(&p_evhtp_req->hooks, evhtp_hook_on_read,
-                 (evhtp_hook)on_response_data_cb, this);
+                 (evhtp_hook)on_response_data_cb, p_connection);
 
   evbuffer_add(p_ev_buf, msg.c_str(), msg.length());
 
-  evhtp_make_request(p_conn, p_evhtp_req, htp_method_POST, path.c_str());
+  evhtp_make_request(p_connection->p_conn, p_evhtp_req, htp_method_POST,
+                     path.c_str());
   evhtp_send_reply_body(p_evhtp_req, p_ev_buf);
 
   evbuffer_free(p_ev_buf);
 
-  response_content_length = 0;
-  n_read = 0;
-  request_in_progress = true;
+  p_connection->response_content_length = 0;
+  p_connection->n_read = 0;
+  p_connection->request_in_progress = true;
 
   s3_log(S3_LOG_DEBUG, nullptr, "Request has been sent");
 
   return true;
 }
 
+void S3HttpPostEngineImpl::send_requests() {
+  for (auto &conn : connections) {
+    if (msgs_to_send.empty()) {
+      break;
+    }
+    if (conn->request_in_progress) {
+      continue;
+    }
+    auto &next = msgs_to_send.front();
+
+    if (send_request(conn.get(), next.second)) {
+      conn->request_id = next.first;
+    } else {
+      set_request_state(next.first, RequestState::FAILED);
+    }
+    msgs_to_send.pop_front();
+  }
+}
+
 void S3HttpPostEngineImpl::on_schedule_cb(evutil_socket_t, short,
                                           void *p_arg) noexcept {
   assert(p_arg != nullptr);
@@ -401,21 +536,28 @@ void S3HttpPostEngineImpl::on_schedule_cb(evutil_socket_t, short,
   try {
     s3_log(S3_LOG_DEBUG, nullptr, "");
 
-    assert(p_inst->on_fail);
+    p_inst->send_requests();
+    p_inst->report_results();
+  }
+  catch (const std::exception &ex) {
+    s3_log(S3_LOG_ERROR, nullptr, "%s", ex.what());
+  }
+  catch (...) {
+    s3_log(S3_LOG_ERROR, nullptr, "Non-standard C++ exception");
+  }
+}
 
-    if (p_inst->f_error) {
-      p_inst->f_error = false;
-      p_inst->on_fail();
-      return;
-    }
-    assert(!p_inst->msg_to_send.empty());
+void S3HttpPostEngineImpl::on_retry_cb(evutil_socket_t, short,
+                                       void *p_arg) noexcept {
+  assert(p_arg != nullptr);
+  auto *p_inst = static_cast<S3HttpPostEngineImpl *>(p_arg);
 
-    const bool ret = p_inst->send_request(p_inst->msg_to_send);
-    p_inst->msg_to_send.clear();
+  try {
+    s3_log(S3_LOG_DEBUG, nullptr, "");
 
-    if (!ret) {
-      p_inst->on_fail();
-    }
+    p_inst->retry_pending = false;
+    p_inst->report_failure();
+    p_inst->report_results();
   }
   catch (const std::exception &ex) {
     s3_log(S3_LOG_ERROR, nullptr, "%s", ex.what());
@@ -433,21 +575,68 @@ static bool is_request_succeed(evhtp_request_t *p_evhtp_req) {
   return status >= EVHTP_RES_OK && status < EVHTP_RES_300;
 }
 
-void S3HttpPostEngineImpl::request_finished(evhtp_request_t *p_evhtp_req) {
-  if (!request_in_progress) {
+void S3HttpPostEngineImpl::request_finished(Connection *p_connection,
+                                            evhtp_request_t *p_evhtp_req) {
+  if (!p_connection->request_in_progress) {
     s3_log(S3_LOG_DEBUG, nullptr, "Double invocation");
     return;
   }
   if (p_evhtp_req) {
     evhtp_unset_all_hooks(&p_evhtp_req->hooks);
   }
-  if (is_request_succeed(p_evhtp_req)) {
+  p_connection->request_in_progress = false;
+
+  set_request_state(p_connection->request_id,
+                    is_request_succeed(p_evhtp_req) ? RequestState::SUCCEEDED
+                                                    : RequestState::FAILED);
+  // Callbacks may post new messages, so they are called outside of
+  // evhtp hooks.
+  schedule();
+}
+
+void S3HttpPostEngineImpl::set_request_state(uint64_t request_id,
+                                             RequestState state) {
+  assert(request_id >= first_request_id);
+  assert(request_id - first_request_id < request_states.size());
+
+  request_states[request_id - first_request_id] = state;
+}
+
+const struct timeval tv = {0, 100000};  // 1/10 sec
+
+void S3HttpPostEngineImpl::report_results() {
+  while (!retry_pending && !request_states.empty()) {
+    const RequestState state = request_states.front();
+
+    if (state == RequestState::IN_PROGRESS) {
+      break;
+    }
+    if (state == RequestState::FAILED) {
+      if (p_retry_event && !event_add(p_retry_event, &tv)) {
+        retry_pending = true;
+      } else {
+        s3_log(S3_LOG_ERROR, nullptr, "event_add() failed");
+        report_failure();
+      }
+      continue;
+    }
+    request_states.pop_front();
+    ++first_request_id;
+
     assert(on_success);
     on_success();
-  } else {
-    call_error_callback();
   }
-  request_in_progress = false;
+}
+
+void S3HttpPostEngineImpl::report_failure() {
+  assert(!request_states.empty());
+  assert(request_states.front() == RequestState::FAILED);
+
+  request_states.pop_front();
+  ++first_request_id;
+
+  assert(on_fail);
+  on_fail();
 }
 
 bool S3HttpPostEngineImpl::prepare_scheduling() {
@@ -456,26 +645,23 @@ bool S3HttpPostEngineImpl::prepare_scheduling() {
 
     if (!p_event) {
       s3_log(S3_LOG_ERROR, nullptr, "event_new() failed");
-      assert(on_fail);
-      on_fail();
+      return false;
     }
   }
-  return p_event;
-}
-
-const struct timeval tv = {0, 100000};  // 1/10 sec
+  if (!p_retry_event) {
+    p_retry_event = event_new(p_evbase, -1, 0, on_retry_cb, this);
 
-void S3HttpPostEngineImpl::call_error_callback() {
-  if (!prepare_scheduling()) {
-    return;
-  }
-  if (event_add(p_event, &tv)) {
-    s3_log(S3_LOG_ERROR, nullptr, "event_add() failed");
-    assert(on_fail);
-    on_fail();
-  } else {
-    f_error = true;
+    if (!p_retry_event) {
+      s3_log(S3_LOG_ERROR, nullptr, "event_new() failed");
+      return false;
+    }
   }
+  return true;
+}
+
+void S3HttpPostEngineImpl::schedule() {
+  assert(p_event != nullptr);
+  event_active(p_event, 0, 1);
 }
 
 bool S3HttpPostEngineImpl::post(const std::string &msg) {
@@ -492,33 +678,40 @@ bool S3HttpPostEngineImpl::post(const std::string &msg) {
     s3_log(S3_LOG_ERROR, nullptr, "Bad callback(s)");
     return false;
   }
-  if (!request_in_progress) {
-    if (send_request(msg)) {
-      return true;
-    }
-  } else if (!msg_to_send.empty()) {
-    s3_log(S3_LOG_ERROR, nullptr,
-           "The previous message hasn't been handled yet");
+  if (!prepare_scheduling()) {
     return false;
-  } else {
-    s3_log(S3_LOG_ERROR, nullptr, "Schedule posting");
-    msg_to_send = msg;
   }
-  if (prepare_scheduling()) {
-    if (!msg_to_send.empty()) {
-      event_active(p_event, 0, 1);
+  const uint64_t request_id = next_request_id++;
+  request_states.push_back(RequestState::IN_PROGRESS);
+
+  if (!compress) {
+    msgs_to_send.emplace_back(request_id, msg);
+  } else {
+    std::string compressed;
+
+    if (gzip(msg, compressed)) {
+      msgs_to_send.emplace_back(request_id, std::move(compressed));
     } else {
-      call_error_callback();
+      set_request_state(request_id, RequestState::FAILED);
     }
   }
+  // Requests are sent and results are reported from the event loop, so the
+  // caller never gets a callback from within post().
+  schedule();
+
   return true;
 }
 
 template <>
 S3HttpPostQueue *create_http_post_queue(
     evbase_t *p_evbase, std::string s_host, uint16_t port, std::string path,
-    std::map<std::string, std::string> headers) {
-
-  return new S3HttpPostQueueImpl(new S3HttpPostEngineImpl(
-      p_evbase, std::move(s_host), port, std::move(path), std::move(headers)));
+    std::map<std::string, std::string> headers,
+    S3HttpPostBatchFormat batch_format, unsigned max_batch_msgs,
+    unsigned max_requests_in_flight, bool compress) {
+
+  return new S3HttpPostQueueImpl(
+      new S3HttpPostEngineImpl(p_evbase, std::move(s_host), port,
+                               std::move(path), std::move(headers),
+                               max_requests_in_flight, compress),
+      std::move(batch_format), max_batch_msgs, max_requests_in_flight);
 }
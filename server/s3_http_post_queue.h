@@ -23,6 +23,20 @@
 
 #include <string>
 
+// Describes how messages are joined into the body of one POST request.
+struct S3HttpPostBatchFormat {
+  std::string prefix;
+  std::string separator;
+  std::string suffix;
+
+  // One message per line.
+  static S3HttpPostBatchFormat newline_delimited();
+  // Messages are elements of JSON array, e.g. prefix '{"records":[' and
+  // suffix ']}'.
+  static S3HttpPostBatchFormat json_array(std::string prefix,
+                                          std::string suffix);
+};
+
 class S3HttpPostQueue {
  public:
   virtual ~S3HttpPostQueue();
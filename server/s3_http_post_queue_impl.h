@@ -23,16 +23,20 @@
 
 #include <cstdint>
 
+#include <deque>
 #include <functional>
 #include <map>
 #include <memory>
 #include <queue>
+#include <vector>
 
 #include <gtest/gtest_prod.h>
 #include <evhtp.h>
 
 #include "s3_http_post_queue.h"
 
+// Callbacks are called once per post() invocation, in the same order as
+// messages were posted.
 class S3HttpPostEngine {
  public:
   virtual ~S3HttpPostEngine();
@@ -41,9 +45,16 @@ class S3HttpPostEngine {
   virtual bool post(const std::string &msg) = 0;
 };
 
+// Joins queued messages into batches and keeps up to
+// 'max_requests_in_flight' batches being sent at the same time.
+// A failed batch is sent again before new messages.
 class S3HttpPostQueueImpl : public S3HttpPostQueue {
  public:
-  S3HttpPostQueueImpl(S3HttpPostEngine *);
+  S3HttpPostQueueImpl(S3HttpPostEngine *,
+                      S3HttpPostBatchFormat batch_format =
+                          S3HttpPostBatchFormat::newline_delimited(),
+                      unsigned max_batch_msgs = 100,
+                      unsigned max_requests_in_flight = 4);
   ~S3HttpPostQueueImpl();
 
   bool post(std::string msg) override;
@@ -53,7 +64,17 @@ class S3HttpPostQueueImpl : public S3HttpPostQueue {
   virtual void on_error();
 
  private:
-  void send_front();
+  struct Batch {
+    std::string body;
+    size_t n_msgs;
+  };
+
+  Batch make_batch();
+  void send_batches();
+  // Drops 'batch' and all messages which haven't been sent yet.
+  void drop_undelivered(const Batch &batch);
+  // All messages which haven't been delivered yet.
+  size_t get_msgs_count() const { return msg_queue.size() + n_batched_msgs; }
 
   enum : unsigned {
     MAX_ERR = 100
@@ -61,41 +82,88 @@ class S3HttpPostQueueImpl : public S3HttpPostQueue {
   enum : unsigned {
     MAX_MSG_IN_QUEUE = 1024
   };
+  // A batch may exceed it only if it consists of one message.
+  enum : size_t {
+    MAX_BATCH_SIZE = 1024 * 1024
+  };
+  const S3HttpPostBatchFormat batch_format;
+  const unsigned max_batch_msgs;
+  const unsigned max_requests_in_flight;
+
   unsigned n_err = 0;
-  bool msg_in_progress = false;
+  size_t n_batched_msgs = 0;
 
+  // Messages which haven't been sent yet
   std::queue<std::string> msg_queue;
+  // Batches in the order they were posted to the engine
+  std::deque<Batch> in_flight;
+  // Batches to be re-sent
+  std::deque<Batch> failed;
   std::unique_ptr<S3HttpPostEngine> http_post_engine;
 
   FRIEND_TEST(S3HttpPostQueueTest, Basic);
   FRIEND_TEST(S3HttpPostQueueTest, InProgress);
   FRIEND_TEST(S3HttpPostQueueTest, ErrorCount);
   FRIEND_TEST(S3HttpPostQueueTest, Thresholds);
+  FRIEND_TEST(S3HttpPostQueueTest, Batching);
+  FRIEND_TEST(S3HttpPostQueueTest, BatchSizeLimit);
+  FRIEND_TEST(S3HttpPostQueueTest, Pipelining);
+  FRIEND_TEST(S3HttpPostQueueTest, FailedBatchIsResentFirst);
+  FRIEND_TEST(S3HttpPostQueueTest, RefusedBatchIsRetried);
+  FRIEND_TEST(S3HttpPostQueueTest, RefusedBatchesAreDropped);
 };
 
+// Sends requests over up to 'max_connections' persistent connections, one
+// request per connection at a time. Results are reported in the order of
+// post() invocations.
 class S3HttpPostEngineImpl : public S3HttpPostEngine {
   typedef struct evdns_base evdns_base_t;
 
  public:
   S3HttpPostEngineImpl(evbase_t *p_evbase, std::string s_host, uint16_t port,
                        std::string path,
-                       std::map<std::string, std::string> headers);
+                       std::map<std::string, std::string> headers,
+                       unsigned max_connections = 1, bool compress = false);
   ~S3HttpPostEngineImpl();
 
   // Next 2 functions should return FALSE if any of functors is "bad"
   bool set_callbacks(std::function<void(void)> on_success,
                      std::function<void(void)> on_fail) override;
   // In additional to previous comment the function should return FALSE
-  // if msg is empty or the function is called before a callback for the
-  // previous invocation is called.
+  // if msg is empty.
   bool post(const std::string &msg) override;
 
+  // Compresses 'in' into gzip format.
+  static bool gzip(const std::string &in, std::string &out);
+
  private:
-  void call_error_callback();
-  bool connect();
+  enum class RequestState {
+    IN_PROGRESS,
+    SUCCEEDED,
+    FAILED
+  };
+
+  struct Connection {
+    S3HttpPostEngineImpl *p_engine;
+    evhtp_connection_t *p_conn = nullptr;
+    bool request_in_progress = false;
+    uint64_t request_id = 0;
+    size_t response_content_length = 0;
+    size_t n_read = 0;
+
+    explicit Connection(S3HttpPostEngineImpl *p_engine_)
+        : p_engine(p_engine_) {}
+  };
+
+  bool connect(Connection *);
   bool prepare_scheduling();
-  void request_finished(evhtp_request_t *);
-  bool send_request(const std::string &);
+  void schedule();
+  void send_requests();
+  bool send_request(Connection *, const std::string &);
+  void request_finished(Connection *, evhtp_request_t *);
+  void set_request_state(uint64_t request_id, RequestState);
+  void report_results();
+  void report_failure();
 
   static evhtp_res on_conn_err_cb(evhtp_connection_t *, evhtp_error_flags,
                                   void *) noexcept;
@@ -110,24 +178,32 @@ class S3HttpPostEngineImpl : public S3HttpPostEngine {
                                        void *) noexcept;
 
   static void on_schedule_cb(evutil_socket_t, short, void *) noexcept;
+  static void on_retry_cb(evutil_socket_t, short, void *) noexcept;
 
   evbase_t *const p_evbase;
   const std::string s_host;
   const uint16_t port;
   const std::string path;
+  const bool compress;
 
   evdns_base_t *p_evdns_base = nullptr;
-  evhtp_connection_t *p_conn = nullptr;
   event_t *p_event = nullptr;
-  bool request_in_progress = false;
-  bool f_error = false;
-  size_t response_content_length = 0;
-  size_t n_read = 0;
+  // Delays reporting of failures
+  event_t *p_retry_event = nullptr;
+  bool retry_pending = false;
+
+  std::vector<std::unique_ptr<Connection>> connections;
+  // Requests waiting for a free connection, pair<request id, body>
+  std::deque<std::pair<uint64_t, std::string>> msgs_to_send;
+  // States of requests which haven't been reported yet, the front one
+  // has id 'first_request_id'
+  std::deque<RequestState> request_states;
+  uint64_t first_request_id = 0;
+  uint64_t next_request_id = 0;
 
   std::function<void(void)> on_success;
   std::function<void(void)> on_fail;
 
-  std::string msg_to_send;
   std::map<std::string, std::string> headers;
 };
 
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+#include <math.h>
+
+#include "s3_latency_histogram.h"
+
+const unsigned S3LatencyHistogram::sub_bucket_count;
+const unsigned S3LatencyHistogram::sub_bucket_half;
+const unsigned S3LatencyHistogram::bucket_count;
+
+S3LatencyHistogram::S3LatencyHistogram() { reset(); }
+
+unsigned S3LatencyHistogram::bucket_index(uint64_t value) {
+  const uint64_t max_value = (1ULL << S3_HISTOGRAM_MAX_VALUE_BITS) - 1;
+  if (value > max_value) {
+    value = max_value;
+  }
+  if (value < sub_bucket_count) {
+    return (unsigned)value;
+  }
+  // Position of the highest bit decides the range, the next bits the
+  // sub-bucket within it.
+  unsigned msb = 63 - __builtin_clzll(value);
+  unsigned shift = msb - (S3_HISTOGRAM_SUB_BUCKET_BITS - 1);
+  unsigned sub_bucket = (unsigned)(value >> shift);
+  return sub_bucket_count + (shift - 1) * sub_bucket_half +
+         (sub_bucket - sub_bucket_half);
+}
+
+uint64_t S3LatencyHistogram::bucket_upper_bound(unsigned index) {
+  if (index < sub_bucket_count) {
+    return index;
+  }
+  unsigned offset = index - sub_bucket_count;
+  unsigned shift = offset / sub_bucket_half + 1;
+  uint64_t sub_bucket = offset % sub_bucket_half + sub_bucket_half;
+  return ((sub_bucket + 1) << shift) - 1;
+}
+
+void S3LatencyHistogram::record(uint64_t value) {
+  counts[bucket_index(value)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void S3LatencyHistogram::reset() {
+  for (auto& count : counts) {
+    count.store(0, std::memory_order_relaxed);
+  }
+}
+
+void S3LatencyHistogram::snapshot(std::vector<uint64_t>* out) const {
+  out->resize(bucket_count, 0);
+  for (unsigned i = 0; i < bucket_count; ++i) {
+    (*out)[i] += counts[i].load(std::memory_order_relaxed);
+  }
+}
+
+uint64_t S3LatencyHistogram::value_at_percentile(
+    const std::vector<uint64_t>& counts, double percentile) {
+  uint64_t total = 0;
+  for (auto count : counts) {
+    total += count;
+  }
+  if (total == 0) {
+    return 0;
+  }
+  uint64_t rank = (uint64_t)ceil(percentile / 100.0 * total);
+  if (rank == 0) {
+    rank = 1;
+  }
+  uint64_t seen = 0;
+  for (unsigned i = 0; i < counts.size(); ++i) {
+    seen += counts[i];
+    if (seen >= rank) {
+      return bucket_upper_bound(i);
+    }
+  }
+  return bucket_upper_bound(counts.size() - 1);
+}
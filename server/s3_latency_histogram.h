@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+#pragma once
+
+#ifndef __S3_SERVER_S3_LATENCY_HISTOGRAM_H__
+#define __S3_SERVER_S3_LATENCY_HISTOGRAM_H__
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// Each power of two range is split into 2^(SUB_BUCKET_BITS - 1) linear
+// sub-buckets, so recorded values are kept with ~3% precision.
+#define S3_HISTOGRAM_SUB_BUCKET_BITS 6
+// Values above 2^MAX_VALUE_BITS - 1 (~19 hours in usec) are clamped.
+#define S3_HISTOGRAM_MAX_VALUE_BITS 36
+
+// HdrHistogram style log-linear histogram of latencies (usec).
+//
+// Recording is a single relaxed atomic increment, it can be done from any
+// thread without locks. Percentiles are computed from a snapshot of counts,
+// so histograms (e.g. of several time windows) can be merged.
+class S3LatencyHistogram {
+ public:
+  static const unsigned sub_bucket_count = 1u << S3_HISTOGRAM_SUB_BUCKET_BITS;
+  static const unsigned sub_bucket_half = sub_bucket_count / 2;
+  static const unsigned bucket_count =
+      sub_bucket_count +
+      (S3_HISTOGRAM_MAX_VALUE_BITS - S3_HISTOGRAM_SUB_BUCKET_BITS) *
+          sub_bucket_half;
+
+  S3LatencyHistogram();
+
+  void record(uint64_t value);
+  void reset();
+
+  // Adds counts of this histogram to 'counts' (resized to bucket_count).
+  void snapshot(std::vector<uint64_t>* counts) const;
+
+  static unsigned bucket_index(uint64_t value);
+  // Highest value recorded into bucket 'index'.
+  static uint64_t bucket_upper_bound(unsigned index);
+  // Value at 'percentile' (0 - 100] of snapshot 'counts', 0 if empty.
+  static uint64_t value_at_percentile(const std::vector<uint64_t>& counts,
+                                      double percentile);
+
+ private:
+  std::atomic<uint64_t> counts[bucket_count];
+};
+
+#endif
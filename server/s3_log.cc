@@ -27,6 +27,16 @@ static thread_local char log_buffer[10 * ONE_KB];
 char *__log_buff() { return log_buffer; }
 size_t __log_buff_sz() { return sizeof(log_buffer); }
 
+void s3_log_msg(int loglevel, const char *file, int line, const char *msg) {
+  google::LogSeverity severity = google::GLOG_INFO;
+  if (loglevel >= S3_LOG_ERROR) {
+    severity = google::GLOG_ERROR;
+  } else if (loglevel == S3_LOG_WARN) {
+    severity = google::GLOG_WARNING;
+  }
+  google::LogMessage(file, line, severity).stream() << msg;
+}
+
 int s3log_level = S3_LOG_INFO;
 s3_fatal_log_handler s3_fatal_handler;
 
@@ -86,6 +96,16 @@ int init_log(char *process_name) {
   return 0;
 }
 
+int init_async_log() {
+  S3Option *option_instance = S3Option::get_instance();
+  if (!option_instance->is_log_async_enabled()) {
+    return 0;
+  }
+  return S3AsyncLog::start(
+      (size_t)option_instance->get_log_async_buffer_size_kb() * ONE_KB,
+      option_instance->get_log_async_sample_rate());
+}
+
 void redefine_log_level() {
   S3Option *option_instance = S3Option::get_instance();
   if (option_instance->get_log_level() != "") {
@@ -120,6 +140,7 @@ void redefine_log_level() {
 }
 
 void fini_log() {
+  S3AsyncLog::stop();
   google::FlushLogFiles(google::GLOG_INFO);
   google::ShutdownGoogleLogging();
 
@@ -127,5 +148,8 @@ void fini_log() {
   closelog();
 }
 
-void flushall_log() { google::FlushLogFiles(google::GLOG_INFO); }
+void flushall_log() {
+  S3AsyncLog::flush();
+  google::FlushLogFiles(google::GLOG_INFO);
+}
 
@@ -30,6 +30,8 @@
 #include <memory>
 #include <inttypes.h>
 
+#include "s3_async_log.h"
+
 #define S3_LOG_FATAL 4
 #define S3_LOG_ERROR 3
 #define S3_LOG_WARN 2
@@ -51,14 +53,20 @@ inline const char* s3_log_get_req_id(const std::string& requestid) {
   return requestid.empty() ? S3_DEFAULT_REQID : requestid.c_str();
 }
 
-#define s3_log_msg_S3_LOG_DEBUG(p) (LOG(INFO) << (p))
-#define s3_log_msg_S3_LOG_INFO(p) (LOG(INFO) << (p))
-#define s3_log_msg_S3_LOG_WARN(p) (LOG(WARNING) << (p))
-#define s3_log_msg_S3_LOG_ERROR(p) (LOG(ERROR) << (p))
-#define s3_log_msg_S3_LOG_FATAL(p) (LOG(ERROR) << (p))
-
 char* __log_buff();
 size_t __log_buff_sz();
+// Writes formatted message to glog.
+void s3_log_msg(int loglevel, const char* file, int line, const char* msg);
+
+// Arguments are evaluated once by the caller and passed to either backend.
+template <typename... Args>
+inline void s3_log_write(int loglevel, const char* file, int line,
+                         const char* fmt, Args... args) {
+  if (!S3AsyncLog::write(loglevel, file, line, fmt, args...)) {
+    snprintf(__log_buff(), __log_buff_sz(), fmt, args...);
+    s3_log_msg(loglevel, file, line, __log_buff());
+  }
+}
 
 // Note:
 // 1. Google glog doesn't have a separate severity level for DEBUG logs.
@@ -66,16 +74,24 @@ size_t __log_buff_sz();
 //    only if S3 log level is set to DEBUG.
 // 2. Logging a FATAL message terminates the program (after the message is
 //    logged).so demote it to ERROR
-#define s3_log(loglevel, requestid, fmt, ...)                               \
-  do {                                                                      \
-    if (loglevel >= s3log_level) {                                          \
-      snprintf(__log_buff(), __log_buff_sz(), "[%s] [ReqID: %s] " fmt "\n", \
-               __func__, s3_log_get_req_id(requestid), ##__VA_ARGS__);      \
-      s3_log_msg_##loglevel(__log_buff());                                  \
-    }                                                                       \
-    if (loglevel >= S3_LOG_FATAL) {                                         \
-      s3_fatal_handler(1);                                                  \
-    }                                                                       \
+// 3. With asynchronous logging (see S3AsyncLog) messages are formatted and
+//    written by a background thread, the synchronous path is used before it
+//    is started and when its buffer can't take the message.
+// 4. The printf() which is never called lets the compiler check the format
+//    against the arguments, it does not evaluate them.
+#define s3_log(loglevel, requestid, fmt, ...)                                  \
+  do {                                                                         \
+    if (loglevel >= s3log_level) {                                             \
+      if (0) {                                                                 \
+        printf("[%s] [ReqID: %s] " fmt "\n", __func__,                         \
+               s3_log_get_req_id(requestid), ##__VA_ARGS__);                   \
+      }                                                                        \
+      s3_log_write(loglevel, __FILE__, __LINE__, "[%s] [ReqID: %s] " fmt "\n", \
+                   __func__, s3_log_get_req_id(requestid), ##__VA_ARGS__);     \
+    }                                                                          \
+    if (loglevel >= S3_LOG_FATAL) {                                            \
+      s3_fatal_handler(1);                                                     \
+    }                                                                          \
   } while (0)
 
 // Note:
@@ -87,24 +103,32 @@ size_t __log_buff_sz();
   } while (0)
 
 // returns timestamp in format: "yyyy:mm:dd hh:mm:ss.uuuuuu"
+// Date and time part is formatted once a second, so is the timezone
+// re-read.
 static inline std::string s3_get_timestamp() {
+  static thread_local time_t date_time_sec = -1;
+  static thread_local char date_time[20];
   struct timespec ts;
-  struct tm result;
-  char date_time[20];
   char timestamp[30];
 
   clock_gettime(CLOCK_REALTIME, &ts);
-  tzset();
-  if (localtime_r(&ts.tv_sec, &result) == NULL) {
-    return std::string();
+  if (ts.tv_sec != date_time_sec) {
+    struct tm result;
+    tzset();
+    if (localtime_r(&ts.tv_sec, &result) == NULL) {
+      return std::string();
+    }
+    strftime(date_time, sizeof(date_time), "%Y:%m:%d %H:%M:%S", &result);
+    date_time_sec = ts.tv_sec;
   }
-  strftime(date_time, sizeof(date_time), "%Y:%m:%d %H:%M:%S", &result);
   snprintf(timestamp, sizeof(timestamp), "%s.%06li", date_time,
            ts.tv_nsec / 1000);
   return std::string(timestamp);
 }
 
 int init_log(char *process_name);
+// Starts asynchronous logging if enabled, must be called after daemonizing.
+int init_async_log();
 void redefine_log_level();
 void fini_log();
 void flushall_log();
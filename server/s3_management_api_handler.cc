@@ -18,9 +18,18 @@
  *
  */
 
+#include <cstring>
+
 #include "s3_action_base.h"
 #include "s3_api_handler.h"
 #include "s3_account_delete_metadata_action.h"
+#include "s3_get_bucket_usage_action.h"
+#include "s3_get_inflight_requests_action.h"
+#include "s3_get_metrics_action.h"
+
+static bool is_path(const char* full_path, const char* path) {
+  return full_path && !std::strcmp(full_path, path);
+}
 
 void S3ManagementAPIHandler::create_action() {
   s3_log(S3_LOG_DEBUG, request_id, "%s Entry", __func__);
@@ -34,6 +43,22 @@ void S3ManagementAPIHandler::create_action() {
           action = std::make_shared<S3AccountDeleteMetadataAction>(request);
           s3_log(S3_LOG_DEBUG, request_id, "S3AccountDeleteMetadataAction");
           break;
+        case S3HttpVerb::GET:
+          if (is_path(request->c_get_full_path(), S3_INFLIGHT_REQUESTS_PATH)) {
+            request->set_action_str("GetInFlightRequests");
+            action = std::make_shared<S3GetInFlightRequestsAction>(request);
+            s3_log(S3_LOG_DEBUG, request_id, "S3GetInFlightRequestsAction");
+          } else if (is_path(request->c_get_full_path(),
+                             S3_BUCKET_USAGE_PATH)) {
+            request->set_action_str("GetBucketUsage");
+            action = std::make_shared<S3GetBucketUsageAction>(request);
+            s3_log(S3_LOG_DEBUG, request_id, "S3GetBucketUsageAction");
+          } else {
+            request->set_action_str("GetMetrics");
+            action = std::make_shared<S3GetMetricsAction>(request);
+            s3_log(S3_LOG_DEBUG, request_id, "S3GetMetricsAction");
+          }
+          break;
         default:
           // should never be here.
           return;
@@ -111,7 +111,13 @@ void S3MempoolManager::free_pools() {
   for (auto &mem_pool : pool_of_mem_pool) {
     s3_log(S3_LOG_DEBUG, "", "Freeing memory pool for unit_size = %zu.\n",
            mem_pool.first);
-    mempool_destroy(&(mem_pool.second));
+    if (mempool_destroy(&(mem_pool.second)) != 0) {
+      // Arena pool with buffers still in use is kept.
+      s3_log(S3_LOG_ERROR, "",
+             "Memory pool for unit_size = %zu is not freed.\n",
+             mem_pool.first);
+      continue;
+    }
     s3_log(S3_LOG_DEBUG, "",
            "Free memory pool successful for unit_size = %zu.\n",
            mem_pool.first);
@@ -181,6 +187,20 @@ size_t S3MempoolManager::get_free_space_for(size_t unit_size) {
   return 0;
 }
 
+std::map<size_t, struct pool_info> S3MempoolManager::get_pools_info() {
+  std::map<size_t, struct pool_info> pools_info;
+  if (!instance) {
+    return pools_info;
+  }
+  for (auto &mem_pool : instance->pool_of_mem_pool) {
+    struct pool_info info = {};
+    if (mempool_getinfo(mem_pool.second, &info) == 0) {
+      pools_info[mem_pool.first] = info;
+    }
+  }
+  return pools_info;
+}
+
 bool S3MempoolManager::free_any_unused() {
   // <non_zero free_space, handle>
   std::map<size_t, MemoryPoolHandle> free_space_map;
@@ -194,25 +214,23 @@ bool S3MempoolManager::free_any_unused() {
     }
   }
 
-  // Request pool with largest free size to free up half the space
-  if (free_space_map.empty()) {
-    return false;
-  } else {
+  // Request pool with largest free size to free up half the space, pools
+  // which can not be downsized (arena backed) are skipped
+  for (auto it = free_space_map.rbegin(); it != free_space_map.rend(); ++it) {
     struct pool_info poolinfo = {0};
-    mempool_getinfo(free_space_map.rbegin()->second, &poolinfo);
+    mempool_getinfo(it->second, &poolinfo);
     s3_log(S3_LOG_DEBUG, "", "Downsizing mempool with unit_size = %zu\n",
            poolinfo.mempool_item_size);
 
-    size_t size_to_reduce = free_space_map.rbegin()->first / 2;
+    size_t size_to_reduce = it->first / 2;
     if (size_to_reduce < poolinfo.mempool_item_size) {
       size_to_reduce = poolinfo.mempool_item_size;
     }
 
-    int rc = mempool_downsize(free_space_map.rbegin()->second, size_to_reduce);
-    if (rc == 0) {
-      return true;
-    } else {
-      return false;
+    int rc = mempool_downsize(it->second, size_to_reduce);
+    if (rc != S3_MEMPOOL_NOT_SUPPORTED) {
+      return rc == 0;
     }
   }
+  return false;
 }
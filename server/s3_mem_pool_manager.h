@@ -98,6 +98,10 @@ class S3MempoolManager {
     return instance;
   }
 
+  // Returns map<unit_size, pool_info> of all pools, empty when the
+  // instance is not created.
+  static std::map<size_t, struct pool_info> get_pools_info();
+
   static void destroy_instance() {
     if (instance) {
       instance->free_pools();
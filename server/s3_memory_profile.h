@@ -24,9 +24,9 @@
 #define __S3_SERVER_S3_MEMORY_PROFILE_H__
 
 class S3MemoryProfile {
-  size_t memory_per_put_request(int layout_id);
-
  public:
+  // Read-ahead window of a PUT object data transfer.
+  size_t memory_per_put_request(int layout_id);
   // Returns true if we have enough memory in mempool to process
   // either put request. Get request we just reject when we run
   // out of memory, memory pool manager is dynamic and free space
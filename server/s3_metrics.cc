@@ -0,0 +1,453 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <unordered_map>
+#include <utility>
+
+#include <event2/event.h>
+
+#include "atexit.h"
+#include "s3_log.h"
+#include "s3_mem_pool_manager.h"
+#include "s3_memory_pool.h"
+#include "s3_metrics.h"
+#include "s3_option.h"
+
+extern S3Option* g_option_instance;
+
+// Percentiles exposed for every latency metric.
+static const std::vector<std::pair<double, const char*>> gs_percentiles = {
+    {50.0, "0.5"}, {90.0, "0.9"}, {99.0, "0.99"}, {99.9, "0.999"}};
+
+const std::vector<uint64_t> S3LatencyMetric::le_boundaries_usec = {
+    500,     1000,    2500,    5000,    10000,   25000,    50000,   100000,
+    250000,  500000,  1000000, 2500000, 5000000, 10000000, 30000000, 60000000};
+
+S3LatencyMetric::S3LatencyMetric()
+    : le_counts(new std::atomic<uint64_t>[le_boundaries_usec.size()]) {
+  for (size_t i = 0; i < le_boundaries_usec.size(); ++i) {
+    le_counts[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+void S3LatencyMetric::observe(uint64_t usec) {
+  count.fetch_add(1, std::memory_order_relaxed);
+  sum_usec.fetch_add(usec, std::memory_order_relaxed);
+  auto it = std::lower_bound(le_boundaries_usec.begin(),
+                             le_boundaries_usec.end(), usec);
+  if (it != le_boundaries_usec.end()) {
+    le_counts[it - le_boundaries_usec.begin()].fetch_add(
+        1, std::memory_order_relaxed);
+  }
+  windows[current_window.load(std::memory_order_relaxed)].record(usec);
+}
+
+void S3LatencyMetric::rotate_window() {
+  unsigned next = 1 - current_window.load(std::memory_order_relaxed);
+  windows[next].reset();
+  current_window.store(next, std::memory_order_relaxed);
+}
+
+std::vector<uint64_t> S3LatencyMetric::get_le_counts() const {
+  std::vector<uint64_t> cumulative(le_boundaries_usec.size());
+  uint64_t total = 0;
+  for (size_t i = 0; i < le_boundaries_usec.size(); ++i) {
+    total += le_counts[i].load(std::memory_order_relaxed);
+    cumulative[i] = total;
+  }
+  return cumulative;
+}
+
+uint64_t S3LatencyMetric::get_percentile_usec(double percentile) const {
+  std::vector<uint64_t> counts;
+  windows[0].snapshot(&counts);
+  windows[1].snapshot(&counts);
+  return S3LatencyHistogram::value_at_percentile(counts, percentile);
+}
+
+namespace {
+
+// Metrics of one S3Metrics instance which this thread has recorded into.
+struct S3MetricsThreadCache {
+  uint64_t instance_id = 0;
+  std::unordered_map<std::string, S3LatencyMetric*> requests;
+  // Indexed by success of the operation.
+  std::unordered_map<std::string, S3LatencyMetric*> motr_ops[2];
+};
+
+thread_local S3MetricsThreadCache tl_metrics_cache;
+std::atomic<uint64_t> gs_metrics_instance_ids{0};
+
+S3MetricsThreadCache& get_thread_cache(uint64_t instance_id) {
+  S3MetricsThreadCache& cache = tl_metrics_cache;
+  if (cache.instance_id != instance_id) {
+    cache.requests.clear();
+    cache.motr_ops[0].clear();
+    cache.motr_ops[1].clear();
+    cache.instance_id = instance_id;
+  }
+  return cache;
+}
+
+}  // namespace
+
+S3Metrics::S3Metrics(std::shared_ptr<EventInterface> event_obj_ptr,
+                     evbase_t* evbase_)
+    : RecurringEventBase(std::move(event_obj_ptr), evbase_),
+      instance_id(++gs_metrics_instance_ids) {}
+
+S3LatencyMetric* S3Metrics::get_request_metric(const std::string& api) {
+  S3MetricsThreadCache& cache = get_thread_cache(instance_id);
+  auto it = cache.requests.find(api);
+  if (it != cache.requests.end()) {
+    return it->second;
+  }
+  S3LatencyMetric* cached;
+  {
+    std::lock_guard<std::mutex> guard(metrics_lock);
+    auto& metric = request_latency[api];
+    if (!metric) {
+      metric.reset(new S3LatencyMetric());
+    }
+    cached = metric.get();
+  }
+  cache.requests.emplace(api, cached);
+  return cached;
+}
+
+S3LatencyMetric* S3Metrics::get_motr_op_metric(const std::string& op,
+                                               bool success) {
+  auto& ops = get_thread_cache(instance_id).motr_ops[success];
+  auto it = ops.find(op);
+  if (it != ops.end()) {
+    return it->second;
+  }
+  S3LatencyMetric* cached;
+  {
+    std::lock_guard<std::mutex> guard(metrics_lock);
+    auto& metric = motr_op_latency[std::make_pair(
+        op, std::string(success ? "success" : "failed"))];
+    if (!metric) {
+      metric.reset(new S3LatencyMetric());
+    }
+    cached = metric.get();
+  }
+  ops.emplace(op, cached);
+  return cached;
+}
+
+void S3Metrics::request_started() { requests_in_flight++; }
+
+void S3Metrics::request_finished(const std::string& api, int64_t usec) {
+  requests_in_flight--;
+  if (usec >= 0) {
+    get_request_metric(api)->observe(usec);
+  }
+}
+
+void S3Metrics::motr_op_started() { motr_ops_in_flight++; }
+
+void S3Metrics::motr_op_finished(const std::string& op, bool success,
+                                 int64_t usec) {
+  motr_ops_in_flight--;
+  if (usec >= 0) {
+    get_motr_op_metric(op, success)->observe(usec);
+  }
+}
+
+void S3Metrics::add_collector(Collector collector) {
+  collectors.push_back(std::move(collector));
+}
+
+void S3Metrics::rotate_windows() {
+  std::lock_guard<std::mutex> guard(metrics_lock);
+  for (auto& it : request_latency) {
+    it.second->rotate_window();
+  }
+  for (auto& it : motr_op_latency) {
+    it.second->rotate_window();
+  }
+}
+
+void S3Metrics::action_callback(void) noexcept { rotate_windows(); }
+
+std::string S3Metrics::escape_label_value(const std::string& value) {
+  std::string escaped;
+  for (char c : value) {
+    if (c == '\\' || c == '"') {
+      escaped += '\\';
+      escaped += c;
+    } else if (c == '\n') {
+      escaped += "\\n";
+    } else {
+      escaped += c;
+    }
+  }
+  return escaped;
+}
+
+std::string S3Metrics::usec_to_seconds_str(uint64_t usec) {
+  char buf[32];
+  snprintf(buf, sizeof(buf), "%" PRIu64 ".%06" PRIu64, usec / 1000000,
+           usec % 1000000);
+  return buf;
+}
+
+void S3Metrics::render_family(std::string& out, const std::string& name,
+                              const std::string& type, const std::string& help,
+                              const std::string& unit) {
+  out += "# TYPE " + name + " " + type + "\n";
+  if (!unit.empty()) {
+    out += "# UNIT " + name + " " + unit + "\n";
+  }
+  out += "# HELP " + name + " " + help + "\n";
+}
+
+void S3Metrics::render_sample(std::string& out, const std::string& name,
+                              const std::string& labels,
+                              const std::string& value) {
+  out += name;
+  if (!labels.empty()) {
+    out += "{" + labels + "}";
+  }
+  out += " " + value + "\n";
+}
+
+// Renders histogram family 'name'_duration_seconds and summary family
+// 'name'_latency_seconds for all 'metrics' (labels -> metric).
+static void render_latency(
+    std::string& out, const std::string& name, const std::string& what,
+    const std::vector<std::pair<std::string, const S3LatencyMetric*>>&
+        metrics) {
+  const std::string histogram = name + "_duration_seconds";
+  S3Metrics::render_family(out, histogram, "histogram",
+                           "Duration of " + what + ".", "seconds");
+  for (auto& it : metrics) {
+    const std::string& labels = it.first;
+    std::vector<uint64_t> le_counts = it.second->get_le_counts();
+    for (size_t i = 0; i < le_counts.size(); ++i) {
+      char le[32];
+      snprintf(le, sizeof(le), "%g",
+               S3LatencyMetric::le_boundaries_usec[i] / 1000000.0);
+      S3Metrics::render_sample(out, histogram + "_bucket",
+                               labels + ",le=\"" + le + "\"",
+                               std::to_string(le_counts[i]));
+    }
+    // Buckets and count are updated independently, keep them consistent.
+    uint64_t count = std::max(it.second->get_count(),
+                              le_counts.empty() ? 0 : le_counts.back());
+    S3Metrics::render_sample(out, histogram + "_bucket",
+                             labels + ",le=\"+Inf\"", std::to_string(count));
+    S3Metrics::render_sample(out, histogram + "_count", labels,
+                             std::to_string(count));
+    S3Metrics::render_sample(
+        out, histogram + "_sum", labels,
+        S3Metrics::usec_to_seconds_str(it.second->get_sum_usec()));
+  }
+
+  const std::string summary = name + "_latency_seconds";
+  S3Metrics::render_family(out, summary, "summary",
+                           "Recent percentiles of duration of " + what + ".",
+                           "seconds");
+  for (auto& it : metrics) {
+    for (auto& percentile : gs_percentiles) {
+      S3Metrics::render_sample(
+          out, summary, it.first + ",quantile=\"" + percentile.second + "\"",
+          S3Metrics::usec_to_seconds_str(
+              it.second->get_percentile_usec(percentile.first)));
+    }
+  }
+}
+
+std::string S3Metrics::render() const {
+  std::string out;
+
+  render_family(out, "s3_requests_in_flight", "gauge",
+                "S3 API requests being processed.");
+  render_sample(out, "s3_requests_in_flight", "",
+                std::to_string(requests_in_flight.load()));
+  render_family(out, "s3_motr_ops_in_flight", "gauge",
+                "Motr operations launched and not completed yet.");
+  render_sample(out, "s3_motr_ops_in_flight", "",
+                std::to_string(motr_ops_in_flight.load()));
+
+  {
+    std::lock_guard<std::mutex> guard(metrics_lock);
+    std::vector<std::pair<std::string, const S3LatencyMetric*>> metrics;
+    for (auto& it : request_latency) {
+      metrics.emplace_back("api=\"" + escape_label_value(it.first) + "\"",
+                           it.second.get());
+    }
+    render_latency(out, "s3_request", "S3 API requests", metrics);
+
+    metrics.clear();
+    for (auto& it : motr_op_latency) {
+      metrics.emplace_back("op=\"" + escape_label_value(it.first.first) +
+                               "\",status=\"" + it.first.second + "\"",
+                           it.second.get());
+    }
+    render_latency(out, "s3_motr_op", "Motr operations", metrics);
+  }
+
+  for (auto& collector : collectors) {
+    collector(out);
+  }
+  out += "# EOF\n";
+  return out;
+}
+
+// Occupancy of libevent and Motr read memory pools.
+static void collect_mempool_metrics(std::string& out) {
+  struct PoolMetrics {
+    std::string labels;
+    struct pool_info info;
+  };
+  std::vector<PoolMetrics> pools;
+
+  struct pool_info info = {};
+  if (event_mempool_getinfo(&info) == 0) {
+    pools.push_back({"pool=\"libevent\",unit_size=\"" +
+                         std::to_string(info.mempool_item_size) + "\"",
+                     info});
+  }
+  for (auto& it : S3MempoolManager::get_pools_info()) {
+    pools.push_back(
+        {"pool=\"motr_read\",unit_size=\"" + std::to_string(it.first) + "\"",
+         it.second});
+  }
+
+  S3Metrics::render_family(out, "s3_mempool_buffers", "gauge",
+                           "Buffers allocated by memory pools, by state.");
+  for (auto& pool : pools) {
+    S3Metrics::render_sample(out, "s3_mempool_buffers",
+                             pool.labels + ",state=\"used\"",
+                             std::to_string(pool.info.number_of_bufs_shared));
+    S3Metrics::render_sample(out, "s3_mempool_buffers",
+                             pool.labels + ",state=\"free\"",
+                             std::to_string(pool.info.free_bufs_in_pool));
+    S3Metrics::render_sample(out, "s3_mempool_buffers",
+                             pool.labels + ",state=\"cached\"",
+                             std::to_string(pool.info.bufs_in_thread_caches));
+  }
+  S3Metrics::render_family(out, "s3_mempool_bytes", "gauge",
+                           "Memory allocated by memory pools, by state.",
+                           "bytes");
+  for (auto& pool : pools) {
+    S3Metrics::render_sample(
+        out, "s3_mempool_bytes", pool.labels + ",state=\"used\"",
+        std::to_string(pool.info.number_of_bufs_shared *
+                       pool.info.mempool_item_size));
+    S3Metrics::render_sample(out, "s3_mempool_bytes",
+                             pool.labels + ",state=\"free\"",
+                             std::to_string(pool.info.free_bufs_in_pool *
+                                            pool.info.mempool_item_size));
+    S3Metrics::render_sample(out, "s3_mempool_bytes",
+                             pool.labels + ",state=\"cached\"",
+                             std::to_string(pool.info.bufs_in_thread_caches *
+                                            pool.info.mempool_item_size));
+  }
+}
+
+// Messages lost by asynchronous logging under overload.
+static void collect_log_metrics(std::string& out) {
+  S3Metrics::render_family(out, "s3_log_messages_dropped", "counter",
+                           "Log messages dropped under overload.");
+  S3Metrics::render_sample(out, "s3_log_messages_dropped_total",
+                           "reason=\"overflow\"",
+                           std::to_string(S3AsyncLog::get_dropped_count()));
+  S3Metrics::render_sample(
+      out, "s3_log_messages_dropped_total", "reason=\"sampled\"",
+      std::to_string(S3AsyncLog::get_sampled_out_count()));
+}
+
+static std::shared_ptr<S3Metrics> gs_metrics;
+
+int s3_metrics_init(evbase_t* evbase) {
+  struct timeval tv;
+  if (!g_option_instance->is_metrics_enabled()) {
+    return 0;
+  }
+  s3_log(S3_LOG_INFO, "", "%s Entry", __func__);
+
+  AtExit call_fini([]() { s3_metrics_fini(); });
+
+  if (!evbase) {
+    return -EINVAL;
+  }
+  gs_metrics =
+      std::make_shared<S3Metrics>(std::make_shared<EventWrapper>(), evbase);
+  if (!gs_metrics) {
+    return -ENOMEM;
+  }
+  gs_metrics->add_collector(collect_mempool_metrics);
+  gs_metrics->add_collector(collect_log_metrics);
+
+  tv.tv_sec = g_option_instance->get_metrics_quantile_window_sec();
+  tv.tv_usec = 0;
+  int rc = gs_metrics->add_evtimer(tv);
+  if (rc != 0) {
+    return rc;
+  }
+
+  call_fini.cancel();
+
+  return 0;
+}
+
+void s3_metrics_fini() {
+  if (!gs_metrics) {
+    return;
+  }
+  s3_log(S3_LOG_INFO, "", "%s Entry", __func__);
+  gs_metrics->del_evtimer();
+  gs_metrics.reset();
+}
+
+std::shared_ptr<S3Metrics> s3_metrics() { return gs_metrics; }
+
+void s3_metrics_request_started() {
+  if (gs_metrics) {
+    gs_metrics->request_started();
+  }
+}
+
+void s3_metrics_request_finished(const std::string& api, int64_t usec) {
+  if (gs_metrics) {
+    gs_metrics->request_finished(api, usec);
+  }
+}
+
+void s3_metrics_motr_op_started() {
+  if (gs_metrics) {
+    gs_metrics->motr_op_started();
+  }
+}
+
+void s3_metrics_motr_op_finished(const std::string& op, bool success,
+                                 int64_t usec) {
+  if (gs_metrics) {
+    gs_metrics->motr_op_finished(op, success, usec);
+  }
+}
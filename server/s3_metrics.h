@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+#pragma once
+
+#ifndef __S3_SERVER_S3_METRICS_H__
+#define __S3_SERVER_S3_METRICS_H__
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "event_utils.h"
+#include "s3_latency_histogram.h"
+
+#define S3_METRICS_CONTENT_TYPE \
+  "application/openmetrics-text; version=1.0.0; charset=utf-8"
+
+// Latency of one kind of operation.
+//
+// Cumulative counts are exposed as a Prometheus histogram with fixed bucket
+// boundaries. Percentiles are computed from HDR histograms of the current and
+// the previous time window, so they reflect recent latency only.
+class S3LatencyMetric {
+ public:
+  // Bucket boundaries (usec) of the exposed histogram, +Inf is implied.
+  static const std::vector<uint64_t> le_boundaries_usec;
+
+  S3LatencyMetric();
+
+  void observe(uint64_t usec);
+  // Starts a new percentile window, the oldest one is dropped.
+  void rotate_window();
+
+  uint64_t get_count() const { return count.load(std::memory_order_relaxed); }
+  uint64_t get_sum_usec() const {
+    return sum_usec.load(std::memory_order_relaxed);
+  }
+  // Cumulative count of observations <= le_boundaries_usec[i].
+  std::vector<uint64_t> get_le_counts() const;
+  // Percentile over the last one to two windows, 0 if nothing was observed.
+  uint64_t get_percentile_usec(double percentile) const;
+
+ private:
+  std::unique_ptr<std::atomic<uint64_t>[]> le_counts;
+  std::atomic<uint64_t> count{0};
+  std::atomic<uint64_t> sum_usec{0};
+  S3LatencyHistogram windows[2];
+  std::atomic<unsigned> current_window{0};
+};
+
+// In-process metrics registry, rendered as OpenMetrics text.
+//
+// Tracks latency of S3 API requests per operation, latency of Motr
+// operations per operation type and outcome, and requests/operations in
+// flight. Other components can contribute gauges through collectors which
+// are called at render time (e.g. memory pool occupancy).
+class S3Metrics : public RecurringEventBase {
+ public:
+  // Appends OpenMetrics text of one or more metric families to 'out'.
+  typedef std::function<void(std::string& out)> Collector;
+
+ private:
+  // Guards creation of latency metrics, once created they are never removed
+  // and recording into them needs no lock.  Each thread caches pointers to
+  // metrics it has recorded into, so the lock is taken once per thread and
+  // metric, not per observation.
+  mutable std::mutex metrics_lock;
+  // Tells instances apart in the per-thread caches.
+  const uint64_t instance_id;
+  // map<api, metric>
+  std::map<std::string, std::unique_ptr<S3LatencyMetric>> request_latency;
+  // map<pair<op, status>, metric>
+  std::map<std::pair<std::string, std::string>,
+           std::unique_ptr<S3LatencyMetric>> motr_op_latency;
+
+  std::atomic<int64_t> requests_in_flight{0};
+  std::atomic<int64_t> motr_ops_in_flight{0};
+
+  std::vector<Collector> collectors;
+
+  S3LatencyMetric* get_request_metric(const std::string& api);
+  S3LatencyMetric* get_motr_op_metric(const std::string& op, bool success);
+
+ public:
+  S3Metrics(std::shared_ptr<EventInterface> event_obj_ptr = nullptr,
+            evbase_t* evbase_ = nullptr);
+
+  void request_started();
+  // 'usec' < 0 when duration is not known, only in-flight gauge is updated.
+  void request_finished(const std::string& api, int64_t usec);
+  void motr_op_started();
+  void motr_op_finished(const std::string& op, bool success, int64_t usec);
+
+  void add_collector(Collector collector);
+
+  // Starts new percentile window for all metrics.
+  void rotate_windows();
+  virtual void action_callback(void) noexcept;
+
+  std::string render() const;
+
+  int64_t get_requests_in_flight() const { return requests_in_flight; }
+  int64_t get_motr_ops_in_flight() const { return motr_ops_in_flight; }
+
+  // Helpers for collectors, write single family header/sample line.
+  static void render_family(std::string& out, const std::string& name,
+                            const std::string& type, const std::string& help,
+                            const std::string& unit = "");
+  static void render_sample(std::string& out, const std::string& name,
+                            const std::string& labels,
+                            const std::string& value);
+  static std::string usec_to_seconds_str(uint64_t usec);
+  static std::string escape_label_value(const std::string& value);
+};
+
+int s3_metrics_init(evbase_t* evbase);
+void s3_metrics_fini();
+// Returns nullptr when metrics are disabled.
+std::shared_ptr<S3Metrics> s3_metrics();
+
+// Helpers, no-op when metrics are disabled.
+void s3_metrics_request_started();
+void s3_metrics_request_finished(const std::string& api, int64_t usec);
+void s3_metrics_motr_op_started();
+void s3_metrics_motr_op_finished(const std::string& op, bool success,
+                                 int64_t usec);
+
+#endif
@@ -75,7 +75,8 @@ struct s3_motr_idx_op_context {
 struct s3_motr_kvs_op_context {
   struct m0_bufvec *keys;
   struct m0_bufvec *values;
-  int *rcs;  // per key return status array
+  int *rcs;            // per key return status array
+  unsigned int flags;  // m0_op_idx_flags passed to m0_idx_op
 };
 
 struct s3_motr_obj_context *create_obj_context(size_t count);
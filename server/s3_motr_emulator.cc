@@ -0,0 +1,703 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <initializer_list>
+
+#include "s3_log.h"
+#include "s3_motr_emulator.h"
+#include "s3_option.h"
+
+// Operation, the m0_op part is what callers see.
+struct S3MotrEmulatorOp : public m0_op {
+  int entity_type = 0;
+  struct m0_uint128 entity_id = {0, 0};
+  struct m0_indexvec *ext = nullptr;
+  struct m0_bufvec *data = nullptr;
+  struct m0_bufvec *keys = nullptr;
+  struct m0_bufvec *vals = nullptr;
+  int *rcs = nullptr;
+  unsigned flags = 0;
+  std::chrono::steady_clock::time_point due;
+  // Launched and not yet completed.
+  bool in_flight = false;
+  // Taken by a worker, which uses the buffers and calls the callbacks.
+  bool executing = false;
+  std::thread::id executor;
+  // Freed by its owner before a worker took it, like m0_op_cancel() it is
+  // failed with -ECANCELED without touching the buffers or callbacks.
+  bool cancelled = false;
+  bool free_when_done = false;
+};
+
+bool S3MotrEmulator::DueLater::operator()(const S3MotrEmulatorOp *a,
+                                           const S3MotrEmulatorOp *b) const {
+  return a->due > b->due;
+}
+
+static const uint64_t chunk_size = 1 << 20;
+
+struct S3MotrEmulator::Object {
+  std::mutex mutex;
+  // Sparse file, or -1 when the object is in memory.
+  int fd = -1;
+  // Chunks of in-memory object which have been written, by index.
+  std::map<uint64_t, std::unique_ptr<char[]>> chunks;
+
+  ~Object() {
+    if (fd >= 0) {
+      close(fd);
+    }
+  }
+};
+
+// Calls fn(offset, buffer, length) for every piece where an extent of 'ext'
+// overlaps a buffer of 'data', in order.  Stops at the first error.
+template <typename F>
+static int for_each_piece(const struct m0_indexvec *ext,
+                          const struct m0_bufvec *data, F fn) {
+  uint32_t e = 0, b = 0;
+  uint64_t e_off = 0, b_off = 0;
+  while (e < ext->iv_vec.v_nr && b < data->ov_vec.v_nr) {
+    const uint64_t len = std::min(ext->iv_vec.v_count[e] - e_off,
+                                  data->ov_vec.v_count[b] - b_off);
+    const int rc =
+        fn(ext->iv_index[e] + e_off, (char *)data->ov_buf[b] + b_off, len);
+    if (rc != 0) {
+      return rc;
+    }
+    e_off += len;
+    b_off += len;
+    if (e_off == ext->iv_vec.v_count[e]) {
+      ++e;
+      e_off = 0;
+    }
+    if (b_off == data->ov_vec.v_count[b]) {
+      ++b;
+      b_off = 0;
+    }
+  }
+  return 0;
+}
+
+static void *copy_buf(const std::string &value, m0_bcount_t *count) {
+  *count = value.size();
+  void *buf = malloc(value.size() ? value.size() : 1);
+  memcpy(buf, value.data(), value.size());
+  return buf;
+}
+
+S3MotrEmulator::S3MotrEmulator(unsigned threads, unsigned latency_usec_,
+                               unsigned bandwidth_mbps,
+                               const std::string &dir_)
+    : dir(dir_),
+      latency_usec(latency_usec_),
+      bytes_per_usec(bandwidth_mbps * 1048576.0 / 1000000),
+      device_free_time(clock::now()),
+      ufid_hi((uint64_t)time(nullptr)),
+      ufid_lo(0),
+      op_id(0) {
+  for (unsigned i = 0; i < std::max(threads, 1u); ++i) {
+    workers.emplace_back(&S3MotrEmulator::worker, this);
+  }
+}
+
+S3MotrEmulator::~S3MotrEmulator() {
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    stopping = true;
+  }
+  queue_cv.notify_all();
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  // Operations which have not completed are failed without callbacks, as
+  // their owners are being destroyed.
+  while (!queue.empty()) {
+    S3MotrEmulatorOp *op = queue.top();
+    queue.pop();
+    std::lock_guard<std::mutex> lock(ops_mutex);
+    op->op_rc = -ECANCELED;
+    op->op_sm.sm_state = M0_OS_FAILED;
+    op->in_flight = false;
+    if (op->free_when_done) {
+      delete op;
+    }
+  }
+}
+
+std::string S3MotrEmulator::object_path(const struct m0_uint128 &id) const {
+  char name[40];
+  snprintf(name, sizeof(name), "%016" PRIx64 "-%016" PRIx64, id.u_hi,
+           id.u_lo);
+  return dir + "/" + name;
+}
+
+std::shared_ptr<S3MotrEmulator::Object> S3MotrEmulator::find_object(
+    const struct m0_uint128 &id) {
+  std::lock_guard<std::mutex> lock(objects_mutex);
+  auto it = objects.find(id);
+  return it == objects.end() ? nullptr : it->second;
+}
+
+int S3MotrEmulator::create_entity(int type, const struct m0_uint128 &id) {
+  if (type == M0_ET_IDX) {
+    std::lock_guard<std::mutex> lock(indices_mutex);
+    return indices.emplace(id, KeyVal()).second ? 0 : -EEXIST;
+  }
+  std::lock_guard<std::mutex> lock(objects_mutex);
+  if (objects.count(id)) {
+    return -EEXIST;
+  }
+  std::shared_ptr<Object> object = std::make_shared<Object>();
+  if (!dir.empty()) {
+    object->fd =
+        open(object_path(id).c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (object->fd < 0) {
+      const int rc = -errno;
+      s3_log(S3_LOG_ERROR, "", "Cannot create %s: %s\n",
+             object_path(id).c_str(), strerror(errno));
+      return rc;
+    }
+  }
+  objects[id] = object;
+  return 0;
+}
+
+int S3MotrEmulator::open_entity(int type, const struct m0_uint128 &id) {
+  if (type == M0_ET_IDX) {
+    std::lock_guard<std::mutex> lock(indices_mutex);
+    return indices.count(id) ? 0 : -ENOENT;
+  }
+  return find_object(id) ? 0 : -ENOENT;
+}
+
+int S3MotrEmulator::delete_entity(int type, const struct m0_uint128 &id) {
+  if (type == M0_ET_IDX) {
+    std::lock_guard<std::mutex> lock(indices_mutex);
+    return indices.erase(id) ? 0 : -ENOENT;
+  }
+  std::lock_guard<std::mutex> lock(objects_mutex);
+  if (!objects.erase(id)) {
+    return -ENOENT;
+  }
+  // Reads and writes in flight still have the file open.
+  if (!dir.empty()) {
+    unlink(object_path(id).c_str());
+  }
+  return 0;
+}
+
+int S3MotrEmulator::write_object(S3MotrEmulatorOp *op) {
+  std::shared_ptr<Object> object = find_object(op->entity_id);
+  if (!object) {
+    return -ENOENT;
+  }
+  std::lock_guard<std::mutex> lock(object->mutex);
+  return for_each_piece(op->ext, op->data, [&object](uint64_t offset,
+                                                     char *buf, uint64_t len) {
+    if (object->fd >= 0) {
+      while (len > 0) {
+        const ssize_t written = pwrite(object->fd, buf, len, offset);
+        if (written < 0) {
+          if (errno == EINTR) {
+            continue;
+          }
+          return -errno;
+        }
+        buf += written;
+        offset += written;
+        len -= written;
+      }
+      return 0;
+    }
+    while (len > 0) {
+      const uint64_t in_chunk = offset % chunk_size;
+      const uint64_t n = std::min(len, chunk_size - in_chunk);
+      std::unique_ptr<char[]> &chunk = object->chunks[offset / chunk_size];
+      if (!chunk) {
+        chunk.reset(new char[chunk_size]());
+      }
+      memcpy(chunk.get() + in_chunk, buf, n);
+      buf += n;
+      offset += n;
+      len -= n;
+    }
+    return 0;
+  });
+}
+
+int S3MotrEmulator::read_object(S3MotrEmulatorOp *op) {
+  std::shared_ptr<Object> object = find_object(op->entity_id);
+  if (!object) {
+    return -ENOENT;
+  }
+  std::lock_guard<std::mutex> lock(object->mutex);
+  // Ranges which have never been written read as zeros.
+  return for_each_piece(op->ext, op->data, [&object](uint64_t offset,
+                                                     char *buf, uint64_t len) {
+    if (object->fd >= 0) {
+      while (len > 0) {
+        const ssize_t n = pread(object->fd, buf, len, offset);
+        if (n < 0) {
+          if (errno == EINTR) {
+            continue;
+          }
+          return -errno;
+        }
+        if (n == 0) {
+          memset(buf, 0, len);
+          break;
+        }
+        buf += n;
+        offset += n;
+        len -= n;
+      }
+      return 0;
+    }
+    while (len > 0) {
+      const uint64_t in_chunk = offset % chunk_size;
+      const uint64_t n = std::min(len, chunk_size - in_chunk);
+      auto it = object->chunks.find(offset / chunk_size);
+      if (it == object->chunks.end()) {
+        memset(buf, 0, n);
+      } else {
+        memcpy(buf, it->second.get() + in_chunk, n);
+      }
+      buf += n;
+      offset += n;
+      len -= n;
+    }
+    return 0;
+  });
+}
+
+// Follows Motr DIX: the index must exist, per key results are in 'rcs'.
+// Returned keys and values are allocated with malloc() and are freed by the
+// caller.
+int S3MotrEmulator::index_op(S3MotrEmulatorOp *op) {
+  std::lock_guard<std::mutex> lock(indices_mutex);
+  auto index = indices.find(op->entity_id);
+  if (index == indices.end()) {
+    return -ENOENT;
+  }
+  KeyVal &kv = index->second;
+  struct m0_bufvec *keys = op->keys;
+  struct m0_bufvec *vals = op->vals;
+
+  switch (op->op_code) {
+    case M0_IC_LOOKUP:
+      return 0;
+
+    case M0_IC_GET:
+      for (uint32_t i = 0; i < keys->ov_vec.v_nr; ++i) {
+        auto it = kv.find(std::string((const char *)keys->ov_buf[i],
+                                      keys->ov_vec.v_count[i]));
+        if (it == kv.end()) {
+          op->rcs[i] = -ENOENT;
+          continue;
+        }
+        vals->ov_buf[i] = copy_buf(it->second, &vals->ov_vec.v_count[i]);
+        op->rcs[i] = 0;
+      }
+      return 0;
+
+    case M0_IC_PUT:
+      for (uint32_t i = 0; i < keys->ov_vec.v_nr; ++i) {
+        std::string key((const char *)keys->ov_buf[i],
+                        keys->ov_vec.v_count[i]);
+        std::string value((const char *)vals->ov_buf[i],
+                          vals->ov_vec.v_count[i]);
+        if (!(op->flags & M0_OIF_OVERWRITE) && kv.count(key)) {
+          op->rcs[i] = -EEXIST;
+          continue;
+        }
+        kv[key] = std::move(value);
+        op->rcs[i] = 0;
+      }
+      return 0;
+
+    case M0_IC_DEL:
+      for (uint32_t i = 0; i < keys->ov_vec.v_nr; ++i) {
+        op->rcs[i] = kv.erase(std::string((const char *)keys->ov_buf[i],
+                                          keys->ov_vec.v_count[i]))
+                         ? 0
+                         : -ENOENT;
+      }
+      return 0;
+
+    case M0_IC_NEXT: {
+      auto it = kv.begin();
+      if (keys->ov_vec.v_count[0] > 0) {
+        std::string start_key((const char *)keys->ov_buf[0],
+                              keys->ov_vec.v_count[0]);
+        // The start key is owned by the caller.
+        keys->ov_buf[0] = nullptr;
+        keys->ov_vec.v_count[0] = 0;
+        it = kv.lower_bound(start_key);
+        if ((op->flags & M0_OIF_EXCLUDE_START_KEY) && it != kv.end() &&
+            it->first == start_key) {
+          ++it;
+        }
+        if (it == kv.end()) {
+          return -ENOENT;
+        }
+      }
+      for (uint32_t i = 0; i < keys->ov_vec.v_nr; ++i, ++it) {
+        if (it == kv.end()) {
+          for (; i < keys->ov_vec.v_nr; ++i) {
+            op->rcs[i] = -ENOENT;
+          }
+          break;
+        }
+        keys->ov_buf[i] = copy_buf(it->first, &keys->ov_vec.v_count[i]);
+        vals->ov_buf[i] = copy_buf(it->second, &vals->ov_vec.v_count[i]);
+        op->rcs[i] = 0;
+      }
+      return 0;
+    }
+  }
+  return -EINVAL;
+}
+
+void S3MotrEmulator::execute(S3MotrEmulatorOp *op) {
+  {
+    std::lock_guard<std::mutex> lock(ops_mutex);
+    if (op->cancelled) {
+      s3_log(S3_LOG_DEBUG, "", "Emulated Motr op %" PRIu64 " cancelled\n",
+             op->op_sm.sm_id);
+      op->op_rc = -ECANCELED;
+      op->op_sm.sm_state = M0_OS_FAILED;
+      op->in_flight = false;
+      delete op;
+      return;
+    }
+    op->executing = true;
+    op->executor = std::this_thread::get_id();
+  }
+  int rc;
+  switch (op->op_code) {
+    case M0_EO_CREATE:
+      rc = create_entity(op->entity_type, op->entity_id);
+      break;
+    case M0_EO_OPEN:
+      rc = open_entity(op->entity_type, op->entity_id);
+      break;
+    case M0_EO_DELETE:
+      rc = delete_entity(op->entity_type, op->entity_id);
+      break;
+    case M0_EO_SYNC:
+      // Everything is stable once it is done.
+      rc = 0;
+      break;
+    case M0_OC_WRITE:
+      rc = write_object(op);
+      break;
+    case M0_OC_READ:
+      rc = read_object(op);
+      break;
+    default:
+      rc = index_op(op);
+  }
+  complete(op, rc);
+}
+
+void S3MotrEmulator::complete(S3MotrEmulatorOp *op, int rc) {
+  s3_log(S3_LOG_DEBUG, "", "Emulated Motr op %" PRIu64 " code %u rc %d\n",
+         op->op_sm.sm_id, op->op_code, rc);
+  op->op_rc = rc;
+  // Callbacks run before the state changes, so motr_op_wait() returns after
+  // them as with Motr.
+  const struct m0_op_ops *cbs = op->op_cbs;
+  if (cbs) {
+    if (rc == 0) {
+      if (cbs->oop_executed) {
+        cbs->oop_executed(op);
+      }
+      if (cbs->oop_stable) {
+        cbs->oop_stable(op);
+      }
+    } else if (cbs->oop_failed) {
+      cbs->oop_failed(op);
+    }
+  }
+  {
+    std::lock_guard<std::mutex> lock(ops_mutex);
+    op->op_sm.sm_state = rc == 0 ? M0_OS_STABLE : M0_OS_FAILED;
+    op->in_flight = false;
+    op->executing = false;
+    if (op->free_when_done) {
+      delete op;
+    }
+  }
+  ops_cv.notify_all();
+}
+
+void S3MotrEmulator::worker() {
+  std::unique_lock<std::mutex> lock(queue_mutex);
+  while (!stopping) {
+    if (queue.empty()) {
+      queue_cv.wait(lock);
+      continue;
+    }
+    S3MotrEmulatorOp *op = queue.top();
+    // Copied, another worker may complete the operation meanwhile.
+    const clock::time_point due = op->due;
+    if (clock::now() < due) {
+      // Also woken up by launch of an operation which is due earlier.
+      queue_cv.wait_until(lock, due);
+      continue;
+    }
+    queue.pop();
+    lock.unlock();
+    execute(op);
+    lock.lock();
+  }
+}
+
+S3MotrEmulatorOp *S3MotrEmulator::new_op(struct m0_entity *entity,
+                                         unsigned opcode) {
+  S3MotrEmulatorOp *op = new S3MotrEmulatorOp();
+  op->op_code = opcode;
+  op->op_sm.sm_state = M0_OS_INITIALISED;
+  op->op_sm.sm_id = ++op_id;
+  op->op_entity = entity;
+  if (entity) {
+    op->entity_type = entity->en_type;
+    op->entity_id = entity->en_id;
+  }
+  return op;
+}
+
+int S3MotrEmulator::create_index(const struct m0_uint128 &id) {
+  return create_entity(M0_ET_IDX, id);
+}
+
+void S3MotrEmulator::op_free(struct m0_op *op) {
+  if (!op) {
+    return;
+  }
+  S3MotrEmulatorOp *emulated_op = static_cast<S3MotrEmulatorOp *>(op);
+  std::unique_lock<std::mutex> lock(ops_mutex);
+  if (emulated_op->in_flight && !emulated_op->executing) {
+    // Still queued, the worker which takes it only frees it.
+    emulated_op->cancelled = true;
+    emulated_op->free_when_done = true;
+    return;
+  }
+  if (emulated_op->executing &&
+      emulated_op->executor == std::this_thread::get_id()) {
+    // Freed by its own callback, buffers are not used after callbacks.
+    emulated_op->free_when_done = true;
+    return;
+  }
+  // The owner frees buffers of the operation next, so wait for the worker
+  // to be done with them.
+  ops_cv.wait(lock, [emulated_op]() { return !emulated_op->in_flight; });
+  delete emulated_op;
+}
+
+void S3MotrEmulator::motr_idx_init(struct m0_idx *idx, struct m0_realm *parent,
+                                   const struct m0_uint128 *id) {
+  memset(idx, 0, sizeof(*idx));
+  idx->in_entity.en_type = M0_ET_IDX;
+  idx->in_entity.en_id = *id;
+  idx->in_entity.en_realm = parent;
+}
+
+// Entities are not registered anywhere, en_sm.sm_state stays 0 so teardown
+// does not finalise them.
+void S3MotrEmulator::motr_idx_fini(struct m0_idx *) {}
+
+int S3MotrEmulator::motr_sync_op_init(struct m0_op **sync_op) {
+  *sync_op = new_op(nullptr, M0_EO_SYNC);
+  return 0;
+}
+
+int S3MotrEmulator::motr_sync_entity_add(struct m0_op *, struct m0_entity *) {
+  return 0;
+}
+
+int S3MotrEmulator::motr_sync_op_add(struct m0_op *, struct m0_op *) {
+  return 0;
+}
+
+void S3MotrEmulator::motr_obj_init(struct m0_obj *obj, struct m0_realm *parent,
+                                   const struct m0_uint128 *id,
+                                   int layout_id) {
+  memset(obj, 0, sizeof(*obj));
+  obj->ob_entity.en_type = M0_ET_OBJ;
+  obj->ob_entity.en_id = *id;
+  obj->ob_entity.en_realm = parent;
+  obj->ob_attr.oa_layout_id = layout_id;
+}
+
+void S3MotrEmulator::motr_obj_fini(struct m0_obj *) {}
+
+int S3MotrEmulator::motr_entity_open(struct m0_entity *entity,
+                                     struct m0_op **op) {
+  *op = new_op(entity, M0_EO_OPEN);
+  return 0;
+}
+
+int S3MotrEmulator::motr_entity_create(struct m0_entity *entity,
+                                       struct m0_op **op) {
+  *op = new_op(entity, M0_EO_CREATE);
+  return 0;
+}
+
+int S3MotrEmulator::motr_entity_delete(struct m0_entity *entity,
+                                       struct m0_op **op) {
+  *op = new_op(entity, M0_EO_DELETE);
+  return 0;
+}
+
+void S3MotrEmulator::motr_op_setup(struct m0_op *op,
+                                   const struct m0_op_ops *ops, m0_time_t) {
+  op->op_cbs = ops;
+}
+
+int S3MotrEmulator::motr_idx_op(struct m0_idx *idx, enum m0_idx_opcode opcode,
+                                struct m0_bufvec *keys, struct m0_bufvec *vals,
+                                int *rcs, unsigned int flags,
+                                struct m0_op **op) {
+  S3MotrEmulatorOp *emulated_op = new_op(&idx->in_entity, opcode);
+  emulated_op->keys = keys;
+  emulated_op->vals = vals;
+  emulated_op->rcs = rcs;
+  emulated_op->flags = flags;
+  *op = emulated_op;
+  return 0;
+}
+
+int S3MotrEmulator::motr_obj_op(struct m0_obj *obj, enum m0_obj_opcode opcode,
+                                struct m0_indexvec *ext, struct m0_bufvec *data,
+                                struct m0_bufvec *, uint64_t, uint32_t flags,
+                                struct m0_op **op) {
+  if (opcode != M0_OC_READ && opcode != M0_OC_WRITE) {
+    return -ENOSYS;
+  }
+  S3MotrEmulatorOp *emulated_op = new_op(&obj->ob_entity, opcode);
+  emulated_op->ext = ext;
+  emulated_op->data = data;
+  emulated_op->flags = flags;
+  *op = emulated_op;
+  return 0;
+}
+
+void S3MotrEmulator::motr_op_launch(uint64_t, struct m0_op **op, uint32_t nr,
+                                    MotrOpType) {
+  for (uint32_t i = 0; i < nr; ++i) {
+    S3MotrEmulatorOp *emulated_op = static_cast<S3MotrEmulatorOp *>(op[i]);
+    uint64_t bytes = 0;
+    if (emulated_op->ext) {
+      for (uint32_t j = 0; j < emulated_op->ext->iv_vec.v_nr; ++j) {
+        bytes += emulated_op->ext->iv_vec.v_count[j];
+      }
+    }
+    for (struct m0_bufvec *kv : {emulated_op->keys, emulated_op->vals}) {
+      if (kv && emulated_op->op_code != M0_IC_NEXT) {
+        for (uint32_t j = 0; j < kv->ov_vec.v_nr; ++j) {
+          bytes += kv->ov_vec.v_count[j];
+        }
+      }
+    }
+    {
+      std::lock_guard<std::mutex> lock(ops_mutex);
+      emulated_op->op_sm.sm_state = M0_OS_LAUNCHED;
+      emulated_op->in_flight = true;
+    }
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    // Transfers share the device one after another, latency overlaps.
+    device_free_time = std::max(device_free_time, clock::now());
+    if (bytes_per_usec > 0) {
+      device_free_time += std::chrono::microseconds(
+          (int64_t)(bytes / bytes_per_usec));
+    }
+    emulated_op->due =
+        device_free_time + std::chrono::microseconds(latency_usec);
+    queue.push(emulated_op);
+  }
+  queue_cv.notify_all();
+}
+
+int S3MotrEmulator::motr_op_wait(m0_op *op, uint64_t bits, m0_time_t to) {
+  std::unique_lock<std::mutex> lock(ops_mutex);
+  auto reached = [op, bits]() {
+    return (M0_BITS(op->op_sm.sm_state) & bits) != 0;
+  };
+  if (to == M0_TIME_NEVER) {
+    ops_cv.wait(lock, reached);
+    return 0;
+  }
+  const m0_time_t now = m0_time_now();
+  const std::chrono::nanoseconds timeout(to > now ? to - now : 0);
+  return ops_cv.wait_for(lock, timeout, reached) ? 0 : -ETIMEDOUT;
+}
+
+int S3MotrEmulator::motr_op_rc(const struct m0_op *op) { return op->op_rc; }
+
+int S3MotrEmulator::m0_h_ufid_next(struct m0_uint128 *ufid) {
+  ufid->u_hi = ufid_hi;
+  ufid->u_lo = ++ufid_lo;
+  return 0;
+}
+
+static std::unique_ptr<S3MotrEmulator> gs_motr_emulator;
+
+int s3_motr_emulator_init() {
+  S3Option *option_instance = S3Option::get_instance();
+  if (!option_instance->is_motr_emulator_enabled()) {
+    return 0;
+  }
+  s3_log(S3_LOG_INFO, "", "%s Entry\n", __func__);
+  const std::string dir = option_instance->get_motr_emulator_dir();
+  if (!dir.empty() && mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST) {
+    const int rc = -errno;
+    s3_log(S3_LOG_FATAL, "", "Cannot create directory %s: %s\n", dir.c_str(),
+           strerror(errno));
+    return rc;
+  }
+  s3_log(S3_LOG_WARN, "",
+         "Motr is emulated, objects and indices are lost on exit\n");
+  gs_motr_emulator.reset(new S3MotrEmulator(
+      option_instance->get_motr_emulator_threads(),
+      option_instance->get_motr_emulator_latency_usec(),
+      option_instance->get_motr_emulator_bandwidth_mbps(), dir));
+  return 0;
+}
+
+void s3_motr_emulator_fini() {
+  if (!gs_motr_emulator) {
+    return;
+  }
+  s3_log(S3_LOG_INFO, "", "%s Entry\n", __func__);
+  gs_motr_emulator.reset();
+}
+
+S3MotrEmulator *s3_motr_emulator() { return gs_motr_emulator.get(); }
@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+#pragma once
+
+#ifndef __S3_SERVER_S3_MOTR_EMULATOR_H__
+#define __S3_SERVER_S3_MOTR_EMULATOR_H__
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "s3_motr_wrapper.h"
+
+struct S3MotrEmulatorOp;
+
+// MotrAPI which stores objects and indices in the s3server process, so
+// s3server can be developed and benchmarked without a Motr cluster.
+//
+// Object extents are kept in memory, or in one sparse file per object when
+// 'dir' is not empty.  Index key-values are always kept in memory.
+//
+// Launched operations are completed by a pool of worker threads, like Motr
+// completes them on its own threads.  Every operation takes 'latency_usec'
+// plus the time its data takes at 'bandwidth_mbps' of one storage device
+// shared by all operations (0 is unlimited).
+//
+// Enabled by S3_MOTR_EMULATOR_ENABLE, ConcreteMotrAPI then forwards to it.
+class S3MotrEmulator : public MotrAPI {
+  struct Object;
+  typedef std::map<std::string, std::string> KeyVal;
+  struct Uint128Comp {
+    bool operator()(const struct m0_uint128 &a,
+                    const struct m0_uint128 &b) const {
+      return a.u_hi < b.u_hi || (a.u_hi == b.u_hi && a.u_lo < b.u_lo);
+    }
+  };
+  typedef std::chrono::steady_clock clock;
+  struct DueLater {
+    bool operator()(const S3MotrEmulatorOp *a,
+                    const S3MotrEmulatorOp *b) const;
+  };
+
+  const std::string dir;
+  const unsigned latency_usec;
+  // Bytes per microsecond, 0 is unlimited.
+  const double bytes_per_usec;
+
+  std::mutex objects_mutex;
+  std::map<struct m0_uint128, std::shared_ptr<Object>, Uint128Comp> objects;
+
+  std::mutex indices_mutex;
+  std::map<struct m0_uint128, KeyVal, Uint128Comp> indices;
+
+  // Launched operations, the earliest due first.
+  std::mutex queue_mutex;
+  std::condition_variable queue_cv;
+  std::priority_queue<S3MotrEmulatorOp *, std::vector<S3MotrEmulatorOp *>,
+                      DueLater> queue;
+  // When the emulated device finishes transfers launched so far.
+  clock::time_point device_free_time;
+  bool stopping = false;
+  std::vector<std::thread> workers;
+
+  // Protects states of operations, and whether they may be freed.
+  std::mutex ops_mutex;
+  std::condition_variable ops_cv;
+
+  const uint64_t ufid_hi;
+  std::atomic<uint64_t> ufid_lo;
+  std::atomic<uint64_t> op_id;
+
+  S3MotrEmulatorOp *new_op(struct m0_entity *entity, unsigned opcode);
+  std::shared_ptr<Object> find_object(const struct m0_uint128 &id);
+  std::string object_path(const struct m0_uint128 &id) const;
+
+  void worker();
+  void execute(S3MotrEmulatorOp *op);
+  void complete(S3MotrEmulatorOp *op, int rc);
+
+  int create_entity(int type, const struct m0_uint128 &id);
+  int open_entity(int type, const struct m0_uint128 &id);
+  int delete_entity(int type, const struct m0_uint128 &id);
+  int write_object(S3MotrEmulatorOp *op);
+  int read_object(S3MotrEmulatorOp *op);
+  int index_op(S3MotrEmulatorOp *op);
+
+ public:
+  S3MotrEmulator(unsigned threads, unsigned latency_usec,
+                 unsigned bandwidth_mbps, const std::string &dir);
+  virtual ~S3MotrEmulator();
+
+  // Creates an index synchronously, returns -EEXIST if it exists.
+  int create_index(const struct m0_uint128 &id);
+
+  // Frees an operation created by this class.  Operation in flight is
+  // cancelled like m0_op_cancel() does: its callbacks are not called and its
+  // buffers are not used once this returns.  Waits for an operation which a
+  // worker is executing, unless called from its callback.
+  void op_free(struct m0_op *op);
+
+  virtual void motr_idx_init(struct m0_idx *idx, struct m0_realm *parent,
+                             const struct m0_uint128 *id);
+
+  virtual void motr_idx_fini(struct m0_idx *idx);
+
+  virtual int motr_sync_op_init(struct m0_op **sync_op);
+
+  virtual int motr_sync_entity_add(struct m0_op *sync_op,
+                                   struct m0_entity *entity);
+
+  virtual int motr_sync_op_add(struct m0_op *sync_op, struct m0_op *op);
+
+  virtual void motr_obj_init(struct m0_obj *obj, struct m0_realm *parent,
+                             const struct m0_uint128 *id, int layout_id);
+
+  virtual void motr_obj_fini(struct m0_obj *obj);
+
+  virtual int motr_entity_open(struct m0_entity *entity, struct m0_op **op);
+
+  virtual int motr_entity_create(struct m0_entity *entity, struct m0_op **op);
+
+  virtual int motr_entity_delete(struct m0_entity *entity, struct m0_op **op);
+
+  virtual void motr_op_setup(struct m0_op *op, const struct m0_op_ops *ops,
+                             m0_time_t linger);
+
+  virtual int motr_idx_op(struct m0_idx *idx, enum m0_idx_opcode opcode,
+                          struct m0_bufvec *keys, struct m0_bufvec *vals,
+                          int *rcs, unsigned int flags, struct m0_op **op);
+
+  virtual int motr_obj_op(struct m0_obj *obj, enum m0_obj_opcode opcode,
+                          struct m0_indexvec *ext, struct m0_bufvec *data,
+                          struct m0_bufvec *attr, uint64_t mask, uint32_t flags,
+                          struct m0_op **op);
+
+  virtual void motr_op_launch(uint64_t addb_request_id, struct m0_op **op,
+                              uint32_t nr,
+                              MotrOpType type = MotrOpType::unknown);
+
+  virtual int motr_op_wait(m0_op *op, uint64_t bits, m0_time_t to);
+
+  virtual int motr_op_rc(const struct m0_op *op);
+
+  virtual int m0_h_ufid_next(struct m0_uint128 *ufid);
+};
+
+int s3_motr_emulator_init();
+void s3_motr_emulator_fini();
+// Returns nullptr when the emulator is disabled.
+S3MotrEmulator *s3_motr_emulator();
+
+#endif
@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+#include <algorithm>
+#include <cassert>
+
+#include "s3_motr_context.h"
+#include "s3_motr_extents.h"
+
+size_t s3_motr_extents_total_size(const S3MotrExtents &extents) {
+  size_t total = 0;
+  for (const auto &extent : extents) {
+    total += extent.length;
+  }
+  return total;
+}
+
+uint64_t s3_motr_extents_end(const S3MotrExtents &extents) {
+  if (extents.empty()) {
+    return 0;
+  }
+  return extents.back().offset + extents.back().length;
+}
+
+bool s3_motr_extents_aligned(const S3MotrExtents &extents, size_t alignment) {
+  for (const auto &extent : extents) {
+    if (!extent.length || extent.offset % alignment ||
+        extent.length % alignment) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Walks buffers and extents together, returns the number of segments and
+// fills 'rw_ctx' if it is not null.
+static size_t map_segments(const S3BufferSequence &buffers,
+                           const S3MotrExtents &extents,
+                           struct s3_motr_rw_op_context *rw_ctx) {
+  size_t segment = 0;
+  size_t buf_idx = 0;
+  size_t buf_offset = 0;
+
+  for (const auto &extent : extents) {
+    size_t extent_offset = 0;
+    while (extent_offset < extent.length) {
+      assert(buf_idx < buffers.size());
+      const auto &buffer = buffers[buf_idx];
+      if (buf_offset == buffer.second) {
+        ++buf_idx;
+        buf_offset = 0;
+        continue;
+      }
+      const size_t len = std::min(extent.length - extent_offset,
+                                  buffer.second - buf_offset);
+      if (rw_ctx) {
+        assert(segment < rw_ctx->data->ov_vec.v_nr);
+        rw_ctx->data->ov_buf[segment] = (char *)buffer.first + buf_offset;
+        rw_ctx->data->ov_vec.v_count[segment] = len;
+        rw_ctx->ext->iv_index[segment] = extent.offset + extent_offset;
+        rw_ctx->ext->iv_vec.v_count[segment] = len;
+        /* we don't want any attributes */
+        rw_ctx->attr->ov_vec.v_count[segment] = 0;
+      }
+      ++segment;
+      extent_offset += len;
+      buf_offset += len;
+    }
+  }
+  return segment;
+}
+
+size_t s3_motr_extents_segment_count(const S3BufferSequence &buffers,
+                                     const S3MotrExtents &extents) {
+  return map_segments(buffers, extents, nullptr);
+}
+
+void s3_motr_extents_set_up(const S3BufferSequence &buffers,
+                            const S3MotrExtents &extents,
+                            struct s3_motr_rw_op_context *rw_ctx) {
+  const size_t segment_count = map_segments(buffers, extents, rw_ctx);
+  assert(segment_count == rw_ctx->data->ov_vec.v_nr);
+  (void)segment_count;
+}
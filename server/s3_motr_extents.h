@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+#pragma once
+
+#ifndef __S3_SERVER_S3_MOTR_EXTENTS_H__
+#define __S3_SERVER_S3_MOTR_EXTENTS_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "s3_buffer_sequence.h"
+
+struct s3_motr_rw_op_context;
+
+// Byte range of a Motr object.
+struct S3MotrExtent {
+  uint64_t offset;
+  size_t length;
+};
+
+using S3MotrExtents = std::vector<S3MotrExtent>;
+
+size_t s3_motr_extents_total_size(const S3MotrExtents &extents);
+
+// Offset just after the end of the last extent, 0 for no extents.
+uint64_t s3_motr_extents_end(const S3MotrExtents &extents);
+
+// True if every extent starts and ends at a multiple of 'alignment' and
+// has non-zero length.
+bool s3_motr_extents_aligned(const S3MotrExtents &extents, size_t alignment);
+
+// Scatter/gather list of one vectored Motr op: the buffers are filled from
+// (or written to) the extents in order, so the data of extent k follows the
+// data of extent k - 1 in the buffers.  A segment ends wherever a buffer or
+// an extent ends, so buffers need not be of extent size.  Buffers must hold
+// at least s3_motr_extents_total_size() bytes, the rest is not used.
+
+// Number of segments, i.e. the buffer count of the rw op context.
+size_t s3_motr_extents_segment_count(const S3BufferSequence &buffers,
+                                     const S3MotrExtents &extents);
+
+// Fills ext, data and attr of 'rw_ctx' created for
+// s3_motr_extents_segment_count() buffers.
+void s3_motr_extents_set_up(const S3BufferSequence &buffers,
+                            const S3MotrExtents &extents,
+                            struct s3_motr_rw_op_context *rw_ctx);
+
+#endif
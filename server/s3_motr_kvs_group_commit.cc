@@ -0,0 +1,374 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+#include <errno.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "atexit.h"
+#include "s3_factory.h"
+#include "s3_log.h"
+#include "s3_motr_kvs_group_commit.h"
+#include "s3_option.h"
+#include "s3_stats.h"
+
+extern S3Option* g_option_instance;
+
+S3MotrKVSGroupCommit::S3MotrKVSGroupCommit(
+    std::shared_ptr<EventInterface> event_obj_ptr, evbase_t* evbase_,
+    unsigned window_usec_, size_t max_keys_,
+    std::shared_ptr<S3MotrKVSWriterFactory> writer_factory_)
+    : RecurringEventBase(std::move(event_obj_ptr), evbase_),
+      window_usec(window_usec_),
+      max_keys(max_keys_ ? max_keys_ : 1) {
+  if (writer_factory_) {
+    writer_factory = std::move(writer_factory_);
+  } else {
+    writer_factory = std::make_shared<S3MotrKVSWriterFactory>();
+  }
+}
+
+void S3MotrKVSGroupCommit::put_keyval(S3MotrKVSWriter* writer,
+                                      struct m0_uint128 oid, std::string key,
+                                      std::string value) {
+  add(writer, oid, OpType::put, std::move(key), std::move(value));
+}
+
+void S3MotrKVSGroupCommit::delete_keyval(S3MotrKVSWriter* writer,
+                                         struct m0_uint128 oid,
+                                         std::string key) {
+  add(writer, oid, OpType::del, std::move(key), "");
+}
+
+void S3MotrKVSGroupCommit::add(S3MotrKVSWriter* writer, struct m0_uint128 oid,
+                               OpType op_type, std::string key,
+                               std::string value) {
+  IndexQueue& queue = queues[get_index_key(oid)];
+  queue.oid = oid;
+  queue.entries.push_back({writer, op_type, std::move(key), std::move(value)});
+  ++queued_count;
+
+  // Can't wait without timer, issue it now.
+  if (queue.entries.size() >= max_keys + queue.held || !arm_timer()) {
+    flush(queue);
+  }
+}
+
+bool S3MotrKVSGroupCommit::arm_timer() {
+  if (timer_armed) {
+    return true;
+  }
+  struct timeval tv;
+  tv.tv_sec = window_usec / 1000000;
+  tv.tv_usec = window_usec % 1000000;
+  if (add_evtimer(tv) != 0) {
+    s3_log(S3_LOG_ERROR, "", "Cannot add group commit timer\n");
+    return false;
+  }
+  timer_armed = true;
+  return true;
+}
+
+void S3MotrKVSGroupCommit::action_callback(void) noexcept {
+  completed_batches.clear();
+  if (!queued_count) {
+    // Nothing came during the last window.
+    del_evtimer();
+    timer_armed = false;
+    return;
+  }
+  // Writers' handlers may queue more operations while flushing, map
+  // iterators stay valid.
+  for (auto& index_queue : queues) {
+    if (!index_queue.second.entries.empty()) {
+      flush(index_queue.second);
+    }
+  }
+  for (auto it = queues.begin(); it != queues.end();) {
+    if (it->second.entries.empty()) {
+      it = queues.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void S3MotrKVSGroupCommit::flush(IndexQueue& queue) {
+  const IndexKey index = get_index_key(queue.oid);
+  std::unordered_set<std::string>& busy = busy_keys[index];
+  Batch puts = {queue.oid, OpType::put, {}};
+  Batch deletes = {queue.oid, OpType::del, {}};
+  std::vector<Entry> held;
+  // Keys of held entries, later entries of the key are held too.
+  std::unordered_set<std::string> held_keys;
+
+  for (auto& entry : queue.entries) {
+    if (busy.count(entry.key) || held_keys.count(entry.key)) {
+      held_keys.insert(entry.key);
+      held.push_back(std::move(entry));
+      continue;
+    }
+    busy.insert(entry.key);
+    if (entry.op_type == OpType::put) {
+      puts.entries.push_back(std::move(entry));
+    } else {
+      deletes.entries.push_back(std::move(entry));
+    }
+  }
+  queued_count -= queue.entries.size() - held.size();
+  queue.entries.swap(held);
+  queue.held = queue.entries.size();
+  if (busy.empty()) {
+    busy_keys.erase(index);
+  }
+  // Keys of the two batches differ, so their order doesn't matter.
+  if (!puts.entries.empty()) {
+    flush(puts);
+  }
+  if (!deletes.entries.empty()) {
+    flush(deletes);
+  }
+}
+
+void S3MotrKVSGroupCommit::flush_held(const IndexKey& index) {
+  auto it = queues.find(index);
+  if (it != queues.end() && it->second.held) {
+    flush(it->second);
+  }
+}
+
+void S3MotrKVSGroupCommit::flush(Batch& batch) {
+  if (batch.entries.size() == 1) {
+    // Nothing to group.
+    Entry& entry = batch.entries[0];
+    launch(entry.writer, batch.oid, batch.op_type, entry.key, entry.value);
+    return;
+  }
+  s3_stats_inc("kvs_group_commit_count");
+  s3_stats_count("kvs_group_commit_keys_count", batch.entries.size());
+
+  // The batch operation is accounted to the first request.
+  S3MotrKVSWriter* first_writer = nullptr;
+  for (auto& entry : batch.entries) {
+    if (entry.writer) {
+      first_writer = entry.writer;
+      break;
+    }
+  }
+  if (!first_writer) {
+    for (auto& entry : batch.entries) {
+      release_key(get_index_key(batch.oid), entry.key);
+    }
+    return;
+  }
+  inflight_batches.push_back(InFlightBatch());
+  auto it = std::prev(inflight_batches.end());
+  it->writer = writer_factory->create_motr_kvs_writer(
+      first_writer->request, first_writer->s3_motr_api);
+  it->batch = std::move(batch);
+  const Batch& inflight = it->batch;
+
+  s3_log(S3_LOG_DEBUG, "",
+         "Group commit of %zu keys to index oid = %" SCNx64 " : %" SCNx64 "\n",
+         inflight.entries.size(), inflight.oid.u_hi, inflight.oid.u_lo);
+  if (inflight.op_type == OpType::put) {
+    std::map<std::string, std::string> kv_list;
+    for (auto& entry : inflight.entries) {
+      kv_list[entry.key] = entry.value;
+    }
+    it->writer->put_keyval(
+        inflight.oid, kv_list,
+        std::bind(&S3MotrKVSGroupCommit::batch_successful, this, it),
+        std::bind(&S3MotrKVSGroupCommit::batch_failed, this, it));
+  } else {
+    std::vector<std::string> keys;
+    keys.reserve(inflight.entries.size());
+    for (auto& entry : inflight.entries) {
+      keys.push_back(entry.key);
+    }
+    it->writer->delete_keyval(
+        inflight.oid, keys,
+        std::bind(&S3MotrKVSGroupCommit::batch_successful, this, it),
+        std::bind(&S3MotrKVSGroupCommit::batch_failed, this, it));
+  }
+}
+
+void S3MotrKVSGroupCommit::launch(S3MotrKVSWriter* writer,
+                                  struct m0_uint128 oid, OpType op_type,
+                                  const std::string& key,
+                                  const std::string& value) {
+  if (!writer) {
+    release_key(get_index_key(oid), key);
+    return;
+  }
+  launched[writer] = std::make_pair(get_index_key(oid), key);
+  std::weak_ptr<S3MotrKVSGroupCommit> weak_self = shared_from_this();
+  auto wrap = [weak_self, writer](std::function<void(void)> handler) {
+    return [weak_self, writer, handler]() {
+      // Writer's handler may replace this function object.
+      std::function<void(void)> writer_handler = handler;
+      std::shared_ptr<S3MotrKVSGroupCommit> self = weak_self.lock();
+      if (self) {
+        self->launched_done(writer);
+      }
+      writer_handler();
+    };
+  };
+  writer->handler_on_success = wrap(writer->handler_on_success);
+  writer->handler_on_failed = wrap(writer->handler_on_failed);
+  if (op_type == OpType::put) {
+    writer->launch_put_keyval(oid, key, value);
+  } else {
+    writer->launch_delete_keyval();
+  }
+}
+
+void S3MotrKVSGroupCommit::launched_done(S3MotrKVSWriter* writer) {
+  auto it = launched.find(writer);
+  if (it == launched.end()) {
+    return;
+  }
+  const IndexKey index = it->second.first;
+  const std::string key = std::move(it->second.second);
+  launched.erase(it);
+  release_key(index, key);
+  flush_held(index);
+}
+
+void S3MotrKVSGroupCommit::release_key(const IndexKey& index,
+                                       const std::string& key) {
+  auto it = busy_keys.find(index);
+  if (it != busy_keys.end()) {
+    it->second.erase(key);
+    if (it->second.empty()) {
+      busy_keys.erase(it);
+    }
+  }
+}
+
+void S3MotrKVSGroupCommit::batch_successful(
+    std::list<InFlightBatch>::iterator it) {
+  completed_batches.splice(completed_batches.end(), inflight_batches, it);
+  // Batch writer is released on the next timer event.
+  arm_timer();
+  const IndexKey index = get_index_key(it->batch.oid);
+  for (auto& entry : it->batch.entries) {
+    release_key(index, entry.key);
+  }
+  const OpType op_type = it->batch.op_type;
+  for (auto& entry : it->batch.entries) {
+    if (!entry.writer) {
+      continue;
+    }
+    S3MotrKVSWriter* writer = entry.writer;
+    // Writer may be destroyed by its handler.
+    entry.writer = nullptr;
+    if (op_type == OpType::put) {
+      writer->put_keyval_successful();
+    } else {
+      writer->delete_keyval_successful();
+    }
+  }
+  flush_held(index);
+}
+
+void S3MotrKVSGroupCommit::batch_failed(std::list<InFlightBatch>::iterator it) {
+  completed_batches.splice(completed_batches.end(), inflight_batches, it);
+  arm_timer();
+  s3_log(S3_LOG_WARN, "",
+         "Group commit of %zu keys failed, retrying each key\n",
+         it->batch.entries.size());
+  const Batch& batch = it->batch;
+  for (auto& entry : it->batch.entries) {
+    S3MotrKVSWriter* writer = entry.writer;
+    entry.writer = nullptr;
+    // Key stays busy until the retry is done.
+    launch(writer, batch.oid, batch.op_type, entry.key, entry.value);
+  }
+  // Keys of destroyed writers are not busy anymore.
+  flush_held(get_index_key(batch.oid));
+}
+
+void S3MotrKVSGroupCommit::forget(S3MotrKVSWriter* writer) {
+  for (auto& index_queue : queues) {
+    auto& entries = index_queue.second.entries;
+    for (auto it = entries.begin(); it != entries.end();) {
+      if (it->writer == writer) {
+        it = entries.erase(it);
+        --queued_count;
+      } else {
+        ++it;
+      }
+    }
+    // Entries behind the removed ones may be free to go, next flush tells.
+    index_queue.second.held =
+        std::min(index_queue.second.held, entries.size());
+  }
+  auto launched_it = launched.find(writer);
+  if (launched_it != launched.end()) {
+    // Operation is abandoned with the writer, same as without group commit.
+    release_key(launched_it->second.first, launched_it->second.second);
+    launched.erase(launched_it);
+  }
+  for (auto* batches : {&inflight_batches, &completed_batches}) {
+    for (auto& inflight : *batches) {
+      for (auto& entry : inflight.batch.entries) {
+        if (entry.writer == writer) {
+          entry.writer = nullptr;
+        }
+      }
+    }
+  }
+}
+
+static std::shared_ptr<S3MotrKVSGroupCommit> gs_kvs_group_commit;
+
+int s3_motr_kvs_group_commit_init(evbase_t* evbase) {
+  if (!g_option_instance->is_kvs_group_commit_enabled()) {
+    return 0;
+  }
+  s3_log(S3_LOG_INFO, "", "%s Entry", __func__);
+
+  if (!evbase) {
+    return -EINVAL;
+  }
+  gs_kvs_group_commit = std::make_shared<S3MotrKVSGroupCommit>(
+      std::make_shared<EventWrapper>(), evbase,
+      g_option_instance->get_kvs_group_commit_window_usec(),
+      g_option_instance->get_kvs_group_commit_max_keys());
+  if (!gs_kvs_group_commit) {
+    return -ENOMEM;
+  }
+  return 0;
+}
+
+void s3_motr_kvs_group_commit_fini() {
+  if (!gs_kvs_group_commit) {
+    return;
+  }
+  s3_log(S3_LOG_INFO, "", "%s Entry", __func__);
+  gs_kvs_group_commit->del_evtimer();
+  gs_kvs_group_commit.reset();
+}
+
+std::shared_ptr<S3MotrKVSGroupCommit> s3_motr_kvs_group_commit() {
+  return gs_kvs_group_commit;
+}
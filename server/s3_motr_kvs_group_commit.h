@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+#pragma once
+
+#ifndef __S3_SERVER_S3_MOTR_KVS_GROUP_COMMIT_H__
+#define __S3_SERVER_S3_MOTR_KVS_GROUP_COMMIT_H__
+
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "event_utils.h"
+#include "s3_motr_kvs_writer.h"
+
+class S3MotrKVSWriterFactory;
+
+// Group commit of KV operations issued by concurrent requests.
+//
+// Single key puts and deletes of S3MotrKVSWriter are queued per index, in
+// arrival order, for at most S3_KVS_GROUP_COMMIT_WINDOW_USEC, or until
+// S3_KVS_GROUP_COMMIT_MAX_KEYS keys are queued for an index.  Then puts and
+// deletes are each written with one multi-key Motr index operation and the
+// result is reported to every writer as if it did the operation on its own.
+// If the multi-key operation fails, each key is retried with its own
+// operation, so one bad key (e.g. delete of missing key) doesn't fail the
+// others and writers see the same state and error codes as without batching.
+//
+// Only one operation on a key is in flight at a time.  An operation on a key
+// which is in flight, or which is queued behind another operation on the key,
+// waits until the earlier one is done, so operations on a key are done in
+// the order they came.
+//
+// Used on the main thread only.
+class S3MotrKVSGroupCommit
+    : public RecurringEventBase,
+      public std::enable_shared_from_this<S3MotrKVSGroupCommit> {
+ public:
+  enum class OpType {
+    put,
+    del
+  };
+
+ private:
+  struct Entry {
+    // Null once the writer is destroyed.
+    S3MotrKVSWriter* writer;
+    OpType op_type;
+    std::string key;
+    std::string value;
+  };
+  typedef std::pair<uint64_t, uint64_t> IndexKey;
+  // Entries queued for one index, in arrival order.
+  struct IndexQueue {
+    struct m0_uint128 oid;
+    std::vector<Entry> entries;
+    // Entries which wait for an earlier operation on their key.
+    size_t held = 0;
+  };
+  // Entries of one index and operation, written together.
+  struct Batch {
+    struct m0_uint128 oid;
+    OpType op_type;
+    std::vector<Entry> entries;
+  };
+  struct InFlightBatch {
+    Batch batch;
+    std::shared_ptr<S3MotrKVSWriter> writer;
+  };
+
+  std::map<IndexKey, IndexQueue> queues;
+  size_t queued_count = 0;
+  // Keys with an operation in flight.
+  std::map<IndexKey, std::unordered_set<std::string>> busy_keys;
+  // Writers which do the operation on their own, and its index and key.
+  std::map<S3MotrKVSWriter*, std::pair<IndexKey, std::string>> launched;
+  std::list<InFlightBatch> inflight_batches;
+  // Completed batches, whose writer may still be on the call stack.
+  std::list<InFlightBatch> completed_batches;
+  bool timer_armed = false;
+
+  unsigned window_usec;
+  size_t max_keys;
+  std::shared_ptr<S3MotrKVSWriterFactory> writer_factory;
+
+  static IndexKey get_index_key(const struct m0_uint128& oid) {
+    return IndexKey(oid.u_hi, oid.u_lo);
+  }
+  void add(S3MotrKVSWriter* writer, struct m0_uint128 oid, OpType op_type,
+           std::string key, std::string value);
+  // Issues queued entries of the index whose key is not busy.
+  void flush(IndexQueue& queue);
+  void flush_held(const IndexKey& index);
+  void flush(Batch& batch);
+  // Writer does the operation on its own, its handlers are wrapped to know
+  // when the key is not busy anymore.
+  void launch(S3MotrKVSWriter* writer, struct m0_uint128 oid, OpType op_type,
+              const std::string& key, const std::string& value);
+  void launched_done(S3MotrKVSWriter* writer);
+  void release_key(const IndexKey& index, const std::string& key);
+  // Returns false if the timer can't be added.
+  bool arm_timer();
+  void batch_successful(std::list<InFlightBatch>::iterator it);
+  void batch_failed(std::list<InFlightBatch>::iterator it);
+
+ public:
+  S3MotrKVSGroupCommit(
+      std::shared_ptr<EventInterface> event_obj_ptr, evbase_t* evbase_,
+      unsigned window_usec, size_t max_keys,
+      std::shared_ptr<S3MotrKVSWriterFactory> writer_factory = nullptr);
+
+  // Queue the operation, writer's handlers are called once it is done.
+  void put_keyval(S3MotrKVSWriter* writer, struct m0_uint128 oid,
+                  std::string key, std::string value);
+  void delete_keyval(S3MotrKVSWriter* writer, struct m0_uint128 oid,
+                     std::string key);
+  // Called when writer is destroyed.
+  void forget(S3MotrKVSWriter* writer);
+
+  size_t get_queued_count() const { return queued_count; }
+  size_t get_inflight_batches_count() const { return inflight_batches.size(); }
+
+  // Flushes all queued operations whose key is not busy.
+  virtual void action_callback(void) noexcept;
+};
+
+int s3_motr_kvs_group_commit_init(evbase_t* evbase);
+void s3_motr_kvs_group_commit_fini();
+// Returns nullptr when group commit is disabled.
+std::shared_ptr<S3MotrKVSGroupCommit> s3_motr_kvs_group_commit();
+
+#endif
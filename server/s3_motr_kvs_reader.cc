@@ -372,6 +372,7 @@ void S3MotrKVSReader::next_keyval(struct m0_uint128 idx_oid, std::string key,
                              &idx_oid);
   idx_ctx->n_initialized_contexts = 1;
 
+  kvs_ctx->flags = flag;
   rc = s3_motr_api->motr_idx_op(&idx_ctx->idx[0], M0_IC_NEXT, kvs_ctx->keys,
                                 kvs_ctx->values, kvs_ctx->rcs, flag,
                                 &(idx_op_ctx->ops[0]));
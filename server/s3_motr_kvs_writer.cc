@@ -22,6 +22,7 @@
 
 #include "s3_common.h"
 
+#include "s3_motr_kvs_group_commit.h"
 #include "s3_motr_kvs_writer.h"
 #include "s3_motr_rw_common.h"
 #include "s3_option.h"
@@ -63,6 +64,13 @@ S3MotrKVSWriter::S3MotrKVSWriter(std::string req_id,
 
 S3MotrKVSWriter::~S3MotrKVSWriter() {
   s3_log(S3_LOG_DEBUG, request_id, "%s\n", __func__);
+  if (queued_in_group_commit) {
+    std::shared_ptr<S3MotrKVSGroupCommit> group_commit =
+        s3_motr_kvs_group_commit();
+    if (group_commit) {
+      group_commit->forget(this);
+    }
+  }
   clean_up_contexts();
 }
 
@@ -626,13 +634,26 @@ void S3MotrKVSWriter::put_keyval(struct m0_uint128 oid, std::string key,
   if (key.empty()) {
     s3_log(S3_LOG_ERROR, request_id, "Empty key in PUT KV\n");
   }
+  this->handler_on_success = on_success;
+  this->handler_on_failed = on_failed;
+
+  std::shared_ptr<S3MotrKVSGroupCommit> group_commit =
+      s3_motr_kvs_group_commit();
+  if (group_commit && request) {
+    queued_in_group_commit = true;
+    group_commit->put_keyval(this, oid, std::move(key), std::move(val));
+    return;
+  }
+  launch_put_keyval(oid, key, val);
+}
+
+void S3MotrKVSWriter::launch_put_keyval(struct m0_uint128 oid,
+                                        const std::string& key,
+                                        const std::string& val) {
   int rc = 0;
   oid_list.clear();
   oid_list.push_back(oid);
 
-  this->handler_on_success = on_success;
-  this->handler_on_failed = on_failed;
-
   if (idx_ctx) {
     // clean up any old allocations
     clean_up_contexts();
@@ -812,7 +833,6 @@ void S3MotrKVSWriter::delete_keyval(struct m0_uint128 oid,
   s3_log(S3_LOG_INFO, stripped_request_id,
          "%s Entry with oid %" SCNx64 " : %" SCNx64 " and %zu keys\n", __func__,
          oid.u_hi, oid.u_lo, keys.size());
-  int rc;
   for (auto key : keys) {
     s3_log(S3_LOG_DEBUG, request_id, "key = %s\n", key.c_str());
     assert(!key.empty());
@@ -831,6 +851,18 @@ void S3MotrKVSWriter::delete_keyval(struct m0_uint128 oid,
   this->handler_on_success = on_success;
   this->handler_on_failed = on_failed;
 
+  std::shared_ptr<S3MotrKVSGroupCommit> group_commit =
+      s3_motr_kvs_group_commit();
+  if (group_commit && request && keys_list.size() == 1) {
+    queued_in_group_commit = true;
+    group_commit->delete_keyval(this, oid, keys_list[0]);
+    return;
+  }
+  launch_delete_keyval();
+}
+
+void S3MotrKVSWriter::launch_delete_keyval() {
+  int rc;
   if (idx_ctx) {
     // clean up any old allocations
     clean_up_contexts();
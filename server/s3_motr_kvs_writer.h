@@ -144,8 +144,18 @@ class S3MotrKVSWriter {
 
   struct s3_motr_idx_context* idx_ctx;
 
+  // Operation is queued in S3MotrKVSGroupCommit.
+  bool queued_in_group_commit = false;
+
   void clean_up_contexts();
 
+  // Launch the operation right away, bypassing group commit.
+  void launch_put_keyval(struct m0_uint128 oid, const std::string& key,
+                         const std::string& val);
+  void launch_delete_keyval();
+
+  friend class S3MotrKVSGroupCommit;
+
  public:
   S3MotrKVSWriter(std::shared_ptr<RequestObject> req,
                   std::shared_ptr<MotrAPI> motr_api = nullptr);
@@ -268,6 +278,12 @@ class S3MotrKVSWriter {
   FRIEND_TEST(S3MotrKVSWritterTest, DelKeyValEmpty);
   FRIEND_TEST(S3BucketMetadataV1Test, CreateBucketListIndexSuccessful);
   FRIEND_TEST(S3PartMetadataTest, CreatePartIndexSuccessful);
+  FRIEND_TEST(S3MotrKVSGroupCommitTest, QueuedUntilTimer);
+  FRIEND_TEST(S3MotrKVSGroupCommitTest, FlushOnMaxKeys);
+  FRIEND_TEST(S3MotrKVSGroupCommitTest, DuplicateKeyIsNotBatched);
+  FRIEND_TEST(S3MotrKVSGroupCommitTest, InterleavedPutDeleteKeepOrder);
+  FRIEND_TEST(S3MotrKVSGroupCommitTest, BatchFailedRetriesEachKey);
+  FRIEND_TEST(S3MotrKVSGroupCommitTest, ForgetWriter);
   FRIEND_TEST(S3PartMetadataTest, CreatePartIndexSuccessfulOnlyCreateIndex);
   FRIEND_TEST(S3PartMetadataTest, CreatePartIndexSuccessfulSaveMetadata);
   FRIEND_TEST(S3NewAccountRegisterNotifyActionTest,
@@ -83,6 +83,40 @@ bool S3MotrReader::read_object_data(size_t num_of_blocks,
   assert(this->handler_on_failed != NULL);
 
   num_of_blocks_to_read = num_of_blocks;
+  extents_to_read.clear();
+
+  if (is_object_opened) {
+    rc = read_object();
+  } else {
+    int retcode =
+        open_object(std::bind(&S3MotrReader::open_object_successful, this),
+                    std::bind(&S3MotrReader::open_object_failed, this));
+    if (retcode != 0) {
+      this->handler_on_failed();
+      rc = false;
+    }
+  }
+  s3_log(S3_LOG_DEBUG, "", "%s Exit", __func__);
+  return rc;
+}
+
+bool S3MotrReader::read_object_extents(S3MotrExtents extents,
+                                       std::function<void(void)> on_success,
+                                       std::function<void(void)> on_failed) {
+  s3_log(S3_LOG_INFO, stripped_request_id,
+         "%s Entry with %zu extents of %zu bytes in total\n", __func__,
+         extents.size(), s3_motr_extents_total_size(extents));
+
+  assert(!extents.empty());
+  assert(s3_motr_extents_aligned(extents, motr_unit_size));
+
+  num_of_blocks_to_read = 0;
+  extents_to_read = std::move(extents);
+
+  bool rc = true;
+  state = S3MotrReaderOpState::reading;
+  this->handler_on_success = std::move(on_success);
+  this->handler_on_failed = std::move(on_failed);
 
   if (is_object_opened) {
     rc = read_object();
@@ -234,8 +268,15 @@ bool S3MotrReader::read_object() {
       std::bind(&S3MotrReader::read_object_failed, this), layout_id));
 
   /* Read the requisite number of blocks from the entity */
-  if (!reader_context->init_read_op_ctx(request_id, num_of_blocks_to_read,
-                                        motr_unit_size, &last_index)) {
+  bool initialized;
+  if (extents_to_read.empty()) {
+    initialized = reader_context->init_read_op_ctx(
+        request_id, num_of_blocks_to_read, motr_unit_size, &last_index);
+  } else {
+    initialized = reader_context->init_read_op_ctx(request_id, extents_to_read);
+    last_index = s3_motr_extents_end(extents_to_read);
+  }
+  if (!initialized) {
     // out-of-memory
     state = S3MotrReaderOpState::ooo;
     s3_log(S3_LOG_ERROR, request_id,
@@ -250,6 +291,10 @@ bool S3MotrReader::read_object() {
   // Remember, so buffers can be iterated.
   motr_rw_op_context = rw_ctx;
   iteration_index = 0;
+  if (!extents_to_read.empty()) {
+    // get_next_block() returns the segments of the extents.
+    num_of_blocks_to_read = rw_ctx->data->ov_vec.v_nr;
+  }
 
   struct s3_motr_context_obj *op_ctx = (struct s3_motr_context_obj *)calloc(
       1, sizeof(struct s3_motr_context_obj));
@@ -276,7 +321,7 @@ bool S3MotrReader::read_object() {
   ctx->ops[0]->op_datum = (void *)op_ctx;
   s3_motr_api->motr_op_setup(ctx->ops[0], &ctx->cbs[0], 0);
 
-  reader_context->start_timer_for("read_object_data");
+  reader_context->start_timer_for("read_object_data", S3TraceCategory::io);
 
   s3_log(S3_LOG_INFO, stripped_request_id,
          "Motr API: readobj(operation: M0_OC_READ, oid: ("
@@ -29,6 +29,7 @@
 #include "s3_asyncop_context_base.h"
 #include "s3_buffer_sequence.h"
 #include "s3_motr_context.h"
+#include "s3_motr_extents.h"
 #include "s3_motr_layout.h"
 #include "s3_motr_wrapper.h"
 #include "s3_log.h"
@@ -120,6 +121,33 @@ class S3MotrReaderContext : public S3AsyncOpContextBase {
     return true;
   }
 
+  // Call this when you want to do vectored read op.
+  // param(in): extents - object ranges to read, their data is placed into
+  //            the evbuffer one after another in the order of extents
+  bool init_read_op_ctx(std::string request_id, const S3MotrExtents& extents) {
+    size_t total_read_sz = s3_motr_extents_total_size(extents);
+    size_t evbuf_unit_buf_sz =
+        S3Option::get_instance()->get_libevent_pool_buffer_size();
+    p_s3_evbuffer = std::unique_ptr<S3Evbuffer>(
+        new S3Evbuffer(request_id, total_read_sz, evbuf_unit_buf_sz));
+    int rc = p_s3_evbuffer->init();
+    if (rc != 0) {
+      return false;
+    }
+    const S3BufferSequence buffers = p_s3_evbuffer->get_buffers();
+    motr_rw_op_context = create_basic_rw_op_ctx(
+        s3_motr_extents_segment_count(buffers, extents), evbuf_unit_buf_sz);
+    if (motr_rw_op_context == NULL) {
+      // out of memory
+      return false;
+    }
+    s3_motr_extents_set_up(buffers, extents, motr_rw_op_context);
+
+    has_motr_rw_op_context = true;
+
+    return true;
+  }
+
   struct s3_motr_op_context* get_motr_op_ctx() { return motr_op_context; }
 
   struct s3_motr_rw_op_context* get_motr_rw_op_ctx() {
@@ -179,6 +207,8 @@ class S3MotrReader {
   size_t num_of_blocks_to_read = 0;
 
   uint64_t last_index = 0;
+  // Set by read_object_extents(), read instead of num_of_blocks_to_read.
+  S3MotrExtents extents_to_read;
 
   bool is_object_opened = false;
   struct s3_motr_obj_context* obj_ctx = nullptr;
@@ -220,6 +250,15 @@ class S3MotrReader {
                                 std::function<void(void)> on_success,
                                 std::function<void(void)> on_failed);
 
+  // async vectored read of several ranges of the object in one Motr op.
+  // Extents must be aligned to the unit size of the layout, their data is
+  // placed into the evbuffer one after another.  last_index is set to the
+  // end of the last extent.
+  // Returns: true = launched, false = failed to launch (out-of-memory)
+  virtual bool read_object_extents(S3MotrExtents extents,
+                                   std::function<void(void)> on_success,
+                                   std::function<void(void)> on_failed);
+
   virtual bool check_object_exist(std::function<void(void)> on_success,
                                   std::function<void(void)> on_failed);
 
@@ -247,6 +286,7 @@ class S3MotrReader {
   FRIEND_TEST(S3MotrReaderTest, OpenObjectCheckNoHoleFlagTest);
   FRIEND_TEST(S3MotrReaderTest, ReadObjectDataTest);
   FRIEND_TEST(S3MotrReaderTest, ReadObjectDataCheckNoHoleFlagTest);
+  FRIEND_TEST(S3MotrReaderTest, ReadObjectExtentsTest);
   FRIEND_TEST(S3MotrReaderTest, ReadObjectDataSuccessful);
   FRIEND_TEST(S3MotrReaderTest, ReadObjectDataFailed);
   FRIEND_TEST(S3MotrReaderTest, CleanupContexts);
@@ -27,6 +27,7 @@
 #include "s3_motr_kvs_writer.h"
 #include "s3_fake_motr_kvs.h"
 #include "s3_common_utilities.h"
+#include "s3_completion_queue.h"
 
 #include <ctime>
 
@@ -66,20 +67,11 @@ bool gs_timeout_shutdown_in_progress = false;
 void (*gs_motr_timeout_shutdown)(int ignore) = s3_kickoff_graceful_shutdown;
 
 // This is run on main thread.
-void motr_op_done_on_main_thread(evutil_socket_t, short events,
-                                 void *user_data) {
+void motr_op_done(void *app_ctx) {
   std::string request_id;
   std::string stripped_request_id;
 
-  if (user_data == NULL) {
-    s3_log(S3_LOG_DEBUG, "", "%s Entry\n", __func__);
-    s3_log(S3_LOG_ERROR, "", "Input argument user_data is NULL\n");
-    s3_log(S3_LOG_DEBUG, "", "%s Exit", __func__);
-    return;
-  }
-  struct user_event_context *user_context =
-      (struct user_event_context *)user_data;
-  S3AsyncOpContextBase *context = (S3AsyncOpContextBase *)user_context->app_ctx;
+  S3AsyncOpContextBase *context = (S3AsyncOpContextBase *)app_ctx;
   if (context == NULL) {
     s3_log(S3_LOG_ERROR, "", "context pointer is NULL\n");
   }
@@ -88,10 +80,6 @@ void motr_op_done_on_main_thread(evutil_socket_t, short events,
     stripped_request_id = context->get_request()->get_stripped_request_id();
   }
   s3_log(S3_LOG_DEBUG, request_id, "%s Entry\n", __func__);
-  struct event *s3user_event = (struct event *)user_context->user_event;
-  if (s3user_event == NULL) {
-    s3_log(S3_LOG_ERROR, request_id, "User event is NULL\n");
-  }
   context->log_timer();
 
   if (context->is_at_least_one_op_successful()) {
@@ -142,10 +130,27 @@ void motr_op_done_on_main_thread(evutil_socket_t, short events,
     }
   }
 
+  s3_log(S3_LOG_DEBUG, request_id, "%s Exit", __func__);
+}
+
+// This is run on main thread.
+void motr_op_done_on_main_thread(evutil_socket_t, short events,
+                                 void *user_data) {
+  if (user_data == NULL) {
+    s3_log(S3_LOG_DEBUG, "", "%s Entry\n", __func__);
+    s3_log(S3_LOG_ERROR, "", "Input argument user_data is NULL\n");
+    s3_log(S3_LOG_DEBUG, "", "%s Exit", __func__);
+    return;
+  }
+  struct user_event_context *user_context =
+      (struct user_event_context *)user_data;
+  struct event *s3user_event = (struct event *)user_context->user_event;
+
+  motr_op_done(user_context->app_ctx);
+
   free(user_data);
   // Free user event
   if (s3user_event) event_free(s3user_event);
-  s3_log(S3_LOG_DEBUG, request_id, "%s Exit", __func__);
 }
 
 // Motr callbacks, run in motr thread
@@ -179,17 +184,12 @@ void s3_motr_op_stable(struct m0_op *op) {
   }
   free(ctx);
   if (app_ctx->incr_response_count() == app_ctx->get_ops_count()) {
-    struct user_event_context *user_ctx = (struct user_event_context *)calloc(
-        1, sizeof(struct user_event_context));
-    user_ctx->app_ctx = app_ctx;
     app_ctx->stop_timer();
 
 #ifdef S3_GOOGLE_TEST
-    evutil_socket_t test_sock = 0;
-    short events = 0;
-    motr_op_done_on_main_thread(test_sock, events, (void *)user_ctx);
+    motr_op_done(app_ctx);
 #else
-    S3PostToMainLoop((void *)user_ctx)(motr_op_done_on_main_thread, request_id);
+    s3_post_completion(motr_op_done, app_ctx, request_id);
 #endif  // S3_GOOGLE_TEST
   }
   s3_log(S3_LOG_DEBUG, request_id, "%s Exit", __func__);
@@ -221,16 +221,11 @@ void s3_motr_op_failed(struct m0_op *op) {
   }
   free(ctx);
   if (app_ctx->incr_response_count() == app_ctx->get_ops_count()) {
-    struct user_event_context *user_ctx = (struct user_event_context *)calloc(
-        1, sizeof(struct user_event_context));
-    user_ctx->app_ctx = app_ctx;
     app_ctx->stop_timer(false);
 #ifdef S3_GOOGLE_TEST
-    evutil_socket_t test_sock = 0;
-    short events = 0;
-    motr_op_done_on_main_thread(test_sock, events, (void *)user_ctx);
+    motr_op_done(app_ctx);
 #else
-    S3PostToMainLoop((void *)user_ctx)(motr_op_done_on_main_thread, request_id);
+    s3_post_completion(motr_op_done, app_ctx, request_id);
 #endif  // S3_GOOGLE_TEST
   }
   s3_log(S3_LOG_DEBUG, request_id, "%s Exit", __func__);
@@ -245,15 +240,10 @@ void s3_motr_op_pre_launch_failure(void *application_context, int rc) {
   s3_log(S3_LOG_DEBUG, request_id, "Error code = %d\n", rc);
   app_ctx->set_op_errno_for(0, rc);
   app_ctx->set_op_status_for(0, S3AsyncOpStatus::failed, "Operation Failed.");
-  struct user_event_context *user_ctx =
-      (struct user_event_context *)calloc(1, sizeof(struct user_event_context));
-  user_ctx->app_ctx = app_ctx;
 #ifdef S3_GOOGLE_TEST
-  evutil_socket_t test_sock = 0;
-  short events = 0;
-  motr_op_done_on_main_thread(test_sock, events, (void *)user_ctx);
+  motr_op_done(app_ctx);
 #else
-  S3PostToMainLoop((void *)user_ctx)(motr_op_done_on_main_thread, request_id);
+  s3_post_completion(motr_op_done, app_ctx, request_id);
 #endif  // S3_GOOGLE_TEST
   s3_log(S3_LOG_DEBUG, request_id, "%s Exit", __func__);
 }
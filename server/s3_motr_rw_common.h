@@ -34,6 +34,10 @@ EXTERN_C_BLOCK_BEGIN
 /* libevhtp */
 #include <evhtp.h>
 
+// Invokes handlers of the S3AsyncOpContextBase 'app_ctx' once all its ops
+// are done, run on main thread.
+void motr_op_done(void *app_ctx);
+
 void motr_op_done_on_main_thread(evutil_socket_t, short events,
                                  void *user_data);
 
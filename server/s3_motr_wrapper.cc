@@ -24,6 +24,7 @@
 #include "s3_log.h"
 #include "s3_fake_motr_redis_kvs.h"
 #include "s3_addb.h"
+#include "s3_motr_emulator.h"
 
 extern struct m0_ufid_generator s3_ufid_generator;
 
@@ -91,20 +92,36 @@ void ConcreteMotrAPI::motr_op_launch_addb_add(uint64_t addb_request_id,
 
 void ConcreteMotrAPI::motr_idx_init(struct m0_idx *idx, struct m0_realm *parent,
                                     const struct m0_uint128 *id) {
+  if (S3MotrEmulator *emulator = s3_motr_emulator()) {
+    emulator->motr_idx_init(idx, parent, id);
+    return;
+  }
   m0_idx_init(idx, parent, id);
 }
 
 void ConcreteMotrAPI::motr_obj_init(struct m0_obj *obj, struct m0_realm *parent,
                                     const struct m0_uint128 *id,
                                     int layout_id) {
+  if (S3MotrEmulator *emulator = s3_motr_emulator()) {
+    emulator->motr_obj_init(obj, parent, id, layout_id);
+    return;
+  }
   m0_obj_init(obj, parent, id, layout_id);
 }
 
-void ConcreteMotrAPI::motr_obj_fini(struct m0_obj *obj) { m0_obj_fini(obj); }
+void ConcreteMotrAPI::motr_obj_fini(struct m0_obj *obj) {
+  if (S3MotrEmulator *emulator = s3_motr_emulator()) {
+    emulator->motr_obj_fini(obj);
+    return;
+  }
+  m0_obj_fini(obj);
+}
 
 int ConcreteMotrAPI::motr_sync_op_init(struct m0_op **sync_op) {
   if (s3_fi_is_enabled("motr_sync_op_init_fail")) {
     return -1;
+  } else if (S3MotrEmulator *emulator = s3_motr_emulator()) {
+    return emulator->motr_sync_op_init(sync_op);
   } else {
     return m0_sync_op_init(sync_op);
   }
@@ -115,6 +132,9 @@ int ConcreteMotrAPI::motr_sync_entity_add(struct m0_op *sync_op,
   if (is_motr_sync_should_be_faked()) {
     return 0;
   }
+  if (S3MotrEmulator *emulator = s3_motr_emulator()) {
+    return emulator->motr_sync_entity_add(sync_op, entity);
+  }
   return m0_sync_entity_add(sync_op, entity);
 }
 
@@ -122,6 +142,9 @@ int ConcreteMotrAPI::motr_sync_op_add(struct m0_op *sync_op, struct m0_op *op) {
   if (is_motr_sync_should_be_faked()) {
     return 0;
   }
+  if (S3MotrEmulator *emulator = s3_motr_emulator()) {
+    return emulator->motr_sync_op_add(sync_op, op);
+  }
   return m0_sync_op_add(sync_op, op);
 }
 
@@ -129,6 +152,8 @@ int ConcreteMotrAPI::motr_entity_open(struct m0_entity *entity,
                                       struct m0_op **op) {
   if (s3_fi_is_enabled("motr_entity_open_fail")) {
     return -1;
+  } else if (S3MotrEmulator *emulator = s3_motr_emulator()) {
+    return emulator->motr_entity_open(entity, op);
   } else {
     return m0_entity_open(entity, op);
   }
@@ -138,6 +163,8 @@ int ConcreteMotrAPI::motr_entity_create(struct m0_entity *entity,
                                         struct m0_op **op) {
   if (s3_fi_is_enabled("motr_entity_create_fail")) {
     return -1;
+  } else if (S3MotrEmulator *emulator = s3_motr_emulator()) {
+    return emulator->motr_entity_create(entity, op);
   } else {
     return m0_entity_create(NULL, entity, op);
   }
@@ -147,6 +174,8 @@ int ConcreteMotrAPI::motr_entity_delete(struct m0_entity *entity,
                                         struct m0_op **op) {
   if (s3_fi_is_enabled("motr_entity_delete_fail")) {
     return -1;
+  } else if (S3MotrEmulator *emulator = s3_motr_emulator()) {
+    return emulator->motr_entity_delete(entity, op);
   } else {
     return m0_entity_delete(entity, op);
   }
@@ -155,6 +184,10 @@ int ConcreteMotrAPI::motr_entity_delete(struct m0_entity *entity,
 void ConcreteMotrAPI::motr_op_setup(struct m0_op *op,
                                     const struct m0_op_ops *ops,
                                     m0_time_t linger) {
+  if (S3MotrEmulator *emulator = s3_motr_emulator()) {
+    emulator->motr_op_setup(op, ops, linger);
+    return;
+  }
   m0_op_setup(op, ops, linger);
 }
 
@@ -164,12 +197,20 @@ int ConcreteMotrAPI::motr_idx_op(struct m0_idx *idx, enum m0_idx_opcode opcode,
                                  struct m0_op **op) {
   if (s3_fi_is_enabled("motr_idx_op_fail")) {
     return -1;
+  } else if (S3MotrEmulator *emulator = s3_motr_emulator()) {
+    return emulator->motr_idx_op(idx, opcode, keys, vals, rcs, flags, op);
   } else {
     return m0_idx_op(idx, opcode, keys, vals, rcs, flags, op);
   }
 }
 
-void ConcreteMotrAPI::motr_idx_fini(struct m0_idx *idx) { m0_idx_fini(idx); }
+void ConcreteMotrAPI::motr_idx_fini(struct m0_idx *idx) {
+  if (S3MotrEmulator *emulator = s3_motr_emulator()) {
+    emulator->motr_idx_fini(idx);
+    return;
+  }
+  m0_idx_fini(idx);
+}
 
 int ConcreteMotrAPI::motr_obj_op(struct m0_obj *obj, enum m0_obj_opcode opcode,
                                  struct m0_indexvec *ext,
@@ -188,6 +229,10 @@ int ConcreteMotrAPI::motr_obj_op(struct m0_obj *obj, enum m0_obj_opcode opcode,
     (*op)->op_sm.sm_state = M0_OS_INITIALISED;
     return 0;
   }
+  if (S3MotrEmulator *emulator = s3_motr_emulator()) {
+    return emulator->motr_obj_op(obj, opcode, ext, data, attr, mask, flags,
+                                 op);
+  }
   return m0_obj_op(obj, opcode, ext, data, attr, mask, flags, op);
 }
 
@@ -237,6 +282,8 @@ void ConcreteMotrAPI::motr_op_launch(uint64_t addb_request_id,
              (type == MotrOpType::getkv &&
               s3_fi_is_enabled("motr_kv_get_fail"))) {
     motr_fi_op_launch(op, nr);
+  } else if (S3MotrEmulator *emulator = s3_motr_emulator()) {
+    emulator->motr_op_launch(addb_request_id, op, nr, type);
   } else {
     s3_log(S3_LOG_DEBUG, "", "m0_op_launch will be used");
     m0_op_launch(op, nr);
@@ -246,11 +293,22 @@ void ConcreteMotrAPI::motr_op_launch(uint64_t addb_request_id,
 // Used for sync motr calls
 int ConcreteMotrAPI::motr_op_wait(m0_op *op, uint64_t bits,
                                   m0_time_t op_wait_period) {
+  if (S3MotrEmulator *emulator = s3_motr_emulator()) {
+    return emulator->motr_op_wait(op, bits, op_wait_period);
+  }
   return m0_op_wait(op, bits, op_wait_period);
 }
 
-int ConcreteMotrAPI::motr_op_rc(const struct m0_op *op) { return m0_rc(op); }
+int ConcreteMotrAPI::motr_op_rc(const struct m0_op *op) {
+  if (S3MotrEmulator *emulator = s3_motr_emulator()) {
+    return emulator->motr_op_rc(op);
+  }
+  return m0_rc(op);
+}
 
 int ConcreteMotrAPI::m0_h_ufid_next(struct m0_uint128 *ufid) {
+  if (S3MotrEmulator *emulator = s3_motr_emulator()) {
+    return emulator->m0_h_ufid_next(ufid);
+  }
   return m0_ufid_next(&s3_ufid_generator, 1, ufid);
 }
@@ -411,6 +411,46 @@ void S3MotrWiter::write_content(std::function<void(void)> on_success,
   handler_on_failed = std::move(on_failed);
   this->buffer_sequence = std::move(buffer_sequence);
   this->size_of_each_buf = size_of_each_buf;
+  extents_to_write.clear();
+
+  state = S3MotrWiterOpState::writing;
+
+  // We should already have an OID
+  assert(oid_list.size() == 1);
+
+  if (is_object_opened) {
+    write_content();
+  } else {
+    open_objects();
+  }
+
+  s3_log(S3_LOG_DEBUG, "", "%s Exit", __func__);
+}
+
+void S3MotrWiter::write_content_at(std::function<void(void)> on_success,
+                                   std::function<void(void)> on_failed,
+                                   S3BufferSequence buffer_sequence,
+                                   S3MotrExtents extents) {
+  s3_log(S3_LOG_INFO, stripped_request_id,
+         "%s Entry with %zu extents of %zu bytes in total\n", __func__,
+         extents.size(), s3_motr_extents_total_size(extents));
+
+  assert(!buffer_sequence.empty());
+  assert(s3_motr_extents_aligned(extents, 4096));
+
+#ifndef NDEBUG
+  size_t buffers_size = 0;
+  for (const auto &ptr_n_len : buffer_sequence) {
+    assert(!(ptr_n_len.second & 0xFFF));  // len % 4096 == 0
+    buffers_size += ptr_n_len.second;
+  }
+  assert(buffers_size == s3_motr_extents_total_size(extents));
+#endif  // NDEBUG
+
+  handler_on_success = std::move(on_success);
+  handler_on_failed = std::move(on_failed);
+  this->buffer_sequence = std::move(buffer_sequence);
+  extents_to_write = std::move(extents);
 
   state = S3MotrWiterOpState::writing;
 
@@ -433,25 +473,32 @@ void S3MotrWiter::write_content() {
 
   assert(is_object_opened);
 
-  const size_t motr_unit_size =
-      S3MotrLayoutMap::get_instance()->get_unit_size_for_layout(layout_ids[0]);
-  size_t motr_buf_count = buffer_sequence.size();
-
-  // bump the count so we write at least multiple of motr_unit_size
-  s3_log(S3_LOG_DEBUG, request_id, "motr_buf_count without padding: %zu\n",
-         motr_buf_count);
-
-  const size_t buffers_per_unit = motr_unit_size / size_of_each_buf;
-
-  if (buffers_per_unit > 1) {
-    size_t buffers_in_last_unit =
-        motr_buf_count % buffers_per_unit;  // marked to send till now
-    if (buffers_in_last_unit > 0) {
-      size_t pad_buf_count = buffers_per_unit - buffers_in_last_unit;
-      s3_log(S3_LOG_DEBUG, request_id, "padding with %zu buffers",
-             pad_buf_count);
-      motr_buf_count += pad_buf_count;
+  size_t motr_buf_count;
+  if (extents_to_write.empty()) {
+    const size_t motr_unit_size =
+        S3MotrLayoutMap::get_instance()->get_unit_size_for_layout(
+            layout_ids[0]);
+    motr_buf_count = buffer_sequence.size();
+
+    // bump the count so we write at least multiple of motr_unit_size
+    s3_log(S3_LOG_DEBUG, request_id, "motr_buf_count without padding: %zu\n",
+           motr_buf_count);
+
+    const size_t buffers_per_unit = motr_unit_size / size_of_each_buf;
+
+    if (buffers_per_unit > 1) {
+      size_t buffers_in_last_unit =
+          motr_buf_count % buffers_per_unit;  // marked to send till now
+      if (buffers_in_last_unit > 0) {
+        size_t pad_buf_count = buffers_per_unit - buffers_in_last_unit;
+        s3_log(S3_LOG_DEBUG, request_id, "padding with %zu buffers",
+               pad_buf_count);
+        motr_buf_count += pad_buf_count;
+      }
     }
+  } else {
+    motr_buf_count =
+        s3_motr_extents_segment_count(buffer_sequence, extents_to_write);
   }
   writer_context.reset(new S3MotrWiterContext(
       request, std::bind(&S3MotrWiter::write_content_successful, this),
@@ -474,7 +521,12 @@ void S3MotrWiter::write_content() {
   ctx->cbs[0].oop_stable = s3_motr_op_stable;
   ctx->cbs[0].oop_failed = s3_motr_op_failed;
 
-  set_up_motr_data_buffers(rw_ctx, std::move(buffer_sequence), motr_buf_count);
+  if (extents_to_write.empty()) {
+    set_up_motr_data_buffers(rw_ctx, std::move(buffer_sequence),
+                             motr_buf_count);
+  } else {
+    set_up_motr_extent_buffers(rw_ctx);
+  }
 
   // see also similar code in S3MotrReader::read_object_successful()
   if (s3_di_fi_is_enabled("di_data_corrupted_on_write")) {
@@ -515,7 +567,7 @@ void S3MotrWiter::write_content() {
 
   ctx->ops[0]->op_datum = (void *)op_ctx;
   s3_motr_api->motr_op_setup(ctx->ops[0], &ctx->cbs[0], 0);
-  writer_context->start_timer_for("write_to_motr_op");
+  writer_context->start_timer_for("write_to_motr_op", S3TraceCategory::io);
 
   s3_log(S3_LOG_INFO, stripped_request_id,
          "Motr API: Write (operation: M0_OC_WRITE, oid: ("
@@ -626,7 +678,8 @@ void S3MotrWiter::delete_objects() {
            sizeof(struct m0_fid));
   }
 
-  delete_context->start_timer_for("delete_objects_from_motr");
+  delete_context->start_timer_for("delete_objects_from_motr",
+                                  S3TraceCategory::io);
 
   s3_log(S3_LOG_INFO, stripped_request_id, "Motr API: deleteobj(oid: %s)\n",
          oid_list_stream.str().c_str());
@@ -777,6 +830,25 @@ void S3MotrWiter::set_up_motr_data_buffers(struct s3_motr_rw_op_context *rw_ctx,
   s3_log(S3_LOG_DEBUG, "", "%s Exit", __func__);
 }
 
+void S3MotrWiter::set_up_motr_extent_buffers(
+    struct s3_motr_rw_op_context *rw_ctx) {
+  s3_log(S3_LOG_DEBUG, request_id, "%s Entry\n", __func__);
+
+  s3_motr_extents_set_up(buffer_sequence, extents_to_write, rw_ctx);
+
+  size_in_current_write = 0;
+  for (const auto &ptr_n_len : buffer_sequence) {
+    md5crypt.Update((const char *)ptr_n_len.first, ptr_n_len.second);
+    size_in_current_write += ptr_n_len.second;
+  }
+  buffer_sequence.clear();
+
+  s3_log(S3_LOG_DEBUG, request_id, "size_in_current_write = %zu\n",
+         size_in_current_write);
+
+  s3_log(S3_LOG_DEBUG, "", "%s Exit", __func__);
+}
+
 struct m0_fid *S3MotrWiter::get_ppvid() const {
   return obj_ctx && obj_ctx->n_initialized_contexts && obj_ctx->objs
              ? &obj_ctx->objs->ob_attr.oa_pver
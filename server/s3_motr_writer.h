@@ -29,6 +29,7 @@
 
 #include "s3_asyncop_context_base.h"
 #include "s3_motr_context.h"
+#include "s3_motr_extents.h"
 #include "s3_motr_wrapper.h"
 #include "s3_log.h"
 #include "s3_md5_hash.h"
@@ -123,6 +124,8 @@ class S3MotrWiter {
   // buffer currently used to write, will be freed on completion
   S3BufferSequence buffer_sequence;
   size_t size_of_each_buf;
+  // Set by write_content_at(), written instead of data at last_index.
+  S3MotrExtents extents_to_write;
 
   // fill entire object with zeroes after checksum calculation, but before
   // writing to Motr
@@ -203,6 +206,15 @@ class S3MotrWiter {
                              S3BufferSequence buffer_sequence,
                              size_t size_of_each_buf);
 
+  // Async vectored save of the buffers to several ranges of the object in
+  // one Motr op.  Data of extent k follows data of extent k - 1 in the
+  // buffers, which must hold exactly the total size of extents.  Extents
+  // and buffers must be 4k aligned.  last_index is not changed.
+  virtual void write_content_at(std::function<void(void)> on_success,
+                                std::function<void(void)> on_failed,
+                                S3BufferSequence buffer_sequence,
+                                S3MotrExtents extents);
+
   // Async delete operation.
   // TODO: add pool version id into BackgroundDelete memo
   virtual void delete_object(std::function<void(void)> on_success,
@@ -222,6 +234,7 @@ class S3MotrWiter {
   void set_up_motr_data_buffers(struct s3_motr_rw_op_context* rw_ctx,
                                 S3BufferSequence buffer_sequence,
                                 size_t motr_buf_count);
+  void set_up_motr_extent_buffers(struct s3_motr_rw_op_context* rw_ctx);
   struct m0_fid* get_ppvid() const;
 
   // For Testing purpose
@@ -244,6 +257,7 @@ class S3MotrWiter {
   FRIEND_TEST(S3MotrWiterTest, OpenObjectsFailedMissingTest);
   FRIEND_TEST(S3MotrWiterTest, WriteContentSuccessfulTest);
   FRIEND_TEST(S3MotrWiterTest, WriteContentFailedTest);
+  FRIEND_TEST(S3MotrWiterTest, WriteContentAtTest);
 };
 
 #endif
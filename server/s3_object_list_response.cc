@@ -21,7 +21,6 @@
 
 #include <evhttp.h>
 #include "s3_object_list_response.h"
-#include "s3_common_utilities.h"
 #include "s3_log.h"
 
 S3ObjectListResponse::S3ObjectListResponse(std::string encoding_type)
@@ -36,7 +35,8 @@ S3ObjectListResponse::S3ObjectListResponse(std::string encoding_type)
       max_uploads(""),
       next_marker_uploadid(""),
       key_count(""),
-      response_xml("") {
+      response_xml(""),
+      contents_on_add(false) {
   s3_log(S3_LOG_DEBUG, "", "%s Ctor\n", __func__);
   object_list.clear();
   part_list.clear();
@@ -119,12 +119,30 @@ void S3ObjectListResponse::set_next_marker_uploadid(std::string next) {
 
 std::string& S3ObjectListResponse::get_object_name() { return object_name; }
 
+void S3ObjectListResponse::render_contents_on_add(
+    const std::string& requestor_canonical_id,
+    const std::string& bucket_owner_user_id,
+    const std::string& requestor_user_id) {
+  this->requestor_canonical_id = requestor_canonical_id;
+  this->bucket_owner_user_id = bucket_owner_user_id;
+  this->requestor_user_id = requestor_user_id;
+  contents_on_add = true;
+}
+
 void S3ObjectListResponse::add_object(
     std::shared_ptr<S3ObjectMetadata> object) {
-  object_list.push_back(object);
+  if (contents_on_add) {
+    S3XmlWriter writer(contents_xml);
+    rendered_keys.push_back(object->get_object_name());
+    add_contents(writer, *object, rendered_keys.back());
+  } else {
+    object_list.push_back(object);
+  }
 }
 
-unsigned int S3ObjectListResponse::size() { return object_list.size(); }
+unsigned int S3ObjectListResponse::size() {
+  return rendered_keys.size() + object_list.size();
+}
 
 unsigned int S3ObjectListResponse::common_prefixes_size() {
   return common_prefixes.size();
@@ -195,64 +213,75 @@ std::string S3ObjectListResponse::get_next_marker_key() {
   return raw_value;
 }
 
+bool S3ObjectListResponse::is_owner_shown(S3ObjectMetadata& object) {
+  return requestor_canonical_id == object.get_canonical_id() ||
+         bucket_owner_user_id == requestor_user_id;
+}
+
+void S3ObjectListResponse::add_contents(S3XmlWriter& writer,
+                                        S3ObjectMetadata& object,
+                                        const std::string& key) {
+  writer.open("Contents");
+  writer.element("Key", get_response_format_key_value(key));
+  writer.element("LastModified", object.get_last_modified_iso());
+  writer.element("ETag", object.get_md5(), true);
+  writer.element("Size", object.get_content_length_str());
+  writer.element("StorageClass", object.get_storage_class());
+  if (is_owner_shown(object)) {
+    writer.open("Owner");
+    writer.element("ID", object.get_canonical_id());
+    writer.element("DisplayName", object.get_account_name());
+    writer.close("Owner");
+  }
+  writer.close("Contents");
+}
+
+size_t S3ObjectListResponse::get_xml_size_hint() {
+  // Rough size of the fixed elements and of a <Contents> with a short key.
+  return 1024 + contents_xml.size() + object_list.size() * 384 +
+         common_prefixes.size() * 64;
+}
+
 std::string& S3ObjectListResponse::get_xml(
     const std::string requestor_canonical_id,
     const std::string bucket_owner_user_id,
     const std::string requestor_user_id) {
-  // clang-format off
-  response_xml = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>";
-  response_xml +=
-      "<ListBucketResult xmlns=\"http://s3.amazonaws.com/doc/2006-03-01/\">";
-  response_xml += S3CommonUtilities::format_xml_string("Name", bucket_name);
-  response_xml +=
-      S3CommonUtilities::format_xml_string("Prefix", request_prefix);
+  this->requestor_canonical_id = requestor_canonical_id;
+  this->bucket_owner_user_id = bucket_owner_user_id;
+  this->requestor_user_id = requestor_user_id;
+
+  response_xml.clear();
+  response_xml.reserve(get_xml_size_hint());
+  S3XmlWriter writer(response_xml);
+  writer.raw("<?xml version=\"1.0\" encoding=\"UTF-8\"?>");
+  writer.raw(
+      "<ListBucketResult xmlns=\"http://s3.amazonaws.com/doc/2006-03-01/\">");
+  writer.element("Name", bucket_name);
+  writer.element("Prefix", request_prefix);
   // When 'Delimiter' is specified in the request, the response should have
   // 'Delimiter'
   if (!this->get_request_delimiter().empty()) {
-    response_xml +=
-        S3CommonUtilities::format_xml_string("Delimiter", request_delimiter);
+    writer.element("Delimiter", request_delimiter);
   }
   if (encoding_type == "url") {
-    response_xml += S3CommonUtilities::format_xml_string("EncodingType", "url");
+    writer.element("EncodingType", "url");
   }
-  response_xml +=
-      S3CommonUtilities::format_xml_string("Marker", request_marker_key);
-  response_xml += S3CommonUtilities::format_xml_string("MaxKeys", max_keys);
+  writer.element("Marker", request_marker_key);
+  writer.element("MaxKeys", max_keys);
   // When is_truncated is true, the response should have "NextMarker".
   // Refer AWS S3 ListObjects documentation for NextMarker.
   if (this->response_is_truncated) {
-    response_xml +=
-        S3CommonUtilities::format_xml_string("NextMarker", next_marker_key);
+    writer.element("NextMarker", next_marker_key);
   }
-  response_xml += S3CommonUtilities::format_xml_string(
-      "IsTruncated", (response_is_truncated ? "true" : "false"));
+  writer.element("IsTruncated", (response_is_truncated ? "true" : "false"));
 
+  response_xml += contents_xml;
   for (auto&& object : object_list) {
-    response_xml += "<Contents>";
-    response_xml += S3CommonUtilities::format_xml_string(
-        "Key", get_response_format_key_value(object->get_object_name()));
-    response_xml += S3CommonUtilities::format_xml_string(
-        "LastModified", object->get_last_modified_iso());
-    response_xml +=
-        S3CommonUtilities::format_xml_string("ETag", object->get_md5(), true);
-    response_xml += S3CommonUtilities::format_xml_string(
-        "Size", object->get_content_length_str());
-    response_xml += S3CommonUtilities::format_xml_string(
-        "StorageClass", object->get_storage_class());
-    if (requestor_canonical_id == object->get_canonical_id() ||
-        bucket_owner_user_id == requestor_user_id) {
-    response_xml += "<Owner>";
-    response_xml +=
-        S3CommonUtilities::format_xml_string("ID", object->get_canonical_id());
-    response_xml += S3CommonUtilities::format_xml_string(
-        "DisplayName", object->get_account_name());
-    response_xml += "</Owner>";
-    }
-    response_xml += "</Contents>";
+    add_contents(writer, *object, object->get_object_name());
   }
 
   for (auto&& prefix : common_prefixes) {
-    response_xml += "<CommonPrefixes>";
+    writer.open("CommonPrefixes");
     std::string prefix_no_delimiter = prefix;
     // Remove the delimiter from the end
     prefix_no_delimiter.pop_back();
@@ -260,126 +289,101 @@ std::string& S3ObjectListResponse::get_xml(
         get_response_format_key_value(prefix_no_delimiter);
     // Add the delimiter at the end
     uri_encode_prefix += request_delimiter;
-    response_xml +=
-        S3CommonUtilities::format_xml_string("Prefix", uri_encode_prefix);
-    response_xml += "</CommonPrefixes>";
+    writer.element("Prefix", uri_encode_prefix);
+    writer.close("CommonPrefixes");
   }
 
-  response_xml += "</ListBucketResult>";
-  // clang-format on
+  writer.raw("</ListBucketResult>");
   return response_xml;
 }
 
 std::string& S3ObjectListResponse::get_multiupload_xml() {
-  // clang-format off
-  response_xml = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>";
-  response_xml +=
+  response_xml.clear();
+  response_xml.reserve(1024 + object_list.size() * 512 +
+                       common_prefixes.size() * 64);
+  S3XmlWriter writer(response_xml);
+  writer.raw("<?xml version=\"1.0\" encoding=\"UTF-8\"?>");
+  writer.raw(
       "<ListMultipartUploadsResult "
-      "xmlns=\"http://s3.amazonaws.com/doc/2006-03-01/\">";
-  response_xml += S3CommonUtilities::format_xml_string("Bucket", bucket_name);
-  response_xml +=
-      S3CommonUtilities::format_xml_string("KeyMarker", request_marker_key);
-  response_xml += S3CommonUtilities::format_xml_string("UploadIdMarker",
-                                                       request_marker_uploadid);
-  response_xml +=
-      S3CommonUtilities::format_xml_string("NextKeyMarker", next_marker_key);
-  response_xml += S3CommonUtilities::format_xml_string("NextUploadIdMarker",
-                                                       next_marker_uploadid);
-  response_xml +=
-      S3CommonUtilities::format_xml_string("MaxUploads", max_uploads);
-  response_xml += S3CommonUtilities::format_xml_string(
-      "IsTruncated", (response_is_truncated ? "true" : "false"));
+      "xmlns=\"http://s3.amazonaws.com/doc/2006-03-01/\">");
+  writer.element("Bucket", bucket_name);
+  writer.element("KeyMarker", request_marker_key);
+  writer.element("UploadIdMarker", request_marker_uploadid);
+  writer.element("NextKeyMarker", next_marker_key);
+  writer.element("NextUploadIdMarker", next_marker_uploadid);
+  writer.element("MaxUploads", max_uploads);
+  writer.element("IsTruncated", (response_is_truncated ? "true" : "false"));
 
   if (encoding_type == "url") {
-    response_xml += S3CommonUtilities::format_xml_string("EncodingType", "url");
+    writer.element("EncodingType", "url");
   }
 
   for (auto&& object : object_list) {
-    response_xml += "<Upload>";
-    response_xml += S3CommonUtilities::format_xml_string(
-        "Key", get_response_format_key_value(object->get_object_name()));
-    response_xml += S3CommonUtilities::format_xml_string(
-        "UploadId", object->get_upload_id());
-    response_xml += "<Initiator>";
-    response_xml +=
-        S3CommonUtilities::format_xml_string("ID", object->get_user_id());
-    response_xml += S3CommonUtilities::format_xml_string(
-        "DisplayName", object->get_user_name());
-    response_xml += "</Initiator>";
-    response_xml += "<Owner>";
-    response_xml +=
-        S3CommonUtilities::format_xml_string("ID", object->get_user_id());
-    response_xml += S3CommonUtilities::format_xml_string(
-        "DisplayName", object->get_user_name());
-    response_xml += "</Owner>";
-    response_xml += S3CommonUtilities::format_xml_string("StorageClass",
-                                                         get_storage_class());
-    response_xml += S3CommonUtilities::format_xml_string(
-        "Initiated", object->get_last_modified_iso());
-    response_xml += "</Upload>";
+    writer.open("Upload");
+    writer.element("Key",
+                   get_response_format_key_value(object->get_object_name()));
+    writer.element("UploadId", object->get_upload_id());
+    writer.open("Initiator");
+    writer.element("ID", object->get_user_id());
+    writer.element("DisplayName", object->get_user_name());
+    writer.close("Initiator");
+    writer.open("Owner");
+    writer.element("ID", object->get_user_id());
+    writer.element("DisplayName", object->get_user_name());
+    writer.close("Owner");
+    writer.element("StorageClass", get_storage_class());
+    writer.element("Initiated", object->get_last_modified_iso());
+    writer.close("Upload");
   }
 
   for (auto&& prefix : common_prefixes) {
-    response_xml += "<CommonPrefixes>";
-    response_xml += S3CommonUtilities::format_xml_string("Prefix", prefix);
-    response_xml += "</CommonPrefixes>";
+    writer.open("CommonPrefixes");
+    writer.element("Prefix", prefix);
+    writer.close("CommonPrefixes");
   }
 
-  response_xml += "</ListMultipartUploadsResult>";
-  // clang-format on
+  writer.raw("</ListMultipartUploadsResult>");
   return response_xml;
 }
 
 std::string& S3ObjectListResponse::get_multipart_xml() {
-  // clang-format off
-  response_xml = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>";
-  response_xml +=
-      "<ListPartsResult xmlns=\"http://s3.amazonaws.com/doc/2006-03-01/\">";
-  response_xml += S3CommonUtilities::format_xml_string("Bucket", bucket_name);
-  response_xml += S3CommonUtilities::format_xml_string(
-      "Key", get_response_format_key_value(get_object_name()));
-  response_xml +=
-      S3CommonUtilities::format_xml_string("UploadID", get_upload_id());
-  response_xml += "<Initiator>";
-  response_xml += S3CommonUtilities::format_xml_string("ID", get_user_id());
-  response_xml +=
-      S3CommonUtilities::format_xml_string("DisplayName", get_user_name());
-  response_xml += "</Initiator>";
-  response_xml += "<Owner>";
-  response_xml += S3CommonUtilities::format_xml_string("ID", get_account_id());
-  response_xml +=
-      S3CommonUtilities::format_xml_string("DisplayName", get_account_name());
-  response_xml += "</Owner>";
-  response_xml +=
-      S3CommonUtilities::format_xml_string("StorageClass", get_storage_class());
-  response_xml += S3CommonUtilities::format_xml_string("PartNumberMarker",
-                                                       request_marker_key);
-  response_xml += S3CommonUtilities::format_xml_string(
-      "NextPartNumberMarker",
-      (next_marker_key.empty() ? "0" : next_marker_key));
-  response_xml += S3CommonUtilities::format_xml_string("MaxParts", max_parts);
-  response_xml += S3CommonUtilities::format_xml_string(
-      "IsTruncated", (response_is_truncated ? "true" : "false"));
+  response_xml.clear();
+  response_xml.reserve(1024 + part_list.size() * 192);
+  S3XmlWriter writer(response_xml);
+  writer.raw("<?xml version=\"1.0\" encoding=\"UTF-8\"?>");
+  writer.raw(
+      "<ListPartsResult xmlns=\"http://s3.amazonaws.com/doc/2006-03-01/\">");
+  writer.element("Bucket", bucket_name);
+  writer.element("Key", get_response_format_key_value(get_object_name()));
+  writer.element("UploadID", get_upload_id());
+  writer.open("Initiator");
+  writer.element("ID", get_user_id());
+  writer.element("DisplayName", get_user_name());
+  writer.close("Initiator");
+  writer.open("Owner");
+  writer.element("ID", get_account_id());
+  writer.element("DisplayName", get_account_name());
+  writer.close("Owner");
+  writer.element("StorageClass", get_storage_class());
+  writer.element("PartNumberMarker", request_marker_key);
+  writer.element("NextPartNumberMarker",
+                 (next_marker_key.empty() ? "0" : next_marker_key));
+  writer.element("MaxParts", max_parts);
+  writer.element("IsTruncated", (response_is_truncated ? "true" : "false"));
 
   if (encoding_type == "url") {
-    response_xml += S3CommonUtilities::format_xml_string("EncodingType", "url");
+    writer.element("EncodingType", "url");
   }
 
   for (auto&& part : part_list) {
-    response_xml += "<Part>";
-    response_xml += S3CommonUtilities::format_xml_string(
-        "PartNumber", part.second->get_part_number());
-    response_xml += S3CommonUtilities::format_xml_string(
-        "LastModified", part.second->get_last_modified_iso());
-    response_xml += S3CommonUtilities::format_xml_string(
-        "ETag", part.second->get_md5(), true);
-    response_xml += S3CommonUtilities::format_xml_string(
-        "Size", part.second->get_content_length_str());
-    response_xml += "</Part>";
+    writer.open("Part");
+    writer.element("PartNumber", part.second->get_part_number());
+    writer.element("LastModified", part.second->get_last_modified_iso());
+    writer.element("ETag", part.second->get_md5(), true);
+    writer.element("Size", part.second->get_content_length_str());
+    writer.close("Part");
   }
 
-  response_xml += "</ListPartsResult>";
-  // clang-format on
-
+  writer.raw("</ListPartsResult>");
   return response_xml;
 }
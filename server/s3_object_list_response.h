@@ -31,6 +31,7 @@
 
 #include "s3_object_metadata.h"
 #include "s3_part_metadata.h"
+#include "s3_xml_writer.h"
 
 class S3ObjectListResponse {
   // value can be url or empty string
@@ -60,7 +61,21 @@ class S3ObjectListResponse {
   std::string key_count;
   std::string response_xml;
 
+  // Set by render_contents_on_add(), then objects are written to
+  // contents_xml as they are added and only their keys are kept.
+  bool contents_on_add;
+  std::string contents_xml;
+  std::vector<std::string> rendered_keys;
+  std::string requestor_canonical_id;
+  std::string bucket_owner_user_id;
+  std::string requestor_user_id;
+
   std::string get_response_format_key_value(const std::string& key_value);
+  virtual bool is_owner_shown(S3ObjectMetadata& object);
+  void add_contents(S3XmlWriter& writer, S3ObjectMetadata& object,
+                    const std::string& key);
+  // Expected size of the ListBucketResult.
+  size_t get_xml_size_hint();
 
  public:
   S3ObjectListResponse(std::string encoding_type = "");
@@ -88,7 +103,7 @@ class S3ObjectListResponse {
   std::string& get_object_name();
   bool is_response_truncated() { return response_is_truncated; }
   std::vector<std::string> get_keys() {
-    std::vector<std::string> keys;
+    std::vector<std::string> keys = rendered_keys;
     for (unsigned int i = 0; i < object_list.size(); i++) {
       keys.push_back(object_list[i]->get_object_name());
     }
@@ -96,6 +111,12 @@ class S3ObjectListResponse {
   }
   std::string get_encoding_type() { return encoding_type; }
 
+  // ListBucketResult <Contents> of objects added after this call are
+  // rendered at once, so object metadata is not held until the response.
+  // get_xml() must then be called with the same ids.
+  void render_contents_on_add(const std::string& requestor_canonical_id,
+                              const std::string& bucket_owner_user_id,
+                              const std::string& requestor_user_id);
   void add_object(std::shared_ptr<S3ObjectMetadata> object);
   void add_part(std::shared_ptr<S3PartMetadata> part);
   void add_common_prefix(std::string);
@@ -20,7 +20,6 @@
 
 #include <evhttp.h>
 #include "s3_object_list_v2_response.h"
-#include "s3_common_utilities.h"
 #include "s3_log.h"
 
 S3ObjectListResponseV2::S3ObjectListResponseV2(const std::string& encoding_type)
@@ -47,74 +46,56 @@ void S3ObjectListResponseV2::set_start_after(
   start_after = in_start_after;
 }
 
+bool S3ObjectListResponseV2::is_owner_shown(S3ObjectMetadata& object) {
+  return fetch_owner;
+}
+
 std::string& S3ObjectListResponseV2::get_xml(
     const std::string& requestor_canonical_id,
     const std::string& bucket_owner_user_id,
     const std::string& requestor_user_id) {
-  // clang-format off
-  response_xml = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>";
-  response_xml +=
-      "<ListBucketResult xmlns=\"http://s3.amazonaws.com/doc/2006-03-01/\">";
-  response_xml += S3CommonUtilities::format_xml_string("Name", bucket_name);
-  response_xml +=
-      S3CommonUtilities::format_xml_string("Prefix", request_prefix);
+  response_xml.clear();
+  response_xml.reserve(get_xml_size_hint());
+  S3XmlWriter writer(response_xml);
+  writer.raw("<?xml version=\"1.0\" encoding=\"UTF-8\"?>");
+  writer.raw(
+      "<ListBucketResult xmlns=\"http://s3.amazonaws.com/doc/2006-03-01/\">");
+  writer.element("Name", bucket_name);
+  writer.element("Prefix", request_prefix);
   // When 'Delimiter' is specified in the request, the response should have
   // 'Delimiter'
   if (!this->get_request_delimiter().empty()) {
-    response_xml +=
-        S3CommonUtilities::format_xml_string("Delimiter", request_delimiter);
+    writer.element("Delimiter", request_delimiter);
   }
   if (encoding_type == "url") {
-    response_xml += S3CommonUtilities::format_xml_string("EncodingType", "url");
+    writer.element("EncodingType", "url");
   }
-  response_xml += S3CommonUtilities::format_xml_string("KeyCount", key_count);
+  writer.element("KeyCount", key_count);
   // If 'continuation-token' specified in original request, include it in the
   // response
   if (cont_token_specified) {
-    response_xml += S3CommonUtilities::format_xml_string("ContinuationToken",
-                                                         continuation_token);
+    writer.element("ContinuationToken", continuation_token);
   }
-  response_xml += S3CommonUtilities::format_xml_string("MaxKeys", max_keys);
+  writer.element("MaxKeys", max_keys);
   // When is_truncated is true, the response should have
   // "NextContinuationToken".
   // Refer AWS S3 ListObjects V2 documentation for NextContinuationToken.
   if (this->response_is_truncated) {
-    response_xml += S3CommonUtilities::format_xml_string(
-        "NextContinuationToken", next_marker_key);
+    writer.element("NextContinuationToken", next_marker_key);
   }
   // If 'start-after' specified in request, include it in response
   if (!start_after.empty()) {
-    response_xml +=
-        S3CommonUtilities::format_xml_string("StartAfter", start_after);
+    writer.element("StartAfter", start_after);
   }
-  response_xml += S3CommonUtilities::format_xml_string(
-      "IsTruncated", (response_is_truncated ? "true" : "false"));
+  writer.element("IsTruncated", (response_is_truncated ? "true" : "false"));
 
+  response_xml += contents_xml;
   for (auto&& object : object_list) {
-    response_xml += "<Contents>";
-    response_xml += S3CommonUtilities::format_xml_string(
-        "Key", get_response_format_key_value(object->get_object_name()));
-    response_xml += S3CommonUtilities::format_xml_string(
-        "LastModified", object->get_last_modified_iso());
-    response_xml +=
-        S3CommonUtilities::format_xml_string("ETag", object->get_md5(), true);
-    response_xml += S3CommonUtilities::format_xml_string(
-        "Size", object->get_content_length_str());
-    response_xml += S3CommonUtilities::format_xml_string(
-        "StorageClass", object->get_storage_class());
-    if (this->fetch_owner) {
-      response_xml += "<Owner>";
-      response_xml += S3CommonUtilities::format_xml_string(
-          "ID", object->get_canonical_id());
-      response_xml += S3CommonUtilities::format_xml_string(
-          "DisplayName", object->get_account_name());
-      response_xml += "</Owner>";
-    }
-    response_xml += "</Contents>";
+    add_contents(writer, *object, object->get_object_name());
   }
 
   for (auto&& prefix : common_prefixes) {
-    response_xml += "<CommonPrefixes>";
+    writer.open("CommonPrefixes");
     std::string prefix_no_delimiter = prefix;
     // Remove the delimiter from the end
     prefix_no_delimiter.pop_back();
@@ -122,12 +103,10 @@ std::string& S3ObjectListResponseV2::get_xml(
         get_response_format_key_value(prefix_no_delimiter);
     // Add the delimiter at the end
     uri_encode_prefix += request_delimiter;
-    response_xml +=
-        S3CommonUtilities::format_xml_string("Prefix", uri_encode_prefix);
-    response_xml += "</CommonPrefixes>";
+    writer.element("Prefix", uri_encode_prefix);
+    writer.close("CommonPrefixes");
   }
 
-  response_xml += "</ListBucketResult>";
-  // clang-format on
+  writer.raw("</ListBucketResult>");
   return response_xml;
 }
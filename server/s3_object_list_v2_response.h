@@ -37,6 +37,8 @@ class S3ObjectListResponseV2 : public S3ObjectListResponse {
   // Continuation-token presen in original request
   bool cont_token_specified;
 
+  bool is_owner_shown(S3ObjectMetadata &object);
+
  public:
   S3ObjectListResponseV2(const std::string &encoding_type = "");
 
@@ -456,6 +456,9 @@ void S3ObjectMetadata::save(std::function<void(void)> on_success,
   if (is_multipart) {
     // Write only to multpart object list and not real object list in a bucket.
     save_metadata();
+  } else if (replaced_metadata_known &&
+             S3Option::get_instance()->is_parallel_metadata_save_enabled()) {
+    save_metadata_parallel();
   } else {
     // First write metadata to objects version list index for a bucket.
     // Next write metadata to object list index for a bucket.
@@ -463,6 +466,175 @@ void S3ObjectMetadata::save(std::function<void(void)> on_success,
   }
 }
 
+void S3ObjectMetadata::set_replaced_metadata(
+    std::shared_ptr<S3ObjectMetadata> replaced) {
+  replaced_metadata = std::move(replaced);
+  replaced_metadata_known = true;
+}
+
+void S3ObjectMetadata::save_metadata_parallel() {
+  s3_log(S3_LOG_DEBUG, request_id, "%s Entry\n", __func__);
+  assert(objects_version_list_index_oid.u_hi ||
+         objects_version_list_index_oid.u_lo);
+  assert(object_list_index_oid.u_hi || object_list_index_oid.u_lo);
+
+  pending_saves = 2;
+  version_metadata_saved = false;
+  object_metadata_saved = false;
+
+  motr_kv_version_writer =
+      mote_kv_writer_factory->create_motr_kvs_writer(request, s3_motr_api);
+  motr_kv_writer =
+      mote_kv_writer_factory->create_motr_kvs_writer(request, s3_motr_api);
+
+  motr_kv_version_writer->put_keyval(
+      objects_version_list_index_oid, get_version_key_in_index(),
+      this->version_entry_to_json(),
+      std::bind(&S3ObjectMetadata::save_version_metadata_parallel_successful,
+                this),
+      std::bind(&S3ObjectMetadata::save_version_metadata_parallel_failed,
+                this));
+  motr_kv_writer->put_keyval(
+      object_list_index_oid, object_name, this->to_json(),
+      std::bind(&S3ObjectMetadata::save_object_metadata_parallel_successful,
+                this),
+      std::bind(&S3ObjectMetadata::save_object_metadata_parallel_failed,
+                this));
+  s3_log(S3_LOG_DEBUG, "", "%s Exit", __func__);
+}
+
+void S3ObjectMetadata::save_version_metadata_parallel_successful() {
+  s3_log(S3_LOG_DEBUG, request_id, "Version metadata saved for Object [%s].\n",
+         object_name.c_str());
+  version_metadata_saved = true;
+  save_metadata_parallel_completed();
+}
+
+void S3ObjectMetadata::save_version_metadata_parallel_failed() {
+  s3_log(S3_LOG_ERROR, request_id,
+         "Version metadata save failed for Object [%s].\n",
+         object_name.c_str());
+  save_metadata_parallel_completed();
+}
+
+void S3ObjectMetadata::save_object_metadata_parallel_successful() {
+  s3_log(S3_LOG_DEBUG, request_id, "Object metadata saved for Object [%s].\n",
+         object_name.c_str());
+  object_metadata_saved = true;
+  save_metadata_parallel_completed();
+}
+
+void S3ObjectMetadata::save_object_metadata_parallel_failed() {
+  s3_log(S3_LOG_ERROR, request_id,
+         "Object metadata save failed for Object [%s].\n", object_name.c_str());
+  save_metadata_parallel_completed();
+}
+
+void S3ObjectMetadata::save_metadata_parallel_completed() {
+  assert(pending_saves > 0);
+  if (--pending_saves) {
+    return;
+  }
+  if (version_metadata_saved && object_metadata_saved) {
+    state = S3ObjectMetadataState::saved;
+    this->handler_on_success();
+    return;
+  }
+  if (motr_kv_version_writer->get_state() ==
+          S3MotrKVSWriterOpState::failed_to_launch ||
+      motr_kv_writer->get_state() ==
+          S3MotrKVSWriterOpState::failed_to_launch) {
+    state = S3ObjectMetadataState::failed_to_launch;
+  } else {
+    state = S3ObjectMetadataState::failed;
+  }
+  // Object list entry without version entry must not stay, version entry
+  // without object list entry is removed too, as no one refers to it.
+  if (object_metadata_saved) {
+    rollback_object_metadata();
+  } else if (version_metadata_saved) {
+    rollback_version_metadata();
+  } else {
+    this->handler_on_failed();
+  }
+}
+
+void S3ObjectMetadata::rollback_object_metadata() {
+  s3_log(S3_LOG_INFO, stripped_request_id, "%s Entry\n", __func__);
+  // Another request may have written the entry since, it is rolled back only
+  // while it still refers to this object.
+  motr_kv_reader =
+      motr_kv_reader_factory->create_motr_kvs_reader(request, s3_motr_api);
+  motr_kv_reader->get_keyval(
+      object_list_index_oid, object_name,
+      std::bind(&S3ObjectMetadata::rollback_object_metadata_loaded, this),
+      std::bind(&S3ObjectMetadata::rollback_object_metadata_load_failed,
+                this));
+}
+
+void S3ObjectMetadata::rollback_object_metadata_loaded() {
+  Json::Value root;
+  Json::Reader reader;
+  if (!reader.parse(motr_kv_reader->get_value(), root) ||
+      root["motr_oid"].asString() != motr_oid_str) {
+    s3_log(S3_LOG_INFO, stripped_request_id,
+           "Object [%s] was written by another request, its object list "
+           "entry is kept\n",
+           object_name.c_str());
+    this->handler_on_failed();
+    return;
+  }
+  // Motr has no conditional write, a request which writes the entry between
+  // the read and this write is still undone.
+  if (replaced_metadata) {
+    // Overwrite of existing object, bring back its entry.
+    motr_kv_writer->put_keyval(
+        object_list_index_oid, object_name, replaced_metadata->to_json(),
+        std::bind(&S3ObjectMetadata::rollback_successful, this),
+        std::bind(&S3ObjectMetadata::rollback_failed, this));
+  } else {
+    motr_kv_writer->delete_keyval(
+        object_list_index_oid, object_name,
+        std::bind(&S3ObjectMetadata::rollback_successful, this),
+        std::bind(&S3ObjectMetadata::rollback_failed, this));
+  }
+}
+
+void S3ObjectMetadata::rollback_object_metadata_load_failed() {
+  if (motr_kv_reader->get_state() == S3MotrKVSReaderOpState::missing) {
+    s3_log(S3_LOG_INFO, stripped_request_id,
+           "Object [%s] was deleted by another request\n",
+           object_name.c_str());
+    this->handler_on_failed();
+  } else {
+    rollback_failed();
+  }
+}
+
+void S3ObjectMetadata::rollback_version_metadata() {
+  s3_log(S3_LOG_INFO, stripped_request_id, "%s Entry\n", __func__);
+  motr_kv_version_writer->delete_keyval(
+      objects_version_list_index_oid, get_version_key_in_index(),
+      std::bind(&S3ObjectMetadata::rollback_successful, this),
+      std::bind(&S3ObjectMetadata::rollback_failed, this));
+}
+
+void S3ObjectMetadata::rollback_successful() {
+  s3_log(S3_LOG_INFO, stripped_request_id,
+         "Partially saved metadata of Object [%s] is rolled back\n",
+         object_name.c_str());
+  this->handler_on_failed();
+}
+
+void S3ObjectMetadata::rollback_failed() {
+  s3_log(S3_LOG_ERROR, request_id,
+         "Rollback of partially saved metadata failed for Object [%s], "
+         "object list entry saved: %d, version entry saved: %d\n",
+         object_name.c_str(), (int)object_metadata_saved,
+         (int)version_metadata_saved);
+  this->handler_on_failed();
+}
+
 // Save to objects version list index
 void S3ObjectMetadata::save_version_metadata() {
   s3_log(S3_LOG_DEBUG, request_id, "%s Entry\n", __func__);
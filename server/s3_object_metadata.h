@@ -125,6 +125,14 @@ class S3ObjectMetadata : private S3ObjectMetadataCopyable {
   std::shared_ptr<S3MotrKVSWriter> motr_kv_writer;
   std::shared_ptr<S3BucketMetadata> bucket_metadata;
 
+  // Parallel save, see set_replaced_metadata().
+  bool replaced_metadata_known = false;
+  std::shared_ptr<S3ObjectMetadata> replaced_metadata;
+  std::shared_ptr<S3MotrKVSWriter> motr_kv_version_writer;
+  unsigned pending_saves = 0;
+  bool version_metadata_saved = false;
+  bool object_metadata_saved = false;
+
   // Used to report to caller.
   std::function<void()> handler_on_success;
   std::function<void()> handler_on_failed;
@@ -259,6 +267,12 @@ class S3ObjectMetadata : private S3ObjectMetadataCopyable {
   virtual void save(std::function<void(void)> on_success,
                     std::function<void(void)> on_failed);
 
+  // Entry of object list index which save() overwrites, nullptr if there is
+  // none.  Once it is known, save() writes versions list index and object list
+  // index concurrently (S3_PARALLEL_METADATA_SAVE_ENABLE) instead of one after
+  // another, as a failed write can be rolled back.
+  void set_replaced_metadata(std::shared_ptr<S3ObjectMetadata> replaced);
+
   // Save object metadata ONLY object list index
   virtual void save_metadata(std::function<void(void)> on_success,
                              std::function<void(void)> on_failed);
@@ -309,6 +323,21 @@ class S3ObjectMetadata : private S3ObjectMetadataCopyable {
   void save_version_metadata_successful();
   void save_version_metadata_failed();
 
+  // Writes to objects version list index and object list index concurrently
+  // and rolls back the one which succeeded, if the other one failed.
+  void save_metadata_parallel();
+  void save_version_metadata_parallel_successful();
+  void save_version_metadata_parallel_failed();
+  void save_object_metadata_parallel_successful();
+  void save_object_metadata_parallel_failed();
+  void save_metadata_parallel_completed();
+  void rollback_object_metadata();
+  void rollback_object_metadata_loaded();
+  void rollback_object_metadata_load_failed();
+  void rollback_version_metadata();
+  void rollback_successful();
+  void rollback_failed();
+
   // Remove entry from object list index
   void remove_object_metadata();
   void remove_object_metadata_successful();
@@ -348,6 +377,15 @@ class S3ObjectMetadata : private S3ObjectMetadataCopyable {
   FRIEND_TEST(S3ObjectMetadataTest, SaveMetadataSuccess);
   FRIEND_TEST(S3ObjectMetadataTest, SaveMetadataFailed);
   FRIEND_TEST(S3ObjectMetadataTest, SaveMetadataFailedToLaunch);
+  FRIEND_TEST(S3ObjectMetadataTest, SaveParallel);
+  FRIEND_TEST(S3ObjectMetadataTest, SaveParallelNotUsedIfReplacedUnknown);
+  FRIEND_TEST(S3ObjectMetadataTest, SaveParallelSuccess);
+  FRIEND_TEST(S3ObjectMetadataTest, SaveParallelBothFailed);
+  FRIEND_TEST(S3ObjectMetadataTest, SaveParallelVersionFailedRestoresReplaced);
+  FRIEND_TEST(S3ObjectMetadataTest, SaveParallelVersionFailedRemovesNew);
+  FRIEND_TEST(S3ObjectMetadataTest, SaveParallelRollbackKeepsNewerEntry);
+  FRIEND_TEST(S3ObjectMetadataTest, SaveParallelObjectFailedRemovesVersion);
+  FRIEND_TEST(S3ObjectMetadataTest, SaveParallelRollbackFailed);
   FRIEND_TEST(S3ObjectMetadataTest, Remove);
   FRIEND_TEST(S3ObjectMetadataTest, RemoveObjectMetadataSuccessful);
   FRIEND_TEST(S3ObjectMetadataTest, RemoveVersionMetadataSuccessful);
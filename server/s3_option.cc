@@ -97,6 +97,13 @@ bool S3Option::load_section(std::string section_name,
         S3_OPTION_VALUE_INVALID_AND_RET("S3_AUDIT_LOG_FORMAT_TYPE",
                                         audit_log_format_str);
       }
+      S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_AUDIT_LOG_ASYNC_ENABLE");
+      audit_log_async_enable =
+          s3_option_node["S3_AUDIT_LOG_ASYNC_ENABLE"].as<bool>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node,
+                               "S3_AUDIT_LOG_ASYNC_BUFFER_SIZE_KB");
+      audit_log_async_buffer_size_kb =
+          s3_option_node["S3_AUDIT_LOG_ASYNC_BUFFER_SIZE_KB"].as<unsigned>();
       S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_AUDIT_LOGGER_POLICY");
       audit_logger_policy =
           s3_option_node["S3_AUDIT_LOGGER_POLICY"].as<std::string>();
@@ -112,6 +119,18 @@ bool S3Option::load_section(std::string section_name,
                                "S3_AUDIT_LOGGER_KAFKA_WEB_PATH");
       audit_logger_kafka_web_path =
           s3_option_node["S3_AUDIT_LOGGER_KAFKA_WEB_PATH"].as<std::string>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node,
+                               "S3_AUDIT_LOGGER_BATCH_MAX_RECORDS");
+      audit_logger_batch_max_records =
+          s3_option_node["S3_AUDIT_LOGGER_BATCH_MAX_RECORDS"].as<unsigned>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node,
+                               "S3_AUDIT_LOGGER_MAX_REQUESTS_IN_FLIGHT");
+      audit_logger_max_requests_in_flight =
+          s3_option_node["S3_AUDIT_LOGGER_MAX_REQUESTS_IN_FLIGHT"]
+              .as<unsigned>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_AUDIT_LOGGER_COMPRESS");
+      audit_logger_compress =
+          s3_option_node["S3_AUDIT_LOGGER_COMPRESS"].as<bool>();
       S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_LOG_FILE_MAX_SIZE");
       log_file_max_size_mb = s3_option_node["S3_LOG_FILE_MAX_SIZE"].as<int>();
       S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_LOG_ENABLE_BUFFERING");
@@ -123,6 +142,14 @@ bool S3Option::load_section(std::string section_name,
       S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_LOG_FLUSH_FREQUENCY");
       log_flush_frequency_sec =
           s3_option_node["S3_LOG_FLUSH_FREQUENCY"].as<int>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_LOG_ASYNC_ENABLE");
+      log_async_enable = s3_option_node["S3_LOG_ASYNC_ENABLE"].as<bool>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_LOG_ASYNC_BUFFER_SIZE_KB");
+      log_async_buffer_size_kb =
+          s3_option_node["S3_LOG_ASYNC_BUFFER_SIZE_KB"].as<unsigned>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_LOG_ASYNC_SAMPLE_RATE");
+      log_async_sample_rate =
+          s3_option_node["S3_LOG_ASYNC_SAMPLE_RATE"].as<unsigned>();
       S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_SERVER_IPV4_BIND_ADDR");
       s3_ipv4_bind_addr =
           s3_option_node["S3_SERVER_IPV4_BIND_ADDR"].as<std::string>();
@@ -186,6 +213,105 @@ bool S3Option::load_section(std::string section_name,
       S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_STATS_ALLOWLIST_FILENAME");
       stats_allowlist_filename =
           s3_option_node["S3_STATS_ALLOWLIST_FILENAME"].as<std::string>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_STATSD_AGGREGATION_ENABLE");
+      statsd_aggregation_enable =
+          s3_option_node["S3_STATSD_AGGREGATION_ENABLE"].as<bool>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_STATSD_MAX_PACKET_SIZE");
+      statsd_max_packet_size =
+          s3_option_node["S3_STATSD_MAX_PACKET_SIZE"].as<unsigned short>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_METRICS_ENABLE");
+      metrics_enable = s3_option_node["S3_METRICS_ENABLE"].as<bool>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node,
+                               "S3_METRICS_QUANTILE_WINDOW_SEC");
+      metrics_quantile_window_sec =
+          s3_option_node["S3_METRICS_QUANTILE_WINDOW_SEC"].as<unsigned>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_REQUEST_TRACE_ENABLE");
+      request_trace_enable =
+          s3_option_node["S3_REQUEST_TRACE_ENABLE"].as<bool>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_REQUEST_TRACE_THRESHOLD_MS");
+      request_trace_threshold_ms =
+          s3_option_node["S3_REQUEST_TRACE_THRESHOLD_MS"].as<unsigned>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_REQUEST_TRACE_MAX_FILES");
+      request_trace_max_files =
+          s3_option_node["S3_REQUEST_TRACE_MAX_FILES"].as<unsigned>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_INFLIGHT_REQUESTS_ENABLE");
+      inflight_requests_enable =
+          s3_option_node["S3_INFLIGHT_REQUESTS_ENABLE"].as<bool>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node,
+                               "S3_INFLIGHT_REQUESTS_LOG_INTERVAL_SEC");
+      inflight_requests_log_interval_sec =
+          s3_option_node["S3_INFLIGHT_REQUESTS_LOG_INTERVAL_SEC"]
+              .as<unsigned>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node,
+                               "S3_INFLIGHT_REQUESTS_LOG_TOP_N");
+      inflight_requests_log_top_n =
+          s3_option_node["S3_INFLIGHT_REQUESTS_LOG_TOP_N"].as<unsigned>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node,
+                               "S3_INFLIGHT_REQUESTS_LOG_THRESHOLD_MS");
+      inflight_requests_log_threshold_ms =
+          s3_option_node["S3_INFLIGHT_REQUESTS_LOG_THRESHOLD_MS"]
+              .as<unsigned>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_MGMT_API_ADMIN_ACCOUNT_ID");
+      mgmt_api_admin_account_id =
+          s3_option_node["S3_MGMT_API_ADMIN_ACCOUNT_ID"].as<std::string>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node,
+                               "S3_PARALLEL_METADATA_SAVE_ENABLE");
+      parallel_metadata_save_enable =
+          s3_option_node["S3_PARALLEL_METADATA_SAVE_ENABLE"].as<bool>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_KVS_GROUP_COMMIT_ENABLE");
+      kvs_group_commit_enable =
+          s3_option_node["S3_KVS_GROUP_COMMIT_ENABLE"].as<bool>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node,
+                               "S3_KVS_GROUP_COMMIT_WINDOW_USEC");
+      kvs_group_commit_window_usec =
+          s3_option_node["S3_KVS_GROUP_COMMIT_WINDOW_USEC"].as<unsigned>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_KVS_GROUP_COMMIT_MAX_KEYS");
+      kvs_group_commit_max_keys =
+          s3_option_node["S3_KVS_GROUP_COMMIT_MAX_KEYS"].as<unsigned>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_BUCKET_USAGE_ENABLE");
+      bucket_usage_enable = s3_option_node["S3_BUCKET_USAGE_ENABLE"].as<bool>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node,
+                               "S3_BUCKET_USAGE_FLUSH_INTERVAL_SEC");
+      bucket_usage_flush_interval_sec =
+          s3_option_node["S3_BUCKET_USAGE_FLUSH_INTERVAL_SEC"].as<unsigned>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node,
+                               "S3_BUCKET_USAGE_RECONCILE_INTERVAL_SEC");
+      bucket_usage_reconcile_interval_sec =
+          s3_option_node["S3_BUCKET_USAGE_RECONCILE_INTERVAL_SEC"]
+              .as<unsigned>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node,
+                               "S3_BUCKET_LIST_CACHE_MAX_ACCOUNTS");
+      bucket_list_cache_max_accounts =
+          s3_option_node["S3_BUCKET_LIST_CACHE_MAX_ACCOUNTS"].as<unsigned>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node,
+                               "S3_BUCKET_LIST_CACHE_EXPIRE_SEC");
+      bucket_list_cache_expire_sec =
+          s3_option_node["S3_BUCKET_LIST_CACHE_EXPIRE_SEC"].as<unsigned>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node,
+                               "S3_MOTR_COMPLETION_QUEUE_SIZE");
+      motr_completion_queue_size =
+          s3_option_node["S3_MOTR_COMPLETION_QUEUE_SIZE"].as<unsigned>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node,
+                               "S3_MOTR_COMPLETION_BATCH_SIZE");
+      motr_completion_batch_size =
+          s3_option_node["S3_MOTR_COMPLETION_BATCH_SIZE"].as<unsigned>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_MOTR_EMULATOR_ENABLE");
+      motr_emulator_enable =
+          s3_option_node["S3_MOTR_EMULATOR_ENABLE"].as<bool>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_MOTR_EMULATOR_THREADS");
+      motr_emulator_threads =
+          s3_option_node["S3_MOTR_EMULATOR_THREADS"].as<unsigned>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node,
+                               "S3_MOTR_EMULATOR_LATENCY_USEC");
+      motr_emulator_latency_usec =
+          s3_option_node["S3_MOTR_EMULATOR_LATENCY_USEC"].as<unsigned>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node,
+                               "S3_MOTR_EMULATOR_BANDWIDTH_MBPS");
+      motr_emulator_bandwidth_mbps =
+          s3_option_node["S3_MOTR_EMULATOR_BANDWIDTH_MBPS"].as<unsigned>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_MOTR_EMULATOR_DIR");
+      motr_emulator_dir =
+          s3_option_node["S3_MOTR_EMULATOR_DIR"].as<std::string>();
       S3_OPTION_ASSERT_AND_RET(s3_option_node,
                                "S3_PERF_STATS_INOUT_BYTES_INTERVAL_MSEC");
       perf_stats_inout_bytes_interval_msec =
@@ -213,6 +339,36 @@ bool S3Option::load_section(std::string section_name,
           s3_option_node["S3_BUCKET_METADATA_CACHE_EXPIRE_SEC"].as<unsigned>();
       bucket_metadata_cache_refresh_sec =
           s3_option_node["S3_BUCKET_METADATA_CACHE_REFRESH_SEC"].as<unsigned>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_GC_ENABLE");
+      gc_enable = s3_option_node["S3_GC_ENABLE"].as<bool>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_GC_BATCH_SIZE");
+      gc_batch_size = s3_option_node["S3_GC_BATCH_SIZE"].as<unsigned>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_GC_MAX_INFLIGHT");
+      gc_max_inflight = s3_option_node["S3_GC_MAX_INFLIGHT"].as<unsigned>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_GC_MAX_DELETES_PER_SEC");
+      gc_max_deletes_per_sec =
+          s3_option_node["S3_GC_MAX_DELETES_PER_SEC"].as<unsigned>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_GC_SCAN_INTERVAL_SEC");
+      gc_scan_interval_sec =
+          s3_option_node["S3_GC_SCAN_INTERVAL_SEC"].as<unsigned>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_GC_MIN_RECORD_AGE_SEC");
+      gc_min_record_age_sec =
+          s3_option_node["S3_GC_MIN_RECORD_AGE_SEC"].as<unsigned>();
+
+      S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_ADMISSION_CONTROL_ENABLE");
+      admission_control_enable =
+          s3_option_node["S3_ADMISSION_CONTROL_ENABLE"].as<bool>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_ADMISSION_QUEUE_MAX_LENGTH");
+      admission_queue_max_length =
+          s3_option_node["S3_ADMISSION_QUEUE_MAX_LENGTH"].as<unsigned>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node,
+                               "S3_ADMISSION_QUEUE_MAX_WAIT_MS");
+      admission_queue_max_wait_ms =
+          s3_option_node["S3_ADMISSION_QUEUE_MAX_WAIT_MS"].as<unsigned>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node,
+                               "S3_ADMISSION_SMALL_REQUEST_SIZE");
+      admission_small_request_size =
+          s3_option_node["S3_ADMISSION_SMALL_REQUEST_SIZE"].as<size_t>();
     } else if (section_name == "S3_AUTH_CONFIG") {
       S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_AUTH_PORT");
       auth_port = s3_option_node["S3_AUTH_PORT"].as<unsigned short>();
@@ -270,6 +426,14 @@ bool S3Option::load_section(std::string section_name,
                                "S3_MOTR_READ_MEMPOOL_ZERO_BUFFER");
       motr_read_mempool_zeroed_buffer =
           s3_option_node["S3_MOTR_READ_MEMPOOL_ZERO_BUFFER"].as<bool>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node,
+                               "S3_MOTR_READ_MEMPOOL_HUGEPAGE_ARENA");
+      motr_read_mempool_hugepage_arena =
+          s3_option_node["S3_MOTR_READ_MEMPOOL_HUGEPAGE_ARENA"].as<bool>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node,
+                               "S3_MOTR_READ_MEMPOOL_NUMA_LOCAL");
+      motr_read_mempool_numa_local =
+          s3_option_node["S3_MOTR_READ_MEMPOOL_NUMA_LOCAL"].as<bool>();
 
       S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_MOTR_OPERATION_WAIT_PERIOD");
       motr_op_wait_period =
@@ -345,6 +509,14 @@ bool S3Option::load_section(std::string section_name,
                                "S3_LIBEVENT_MEMPOOL_ZERO_BUFFER");
       libevent_mempool_zeroed_buffer =
           s3_option_node["S3_LIBEVENT_MEMPOOL_ZERO_BUFFER"].as<bool>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node,
+                               "S3_LIBEVENT_MEMPOOL_HUGEPAGE_ARENA");
+      libevent_mempool_hugepage_arena =
+          s3_option_node["S3_LIBEVENT_MEMPOOL_HUGEPAGE_ARENA"].as<bool>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node,
+                               "S3_LIBEVENT_MEMPOOL_NUMA_LOCAL");
+      libevent_mempool_numa_local =
+          s3_option_node["S3_LIBEVENT_MEMPOOL_NUMA_LOCAL"].as<bool>();
 
       S3_OPTION_ASSERT_AND_RET(s3_option_node,
                                "S3_LIBEVENT_POOL_RESERVE_PERCENT");
@@ -483,6 +655,14 @@ bool S3Option::load_section(std::string section_name,
       S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_LOG_FLUSH_FREQUENCY");
       log_flush_frequency_sec =
           s3_option_node["S3_LOG_FLUSH_FREQUENCY"].as<int>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_LOG_ASYNC_ENABLE");
+      log_async_enable = s3_option_node["S3_LOG_ASYNC_ENABLE"].as<bool>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_LOG_ASYNC_BUFFER_SIZE_KB");
+      log_async_buffer_size_kb =
+          s3_option_node["S3_LOG_ASYNC_BUFFER_SIZE_KB"].as<unsigned>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_LOG_ASYNC_SAMPLE_RATE");
+      log_async_sample_rate =
+          s3_option_node["S3_LOG_ASYNC_SAMPLE_RATE"].as<unsigned>();
       S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_ENABLE_STATS");
       stats_enable = s3_option_node["S3_ENABLE_STATS"].as<bool>();
       S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_STATSD_MAX_SEND_RETRY");
@@ -491,6 +671,105 @@ bool S3Option::load_section(std::string section_name,
       S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_STATS_ALLOWLIST_FILENAME");
       stats_allowlist_filename =
           s3_option_node["S3_STATS_ALLOWLIST_FILENAME"].as<std::string>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_STATSD_AGGREGATION_ENABLE");
+      statsd_aggregation_enable =
+          s3_option_node["S3_STATSD_AGGREGATION_ENABLE"].as<bool>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_STATSD_MAX_PACKET_SIZE");
+      statsd_max_packet_size =
+          s3_option_node["S3_STATSD_MAX_PACKET_SIZE"].as<unsigned short>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_METRICS_ENABLE");
+      metrics_enable = s3_option_node["S3_METRICS_ENABLE"].as<bool>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node,
+                               "S3_METRICS_QUANTILE_WINDOW_SEC");
+      metrics_quantile_window_sec =
+          s3_option_node["S3_METRICS_QUANTILE_WINDOW_SEC"].as<unsigned>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_REQUEST_TRACE_ENABLE");
+      request_trace_enable =
+          s3_option_node["S3_REQUEST_TRACE_ENABLE"].as<bool>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_REQUEST_TRACE_THRESHOLD_MS");
+      request_trace_threshold_ms =
+          s3_option_node["S3_REQUEST_TRACE_THRESHOLD_MS"].as<unsigned>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_REQUEST_TRACE_MAX_FILES");
+      request_trace_max_files =
+          s3_option_node["S3_REQUEST_TRACE_MAX_FILES"].as<unsigned>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_INFLIGHT_REQUESTS_ENABLE");
+      inflight_requests_enable =
+          s3_option_node["S3_INFLIGHT_REQUESTS_ENABLE"].as<bool>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node,
+                               "S3_INFLIGHT_REQUESTS_LOG_INTERVAL_SEC");
+      inflight_requests_log_interval_sec =
+          s3_option_node["S3_INFLIGHT_REQUESTS_LOG_INTERVAL_SEC"]
+              .as<unsigned>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node,
+                               "S3_INFLIGHT_REQUESTS_LOG_TOP_N");
+      inflight_requests_log_top_n =
+          s3_option_node["S3_INFLIGHT_REQUESTS_LOG_TOP_N"].as<unsigned>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node,
+                               "S3_INFLIGHT_REQUESTS_LOG_THRESHOLD_MS");
+      inflight_requests_log_threshold_ms =
+          s3_option_node["S3_INFLIGHT_REQUESTS_LOG_THRESHOLD_MS"]
+              .as<unsigned>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_MGMT_API_ADMIN_ACCOUNT_ID");
+      mgmt_api_admin_account_id =
+          s3_option_node["S3_MGMT_API_ADMIN_ACCOUNT_ID"].as<std::string>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node,
+                               "S3_PARALLEL_METADATA_SAVE_ENABLE");
+      parallel_metadata_save_enable =
+          s3_option_node["S3_PARALLEL_METADATA_SAVE_ENABLE"].as<bool>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_KVS_GROUP_COMMIT_ENABLE");
+      kvs_group_commit_enable =
+          s3_option_node["S3_KVS_GROUP_COMMIT_ENABLE"].as<bool>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node,
+                               "S3_KVS_GROUP_COMMIT_WINDOW_USEC");
+      kvs_group_commit_window_usec =
+          s3_option_node["S3_KVS_GROUP_COMMIT_WINDOW_USEC"].as<unsigned>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_KVS_GROUP_COMMIT_MAX_KEYS");
+      kvs_group_commit_max_keys =
+          s3_option_node["S3_KVS_GROUP_COMMIT_MAX_KEYS"].as<unsigned>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_BUCKET_USAGE_ENABLE");
+      bucket_usage_enable = s3_option_node["S3_BUCKET_USAGE_ENABLE"].as<bool>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node,
+                               "S3_BUCKET_USAGE_FLUSH_INTERVAL_SEC");
+      bucket_usage_flush_interval_sec =
+          s3_option_node["S3_BUCKET_USAGE_FLUSH_INTERVAL_SEC"].as<unsigned>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node,
+                               "S3_BUCKET_USAGE_RECONCILE_INTERVAL_SEC");
+      bucket_usage_reconcile_interval_sec =
+          s3_option_node["S3_BUCKET_USAGE_RECONCILE_INTERVAL_SEC"]
+              .as<unsigned>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node,
+                               "S3_BUCKET_LIST_CACHE_MAX_ACCOUNTS");
+      bucket_list_cache_max_accounts =
+          s3_option_node["S3_BUCKET_LIST_CACHE_MAX_ACCOUNTS"].as<unsigned>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node,
+                               "S3_BUCKET_LIST_CACHE_EXPIRE_SEC");
+      bucket_list_cache_expire_sec =
+          s3_option_node["S3_BUCKET_LIST_CACHE_EXPIRE_SEC"].as<unsigned>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node,
+                               "S3_MOTR_COMPLETION_QUEUE_SIZE");
+      motr_completion_queue_size =
+          s3_option_node["S3_MOTR_COMPLETION_QUEUE_SIZE"].as<unsigned>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node,
+                               "S3_MOTR_COMPLETION_BATCH_SIZE");
+      motr_completion_batch_size =
+          s3_option_node["S3_MOTR_COMPLETION_BATCH_SIZE"].as<unsigned>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_MOTR_EMULATOR_ENABLE");
+      motr_emulator_enable =
+          s3_option_node["S3_MOTR_EMULATOR_ENABLE"].as<bool>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_MOTR_EMULATOR_THREADS");
+      motr_emulator_threads =
+          s3_option_node["S3_MOTR_EMULATOR_THREADS"].as<unsigned>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node,
+                               "S3_MOTR_EMULATOR_LATENCY_USEC");
+      motr_emulator_latency_usec =
+          s3_option_node["S3_MOTR_EMULATOR_LATENCY_USEC"].as<unsigned>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node,
+                               "S3_MOTR_EMULATOR_BANDWIDTH_MBPS");
+      motr_emulator_bandwidth_mbps =
+          s3_option_node["S3_MOTR_EMULATOR_BANDWIDTH_MBPS"].as<unsigned>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_MOTR_EMULATOR_DIR");
+      motr_emulator_dir =
+          s3_option_node["S3_MOTR_EMULATOR_DIR"].as<std::string>();
       S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_AUDIT_LOGGER_POLICY");
       audit_logger_policy =
           s3_option_node["S3_AUDIT_LOGGER_POLICY"].as<std::string>();
@@ -506,6 +785,18 @@ bool S3Option::load_section(std::string section_name,
                                "S3_AUDIT_LOGGER_KAFKA_WEB_PATH");
       audit_logger_kafka_web_path =
           s3_option_node["S3_AUDIT_LOGGER_KAFKA_WEB_PATH"].as<std::string>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node,
+                               "S3_AUDIT_LOGGER_BATCH_MAX_RECORDS");
+      audit_logger_batch_max_records =
+          s3_option_node["S3_AUDIT_LOGGER_BATCH_MAX_RECORDS"].as<unsigned>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node,
+                               "S3_AUDIT_LOGGER_MAX_REQUESTS_IN_FLIGHT");
+      audit_logger_max_requests_in_flight =
+          s3_option_node["S3_AUDIT_LOGGER_MAX_REQUESTS_IN_FLIGHT"]
+              .as<unsigned>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_AUDIT_LOGGER_COMPRESS");
+      audit_logger_compress =
+          s3_option_node["S3_AUDIT_LOGGER_COMPRESS"].as<bool>();
       S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_REDIS_SERVER_ADDRESS");
       redis_srv_addr =
           s3_option_node["S3_REDIS_SERVER_ADDRESS"].as<std::string>();
@@ -529,6 +820,36 @@ bool S3Option::load_section(std::string section_name,
           s3_option_node["S3_BUCKET_METADATA_CACHE_EXPIRE_SEC"].as<unsigned>();
       bucket_metadata_cache_refresh_sec =
           s3_option_node["S3_BUCKET_METADATA_CACHE_REFRESH_SEC"].as<unsigned>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_GC_ENABLE");
+      gc_enable = s3_option_node["S3_GC_ENABLE"].as<bool>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_GC_BATCH_SIZE");
+      gc_batch_size = s3_option_node["S3_GC_BATCH_SIZE"].as<unsigned>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_GC_MAX_INFLIGHT");
+      gc_max_inflight = s3_option_node["S3_GC_MAX_INFLIGHT"].as<unsigned>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_GC_MAX_DELETES_PER_SEC");
+      gc_max_deletes_per_sec =
+          s3_option_node["S3_GC_MAX_DELETES_PER_SEC"].as<unsigned>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_GC_SCAN_INTERVAL_SEC");
+      gc_scan_interval_sec =
+          s3_option_node["S3_GC_SCAN_INTERVAL_SEC"].as<unsigned>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_GC_MIN_RECORD_AGE_SEC");
+      gc_min_record_age_sec =
+          s3_option_node["S3_GC_MIN_RECORD_AGE_SEC"].as<unsigned>();
+
+      S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_ADMISSION_CONTROL_ENABLE");
+      admission_control_enable =
+          s3_option_node["S3_ADMISSION_CONTROL_ENABLE"].as<bool>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_ADMISSION_QUEUE_MAX_LENGTH");
+      admission_queue_max_length =
+          s3_option_node["S3_ADMISSION_QUEUE_MAX_LENGTH"].as<unsigned>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node,
+                               "S3_ADMISSION_QUEUE_MAX_WAIT_MS");
+      admission_queue_max_wait_ms =
+          s3_option_node["S3_ADMISSION_QUEUE_MAX_WAIT_MS"].as<unsigned>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node,
+                               "S3_ADMISSION_SMALL_REQUEST_SIZE");
+      admission_small_request_size =
+          s3_option_node["S3_ADMISSION_SMALL_REQUEST_SIZE"].as<size_t>();
     } else if (section_name == "S3_AUTH_CONFIG") {
       if (!(cmd_opt_flag & S3_OPTION_AUTH_PORT)) {
         S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_AUTH_PORT");
@@ -595,6 +916,14 @@ bool S3Option::load_section(std::string section_name,
       S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_MOTR_OPERATION_WAIT_PERIOD");
       motr_op_wait_period =
           s3_option_node["S3_MOTR_OPERATION_WAIT_PERIOD"].as<unsigned>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node,
+                               "S3_MOTR_READ_MEMPOOL_HUGEPAGE_ARENA");
+      motr_read_mempool_hugepage_arena =
+          s3_option_node["S3_MOTR_READ_MEMPOOL_HUGEPAGE_ARENA"].as<bool>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node,
+                               "S3_MOTR_READ_MEMPOOL_NUMA_LOCAL");
+      motr_read_mempool_numa_local =
+          s3_option_node["S3_MOTR_READ_MEMPOOL_NUMA_LOCAL"].as<bool>();
 
       std::string motr_read_pool_initial_buffer_count_str;
       std::string motr_read_pool_expandable_count_str;
@@ -644,6 +973,14 @@ bool S3Option::load_section(std::string section_name,
       S3_OPTION_ASSERT_AND_RET(s3_option_node, "S3_LIBEVENT_MAX_READ_SIZE");
       libevent_max_read_size_str =
           s3_option_node["S3_LIBEVENT_MAX_READ_SIZE"].as<std::string>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node,
+                               "S3_LIBEVENT_MEMPOOL_HUGEPAGE_ARENA");
+      libevent_mempool_hugepage_arena =
+          s3_option_node["S3_LIBEVENT_MEMPOOL_HUGEPAGE_ARENA"].as<bool>();
+      S3_OPTION_ASSERT_AND_RET(s3_option_node,
+                               "S3_LIBEVENT_MEMPOOL_NUMA_LOCAL");
+      libevent_mempool_numa_local =
+          s3_option_node["S3_LIBEVENT_MEMPOOL_NUMA_LOCAL"].as<bool>();
       sscanf(libevent_pool_initial_size_str.c_str(), "%zu",
              &libevent_pool_initial_size);
       sscanf(libevent_pool_expandable_size_str.c_str(), "%zu",
@@ -833,6 +1170,10 @@ void S3Option::dump_options() {
          audit_log_conf_file.c_str());
   s3_log(S3_LOG_INFO, "", "S3_AUDIT_LOG_FORMAT_TYPE = %s\n",
          audit_format_type_to_string(audit_log_format).c_str());
+  s3_log(S3_LOG_INFO, "", "S3_AUDIT_LOG_ASYNC_ENABLE = %s\n",
+         audit_log_async_enable ? "true" : "false");
+  s3_log(S3_LOG_INFO, "", "S3_AUDIT_LOG_ASYNC_BUFFER_SIZE_KB = %u\n",
+         audit_log_async_buffer_size_kb);
   s3_log(S3_LOG_INFO, "", "S3_AUDIT_LOGGER_POLICY = %s\n",
          audit_logger_policy.c_str());
   s3_log(S3_LOG_INFO, "", "S3_AUDIT_LOGGER_HOST = %s\n",
@@ -842,10 +1183,22 @@ void S3Option::dump_options() {
          audit_logger_rsyslog_msgid.c_str());
   s3_log(S3_LOG_INFO, "", "S3_AUDIT_LOGGER_KAFKA_WEB_PATH = %s\n",
          audit_logger_kafka_web_path.c_str());
+  s3_log(S3_LOG_INFO, "", "S3_AUDIT_LOGGER_BATCH_MAX_RECORDS = %u\n",
+         audit_logger_batch_max_records);
+  s3_log(S3_LOG_INFO, "", "S3_AUDIT_LOGGER_MAX_REQUESTS_IN_FLIGHT = %u\n",
+         audit_logger_max_requests_in_flight);
+  s3_log(S3_LOG_INFO, "", "S3_AUDIT_LOGGER_COMPRESS = %s\n",
+         audit_logger_compress ? "true" : "false");
   s3_log(S3_LOG_INFO, "", "S3_ENABLE_MURMURHASH_OID = %s\n",
          (s3_enable_murmurhash_oid ? "true" : "false"));
   s3_log(S3_LOG_INFO, "", "S3_LOG_FLUSH_FREQUENCY = %d\n",
          log_flush_frequency_sec);
+  s3_log(S3_LOG_INFO, "", "S3_LOG_ASYNC_ENABLE = %s\n",
+         log_async_enable ? "true" : "false");
+  s3_log(S3_LOG_INFO, "", "S3_LOG_ASYNC_BUFFER_SIZE_KB = %u\n",
+         log_async_buffer_size_kb);
+  s3_log(S3_LOG_INFO, "", "S3_LOG_ASYNC_SAMPLE_RATE = %u\n",
+         log_async_sample_rate);
   s3_log(S3_LOG_INFO, "", "S3_ENABLE_AUTH_SSL = %s\n",
          (s3_enable_auth_ssl) ? "true" : "false");
   s3_log(S3_LOG_INFO, "", "S3_REUSEPORT = %s\n",
@@ -975,6 +1328,62 @@ void S3Option::dump_options() {
   s3_log(S3_LOG_INFO, "",
          "S3_PERF_STATS_INOUT_BYTES_INTERVAL_MSEC = %" PRIu32 "\n",
          perf_stats_inout_bytes_interval_msec);
+  s3_log(S3_LOG_INFO, "", "S3_STATSD_AGGREGATION_ENABLE = %s\n",
+         statsd_aggregation_enable ? "true" : "false");
+  s3_log(S3_LOG_INFO, "", "S3_STATSD_MAX_PACKET_SIZE = %d\n",
+         statsd_max_packet_size);
+  s3_log(S3_LOG_INFO, "", "S3_METRICS_ENABLE = %s\n",
+         metrics_enable ? "true" : "false");
+  s3_log(S3_LOG_INFO, "", "S3_METRICS_QUANTILE_WINDOW_SEC = %u\n",
+         metrics_quantile_window_sec);
+  s3_log(S3_LOG_INFO, "", "S3_REQUEST_TRACE_ENABLE = %s\n",
+         request_trace_enable ? "true" : "false");
+  s3_log(S3_LOG_INFO, "", "S3_REQUEST_TRACE_THRESHOLD_MS = %u\n",
+         request_trace_threshold_ms);
+  s3_log(S3_LOG_INFO, "", "S3_REQUEST_TRACE_MAX_FILES = %u\n",
+         request_trace_max_files);
+  s3_log(S3_LOG_INFO, "", "S3_INFLIGHT_REQUESTS_ENABLE = %s\n",
+         inflight_requests_enable ? "true" : "false");
+  s3_log(S3_LOG_INFO, "", "S3_INFLIGHT_REQUESTS_LOG_INTERVAL_SEC = %u\n",
+         inflight_requests_log_interval_sec);
+  s3_log(S3_LOG_INFO, "", "S3_INFLIGHT_REQUESTS_LOG_TOP_N = %u\n",
+         inflight_requests_log_top_n);
+  s3_log(S3_LOG_INFO, "", "S3_INFLIGHT_REQUESTS_LOG_THRESHOLD_MS = %u\n",
+         inflight_requests_log_threshold_ms);
+  s3_log(S3_LOG_INFO, "", "S3_MGMT_API_ADMIN_ACCOUNT_ID = %s\n",
+         mgmt_api_admin_account_id.c_str());
+  s3_log(S3_LOG_INFO, "", "S3_PARALLEL_METADATA_SAVE_ENABLE = %s\n",
+         parallel_metadata_save_enable ? "true" : "false");
+  s3_log(S3_LOG_INFO, "", "S3_KVS_GROUP_COMMIT_ENABLE = %s\n",
+         kvs_group_commit_enable ? "true" : "false");
+  s3_log(S3_LOG_INFO, "", "S3_KVS_GROUP_COMMIT_WINDOW_USEC = %u\n",
+         kvs_group_commit_window_usec);
+  s3_log(S3_LOG_INFO, "", "S3_KVS_GROUP_COMMIT_MAX_KEYS = %u\n",
+         kvs_group_commit_max_keys);
+  s3_log(S3_LOG_INFO, "", "S3_BUCKET_USAGE_ENABLE = %s\n",
+         bucket_usage_enable ? "true" : "false");
+  s3_log(S3_LOG_INFO, "", "S3_BUCKET_USAGE_FLUSH_INTERVAL_SEC = %u\n",
+         bucket_usage_flush_interval_sec);
+  s3_log(S3_LOG_INFO, "", "S3_BUCKET_USAGE_RECONCILE_INTERVAL_SEC = %u\n",
+         bucket_usage_reconcile_interval_sec);
+  s3_log(S3_LOG_INFO, "", "S3_BUCKET_LIST_CACHE_MAX_ACCOUNTS = %u\n",
+         bucket_list_cache_max_accounts);
+  s3_log(S3_LOG_INFO, "", "S3_BUCKET_LIST_CACHE_EXPIRE_SEC = %u\n",
+         bucket_list_cache_expire_sec);
+  s3_log(S3_LOG_INFO, "", "S3_MOTR_COMPLETION_QUEUE_SIZE = %u\n",
+         motr_completion_queue_size);
+  s3_log(S3_LOG_INFO, "", "S3_MOTR_COMPLETION_BATCH_SIZE = %u\n",
+         motr_completion_batch_size);
+  s3_log(S3_LOG_INFO, "", "S3_MOTR_EMULATOR_ENABLE = %s\n",
+         motr_emulator_enable ? "true" : "false");
+  s3_log(S3_LOG_INFO, "", "S3_MOTR_EMULATOR_THREADS = %u\n",
+         motr_emulator_threads);
+  s3_log(S3_LOG_INFO, "", "S3_MOTR_EMULATOR_LATENCY_USEC = %u\n",
+         motr_emulator_latency_usec);
+  s3_log(S3_LOG_INFO, "", "S3_MOTR_EMULATOR_BANDWIDTH_MBPS = %u\n",
+         motr_emulator_bandwidth_mbps);
+  s3_log(S3_LOG_INFO, "", "S3_MOTR_EMULATOR_DIR = %s\n",
+         motr_emulator_dir.c_str());
 
   s3_log(S3_LOG_INFO, "", "S3_REDIS_SERVER_PORT = %d\n", (int)redis_srv_port);
   s3_log(S3_LOG_INFO, "", "S3_REDIS_SERVER_ADDRESS = %s\n",
@@ -987,10 +1396,36 @@ void S3Option::dump_options() {
 
   s3_log(S3_LOG_INFO, "", "S3_SERVER_ENABLE_ADDB_DUMP = %s\n",
          is_s3server_addb_dump_enabled() ? "true" : "false");
+
+  s3_log(S3_LOG_INFO, "", "S3_GC_ENABLE = %s\n", gc_enable ? "true" : "false");
+  s3_log(S3_LOG_INFO, "", "S3_GC_BATCH_SIZE = %u\n", gc_batch_size);
+  s3_log(S3_LOG_INFO, "", "S3_GC_MAX_INFLIGHT = %u\n", gc_max_inflight);
+  s3_log(S3_LOG_INFO, "", "S3_GC_MAX_DELETES_PER_SEC = %u\n",
+         gc_max_deletes_per_sec);
+  s3_log(S3_LOG_INFO, "", "S3_GC_SCAN_INTERVAL_SEC = %u\n",
+         gc_scan_interval_sec);
+  s3_log(S3_LOG_INFO, "", "S3_GC_MIN_RECORD_AGE_SEC = %u\n",
+         gc_min_record_age_sec);
+  s3_log(S3_LOG_INFO, "", "S3_ADMISSION_CONTROL_ENABLE = %s\n",
+         admission_control_enable ? "true" : "false");
+  s3_log(S3_LOG_INFO, "", "S3_ADMISSION_QUEUE_MAX_LENGTH = %u\n",
+         admission_queue_max_length);
+  s3_log(S3_LOG_INFO, "", "S3_ADMISSION_QUEUE_MAX_WAIT_MS = %u\n",
+         admission_queue_max_wait_ms);
+  s3_log(S3_LOG_INFO, "", "S3_ADMISSION_SMALL_REQUEST_SIZE = %zu\n",
+         admission_small_request_size);
   s3_log(S3_LOG_INFO, "", "S3_MOTR_READ_MEMPOOL_ZERO_BUFFER=%s\n",
          motr_read_mempool_zeroed_buffer ? "true" : "false");
   s3_log(S3_LOG_INFO, "", "S3_LIBEVENT_MEMPOOL_ZERO_BUFFER=%s\n",
          libevent_mempool_zeroed_buffer ? "true" : "false");
+  s3_log(S3_LOG_INFO, "", "S3_MOTR_READ_MEMPOOL_HUGEPAGE_ARENA=%s\n",
+         motr_read_mempool_hugepage_arena ? "true" : "false");
+  s3_log(S3_LOG_INFO, "", "S3_MOTR_READ_MEMPOOL_NUMA_LOCAL=%s\n",
+         motr_read_mempool_numa_local ? "true" : "false");
+  s3_log(S3_LOG_INFO, "", "S3_LIBEVENT_MEMPOOL_HUGEPAGE_ARENA=%s\n",
+         libevent_mempool_hugepage_arena ? "true" : "false");
+  s3_log(S3_LOG_INFO, "", "S3_LIBEVENT_MEMPOOL_NUMA_LOCAL=%s\n",
+         libevent_mempool_numa_local ? "true" : "false");
 
   return;
 }
@@ -1019,6 +1454,14 @@ AuditFormatType S3Option::get_s3_audit_format_type() {
   return audit_log_format;
 }
 
+bool S3Option::is_audit_log_async_enabled() const {
+  return audit_log_async_enable;
+}
+
+unsigned S3Option::get_audit_log_async_buffer_size_kb() const {
+  return audit_log_async_buffer_size_kb;
+}
+
 std::string S3Option::get_audit_logger_policy() { return audit_logger_policy; }
 
 void S3Option::set_audit_logger_policy(std::string const& policy) {
@@ -1037,6 +1480,18 @@ std::string S3Option::get_audit_logger_kafka_web_path() {
   return audit_logger_kafka_web_path;
 }
 
+unsigned S3Option::get_audit_logger_batch_max_records() const {
+  return audit_logger_batch_max_records;
+}
+
+unsigned S3Option::get_audit_logger_max_requests_in_flight() const {
+  return audit_logger_max_requests_in_flight;
+}
+
+bool S3Option::is_audit_logger_compress_enabled() const {
+  return audit_logger_compress;
+}
+
 unsigned short S3Option::get_s3_grace_period_sec() {
   return s3_grace_period_sec;
 }
@@ -1125,6 +1580,16 @@ int S3Option::get_log_flush_frequency_in_sec() {
   return log_flush_frequency_sec;
 }
 
+bool S3Option::is_log_async_enabled() const { return log_async_enable; }
+
+unsigned S3Option::get_log_async_buffer_size_kb() const {
+  return log_async_buffer_size_kb;
+}
+
+unsigned S3Option::get_log_async_sample_rate() const {
+  return log_async_sample_rate;
+}
+
 bool S3Option::is_log_buffering_enabled() { return log_buffering_enable; }
 
 bool S3Option::is_murmurhash_oid_enabled() { return s3_enable_murmurhash_oid; }
@@ -1173,6 +1638,42 @@ unsigned S3Option::get_bucket_metadata_cache_refresh_sec() const {
   return bucket_metadata_cache_refresh_sec;
 }
 
+bool S3Option::is_gc_enabled() const { return gc_enable; }
+
+void S3Option::set_gc_enable(bool enable) { gc_enable = enable; }
+
+unsigned S3Option::get_gc_batch_size() const { return gc_batch_size; }
+
+unsigned S3Option::get_gc_max_inflight() const { return gc_max_inflight; }
+
+unsigned S3Option::get_gc_max_deletes_per_sec() const {
+  return gc_max_deletes_per_sec;
+}
+
+unsigned S3Option::get_gc_scan_interval_sec() const {
+  return gc_scan_interval_sec;
+}
+
+unsigned S3Option::get_gc_min_record_age_sec() const {
+  return gc_min_record_age_sec;
+}
+
+bool S3Option::is_admission_control_enabled() const {
+  return admission_control_enable;
+}
+
+unsigned S3Option::get_admission_queue_max_length() const {
+  return admission_queue_max_length;
+}
+
+unsigned S3Option::get_admission_queue_max_wait_ms() const {
+  return admission_queue_max_wait_ms;
+}
+
+size_t S3Option::get_admission_small_request_size() const {
+  return admission_small_request_size;
+}
+
 std::string S3Option::get_motr_local_addr() { return motr_local_addr; }
 
 std::string S3Option::get_motr_ha_addr() { return motr_ha_addr; }
@@ -1327,6 +1828,130 @@ void S3Option::set_stats_allowlist_filename(std::string filename) {
   stats_allowlist_filename = filename;
 }
 
+bool S3Option::is_statsd_aggregation_enabled() const {
+  return statsd_aggregation_enable;
+}
+
+void S3Option::set_statsd_aggregation_enable(bool enable) {
+  statsd_aggregation_enable = enable;
+}
+
+unsigned short S3Option::get_statsd_max_packet_size() const {
+  return statsd_max_packet_size;
+}
+
+bool S3Option::is_metrics_enabled() const { return metrics_enable; }
+
+unsigned S3Option::get_metrics_quantile_window_sec() const {
+  return metrics_quantile_window_sec;
+}
+
+bool S3Option::is_request_trace_enabled() const { return request_trace_enable; }
+
+unsigned S3Option::get_request_trace_threshold_ms() const {
+  return request_trace_threshold_ms;
+}
+
+unsigned S3Option::get_request_trace_max_files() const {
+  return request_trace_max_files;
+}
+
+bool S3Option::is_inflight_requests_enabled() const {
+  return inflight_requests_enable;
+}
+
+unsigned S3Option::get_inflight_requests_log_interval_sec() const {
+  return inflight_requests_log_interval_sec;
+}
+
+unsigned S3Option::get_inflight_requests_log_top_n() const {
+  return inflight_requests_log_top_n;
+}
+
+unsigned S3Option::get_inflight_requests_log_threshold_ms() const {
+  return inflight_requests_log_threshold_ms;
+}
+
+const std::string& S3Option::get_mgmt_api_admin_account_id() const {
+  return mgmt_api_admin_account_id;
+}
+
+void S3Option::set_mgmt_api_admin_account_id(const std::string& value) {
+  mgmt_api_admin_account_id = value;
+}
+
+bool S3Option::is_parallel_metadata_save_enabled() const {
+  return parallel_metadata_save_enable;
+}
+
+void S3Option::set_parallel_metadata_save_enable(bool enable) {
+  parallel_metadata_save_enable = enable;
+}
+
+bool S3Option::is_kvs_group_commit_enabled() const {
+  return kvs_group_commit_enable;
+}
+
+unsigned S3Option::get_kvs_group_commit_window_usec() const {
+  return kvs_group_commit_window_usec;
+}
+
+unsigned S3Option::get_kvs_group_commit_max_keys() const {
+  return kvs_group_commit_max_keys;
+}
+
+bool S3Option::is_bucket_usage_enabled() const { return bucket_usage_enable; }
+
+void S3Option::set_bucket_usage_enable(bool enable) {
+  bucket_usage_enable = enable;
+}
+
+unsigned S3Option::get_bucket_usage_flush_interval_sec() const {
+  return bucket_usage_flush_interval_sec;
+}
+
+unsigned S3Option::get_bucket_usage_reconcile_interval_sec() const {
+  return bucket_usage_reconcile_interval_sec;
+}
+
+void S3Option::set_bucket_usage_reconcile_interval_sec(unsigned interval_sec) {
+  bucket_usage_reconcile_interval_sec = interval_sec;
+}
+
+unsigned S3Option::get_bucket_list_cache_max_accounts() const {
+  return bucket_list_cache_max_accounts;
+}
+
+unsigned S3Option::get_bucket_list_cache_expire_sec() const {
+  return bucket_list_cache_expire_sec;
+}
+
+unsigned S3Option::get_motr_completion_queue_size() const {
+  return motr_completion_queue_size;
+}
+
+unsigned S3Option::get_motr_completion_batch_size() const {
+  return motr_completion_batch_size;
+}
+
+bool S3Option::is_motr_emulator_enabled() const { return motr_emulator_enable; }
+
+unsigned S3Option::get_motr_emulator_threads() const {
+  return motr_emulator_threads;
+}
+
+unsigned S3Option::get_motr_emulator_latency_usec() const {
+  return motr_emulator_latency_usec;
+}
+
+unsigned S3Option::get_motr_emulator_bandwidth_mbps() const {
+  return motr_emulator_bandwidth_mbps;
+}
+
+std::string S3Option::get_motr_emulator_dir() const {
+  return motr_emulator_dir;
+}
+
 evbase_t* S3Option::get_eventbase() { return eventbase; }
 
 void S3Option::enable_fault_injection() { FLAGS_fault_injection = true; }
@@ -1367,6 +1992,22 @@ bool S3Option::get_libevent_mempool_zeroed_buffer() {
   return libevent_mempool_zeroed_buffer;
 }
 
+bool S3Option::get_motr_read_mempool_hugepage_arena() {
+  return motr_read_mempool_hugepage_arena;
+}
+
+bool S3Option::get_motr_read_mempool_numa_local() {
+  return motr_read_mempool_numa_local;
+}
+
+bool S3Option::get_libevent_mempool_hugepage_arena() {
+  return libevent_mempool_hugepage_arena;
+}
+
+bool S3Option::get_libevent_mempool_numa_local() {
+  return libevent_mempool_numa_local;
+}
+
 unsigned int S3Option::get_motr_first_read_size() {
   return motr_first_obj_read_size;
 }
@@ -112,11 +112,16 @@ class S3Option {
   std::string s3_iam_cert_file;
   std::string audit_log_conf_file;
   AuditFormatType audit_log_format;
+  bool audit_log_async_enable;
+  unsigned audit_log_async_buffer_size_kb;
   std::string audit_logger_policy;
   std::string audit_logger_host;
   int audit_logger_port;
   std::string audit_logger_rsyslog_msgid;
   std::string audit_logger_kafka_web_path;
+  unsigned audit_logger_batch_max_records;
+  unsigned audit_logger_max_requests_in_flight;
+  bool audit_logger_compress;
   unsigned short max_audit_retry_count;
   std::string s3server_ssl_cert_file;
   std::string s3server_ssl_pem_file;
@@ -133,12 +138,27 @@ class S3Option {
   bool log_buffering_enable;
   bool s3_enable_murmurhash_oid;
   int log_flush_frequency_sec;
+  bool log_async_enable;
+  unsigned log_async_buffer_size_kb;
+  unsigned log_async_sample_rate;
   unsigned int motr_first_obj_read_size;
 
   unsigned bucket_metadata_cache_max_size;
   unsigned bucket_metadata_cache_expire_sec;
   unsigned bucket_metadata_cache_refresh_sec;
 
+  bool gc_enable;
+  unsigned gc_batch_size;
+  unsigned gc_max_inflight;
+  unsigned gc_max_deletes_per_sec;
+  unsigned gc_scan_interval_sec;
+  unsigned gc_min_record_age_sec;
+
+  bool admission_control_enable;
+  unsigned admission_queue_max_length;
+  unsigned admission_queue_max_wait_ms;
+  size_t admission_small_request_size;
+
   bool s3_di_disable_data_corruption_iem;
   bool s3_di_disable_metadata_corruption_iem;
 
@@ -162,6 +182,10 @@ class S3Option {
 
   bool motr_read_mempool_zeroed_buffer;
   bool libevent_mempool_zeroed_buffer;
+  bool motr_read_mempool_hugepage_arena;
+  bool motr_read_mempool_numa_local;
+  bool libevent_mempool_hugepage_arena;
+  bool libevent_mempool_numa_local;
 
   size_t motr_read_pool_initial_buffer_count;
   size_t motr_read_pool_expandable_count;
@@ -190,6 +214,34 @@ class S3Option {
   unsigned short statsd_max_send_retry;
   std::string stats_allowlist_filename;
   uint32_t perf_stats_inout_bytes_interval_msec;
+  bool statsd_aggregation_enable;
+  unsigned short statsd_max_packet_size;
+  bool metrics_enable;
+  unsigned metrics_quantile_window_sec;
+  bool request_trace_enable;
+  unsigned request_trace_threshold_ms;
+  unsigned request_trace_max_files;
+  bool inflight_requests_enable;
+  unsigned inflight_requests_log_interval_sec;
+  unsigned inflight_requests_log_top_n;
+  unsigned inflight_requests_log_threshold_ms;
+  std::string mgmt_api_admin_account_id;
+  bool parallel_metadata_save_enable;
+  bool kvs_group_commit_enable;
+  unsigned kvs_group_commit_window_usec;
+  unsigned kvs_group_commit_max_keys;
+  bool bucket_usage_enable;
+  unsigned bucket_usage_flush_interval_sec;
+  unsigned bucket_usage_reconcile_interval_sec;
+  unsigned bucket_list_cache_max_accounts;
+  unsigned bucket_list_cache_expire_sec;
+  unsigned motr_completion_queue_size;
+  unsigned motr_completion_batch_size;
+  bool motr_emulator_enable;
+  unsigned motr_emulator_threads;
+  unsigned motr_emulator_latency_usec;
+  unsigned motr_emulator_bandwidth_mbps;
+  std::string motr_emulator_dir;
   evbase_t* eventbase;
 
   static S3Option* option_instance;
@@ -224,9 +276,14 @@ class S3Option {
     s3_version = "1";
     log_level = FLAGS_s3loglevel;
     audit_log_conf_file = FLAGS_audit_config;
+    audit_log_async_enable = false;
+    audit_log_async_buffer_size_kb = 4096;
     log_file_max_size_mb = 100;  // 100 MB
     log_buffering_enable = true;
     log_flush_frequency_sec = 30;  // 30 seconds
+    log_async_enable = false;
+    log_async_buffer_size_kb = 1024;
+    log_async_sample_rate = 10;
 
     // possible values: "disabled", "rsyslog-tcp"
     audit_logger_policy = "disabled";
@@ -234,6 +291,9 @@ class S3Option {
     audit_logger_port = 514;
     audit_logger_rsyslog_msgid = "s3server-audit-logging";
     audit_logger_kafka_web_path = "/topics/test";
+    audit_logger_batch_max_records = 100;
+    audit_logger_max_requests_in_flight = 4;
+    audit_logger_compress = false;
     max_audit_retry_count = 5;
 
     motr_layout_id = FLAGS_motrlayoutid;
@@ -252,6 +312,10 @@ class S3Option {
 
     motr_read_mempool_zeroed_buffer = 0;
     libevent_mempool_zeroed_buffer = 0;
+    motr_read_mempool_hugepage_arena = false;
+    motr_read_mempool_numa_local = false;
+    libevent_mempool_hugepage_arena = false;
+    libevent_mempool_numa_local = false;
 
     // libevent_pool_buffer_size is used for each item in this
     motr_read_pool_initial_buffer_count = 10;   // 10 buffer
@@ -293,6 +357,33 @@ class S3Option {
     stats_allowlist_filename =
         "/opt/seagate/cortx/s3/conf/s3stats-allowlist.yaml";
     perf_stats_inout_bytes_interval_msec = 1000;
+    statsd_aggregation_enable = false;
+    statsd_max_packet_size = 1432;
+    metrics_enable = false;
+    metrics_quantile_window_sec = 60;
+    request_trace_enable = false;
+    request_trace_threshold_ms = 1000;
+    request_trace_max_files = 100;
+    inflight_requests_enable = false;
+    inflight_requests_log_interval_sec = 60;
+    inflight_requests_log_top_n = 5;
+    inflight_requests_log_threshold_ms = 5000;
+    mgmt_api_admin_account_id = "";
+    parallel_metadata_save_enable = true;
+    kvs_group_commit_enable = false;
+    kvs_group_commit_window_usec = 500;
+    kvs_group_commit_max_keys = 64;
+    bucket_usage_enable = false;
+    bucket_usage_flush_interval_sec = 10;
+    bucket_usage_reconcile_interval_sec = 0;
+    bucket_list_cache_max_accounts = 1000;
+    bucket_list_cache_expire_sec = 5;
+    motr_completion_queue_size = 65536;
+    motr_completion_batch_size = 256;
+    motr_emulator_enable = false;
+    motr_emulator_threads = 4;
+    motr_emulator_latency_usec = 0;
+    motr_emulator_bandwidth_mbps = 0;
 
     redis_srv_addr = "127.0.0.1";
     redis_srv_port = 6397;
@@ -300,6 +391,18 @@ class S3Option {
     motr_etimedout_max_threshold = 5;
     motr_etimedout_window_sec = 60;
 
+    gc_enable = false;
+    gc_batch_size = 100;
+    gc_max_inflight = 8;
+    gc_max_deletes_per_sec = 100;
+    gc_scan_interval_sec = 60;
+    gc_min_record_age_sec = 900;
+
+    admission_control_enable = false;
+    admission_queue_max_length = 1024;
+    admission_queue_max_wait_ms = 2000;
+    admission_small_request_size = 1048576;
+
     eventbase = NULL;
 
     // find out the nodename
@@ -336,12 +439,17 @@ class S3Option {
   std::string get_s3_pidfile();
   std::string get_s3_audit_config();
   AuditFormatType get_s3_audit_format_type();
+  bool is_audit_log_async_enabled() const;
+  unsigned get_audit_log_async_buffer_size_kb() const;
   std::string get_audit_logger_policy();
   void set_audit_logger_policy(std::string const&);
   std::string get_audit_logger_host();
   int get_audit_logger_port();
   std::string get_audit_logger_rsyslog_msgid();
   std::string get_audit_logger_kafka_web_path();
+  unsigned get_audit_logger_batch_max_records() const;
+  unsigned get_audit_logger_max_requests_in_flight() const;
+  bool is_audit_logger_compress_enabled() const;
   unsigned short get_audit_max_retry_count();
   unsigned short get_s3_bind_port();
   unsigned short get_motr_http_bind_port();
@@ -391,6 +499,9 @@ class S3Option {
   bool is_log_buffering_enabled();
   bool is_murmurhash_oid_enabled();
   int get_log_flush_frequency_in_sec();
+  bool is_log_async_enabled() const;
+  unsigned get_log_async_buffer_size_kb() const;
+  unsigned get_log_async_sample_rate() const;
 
   unsigned short s3_performance_enabled();
   std::string get_perf_log_filename();
@@ -399,6 +510,19 @@ class S3Option {
   unsigned get_bucket_metadata_cache_expire_sec() const;
   unsigned get_bucket_metadata_cache_refresh_sec() const;
 
+  bool is_gc_enabled() const;
+  void set_gc_enable(bool enable);
+  unsigned get_gc_batch_size() const;
+  unsigned get_gc_max_inflight() const;
+  unsigned get_gc_max_deletes_per_sec() const;
+  unsigned get_gc_scan_interval_sec() const;
+  unsigned get_gc_min_record_age_sec() const;
+
+  bool is_admission_control_enabled() const;
+  unsigned get_admission_queue_max_length() const;
+  unsigned get_admission_queue_max_wait_ms() const;
+  size_t get_admission_small_request_size() const;
+
   std::string get_motr_local_addr();
   std::string get_motr_ha_addr();
   std::string get_motr_prof();
@@ -466,6 +590,10 @@ class S3Option {
 
   bool get_motr_read_mempool_zeroed_buffer();
   bool get_libevent_mempool_zeroed_buffer();
+  bool get_motr_read_mempool_hugepage_arena();
+  bool get_motr_read_mempool_numa_local();
+  bool get_libevent_mempool_hugepage_arena();
+  bool get_libevent_mempool_numa_local();
 
   bool is_stats_enabled();
   void set_stats_enable(bool enable);
@@ -475,6 +603,39 @@ class S3Option {
   std::string get_stats_allowlist_filename();
   uint32_t get_perf_stats_inout_bytes_interval_msec();
   void set_stats_allowlist_filename(std::string filename);
+  bool is_statsd_aggregation_enabled() const;
+  void set_statsd_aggregation_enable(bool enable);
+  unsigned short get_statsd_max_packet_size() const;
+  bool is_metrics_enabled() const;
+  unsigned get_metrics_quantile_window_sec() const;
+  bool is_request_trace_enabled() const;
+  unsigned get_request_trace_threshold_ms() const;
+  unsigned get_request_trace_max_files() const;
+  bool is_inflight_requests_enabled() const;
+  unsigned get_inflight_requests_log_interval_sec() const;
+  unsigned get_inflight_requests_log_top_n() const;
+  unsigned get_inflight_requests_log_threshold_ms() const;
+  const std::string& get_mgmt_api_admin_account_id() const;
+  void set_mgmt_api_admin_account_id(const std::string& value);
+  bool is_parallel_metadata_save_enabled() const;
+  void set_parallel_metadata_save_enable(bool enable);
+  bool is_kvs_group_commit_enabled() const;
+  unsigned get_kvs_group_commit_window_usec() const;
+  unsigned get_kvs_group_commit_max_keys() const;
+  bool is_bucket_usage_enabled() const;
+  void set_bucket_usage_enable(bool enable);
+  unsigned get_bucket_usage_flush_interval_sec() const;
+  unsigned get_bucket_usage_reconcile_interval_sec() const;
+  void set_bucket_usage_reconcile_interval_sec(unsigned interval_sec);
+  unsigned get_bucket_list_cache_max_accounts() const;
+  unsigned get_bucket_list_cache_expire_sec() const;
+  unsigned get_motr_completion_queue_size() const;
+  unsigned get_motr_completion_batch_size() const;
+  bool is_motr_emulator_enabled() const;
+  unsigned get_motr_emulator_threads() const;
+  unsigned get_motr_emulator_latency_usec() const;
+  unsigned get_motr_emulator_bandwidth_mbps() const;
+  std::string get_motr_emulator_dir() const;
 
   // Fault injection Option
   void enable_fault_injection();
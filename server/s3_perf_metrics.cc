@@ -68,7 +68,11 @@ class S3ThroughputMetricsEvent : public RecurringEventBase {
                            evbase_t *evbase_ = nullptr)
       : RecurringEventBase(std::move(event_obj_ptr), evbase_) {}
 
-  virtual void action_callback(void) noexcept { submit_metrics(); }
+  virtual void action_callback(void) noexcept {
+    submit_metrics();
+    // Metrics aggregated by S3Stats are sent on the same timer.
+    s3_stats_flush();
+  }
 
   void more_bytes_in(int cnt) { in.more_bytes(cnt); }
 
@@ -22,6 +22,7 @@
 #include <libxml/xmlmemory.h>
 #include <unistd.h>
 
+#include "s3_bucket_usage.h"
 #include "s3_error_codes.h"
 #include "s3_iem.h"
 #include "s3_log.h"
@@ -108,6 +109,9 @@ void S3PostCompleteAction::setup_steps() {
   ACTION_TASK_ADD(S3PostCompleteAction::get_next_parts_info, this);
   ACTION_TASK_ADD(
       S3PostCompleteAction::add_object_oid_to_probable_dead_oid_list, this);
+  if (s3_bucket_usage()) {
+    ACTION_TASK_ADD(S3PostCompleteAction::fetch_replaced_object_info, this);
+  }
   ACTION_TASK_ADD(S3PostCompleteAction::save_metadata, this);
   ACTION_TASK_ADD(S3PostCompleteAction::delete_multipart_metadata, this);
   ACTION_TASK_ADD(S3PostCompleteAction::delete_part_list_index, this);
@@ -604,6 +608,26 @@ void S3PostCompleteAction::add_object_oid_to_probable_dead_oid_list_failed() {
   s3_log(S3_LOG_DEBUG, "", "%s Exit", __func__);
 }
 
+// Size of the object being replaced is not kept in multipart metadata, and
+// the object may have been replaced since the upload was initiated.
+void S3PostCompleteAction::fetch_replaced_object_info() {
+  s3_log(S3_LOG_INFO, stripped_request_id, "%s Entry\n", __func__);
+  if (is_abort_multipart()) {
+    next();
+  } else {
+    replaced_object_metadata =
+        object_metadata_factory->create_object_metadata_obj(
+            request, bucket_metadata->get_object_list_index_oid());
+    replaced_object_metadata->set_objects_version_list_index_oid(
+        bucket_metadata->get_objects_version_list_index_oid());
+    // Used for bucket usage only, so failure does not fail the request.
+    replaced_object_metadata->load(
+        std::bind(&S3PostCompleteAction::next, this),
+        std::bind(&S3PostCompleteAction::next, this));
+  }
+  s3_log(S3_LOG_DEBUG, "", "%s Exit", __func__);
+}
+
 void S3PostCompleteAction::save_metadata() {
   s3_log(S3_LOG_INFO, stripped_request_id, "%s Entry\n", __func__);
   if (is_abort_multipart()) {
@@ -638,6 +662,12 @@ void S3PostCompleteAction::save_object_metadata_succesful() {
   s3_log(S3_LOG_INFO, stripped_request_id, "%s Entry\n", __func__);
   obj_metadata_updated = true;
   s3_post_complete_action_state = S3PostCompleteActionState::metadataSaved;
+  s3_bucket_usage_object_put(
+      *bucket_metadata, *new_object_metadata,
+      replaced_object_metadata && replaced_object_metadata->get_state() ==
+                                      S3ObjectMetadataState::present
+          ? replaced_object_metadata.get()
+          : nullptr);
   next();
   s3_log(S3_LOG_DEBUG, "", "%s Exit", __func__);
 }
@@ -60,6 +60,8 @@ class S3PostCompleteAction : public S3ObjectAction {
   std::shared_ptr<S3MotrWiter> motr_writer;
   std::shared_ptr<S3MotrKVSWriter> motr_kv_writer;
   std::shared_ptr<S3ObjectMetadata> new_object_metadata;
+  // Object which is overwritten, loaded only for bucket usage.
+  std::shared_ptr<S3ObjectMetadata> replaced_object_metadata;
   std::string upload_id;
   std::string bucket_name;
   std::string object_name;
@@ -121,6 +123,7 @@ class S3PostCompleteAction : public S3ObjectAction {
   bool validate_parts();
   void get_parts_failed();
   void get_part_info(int part);
+  void fetch_replaced_object_info();
   void save_metadata();
   void save_object_metadata_succesful();
   void save_object_metadata_failed();
@@ -20,6 +20,7 @@
 
 #include <functional>
 
+#include "s3_bucket_list_cache.h"
 #include "s3_error_codes.h"
 #include "s3_log.h"
 #include "s3_put_bucket_action.h"
@@ -250,7 +251,7 @@ void S3PutBucketAction::create_bucket() {
     // bypass shutdown signal check for next task
     check_shutdown_signal_for_next_task(false);
     bucket_metadata->save(
-        std::bind(&S3PutBucketAction::next, this),
+        std::bind(&S3PutBucketAction::create_bucket_successful, this),
         std::bind(&S3PutBucketAction::create_bucket_failed, this));
   } else if (bucket_metadata->get_state() ==
              S3BucketMetadataState::failed_to_launch) {
@@ -265,8 +266,17 @@ void S3PutBucketAction::create_bucket() {
   s3_log(S3_LOG_DEBUG, "", "%s Exit", __func__);
 }
 
+void S3PutBucketAction::create_bucket_successful() {
+  s3_log(S3_LOG_INFO, stripped_request_id, "%s Entry\n", __func__);
+  s3_bucket_list_cache_invalidate(request->get_account_id());
+  next();
+  s3_log(S3_LOG_DEBUG, "", "%s Exit", __func__);
+}
+
 void S3PutBucketAction::create_bucket_failed() {
   s3_log(S3_LOG_INFO, stripped_request_id, "%s Entry\n", __func__);
+  // Metadata may have been saved to the bucket list index only.
+  s3_bucket_list_cache_invalidate(request->get_account_id());
   if (bucket_metadata->get_state() == S3BucketMetadataState::failed_to_launch) {
     s3_log(S3_LOG_ERROR, request_id,
            "Save bucket metadata operation failed due to prelaunch failure\n");
@@ -60,6 +60,7 @@ class S3PutBucketAction : public S3Action {
   void validate_bucket_name();
   void read_metadata();
   void create_bucket();
+  void create_bucket_successful();
   void create_bucket_failed();
   void send_response_to_s3_client();
 
@@ -19,6 +19,7 @@
  */
 
 #include "s3_put_chunk_upload_object_action.h"
+#include "s3_bucket_usage.h"
 #include "s3_motr_layout.h"
 #include "s3_error_codes.h"
 #include "s3_iem.h"
@@ -691,6 +692,10 @@ void S3PutChunkUploadObjectAction::save_metadata() {
 void S3PutChunkUploadObjectAction::save_object_metadata_success() {
   s3_log(S3_LOG_INFO, stripped_request_id, "%s Entry\n", __func__);
   s3_put_chunk_action_state = S3PutChunkUploadObjectActionState::metadataSaved;
+  s3_bucket_usage_object_put(*bucket_metadata, *new_object_metadata,
+                             (old_object_oid.u_hi || old_object_oid.u_lo)
+                                 ? object_metadata.get()
+                                 : nullptr);
   next();
 }
 
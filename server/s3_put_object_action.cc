@@ -19,6 +19,7 @@
  */
 
 #include "s3_put_object_action.h"
+#include "s3_bucket_usage.h"
 #include "s3_motr_layout.h"
 #include "s3_common.h"
 #include "s3_error_codes.h"
@@ -606,6 +607,13 @@ void S3PutObjectAction::save_metadata() {
     }
   }
 
+  // Lets new metadata be saved to both indices at once.
+  if (old_object_oid.u_hi || old_object_oid.u_lo) {
+    new_object_metadata->set_replaced_metadata(object_metadata);
+  } else {
+    new_object_metadata->set_replaced_metadata(nullptr);
+  }
+
   // bypass shutdown signal check for next task
   check_shutdown_signal_for_next_task(false);
   new_object_metadata->save(
@@ -617,6 +625,10 @@ void S3PutObjectAction::save_metadata() {
 void S3PutObjectAction::save_object_metadata_success() {
   s3_log(S3_LOG_INFO, stripped_request_id, "%s Entry\n", __func__);
   s3_put_action_state = S3PutObjectActionState::metadataSaved;
+  s3_bucket_usage_object_put(*bucket_metadata, *new_object_metadata,
+                             (old_object_oid.u_hi || old_object_oid.u_lo)
+                                 ? object_metadata.get()
+                                 : nullptr);
   next();
 }
 
@@ -30,6 +30,7 @@
 #include "s3_stats.h"
 #include "s3_audit_info_logger.h"
 #include "s3_iem.h"
+#include "s3_metrics.h"
 
 extern S3Option* g_option_instance;
 
@@ -51,11 +52,17 @@ S3RequestObject::S3RequestObject(
   }
 
   audit_log_obj.set_time_of_request_arrival();
+  s3_metrics_request_started();
 }
 
 S3RequestObject::~S3RequestObject() {
   s3_log(S3_LOG_DEBUG, request_id, "%s\n", __func__);
   populate_and_log_audit_info();
+
+  // Timer is not stopped when no response was sent (e.g. client went away).
+  int64_t elapsed_nsec = request_timer.elapsed_time_in_nanosec();
+  s3_metrics_request_finished(s3_action.empty() ? "Unknown" : s3_action,
+                              elapsed_nsec < 0 ? -1 : elapsed_nsec / 1000);
 }
 
 S3AuditInfo& S3RequestObject::get_audit_info() { return audit_log_obj; }
@@ -67,6 +74,11 @@ std::string S3RequestObject::get_object_uri() {
 
 std::string S3RequestObject::get_action_str() { return s3_action; }
 
+void S3RequestObject::describe(S3InFlightRequestInfo& info) {
+  RequestObject::describe(info);
+  info.action = s3_action;
+}
+
 void S3RequestObject::set_bucket_name(const std::string& name) {
   bucket_name = name;
 }
@@ -154,7 +166,7 @@ void S3RequestObject::populate_and_log_audit_info() {
   }
 
   audit_log_obj.set_bucket_name(bucket_name);
-  audit_log_obj.set_remote_ip(get_header_value("X-Forwarded-For"));
+  audit_log_obj.set_remote_ip(get_known_header(S3Header::x_forwarded_for));
   audit_log_obj.set_bytes_received(get_content_length());
   audit_log_obj.set_requester(get_account_id());
   audit_log_obj.set_request_id(request_id);
@@ -162,19 +174,19 @@ void S3RequestObject::populate_and_log_audit_info() {
   audit_log_obj.set_object_key(get_object_uri());
   audit_log_obj.set_request_uri(request_uri);
   audit_log_obj.set_http_status(http_status);
-  audit_log_obj.set_signature_version(get_header_value("Authorization"));
-  audit_log_obj.set_user_agent(get_header_value("User-Agent"));
+  audit_log_obj.set_signature_version(
+      get_known_header(S3Header::authorization));
+  audit_log_obj.set_user_agent(get_known_header(S3Header::user_agent));
   audit_log_obj.set_version_id(get_query_string_value("versionId"));
   // Setting object size for PUT object request
   if (object_size != 0) {
     audit_log_obj.set_object_size(object_size);
   }
-  audit_log_obj.set_host_header(get_header_value("Host"));
+  audit_log_obj.set_host_header(get_known_header(S3Header::host));
 
   // Skip audit logs for health checks.
   if (audit_log_obj.get_publish_flag()) {
-    if (S3AuditInfoLogger::save_msg(request_id, audit_log_obj.to_string()) <
-        0) {
+    if (S3AuditInfoLogger::save_audit_info(request_id, audit_log_obj) < 0) {
       s3_log(S3_LOG_FATAL, request_id, "Audit Logger Error. STOP Server\n");
     }
   }
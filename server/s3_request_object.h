@@ -86,6 +86,7 @@ class S3RequestObject : public RequestObject {
   virtual void set_object_name(const std::string& name);
   virtual const std::string& get_object_name();
   virtual void set_action_str(const std::string& action);
+  virtual void describe(S3InFlightRequestInfo& info);
   virtual void set_default_acl(const std::string& name);
   virtual const std::string& get_default_acl();
   bool validate_attrs(const std::string& c_bucket_name,
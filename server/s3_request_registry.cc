@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+#include <errno.h>
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+#include <json/json.h>
+
+#include "atexit.h"
+#include "request_object.h"
+#include "s3_log.h"
+#include "s3_option.h"
+#include "s3_request_registry.h"
+
+extern S3Option* g_option_instance;
+
+S3RequestRegistry::S3RequestRegistry(
+    std::shared_ptr<EventInterface> event_obj_ptr, evbase_t* evbase_,
+    size_t log_top_n_, int64_t log_threshold_us_)
+    : RecurringEventBase(std::move(event_obj_ptr), evbase_),
+      log_top_n(log_top_n_),
+      log_threshold_us(log_threshold_us_) {}
+
+void S3RequestRegistry::add(RequestObject* request) {
+  requests.insert(request);
+}
+
+void S3RequestRegistry::remove(RequestObject* request) {
+  requests.erase(request);
+}
+
+std::vector<S3InFlightRequestInfo> S3RequestRegistry::get_slowest(
+    size_t limit) const {
+  // Sort by arrival time first, so only requests which are returned have to
+  // be described.
+  std::vector<std::pair<std::chrono::steady_clock::time_point, RequestObject*>>
+      by_arrival;
+  by_arrival.reserve(requests.size());
+  for (RequestObject* request : requests) {
+    by_arrival.emplace_back(request->get_arrival_time(), request);
+  }
+  limit = std::min(limit, by_arrival.size());
+  std::partial_sort(by_arrival.begin(), by_arrival.begin() + limit,
+                    by_arrival.end());
+
+  std::vector<S3InFlightRequestInfo> infos(limit);
+  for (size_t i = 0; i < limit; ++i) {
+    by_arrival[i].second->describe(infos[i]);
+  }
+  return infos;
+}
+
+void S3RequestRegistry::action_callback(void) noexcept {
+  for (const auto& info : get_slowest(log_top_n)) {
+    if (info.elapsed_us < log_threshold_us) {
+      break;
+    }
+    s3_log(S3_LOG_WARN, info.request_id,
+           "Slow request in flight for %lld ms: %s %s action: %s task: %s "
+           "async op: %s (%u in flight, %lld ms) bytes in/out: %zu/%zu\n",
+           (long long)(info.elapsed_us / 1000), info.method.c_str(),
+           info.uri.c_str(), info.action.c_str(), info.task.c_str(),
+           info.async_op.c_str(), info.async_ops_count,
+           (long long)(info.async_op_elapsed_us / 1000), info.bytes_received,
+           info.bytes_sent);
+  }
+}
+
+std::string S3RequestRegistry::to_json(
+    const std::vector<S3InFlightRequestInfo>& infos, size_t total_count) {
+  Json::Value root;
+  root["count"] = (Json::UInt64)total_count;
+  Json::Value& requests_json = root["requests"];
+  requests_json = Json::Value(Json::arrayValue);
+
+  for (const auto& info : infos) {
+    Json::Value request_json;
+    request_json["request_id"] = info.request_id;
+    request_json["method"] = info.method;
+    request_json["uri"] = info.uri;
+    request_json["action"] = info.action;
+    request_json["task"] = info.task;
+    request_json["elapsed_ms"] = (Json::Int64)(info.elapsed_us / 1000);
+    request_json["bytes_received"] = (Json::UInt64)info.bytes_received;
+    request_json["bytes_sent"] = (Json::UInt64)info.bytes_sent;
+    if (info.async_ops_count) {
+      request_json["async_op"] = info.async_op;
+      request_json["async_op_elapsed_ms"] =
+          (Json::Int64)(info.async_op_elapsed_us / 1000);
+      request_json["async_ops_in_flight"] = info.async_ops_count;
+    }
+    requests_json.append(request_json);
+  }
+  Json::FastWriter fast_writer;
+  return fast_writer.write(root);
+}
+
+static std::shared_ptr<S3RequestRegistry> gs_request_registry;
+
+int s3_request_registry_init(evbase_t* evbase) {
+  struct timeval tv;
+  if (!g_option_instance->is_inflight_requests_enabled()) {
+    return 0;
+  }
+  s3_log(S3_LOG_INFO, "", "%s Entry", __func__);
+
+  AtExit call_fini([]() { s3_request_registry_fini(); });
+
+  if (!evbase) {
+    return -EINVAL;
+  }
+  gs_request_registry = std::make_shared<S3RequestRegistry>(
+      std::make_shared<EventWrapper>(), evbase,
+      g_option_instance->get_inflight_requests_log_top_n(),
+      (int64_t)g_option_instance->get_inflight_requests_log_threshold_ms() *
+          1000);
+  if (!gs_request_registry) {
+    return -ENOMEM;
+  }
+  const unsigned interval_sec =
+      g_option_instance->get_inflight_requests_log_interval_sec();
+  if (interval_sec) {
+    tv.tv_sec = interval_sec;
+    tv.tv_usec = 0;
+    int rc = gs_request_registry->add_evtimer(tv);
+    if (rc != 0) {
+      return rc;
+    }
+  }
+  call_fini.cancel();
+
+  return 0;
+}
+
+void s3_request_registry_fini() {
+  if (!gs_request_registry) {
+    return;
+  }
+  s3_log(S3_LOG_INFO, "", "%s Entry", __func__);
+  gs_request_registry->del_evtimer();
+  gs_request_registry.reset();
+}
+
+std::shared_ptr<S3RequestRegistry> s3_request_registry() {
+  return gs_request_registry;
+}
+
+void s3_request_registry_add(RequestObject* request) {
+  if (gs_request_registry) {
+    gs_request_registry->add(request);
+  }
+}
+
+void s3_request_registry_remove(RequestObject* request) {
+  if (gs_request_registry) {
+    gs_request_registry->remove(request);
+  }
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+#pragma once
+
+#ifndef __S3_SERVER_S3_REQUEST_REGISTRY_H__
+#define __S3_SERVER_S3_REQUEST_REGISTRY_H__
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "event_utils.h"
+
+#define S3_INFLIGHT_REQUESTS_PATH "/requests"
+
+class RequestObject;
+
+// What a request in flight is doing, see RequestObject::describe().
+struct S3InFlightRequestInfo {
+  std::string request_id;
+  std::string method;
+  std::string uri;
+  // S3 API name, empty until the request is routed.
+  std::string action;
+  // Running action task, or the last one which has run.
+  std::string task;
+  // Latest started async operation (Motr or auth) which has not completed.
+  std::string async_op;
+  unsigned async_ops_count = 0;
+  int64_t elapsed_us = 0;
+  int64_t async_op_elapsed_us = 0;
+  size_t bytes_received = 0;
+  size_t bytes_sent = 0;
+};
+
+// Registry of all request objects which exist, i.e. requests which are
+// being processed including background cleanup after the response.
+//
+// Serves the list of the slowest requests on GET of management API path
+// /requests, and periodically logs the slowest ones which take longer than
+// S3_INFLIGHT_REQUESTS_LOG_THRESHOLD_MS.  Used on the main thread only.
+class S3RequestRegistry : public RecurringEventBase {
+  std::unordered_set<RequestObject*> requests;
+  size_t log_top_n;
+  int64_t log_threshold_us;
+
+ public:
+  S3RequestRegistry(std::shared_ptr<EventInterface> event_obj_ptr = nullptr,
+                    evbase_t* evbase_ = nullptr, size_t log_top_n = 5,
+                    int64_t log_threshold_us = 0);
+
+  void add(RequestObject* request);
+  void remove(RequestObject* request);
+  size_t get_count() const { return requests.size(); }
+
+  // At most 'limit' requests, those in flight the longest first.
+  std::vector<S3InFlightRequestInfo> get_slowest(size_t limit) const;
+
+  // Logs the slowest requests.
+  virtual void action_callback(void) noexcept;
+
+  static std::string to_json(const std::vector<S3InFlightRequestInfo>& infos,
+                             size_t total_count);
+
+};
+
+int s3_request_registry_init(evbase_t* evbase);
+void s3_request_registry_fini();
+// Returns nullptr when the registry is disabled.
+std::shared_ptr<S3RequestRegistry> s3_request_registry();
+
+// Helpers, no-op when the registry is disabled.
+void s3_request_registry_add(RequestObject* request);
+void s3_request_registry_remove(RequestObject* request);
+
+#endif
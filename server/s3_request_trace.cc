@@ -0,0 +1,299 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include <json/json.h>
+
+#include "s3_log.h"
+#include "s3_option.h"
+#include "s3_request_trace.h"
+
+static const char* get_category_name(S3TraceCategory category) {
+  switch (category) {
+    case S3TraceCategory::request:
+      return "request";
+    case S3TraceCategory::action:
+      return "action";
+    case S3TraceCategory::auth:
+      return "auth";
+    case S3TraceCategory::kvs:
+      return "kvs";
+    case S3TraceCategory::io:
+      return "io";
+  }
+  return "unknown";
+}
+
+const size_t S3RequestTrace::max_spans;
+
+namespace {
+
+struct S3TraceSaveJob {
+  std::string dir;
+  std::string request_id;
+  std::string trace;
+  unsigned max_files;
+};
+
+// State of the writer thread, see S3RequestTrace::start_writer().
+struct S3TraceWriter {
+  std::mutex lock;
+  std::condition_variable cond;
+  std::deque<S3TraceSaveJob> jobs;
+  size_t max_queued = 0;
+  bool running = false;
+  bool stopping = false;
+  uint64_t dropped_count = 0;
+  std::thread thread;
+};
+
+S3TraceWriter gs_trace_writer;
+
+void trace_writer_main() {
+  std::unique_lock<std::mutex> lock(gs_trace_writer.lock);
+  for (;;) {
+    gs_trace_writer.cond.wait(lock, []() {
+      return gs_trace_writer.stopping || !gs_trace_writer.jobs.empty();
+    });
+    if (gs_trace_writer.jobs.empty()) {
+      // Stopping, everything queued is saved.
+      return;
+    }
+    S3TraceSaveJob job = std::move(gs_trace_writer.jobs.front());
+    gs_trace_writer.jobs.pop_front();
+    lock.unlock();
+    S3RequestTrace::save(job.dir, job.request_id, job.trace, job.max_files);
+    lock.lock();
+  }
+}
+
+}  // namespace
+
+S3RequestTrace::S3RequestTrace(bool enable) {
+  if (enable) {
+    start_time = std::chrono::steady_clock::now();
+    spans.reset(new S3TraceSpan[max_spans]);
+    begin("request", S3TraceCategory::request);
+  }
+}
+
+int64_t S3RequestTrace::now_us() const {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now() - start_time).count();
+}
+
+int S3RequestTrace::begin(const char* name, S3TraceCategory category) {
+  if (!spans) {
+    return -1;
+  }
+  if (spans_count == max_spans) {
+    ++dropped_count;
+    return -1;
+  }
+  S3TraceSpan& span = spans[spans_count];
+  span.name = name;
+  span.category = category;
+  span.begin_us = now_us();
+  span.end_us = -1;
+  return (int)spans_count++;
+}
+
+void S3RequestTrace::end(int span_id) {
+  if (span_id < 0 || (size_t)span_id >= spans_count) {
+    return;
+  }
+  S3TraceSpan& span = spans[span_id];
+  if (span.end_us < 0) {
+    span.end_us = now_us();
+  }
+}
+
+int64_t S3RequestTrace::get_response_time_us() const {
+  if (!spans) {
+    return 0;
+  }
+  return spans[0].end_us < 0 ? now_us() : spans[0].end_us;
+}
+
+std::string S3RequestTrace::to_chrome_trace(const std::string& request_id)
+    const {
+  Json::Value root;
+  Json::Value& events = root["traceEvents"];
+  events = Json::Value(Json::arrayValue);
+  const int64_t now = now_us();
+  const Json::Int64 pid = getpid();
+
+  for (size_t i = 0; i < spans_count; ++i) {
+    const S3TraceSpan& span = spans[i];
+    Json::Value event;
+    event["name"] = span.name;
+    event["cat"] = get_category_name(span.category);
+    event["ph"] = "X";
+    event["ts"] = (Json::Int64)span.begin_us;
+    event["dur"] =
+        (Json::Int64)((span.end_us < 0 ? now : span.end_us) - span.begin_us);
+    event["pid"] = pid;
+    event["tid"] = (int)span.category;
+    if (span.end_us < 0) {
+      event["args"]["unfinished"] = true;
+    }
+    if (i == 0) {
+      event["args"]["request_id"] = request_id;
+    }
+    events.append(event);
+  }
+  // Name the rows after categories.
+  for (int category = (int)S3TraceCategory::request;
+       category <= (int)S3TraceCategory::io; ++category) {
+    Json::Value event;
+    event["name"] = "thread_name";
+    event["ph"] = "M";
+    event["pid"] = pid;
+    event["tid"] = category;
+    event["args"]["name"] = get_category_name((S3TraceCategory)category);
+    events.append(event);
+  }
+  root["displayTimeUnit"] = "ms";
+  root["otherData"]["request_id"] = request_id;
+  root["otherData"]["dropped_spans"] = (Json::UInt64)dropped_count;
+
+  Json::FastWriter fast_writer;
+  return fast_writer.write(root);
+}
+
+void S3RequestTrace::finish(const std::string& request_id) {
+  if (!spans) {
+    return;
+  }
+  S3Option* option_instance = S3Option::get_instance();
+  const int64_t threshold_us =
+      (int64_t)option_instance->get_request_trace_threshold_ms() * 1000;
+  const std::string log_dir = option_instance->get_log_dir();
+  if (get_response_time_us() < threshold_us || log_dir.empty()) {
+    return;
+  }
+  std::string trace = to_chrome_trace(request_id);
+  if (!save_async(log_dir + "/trace", request_id, trace,
+                  option_instance->get_request_trace_max_files())) {
+    save(log_dir + "/trace", request_id, trace,
+         option_instance->get_request_trace_max_files());
+  }
+}
+
+int S3RequestTrace::start_writer(size_t max_queued) {
+  std::lock_guard<std::mutex> guard(gs_trace_writer.lock);
+  if (gs_trace_writer.running) {
+    return -EEXIST;
+  }
+  gs_trace_writer.max_queued = max_queued;
+  gs_trace_writer.stopping = false;
+  gs_trace_writer.dropped_count = 0;
+  gs_trace_writer.thread = std::thread(trace_writer_main);
+  gs_trace_writer.running = true;
+  return 0;
+}
+
+void S3RequestTrace::stop_writer() {
+  {
+    std::lock_guard<std::mutex> guard(gs_trace_writer.lock);
+    if (!gs_trace_writer.running) {
+      return;
+    }
+    gs_trace_writer.running = false;
+    gs_trace_writer.stopping = true;
+  }
+  gs_trace_writer.cond.notify_one();
+  gs_trace_writer.thread.join();
+  if (gs_trace_writer.dropped_count) {
+    s3_log(S3_LOG_INFO, "", "%llu slow request traces were dropped\n",
+           (unsigned long long)gs_trace_writer.dropped_count);
+  }
+}
+
+bool S3RequestTrace::save_async(std::string dir, std::string request_id,
+                                std::string trace, unsigned max_files) {
+  {
+    std::lock_guard<std::mutex> guard(gs_trace_writer.lock);
+    if (!gs_trace_writer.running) {
+      return false;
+    }
+    if (gs_trace_writer.jobs.size() >= gs_trace_writer.max_queued) {
+      ++gs_trace_writer.dropped_count;
+      s3_log(S3_LOG_DEBUG, request_id,
+             "Trace writer is busy, slow request trace is dropped\n");
+      return true;
+    }
+    gs_trace_writer.jobs.push_back({std::move(dir), std::move(request_id),
+                                    std::move(trace), max_files});
+  }
+  gs_trace_writer.cond.notify_one();
+  return true;
+}
+
+int S3RequestTrace::save(const std::string& dir, const std::string& request_id,
+                         const std::string& trace, unsigned max_files) {
+  // Traces written so far, oldest first.
+  static std::deque<std::string> saved_files;
+
+  if (max_files == 0) {
+    return 0;
+  }
+  if (mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST) {
+    const int rc = -errno;
+    s3_log(S3_LOG_ERROR, request_id, "Cannot create directory %s: %s\n",
+           dir.c_str(), strerror(errno));
+    return rc;
+  }
+  const std::string file_name = dir + "/" + request_id + ".json";
+  FILE* file = fopen(file_name.c_str(), "w");
+  if (!file) {
+    const int rc = -errno;
+    s3_log(S3_LOG_ERROR, request_id, "Cannot open %s: %s\n",
+           file_name.c_str(), strerror(errno));
+    return rc;
+  }
+  const bool written = fwrite(trace.data(), 1, trace.size(), file) ==
+                       trace.size();
+  if (fclose(file) != 0 || !written) {
+    s3_log(S3_LOG_ERROR, request_id, "Cannot write %s\n", file_name.c_str());
+    unlink(file_name.c_str());
+    return -EIO;
+  }
+  s3_log(S3_LOG_INFO, request_id, "Slow request trace is saved to %s\n",
+         file_name.c_str());
+
+  saved_files.push_back(file_name);
+  while (saved_files.size() > max_files) {
+    unlink(saved_files.front().c_str());
+    saved_files.pop_front();
+  }
+  return 0;
+}
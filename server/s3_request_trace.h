@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+#pragma once
+
+#ifndef __S3_SERVER_S3_REQUEST_TRACE_H__
+#define __S3_SERVER_S3_REQUEST_TRACE_H__
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// Per-request timeline of action steps, auth calls, KVS operations and
+// object reads/writes.  Unlike ADDB it needs no Motr tools to read: slow
+// requests are saved as Chrome trace JSON, which can be opened with
+// chrome://tracing or https://ui.perfetto.dev.
+//
+// Usage (on the main thread only):
+//   int span = S3_TRACE_BEGIN(request, "get_keyval", S3TraceCategory::kvs);
+//   ...
+//   S3_TRACE_END(request, span);
+
+enum class S3TraceCategory {
+  request,
+  action,
+  auth,
+  kvs,
+  io
+};
+
+struct S3TraceSpan {
+  // Must be a string literal or have static storage duration.
+  const char* name;
+  S3TraceCategory category;
+  // Microseconds since the request arrival, end is -1 while span is open.
+  int64_t begin_us;
+  int64_t end_us;
+};
+
+class S3RequestTrace {
+ public:
+  // Spans beyond this number are not recorded, only counted.
+  static const size_t max_spans = 128;
+
+  // Disabled trace doesn't allocate anything and ignores all calls.
+  explicit S3RequestTrace(bool enable);
+
+  bool is_enabled() const { return spans != nullptr; }
+
+  // Returns span id to be passed to end(), or -1 if span is not recorded.
+  int begin(const char* name, S3TraceCategory category);
+  void end(int span_id);
+
+  // Ends the span which covers the whole request, called once the response
+  // is sent to the client.
+  void responded() { end(0); }
+
+  size_t get_spans_count() const { return spans_count; }
+  size_t get_dropped_count() const { return dropped_count; }
+  const S3TraceSpan& get_span(size_t span_id) const { return spans[span_id]; }
+
+  // Time until the response, or until now if the request is not responded.
+  int64_t get_response_time_us() const;
+
+  // Trace in Chrome trace event format, each category is shown as a
+  // separate thread.  Spans which are still open end now.
+  std::string to_chrome_trace(const std::string& request_id) const;
+
+  // Saves the trace if the request is slower than
+  // S3_REQUEST_TRACE_THRESHOLD_MS.  Called when request object is destroyed,
+  // the file is written by the writer thread when it is running.
+  void finish(const std::string& request_id);
+
+  // Writes 'trace' to <dir>/<request_id>.json.  Keeps at most 'max_files'
+  // traces written by this process, removing the oldest ones.
+  static int save(const std::string& dir, const std::string& request_id,
+                  const std::string& trace, unsigned max_files);
+
+  // Starts the thread which saves traces off the event loop.  At most
+  // 'max_queued' traces wait for it, further ones are dropped.
+  static int start_writer(size_t max_queued = 64);
+  // Saves queued traces and stops the thread.
+  static void stop_writer();
+  // Queues save() for the writer thread.  Returns false if the writer is
+  // not running, the caller saves the trace itself then.
+  static bool save_async(std::string dir, std::string request_id,
+                         std::string trace, unsigned max_files);
+
+ private:
+  int64_t now_us() const;
+
+  std::chrono::steady_clock::time_point start_time;
+  std::unique_ptr<S3TraceSpan[]> spans;
+  size_t spans_count = 0;
+  size_t dropped_count = 0;
+};
+
+// 'req' is a pointer to RequestObject, it may be null.
+#define S3_TRACE_BEGIN(req, name, category) \
+  ((req) ? (req)->get_trace().begin((name), (category)) : -1)
+
+#define S3_TRACE_END(req, span_id)          \
+  do {                                      \
+    if (req) {                              \
+      (req)->get_trace().end((span_id));    \
+    }                                       \
+  } while (0)
+
+#endif
@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#include <ctype.h>
+#include <string.h>
+#include <strings.h>
+
+#include "s3_log.h"
+#include "s3_route_table.h"
+
+const size_t S3RouteTable::table_size;
+
+static uint32_t hash_name(const char* name, size_t length, uint32_t seed) {
+  // FNV-1a of lower case name.
+  uint32_t hash = 2166136261U ^ seed;
+  for (size_t i = 0; i < length; ++i) {
+    hash ^= (unsigned char)tolower((unsigned char)name[i]);
+    hash *= 16777619U;
+  }
+  // Low bits of FNV don't depend on high bits of the seed, mix them in.
+  hash ^= hash >> 16;
+  hash *= 0x85ebca6bU;
+  hash ^= hash >> 13;
+  hash *= 0xc2b2ae35U;
+  hash ^= hash >> 16;
+  return hash;
+}
+
+S3RouteTable::S3RouteTable() {
+  // Try seeds until every sub-resource gets its own slot.
+  for (;; ++seed) {
+    memset(slots, 0, sizeof(slots));
+    bool collision = false;
+    for (const auto& sub_resource : S3OperationString) {
+      const std::string& name = sub_resource.first;
+      Slot& slot = slots[get_slot(name.c_str(), name.length())];
+      if (slot.name) {
+        collision = true;
+        break;
+      }
+      slot.name = name.c_str();
+      slot.length = name.length();
+      slot.operation_code = sub_resource.second;
+    }
+    if (!collision) {
+      break;
+    }
+  }
+  s3_log(S3_LOG_DEBUG, "", "Sub-resource table of %zu entries, seed %u\n",
+         S3OperationString.size(), seed);
+}
+
+size_t S3RouteTable::get_slot(const char* name, size_t length) const {
+  return hash_name(name, length, seed) % table_size;
+}
+
+const S3RouteTable& S3RouteTable::get_instance() {
+  static const S3RouteTable route_table;
+  return route_table;
+}
+
+bool S3RouteTable::find_operation_code(const std::string& query_key,
+                                       S3OperationCode& operation_code) const {
+  const Slot& slot = slots[get_slot(query_key.c_str(), query_key.length())];
+  if (!slot.name || slot.length != query_key.length() ||
+      strncasecmp(slot.name, query_key.c_str(), slot.length) != 0) {
+    return false;
+  }
+  operation_code = slot.operation_code;
+  return true;
+}
+
+S3OperationCode S3RouteTable::get_operation_code(
+    const std::map<std::string, std::string, compare>& query_params) const {
+  S3OperationCode operation_code = S3OperationCode::none;
+  for (const auto& query_param : query_params) {
+    find_operation_code(query_param.first, operation_code);
+  }
+  return operation_code;
+}
+
+S3PathRoute S3RouteTable::route_path(const char* path) {
+  S3PathRoute route = {S3PathShape::root, "", 0, ""};
+  if (!*path || !strcmp(path, "/")) {
+    return route;
+  }
+  route.bucket = path + 1;
+  // Ignoring the first forward slash.
+  const char* slash = strchr(route.bucket, '/');
+  if (!slash) {
+    // No second slash, means only bucket name.
+    route.shape = S3PathShape::bucket;
+    route.bucket_length = strlen(route.bucket);
+  } else if (!slash[1]) {
+    // Second slash is the last char, means only bucket name.
+    route.shape = S3PathShape::bucket;
+    route.bucket_length = slash - route.bucket;
+  } else {
+    route.shape = S3PathShape::object;
+    route.bucket_length = slash - route.bucket;
+    route.object = slash + 1;
+  }
+  return route;
+}
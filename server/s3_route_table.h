@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#pragma once
+
+#ifndef __S3_SERVER_S3_ROUTE_TABLE_H__
+#define __S3_SERVER_S3_ROUTE_TABLE_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+
+#include "s3_common.h"
+
+// Shape of path style request URI.
+enum class S3PathShape {
+  root,    // "/"
+  bucket,  // "/bucket" or "/bucket/"
+  object   // "/bucket/object/key"
+};
+
+struct S3PathRoute {
+  S3PathShape shape;
+  // Bucket and object names point into the parsed path.
+  const char* bucket;
+  size_t bucket_length;
+  const char* object;
+};
+
+// Routing tables which are precompiled once, so that routing a request
+// costs a fixed number of operations independent of the number of S3 APIs.
+//
+// Sub-resource query parameters (S3OperationString) are found with a
+// perfect hash: a seed is chosen at startup so that no two sub-resources
+// share a slot, and lookup is one hash plus one name comparison.
+class S3RouteTable {
+  // Well above the number of sub-resources, so a seed is found quickly.
+  static const size_t table_size = 64;
+
+  struct Slot {
+    const char* name;
+    size_t length;
+    S3OperationCode operation_code;
+  };
+  Slot slots[table_size];
+  uint32_t seed = 0;
+
+  S3RouteTable();
+  size_t get_slot(const char* name, size_t length) const;
+
+ public:
+  static const S3RouteTable& get_instance();
+
+  // Returns false if 'query_key' (case insensitive) is not a sub-resource.
+  bool find_operation_code(const std::string& query_key,
+                           S3OperationCode& operation_code) const;
+
+  // Operation code of request with these query parameters.  If there are
+  // several sub-resources, the last one in order of the map wins.
+  S3OperationCode get_operation_code(
+      const std::map<std::string, std::string, compare>& query_params) const;
+
+  uint32_t get_seed() const { return seed; }
+
+  // Splits path style URI path, which starts with '/'.
+  static S3PathRoute route_path(const char* path);
+};
+
+#endif
@@ -19,7 +19,6 @@
  */
 
 #include <memory>
-#include <regex>
 #include <string>
 
 #include "s3_api_handler.h"
@@ -19,12 +19,11 @@
  */
 
 #include "s3_service_list_response.h"
-#include "s3_common_utilities.h"
+#include "s3_xml_writer.h"
 #include "s3_log.h"
 
-S3ServiceListResponse::S3ServiceListResponse() {
+S3ServiceListResponse::S3ServiceListResponse() : bucket_count(0) {
   s3_log(S3_LOG_DEBUG, "", "%s Ctor\n", __func__);
-  bucket_list.clear();
 }
 
 void S3ServiceListResponse::set_owner_name(std::string name) {
@@ -33,34 +32,32 @@ void S3ServiceListResponse::set_owner_name(std::string name) {
 
 void S3ServiceListResponse::set_owner_id(std::string id) { owner_id = id; }
 
-void S3ServiceListResponse::add_bucket(
-    std::shared_ptr<S3BucketMetadata> bucket) {
-  bucket_list.push_back(bucket);
+void S3ServiceListResponse::add_bucket(const std::string& name,
+                                       const std::string& creation_date) {
+  S3XmlWriter writer(buckets_xml);
+  writer.open("Bucket");
+  writer.element("Name", name);
+  writer.element("CreationDate", creation_date);
+  writer.close("Bucket");
+  ++bucket_count;
 }
 
-// clang-format off
 std::string& S3ServiceListResponse::get_xml() {
-  response_xml = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>";
-  response_xml +=
+  response_xml.clear();
+  response_xml.reserve(512 + buckets_xml.size());
+  S3XmlWriter writer(response_xml);
+  writer.raw("<?xml version=\"1.0\" encoding=\"UTF-8\"?>");
+  writer.raw(
       "<ListAllMyBucketsResult "
-      "xmlns=\"http://s3.amazonaws.com/doc/2006-03-01\">";
-  response_xml += "<Owner>";
-  response_xml += S3CommonUtilities::format_xml_string("ID", owner_id);
-  response_xml +=
-      S3CommonUtilities::format_xml_string("DisplayName", owner_name);
-  response_xml += "</Owner>";
-  response_xml += "<Buckets>";
-  for (auto&& bucket : bucket_list) {
-    response_xml += "<Bucket>";
-    response_xml +=
-        S3CommonUtilities::format_xml_string("Name", bucket->get_bucket_name());
-    response_xml += S3CommonUtilities::format_xml_string(
-        "CreationDate", bucket->get_creation_time());
-    response_xml += "</Bucket>";
-  }
-  response_xml += "</Buckets>";
-  response_xml += "</ListAllMyBucketsResult>";
+      "xmlns=\"http://s3.amazonaws.com/doc/2006-03-01\">");
+  writer.open("Owner");
+  writer.element("ID", owner_id);
+  writer.element("DisplayName", owner_name);
+  writer.close("Owner");
+  writer.open("Buckets");
+  response_xml += buckets_xml;
+  writer.close("Buckets");
+  writer.raw("</ListAllMyBucketsResult>");
 
   return response_xml;
 }
-// clang-format on
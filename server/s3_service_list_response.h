@@ -23,16 +23,16 @@
 #ifndef __S3_SERVER_S3_SERVICE_LIST_RESPONSE_H__
 #define __S3_SERVER_S3_SERVICE_LIST_RESPONSE_H__
 
-#include <memory>
 #include <string>
-#include <vector>
-
-#include "s3_bucket_metadata.h"
 
+// ListBuckets (GET service) response.  Buckets are rendered as they are
+// added, so no bucket metadata has to be kept until the response is sent.
 class S3ServiceListResponse {
   std::string owner_name;
   std::string owner_id;
-  std::vector<std::shared_ptr<S3BucketMetadata>> bucket_list;
+  // <Bucket> elements of the buckets added so far.
+  std::string buckets_xml;
+  size_t bucket_count;
 
   // Generated xml response
   std::string response_xml;
@@ -41,9 +41,9 @@ class S3ServiceListResponse {
   S3ServiceListResponse();
   void set_owner_name(std::string name);
   void set_owner_id(std::string id);
-  void add_bucket(std::shared_ptr<S3BucketMetadata> bucket);
+  void add_bucket(const std::string& name, const std::string& creation_date);
   std::string& get_xml();
-  int get_bucket_count() const { return bucket_list.size(); }
+  int get_bucket_count() const { return bucket_count; }
 };
 
 #endif
@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#include "s3_simd.h"
+
+static S3SimdLevel detect_level() {
+#ifdef S3_SIMD_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return S3SimdLevel::avx2;
+  }
+  if (__builtin_cpu_supports("sse4.2")) {
+    return S3SimdLevel::sse42;
+  }
+#endif
+  return S3SimdLevel::scalar;
+}
+
+S3SimdLevel s3_simd_detect_level() {
+  static const S3SimdLevel detected_level = detect_level();
+  return detected_level;
+}
+
+// Zero, i.e. scalar, during static initialization of other translation units
+// which may already use the helpers.
+static S3SimdLevel gs_level = s3_simd_detect_level();
+
+S3SimdLevel s3_simd_level() { return gs_level; }
+
+S3SimdLevel s3_simd_set_level(S3SimdLevel level) {
+  const S3SimdLevel detected_level = s3_simd_detect_level();
+  gs_level = level < detected_level ? level : detected_level;
+  return gs_level;
+}
@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#pragma once
+
+#ifndef __S3_SERVER_S3_SIMD_H__
+#define __S3_SERVER_S3_SIMD_H__
+
+// Vector kernels of the text helpers, i.e. url_encode(), S3XmlWriter::escape()
+// and base64 encoding and decoding, are compiled for x86-64 with per function
+// target attributes and chosen at run time, so the binary still runs on CPUs
+// without SSE4.2 or AVX2.  Each helper has a scalar fallback giving the same
+// output.
+#if defined(__x86_64__) && defined(__GNUC__)
+#define S3_SIMD_X86 1
+#define S3_TARGET_SSE42 __attribute__((target("sse4.2")))
+#define S3_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+enum class S3SimdLevel {
+  scalar,
+  sse42,
+  avx2
+};
+
+// Best level supported by the CPU.
+S3SimdLevel s3_simd_detect_level();
+// Level the kernels use, scalar until static initialization has detected it.
+S3SimdLevel s3_simd_level();
+// Lowers (or restores) the level the kernels use, for tests and benchmarks.
+// Returns the level which is set, at most the detected one.
+S3SimdLevel s3_simd_set_level(S3SimdLevel level);
+
+#endif
@@ -0,0 +1,271 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+#include <string.h>
+
+#include <algorithm>
+#include <iterator>
+
+#include "s3_sorted_kv_store.h"
+
+static size_t common_prefix_size(const std::string &a, const std::string &b) {
+  const size_t size = std::min(a.size(), b.size());
+  size_t i = 0;
+  while (i < size && a[i] == b[i]) {
+    ++i;
+  }
+  return i;
+}
+
+static uint32_t get_head(const char *suffix, size_t size) {
+  uint32_t head = 0;
+  for (size_t i = 0; i < 4; ++i) {
+    head = (head << 8) | (i < size ? (unsigned char)suffix[i] : 0);
+  }
+  return head;
+}
+
+std::string S3SortedKvStore::Leaf::get_key(size_t i) const {
+  std::string key;
+  key.reserve(prefix.size() + entries[i].suffix_size);
+  key.append(prefix);
+  key.append(data, entries[i].offset, entries[i].suffix_size);
+  return key;
+}
+
+std::string S3SortedKvStore::Leaf::get_value(size_t i) const {
+  return data.substr(entries[i].offset + entries[i].suffix_size,
+                     entries[i].value_size);
+}
+
+size_t S3SortedKvStore::Leaf::lower_bound(const std::string &key) const {
+  const int rc = key.compare(0, prefix.size(), prefix);
+  if (rc != 0) {
+    // All keys of the leaf are greater or less than 'key'.
+    return rc < 0 ? 0 : entries.size();
+  }
+  const char *rest = key.data() + prefix.size();
+  const size_t rest_size = key.size() - prefix.size();
+  const uint32_t head = get_head(rest, rest_size);
+  size_t low = 0, high = entries.size();
+  while (low < high) {
+    const size_t mid = low + (high - low) / 2;
+    const Entry &entry = entries[mid];
+    int cmp;
+    if (entry.head != head) {
+      cmp = entry.head < head ? -1 : 1;
+    } else {
+      cmp = memcmp(data.data() + entry.offset, rest,
+                   std::min<size_t>(entry.suffix_size, rest_size));
+      if (cmp == 0) {
+        cmp = entry.suffix_size < rest_size ? -1 : 0;
+      }
+    }
+    if (cmp < 0) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low;
+}
+
+bool S3SortedKvStore::Leaf::is_equal(size_t i, const std::string &key) const {
+  const Entry &entry = entries[i];
+  return key.size() == prefix.size() + entry.suffix_size &&
+         key.compare(0, prefix.size(), prefix) == 0 &&
+         memcmp(data.data() + entry.offset, key.data() + prefix.size(),
+                entry.suffix_size) == 0;
+}
+
+void S3SortedKvStore::Leaf::append(size_t i, const std::string &key,
+                                   const std::string &value) {
+  const Entry entry = {
+      get_head(key.data() + prefix.size(), key.size() - prefix.size()),
+      (uint32_t)data.size(), (uint32_t)(key.size() - prefix.size()),
+      (uint32_t)value.size()};
+  data.append(key, prefix.size(), std::string::npos);
+  data.append(value);
+  entries.insert(entries.begin() + i, entry);
+}
+
+void S3SortedKvStore::Leaf::set_value(size_t i, const std::string &value) {
+  Entry &entry = entries[i];
+  if (value.size() <= entry.value_size) {
+    data.replace(entry.offset + entry.suffix_size, value.size(), value);
+    garbage += entry.value_size - value.size();
+  } else {
+    const std::string suffix = data.substr(entry.offset, entry.suffix_size);
+    garbage += entry.suffix_size + entry.value_size;
+    entry.offset = data.size();
+    data.append(suffix);
+    data.append(value);
+  }
+  entry.value_size = value.size();
+}
+
+void S3SortedKvStore::Leaf::erase(size_t i) {
+  garbage += entries[i].suffix_size + entries[i].value_size;
+  entries.erase(entries.begin() + i);
+}
+
+void S3SortedKvStore::Leaf::compact(const std::string &new_prefix) {
+  std::string new_data;
+  new_data.reserve(data.size() - garbage);
+  for (Entry &entry : entries) {
+    const size_t offset = new_data.size();
+    if (new_prefix.size() <= prefix.size()) {
+      new_data.append(prefix, new_prefix.size(), std::string::npos);
+      new_data.append(data, entry.offset, entry.suffix_size);
+    } else {
+      const size_t skip = new_prefix.size() - prefix.size();
+      new_data.append(data, entry.offset + skip, entry.suffix_size - skip);
+    }
+    new_data.append(data, entry.offset + entry.suffix_size, entry.value_size);
+    entry.suffix_size = new_data.size() - offset - entry.value_size;
+    entry.offset = offset;
+    entry.head = get_head(new_data.data() + offset, entry.suffix_size);
+  }
+  new_data.shrink_to_fit();
+  data.swap(new_data);
+  prefix = new_prefix;
+  garbage = 0;
+}
+
+S3SortedKvStore::S3SortedKvStore(size_t max_leaf_entries_)
+    : max_leaf_entries(std::max<size_t>(max_leaf_entries_, 2)) {
+  leaves[""];
+}
+
+std::map<std::string, S3SortedKvStore::Leaf>::iterator
+S3SortedKvStore::find_leaf(const std::string &key) {
+  return std::prev(leaves.upper_bound(key));
+}
+
+std::map<std::string, S3SortedKvStore::Leaf>::const_iterator
+S3SortedKvStore::find_leaf(const std::string &key) const {
+  return std::prev(leaves.upper_bound(key));
+}
+
+void S3SortedKvStore::split(std::map<std::string, Leaf>::iterator it) {
+  Leaf &left = it->second;
+  const size_t mid = left.entries.size() / 2;
+  const std::string fence = left.get_key(mid);
+  Leaf &right = leaves.emplace_hint(std::next(it), fence, Leaf())->second;
+
+  right.prefix = left.prefix;
+  right.data = left.data;
+  right.entries.assign(left.entries.begin() + mid, left.entries.end());
+  right.compact(fence.substr(
+      0, common_prefix_size(fence, right.get_key(right.entries.size() - 1))));
+
+  left.entries.resize(mid);
+  left.entries.shrink_to_fit();
+  const std::string first = left.get_key(0);
+  const std::string last = left.get_key(mid - 1);
+  left.compact(first.substr(0, common_prefix_size(first, last)));
+}
+
+bool S3SortedKvStore::get(const std::string &key, std::string &value) const {
+  const Leaf &leaf = find_leaf(key)->second;
+  const size_t i = leaf.lower_bound(key);
+  if (i == leaf.entries.size() || !leaf.is_equal(i, key)) {
+    return false;
+  }
+  value = leaf.get_value(i);
+  return true;
+}
+
+bool S3SortedKvStore::put(const std::string &key, const std::string &value) {
+  auto it = find_leaf(key);
+  Leaf &leaf = it->second;
+  const size_t i = leaf.lower_bound(key);
+  if (i < leaf.entries.size() && leaf.is_equal(i, key)) {
+    leaf.set_value(i, value);
+    if (leaf.garbage > leaf.data.size() / 2) {
+      leaf.compact(leaf.prefix);
+    }
+    return false;
+  }
+  if (leaf.entries.empty()) {
+    // The whole key is the prefix until other keys are added.
+    leaf.prefix = key;
+    leaf.data.clear();
+    leaf.garbage = 0;
+  } else if (key.compare(0, leaf.prefix.size(), leaf.prefix) != 0) {
+    leaf.compact(key.substr(0, common_prefix_size(leaf.prefix, key)));
+  }
+  leaf.append(i, key, value);
+  ++count;
+  if (leaf.entries.size() > max_leaf_entries) {
+    split(it);
+  }
+  return true;
+}
+
+bool S3SortedKvStore::del(const std::string &key) {
+  auto it = find_leaf(key);
+  Leaf &leaf = it->second;
+  const size_t i = leaf.lower_bound(key);
+  if (i == leaf.entries.size() || !leaf.is_equal(i, key)) {
+    return false;
+  }
+  leaf.erase(i);
+  --count;
+  if (leaf.entries.empty() && !it->first.empty()) {
+    leaves.erase(it);
+  } else if (leaf.garbage > leaf.data.size() / 2) {
+    leaf.compact(leaf.prefix);
+  }
+  return true;
+}
+
+size_t S3SortedKvStore::next(
+    const std::string &start_key, bool exclude_start_key, size_t max_count,
+    std::vector<std::pair<std::string, std::string>> &result) const {
+  auto it = find_leaf(start_key);
+  size_t i = it->second.lower_bound(start_key);
+  if (exclude_start_key && i < it->second.entries.size() &&
+      it->second.is_equal(i, start_key)) {
+    ++i;
+  }
+  size_t appended = 0;
+  while (appended < max_count && it != leaves.end()) {
+    if (i == it->second.entries.size()) {
+      ++it;
+      i = 0;
+      continue;
+    }
+    result.emplace_back(it->second.get_key(i), it->second.get_value(i));
+    ++appended;
+    ++i;
+  }
+  return appended;
+}
+
+size_t S3SortedKvStore::get_memory_usage() const {
+  size_t usage = 0;
+  for (const auto &fence_leaf : leaves) {
+    const Leaf &leaf = fence_leaf.second;
+    usage += fence_leaf.first.size() + leaf.prefix.size() + leaf.data.size() +
+             leaf.entries.capacity() * sizeof(Leaf::Entry);
+  }
+  return usage;
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+#pragma once
+
+#ifndef __S3_SERVER_S3_SORTED_KV_STORE_H__
+#define __S3_SERVER_S3_SORTED_KV_STORE_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Ordered in-memory key-value store used by the fake KVS, compact enough to
+// hold indices of 100M keys on a workstation.
+//
+// Keys are kept in leaves of up to 'max_leaf_entries' entries, found by
+// their lower fence keys like in a B+tree.  Each leaf stores the common
+// prefix of its keys once, and key suffixes and values in one buffer.
+// Not thread safe.
+class S3SortedKvStore {
+  struct Leaf {
+    struct Entry {
+      // First bytes of the key suffix, big endian and zero padded, so most
+      // comparisons do not touch 'data'.
+      uint32_t head;
+      uint32_t offset;  // Of the key suffix in 'data', the value follows.
+      uint32_t suffix_size;
+      uint32_t value_size;
+    };
+    // Common prefix of all keys in the leaf.
+    std::string prefix;
+    // Key suffixes and values.  Overwritten and deleted ones remain as
+    // garbage until the leaf is compacted.
+    std::string data;
+    size_t garbage = 0;
+    // Sorted by key.
+    std::vector<Entry> entries;
+
+    std::string get_key(size_t i) const;
+    std::string get_value(size_t i) const;
+    // Index of the first entry which is not less than 'key'.
+    size_t lower_bound(const std::string &key) const;
+    bool is_equal(size_t i, const std::string &key) const;
+    void append(size_t i, const std::string &key, const std::string &value);
+    void set_value(size_t i, const std::string &value);
+    void erase(size_t i);
+    // Rewrites 'data' without garbage and with 'new_prefix', which must be
+    // a prefix of all keys.
+    void compact(const std::string &new_prefix);
+  };
+
+  // By lower fence key.  Leaf with "" fence always exists.
+  std::map<std::string, Leaf> leaves;
+  const size_t max_leaf_entries;
+  size_t count = 0;
+
+  std::map<std::string, Leaf>::iterator find_leaf(const std::string &key);
+  std::map<std::string, Leaf>::const_iterator find_leaf(
+      const std::string &key) const;
+  void split(std::map<std::string, Leaf>::iterator it);
+
+ public:
+  explicit S3SortedKvStore(size_t max_leaf_entries = 128);
+
+  // Returns false if there is no such key.
+  bool get(const std::string &key, std::string &value) const;
+  // Returns true if the key is new, false if its value is overwritten.
+  bool put(const std::string &key, const std::string &value);
+  // Returns false if there is no such key.
+  bool del(const std::string &key);
+
+  // Appends at most 'max_count' entries in key order to 'result', the
+  // first one is 'start_key' or the one after it, or after it only if
+  // 'exclude_start_key'.  Returns count of entries appended.
+  size_t next(const std::string &start_key, bool exclude_start_key,
+              size_t max_count,
+              std::vector<std::pair<std::string, std::string>> &result) const;
+
+  size_t size() const { return count; }
+  size_t get_leaf_count() const { return leaves.size(); }
+  // Bytes of keys, values and their entries, without allocator and map
+  // overhead.
+  size_t get_memory_usage() const;
+};
+
+#endif
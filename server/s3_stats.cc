@@ -51,11 +51,21 @@ void S3Stats::delete_instance() {
 
 int S3Stats::count(const std::string& key, int64_t value, int retry,
                    float sample_rate) {
+  if (aggregator) {
+    assert(is_keyname_valid(key));
+    aggregator->count(key, value, sample_rate);
+    return 0;
+  }
   return form_and_send_msg(key, "c", std::to_string(value), retry, sample_rate);
 }
 
 int S3Stats::timing(const std::string& key, size_t time_ms, int retry,
                     float sample_rate) {
+  if (aggregator) {
+    assert(is_keyname_valid(key));
+    aggregator->timing(key, time_ms, sample_rate);
+    return 0;
+  }
   return form_and_send_msg(key, "ms", std::to_string(time_ms), retry,
                            sample_rate);
 }
@@ -68,12 +78,21 @@ int S3Stats::set_gauge(const std::string& key, int value, int retry) {
            key.c_str(), value);
     errno = EINVAL;
     return -1;
+  } else if (aggregator) {
+    assert(is_keyname_valid(key));
+    aggregator->set_gauge(key, value);
+    return 0;
   } else {
     return form_and_send_msg(key, "g", std::to_string(value), retry, 1.0);
   }
 }
 
 int S3Stats::update_gauge(const std::string& key, int value, int retry) {
+  if (aggregator) {
+    assert(is_keyname_valid(key));
+    aggregator->update_gauge(key, value);
+    return 0;
+  }
   std::string value_str;
   if (value >= 0) {
     value_str = "+" + std::to_string(value);
@@ -83,6 +102,7 @@ int S3Stats::update_gauge(const std::string& key, int value, int retry) {
   return form_and_send_msg(key, "g", value_str, retry, 1.0);
 }
 
+// Sets are not aggregated, unique values would have to be kept until flush.
 int S3Stats::count_unique(const std::string& key, const std::string& value,
                           int retry) {
   return form_and_send_msg(key, "s", value, retry, 1.0);
@@ -164,12 +184,32 @@ int S3Stats::init() {
     errno = EINVAL;
     return -1;
   }
+  if (g_option_instance->is_statsd_aggregation_enabled()) {
+    aggregator.reset(new S3StatsAggregator(
+        metrics_allowlist, g_option_instance->get_statsd_max_packet_size()));
+  }
   s3_log(S3_LOG_DEBUG, "", "%s Exit", __func__);
   return 0;
 }
 
+int S3Stats::flush() {
+  if (!aggregator || sock == -1) {
+    return 0;
+  }
+  int rc = 0;
+  aggregator->flush([this, &rc](const std::string& packet) {
+    if (send(packet) != 0) {
+      rc = -1;
+    }
+  });
+  return rc;
+}
+
 void S3Stats::finish() {
   s3_log(S3_LOG_DEBUG, "", "%s Entry\n", __func__);
+  // Do not lose metrics accumulated since the last flush.
+  flush();
+  aggregator.reset();
   if (sock != -1) {
     socket_obj->close(sock);
     sock = -1;
@@ -263,6 +303,13 @@ void s3_stats_fini() {
   }
 }
 
+int s3_stats_flush() {
+  if (!g_option_instance->is_stats_enabled() || !g_stats_instance) {
+    return 0;
+  }
+  return g_stats_instance->flush();
+}
+
 int s3_stats_timing(const std::string& key, size_t value, int retry,
                     float sample_rate) {
 
@@ -31,6 +31,7 @@
 #include <unordered_set>
 #include "s3_log.h"
 #include "s3_option.h"
+#include "s3_stats_aggregator.h"
 #include "socket_wrapper.h"
 
 class S3Stats {
@@ -56,6 +57,10 @@ class S3Stats {
   int count_unique(const std::string& key, const std::string& value,
                    int retry = 1);
 
+  // Send metrics aggregated since the previous flush (no-op when aggregation
+  // is disabled). Returns -1 if any of the packets was not sent.
+  int flush();
+
  private:
   S3Stats(const std::string& host_addr, const unsigned short port_num,
           SocketInterface* socket_obj_ptr = NULL)
@@ -111,10 +116,15 @@ class S3Stats {
   // metrics allowlist
   std::unordered_set<std::string> metrics_allowlist;
 
+  // Set when S3_STATSD_AGGREGATION_ENABLE is true. Then counters, timings and
+  // gauges are accumulated here and sent by flush() in batches.
+  std::unique_ptr<S3StatsAggregator> aggregator;
+
   FRIEND_TEST(S3StatsTest, Init);
   FRIEND_TEST(S3StatsTest, Allowlist);
   FRIEND_TEST(S3StatsTest, S3StatsSendMustSucceedIfSocketSendToSucceeds);
   FRIEND_TEST(S3StatsTest, S3StatsSendMustRetryAndFailIfRetriesFail);
+  FRIEND_TEST(S3StatsTest, AggregatedMetricsAreSentOnFlush);
 };
 
 extern S3Option* g_option_instance;
@@ -123,6 +133,8 @@ extern S3Stats* g_stats_instance;
 // Utility Wrappers for StatsD
 int s3_stats_init();
 void s3_stats_fini();
+// Send aggregated metrics, called periodically from the event loop.
+int s3_stats_flush();
 
 static inline int s3_stats_inc(const std::string& key, int retry = 1,
                                float sample_rate = 1.0) {
@@ -0,0 +1,207 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+
+#include <algorithm>
+
+#include "s3_stats_aggregator.h"
+
+std::atomic<uint64_t> S3StatsAggregator::next_generation{1};
+thread_local S3StatsAggregator::CachedSlot S3StatsAggregator::cached_slot;
+
+// Number of events a sampled event stands for.
+static int64_t sample_weight(float sample_rate) {
+  if (sample_rate <= 0.0 || sample_rate >= 1.0) {
+    return 1;
+  }
+  return std::max((int64_t)1, (int64_t)llround(1.0 / sample_rate));
+}
+
+S3StatsAggregator::S3StatsAggregator(
+    const std::unordered_set<std::string>& keys, size_t max_packet_size_)
+    : max_packet_size(max_packet_size_),
+      generation(next_generation++),
+      gauges(new Gauge[keys.size()]) {
+  key_names.assign(keys.begin(), keys.end());
+  std::sort(key_names.begin(), key_names.end());
+  for (size_t i = 0; i < key_names.size(); ++i) {
+    key_index[key_names[i]] = i;
+  }
+}
+
+unsigned S3StatsAggregator::timing_bucket(size_t time_ms) {
+  if (time_ms == 0) {
+    return 0;
+  }
+  unsigned bucket = 64 - __builtin_clzll((unsigned long long)time_ms);
+  return std::min(bucket, (unsigned)S3_STATS_TIMING_BUCKETS - 1);
+}
+
+bool S3StatsAggregator::find_index(const std::string& key,
+                                   size_t* index) const {
+  auto it = key_index.find(key);
+  if (it == key_index.end()) {
+    return false;
+  }
+  *index = it->second;
+  return true;
+}
+
+S3StatsAggregator::ThreadSlot* S3StatsAggregator::get_thread_slot() {
+  if (cached_slot.generation == generation) {
+    return cached_slot.slot;
+  }
+  std::unique_ptr<ThreadSlot> slot(new ThreadSlot());
+  slot->entries.reset(new Entry[key_names.size()]);
+  ThreadSlot* slot_ptr = slot.get();
+  {
+    std::lock_guard<std::mutex> guard(slots_lock);
+    slots.push_back(std::move(slot));
+  }
+  cached_slot.generation = generation;
+  cached_slot.slot = slot_ptr;
+  return slot_ptr;
+}
+
+bool S3StatsAggregator::count(const std::string& key, int64_t value,
+                              float sample_rate) {
+  size_t index;
+  if (!find_index(key, &index)) {
+    return false;
+  }
+  Entry& entry = get_thread_slot()->entries[index];
+  entry.counter.fetch_add(value * sample_weight(sample_rate),
+                          std::memory_order_relaxed);
+  return true;
+}
+
+bool S3StatsAggregator::timing(const std::string& key, size_t time_ms,
+                               float sample_rate) {
+  size_t index;
+  if (!find_index(key, &index)) {
+    return false;
+  }
+  const uint64_t weight = sample_weight(sample_rate);
+  TimingBucket& bucket =
+      get_thread_slot()->entries[index].timing[timing_bucket(time_ms)];
+  bucket.sum.fetch_add(time_ms * weight, std::memory_order_relaxed);
+  bucket.count.fetch_add(weight, std::memory_order_relaxed);
+  return true;
+}
+
+bool S3StatsAggregator::set_gauge(const std::string& key, int value) {
+  size_t index;
+  if (!find_index(key, &index)) {
+    return false;
+  }
+  // Deltas recorded before the new value are overridden by it.
+  gauges[index].delta.store(0, std::memory_order_relaxed);
+  gauges[index].value.store(value, std::memory_order_relaxed);
+  gauges[index].is_set.store(true, std::memory_order_release);
+  return true;
+}
+
+bool S3StatsAggregator::update_gauge(const std::string& key, int value) {
+  size_t index;
+  if (!find_index(key, &index)) {
+    return false;
+  }
+  gauges[index].delta.fetch_add(value, std::memory_order_relaxed);
+  return true;
+}
+
+size_t S3StatsAggregator::flush(const SendCallback& send) {
+  size_t packets = 0;
+  std::string packet;
+  char line[512];
+
+  auto append = [&](int len) {
+    if (len <= 0) {
+      return;
+    }
+    len = std::min(len, (int)sizeof(line) - 1);
+    if (!packet.empty() && packet.size() + 1 + len > max_packet_size) {
+      send(packet);
+      packets++;
+      packet.clear();
+    }
+    if (!packet.empty()) {
+      packet += '\n';
+    }
+    packet.append(line, len);
+  };
+
+  std::lock_guard<std::mutex> guard(slots_lock);
+  for (size_t i = 0; i < key_names.size(); ++i) {
+    const char* key = key_names[i].c_str();
+
+    int64_t counter = 0;
+    uint64_t timing_count[S3_STATS_TIMING_BUCKETS] = {0};
+    uint64_t timing_sum[S3_STATS_TIMING_BUCKETS] = {0};
+    for (auto& slot : slots) {
+      Entry& entry = slot->entries[i];
+      counter += entry.counter.exchange(0, std::memory_order_relaxed);
+      for (unsigned b = 0; b < S3_STATS_TIMING_BUCKETS; ++b) {
+        if (entry.timing[b].count.load(std::memory_order_relaxed) == 0) {
+          continue;
+        }
+        timing_count[b] +=
+            entry.timing[b].count.exchange(0, std::memory_order_relaxed);
+        timing_sum[b] +=
+            entry.timing[b].sum.exchange(0, std::memory_order_relaxed);
+      }
+    }
+
+    // StatsD message format: <metricname>:<value>|<type>[|@<sampling rate>]
+    if (counter != 0) {
+      append(snprintf(line, sizeof(line), "%s:%" PRId64 "|c", key, counter));
+    }
+    Gauge& gauge = gauges[i];
+    if (gauge.is_set.exchange(false, std::memory_order_acquire)) {
+      append(snprintf(line, sizeof(line), "%s:%" PRId64 "|g", key,
+                      gauge.value.load(std::memory_order_relaxed)));
+    }
+    int64_t delta = gauge.delta.exchange(0, std::memory_order_relaxed);
+    if (delta != 0) {
+      append(snprintf(line, sizeof(line), "%s:%+" PRId64 "|g", key, delta));
+    }
+    for (unsigned b = 0; b < S3_STATS_TIMING_BUCKETS; ++b) {
+      if (timing_count[b] == 0) {
+        continue;
+      }
+      uint64_t mean = timing_sum[b] / timing_count[b];
+      if (timing_count[b] == 1) {
+        append(snprintf(line, sizeof(line), "%s:%" PRIu64 "|ms", key, mean));
+      } else {
+        // Plain decimal, StatsD does not parse exponent notation.
+        append(snprintf(line, sizeof(line), "%s:%" PRIu64 "|ms|@%.9f", key,
+                        mean, std::max(1.0 / timing_count[b], 1e-9)));
+      }
+    }
+  }
+  if (!packet.empty()) {
+    send(packet);
+    packets++;
+  }
+  return packets;
+}
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+#pragma once
+
+#ifndef __S3_SERVER_S3_STATS_AGGREGATOR_H__
+#define __S3_SERVER_S3_STATS_AGGREGATOR_H__
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Timing values are kept in power of two buckets (in ms):
+// [0], [1], [2, 3], [4, 7], ... and the last one for everything above.
+#define S3_STATS_TIMING_BUCKETS 24
+
+// In-process aggregation of StatsD metrics.
+//
+// Metric events are accumulated per allowlisted key instead of being sent
+// one UDP packet each. Counters and timings go to slots owned by the calling
+// thread, so recording is a hash lookup plus an uncontended atomic add, no
+// locks and no syscalls. Gauges are absolute values and are kept once per key.
+// flush() collects and resets everything accumulated since the previous flush
+// and sends it as multi-metric packets ("\n" separated lines).
+//
+// Timings are reported per non-empty histogram bucket as the mean value of the
+// bucket with the sampling rate 1/<number of samples>, so StatsD counts every
+// sample, while percentiles are of bucket resolution.
+class S3StatsAggregator {
+ public:
+  typedef std::function<void(const std::string&)> SendCallback;
+
+  S3StatsAggregator(const std::unordered_set<std::string>& keys,
+                    size_t max_packet_size);
+
+  // Following return false if 'key' is not known to the aggregator.
+  bool count(const std::string& key, int64_t value, float sample_rate = 1.0);
+  bool timing(const std::string& key, size_t time_ms, float sample_rate = 1.0);
+  bool set_gauge(const std::string& key, int value);
+  bool update_gauge(const std::string& key, int value);
+
+  // Sends metrics accumulated since previous flush, returns number of packets.
+  size_t flush(const SendCallback& send);
+
+  static unsigned timing_bucket(size_t time_ms);
+
+ private:
+  struct TimingBucket {
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> sum{0};
+  };
+  struct Entry {
+    std::atomic<int64_t> counter{0};
+    TimingBucket timing[S3_STATS_TIMING_BUCKETS];
+  };
+  // Entries of one thread, indexed same as 'key_names'.
+  struct ThreadSlot {
+    std::unique_ptr<Entry[]> entries;
+  };
+  struct Gauge {
+    std::atomic<int64_t> value{0};
+    std::atomic<bool> is_set{false};
+    std::atomic<int64_t> delta{0};
+  };
+  // Slot of the current thread, valid while 'generation' matches.
+  struct CachedSlot {
+    uint64_t generation = 0;
+    ThreadSlot* slot = nullptr;
+  };
+
+  std::unordered_map<std::string, size_t> key_index;
+  std::vector<std::string> key_names;
+  size_t max_packet_size;
+  // Unique per instance, tells thread cached slots of other instances apart.
+  uint64_t generation;
+  std::unique_ptr<Gauge[]> gauges;
+
+  // Protects 'slots' only, taken once per thread and on flush.
+  std::mutex slots_lock;
+  std::vector<std::unique_ptr<ThreadSlot>> slots;
+
+  static std::atomic<uint64_t> next_generation;
+  static thread_local CachedSlot cached_slot;
+
+  ThreadSlot* get_thread_slot();
+  // Returns false if key is unknown.
+  bool find_index(const std::string& key, size_t* index) const;
+};
+
+#endif
@@ -22,6 +22,7 @@
 
 #include "s3_log.h"
 #include "s3_option.h"
+#include "s3_route_table.h"
 #include "s3_uri.h"
 
 S3URI::S3URI(std::shared_ptr<S3RequestObject> req)
@@ -46,31 +47,20 @@ S3OperationCode S3URI::get_operation_code() { return operation_code; }
 void S3URI::setup_operation_code() {
   const std::map<std::string, std::string, compare>& query_params_map =
       request->get_query_parameters();
-  if (query_params_map.empty()) {
-    s3_log(S3_LOG_DEBUG, request_id, "Operation code %s\n",
-           operation_code_to_str(operation_code).c_str());
-    return;
+  if (!query_params_map.empty()) {
+    operation_code =
+        S3RouteTable::get_instance().get_operation_code(query_params_map);
   }
-
-  // iterate through the map and check for relative operational code
-  for (const auto& it : query_params_map) {
-    auto op_code_it = S3OperationString.find(it.first);
-    if (op_code_it != S3OperationString.end()) {
-      operation_code = op_code_it->second;
-    }
-  }
-
   s3_log(S3_LOG_DEBUG, request_id, "Operation code %s\n",
          operation_code_to_str(operation_code).c_str());
-  // Other operations - todo
 }
 
 S3PathStyleURI::S3PathStyleURI(std::shared_ptr<S3RequestObject> req)
     : S3URI(req) {
   s3_log(S3_LOG_DEBUG, request_id, "%s Ctor\n", __func__);
-  std::string full_uri(request->c_get_full_path());
-  // Regex is better, but lets live with raw parsing. regex = >gcc 4.9.0
-  if (full_uri.compare("/") == 0) {
+  const S3PathRoute route =
+      S3RouteTable::route_path(request->c_get_full_path());
+  if (route.shape == S3PathShape::root) {
     // FaultInjection request check
     std::string header_value =
         request->get_header_value("x-seagate-faultinjection");
@@ -84,22 +74,13 @@ S3PathStyleURI::S3PathStyleURI(std::shared_ptr<S3RequestObject> req)
     s3_log(S3_LOG_DEBUG, request_id, "x-seagate-mgmt-api is enabled.\n");
     s3_api_type = S3ApiType::management;
   } else {
-    // Find the second forward slash.
-    std::size_t pos =
-        full_uri.find("/", 1);  // ignoring the first forward slash
-    if (pos == std::string::npos) {
-      // no second slash, means only bucket name.
-      bucket_name = std::string(full_uri.c_str() + 1);
-      s3_api_type = S3ApiType::bucket;
-    } else if (pos == full_uri.length() - 1) {
-      // second slash and its last char, means only bucket name.
-      bucket_name = std::string(full_uri.c_str() + 1, full_uri.length() - 2);
+    bucket_name.assign(route.bucket, route.bucket_length);
+    if (route.shape == S3PathShape::bucket) {
       s3_api_type = S3ApiType::bucket;
     } else {
       // Its an object api.
       s3_api_type = S3ApiType::object;
-      bucket_name = std::string(full_uri.c_str() + 1, pos - 1);
-      object_name = std::string(full_uri.c_str() + pos + 1);
+      object_name = route.object;
     }
   }
   request->set_api_type(s3_api_type);
@@ -20,12 +20,19 @@
 
 #include <cstring>
 
+#include "s3_simd.h"
 #include "s3_url_encode.h"
 
+#ifdef S3_SIMD_X86
+#include <immintrin.h>
+#endif
+
+static const char hex_digits[] = "0123456789ABCDEF";
+
 void escape_char(char ch, std::string& destination) {
-  char buf[16];
-  snprintf(buf, sizeof(buf), "%%%.2X", (int)(unsigned char)ch);
-  destination.append(buf);
+  const unsigned char c = ch;
+  const char buf[3] = {'%', hex_digits[c >> 4], hex_digits[c & 0x0F]};
+  destination.append(buf, sizeof(buf));
 }
 
 bool char_needs_url_encoding(char c) {
@@ -58,17 +65,111 @@ bool char_needs_url_encoding(char c) {
   return false;
 }
 
+#ifdef S3_SIMD_X86
+// Characters which need no encoding by their nibbles, c is such if
+// by_low[c & 0x0F] & by_high[c >> 4] is not 0.  Built from
+// char_needs_url_encoding(), only rows 0x20..0x70 have a bit in by_high.
+struct S3UrlSafeTables {
+  alignas(16) unsigned char by_low[16];
+  alignas(16) unsigned char by_high[16];
+
+  S3UrlSafeTables() {
+    memset(by_low, 0, sizeof(by_low));
+    memset(by_high, 0, sizeof(by_high));
+    for (unsigned high = 2; high < 8; ++high) {
+      by_high[high] = 1 << (high - 2);
+      for (unsigned low = 0; low < 16; ++low) {
+        if (!char_needs_url_encoding((char)(high << 4 | low))) {
+          by_low[low] |= by_high[high];
+        }
+      }
+    }
+  }
+};
+
+static const S3UrlSafeTables& get_url_safe_tables() {
+  static const S3UrlSafeTables tables;
+  return tables;
+}
+
+// Skips blocks of characters which need no encoding, returns the first
+// character which needs it or the start of the tail shorter than a block.
+S3_TARGET_SSE42 static const char* skip_safe_sse42(const char* p,
+                                                   const char* end) {
+  const S3UrlSafeTables& tables = get_url_safe_tables();
+  const __m128i by_low = _mm_load_si128((const __m128i*)tables.by_low);
+  const __m128i by_high = _mm_load_si128((const __m128i*)tables.by_high);
+  const __m128i nibble = _mm_set1_epi8(0x0F);
+  for (; end - p >= 16; p += 16) {
+    const __m128i chars = _mm_loadu_si128((const __m128i*)p);
+    const __m128i low = _mm_and_si128(chars, nibble);
+    const __m128i high = _mm_and_si128(_mm_srli_epi16(chars, 4), nibble);
+    const __m128i safe = _mm_and_si128(_mm_shuffle_epi8(by_low, low),
+                                       _mm_shuffle_epi8(by_high, high));
+    const unsigned unsafe_mask =
+        _mm_movemask_epi8(_mm_cmpeq_epi8(safe, _mm_setzero_si128()));
+    if (unsafe_mask) {
+      return p + __builtin_ctz(unsafe_mask);
+    }
+  }
+  return p;
+}
+
+S3_TARGET_AVX2 static const char* skip_safe_avx2(const char* p,
+                                                 const char* end) {
+  const S3UrlSafeTables& tables = get_url_safe_tables();
+  const __m256i by_low = _mm256_broadcastsi128_si256(
+      _mm_load_si128((const __m128i*)tables.by_low));
+  const __m256i by_high = _mm256_broadcastsi128_si256(
+      _mm_load_si128((const __m128i*)tables.by_high));
+  const __m256i nibble = _mm256_set1_epi8(0x0F);
+  for (; end - p >= 32; p += 32) {
+    const __m256i chars = _mm256_loadu_si256((const __m256i*)p);
+    const __m256i low = _mm256_and_si256(chars, nibble);
+    const __m256i high = _mm256_and_si256(_mm256_srli_epi16(chars, 4), nibble);
+    const __m256i safe = _mm256_and_si256(_mm256_shuffle_epi8(by_low, low),
+                                          _mm256_shuffle_epi8(by_high, high));
+    const unsigned unsafe_mask = _mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(safe, _mm256_setzero_si256()));
+    if (unsafe_mask) {
+      return p + __builtin_ctz(unsafe_mask);
+    }
+  }
+  return p;
+}
+#endif
+
+// Returns the first character in [p, end) which needs encoding, or end.
+static const char* skip_safe(const char* p, const char* end) {
+#ifdef S3_SIMD_X86
+  const S3SimdLevel level = s3_simd_level();
+  if (level >= S3SimdLevel::avx2) {
+    p = skip_safe_avx2(p, end);
+  }
+  if (level >= S3SimdLevel::sse42) {
+    p = skip_safe_sse42(p, end);
+  }
+#endif
+  while (p < end && !char_needs_url_encoding(*p)) {
+    ++p;
+  }
+  return p;
+}
+
 std::string url_encode(const char* src) {
   if (src == NULL) {
     return "";
   }
   std::string encoded_string = "";
-  size_t len = strlen(src);
-  for (size_t i = 0; i < len; i++, src++) {
-    if (char_needs_url_encoding(*src)) {
-      escape_char(*src, encoded_string);
-    } else {
-      encoded_string.append(src, 1);
+  const char* const end = src + strlen(src);
+  encoded_string.reserve(end - src);
+  while (src < end) {
+    // Copy characters which need no encoding at once.
+    const char* run = src;
+    src = skip_safe(src, end);
+    encoded_string.append(run, src - run);
+    if (src < end) {
+      escape_char(*src++, encoded_string);
     }
   }
   return encoded_string;
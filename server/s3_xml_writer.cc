@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#include "s3_simd.h"
+#include "s3_xml_writer.h"
+
+#ifdef S3_SIMD_X86
+#include <immintrin.h>
+#endif
+
+void S3XmlWriter::open(const char* tag) {
+  xml += '<';
+  xml += tag;
+  xml += '>';
+}
+
+void S3XmlWriter::close(const char* tag) {
+  xml += "</";
+  xml += tag;
+  xml += '>';
+}
+
+void S3XmlWriter::element(const char* tag, const std::string& value,
+                          bool append_quotes) {
+  if (value.empty() || value[0] == '\0') {
+    xml += '<';
+    xml += tag;
+    xml += "/>";
+    return;
+  }
+  open(tag);
+  if (append_quotes) {
+    xml += '"';
+  }
+  escape(value, xml);
+  if (append_quotes) {
+    xml += '"';
+  }
+  close(tag);
+}
+
+#ifdef S3_SIMD_X86
+// Skips blocks of characters which need no escaping, returns the first
+// character which needs it (or NUL) or the start of the tail shorter than a
+// block.
+S3_TARGET_SSE42 static const char* skip_plain_sse42(const char* p,
+                                                    const char* end) {
+  const __m128i lt = _mm_set1_epi8('<');
+  const __m128i gt = _mm_set1_epi8('>');
+  const __m128i amp = _mm_set1_epi8('&');
+  const __m128i quot = _mm_set1_epi8('"');
+  const __m128i cr = _mm_set1_epi8('\r');
+  for (; end - p >= 16; p += 16) {
+    const __m128i chars = _mm_loadu_si128((const __m128i*)p);
+    __m128i special = _mm_cmpeq_epi8(chars, _mm_setzero_si128());
+    special = _mm_or_si128(special, _mm_cmpeq_epi8(chars, lt));
+    special = _mm_or_si128(special, _mm_cmpeq_epi8(chars, gt));
+    special = _mm_or_si128(special, _mm_cmpeq_epi8(chars, amp));
+    special = _mm_or_si128(special, _mm_cmpeq_epi8(chars, quot));
+    special = _mm_or_si128(special, _mm_cmpeq_epi8(chars, cr));
+    const unsigned special_mask = _mm_movemask_epi8(special);
+    if (special_mask) {
+      return p + __builtin_ctz(special_mask);
+    }
+  }
+  return p;
+}
+
+S3_TARGET_AVX2 static const char* skip_plain_avx2(const char* p,
+                                                  const char* end) {
+  const __m256i lt = _mm256_set1_epi8('<');
+  const __m256i gt = _mm256_set1_epi8('>');
+  const __m256i amp = _mm256_set1_epi8('&');
+  const __m256i quot = _mm256_set1_epi8('"');
+  const __m256i cr = _mm256_set1_epi8('\r');
+  for (; end - p >= 32; p += 32) {
+    const __m256i chars = _mm256_loadu_si256((const __m256i*)p);
+    __m256i special = _mm256_cmpeq_epi8(chars, _mm256_setzero_si256());
+    special = _mm256_or_si256(special, _mm256_cmpeq_epi8(chars, lt));
+    special = _mm256_or_si256(special, _mm256_cmpeq_epi8(chars, gt));
+    special = _mm256_or_si256(special, _mm256_cmpeq_epi8(chars, amp));
+    special = _mm256_or_si256(special, _mm256_cmpeq_epi8(chars, quot));
+    special = _mm256_or_si256(special, _mm256_cmpeq_epi8(chars, cr));
+    const unsigned special_mask = _mm256_movemask_epi8(special);
+    if (special_mask) {
+      return p + __builtin_ctz(special_mask);
+    }
+  }
+  return p;
+}
+#endif
+
+static bool is_plain(char c) {
+  switch (c) {
+    case '<':
+    case '>':
+    case '&':
+    case '"':
+    case '\r':
+    case '\0':
+      return false;
+  }
+  return true;
+}
+
+// Returns the first character in [p, end) which needs escaping or is NUL,
+// or end.
+static const char* skip_plain(const char* p, const char* end) {
+#ifdef S3_SIMD_X86
+  const S3SimdLevel level = s3_simd_level();
+  if (level >= S3SimdLevel::avx2) {
+    p = skip_plain_avx2(p, end);
+  }
+  if (level >= S3SimdLevel::sse42) {
+    p = skip_plain_sse42(p, end);
+  }
+#endif
+  while (p < end && is_plain(*p)) {
+    ++p;
+  }
+  return p;
+}
+
+void S3XmlWriter::escape(const std::string& value, std::string& out) {
+  const char* run = value.c_str();
+  const char* const end = run + value.length();
+  for (const char* p = run;; ++p) {
+    // Copy characters which need no escaping at once.
+    p = skip_plain(p, end);
+    const char* entity;
+    // Value ends at the first NUL, *end is NUL too.
+    switch (*p) {
+      case '<':
+        entity = "&lt;";
+        break;
+      case '>':
+        entity = "&gt;";
+        break;
+      case '&':
+        entity = "&amp;";
+        break;
+      case '"':
+        entity = "&quot;";
+        break;
+      case '\r':
+        entity = "&#13;";
+        break;
+      default:
+        out.append(run, p - run);
+        return;
+    }
+    out.append(run, p - run);
+    out += entity;
+    run = p + 1;
+  }
+}
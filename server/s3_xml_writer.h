@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#pragma once
+
+#ifndef __S3_SERVER_S3_XML_WRITER_H__
+#define __S3_SERVER_S3_XML_WRITER_H__
+
+#include <string>
+
+// Appends XML elements to a string, escaping values in a single pass without
+// temporary strings.  Output is the same as of
+// S3CommonUtilities::format_xml_string(), i.e. libxml xmlEncodeSpecialChars()
+// escaping, and an element with empty value is written as <Tag/>.  Runs of
+// characters which need no escaping are found with SSE4.2 or AVX2 when the
+// CPU has them, see s3_simd.h.
+//
+// Usage:
+//   S3XmlWriter writer(response_xml);
+//   writer.open("Contents");
+//   writer.element("Key", key);
+//   writer.element("ETag", md5, true);
+//   writer.close("Contents");
+class S3XmlWriter {
+  std::string& xml;
+
+ public:
+  explicit S3XmlWriter(std::string& out) : xml(out) {}
+
+  // Appends markup as is.
+  void raw(const char* markup) { xml += markup; }
+  void open(const char* tag);
+  void close(const char* tag);
+  // <tag>value</tag>, value is escaped and optionally put in quotes.
+  void element(const char* tag, const std::string& value,
+               bool append_quotes = false);
+
+  // Appends escaped 'value' to 'out', value ends at the first NUL.
+  static void escape(const std::string& value, std::string& out);
+};
+
+#endif
@@ -32,6 +32,8 @@
 #include "evhtp_wrapper.h"
 #include "fid/fid.h"
 #include "murmur3_hash.h"
+#include "s3_bucket_list_cache.h"
+#include "s3_completion_queue.h"
 #include "s3_bucket_metadata_cache.h"
 #include "s3_motr_layout.h"
 #include "s3_common_utilities.h"
@@ -51,8 +53,16 @@
 #include "s3_audit_info_logger.h"
 #include "s3_fake_motr_redis_kvs.h"
 #include "s3_motr_wrapper.h"
+#include "s3_motr_emulator.h"
 #include "s3_m0_uint128_helper.h"
 #include "s3_perf_metrics.h"
+#include "s3_garbage_collector.h"
+#include "s3_admission_controller.h"
+#include "s3_metrics.h"
+#include "s3_request_registry.h"
+#include "s3_request_trace.h"
+#include "s3_motr_kvs_group_commit.h"
+#include "s3_bucket_usage.h"
 #include "s3_iem.h"
 
 #define FOUR_KB 4096
@@ -69,6 +79,7 @@
 #define BUCKET_METADATA_LIST_INDEX_OID_U_LO 2
 #define OBJECT_PROBABLE_DEAD_OID_LIST_INDEX_OID_U_LO 3
 #define GLOBAL_INSTANCE_INDEX_U_LO 4
+#define BUCKET_USAGE_INDEX_OID_U_LO 5
 
 S3Option *g_option_instance = NULL;
 evhtp_ssl_ctx_t *g_ssl_auth_ctx = NULL;
@@ -82,6 +93,8 @@ struct m0_uint128 bucket_metadata_list_index_oid;
 struct m0_uint128 global_instance_list_index;
 // objects listed in this index are probable delete candidates and not absolute.
 struct m0_uint128 global_probable_dead_object_list_index_oid;
+// index will have object count and bytes used of buckets, per s3server.
+struct m0_uint128 bucket_usage_index_oid;
 
 int global_shutdown_in_progress;
 pthread_t global_tid_indexop;
@@ -176,6 +189,88 @@ static evhtp_res on_client_request_fini(evhtp_request_t *p_evhtp_req,
   return EVHTP_RES_OK;
 }
 
+static void dispatch_admitted_s3_api_request(
+    Router *router, std::shared_ptr<S3RequestObject> s3_request) {
+  router->dispatch(s3_request);
+
+  auto buffered_input = s3_request->get_buffered_input();
+
+  if (buffered_input && !buffered_input->is_freezed()) {
+    s3_request->set_start_client_request_read_timeout();
+  }
+}
+
+// Expected libevent mempool usage of the request, buffers of the request and
+// response plus the read-ahead window of object data transfer.
+static size_t s3_api_request_data_footprint(
+    std::shared_ptr<S3RequestObject> s3_request) {
+  if (s3_request->get_api_type() != S3ApiType::object) {
+    return 0;
+  }
+  if (s3_request->http_verb() == S3HttpVerb::PUT) {
+    size_t data_length = s3_request->get_data_length();
+    int layout_id =
+        S3MotrLayoutMap::get_instance()->get_layout_for_object_size(
+            data_length);
+    return std::min(data_length,
+                    S3MemoryProfile().memory_per_put_request(layout_id));
+  }
+  if (s3_request->http_verb() == S3HttpVerb::GET) {
+    // Object size is not known yet, assume full read-ahead window.
+    int layout_id =
+        S3MotrLayoutMap::get_instance()->get_best_layout_for_object_size();
+    return (size_t)g_option_instance->get_motr_read_payload_size(layout_id) *
+           g_option_instance->get_read_ahead_multiple();
+  }
+  return 0;
+}
+
+static void admit_s3_api_request(
+    std::shared_ptr<S3AdmissionController> admission, Router *router,
+    std::shared_ptr<S3RequestObject> s3_request) {
+  const size_t data_footprint = s3_api_request_data_footprint(s3_request);
+  const size_t footprint =
+      data_footprint + 2 * g_option_instance->get_libevent_pool_buffer_size();
+  S3AdmissionPriority priority = s3_admission_priority(
+      data_footprint, g_option_instance->get_admission_small_request_size());
+
+  uint64_t waiter_id = 0;
+  S3AdmissionResult result = admission->submit(
+      footprint, priority,
+      [router, s3_request](std::unique_ptr<S3AdmissionTicket> ticket) {
+        s3_request->set_admission_ticket(std::move(ticket));
+        if (!s3_request->client_connected()) {
+          return;
+        }
+        // Read timer is set after dispatch, if request has payload.
+        s3_request->resume(false);
+        dispatch_admitted_s3_api_request(router, s3_request);
+      },
+      [s3_request]() {
+        s3_log(S3_LOG_INFO, s3_request->get_stripped_request_id().c_str(),
+               "Limited memory: Admission deadline expired, rejecting request "
+               "with retry.\n");
+        s3_request->respond_retry_after(1);
+      },
+      &waiter_id);
+
+  if (result == S3AdmissionResult::queued) {
+    s3_log(S3_LOG_DEBUG, s3_request->get_request_id().c_str(),
+           "Limited memory: Request is waiting for admission, footprint = "
+           "%zu\n",
+           footprint);
+    // Stop reading the payload until admitted, leave the queue if the client
+    // disconnects meanwhile.
+    s3_request->pause();
+    s3_request->set_admission_waiter(admission, waiter_id);
+  } else if (result == S3AdmissionResult::rejected) {
+    s3_log(S3_LOG_INFO, s3_request->get_stripped_request_id().c_str(),
+           "Limited memory: Admission queue is full, rejecting request with "
+           "retry.\n");
+    s3_request->respond_retry_after(1);
+  }
+}
+
 extern "C" evhtp_res dispatch_s3_api_request(evhtp_request_t *req,
                                              evhtp_headers_t *hdrs, void *arg) {
   s3_log(S3_LOG_INFO, "", "Req uri [%s]\n", req->uri->path->full);
@@ -270,9 +365,12 @@ extern "C" evhtp_res dispatch_s3_api_request(evhtp_request_t *req,
            poolinfo.total_bufs_allocated_by_pool);
   }
 
+  std::shared_ptr<S3AdmissionController> admission = s3_admission_controller();
+  const bool is_put_object = s3_request->get_api_type() == S3ApiType::object &&
+                             s3_request->http_verb() == S3HttpVerb::PUT;
+
   // Check if we have enough approx memory to proceed with request
-  if (s3_request->get_api_type() == S3ApiType::object &&
-      s3_request->http_verb() == S3HttpVerb::PUT) {
+  if (is_put_object && !admission) {
     int layout_id = S3MotrLayoutMap::get_instance()->get_layout_for_object_size(
         s3_request->get_data_length());
     if (!S3MemoryProfile().we_have_enough_memory_for_put_obj(layout_id) ||
@@ -281,11 +379,12 @@ extern "C" evhtp_res dispatch_s3_api_request(evhtp_request_t *req,
              "Limited memory: Rejecting PUT object/part request with retry.\n");
       s3_request->respond_retry_after(1);
       return EVHTP_RES_OK;
-    } else if (req->buffer_out) {
-      // Reserve memory for an error response
-      evbuffer_expand(req->buffer_out, 4096);
     }
   }
+  if (is_put_object && req->buffer_out) {
+    // Reserve memory for an error response
+    evbuffer_expand(req->buffer_out, 4096);
+  }
   req->cbarg = static_cast<RequestObject *>(s3_request.get());
 
   evhtp_set_hook(&req->hooks, evhtp_hook_on_error,
@@ -293,12 +392,10 @@ extern "C" evhtp_res dispatch_s3_api_request(evhtp_request_t *req,
   evhtp_set_hook(&req->hooks, evhtp_hook_on_request_fini,
                  (evhtp_hook)on_client_request_fini, NULL);
 
-  router->dispatch(s3_request);
-
-  auto buffered_input = s3_request->get_buffered_input();
-
-  if (buffered_input && !buffered_input->is_freezed()) {
-    s3_request->set_start_client_request_read_timeout();
+  if (admission) {
+    admit_s3_api_request(admission, router, s3_request);
+  } else {
+    dispatch_admitted_s3_api_request(router, s3_request);
   }
 
   return EVHTP_RES_OK;
@@ -543,6 +640,11 @@ int create_global_index(struct m0_uint128 &root_index_oid,
   const auto m0_timeout = m0_time_from_now(motr_op_wait_period, 0);
   init_s3_index_oid(root_index_oid, u_lo_index_offset);
 
+  if (S3MotrEmulator *emulator = s3_motr_emulator()) {
+    rc = emulator->create_index(root_index_oid);
+    return -EEXIST == rc ? 0 : rc;
+  }
+
   struct m0_idx idx;
   memset(&idx, 0, sizeof idx);
 
@@ -715,7 +817,6 @@ int main(int argc, char **argv) {
     exit(1);
   }
 
-  S3ErrorMessages::init_messages();
   g_option_instance = S3Option::get_instance();
 
   std::unique_ptr<S3PerfLogger> s3_perf_logger;
@@ -734,6 +835,11 @@ int main(int argc, char **argv) {
   S3Daemonize s3daemon;
   set_fatal_handler_exit();
   s3daemon.daemonize();
+  rc = init_async_log();
+  if (rc != 0) {
+    s3_log(S3_LOG_FATAL, "", "Could not start asynchronous logging: %s\n",
+           strerror(-rc));
+  }
 #if 0
   s3daemon.register_signals();
 #endif
@@ -758,10 +864,18 @@ int main(int argc, char **argv) {
     s3_log(S3_LOG_FATAL, "", "Stats Init failed!!\n");
   }
 
-  int libevent_mempool_flags = CREATE_ALIGNED_MEMORY;
+  // libevent buffers are allocated/released from both the event loop and
+  // motr threads, use per-thread caches to keep the pool lock off hot path.
+  int libevent_mempool_flags = CREATE_ALIGNED_MEMORY | ENABLE_THREAD_CACHE;
   if (g_option_instance->get_libevent_mempool_zeroed_buffer()) {
     libevent_mempool_flags = libevent_mempool_flags | ZEROED_BUFFER;
   }
+  if (g_option_instance->get_libevent_mempool_hugepage_arena()) {
+    libevent_mempool_flags = libevent_mempool_flags | ENABLE_HUGEPAGE_ARENA;
+  }
+  if (g_option_instance->get_libevent_mempool_numa_local()) {
+    libevent_mempool_flags = libevent_mempool_flags | ENABLE_NUMA_LOCAL;
+  }
 
   // Call this function at starting as we need to make use of our own
   // memory allocation/deallocation functions
@@ -797,11 +911,25 @@ int main(int argc, char **argv) {
     return 1;
   }
 
+  // Before Motr is initialised, Motr threads post completions to it.
+  rc = s3_completion_queue_init(global_evbase_handle);
+  if (rc != 0) {
+    s3daemon.delete_pidfile();
+    s3_log(S3_LOG_ERROR, "", "Couldn't init Motr completion queue: %s\n",
+           strerror(-rc));
+    finalize_cli_options();
+    return 1;
+  }
+
   if (S3AuditInfoLogger::init() != 0) {
     s3daemon.delete_pidfile();
     finalize_cli_options();
     s3_log(S3_LOG_FATAL, "", "Couldn't init audit logger!");
   }
+  if (g_option_instance->is_request_trace_enabled()) {
+    // Slow request traces are saved off the event loop.
+    S3RequestTrace::start_writer();
+  }
 
   event_set_fatal_callback(fatal_libevent);
   if (g_option_instance->is_s3_ssl_auth_enabled()) {
@@ -893,10 +1021,20 @@ int main(int argc, char **argv) {
     s3_log(S3_LOG_FATAL, "", "Failed to create pthread\n");
   }
 
-  int motr_read_mempool_flags = CREATE_ALIGNED_MEMORY;
+  // Thread caches are bounded in bytes, so the pools of large units (e.g. 1MB)
+  // do not use them.
+  int motr_read_mempool_flags = CREATE_ALIGNED_MEMORY | ENABLE_THREAD_CACHE;
   if (g_option_instance->get_motr_read_mempool_zeroed_buffer()) {
     motr_read_mempool_flags = motr_read_mempool_flags | ZEROED_BUFFER;
   }
+  // Arena backed pool can not be downsized, so S3MempoolManager can not move
+  // free memory between unit sizes for it.
+  if (g_option_instance->get_motr_read_mempool_hugepage_arena()) {
+    motr_read_mempool_flags = motr_read_mempool_flags | ENABLE_HUGEPAGE_ARENA;
+  }
+  if (g_option_instance->get_motr_read_mempool_numa_local()) {
+    motr_read_mempool_flags = motr_read_mempool_flags | ENABLE_NUMA_LOCAL;
+  }
 
   // Create memory pool for motr read operations.
   rc = S3MempoolManager::create_pool(
@@ -999,6 +1137,20 @@ int main(int argc, char **argv) {
     s3_log(S3_LOG_FATAL, "", "Failed to create global instance index\n");
   }
 
+  // bucket_usage_index_oid - will hold <object list index oid>/<process fid>
+  // as key, usage counters written by that s3server as value.
+  if (g_option_instance->is_bucket_usage_enabled()) {
+    rc = create_global_index(bucket_usage_index_oid,
+                             BUCKET_USAGE_INDEX_OID_U_LO);
+    if (rc < 0) {
+      s3daemon.delete_pidfile();
+      fini_auth_ssl();
+      fini_motr();
+      finalize_cli_options();
+      s3_log(S3_LOG_FATAL, "", "Failed to create bucket usage index\n");
+    }
+  }
+
   extern struct m0_config motr_conf;
 
   std::string s3server_fid = motr_conf.mc_process_fid;
@@ -1114,6 +1266,71 @@ int main(int argc, char **argv) {
            strerror(-rc));
   }
 
+  rc = s3_gc_init(global_evbase_handle);
+  if (rc != 0) {
+    s3daemon.delete_pidfile();
+    fini_auth_ssl();
+    evhtp_free(htp_motr);
+    fini_motr();
+    finalize_cli_options();
+    s3_log(S3_LOG_FATAL, "", "Could not init garbage collector: %s\n",
+           strerror(-rc));
+  }
+
+  rc = s3_admission_init(global_evbase_handle);
+  if (rc != 0) {
+    s3daemon.delete_pidfile();
+    fini_auth_ssl();
+    evhtp_free(htp_motr);
+    fini_motr();
+    finalize_cli_options();
+    s3_log(S3_LOG_FATAL, "", "Could not init admission control: %s\n",
+           strerror(-rc));
+  }
+
+  rc = s3_metrics_init(global_evbase_handle);
+  if (rc != 0) {
+    s3daemon.delete_pidfile();
+    fini_auth_ssl();
+    evhtp_free(htp_motr);
+    fini_motr();
+    finalize_cli_options();
+    s3_log(S3_LOG_FATAL, "", "Could not init metrics: %s\n", strerror(-rc));
+  }
+
+  rc = s3_request_registry_init(global_evbase_handle);
+  if (rc != 0) {
+    s3daemon.delete_pidfile();
+    fini_auth_ssl();
+    evhtp_free(htp_motr);
+    fini_motr();
+    finalize_cli_options();
+    s3_log(S3_LOG_FATAL, "", "Could not init request registry: %s\n",
+           strerror(-rc));
+  }
+
+  rc = s3_motr_kvs_group_commit_init(global_evbase_handle);
+  if (rc != 0) {
+    s3daemon.delete_pidfile();
+    fini_auth_ssl();
+    evhtp_free(htp_motr);
+    fini_motr();
+    finalize_cli_options();
+    s3_log(S3_LOG_FATAL, "", "Could not init KVS group commit: %s\n",
+           strerror(-rc));
+  }
+
+  rc = s3_bucket_usage_init(global_evbase_handle, s3server_fid);
+  if (rc != 0) {
+    s3daemon.delete_pidfile();
+    fini_auth_ssl();
+    evhtp_free(htp_motr);
+    fini_motr();
+    finalize_cli_options();
+    s3_log(S3_LOG_FATAL, "", "Could not init bucket usage: %s\n",
+           strerror(-rc));
+  }
+
   signal_sigint_event = evsignal_new(global_evbase_handle, SIGINT, s3_signal_cb,
                                      (void *)global_evbase_handle);
   if (!signal_sigint_event || event_add(signal_sigint_event, NULL) < 0) {
@@ -1141,6 +1358,12 @@ int main(int argc, char **argv) {
           g_option_instance->get_bucket_metadata_cache_max_size(),
           g_option_instance->get_bucket_metadata_cache_expire_sec(),
           g_option_instance->get_bucket_metadata_cache_refresh_sec()));
+  std::unique_ptr<S3BucketListCache> sptr_bucket_list_cache;
+  if (g_option_instance->get_bucket_list_cache_max_accounts()) {
+    sptr_bucket_list_cache.reset(new S3BucketListCache(
+        g_option_instance->get_bucket_list_cache_max_accounts(),
+        g_option_instance->get_bucket_list_cache_expire_sec()));
+  }
 
   // new flag in Libevent 2.1
   // EVLOOP_NO_EXIT_ON_EMPTY tells event_base_loop()
@@ -1155,8 +1378,15 @@ int main(int argc, char **argv) {
            "backend\n");
   }
 
+  // Garbage collector drains its motr operations, so it goes before teardown.
+  s3_gc_fini();
   shutdown_motr_teardown_called = 1;
   global_motr_teardown();
+  s3_bucket_usage_fini();
+  s3_admission_fini();
+  s3_motr_kvs_group_commit_fini();
+  s3_request_registry_fini();
+  s3_metrics_fini();
   s3_perf_metrics_fini();
   pthread_join(global_tid_indexop, NULL);
   pthread_join(global_tid_objop, NULL);
@@ -1169,13 +1399,14 @@ int main(int argc, char **argv) {
 
   /* Clean-up */
   fini_motr();
+  s3_completion_queue_fini();
 
   delete s3_router;
   delete motr_router;
-  S3ErrorMessages::finalize();
   s3_log(S3_LOG_DEBUG, "", "S3server exiting...\n");
   s3daemon.delete_pidfile();
   s3_stats_fini();
+  S3RequestTrace::stop_writer();
   S3AuditInfoLogger::finalize();
   finalize_cli_options();
   S3MempoolManager::destroy_instance();
@@ -0,0 +1,219 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "mock_event_wrapper.h"
+#include "s3_admission_controller.h"
+
+class S3AdmissionControllerTest : public testing::Test {
+ protected:
+  S3AdmissionControllerTest() : free_space(1024 * 1024) {}
+
+  void create(size_t budget, size_t reserve, size_t max_queue_len,
+              unsigned max_wait_ms) {
+    controller = std::make_shared<S3AdmissionController>(
+        std::make_shared<MockEventWrapper>(), nullptr, budget, reserve,
+        max_queue_len, max_wait_ms, [this]() { return free_space; });
+  }
+
+  // Submits request named 'name', records admission/shedding in 'events'.
+  S3AdmissionResult submit(const std::string &name, size_t footprint,
+                           S3AdmissionPriority priority) {
+    return controller->submit(
+        footprint, priority,
+        [this, name](std::unique_ptr<S3AdmissionTicket> ticket) {
+          events.push_back("admit " + name);
+          tickets.push_back(std::move(ticket));
+        },
+        [this, name]() { events.push_back("shed " + name); });
+  }
+
+  size_t free_space;
+  std::shared_ptr<S3AdmissionController> controller;
+  std::vector<std::string> events;
+  std::vector<std::unique_ptr<S3AdmissionTicket>> tickets;
+};
+
+TEST_F(S3AdmissionControllerTest, AdmitsWithinBudget) {
+  create(100, 0, 10, 1000);
+
+  EXPECT_EQ(S3AdmissionResult::admitted,
+            submit("a", 60, S3AdmissionPriority::large));
+  EXPECT_EQ(S3AdmissionResult::queued,
+            submit("b", 60, S3AdmissionPriority::large));
+  EXPECT_EQ(60, controller->get_inflight_footprint());
+  EXPECT_EQ(1, controller->get_queue_length());
+
+  // Request 'a' is done.
+  tickets.clear();
+  EXPECT_EQ(0, controller->get_inflight_footprint());
+  controller->drain();
+
+  ASSERT_EQ(2, events.size());
+  EXPECT_EQ("admit a", events[0]);
+  EXPECT_EQ("admit b", events[1]);
+  EXPECT_EQ(60, controller->get_inflight_footprint());
+  EXPECT_EQ(0, controller->get_queue_length());
+}
+
+TEST_F(S3AdmissionControllerTest, AdmitsOversizedRequestWhenIdle) {
+  create(100, 0, 10, 1000);
+
+  EXPECT_EQ(S3AdmissionResult::admitted,
+            submit("big", 500, S3AdmissionPriority::large));
+  EXPECT_EQ(1, controller->get_inflight_requests());
+}
+
+TEST_F(S3AdmissionControllerTest, WaitsForFreeSpaceAboveReserve) {
+  create(1000, 100, 10, 1000);
+  free_space = 120;
+
+  // Nothing is in flight, but the pool is below reserve + footprint.
+  EXPECT_EQ(S3AdmissionResult::queued,
+            submit("a", 50, S3AdmissionPriority::small));
+  controller->drain();
+  EXPECT_TRUE(events.empty());
+
+  free_space = 200;
+  controller->drain();
+  ASSERT_EQ(1, events.size());
+  EXPECT_EQ("admit a", events[0]);
+}
+
+TEST_F(S3AdmissionControllerTest, ServesMetadataAndSmallRequestsFirst) {
+  create(100, 0, 10, 1000);
+
+  EXPECT_EQ(S3AdmissionResult::admitted,
+            submit("first", 100, S3AdmissionPriority::large));
+  EXPECT_EQ(S3AdmissionResult::queued,
+            submit("large", 50, S3AdmissionPriority::large));
+  EXPECT_EQ(S3AdmissionResult::queued,
+            submit("small", 30, S3AdmissionPriority::small));
+  EXPECT_EQ(S3AdmissionResult::queued,
+            submit("metadata", 10, S3AdmissionPriority::metadata));
+
+  tickets.clear();
+  controller->drain();
+
+  ASSERT_EQ(4, events.size());
+  EXPECT_EQ("admit metadata", events[1]);
+  EXPECT_EQ("admit small", events[2]);
+  EXPECT_EQ("admit large", events[3]);
+}
+
+TEST_F(S3AdmissionControllerTest, DoesNotOvertakeWaitingRequests) {
+  create(100, 0, 10, 1000);
+
+  submit("first", 90, S3AdmissionPriority::large);
+  EXPECT_EQ(S3AdmissionResult::queued,
+            submit("waiting", 50, S3AdmissionPriority::small));
+  // Fits into the budget, but same priority request is already waiting.
+  EXPECT_EQ(S3AdmissionResult::queued,
+            submit("next", 5, S3AdmissionPriority::small));
+  // Higher priority may go ahead.
+  EXPECT_EQ(S3AdmissionResult::admitted,
+            submit("metadata", 5, S3AdmissionPriority::metadata));
+}
+
+TEST_F(S3AdmissionControllerTest, ShedsExpiredRequests) {
+  create(100, 0, 10, 500);
+
+  submit("first", 100, S3AdmissionPriority::large);
+  submit("waiting", 50, S3AdmissionPriority::large);
+
+  controller->shed_expired(std::chrono::steady_clock::now());
+  EXPECT_EQ(1, controller->get_queue_length());
+
+  controller->shed_expired(std::chrono::steady_clock::now() +
+                           std::chrono::milliseconds(500));
+  EXPECT_EQ(0, controller->get_queue_length());
+  ASSERT_EQ(2, events.size());
+  EXPECT_EQ("shed waiting", events[1]);
+}
+
+TEST_F(S3AdmissionControllerTest, QueueFullEvictsLowerPriority) {
+  create(100, 0, 2, 1000);
+
+  submit("first", 100, S3AdmissionPriority::large);
+  submit("large1", 50, S3AdmissionPriority::large);
+  submit("large2", 50, S3AdmissionPriority::large);
+  EXPECT_EQ(2, controller->get_queue_length());
+
+  // Newest lower priority waiter makes room.
+  EXPECT_EQ(S3AdmissionResult::queued,
+            submit("metadata", 10, S3AdmissionPriority::metadata));
+  ASSERT_EQ(2, events.size());
+  EXPECT_EQ("shed large2", events[1]);
+  EXPECT_EQ(1, controller->queues[(int)S3AdmissionPriority::metadata].size());
+
+  // Nothing of lower priority to evict.
+  EXPECT_EQ(S3AdmissionResult::rejected,
+            submit("large3", 50, S3AdmissionPriority::large));
+  EXPECT_EQ(2, controller->get_queue_length());
+}
+
+TEST_F(S3AdmissionControllerTest, CancelRemovesWaiter) {
+  create(100, 0, 10, 1000);
+
+  submit("first", 100, S3AdmissionPriority::large);
+  // Callbacks of a waiter own the request, like the server does.
+  auto request = std::make_shared<int>(0);
+  uint64_t waiter_id = 0;
+  EXPECT_EQ(S3AdmissionResult::queued,
+            controller->submit(
+                50, S3AdmissionPriority::large,
+                [request](std::unique_ptr<S3AdmissionTicket>) {},
+                [request]() {}, &waiter_id));
+  submit("next", 50, S3AdmissionPriority::large);
+  EXPECT_EQ(2, controller->get_queue_length());
+
+  EXPECT_TRUE(controller->cancel(waiter_id));
+  EXPECT_FALSE(controller->cancel(waiter_id));
+  EXPECT_EQ(1, controller->get_queue_length());
+  // Freed from the event loop, not from within cancel().
+  EXPECT_EQ(1, controller->cancelled.size());
+  EXPECT_EQ(3, request.use_count());
+
+  tickets.clear();
+  controller->drain();
+  EXPECT_EQ(1, request.use_count());
+  ASSERT_EQ(2, events.size());
+  EXPECT_EQ("admit next", events[1]);
+  EXPECT_EQ(0, controller->get_queue_length());
+}
+
+TEST_F(S3AdmissionControllerTest, TicketOutlivesController) {
+  create(100, 0, 10, 1000);
+  submit("a", 10, S3AdmissionPriority::small);
+  controller.reset();
+  // Must not touch destroyed controller.
+  tickets.clear();
+}
+
+TEST_F(S3AdmissionControllerTest, Priority) {
+  EXPECT_EQ(S3AdmissionPriority::metadata, s3_admission_priority(0, 1024));
+  EXPECT_EQ(S3AdmissionPriority::small, s3_admission_priority(1024, 1024));
+  EXPECT_EQ(S3AdmissionPriority::large, s3_admission_priority(1025, 1024));
+}
@@ -0,0 +1,231 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "s3_async_log.h"
+#include "s3_log.h"
+
+template <typename... Args>
+static std::string deferred_format(const char* fmt, Args... args) {
+  std::vector<char> packed(S3LogArgs::size(args...));
+  char* end = S3LogArgs::pack(packed.data(), args...);
+  EXPECT_EQ(packed.data() + packed.size(), end);
+  return S3AsyncLog::format(fmt, packed.data(), end);
+}
+
+#define EXPECT_SAME_AS_SNPRINTF(fmt, ...)                    \
+  do {                                                       \
+    char expected[256];                                      \
+    snprintf(expected, sizeof(expected), fmt, __VA_ARGS__);  \
+    EXPECT_EQ(expected, deferred_format(fmt, __VA_ARGS__));  \
+  } while (0)
+
+class S3AsyncLogTest : public testing::Test {
+ protected:
+  void SetUp() {
+    S3AsyncLog::set_sink([this](int level, const S3AsyncLog::Origin& origin,
+                                const std::string& msg) {
+      std::lock_guard<std::mutex> guard(lock);
+      messages.push_back(msg);
+      levels.push_back(level);
+      origins.push_back(origin);
+    });
+  }
+
+  void TearDown() {
+    S3AsyncLog::stop();
+    S3AsyncLog::set_sink(nullptr);
+  }
+
+  std::mutex lock;
+  std::vector<std::string> messages;
+  std::vector<int> levels;
+  std::vector<S3AsyncLog::Origin> origins;
+};
+
+TEST_F(S3AsyncLogTest, FormatMatchesPrintf) {
+  std::string temp("temporary");
+  EXPECT_SAME_AS_SNPRINTF("[%s] [ReqID: %s] plain\n", "func", temp.c_str());
+  EXPECT_SAME_AS_SNPRINTF("%d %i %5d %-5d| %05d", -1, 2, 3, -4, 5);
+  EXPECT_SAME_AS_SNPRINTF("%u %x %X %o %#x", 7u, 255u, 255u, 8u, 16u);
+  EXPECT_SAME_AS_SNPRINTF("%ld %lu %zu %" PRIu64 " %" PRId64, -1L, 2UL,
+                          (size_t)3, (uint64_t)UINT64_MAX, (int64_t)INT64_MIN);
+  // Value is converted to the type given by length modifier.
+  EXPECT_SAME_AS_SNPRINTF("%x %hhu %hd", -1, 257, 65537);
+  EXPECT_SAME_AS_SNPRINTF("%f %.2f %e %g %8.3lf", 1.5, 2.345, 1e10, 0.25,
+                          -3.0);
+  EXPECT_SAME_AS_SNPRINTF("%c%c %10s|%-4s|%.2s", 'o', 'k', "right", "l", "cut");
+  EXPECT_SAME_AS_SNPRINTF("%*d|%-*s|%.*s", 4, 1, 3, "a", 2, "abc");
+  EXPECT_SAME_AS_SNPRINTF("%p 100%% %s", (void*)0x1234, (const char*)nullptr);
+  EXPECT_SAME_AS_SNPRINTF("%d %s", true, "bool");
+}
+
+TEST_F(S3AsyncLogTest, FormatMismatch) {
+  EXPECT_EQ("a %? b %?", deferred_format("a %d b %s", "str"));
+  EXPECT_EQ("no args", deferred_format("no args"));
+}
+
+TEST_F(S3AsyncLogTest, NotRunning) {
+  EXPECT_FALSE(S3AsyncLog::write(1, __FILE__, __LINE__, "msg"));
+}
+
+TEST_F(S3AsyncLogTest, WritesInOrder) {
+  ASSERT_EQ(0, S3AsyncLog::start(1024 * 1024, 10));
+  EXPECT_EQ(-EEXIST, S3AsyncLog::start(1024 * 1024, 10));
+  for (int i = 0; i < 1000; ++i) {
+    std::string id = "id" + std::to_string(i);
+    EXPECT_TRUE(S3AsyncLog::write(i % 3, __FILE__, __LINE__, "%s %d\n",
+                                  id.c_str(), i));
+  }
+  S3AsyncLog::flush();
+
+  std::lock_guard<std::mutex> guard(lock);
+  ASSERT_EQ(1000, messages.size());
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_EQ("id" + std::to_string(i) + " " + std::to_string(i) + "\n",
+              messages[i]);
+    EXPECT_EQ(i % 3, levels[i]);
+  }
+}
+
+TEST_F(S3AsyncLogTest, OriginIsTakenWhenQueued) {
+  ASSERT_EQ(0, S3AsyncLog::start(64 * 1024, 10));
+  pid_t tid = 0;
+  struct timespec before, after;
+  clock_gettime(CLOCK_REALTIME, &before);
+  const int line = __LINE__ + 3;
+  std::thread thread([&tid]() {
+    tid = syscall(SYS_gettid);
+    S3AsyncLog::write(1, __FILE__, __LINE__, "msg\n");
+  });
+  thread.join();
+  clock_gettime(CLOCK_REALTIME, &after);
+  // Written by the flusher after a delay.
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  S3AsyncLog::flush();
+
+  std::lock_guard<std::mutex> guard(lock);
+  ASSERT_EQ(1, origins.size());
+  const S3AsyncLog::Origin& origin = origins[0];
+  EXPECT_STREQ(__FILE__, origin.file);
+  EXPECT_EQ(line, origin.line);
+  EXPECT_EQ(tid, origin.tid);
+  const auto usec = [](const struct timespec& ts) {
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+  };
+  EXPECT_LE(usec(before), usec(origin.time));
+  EXPECT_GE(usec(after), usec(origin.time));
+}
+
+TEST_F(S3AsyncLogTest, ArgumentsAreEvaluatedOnce) {
+  int evaluated = 0;
+  // Synchronous path.
+  s3_log(S3_LOG_WARN, "", "%d", ++evaluated);
+  EXPECT_EQ(1, evaluated);
+
+  ASSERT_EQ(0, S3AsyncLog::start(64 * 1024, 10));
+  s3_log(S3_LOG_WARN, "", "%d", ++evaluated);
+  EXPECT_EQ(2, evaluated);
+  S3AsyncLog::flush();
+  std::lock_guard<std::mutex> guard(lock);
+  ASSERT_EQ(1, messages.size());
+  EXPECT_NE(std::string::npos, messages[0].find("] 2\n"));
+}
+
+TEST_F(S3AsyncLogTest, FatalIsSynchronous) {
+  ASSERT_EQ(0, S3AsyncLog::start(64 * 1024, 10));
+  EXPECT_TRUE(S3AsyncLog::write(1, __FILE__, __LINE__, "before\n"));
+  // Queued messages are written out before the caller writes FATAL one.
+  EXPECT_FALSE(S3AsyncLog::write(4, __FILE__, __LINE__, "fatal\n"));
+  std::lock_guard<std::mutex> guard(lock);
+  ASSERT_EQ(1, messages.size());
+  EXPECT_EQ("before\n", messages[0]);
+}
+
+TEST_F(S3AsyncLogTest, OverloadSamplesAndDrops) {
+  // Flusher is blocked by the sink, so the ring buffer fills up.
+  std::mutex blocker;
+  S3AsyncLog::set_sink(
+      [&blocker](int, const S3AsyncLog::Origin&, const std::string&) {
+        std::lock_guard<std::mutex> guard(blocker);
+      });
+  std::unique_lock<std::mutex> blocked(blocker);
+  ASSERT_EQ(0, S3AsyncLog::start(4 * 1024, 4));
+
+  uint64_t dropped = S3AsyncLog::get_dropped_count();
+  uint64_t sampled_out = S3AsyncLog::get_sampled_out_count();
+  bool synchronous_warn = false;
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_TRUE(S3AsyncLog::write(1, __FILE__, __LINE__, "%d\n", i));
+  }
+  for (int i = 0; i < 100; ++i) {
+    // WARN is never dropped.
+    if (!S3AsyncLog::write(2, __FILE__, __LINE__, "%d\n", i)) {
+      synchronous_warn = true;
+    }
+  }
+  EXPECT_LT(sampled_out, S3AsyncLog::get_sampled_out_count());
+  EXPECT_LT(dropped, S3AsyncLog::get_dropped_count());
+  EXPECT_TRUE(synchronous_warn);
+  blocked.unlock();
+  S3AsyncLog::stop();
+}
+
+TEST_F(S3AsyncLogTest, ManyThreads) {
+  const int threads_count = 4;
+  const int messages_count = 2000;
+  ASSERT_EQ(0, S3AsyncLog::start(1024 * 1024, 1));
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < threads_count; ++t) {
+    threads.emplace_back([t]() {
+      for (int i = 0; i < messages_count; ++i) {
+        S3AsyncLog::write(2, __FILE__, __LINE__, "%d %d\n", t, i);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  S3AsyncLog::stop();
+
+  // Messages of each thread are in order.
+  std::vector<int> next(threads_count, 0);
+  std::lock_guard<std::mutex> guard(lock);
+  ASSERT_EQ(threads_count * messages_count, messages.size());
+  for (auto& msg : messages) {
+    int t, i;
+    ASSERT_EQ(2, sscanf(msg.c_str(), "%d %d", &t, &i));
+    EXPECT_EQ(next[t]++, i);
+  }
+}
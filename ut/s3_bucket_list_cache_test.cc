@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "s3_bucket_list_cache.h"
+
+TEST(S3BucketListEntryTest, FromBucketMetadataJson) {
+  S3BucketListEntry entry;
+  ASSERT_TRUE(s3_bucket_list_entry_from_json(
+      "{\"ACL\":\"PD94bWwgdmVyc2lvbj0iMS4wIj8+\",\"Bucket-Name\":\"bucket1\","
+      "\"Policy\":\"\",\"System-Defined\":{\"Date\":\"2020-09-01T10:00:00."
+      "000Z\",\"LocationConstraint\":\"us-west-2\",\"Owner-Account\":\"s3\"},"
+      "\"User-Defined\":{\"x-amz-meta-a\":\"{\\\"Date\\\":1}\"},"
+      "\"create_timestamp\":\"2020-09-01T10:00:00.000Z\","
+      "\"motr_object_list_index_oid\":\"AQAAAAAAAHg=-AQAAAAAAAAA=\"}\n",
+      entry));
+  EXPECT_EQ("bucket1", entry.name);
+  EXPECT_EQ("2020-09-01T10:00:00.000Z", entry.creation_date);
+}
+
+TEST(S3BucketListEntryTest, SkipsValuesOfAnyType) {
+  S3BucketListEntry entry;
+  ASSERT_TRUE(s3_bucket_list_entry_from_json(
+      " { \"a\" : [1, -2.5e+3, true, null, {\"b\": [[]]}, \"]\"],\n"
+      "\"System-Defined\": {\"x\": {}, \"Date\": \"d\"}, \"c\": false,"
+      "\"Bucket-Name\": \"n\" } ",
+      entry));
+  EXPECT_EQ("n", entry.name);
+  EXPECT_EQ("d", entry.creation_date);
+}
+
+TEST(S3BucketListEntryTest, UnescapesStrings) {
+  S3BucketListEntry entry;
+  ASSERT_TRUE(s3_bucket_list_entry_from_json(
+      "{\"Bucket-Name\":\"a\\\"b\\\\c\\/d\\u00e9\\ud83d\\ude00\\n\"}", entry));
+  EXPECT_EQ("a\"b\\c/d\xc3\xa9\xf0\x9f\x98\x80\n", entry.name);
+  EXPECT_EQ("", entry.creation_date);
+}
+
+TEST(S3BucketListEntryTest, RejectsInvalidJson) {
+  S3BucketListEntry entry;
+  EXPECT_FALSE(s3_bucket_list_entry_from_json("", entry));
+  EXPECT_FALSE(s3_bucket_list_entry_from_json("keyval", entry));
+  EXPECT_FALSE(s3_bucket_list_entry_from_json("[]", entry));
+  EXPECT_FALSE(s3_bucket_list_entry_from_json("{\"Bucket-Name\":\"a\"", entry));
+  EXPECT_FALSE(s3_bucket_list_entry_from_json("{\"Bucket-Name\":\"a}", entry));
+  EXPECT_FALSE(
+      s3_bucket_list_entry_from_json("{\"Bucket-Name\":\"\\x\"}", entry));
+  EXPECT_FALSE(s3_bucket_list_entry_from_json("{\"a\":[1,}", entry));
+  EXPECT_FALSE(s3_bucket_list_entry_from_json("{\"a\":}", entry));
+  EXPECT_FALSE(
+      s3_bucket_list_entry_from_json("{\"a\":" + std::string(100, '['), entry));
+}
+
+TEST(S3BucketListCacheTest, SingleInstance) {
+  EXPECT_EQ(nullptr, S3BucketListCache::get_instance());
+  {
+    S3BucketListCache cache(10, 60);
+    EXPECT_EQ(&cache, S3BucketListCache::get_instance());
+  }
+  EXPECT_EQ(nullptr, S3BucketListCache::get_instance());
+  // No-op without the cache.
+  s3_bucket_list_cache_invalidate("12345");
+}
+
+TEST(S3BucketListCacheTest, AddFindInvalidate) {
+  S3BucketListCache cache(10, 60);
+  EXPECT_EQ(nullptr, cache.find("12345"));
+
+  cache.add("12345", cache.begin_load(), {{"bucket1", "date1"}});
+  cache.add("67890", cache.begin_load(), {});
+  const std::vector<S3BucketListEntry>* buckets = cache.find("12345");
+  ASSERT_NE(nullptr, buckets);
+  ASSERT_EQ(1, buckets->size());
+  EXPECT_EQ("bucket1", (*buckets)[0].name);
+  EXPECT_EQ("date1", (*buckets)[0].creation_date);
+  ASSERT_NE(nullptr, cache.find("67890"));
+  EXPECT_TRUE(cache.find("67890")->empty());
+
+  s3_bucket_list_cache_invalidate("12345");
+  EXPECT_EQ(nullptr, cache.find("12345"));
+  EXPECT_NE(nullptr, cache.find("67890"));
+}
+
+TEST(S3BucketListCacheTest, ListLoadedDuringInvalidationIsDropped) {
+  S3BucketListCache cache(10, 60);
+  const uint64_t token = cache.begin_load();
+  cache.invalidate("67890");
+  cache.add("12345", token, {{"bucket1", "date1"}});
+  EXPECT_EQ(nullptr, cache.find("12345"));
+
+  cache.add("12345", cache.begin_load(), {{"bucket1", "date1"}});
+  EXPECT_NE(nullptr, cache.find("12345"));
+}
+
+TEST(S3BucketListCacheTest, Expires) {
+  S3BucketListCache cache(10, 0);
+  cache.add("12345", cache.begin_load(), {{"bucket1", "date1"}});
+  EXPECT_EQ(1, cache.get_count());
+  EXPECT_EQ(nullptr, cache.find("12345"));
+  EXPECT_EQ(0, cache.get_count());
+}
+
+TEST(S3BucketListCacheTest, EvictsOldestAccount) {
+  S3BucketListCache cache(2, 60);
+  cache.add("1", cache.begin_load(), {});
+  cache.add("2", cache.begin_load(), {});
+  cache.add("3", cache.begin_load(), {});
+  EXPECT_EQ(2, cache.get_count());
+  EXPECT_EQ(nullptr, cache.find("1"));
+  EXPECT_NE(nullptr, cache.find("2"));
+  EXPECT_NE(nullptr, cache.find("3"));
+}
@@ -0,0 +1,486 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <json/json.h>
+
+#include "mock_event_wrapper.h"
+#include "mock_motr_request_object.h"
+#include "mock_s3_factory.h"
+#include "mock_s3_motr_wrapper.h"
+#include "s3_bucket_usage.h"
+#include "s3_m0_uint128_helper.h"
+#include "s3_option.h"
+
+using ::testing::_;
+using ::testing::A;
+using ::testing::DoAll;
+using ::testing::ElementsAre;
+using ::testing::InvokeArgument;
+using ::testing::Return;
+using ::testing::ReturnPointee;
+using ::testing::ReturnRef;
+using ::testing::SaveArg;
+
+static S3BucketUsageCounters make_counters(int64_t objects_count,
+                                           int64_t bytes_used) {
+  S3BucketUsageCounters counters;
+  counters.objects_count = objects_count;
+  counters.bytes_used = bytes_used;
+  return counters;
+}
+
+TEST(S3BucketUsageCountersTest, Json) {
+  S3BucketUsageCounters counters = make_counters(3, 5000000000LL);
+  S3BucketUsageCounters parsed;
+  ASSERT_TRUE(parsed.from_json(counters.to_json()));
+  EXPECT_EQ(3, parsed.objects_count);
+  EXPECT_EQ(5000000000LL, parsed.bytes_used);
+  EXPECT_FALSE(parsed.from_json("{invalid json"));
+
+  parsed.add(make_counters(-3, -5000000000LL));
+  EXPECT_TRUE(parsed.is_zero());
+}
+
+class S3BucketUsageTest : public testing::Test {
+ protected:
+  S3BucketUsageTest() {
+    evhtp_request_t *req = NULL;
+    ptr_mock_request =
+        std::make_shared<MockMotrRequestObject>(req, new EvhtpWrapper());
+    ptr_mock_s3_motr_api = std::make_shared<MockS3Motr>();
+    motr_kvs_reader_factory = std::make_shared<MockS3MotrKVSReaderFactory>(
+        ptr_mock_request, ptr_mock_s3_motr_api);
+    motr_kvs_writer_factory = std::make_shared<MockS3MotrKVSWriterFactory>(
+        ptr_mock_request, ptr_mock_s3_motr_api);
+
+    usage.reset(new S3BucketUsage(
+        std::make_shared<MockEventWrapper>(), nullptr, ptr_mock_request,
+        {0x11, 0x22}, "fid1", motr_kvs_reader_factory,
+        motr_kvs_writer_factory, ptr_mock_s3_motr_api));
+  }
+
+  std::shared_ptr<MockMotrRequestObject> ptr_mock_request;
+  std::shared_ptr<MockS3Motr> ptr_mock_s3_motr_api;
+  std::shared_ptr<MockS3MotrKVSReaderFactory> motr_kvs_reader_factory;
+  std::shared_ptr<MockS3MotrKVSWriterFactory> motr_kvs_writer_factory;
+  std::shared_ptr<S3BucketUsage> usage;
+};
+
+TEST_F(S3BucketUsageTest, FlushLoadsThenSavesAbsoluteValues) {
+  // Reconciliation is not due.
+  usage->reconcile_time = time(nullptr);
+  std::map<std::string, std::pair<int, std::string>> kvs;
+  kvs["b1/fid1"] = std::make_pair(0, make_counters(3, 1000).to_json());
+  std::map<std::string, std::string> saved;
+
+  usage->update("b1", make_counters(1, 100));
+  usage->update("b1", make_counters(1, 50));
+
+  EXPECT_CALL(*(motr_kvs_reader_factory->mock_motr_kvs_reader),
+              get_keyval(_, A<std::vector<std::string>>(), _, _)).Times(1);
+  usage->action_callback();
+  EXPECT_TRUE(usage->flush_in_progress);
+  // Changes which come during the flush wait for the next one.
+  usage->update("b1", make_counters(-1, -100));
+
+  EXPECT_CALL(*(motr_kvs_reader_factory->mock_motr_kvs_reader), get_state())
+      .WillRepeatedly(Return(S3MotrKVSReaderOpState::present));
+  EXPECT_CALL(*(motr_kvs_reader_factory->mock_motr_kvs_reader),
+              get_key_values()).WillRepeatedly(ReturnRef(kvs));
+  EXPECT_CALL(*(motr_kvs_writer_factory->mock_motr_kvs_writer),
+              put_keyval(_, _, _, _)).WillOnce(SaveArg<1>(&saved));
+  usage->load_records_successful();
+
+  S3BucketUsageCounters value;
+  ASSERT_EQ(1, saved.size());
+  ASSERT_TRUE(value.from_json(saved["b1/fid1"]));
+  EXPECT_EQ(5, value.objects_count);
+  EXPECT_EQ(1150, value.bytes_used);
+
+  usage->save_records_successful();
+  EXPECT_FALSE(usage->flush_in_progress);
+  EXPECT_EQ(5, usage->records["b1"].persisted.objects_count);
+  EXPECT_TRUE(usage->records["b1"].flushing.is_zero());
+
+  // Loaded record is written without reading it again.
+  EXPECT_CALL(*(motr_kvs_writer_factory->mock_motr_kvs_writer),
+              put_keyval(_, _, _, _)).WillOnce(SaveArg<1>(&saved));
+  usage->action_callback();
+  ASSERT_TRUE(value.from_json(saved["b1/fid1"]));
+  EXPECT_EQ(4, value.objects_count);
+  EXPECT_EQ(1050, value.bytes_used);
+}
+
+TEST_F(S3BucketUsageTest, FailedSaveKeepsChanges) {
+  // Reconciliation is not due.
+  usage->reconcile_time = time(nullptr);
+  usage->records["b1"].loaded = true;
+  usage->records["b1"].persisted = make_counters(2, 20);
+  usage->update("b1", make_counters(1, 10));
+
+  EXPECT_CALL(*(motr_kvs_writer_factory->mock_motr_kvs_writer),
+              put_keyval(_, _, _, _)).Times(1);
+  usage->action_callback();
+  usage->save_records_failed();
+
+  EXPECT_FALSE(usage->flush_in_progress);
+  EXPECT_EQ(2, usage->records["b1"].persisted.objects_count);
+  EXPECT_TRUE(usage->records["b1"].flushing.is_zero());
+  EXPECT_EQ(1, usage->records["b1"].pending.objects_count);
+  EXPECT_EQ(10, usage->records["b1"].pending.bytes_used);
+}
+
+TEST_F(S3BucketUsageTest, ForgetDeletesOwnRecord) {
+  // Reconciliation is not due.
+  usage->reconcile_time = time(nullptr);
+  usage->update("b1", make_counters(1, 10));
+  usage->forget("b1");
+
+  EXPECT_CALL(*(motr_kvs_writer_factory->mock_motr_kvs_writer),
+              delete_keyval(_, ElementsAre("b1/fid1", "b1/reconciled"), _, _))
+      .WillOnce(InvokeArgument<2>());
+  usage->action_callback();
+
+  EXPECT_TRUE(usage->records.empty());
+  EXPECT_TRUE(usage->deleted_keys.empty());
+  EXPECT_FALSE(usage->flush_in_progress);
+}
+
+TEST_F(S3BucketUsageTest, QuerySumsInstances) {
+  usage->records["b1"].loaded = true;
+  usage->records["b1"].persisted = make_counters(2, 20);
+  usage->update("b1", make_counters(1, 10));
+
+  std::map<std::string, std::pair<int, std::string>> kvs;
+  kvs["b1/fid0"] = std::make_pair(0, make_counters(5, 500).to_json());
+  // Own record is taken from memory, which is more recent.
+  kvs["b1/fid1"] = std::make_pair(0, make_counters(100, 100).to_json());
+  kvs["b2/fid0"] = std::make_pair(0, make_counters(7, 7).to_json());
+
+  EXPECT_CALL(*(motr_kvs_reader_factory->mock_motr_kvs_reader),
+              next_keyval(_, "b1/", _, _, _, _))
+      .WillOnce(InvokeArgument<3>());
+  EXPECT_CALL(*(motr_kvs_reader_factory->mock_motr_kvs_reader),
+              get_key_values()).WillRepeatedly(ReturnRef(kvs));
+
+  int result_rc = -1;
+  S3BucketUsageCounters result;
+  usage->get_usage("b1", [&](int rc, const S3BucketUsageCounters &counters) {
+    result_rc = rc;
+    result = counters;
+  });
+
+  EXPECT_EQ(0, result_rc);
+  EXPECT_EQ(8, result.objects_count);
+  EXPECT_EQ(530, result.bytes_used);
+}
+
+TEST_F(S3BucketUsageTest, QueryKeepsNegativeUsage) {
+  // Deleted objects which were never counted, until reconciliation.
+  usage->update("b1", make_counters(-2, -20));
+
+  std::map<std::string, std::pair<int, std::string>> kvs;
+  EXPECT_CALL(*(motr_kvs_reader_factory->mock_motr_kvs_reader),
+              next_keyval(_, "b1/", _, _, _, _))
+      .WillOnce(InvokeArgument<3>());
+  EXPECT_CALL(*(motr_kvs_reader_factory->mock_motr_kvs_reader),
+              get_key_values()).WillRepeatedly(ReturnRef(kvs));
+
+  S3BucketUsageCounters result;
+  usage->get_usage("b1", [&](int rc, const S3BucketUsageCounters &counters) {
+    result = counters;
+  });
+
+  EXPECT_EQ(-2, result.objects_count);
+  EXPECT_EQ(-20, result.bytes_used);
+}
+
+TEST_F(S3BucketUsageTest, QueryResultIsReused) {
+  std::map<std::string, std::pair<int, std::string>> kvs;
+  kvs["b1/fid0"] = std::make_pair(0, make_counters(5, 500).to_json());
+  // Records are read once.
+  EXPECT_CALL(*(motr_kvs_reader_factory->mock_motr_kvs_reader),
+              next_keyval(_, "b1/", _, _, _, _))
+      .WillOnce(InvokeArgument<3>());
+  EXPECT_CALL(*(motr_kvs_reader_factory->mock_motr_kvs_reader),
+              get_key_values()).WillRepeatedly(ReturnRef(kvs));
+
+  S3BucketUsageCounters result;
+  auto on_done = [&](int rc, const S3BucketUsageCounters &counters) {
+    result = counters;
+  };
+  usage->get_usage("b1", on_done);
+  EXPECT_EQ(5, result.objects_count);
+
+  // Own changes are taken from memory still.
+  usage->update("b1", make_counters(1, 10));
+  usage->get_usage("b1", on_done);
+  EXPECT_EQ(6, result.objects_count);
+  EXPECT_EQ(510, result.bytes_used);
+
+  // Dropped once it is older than a flush interval, own changes are flushed.
+  usage->summed["b1"].read_time -= 10;
+  usage->reconcile_time = time(nullptr);
+  EXPECT_CALL(*(motr_kvs_reader_factory->mock_motr_kvs_reader),
+              get_keyval(_, A<std::vector<std::string>>(), _, _)).Times(1);
+  usage->action_callback();
+  EXPECT_TRUE(usage->summed.empty());
+}
+
+TEST_F(S3BucketUsageTest, QueryEndsWhenStopped) {
+  std::function<void(void)> on_success;
+  EXPECT_CALL(*(motr_kvs_reader_factory->mock_motr_kvs_reader),
+              next_keyval(_, "b1/", _, _, _, _))
+      .WillOnce(SaveArg<3>(&on_success));
+
+  int result_rc = 0;
+  usage->get_usage("b1", [&](int rc, const S3BucketUsageCounters &counters) {
+    result_rc = rc;
+  });
+  // Query in progress does not keep bucket usage.
+  usage->stop();
+  std::weak_ptr<S3BucketUsage> stopped = usage;
+  usage.reset();
+  EXPECT_TRUE(stopped.expired());
+
+  on_success();
+  EXPECT_EQ(-ECANCELED, result_rc);
+}
+
+static std::string make_object_json(const std::string &content_length) {
+  Json::Value root;
+  root["System-Defined"]["Content-Length"] = content_length;
+  Json::FastWriter fast_writer;
+  return fast_writer.write(root);
+}
+
+static std::string make_bucket_json(const struct m0_uint128 &list_index_oid) {
+  Json::Value root;
+  root["motr_object_list_index_oid"] =
+      S3M0Uint128Helper::to_string(list_index_oid);
+  Json::FastWriter fast_writer;
+  return fast_writer.write(root);
+}
+
+TEST_F(S3BucketUsageTest, ReconcileElectsOneInstance) {
+  S3Option::get_instance()->set_bucket_usage_reconcile_interval_sec(86400);
+  const time_t now = time(nullptr);
+  S3BucketUsageLease lease;
+  std::string lease_json;
+  EXPECT_CALL(*(motr_kvs_reader_factory->mock_motr_kvs_reader),
+              get_keyval(_, A<std::string>(), _, _)).Times(4);
+  EXPECT_CALL(*(motr_kvs_reader_factory->mock_motr_kvs_reader), get_value())
+      .WillRepeatedly(ReturnPointee(&lease_json));
+
+  // Held by another instance.
+  lease.instance_id = "fid0";
+  lease.renewed = now;
+  lease_json = lease.to_json();
+  auto reconciler = std::make_shared<S3BucketUsageReconciler>(usage);
+  reconciler->run();
+  reconciler->read_lease_successful();
+  EXPECT_TRUE(reconciler->is_finished());
+
+  // Released, but the last run is recent.
+  lease.renewed = 0;
+  lease.last_run = now - 10;
+  lease_json = lease.to_json();
+  reconciler = std::make_shared<S3BucketUsageReconciler>(usage);
+  reconciler->run();
+  reconciler->read_lease_successful();
+  EXPECT_TRUE(reconciler->is_finished());
+
+  // Claimed, then another instance claims it too and wins.
+  lease.last_run = now - 86400;
+  lease_json = lease.to_json();
+  std::string claim;
+  EXPECT_CALL(*(motr_kvs_writer_factory->mock_motr_kvs_writer),
+              put_keyval(_, std::string(S3_BUCKET_USAGE_LEASE_RECORD), _, _,
+                         _)).WillOnce(DoAll(SaveArg<2>(&claim),
+                                            InvokeArgument<3>()));
+  reconciler = std::make_shared<S3BucketUsageReconciler>(usage);
+  reconciler->run();
+  reconciler->read_lease_successful();
+  EXPECT_FALSE(reconciler->is_finished());
+  S3BucketUsageLease claimed;
+  ASSERT_TRUE(claimed.from_json(claim));
+  EXPECT_EQ("fid1", claimed.instance_id);
+  EXPECT_EQ(now - 86400, claimed.last_run);
+
+  lease.instance_id = "fid2";
+  lease.renewed = now;
+  lease_json = lease.to_json();
+  reconciler->resume_time = 0;
+  reconciler->tick();
+  reconciler->read_lease_successful();
+  EXPECT_TRUE(reconciler->is_finished());
+  EXPECT_FALSE(reconciler->elected);
+  reconciler->release();
+  S3Option::get_instance()->set_bucket_usage_reconcile_interval_sec(0);
+}
+
+TEST_F(S3BucketUsageTest, ReconcileWritesCorrection) {
+  const struct m0_uint128 list_index_oid = {0x1, 0x2};
+  const std::string bucket_key = S3BucketUsage::get_bucket_key(list_index_oid);
+  usage->records[bucket_key].loaded = true;
+  usage->records[bucket_key].persisted = make_counters(1, 10);
+
+  std::map<std::string, std::pair<int, std::string>> kvs;
+  EXPECT_CALL(*(motr_kvs_reader_factory->mock_motr_kvs_reader),
+              get_key_values()).WillRepeatedly(ReturnRef(kvs));
+  // Buckets, usage records, objects of the bucket, then usage records again.
+  EXPECT_CALL(*(motr_kvs_reader_factory->mock_motr_kvs_reader),
+              next_keyval(_, _, _, _, _, _)).Times(4);
+
+  auto reconciler = std::make_shared<S3BucketUsageReconciler>(usage);
+  // Elected, see ReconcileElectsOneInstance.
+  reconciler->elected = true;
+  reconciler->start_time = 100;
+  reconciler->lease.instance_id = "fid1";
+  reconciler->lease.renewed = time(nullptr);
+  reconciler->list_buckets("");
+  kvs["12345/b1"] = std::make_pair(0, make_bucket_json(list_index_oid));
+  reconciler->list_buckets_successful();
+
+  kvs.clear();
+  kvs[bucket_key + "/fid0"] =
+      std::make_pair(0, make_counters(2, 100).to_json());
+  kvs[bucket_key + "/reconciled"] =
+      std::make_pair(0, make_counters(-1, -10).to_json());
+  std::map<std::string, std::pair<int, std::string>> records = kvs;
+  reconciler->query->list_records_successful();
+
+  kvs.clear();
+  kvs["obj1"] = std::make_pair(0, make_object_json("100"));
+  kvs["obj2"] = std::make_pair(0, make_object_json("200"));
+  reconciler->count_objects_successful();
+  // Records are summed again once other instances have flushed.
+  EXPECT_NE(0, reconciler->resume_time);
+
+  kvs = records;
+  reconciler->resume_time = 0;
+  reconciler->tick();
+  std::string saved;
+  EXPECT_CALL(*(motr_kvs_writer_factory->mock_motr_kvs_writer),
+              put_keyval(_, bucket_key + "/reconciled", _, _, _))
+      .WillOnce(DoAll(SaveArg<2>(&saved), InvokeArgument<3>()));
+  reconciler->query->list_records_successful();
+
+  // Records sum up to 2 objects and 100 bytes, 2 objects and 300 bytes are
+  // counted.
+  S3BucketUsageCounters value;
+  ASSERT_TRUE(value.from_json(saved));
+  EXPECT_EQ(-1, value.objects_count);
+  EXPECT_EQ(190, value.bytes_used);
+
+  // Lease is released on the next tick.
+  EXPECT_FALSE(reconciler->is_finished());
+  EXPECT_CALL(*(motr_kvs_writer_factory->mock_motr_kvs_writer),
+              put_keyval(_, std::string(S3_BUCKET_USAGE_LEASE_RECORD), _, _,
+                         _)).WillOnce(DoAll(SaveArg<2>(&saved),
+                                            InvokeArgument<3>()));
+  reconciler->tick();
+  EXPECT_TRUE(reconciler->is_finished());
+  S3BucketUsageLease lease;
+  ASSERT_TRUE(lease.from_json(saved));
+  EXPECT_EQ("fid1", lease.instance_id);
+  EXPECT_EQ(0, lease.renewed);
+  EXPECT_EQ(100, lease.last_run);
+  reconciler->release();
+}
+
+TEST_F(S3BucketUsageTest, ReconcileSkipsChangedBucket) {
+  const struct m0_uint128 list_index_oid = {0x1, 0x2};
+  const std::string bucket_key = S3BucketUsage::get_bucket_key(list_index_oid);
+
+  std::map<std::string, std::pair<int, std::string>> kvs;
+  EXPECT_CALL(*(motr_kvs_reader_factory->mock_motr_kvs_reader),
+              get_key_values()).WillRepeatedly(ReturnRef(kvs));
+  EXPECT_CALL(*(motr_kvs_reader_factory->mock_motr_kvs_reader),
+              next_keyval(_, _, _, _, _, _)).Times(4);
+  EXPECT_CALL(*(motr_kvs_writer_factory->mock_motr_kvs_writer),
+              put_keyval(_, bucket_key + "/reconciled", _, _, _)).Times(0);
+
+  auto reconciler = std::make_shared<S3BucketUsageReconciler>(usage);
+  reconciler->elected = true;
+  reconciler->lease.renewed = time(nullptr);
+  reconciler->list_buckets("");
+  kvs["12345/b1"] = std::make_pair(0, make_bucket_json(list_index_oid));
+  reconciler->list_buckets_successful();
+
+  kvs.clear();
+  kvs[bucket_key + "/fid0"] =
+      std::make_pair(0, make_counters(2, 100).to_json());
+  reconciler->query->list_records_successful();
+
+  kvs.clear();
+  kvs["obj1"] = std::make_pair(0, make_object_json("100"));
+  reconciler->count_objects_successful();
+
+  // Another instance has written an object which the scan may have missed.
+  kvs.clear();
+  kvs[bucket_key + "/fid0"] =
+      std::make_pair(0, make_counters(3, 150).to_json());
+  reconciler->resume_time = 0;
+  reconciler->tick();
+  reconciler->query->list_records_successful();
+
+  EXPECT_CALL(*(motr_kvs_writer_factory->mock_motr_kvs_writer),
+              put_keyval(_, std::string(S3_BUCKET_USAGE_LEASE_RECORD), _, _,
+                         _)).WillOnce(InvokeArgument<3>());
+  reconciler->tick();
+  EXPECT_TRUE(reconciler->is_finished());
+  reconciler->release();
+}
+
+TEST_F(S3BucketUsageTest, ReconcileSkipsDeletedBucket) {
+  std::map<std::string, std::pair<int, std::string>> kvs;
+  kvs["12345/b1"] = std::make_pair(0, make_bucket_json({0x1, 0x2}));
+  EXPECT_CALL(*(motr_kvs_reader_factory->mock_motr_kvs_reader),
+              get_key_values()).WillRepeatedly(ReturnRef(kvs));
+  // Buckets, usage records, then objects of the bucket.
+  EXPECT_CALL(*(motr_kvs_reader_factory->mock_motr_kvs_reader),
+              next_keyval(_, _, _, _, _, _)).Times(3);
+  EXPECT_CALL(*(motr_kvs_writer_factory->mock_motr_kvs_writer),
+              put_keyval(_, A<std::string>(), _, _, _))
+      .WillOnce(InvokeArgument<3>());
+
+  auto reconciler = std::make_shared<S3BucketUsageReconciler>(usage);
+  reconciler->elected = true;
+  reconciler->lease.renewed = time(nullptr);
+  reconciler->list_buckets("");
+  reconciler->list_buckets_successful();
+  reconciler->query->list_records_successful();
+  EXPECT_FALSE(reconciler->is_finished());
+
+  EXPECT_CALL(*(motr_kvs_reader_factory->mock_motr_kvs_reader), get_state())
+      .WillRepeatedly(Return(S3MotrKVSReaderOpState::missing));
+  reconciler->count_objects_failed();
+  EXPECT_TRUE(reconciler->scanned.empty());
+
+  // Nothing to correct, only the lease is written.
+  reconciler->resume_time = 0;
+  reconciler->tick();
+  EXPECT_TRUE(reconciler->is_finished());
+  reconciler->release();
+}
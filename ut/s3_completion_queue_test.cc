@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include <event2/event.h>
+
+#include "s3_completion_queue.h"
+
+namespace {
+
+struct CompletionLog {
+  std::vector<int> order;
+  size_t expected = 0;
+  struct event_base *base = nullptr;
+};
+
+CompletionLog *gs_log;
+
+// 'ctx' is the value pushed, cast to a pointer.
+void log_completion(void *ctx) {
+  gs_log->order.push_back((int)(intptr_t)ctx);
+  if (gs_log->base && gs_log->order.size() == gs_log->expected) {
+    event_base_loopbreak(gs_log->base);
+  }
+}
+
+class S3CompletionQueueTest : public testing::Test {
+ protected:
+  CompletionLog log;
+
+  void SetUp() { gs_log = &log; }
+  void TearDown() { gs_log = nullptr; }
+
+  // Runs the event loop until 'expected' completions are logged or for at
+  // most 10 seconds.
+  void run_loop(struct event_base *base, size_t expected) {
+    log.base = base;
+    log.expected = expected;
+    struct timeval tv = {10, 0};
+    event_base_loopexit(base, &tv);
+    event_base_dispatch(base);
+  }
+};
+
+}  // namespace
+
+TEST_F(S3CompletionQueueTest, CapacityIsPowerOf2) {
+  EXPECT_EQ(2, S3CompletionQueue(0, 1).get_capacity());
+  EXPECT_EQ(4, S3CompletionQueue(3, 1).get_capacity());
+  EXPECT_EQ(1024, S3CompletionQueue(1024, 1).get_capacity());
+}
+
+TEST_F(S3CompletionQueueTest, DrainsInOrder) {
+  S3CompletionQueue queue(8, 8);
+  EXPECT_EQ(0, queue.drain(8));
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_TRUE(queue.push(log_completion, (void *)(intptr_t)i));
+  }
+  EXPECT_EQ(2, queue.drain(2));
+  EXPECT_EQ(3, queue.drain(8));
+  EXPECT_EQ(std::vector<int>({0, 1, 2, 3, 4}), log.order);
+}
+
+TEST_F(S3CompletionQueueTest, Full) {
+  S3CompletionQueue queue(4, 4);
+  for (int lap = 0; lap < 3; ++lap) {
+    for (int i = 0; i < 4; ++i) {
+      EXPECT_TRUE(queue.push(log_completion, (void *)(intptr_t)i));
+    }
+    EXPECT_FALSE(queue.push(log_completion, (void *)(intptr_t)4));
+    EXPECT_EQ(1, queue.drain(1));
+    EXPECT_TRUE(queue.push(log_completion, (void *)(intptr_t)4));
+    EXPECT_EQ(4, queue.drain(10));
+  }
+  EXPECT_EQ(15, log.order.size());
+  EXPECT_EQ(4, log.order.back());
+}
+
+TEST_F(S3CompletionQueueTest, ConcurrentProducers) {
+  const int n_threads = 4;
+  const int n_pushes = 20000;
+  S3CompletionQueue queue(256, 256);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < n_threads; ++t) {
+    threads.emplace_back([&queue, t]() {
+      for (int i = 0; i < n_pushes; ++i) {
+        void *ctx = (void *)(intptr_t)(t * n_pushes + i);
+        while (!queue.push(log_completion, ctx)) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  while (log.order.size() < (size_t)n_threads * n_pushes) {
+    if (!queue.drain(64)) {
+      std::this_thread::yield();
+    }
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  // Each producer's completions are handled in its order.
+  std::vector<int> next(n_threads);
+  for (int value : log.order) {
+    const int t = value / n_pushes;
+    ASSERT_EQ(next[t], value % n_pushes);
+    ++next[t];
+  }
+  EXPECT_EQ(0, queue.drain(64));
+}
+
+TEST_F(S3CompletionQueueTest, WakesUpEventLoop) {
+  struct event_base *base = event_base_new();
+  ASSERT_NE(nullptr, base);
+  {
+    // Batch is smaller than the count of completions.
+    S3CompletionQueue queue(1024, 16);
+    ASSERT_EQ(0, queue.attach(base));
+
+    const int n_threads = 4;
+    const int n_pushes = 100;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < n_threads; ++t) {
+      threads.emplace_back([&queue, t]() {
+        for (int i = 0; i < n_pushes; ++i) {
+          queue.push(log_completion, (void *)(intptr_t)(t * n_pushes + i));
+        }
+      });
+    }
+    run_loop(base, n_threads * n_pushes);
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    EXPECT_EQ(n_threads * n_pushes, log.order.size());
+
+    // Woken up again after the loop has drained everything.
+    log.order.clear();
+    queue.push(log_completion, (void *)(intptr_t)7);
+    run_loop(base, 1);
+    EXPECT_EQ(std::vector<int>({7}), log.order);
+  }
+  event_base_free(base);
+}
+
+static void count_completion(void *ctx) { ++*(size_t *)ctx; }
+
+// Prints the cost of passing a completion to the event loop through the
+// queue.  Disabled, run with --gtest_also_run_disabled_tests.
+TEST_F(S3CompletionQueueTest, DISABLED_Benchmark) {
+  struct event_base *base = event_base_new();
+  ASSERT_NE(nullptr, base);
+  {
+    const size_t n_completions = 200000;
+    S3CompletionQueue queue(65536, 256);
+    ASSERT_EQ(0, queue.attach(base));
+    size_t count = 0;
+    auto start = std::chrono::steady_clock::now();
+    std::thread producer([&queue, &count]() {
+      for (size_t i = 0; i < n_completions; ++i) {
+        while (!queue.push(count_completion, &count)) {
+          std::this_thread::yield();
+        }
+      }
+    });
+    while (count < n_completions) {
+      event_base_loop(base, EVLOOP_ONCE);
+    }
+    producer.join();
+    const double ns = std::chrono::duration<double, std::nano>(
+                          std::chrono::steady_clock::now() - start).count();
+    printf("S3CompletionQueue: %.0f ns per completion\n", ns / n_completions);
+    EXPECT_EQ(n_completions, count);
+  }
+  event_base_free(base);
+}
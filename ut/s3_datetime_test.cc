@@ -18,6 +18,11 @@
  *
  */
 
+#include <stdio.h>
+#include <string.h>
+
+#include <chrono>
+
 #include "s3_datetime.h"
 #include "gtest/gtest.h"
 
@@ -33,6 +38,12 @@ class S3DateTimeTest : public testing::Test {
   void init_with_fmt_test(std::string &time_str, std::string format) {
     s3dateobj_ptr->init_with_fmt(time_str, format);
   }
+  static bool parse_iso_test(const char *time_str, struct tm &out) {
+    return S3DateTime::parse_iso(time_str, out);
+  }
+  static bool parse_gmt_test(const char *time_str, struct tm &out) {
+    return S3DateTime::parse_gmt(time_str, out);
+  }
   void TearDown() { delete s3dateobj_ptr; }
 
   S3DateTime *s3dateobj_ptr;
@@ -187,3 +198,131 @@ TEST_F(S3DateTimeTest, GetFmtStringTest) {
   fmt_time = get_format_string_test(S3_ISO_DATETIME_FORMAT);
   EXPECT_EQ('Z', fmt_time.back());
 }
+
+// Hand-rolled parsing and formatting must give the same results as
+// strptime/strftime for every second of a few years around now and the
+// leap days.
+TEST_F(S3DateTimeTest, SameAsStrftimeAndStrptime) {
+  const time_t start = 1577836800;  // 2020-01-01
+  for (time_t t = start - 86400 * 366 * 4; t < start + 86400 * 366 * 4;
+       t += 86400 / 4 + 7) {
+    struct tm expected;
+    gmtime_r(&t, &expected);
+    char iso[100], gmt[100];
+    strftime(iso, sizeof(iso), S3_ISO_DATETIME_FORMAT, &expected);
+    strftime(gmt, sizeof(gmt), S3_GMT_DATETIME_FORMAT, &expected);
+
+    S3DateTime from_iso;
+    from_iso.init_with_iso(iso);
+    EXPECT_EQ(iso, from_iso.get_isoformat_string());
+    EXPECT_EQ(gmt, from_iso.get_gmtformat_string());
+
+    struct tm parsed, by_strptime;
+    memset(&by_strptime, 0, sizeof(by_strptime));
+    strptime(gmt, S3_GMT_DATETIME_FORMAT, &by_strptime);
+    ASSERT_TRUE(parse_gmt_test(gmt, parsed)) << gmt;
+    EXPECT_EQ(by_strptime.tm_yday, parsed.tm_yday) << gmt;
+    EXPECT_EQ(by_strptime.tm_wday, parsed.tm_wday) << gmt;
+    EXPECT_EQ(0, memcmp(&by_strptime, &parsed, sizeof(parsed))) << gmt;
+  }
+}
+
+TEST_F(S3DateTimeTest, ParseISOFmtTest) {
+  struct tm parsed;
+  ASSERT_TRUE(parse_iso_test("2016-02-29T23:59:60.123Z", parsed));
+  EXPECT_EQ(116, parsed.tm_year);
+  EXPECT_EQ(1, parsed.tm_mon);
+  EXPECT_EQ(29, parsed.tm_mday);
+  EXPECT_EQ(59, parsed.tm_yday);
+  EXPECT_EQ(1, parsed.tm_wday);
+  EXPECT_EQ(60, parsed.tm_sec);
+  EXPECT_TRUE(parse_iso_test("2017-01-28T13:15:30Z", parsed));
+
+  EXPECT_FALSE(parse_iso_test("", parsed));
+  EXPECT_FALSE(parse_iso_test("2017-01-28 13:15:30Z", parsed));
+  EXPECT_FALSE(parse_iso_test("2017-13-28T13:15:30.000Z", parsed));
+  EXPECT_FALSE(parse_iso_test("2017-01-28T24:15:30.000Z", parsed));
+  EXPECT_FALSE(parse_iso_test("2017-01-28T13:15:30.Z", parsed));
+  EXPECT_FALSE(parse_iso_test("2017-01-28T13:15:30.000Z+", parsed));
+}
+
+TEST_F(S3DateTimeTest, ParseGMTFmtTest) {
+  struct tm parsed;
+  ASSERT_TRUE(parse_gmt_test("Sat, 28 Jan 2017 13:15:30 GMT", parsed));
+  EXPECT_EQ(6, parsed.tm_wday);
+  EXPECT_EQ(27, parsed.tm_yday);
+  // Full names and any case, as strptime accepts.
+  ASSERT_TRUE(parse_gmt_test("sunday, 29 JANUARY 2017 08:05:01 GMT", parsed));
+  EXPECT_EQ(0, parsed.tm_wday);
+  EXPECT_EQ(0, parsed.tm_mon);
+
+  EXPECT_FALSE(parse_gmt_test("Sat 28 Jan 2017 13:15:30 GMT", parsed));
+  EXPECT_FALSE(parse_gmt_test("Sat, 28 Jan 2017 13:15:30", parsed));
+  EXPECT_FALSE(parse_gmt_test("Sat, 28 Jab 2017 13:15:30 GMT", parsed));
+  EXPECT_FALSE(parse_gmt_test("Sat, 32 Jan 2017 13:15:30 GMT", parsed));
+}
+
+// Input which is not parsed by hand falls back to strptime.
+TEST_F(S3DateTimeTest, InvalidISOFallsBack) {
+  s3dateobj_ptr->init_with_iso("");
+  EXPECT_EQ("1900-01-00T00:00:00.000Z", s3dateobj_ptr->get_isoformat_string());
+  EXPECT_EQ("Sun, 00 Jan 1900 00:00:00 GMT",
+            s3dateobj_ptr->get_gmtformat_string());
+}
+
+TEST_F(S3DateTimeTest, CurrentTimeIsCached) {
+  S3DateTime first, second;
+  time_t now;
+  // Both must be initialised within the same second.
+  do {
+    now = time(NULL);
+    first.init_current_time();
+    second.init_current_time();
+  } while (time(NULL) != now);
+  const std::string iso = first.get_isoformat_string();
+  EXPECT_EQ(iso, second.get_isoformat_string());
+
+  struct tm expected;
+  char buf[100];
+  gmtime_r(&now, &expected);
+  strftime(buf, sizeof(buf), S3_ISO_DATETIME_FORMAT, &expected);
+  EXPECT_EQ(buf, iso);
+
+  second.init_with_iso("2017-01-28T13:15:30.000Z");
+  EXPECT_EQ("2017-01-28T13:15:30.000Z", second.get_isoformat_string());
+}
+
+// Prints the cost of ISO to GMT conversion of Last-Modified.  Disabled, run
+// with --gtest_also_run_disabled_tests.
+TEST(S3DateTimeBenchmark, DISABLED_LastModifiedGmt) {
+  const int count = 200000;
+  const char *iso = "2020-06-15T10:20:30.000Z";
+  size_t length = 0;
+
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < count; ++i) {
+    struct tm point_in_time;
+    char buf[100];
+    memset(&point_in_time, 0, sizeof(point_in_time));
+    strptime(iso, S3_ISO_DATETIME_FORMAT, &point_in_time);
+    strftime(buf, sizeof(buf), S3_GMT_DATETIME_FORMAT, &point_in_time);
+    length += strlen(buf);
+  }
+  const double libc_ns =
+      std::chrono::duration<double, std::nano>(
+          std::chrono::steady_clock::now() - start).count() / count;
+
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < count; ++i) {
+    S3DateTime date_time;
+    date_time.init_with_iso(iso);
+    length += date_time.get_gmtformat_string().length();
+  }
+  const double fast_ns =
+      std::chrono::duration<double, std::nano>(
+          std::chrono::steady_clock::now() - start).count() / count;
+
+  EXPECT_EQ((size_t)count * 2 * 29, length);
+  printf("ISO to GMT: strptime/strftime %.1f ns, S3DateTime %.1f ns\n",
+         libc_ns, fast_ns);
+}
@@ -18,6 +18,9 @@
  *
  */
 
+#include <chrono>
+#include <cstdio>
+
 #include "gtest/gtest.h"
 
 #include "libxml/parser.h"
@@ -143,3 +146,69 @@ TEST_F(S3ErrorTest, Negative) {
   EXPECT_EQ(520, error.get_http_status_code());
   EXPECT_EQ(expected_response, error.to_xml());
 }
+
+TEST_F(S3ErrorTest, NoDeclaration) {
+  S3Error error("NoSuchKey", "dummy-request-id", "/bucket/key");
+  EXPECT_EQ(
+      "<Error>\n"
+      "<Code>NoSuchKey</Code>"
+      "<Message>The specified key does not exist.</Message>"
+      "<Resource>/bucket/key</Resource>"
+      "<RequestId>dummy-request-id</RequestId>"
+      "</Error>\n",
+      error.to_xml(true));
+  // Same XML when rendered again.
+  EXPECT_EQ(error.to_xml(true), error.to_xml(true));
+}
+
+TEST_F(S3ErrorTest, EscapesResourceAndRequestId) {
+  S3Error error("NoSuchKey", "id\"1", "/bucket/a&b<c>");
+  std::string xml_content = error.to_xml();
+  is_valid_xml(xml_content);
+  has_element_with_value(xml_content, "Resource", "/bucket/a&b<c>");
+  has_element_with_value(xml_content, "RequestId", "id\"1");
+
+  S3Error no_resource("NoSuchKey", "dummy-request-id");
+  EXPECT_NE(std::string::npos, no_resource.to_xml().find("<Resource/>"));
+}
+
+TEST_F(S3ErrorTest, AuthErrorMessage) {
+  S3Error error("AccessDenied", "dummy-request-id", "SomeBucketName");
+  error.set_auth_error_message("Policy <denies> access");
+  EXPECT_EQ(
+      "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+      "<Error>\n"
+      "<Code>AccessDenied</Code>"
+      "<Message>Policy &lt;denies&gt; access</Message>"
+      "<Resource>SomeBucketName</Resource>"
+      "<RequestId>dummy-request-id</RequestId>"
+      "</Error>\n",
+      error.to_xml());
+  EXPECT_EQ(403, error.get_http_status_code());
+}
+
+TEST_F(S3ErrorTest, EmptyMessage) {
+  // s3_error_messages.json has no "Description" for InvalidObjectState.
+  S3Error error("InvalidObjectState", "dummy-request-id", "SomeBucketName");
+  std::string xml_content = error.to_xml();
+  is_valid_xml(xml_content);
+  EXPECT_NE(std::string::npos, xml_content.find("<Message/>"));
+  EXPECT_EQ(403, error.get_http_status_code());
+}
+
+// Prints the cost of a 404 error response body, e.g. for HEAD of missing
+// objects.  Disabled, run with --gtest_also_run_disabled_tests.
+TEST_F(S3ErrorTest, DISABLED_Benchmark) {
+  const int n_errors = 100000;
+  size_t total_length = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < n_errors; ++i) {
+    S3Error error("NoSuchKey", "4442587F-B7D0-A2F9-0000-000000000000",
+                  "/mybucket/myfoto.jpg");
+    total_length += error.to_xml().length();
+  }
+  const double ns = std::chrono::duration<double, std::nano>(
+                        std::chrono::steady_clock::now() - start).count();
+  printf("S3Error::to_xml: %.0f ns per error response\n", ns / n_errors);
+  EXPECT_LT(0, total_length);
+}
@@ -20,50 +20,67 @@
 
 #include <json/json.h>
 #include <fstream>
-#include <iostream>
+#include <string>
 
 #include <gtest/gtest.h>
+#include "s3_common_utilities.h"
 #include "s3_error_messages.h"
-/* /opt/seagate/cortx/s3/resources/s3_error_messages.json */
 
-TEST(S3ErrorDetailsTest, DefaultConstructor) {
-  S3ErrorDetails error_msg;
-  EXPECT_EQ(520, error_msg.http_return_code);
-  EXPECT_STREQ("Unknown Error", error_msg.description.c_str());
+TEST(S3ErrorDetailsTest, Unknown) {
+  const S3ErrorDetails& details = s3_error_details(S3ErrorCode::unknown);
+  EXPECT_EQ(520, details.get_http_status_code());
+  EXPECT_STREQ("Unknown Error", details.get_message());
+  EXPECT_EQ(0, details.xml_head_length);
 }
 
-TEST(S3ErrorDetailsTest, ConstructorWithMsg) {
-  S3ErrorDetails error_msg("message", 1);
-  EXPECT_EQ(1, error_msg.http_return_code);
-  EXPECT_STREQ("message", error_msg.description.c_str());
+TEST(S3ErrorMessagesTest, GetDetails) {
+  const S3ErrorDetails& details = s3_error_details("AccessDenied");
+  EXPECT_STREQ("Access Denied", details.get_message());
+  EXPECT_EQ(403, details.get_http_status_code());
+  EXPECT_EQ(&details, &s3_error_details(S3ErrorCode::AccessDenied));
 }
 
-TEST(S3ErrorDetailsTest, Get) {
-  S3ErrorDetails error_msg("message2", 500);
-  std::string desc = error_msg.get_message();
-  int returncode = error_msg.get_http_status_code();
-  EXPECT_EQ(500, returncode);
-  EXPECT_STREQ("message2", desc.c_str());
+TEST(S3ErrorMessagesTest, CodeFromString) {
+  EXPECT_EQ(S3ErrorCode::NoSuchKey, s3_error_code_from_string("NoSuchKey"));
+  for (unsigned i = 0; i < (unsigned)S3ErrorCode::unknown; ++i) {
+    const S3ErrorCode code = (S3ErrorCode)i;
+    EXPECT_EQ(code, s3_error_code_from_string(s3_error_details(code).code));
+  }
+  EXPECT_EQ(S3ErrorCode::unknown, s3_error_code_from_string(""));
+  EXPECT_EQ(S3ErrorCode::unknown, s3_error_code_from_string("nosuchkey"));
+  EXPECT_EQ(S3ErrorCode::unknown, s3_error_code_from_string("NoSuchKeys"));
+  EXPECT_EQ(S3ErrorCode::unknown,
+            s3_error_code_from_string(std::string("NoSuchKey\0", 10)));
+  EXPECT_EQ(S3ErrorCode::unknown, s3_error_code_from_string("ZZZ"));
 }
 
-TEST(S3ErrorMessagesTest, SingletonCheck) {
-  S3ErrorMessages *inst1 = S3ErrorMessages::get_instance();
-  S3ErrorMessages *inst2 = S3ErrorMessages::get_instance();
-  EXPECT_EQ(inst1, inst2);
-}
+// server/s3_error_table.h has to be regenerated after the JSON is changed.
+TEST(S3ErrorMessagesTest, MatchesJsonResource) {
+  Json::Value jsonroot;
+  Json::Reader reader;
+  std::ifstream json_file("resources/s3_error_messages.json",
+                          std::ifstream::binary);
+  ASSERT_TRUE(reader.parse(json_file, jsonroot));
 
-TEST(S3ErrorMessagesTest, Constructor) {
-  S3ErrorMessages *inst = S3ErrorMessages::get_instance();
-  ASSERT_TRUE(inst->error_list.size() != 0);
+  EXPECT_EQ(jsonroot.size(), (unsigned)S3ErrorCode::unknown);
+  for (const auto& code : jsonroot.getMemberNames()) {
+    const S3ErrorDetails& details = s3_error_details(code);
+    EXPECT_EQ(code, details.code);
+    EXPECT_EQ(jsonroot[code]["Description"].asString(),
+              details.get_message());
+    EXPECT_EQ(jsonroot[code]["httpcode"].asInt(),
+              details.get_http_status_code());
+  }
 }
 
-TEST(S3ErrorMessagesTest, GetDetails) {
-  S3ErrorMessages *inst = S3ErrorMessages::get_instance();
-  std::string errdesc;
-  int httpcode;
-  S3ErrorDetails errdetails = inst->get_details("AccessDenied");
-  errdesc = errdetails.get_message();
-  httpcode = errdetails.get_http_status_code();
-  EXPECT_STREQ("Access Denied", errdesc.c_str());
-  EXPECT_EQ(403, httpcode);
+TEST(S3ErrorMessagesTest, PreRenderedXml) {
+  for (unsigned i = 0; i < (unsigned)S3ErrorCode::unknown; ++i) {
+    const S3ErrorDetails& details = s3_error_details((S3ErrorCode)i);
+    const std::string expected =
+        "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<Error>\n" +
+        S3CommonUtilities::format_xml_string("Code", details.code) +
+        S3CommonUtilities::format_xml_string("Message", details.description);
+    EXPECT_EQ(expected,
+              std::string(details.xml_head, details.xml_head_length));
+  }
 }
@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <stdlib.h>
+
+#include <string>
+#include <vector>
+
+#include "s3_fake_motr_kvs.h"
+
+// Keys and values of one fake KVS operation.
+class FakeKvsOp {
+  std::vector<m0_bcount_t> key_counts, value_counts;
+  std::vector<void *> key_bufs, value_bufs;
+  struct m0_bufvec keys, values;
+
+ public:
+  std::vector<int> rcs;
+  struct s3_motr_kvs_op_context ctx;
+
+  explicit FakeKvsOp(size_t nr)
+      : key_counts(nr),
+        value_counts(nr),
+        key_bufs(nr),
+        value_bufs(nr),
+        rcs(nr, 1) {
+    keys.ov_vec.v_nr = values.ov_vec.v_nr = nr;
+    keys.ov_vec.v_count = key_counts.data();
+    keys.ov_buf = key_bufs.data();
+    values.ov_vec.v_count = value_counts.data();
+    values.ov_buf = value_bufs.data();
+    ctx.keys = &keys;
+    ctx.values = &values;
+    ctx.rcs = rcs.data();
+    ctx.flags = 0;
+  }
+
+  ~FakeKvsOp() {
+    for (size_t i = 0; i < key_bufs.size(); ++i) {
+      free(key_bufs[i]);
+      free(value_bufs[i]);
+    }
+  }
+
+  void set(size_t i, const std::string &key, const std::string &value = "") {
+    key_counts[i] = key.size();
+    key_bufs[i] = strdup(key.c_str());
+    value_counts[i] = value.size();
+    value_bufs[i] = value.empty() ? nullptr : strdup(value.c_str());
+  }
+
+  std::string key(size_t i) const {
+    return std::string((const char *)key_bufs[i], key_counts[i]);
+  }
+
+  std::string value(size_t i) const {
+    return std::string((const char *)value_bufs[i], value_counts[i]);
+  }
+};
+
+class S3FakeMotrKvsTest : public testing::Test {
+ protected:
+  S3FakeMotrKvs *kvs = S3FakeMotrKvs::instance();
+  struct m0_uint128 oid;
+
+  void SetUp() {
+    // Each test uses its own index.
+    static uint64_t last_lo = 0;
+    oid.u_hi = 0xfa4e;
+    oid.u_lo = ++last_lo;
+  }
+
+  void put(const std::vector<std::string> &keys) {
+    FakeKvsOp op(keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+      op.set(i, keys[i], "v" + keys[i]);
+    }
+    ASSERT_EQ(0, kvs->kv_write(oid, op.ctx));
+    EXPECT_EQ(std::vector<int>(keys.size(), 0), op.rcs);
+  }
+};
+
+TEST_F(S3FakeMotrKvsTest, MissingIndex) {
+  FakeKvsOp op(1);
+  op.set(0, "key");
+  EXPECT_EQ(-ENOENT, kvs->kv_read(oid, op.ctx));
+  EXPECT_EQ(-ENOENT, kvs->kv_del(oid, op.ctx));
+  FakeKvsOp next_op(1);
+  EXPECT_EQ(-ENOENT, kvs->kv_next(oid, next_op.ctx));
+}
+
+TEST_F(S3FakeMotrKvsTest, BatchReadDelete) {
+  put({"b", "a", "c"});
+
+  FakeKvsOp read_op(3);
+  read_op.set(0, "c");
+  read_op.set(1, "missing");
+  read_op.set(2, "a");
+  ASSERT_EQ(0, kvs->kv_read(oid, read_op.ctx));
+  EXPECT_EQ(std::vector<int>({0, -ENOENT, 0}), read_op.rcs);
+  EXPECT_EQ("vc", read_op.value(0));
+  EXPECT_EQ("va", read_op.value(2));
+
+  FakeKvsOp del_op(2);
+  del_op.set(0, "a");
+  del_op.set(1, "missing");
+  ASSERT_EQ(0, kvs->kv_del(oid, del_op.ctx));
+  EXPECT_EQ(std::vector<int>({0, -ENOENT}), del_op.rcs);
+}
+
+TEST_F(S3FakeMotrKvsTest, NextKeyval) {
+  put({"dir/a", "dir/b", "dir/c", "dir0", "e"});
+
+  // From the first key.
+  FakeKvsOp first_op(2);
+  ASSERT_EQ(0, kvs->kv_next(oid, first_op.ctx));
+  EXPECT_EQ(std::vector<int>({0, 0}), first_op.rcs);
+  EXPECT_EQ("dir/a", first_op.key(0));
+  EXPECT_EQ("dir/b", first_op.key(1));
+  EXPECT_EQ("vdir/b", first_op.value(1));
+
+  // Start key is kept by the caller.
+  std::string start_key = "dir/b";
+  FakeKvsOp exclude_op(3);
+  exclude_op.ctx.keys->ov_vec.v_count[0] = start_key.size();
+  exclude_op.ctx.keys->ov_buf[0] = &start_key[0];
+  exclude_op.ctx.flags = M0_OIF_EXCLUDE_START_KEY;
+  ASSERT_EQ(0, kvs->kv_next(oid, exclude_op.ctx));
+  EXPECT_EQ("dir/c", exclude_op.key(0));
+  EXPECT_EQ("dir0", exclude_op.key(1));
+  EXPECT_EQ("e", exclude_op.key(2));
+
+  // Prefix which is not a key, as GET bucket with prefix does.
+  start_key = "dir/";
+  FakeKvsOp prefix_op(5);
+  prefix_op.ctx.keys->ov_vec.v_count[0] = start_key.size();
+  prefix_op.ctx.keys->ov_buf[0] = &start_key[0];
+  ASSERT_EQ(0, kvs->kv_next(oid, prefix_op.ctx));
+  EXPECT_EQ(std::vector<int>({0, 0, 0, 0, 0}), prefix_op.rcs);
+  EXPECT_EQ("dir/a", prefix_op.key(0));
+  EXPECT_EQ("e", prefix_op.key(4));
+
+  // Included start key, and the end of the index.
+  start_key = "dir0";
+  FakeKvsOp end_op(3);
+  end_op.ctx.keys->ov_vec.v_count[0] = start_key.size();
+  end_op.ctx.keys->ov_buf[0] = &start_key[0];
+  ASSERT_EQ(0, kvs->kv_next(oid, end_op.ctx));
+  EXPECT_EQ(std::vector<int>({0, 0, -ENOENT}), end_op.rcs);
+  EXPECT_EQ("dir0", end_op.key(0));
+  EXPECT_EQ("e", end_op.key(1));
+  EXPECT_EQ(nullptr, end_op.ctx.keys->ov_buf[2]);
+}
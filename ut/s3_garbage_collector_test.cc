@@ -0,0 +1,273 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <json/json.h>
+
+#include "mock_event_wrapper.h"
+#include "mock_motr_request_object.h"
+#include "mock_s3_factory.h"
+#include "mock_s3_motr_wrapper.h"
+#include "s3_garbage_collector.h"
+#include "s3_m0_uint128_helper.h"
+#include "s3_probable_delete_record.h"
+
+using ::testing::_;
+using ::testing::AtLeast;
+using ::testing::Return;
+using ::testing::ReturnRef;
+
+static std::string make_record(const struct m0_uint128 &old_oid,
+                               const struct m0_uint128 &oid,
+                               bool force_delete = false,
+                               bool is_multipart = false) {
+  S3ProbableDeleteRecord record(
+      S3M0Uint128Helper::to_string(oid), old_oid, "obj1", oid, 9,
+      {0x11, 0x22}, {0x33, 0x44}, "obj1/version", force_delete, is_multipart,
+      {0x55, 0x66});
+  return record.to_json();
+}
+
+// Moves create_timestamp of the record well into the past.
+static std::string make_old_record(const std::string &json) {
+  Json::Value root;
+  Json::Reader reader;
+  reader.parse(json, root);
+  root["create_timestamp"] = "2020-01-01T00:00:00.000Z";
+  Json::FastWriter writer;
+  return writer.write(root);
+}
+
+class S3GCTokenBucketTest : public testing::Test {};
+
+TEST_F(S3GCTokenBucketTest, ConsumesBurstThenRefills) {
+  auto now = std::chrono::steady_clock::now();
+  S3GCTokenBucket bucket(10, 5, now);
+
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_TRUE(bucket.try_consume(1, now));
+  }
+  EXPECT_FALSE(bucket.try_consume(1, now));
+
+  // 10 tokens/sec, so 200ms gives 2 tokens.
+  now += std::chrono::milliseconds(200);
+  EXPECT_TRUE(bucket.try_consume(1, now));
+  EXPECT_TRUE(bucket.try_consume(1, now));
+  EXPECT_FALSE(bucket.try_consume(1, now));
+
+  // Never accumulates above burst.
+  now += std::chrono::seconds(10);
+  bucket.refill(now);
+  EXPECT_DOUBLE_EQ(5, bucket.get_available_tokens());
+}
+
+TEST_F(S3GCTokenBucketTest, ZeroRateIsUnlimited) {
+  auto now = std::chrono::steady_clock::now();
+  S3GCTokenBucket bucket(0, 1, now);
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_TRUE(bucket.try_consume(1, now));
+  }
+}
+
+class S3GCProbableDeleteEntryTest : public testing::Test {
+ protected:
+  struct m0_uint128 old_oid = {0x1234, 0x5678};
+  struct m0_uint128 new_oid = {0x8765, 0x4321};
+  struct m0_uint128 zero_oid = {0ULL, 0ULL};
+};
+
+TEST_F(S3GCProbableDeleteEntryTest, ParsesNewObjectRecord) {
+  std::string key = "I" + S3M0Uint128Helper::to_string(new_oid);
+  S3GCProbableDeleteEntry entry;
+
+  ASSERT_TRUE(entry.from_json(key, make_record(old_oid, new_oid)));
+  EXPECT_EQ(new_oid.u_hi, entry.oid.u_hi);
+  EXPECT_EQ(new_oid.u_lo, entry.oid.u_lo);
+  EXPECT_EQ(old_oid.u_hi, entry.old_oid.u_hi);
+  EXPECT_EQ(old_oid.u_lo, entry.old_oid.u_lo);
+  EXPECT_FALSE(entry.is_old_object_record());
+  EXPECT_EQ(9, entry.layout_id);
+  EXPECT_EQ("obj1", entry.object_key_in_index);
+  EXPECT_EQ(0x11ULL, entry.object_list_idx_oid.u_hi);
+  EXPECT_EQ("obj1/version", entry.version_key_in_index);
+  EXPECT_FALSE(entry.force_delete);
+  EXPECT_FALSE(entry.is_multipart);
+  EXPECT_NE(0, entry.create_time);
+}
+
+TEST_F(S3GCProbableDeleteEntryTest, ParsesFreshPutRecord) {
+  // PUT without an old object also writes zero old_oid.
+  std::string key = "I" + S3M0Uint128Helper::to_string(new_oid);
+  S3GCProbableDeleteEntry entry;
+
+  ASSERT_TRUE(entry.from_json(key, make_record(zero_oid, new_oid)));
+  EXPECT_EQ(new_oid.u_hi, entry.oid.u_hi);
+  EXPECT_FALSE(entry.is_old_object_record());
+  EXPECT_EQ(S3GCAction::skip, entry.decide(false, zero_oid));
+}
+
+TEST_F(S3GCProbableDeleteEntryTest, ParsesOldObjectRecord) {
+  // key = oldoid + "-" + newoid, record holds zero old_oid.
+  std::string key = "I" + S3M0Uint128Helper::to_string(old_oid) + "-" +
+                    S3M0Uint128Helper::to_string(new_oid);
+  S3GCProbableDeleteEntry entry;
+
+  ASSERT_TRUE(entry.from_json(key, make_record(zero_oid, old_oid, true)));
+  EXPECT_EQ(old_oid.u_hi, entry.oid.u_hi);
+  EXPECT_EQ(old_oid.u_lo, entry.oid.u_lo);
+  EXPECT_TRUE(entry.is_old_object_record());
+  EXPECT_TRUE(entry.force_delete);
+}
+
+TEST_F(S3GCProbableDeleteEntryTest, ParsesMultipartRecord) {
+  std::string key = "I" + S3M0Uint128Helper::to_string(new_oid);
+  S3GCProbableDeleteEntry entry;
+
+  ASSERT_TRUE(
+      entry.from_json(key, make_record(zero_oid, new_oid, false, true)));
+  EXPECT_TRUE(entry.is_multipart);
+  EXPECT_EQ(0x55ULL, entry.part_list_idx_oid.u_hi);
+  EXPECT_EQ(0x66ULL, entry.part_list_idx_oid.u_lo);
+}
+
+TEST_F(S3GCProbableDeleteEntryTest, RejectsInvalidRecord) {
+  S3GCProbableDeleteEntry entry;
+  std::string key = "I" + S3M0Uint128Helper::to_string(new_oid);
+
+  EXPECT_FALSE(entry.from_json(key, "{invalid json"));
+  EXPECT_FALSE(entry.from_json("I", make_record(old_oid, new_oid)));
+  EXPECT_FALSE(entry.from_json("Inodash", make_record(old_oid, new_oid)));
+}
+
+TEST_F(S3GCProbableDeleteEntryTest, Decide) {
+  S3GCProbableDeleteEntry entry;
+  entry.oid = old_oid;
+
+  // Old object record
+  entry.old_object_record = true;
+  entry.old_oid = zero_oid;
+  EXPECT_EQ(S3GCAction::delete_object, entry.decide(false, zero_oid));
+  EXPECT_EQ(S3GCAction::delete_object, entry.decide(true, new_oid));
+  EXPECT_EQ(S3GCAction::skip, entry.decide(true, old_oid));
+
+  // New object record of an overwrite
+  entry.old_object_record = false;
+  entry.oid = new_oid;
+  entry.old_oid = old_oid;
+  EXPECT_EQ(S3GCAction::drop_record, entry.decide(true, new_oid));
+  EXPECT_EQ(S3GCAction::skip, entry.decide(true, old_oid));
+  EXPECT_EQ(S3GCAction::skip, entry.decide(false, zero_oid));
+
+  // New object record of a fresh PUT, metadata may be not saved yet.
+  entry.old_oid = zero_oid;
+  EXPECT_EQ(S3GCAction::drop_record, entry.decide(true, new_oid));
+  EXPECT_EQ(S3GCAction::skip, entry.decide(false, zero_oid));
+
+  entry.is_multipart = true;
+  EXPECT_EQ(S3GCAction::skip, entry.decide(true, new_oid));
+
+  entry.force_delete = true;
+  EXPECT_EQ(S3GCAction::delete_object, entry.decide(true, new_oid));
+}
+
+class S3GarbageCollectorTest : public testing::Test {
+ protected:
+  S3GarbageCollectorTest() {
+    evhtp_request_t *req = NULL;
+    ptr_mock_request =
+        std::make_shared<MockMotrRequestObject>(req, new EvhtpWrapper());
+    ptr_mock_s3_motr_api = std::make_shared<MockS3Motr>();
+    motr_kvs_reader_factory = std::make_shared<MockS3MotrKVSReaderFactory>(
+        ptr_mock_request, ptr_mock_s3_motr_api);
+    motr_kvs_writer_factory = std::make_shared<MockS3MotrKVSWriterFactory>(
+        ptr_mock_request, ptr_mock_s3_motr_api);
+    motr_writer_factory = std::make_shared<MockS3MotrWriterFactory>(
+        ptr_mock_request, ptr_mock_s3_motr_api);
+
+    gc.reset(new S3GarbageCollector(
+        std::make_shared<MockEventWrapper>(), nullptr, ptr_mock_request,
+        motr_kvs_reader_factory, motr_kvs_writer_factory, motr_writer_factory,
+        ptr_mock_s3_motr_api));
+  }
+
+  std::shared_ptr<MockMotrRequestObject> ptr_mock_request;
+  std::shared_ptr<MockS3Motr> ptr_mock_s3_motr_api;
+  std::shared_ptr<MockS3MotrKVSReaderFactory> motr_kvs_reader_factory;
+  std::shared_ptr<MockS3MotrKVSWriterFactory> motr_kvs_writer_factory;
+  std::shared_ptr<MockS3MotrWriterFactory> motr_writer_factory;
+  std::unique_ptr<S3GarbageCollector> gc;
+};
+
+TEST_F(S3GarbageCollectorTest, ScanQueuesOnlyOldRecords) {
+  struct m0_uint128 oid1 = {0x1, 0x1};
+  struct m0_uint128 oid2 = {0x2, 0x2};
+  struct m0_uint128 zero_oid = {0ULL, 0ULL};
+  std::map<std::string, std::pair<int, std::string>> kvs;
+  kvs["I" + S3M0Uint128Helper::to_string(oid1)] =
+      std::make_pair(0, make_old_record(make_record(zero_oid, oid1)));
+  // Fresh record, may belong to request in progress.
+  kvs["I" + S3M0Uint128Helper::to_string(oid2)] =
+      std::make_pair(0, make_record(zero_oid, oid2));
+  kvs["Igarbage"] = std::make_pair(0, "{}");
+
+  EXPECT_CALL(*(motr_kvs_reader_factory->mock_motr_kvs_reader),
+              next_keyval(_, "", gc->batch_size, _, _, _)).Times(1);
+  EXPECT_CALL(*(motr_kvs_reader_factory->mock_motr_kvs_reader),
+              get_key_values()).WillRepeatedly(ReturnRef(kvs));
+
+  gc->scan_next_batch();
+  EXPECT_TRUE(gc->scan_in_progress);
+
+  // Do not start processing, only check what is queued.
+  gc->stop();
+  gc->scan_next_batch_successful();
+
+  EXPECT_FALSE(gc->scan_in_progress);
+  ASSERT_EQ(1, gc->pending.size());
+  EXPECT_EQ(oid1.u_hi, gc->pending.front().oid.u_hi);
+  // Less than batch size returned - pass is complete.
+  EXPECT_TRUE(gc->marker.empty());
+  EXPECT_EQ(3, gc->get_backlog());
+}
+
+TEST_F(S3GarbageCollectorTest, DispatchHonoursMaxInflight) {
+  size_t records = gc->max_inflight + 2;
+  for (size_t i = 0; i < records; ++i) {
+    S3GCProbableDeleteEntry entry;
+    entry.record_key = "I" + std::to_string(i);
+    entry.oid = {i + 1, i + 1};
+    entry.force_delete = true;
+    gc->pending.push_back(entry);
+  }
+
+  // Deletes are never completed, so only max_inflight must be launched.
+  EXPECT_CALL(*(motr_writer_factory->mock_motr_writer),
+              delete_object(_, _, _, _, _)).Times(gc->max_inflight);
+
+  EXPECT_TRUE(gc->is_idle());
+  gc->dispatch();
+
+  EXPECT_EQ(gc->max_inflight, gc->inflight);
+  EXPECT_EQ(2, gc->pending.size());
+  // s3_gc_fini has to wait for them.
+  EXPECT_FALSE(gc->is_idle());
+}
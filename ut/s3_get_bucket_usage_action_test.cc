@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#include <memory>
+
+#include <json/json.h>
+
+#include "mock_s3_factory.h"
+#include "s3_error_codes.h"
+#include "s3_get_bucket_usage_action.h"
+#include "s3_test_utils.h"
+
+using ::testing::_;
+using ::testing::AtLeast;
+using ::testing::Return;
+using ::testing::ReturnRef;
+
+class S3GetBucketUsageActionTest : public testing::Test {
+ protected:
+  S3GetBucketUsageActionTest() {
+    evhtp_request_t *req = NULL;
+    EvhtpInterface *evhtp_obj_ptr = new EvhtpWrapper();
+    ptr_mock_request =
+        std::make_shared<MockS3RequestObject>(req, evhtp_obj_ptr);
+    bucket_meta_factory =
+        std::make_shared<MockS3BucketMetadataFactory>(ptr_mock_request);
+
+    std::map<std::string, std::string> input_headers;
+    EXPECT_CALL(*ptr_mock_request, get_in_headers_copy()).Times(1).WillOnce(
+        ReturnRef(input_headers));
+    EXPECT_CALL(*ptr_mock_request, get_audit_info())
+        .WillRepeatedly(ReturnRef(audit_info));
+    EXPECT_CALL(*ptr_mock_request, c_get_full_path())
+        .WillRepeatedly(Return(S3_BUCKET_USAGE_PATH));
+    S3Option::get_instance()->disable_auth();
+    action_under_test.reset(
+        new S3GetBucketUsageAction(ptr_mock_request, bucket_meta_factory));
+  }
+
+  S3AuditInfo audit_info;
+  std::shared_ptr<S3GetBucketUsageAction> action_under_test;
+  std::shared_ptr<MockS3RequestObject> ptr_mock_request;
+  std::shared_ptr<MockS3BucketMetadataFactory> bucket_meta_factory;
+};
+
+TEST_F(S3GetBucketUsageActionTest, ConstructorTest) {
+  EXPECT_EQ(5, action_under_test->number_of_tasks());
+}
+
+TEST_F(S3GetBucketUsageActionTest, MissingBucketParameter) {
+  EXPECT_CALL(*ptr_mock_request, get_query_string_value("bucket"))
+      .WillOnce(Return(""));
+  EXPECT_CALL(*ptr_mock_request, set_out_header_value(_, _)).Times(AtLeast(1));
+  EXPECT_CALL(*ptr_mock_request, send_response(400, _)).Times(1);
+  action_under_test->validate_request();
+  EXPECT_FALSE(audit_info.get_publish_flag());
+}
+
+TEST_F(S3GetBucketUsageActionTest, BucketUsageDisabled) {
+  // Bucket usage is not initialized in unit tests.
+  EXPECT_CALL(*ptr_mock_request, get_query_string_value("bucket"))
+      .WillOnce(Return("seagatebucket"));
+  EXPECT_CALL(*ptr_mock_request, set_out_header_value(_, _)).Times(AtLeast(1));
+  EXPECT_CALL(*ptr_mock_request, send_response(501, _)).Times(1);
+  action_under_test->validate_request();
+}
+
+TEST_F(S3GetBucketUsageActionTest, FetchBucketInfoMissing) {
+  action_under_test->bucket_metadata =
+      bucket_meta_factory->mock_bucket_metadata;
+  EXPECT_CALL(*(bucket_meta_factory->mock_bucket_metadata), get_state())
+      .WillRepeatedly(Return(S3BucketMetadataState::missing));
+  EXPECT_CALL(*ptr_mock_request, set_out_header_value(_, _)).Times(AtLeast(1));
+  EXPECT_CALL(*ptr_mock_request, send_response(404, _)).Times(1);
+  action_under_test->fetch_bucket_info_failed();
+}
+
+TEST_F(S3GetBucketUsageActionTest, SendResponse) {
+  action_under_test->bucket_name = "seagatebucket";
+  action_under_test->usage.objects_count = 2;
+  action_under_test->usage.bytes_used = 2048;
+
+  std::string response;
+  EXPECT_CALL(*ptr_mock_request, set_out_header_value(_, _)).Times(AtLeast(1));
+  EXPECT_CALL(*ptr_mock_request, send_response(200, _))
+      .WillOnce(testing::SaveArg<1>(&response));
+  action_under_test->send_response_to_s3_client();
+
+  Json::Value root;
+  Json::Reader reader;
+  ASSERT_TRUE(reader.parse(response, root));
+  EXPECT_EQ("seagatebucket", root["bucket"].asString());
+  EXPECT_EQ(2, root["objects_count"].asInt64());
+  EXPECT_EQ(2048, root["bytes_used"].asInt64());
+}
+
+TEST_F(S3GetBucketUsageActionTest, AccessDeniedForOtherAccount) {
+  S3Option::get_instance()->enable_auth();
+  action_under_test->is_authorizationheader_present = true;
+  action_under_test->bucket_metadata =
+      bucket_meta_factory->mock_bucket_metadata;
+  ptr_mock_request->set_user_name("tester");
+  ptr_mock_request->set_account_id("12345");
+  EXPECT_CALL(*ptr_mock_request, set_out_header_value(_, _)).Times(AtLeast(1));
+  EXPECT_CALL(*ptr_mock_request, send_response(403, _)).Times(1);
+  action_under_test->fetch_bucket_info_successful();
+  S3Option::get_instance()->disable_auth();
+}
+
+TEST_F(S3GetBucketUsageActionTest, AccessDeniedForOtherAccountRoot) {
+  // Root user of an account which neither owns the bucket nor is the admin
+  // account.
+  S3Option::get_instance()->enable_auth();
+  S3Option::get_instance()->set_mgmt_api_admin_account_id("admin-account");
+  action_under_test->is_authorizationheader_present = true;
+  action_under_test->bucket_metadata =
+      bucket_meta_factory->mock_bucket_metadata;
+  ptr_mock_request->set_user_name("root");
+  ptr_mock_request->set_account_id("12345");
+  EXPECT_FALSE(action_under_test->is_bucket_usage_allowed());
+  EXPECT_CALL(*ptr_mock_request, set_out_header_value(_, _)).Times(AtLeast(1));
+  EXPECT_CALL(*ptr_mock_request, send_response(403, _)).Times(1);
+  action_under_test->fetch_bucket_info_successful();
+  S3Option::get_instance()->set_mgmt_api_admin_account_id("");
+  S3Option::get_instance()->disable_auth();
+}
+
+TEST_F(S3GetBucketUsageActionTest, AllowedForAdminAccountRoot) {
+  S3Option::get_instance()->enable_auth();
+  S3Option::get_instance()->set_mgmt_api_admin_account_id("12345");
+  action_under_test->is_authorizationheader_present = true;
+  action_under_test->bucket_metadata =
+      bucket_meta_factory->mock_bucket_metadata;
+  ptr_mock_request->set_user_name("root");
+  ptr_mock_request->set_account_id("12345");
+  EXPECT_TRUE(action_under_test->is_bucket_usage_allowed());
+  S3Option::get_instance()->set_mgmt_api_admin_account_id("");
+  S3Option::get_instance()->disable_auth();
+}
@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+#include <memory>
+
+#include "mock_s3_factory.h"
+#include "s3_error_codes.h"
+#include "s3_get_metrics_action.h"
+#include "s3_test_utils.h"
+
+using ::testing::_;
+using ::testing::AtLeast;
+using ::testing::Return;
+using ::testing::ReturnRef;
+
+class S3GetMetricsActionTest : public testing::Test {
+ protected:
+  S3GetMetricsActionTest() {
+    evhtp_request_t *req = NULL;
+    EvhtpInterface *evhtp_obj_ptr = new EvhtpWrapper();
+    ptr_mock_request =
+        std::make_shared<MockS3RequestObject>(req, evhtp_obj_ptr);
+
+    std::map<std::string, std::string> input_headers;
+    EXPECT_CALL(*ptr_mock_request, get_in_headers_copy()).Times(1).WillOnce(
+        ReturnRef(input_headers));
+    EXPECT_CALL(*ptr_mock_request, get_audit_info())
+        .WillRepeatedly(ReturnRef(audit_info));
+    S3Option::get_instance()->disable_auth();
+    action_under_test.reset(new S3GetMetricsAction(ptr_mock_request));
+  }
+
+  S3AuditInfo audit_info;
+  std::shared_ptr<S3GetMetricsAction> action_under_test;
+  std::shared_ptr<MockS3RequestObject> ptr_mock_request;
+};
+
+TEST_F(S3GetMetricsActionTest, ConstructorTest) {
+  EXPECT_EQ(2, action_under_test->number_of_tasks());
+}
+
+TEST_F(S3GetMetricsActionTest, UnknownPathIsNotFound) {
+  EXPECT_CALL(*ptr_mock_request, c_get_full_path())
+      .WillRepeatedly(Return("/stats"));
+  EXPECT_CALL(*ptr_mock_request, set_out_header_value(_, _)).Times(AtLeast(1));
+  EXPECT_CALL(*ptr_mock_request, send_response(404, _)).Times(1);
+  action_under_test->send_response_to_s3_client();
+  EXPECT_FALSE(audit_info.get_publish_flag());
+}
+
+TEST_F(S3GetMetricsActionTest, MetricsDisabled) {
+  // Metrics are not initialized in unit tests.
+  EXPECT_CALL(*ptr_mock_request, c_get_full_path())
+      .WillRepeatedly(Return(S3_METRICS_PATH));
+  EXPECT_CALL(*ptr_mock_request, set_out_header_value(_, _)).Times(AtLeast(1));
+  EXPECT_CALL(*ptr_mock_request, send_response(501, _)).Times(1);
+  action_under_test->send_response_to_s3_client();
+}
+
+TEST_F(S3GetMetricsActionTest, AccessDeniedForNonRootUser) {
+  S3Option::get_instance()->enable_auth();
+  ptr_mock_request->set_user_name("tester");
+  EXPECT_CALL(*ptr_mock_request, c_get_full_path())
+      .WillRepeatedly(Return(S3_METRICS_PATH));
+  EXPECT_CALL(*ptr_mock_request, set_out_header_value(_, _)).Times(AtLeast(1));
+  EXPECT_CALL(*ptr_mock_request, send_response(403, _)).Times(1);
+  action_under_test->send_response_to_s3_client();
+  S3Option::get_instance()->disable_auth();
+}
+
+TEST_F(S3GetMetricsActionTest, AccessDeniedWithoutAuthorization) {
+  // Root user name without Authorization header is not authenticated.
+  S3Option::get_instance()->enable_auth();
+  ptr_mock_request->set_user_name("root");
+  EXPECT_CALL(*ptr_mock_request, c_get_full_path())
+      .WillRepeatedly(Return(S3_METRICS_PATH));
+  EXPECT_CALL(*ptr_mock_request, set_out_header_value(_, _)).Times(AtLeast(1));
+  EXPECT_CALL(*ptr_mock_request, send_response(403, _)).Times(1);
+  action_under_test->send_response_to_s3_client();
+  S3Option::get_instance()->disable_auth();
+}
+
+TEST_F(S3GetMetricsActionTest, AccessDeniedForOtherAccountRoot) {
+  S3Option::get_instance()->enable_auth();
+  S3Option::get_instance()->set_mgmt_api_admin_account_id("admin-account");
+  action_under_test->is_authorizationheader_present = true;
+  ptr_mock_request->set_user_name("root");
+  ptr_mock_request->set_account_id("12345");
+  EXPECT_CALL(*ptr_mock_request, c_get_full_path())
+      .WillRepeatedly(Return(S3_METRICS_PATH));
+  EXPECT_CALL(*ptr_mock_request, set_out_header_value(_, _)).Times(AtLeast(1));
+  EXPECT_CALL(*ptr_mock_request, send_response(403, _)).Times(1);
+  action_under_test->send_response_to_s3_client();
+  S3Option::get_instance()->set_mgmt_api_admin_account_id("");
+  S3Option::get_instance()->disable_auth();
+}
+
+TEST_F(S3GetMetricsActionTest, AllowedForAdminAccountRoot) {
+  // Metrics are not initialized in unit tests, so an allowed request gets 501.
+  S3Option::get_instance()->enable_auth();
+  S3Option::get_instance()->set_mgmt_api_admin_account_id("admin-account");
+  action_under_test->is_authorizationheader_present = true;
+  ptr_mock_request->set_user_name("root");
+  ptr_mock_request->set_account_id("admin-account");
+  EXPECT_CALL(*ptr_mock_request, c_get_full_path())
+      .WillRepeatedly(Return(S3_METRICS_PATH));
+  EXPECT_CALL(*ptr_mock_request, set_out_header_value(_, _)).Times(AtLeast(1));
+  EXPECT_CALL(*ptr_mock_request, send_response(501, _)).Times(1);
+  action_under_test->send_response_to_s3_client();
+  S3Option::get_instance()->set_mgmt_api_admin_account_id("");
+  S3Option::get_instance()->disable_auth();
+}
@@ -20,7 +20,6 @@
 
 #include <memory>
 
-#include "mock_s3_bucket_metadata.h"
 #include "mock_s3_motr_wrapper.h"
 #include "mock_s3_factory.h"
 #include "s3_error_codes.h"
@@ -61,15 +60,19 @@ class S3GetServiceActionTest : public testing::Test {
     // Mock factories.
     motr_kvs_reader_factory = std::make_shared<MockS3MotrKVSReaderFactory>(
         ptr_mock_request, s3_motr_api_mock);
-    bucket_meta_factory =
-        std::make_shared<MockS3BucketMetadataFactory>(ptr_mock_request);
     std::map<std::string, std::string> input_headers;
     input_headers["Authorization"] = "1";
     EXPECT_CALL(*ptr_mock_request, get_in_headers_copy()).Times(1).WillOnce(
         ReturnRef(input_headers));
     // Object to be tested.
-    action_under_test.reset(new S3GetServiceAction(
-        ptr_mock_request, motr_kvs_reader_factory, bucket_meta_factory));
+    action_under_test.reset(
+        new S3GetServiceAction(ptr_mock_request, motr_kvs_reader_factory));
+  }
+
+  static std::string bucket_json(const std::string &name) {
+    return "{\"Bucket-Name\":\"" + name +
+           "\",\"System-Defined\":{\"Date\":\"2020-09-01T10:00:00.000Z\","
+           "\"Owner-Account-id\":\"12345\"},\"User-Defined\":{}}\n";
   }
 
   std::shared_ptr<MockS3Motr> s3_motr_api_mock;
@@ -77,7 +80,6 @@ class S3GetServiceActionTest : public testing::Test {
   std::shared_ptr<MockS3RequestObject> ptr_mock_request;
   std::shared_ptr<MockS3MotrKVSReaderFactory> motr_kvs_reader_factory;
   std::shared_ptr<MockS3AsyncBufferOptContainerFactory> async_buffer_factory;
-  std::shared_ptr<MockS3BucketMetadataFactory> bucket_meta_factory;
   struct m0_uint128 object_list_indx_oid;
   struct m0_uint128 oid;
   struct m0_uint128 zero_oid_idx;
@@ -103,11 +105,99 @@ TEST_F(S3GetServiceActionTest, GetNextBucketTest) {
 // Verify that GetNextBucketSuccessful list fetches correct count of bucket.
 TEST_F(S3GetServiceActionTest, GetNextBucketSuccessful) {
   result_keys_values.insert(
-      std::make_pair("testkey0", std::make_pair(0, "keyval")));
+      std::make_pair("testkey0", std::make_pair(0, bucket_json("bucket0"))));
+  result_keys_values.insert(
+      std::make_pair("testkey1", std::make_pair(0, bucket_json("bucket1"))));
+  result_keys_values.insert(
+      std::make_pair("testkey2", std::make_pair(0, bucket_json("bucket2"))));
+
+  EXPECT_CALL(*(motr_kvs_reader_factory->mock_motr_kvs_reader),
+              get_key_values()).WillRepeatedly(ReturnRef(result_keys_values));
+  action_under_test->motr_kv_reader =
+      motr_kvs_reader_factory->mock_motr_kvs_reader;
+  EXPECT_CALL(*ptr_mock_request, set_out_header_value(_, _)).Times(AtLeast(1));
+  EXPECT_CALL(*ptr_mock_request, send_response(200, _)).Times(AtLeast(1));
+
+  action_under_test->get_next_buckets_successful();
+
+  EXPECT_EQ(3, action_under_test->bucket_list.get_bucket_count());
+  std::string &response_xml = action_under_test->bucket_list.get_xml();
+  EXPECT_NE(std::string::npos,
+            response_xml.find("<Bucket><Name>bucket1</Name><CreationDate>"
+                              "2020-09-01T10:00:00.000Z</CreationDate>"
+                              "</Bucket>"));
+}
+
+TEST_F(S3GetServiceActionTest, GetNextBucketSkipsCorruptedMetadata) {
+  result_keys_values.insert(
+      std::make_pair("testkey0", std::make_pair(0, bucket_json("bucket0"))));
   result_keys_values.insert(
       std::make_pair("testkey1", std::make_pair(0, "keyval")));
+
+  EXPECT_CALL(*(motr_kvs_reader_factory->mock_motr_kvs_reader),
+              get_key_values()).WillRepeatedly(ReturnRef(result_keys_values));
+  action_under_test->motr_kv_reader =
+      motr_kvs_reader_factory->mock_motr_kvs_reader;
+  EXPECT_CALL(*ptr_mock_request, set_out_header_value(_, _)).Times(AtLeast(1));
+  EXPECT_CALL(*ptr_mock_request, send_response(200, _)).Times(AtLeast(1));
+
+  action_under_test->get_next_buckets_successful();
+
+  EXPECT_EQ(1, action_under_test->bucket_list.get_bucket_count());
+}
+
+// Full page means there may be more buckets, next page starts after the
+// last key.
+TEST_F(S3GetServiceActionTest, GetNextBucketFetchesNextPage) {
+  const int old_idx_fetch_count =
+      S3Option::get_instance()->get_motr_idx_fetch_count();
+  S3Option::get_instance()->set_motr_idx_fetch_count(2);
+  result_keys_values.insert(
+      std::make_pair("testkey0", std::make_pair(0, bucket_json("bucket0"))));
+  result_keys_values.insert(
+      std::make_pair("testkey1", std::make_pair(0, bucket_json("bucket1"))));
+
+  EXPECT_CALL(*(motr_kvs_reader_factory->mock_motr_kvs_reader),
+              get_key_values()).WillRepeatedly(ReturnRef(result_keys_values));
+  action_under_test->motr_kv_reader =
+      motr_kvs_reader_factory->mock_motr_kvs_reader;
+  EXPECT_CALL(*(motr_kvs_reader_factory->mock_motr_kvs_reader),
+              next_keyval(_, "testkey1", 2, _, _, _)).Times(1);
+  EXPECT_CALL(*ptr_mock_request, send_response(_, _)).Times(0);
+
+  action_under_test->get_next_buckets_successful();
+
+  EXPECT_EQ(2, action_under_test->bucket_list.get_bucket_count());
+  S3Option::get_instance()->set_motr_idx_fetch_count(old_idx_fetch_count);
+}
+
+TEST_F(S3GetServiceActionTest, InitializationServesCachedBuckets) {
+  S3BucketListCache cache(10, 60);
+  ptr_mock_request->set_account_id("12345");
+  cache.add("12345", cache.begin_load(),
+            {{"bucket0", "2020-09-01T10:00:00.000Z"},
+             {"bucket1", "2020-09-02T10:00:00.000Z"}});
+  action_under_test->bucket_list_cache = &cache;
+
+  EXPECT_CALL(*(motr_kvs_reader_factory->mock_motr_kvs_reader),
+              next_keyval(_, _, _, _, _, _)).Times(0);
+  EXPECT_CALL(*ptr_mock_request, set_out_header_value(_, _)).Times(AtLeast(1));
+  EXPECT_CALL(*ptr_mock_request, send_response(200, _)).Times(1);
+
+  action_under_test->initialization();
+
+  EXPECT_EQ(2, action_under_test->bucket_list.get_bucket_count());
+}
+
+TEST_F(S3GetServiceActionTest, GetNextBucketSuccessfulFillsCache) {
+  S3BucketListCache cache(10, 60);
+  ptr_mock_request->set_account_id("12345");
+  action_under_test->bucket_list_cache = &cache;
+  action_under_test->bucket_list_cache_token = cache.begin_load();
   result_keys_values.insert(
-      std::make_pair("testkey2", std::make_pair(0, "keyval")));
+      std::make_pair("testkey0", std::make_pair(0, bucket_json("bucket0"))));
+  result_keys_values.insert(
+      std::make_pair("testkey1", std::make_pair(0, bucket_json("bucket1"))));
 
   EXPECT_CALL(*(motr_kvs_reader_factory->mock_motr_kvs_reader),
               get_key_values()).WillRepeatedly(ReturnRef(result_keys_values));
@@ -116,12 +206,37 @@ TEST_F(S3GetServiceActionTest, GetNextBucketSuccessful) {
   EXPECT_CALL(*ptr_mock_request, set_out_header_value(_, _)).Times(AtLeast(1));
   EXPECT_CALL(*ptr_mock_request, send_response(200, _)).Times(AtLeast(1));
 
-  EXPECT_CALL(*(bucket_meta_factory->mock_bucket_metadata), from_json(_))
-      .WillRepeatedly(Return(0));
+  action_under_test->get_next_buckets_successful();
+
+  const std::vector<S3BucketListEntry> *cached = cache.find("12345");
+  ASSERT_NE(nullptr, cached);
+  ASSERT_EQ(2, cached->size());
+  EXPECT_EQ("bucket0", (*cached)[0].name);
+  EXPECT_EQ("bucket1", (*cached)[1].name);
+  EXPECT_EQ("2020-09-01T10:00:00.000Z", (*cached)[1].creation_date);
+}
+
+// Bucket created while the list was read may be missing from it.
+TEST_F(S3GetServiceActionTest, LoadedBucketsAreNotCachedIfInvalidated) {
+  S3BucketListCache cache(10, 60);
+  ptr_mock_request->set_account_id("12345");
+  action_under_test->bucket_list_cache = &cache;
+  action_under_test->bucket_list_cache_token = cache.begin_load();
+  s3_bucket_list_cache_invalidate("12345");
+  result_keys_values.insert(
+      std::make_pair("testkey0", std::make_pair(0, bucket_json("bucket0"))));
+
+  EXPECT_CALL(*(motr_kvs_reader_factory->mock_motr_kvs_reader),
+              get_key_values()).WillRepeatedly(ReturnRef(result_keys_values));
+  action_under_test->motr_kv_reader =
+      motr_kvs_reader_factory->mock_motr_kvs_reader;
+  EXPECT_CALL(*ptr_mock_request, set_out_header_value(_, _)).Times(AtLeast(1));
+  EXPECT_CALL(*ptr_mock_request, send_response(200, _)).Times(AtLeast(1));
 
   action_under_test->get_next_buckets_successful();
 
-  EXPECT_EQ(3, action_under_test->bucket_list.get_bucket_count());
+  EXPECT_EQ(1, action_under_test->bucket_list.get_bucket_count());
+  EXPECT_EQ(nullptr, cache.find("12345"));
 }
 
 // Verify that get_next_buckets_failed sets boolean flag to true if user
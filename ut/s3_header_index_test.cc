@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <string>
+
+#include "s3_header_index.h"
+
+TEST(S3HeaderIndexTest, FindIsCaseInsensitive) {
+  std::map<std::string, std::string> headers = {
+      {"Content-Type", "application/xml"}, {"x-amz-meta-key", "value"}};
+  S3HeaderIndex index;
+  for (const auto& header : headers) {
+    index.add(header.first.c_str(), &header.second);
+  }
+  EXPECT_EQ(2, index.size());
+
+  ASSERT_NE(nullptr, index.find("content-type"));
+  EXPECT_EQ("application/xml", *index.find("CONTENT-TYPE"));
+  EXPECT_EQ(&headers["x-amz-meta-key"], index.find("X-Amz-Meta-Key"));
+  EXPECT_EQ(nullptr, index.find("Content"));
+  EXPECT_EQ(nullptr, index.find(""));
+}
+
+TEST(S3HeaderIndexTest, FindKnownHeader) {
+  std::map<std::string, std::string> headers = {
+      {"content-length", "512"}, {"X-AMZ-DECODED-CONTENT-LENGTH", "256"}};
+  S3HeaderIndex index;
+  for (const auto& header : headers) {
+    index.add(header.first.c_str(), &header.second);
+  }
+  ASSERT_NE(nullptr, index.find(S3Header::content_length));
+  EXPECT_EQ("512", *index.find(S3Header::content_length));
+  EXPECT_EQ("256", *index.find(S3Header::x_amz_decoded_content_length));
+  EXPECT_EQ(nullptr, index.find(S3Header::range));
+
+  index.clear();
+  EXPECT_EQ(0, index.size());
+  EXPECT_EQ(nullptr, index.find(S3Header::content_length));
+  EXPECT_EQ(nullptr, index.find("content-length"));
+}
+
+TEST(S3HeaderIndexTest, FirstHeaderWins) {
+  std::string first = "first";
+  std::string second = "second";
+  S3HeaderIndex index;
+  index.add("Host", &first);
+  index.add("host", &second);
+  EXPECT_EQ(1, index.size());
+  EXPECT_EQ(&first, index.find("HOST"));
+  EXPECT_EQ(&first, index.find(S3Header::host));
+}
+
+TEST(S3HeaderIndexTest, KnownHeaderNames) {
+  for (size_t i = 0; i < (size_t)S3Header::count; ++i) {
+    const std::string value = "value";
+    S3HeaderIndex index;
+    // Name of every well-known header maps back to the same header.
+    index.add(S3HeaderIndex::get_name((S3Header)i), &value);
+    EXPECT_EQ(&value, index.find((S3Header)i)) << i;
+  }
+}
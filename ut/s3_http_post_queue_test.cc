@@ -18,16 +18,24 @@
  *
  */
 
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
 #include <memory>
 #include <string>
+#include <vector>
 
+#include <event2/http.h>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include <zlib.h>
 
 #include "s3_http_post_queue_impl.h"
 
 using ::testing::_;
 using ::testing::DefaultValue;
+using ::testing::Invoke;
 using ::testing::Return;
 
 class MockS3HttpPostEngine : public S3HttpPostEngine {
@@ -45,19 +53,37 @@ class S3HttpPostQueueTest : public testing::Test {
  protected:
   S3HttpPostQueueTest();
   void SetUp() override;
+  void create_queue(S3HttpPostBatchFormat batch_format,
+                    unsigned max_batch_msgs, unsigned max_requests_in_flight);
 
   std::unique_ptr<S3HttpPostQueueImpl> object;
+  // Bodies passed to the engine
+  std::vector<std::string> posted;
+  // What the engine returns from post()
+  bool engine_accepts = true;
 };
 
 S3HttpPostQueueTest::S3HttpPostQueueTest() = default;
 
 void S3HttpPostQueueTest::SetUp() {
+  create_queue(S3HttpPostBatchFormat::newline_delimited(), 100, 4);
+}
+
+void S3HttpPostQueueTest::create_queue(S3HttpPostBatchFormat batch_format,
+                                       unsigned max_batch_msgs,
+                                       unsigned max_requests_in_flight) {
   auto *engine = new MockS3HttpPostEngine();
 
   EXPECT_CALL(*engine, set_callbacks(_, _)).Times(1);
-  EXPECT_CALL(*engine, post(_)).WillRepeatedly(Return(true));
+  EXPECT_CALL(*engine, post(_))
+      .WillRepeatedly(Invoke([this](const std::string &body) {
+        posted.push_back(body);
+        return engine_accepts;
+      }));
 
-  object.reset(new S3HttpPostQueueImpl(engine));
+  posted.clear();
+  object.reset(new S3HttpPostQueueImpl(engine, std::move(batch_format),
+                                       max_batch_msgs, max_requests_in_flight));
 }
 
 const char msg[] = "{\"k\": \"v\"}";
@@ -66,21 +92,23 @@ TEST_F(S3HttpPostQueueTest, Basic) {
   EXPECT_FALSE(object->post(""));
 
   EXPECT_TRUE(object->post(msg));
-  EXPECT_EQ(1, object->msg_queue.size());
+  EXPECT_EQ(1, object->get_msgs_count());
+  ASSERT_EQ(1, posted.size());
+  EXPECT_EQ(std::string(msg) + "\n", posted[0]);
 
   object->on_msg_sent();
-  EXPECT_TRUE(object->msg_queue.empty());
+  EXPECT_EQ(0, object->get_msgs_count());
 }
 
 TEST_F(S3HttpPostQueueTest, InProgress) {
   EXPECT_TRUE(object->post(msg));
-  EXPECT_TRUE(object->msg_in_progress);
+  EXPECT_FALSE(object->in_flight.empty());
 
   object->on_error();
-  EXPECT_TRUE(object->msg_in_progress);
+  EXPECT_FALSE(object->in_flight.empty());
 
   object->on_msg_sent();
-  EXPECT_FALSE(object->msg_in_progress);
+  EXPECT_TRUE(object->in_flight.empty());
 }
 
 TEST_F(S3HttpPostQueueTest, ErrorCount) {
@@ -109,3 +137,293 @@ TEST_F(S3HttpPostQueueTest, Thresholds) {
   EXPECT_TRUE(object->post(msg));
   EXPECT_FALSE(object->post(msg));
 }
+
+TEST_F(S3HttpPostQueueTest, Batching) {
+  // While there are free request slots each message is sent at once.
+  for (unsigned i = 0; i < 4; ++i) {
+    EXPECT_TRUE(object->post(std::to_string(i)));
+  }
+  ASSERT_EQ(4, posted.size());
+  EXPECT_EQ("3\n", posted[3]);
+
+  for (unsigned i = 4; i < 254; ++i) {
+    EXPECT_TRUE(object->post(std::to_string(i)));
+  }
+  EXPECT_EQ(4, posted.size());
+  EXPECT_EQ(254, object->get_msgs_count());
+
+  object->on_msg_sent();
+  ASSERT_EQ(5, posted.size());
+  EXPECT_EQ(100, std::count(posted[4].begin(), posted[4].end(), '\n'));
+  EXPECT_EQ(0, posted[4].find("4\n5\n"));
+
+  object->on_msg_sent();
+  object->on_msg_sent();
+  ASSERT_EQ(7, posted.size());
+  // The rest of messages
+  EXPECT_EQ(50, std::count(posted[6].begin(), posted[6].end(), '\n'));
+  EXPECT_EQ(251, object->get_msgs_count());
+}
+
+TEST_F(S3HttpPostQueueTest, BatchSizeLimit) {
+  create_queue(S3HttpPostBatchFormat::newline_delimited(), 100, 1);
+  const std::string big_msg(S3HttpPostQueueImpl::MAX_BATCH_SIZE / 3, 'x');
+
+  EXPECT_TRUE(object->post(msg));
+  for (unsigned i = 0; i < 4; ++i) {
+    EXPECT_TRUE(object->post(big_msg));
+  }
+  object->on_msg_sent();
+  ASSERT_EQ(2, posted.size());
+  EXPECT_EQ(2, std::count(posted[1].begin(), posted[1].end(), '\n'));
+  EXPECT_GE(S3HttpPostQueueImpl::MAX_BATCH_SIZE, posted[1].length());
+
+  object->on_msg_sent();
+  ASSERT_EQ(3, posted.size());
+  EXPECT_EQ(2, std::count(posted[2].begin(), posted[2].end(), '\n'));
+}
+
+TEST_F(S3HttpPostQueueTest, Pipelining) {
+  create_queue(S3HttpPostBatchFormat::json_array("{\"records\":[", "]}"), 3,
+               2);
+
+  EXPECT_TRUE(object->post("1"));
+  EXPECT_TRUE(object->post("2"));
+  for (unsigned i = 3; i <= 6; ++i) {
+    EXPECT_TRUE(object->post(std::to_string(i)));
+  }
+  ASSERT_EQ(2, posted.size());
+  EXPECT_EQ("{\"records\":[1]}", posted[0]);
+  EXPECT_EQ("{\"records\":[2]}", posted[1]);
+  EXPECT_EQ(2, object->in_flight.size());
+
+  object->on_msg_sent();
+  ASSERT_EQ(3, posted.size());
+  EXPECT_EQ("{\"records\":[3,4,5]}", posted[2]);
+  EXPECT_EQ(5, object->get_msgs_count());
+
+  object->on_msg_sent();
+  object->on_msg_sent();
+  ASSERT_EQ(4, posted.size());
+  EXPECT_EQ("{\"records\":[6]}", posted[3]);
+
+  object->on_msg_sent();
+  EXPECT_TRUE(object->in_flight.empty());
+  EXPECT_EQ(0, object->get_msgs_count());
+}
+
+TEST_F(S3HttpPostQueueTest, FailedBatchIsResentFirst) {
+  create_queue(S3HttpPostBatchFormat::newline_delimited(), 2, 2);
+
+  EXPECT_TRUE(object->post("a"));
+  EXPECT_TRUE(object->post("b"));
+  EXPECT_TRUE(object->post("c"));
+  EXPECT_TRUE(object->post("d"));
+  EXPECT_TRUE(object->post("e"));
+
+  object->on_error();
+  ASSERT_EQ(3, posted.size());
+  EXPECT_EQ("a\n", posted[2]);
+  EXPECT_EQ(1, object->n_err);
+  EXPECT_EQ(5, object->get_msgs_count());
+
+  object->on_msg_sent();
+  ASSERT_EQ(4, posted.size());
+  EXPECT_EQ("c\nd\n", posted[3]);
+  EXPECT_EQ(0, object->n_err);
+  EXPECT_EQ(4, object->get_msgs_count());
+}
+
+TEST_F(S3HttpPostQueueTest, RefusedBatchIsRetried) {
+  engine_accepts = false;
+  EXPECT_TRUE(object->post("a"));
+  EXPECT_TRUE(object->in_flight.empty());
+  EXPECT_EQ(1, object->failed.size());
+  EXPECT_EQ(1, object->n_err);
+  EXPECT_EQ(1, object->get_msgs_count());
+
+  engine_accepts = true;
+  EXPECT_TRUE(object->post("b"));
+  ASSERT_EQ(3, posted.size());
+  EXPECT_EQ("a\n", posted[1]);
+  EXPECT_EQ("b\n", posted[2]);
+  EXPECT_EQ(2, object->in_flight.size());
+  EXPECT_TRUE(object->failed.empty());
+  EXPECT_EQ(2, object->get_msgs_count());
+}
+
+TEST_F(S3HttpPostQueueTest, RefusedBatchesAreDropped) {
+  engine_accepts = false;
+  for (unsigned i = 1; i < S3HttpPostQueueImpl::MAX_ERR; ++i) {
+    EXPECT_TRUE(object->post(msg));
+    EXPECT_EQ(i, object->n_err);
+    EXPECT_EQ(i, object->get_msgs_count());
+  }
+  EXPECT_TRUE(object->post(msg));
+  EXPECT_EQ(S3HttpPostQueueImpl::MAX_ERR, object->n_err);
+  EXPECT_TRUE(object->failed.empty());
+  EXPECT_EQ(0, object->get_msgs_count());
+
+  EXPECT_FALSE(object->post(msg));
+}
+
+static std::string gunzip(const std::string &in) {
+  z_stream strm = {};
+  EXPECT_EQ(Z_OK, inflateInit2(&strm, 15 + 16));
+
+  std::string out;
+  char buf[4096];
+  strm.next_in = (Bytef *)in.data();
+  strm.avail_in = in.length();
+  int rc;
+  do {
+    strm.next_out = (Bytef *)buf;
+    strm.avail_out = sizeof(buf);
+    rc = inflate(&strm, Z_NO_FLUSH);
+    out.append(buf, sizeof(buf) - strm.avail_out);
+  } while (rc == Z_OK);
+  EXPECT_EQ(Z_STREAM_END, rc);
+  inflateEnd(&strm);
+
+  return out;
+}
+
+TEST(S3HttpPostEngineTest, Gzip) {
+  std::string body;
+  for (unsigned i = 0; i < 1000; ++i) {
+    body += msg;
+    body += '\n';
+  }
+  std::string compressed;
+  ASSERT_TRUE(S3HttpPostEngineImpl::gzip(body, compressed));
+  EXPECT_LT(compressed.length(), body.length() / 10);
+  EXPECT_EQ(body, gunzip(compressed));
+}
+
+// HTTP server on the loopback interface which accepts newline delimited
+// records and counts them.
+class S3HttpPostStub {
+ public:
+  explicit S3HttpPostStub(evbase_t *p_evbase) {
+    p_http = evhttp_new(p_evbase);
+    auto *p_handle = evhttp_bind_socket_with_handle(p_http, "127.0.0.1", 0);
+
+    if (p_handle) {
+      struct sockaddr_in addr = {};
+      socklen_t len = sizeof(addr);
+      getsockname(evhttp_bound_socket_get_fd(p_handle),
+                  (struct sockaddr *)&addr, &len);
+      port = ntohs(addr.sin_port);
+    }
+    evhttp_set_gencb(p_http, on_request, this);
+  }
+  ~S3HttpPostStub() { evhttp_free(p_http); }
+
+  uint16_t port = 0;
+  size_t n_requests = 0;
+  size_t n_records = 0;
+
+ private:
+  static void on_request(struct evhttp_request *p_req, void *p_arg) {
+    auto *p_stub = static_cast<S3HttpPostStub *>(p_arg);
+    auto *p_buf = evhttp_request_get_input_buffer(p_req);
+
+    std::string body(evbuffer_get_length(p_buf), '\0');
+    evbuffer_remove(p_buf, &body[0], body.length());
+
+    const char *encoding = evhttp_find_header(
+        evhttp_request_get_input_headers(p_req), "Content-Encoding");
+    if (encoding && !strcmp(encoding, "gzip")) {
+      body = gunzip(body);
+    }
+    ++p_stub->n_requests;
+    p_stub->n_records += std::count(body.begin(), body.end(), '\n');
+
+    evhttp_send_reply(p_req, HTTP_OK, "OK", nullptr);
+  }
+
+  struct evhttp *p_http;
+};
+
+// Posts 'n_records' audit-like records as fast as the queue accepts them
+// and returns the number of records per second received by the stub.
+static double run_post_benchmark(unsigned max_batch_msgs,
+                                 unsigned max_requests_in_flight,
+                                 bool compress, size_t n_records,
+                                 size_t *n_requests) {
+  evbase_t *p_evbase = event_base_new();
+  double records_per_sec = 0;
+  {
+    S3HttpPostStub stub(p_evbase);
+    EXPECT_NE(0, stub.port);
+
+    // Keeps the loop waking up if nothing else happens.
+    struct event *p_tick = event_new(p_evbase, -1, EV_PERSIST,
+                                     [](evutil_socket_t, short, void *) {},
+                                     nullptr);
+    const struct timeval tick = {0, 100000};
+    event_add(p_tick, &tick);
+
+    std::unique_ptr<S3HttpPostQueue> queue(create_http_post_queue(
+        p_evbase, std::string("127.0.0.1"), stub.port, std::string("/audit"),
+        std::map<std::string, std::string>(),
+        S3HttpPostBatchFormat::newline_delimited(), max_batch_msgs,
+        max_requests_in_flight, compress));
+
+    const std::string record =
+        "{\"key\":\"s3server\",\"value\":{\"bucket\":\"bucket\","
+        "\"object\":\"object\",\"operation\":\"REST.PUT.OBJECT\","
+        "\"request_id\":\"5f0a6c2e-0e4a-4c8b-9a61-39e3b0b8e1a7\","
+        "\"http_status\":200,\"bytes_received\":1048576}}";
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto deadline = start + std::chrono::seconds(60);
+
+    for (size_t n_posted = 0;
+         n_posted < n_records && std::chrono::steady_clock::now() < deadline;) {
+      if (queue->post(record)) {
+        ++n_posted;
+      } else {
+        event_base_loop(p_evbase, EVLOOP_ONCE);
+      }
+    }
+    while (stub.n_records < n_records &&
+           std::chrono::steady_clock::now() < deadline) {
+      event_base_loop(p_evbase, EVLOOP_ONCE);
+    }
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    EXPECT_EQ(n_records, stub.n_records);
+    records_per_sec = stub.n_records / elapsed.count();
+    *n_requests = stub.n_requests;
+
+    queue.reset();
+    event_free(p_tick);
+  }
+  event_base_free(p_evbase);
+
+  return records_per_sec;
+}
+
+// Prints records per second posted one by one, batched, and batched with
+// compression.  Disabled, run with --gtest_also_run_disabled_tests.
+TEST(S3HttpPostQueueBenchmark, DISABLED_RecordsPerSecond) {
+  const size_t n_records = 20000;
+  size_t n_requests = 0;
+
+  // The same as posting one message per request and waiting for it.
+  const double single = run_post_benchmark(1, 1, false, n_records, &n_requests);
+  EXPECT_EQ(n_records, n_requests);
+
+  const double batched =
+      run_post_benchmark(100, 4, false, n_records, &n_requests);
+  EXPECT_GT(n_records / 10, n_requests);
+
+  const double compressed =
+      run_post_benchmark(100, 4, true, n_records, &n_requests);
+  EXPECT_GT(n_records / 10, n_requests);
+
+  printf("Audit records/sec: single %.0f, batched %.0f, batched+gzip %.0f\n",
+         single, batched, compressed);
+}
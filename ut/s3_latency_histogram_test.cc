@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+#include "s3_latency_histogram.h"
+
+TEST(S3LatencyHistogramTest, SmallValuesAreExact) {
+  for (uint64_t value = 0; value < S3LatencyHistogram::sub_bucket_count;
+       ++value) {
+    unsigned index = S3LatencyHistogram::bucket_index(value);
+    EXPECT_EQ(value, index);
+    EXPECT_EQ(value, S3LatencyHistogram::bucket_upper_bound(index));
+  }
+}
+
+TEST(S3LatencyHistogramTest, BucketsCoverAllValues) {
+  uint64_t lower = 0;
+  for (unsigned index = 0; index < S3LatencyHistogram::bucket_count; ++index) {
+    uint64_t upper = S3LatencyHistogram::bucket_upper_bound(index);
+    EXPECT_EQ(index, S3LatencyHistogram::bucket_index(lower));
+    EXPECT_EQ(index, S3LatencyHistogram::bucket_index(upper));
+    // Bucket width is within ~3% of its values.
+    EXPECT_LE((upper - lower) * 32, upper);
+    lower = upper + 1;
+  }
+  EXPECT_EQ((1ULL << S3_HISTOGRAM_MAX_VALUE_BITS), lower);
+  // Larger values are clamped into the last bucket.
+  EXPECT_EQ(S3LatencyHistogram::bucket_count - 1,
+            S3LatencyHistogram::bucket_index(UINT64_MAX));
+}
+
+TEST(S3LatencyHistogramTest, ValueAtPercentile) {
+  S3LatencyHistogram histogram;
+  std::vector<uint64_t> counts;
+  histogram.snapshot(&counts);
+  EXPECT_EQ(0, S3LatencyHistogram::value_at_percentile(counts, 99));
+
+  for (uint64_t value = 1; value <= 1000; ++value) {
+    histogram.record(value * 1000);
+  }
+  counts.clear();
+  histogram.snapshot(&counts);
+  uint64_t p50 = S3LatencyHistogram::value_at_percentile(counts, 50);
+  uint64_t p99 = S3LatencyHistogram::value_at_percentile(counts, 99);
+  uint64_t p999 = S3LatencyHistogram::value_at_percentile(counts, 99.9);
+  uint64_t p100 = S3LatencyHistogram::value_at_percentile(counts, 100);
+  EXPECT_GE(p50, 500000u);
+  EXPECT_LE(p50, 500000u * 33 / 32);
+  EXPECT_GE(p99, 990000u);
+  EXPECT_LE(p99, 990000u * 33 / 32);
+  EXPECT_GE(p999, 999000u);
+  EXPECT_LE(p999, 999000u * 33 / 32);
+  EXPECT_GE(p100, 1000000u);
+  EXPECT_LE(p100, 1000000u * 33 / 32);
+
+  histogram.reset();
+  counts.clear();
+  histogram.snapshot(&counts);
+  EXPECT_EQ(0, S3LatencyHistogram::value_at_percentile(counts, 50));
+}
+
+TEST(S3LatencyHistogramTest, SnapshotsAreMerged) {
+  S3LatencyHistogram first;
+  S3LatencyHistogram second;
+  first.record(10);
+  second.record(20);
+  second.record(30);
+
+  std::vector<uint64_t> counts;
+  first.snapshot(&counts);
+  second.snapshot(&counts);
+  EXPECT_EQ(10, S3LatencyHistogram::value_at_percentile(counts, 33));
+  EXPECT_EQ(20, S3LatencyHistogram::value_at_percentile(counts, 50));
+  EXPECT_EQ(30, S3LatencyHistogram::value_at_percentile(counts, 100));
+}
+
+TEST(S3LatencyHistogramTest, ConcurrentRecording) {
+  const int threads_count = 4;
+  const int values_count = 10000;
+  S3LatencyHistogram histogram;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < threads_count; ++t) {
+    threads.emplace_back([&histogram]() {
+      for (int i = 0; i < values_count; ++i) {
+        histogram.record(i);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  std::vector<uint64_t> counts;
+  histogram.snapshot(&counts);
+  uint64_t total = 0;
+  for (auto count : counts) {
+    total += count;
+  }
+  EXPECT_EQ(threads_count * values_count, total);
+}
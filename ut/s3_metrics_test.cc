@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "s3_metrics.h"
+
+class S3MetricsTest : public testing::Test {
+ protected:
+  static bool contains(const std::string& text, const std::string& line) {
+    return text.find(line + "\n") != std::string::npos;
+  }
+
+  S3Metrics metrics;
+};
+
+TEST_F(S3MetricsTest, UsecToSecondsStr) {
+  EXPECT_EQ("0.000000", S3Metrics::usec_to_seconds_str(0));
+  EXPECT_EQ("0.001500", S3Metrics::usec_to_seconds_str(1500));
+  EXPECT_EQ("12.000001", S3Metrics::usec_to_seconds_str(12000001));
+}
+
+TEST_F(S3MetricsTest, EscapeLabelValue) {
+  EXPECT_EQ("GetObject", S3Metrics::escape_label_value("GetObject"));
+  EXPECT_EQ("a\\\"b\\\\c\\nd", S3Metrics::escape_label_value("a\"b\\c\nd"));
+}
+
+TEST_F(S3MetricsTest, LatencyMetric) {
+  S3LatencyMetric metric;
+  metric.observe(40);
+  metric.observe(800);
+  metric.observe(100000000);
+
+  EXPECT_EQ(3, metric.get_count());
+  EXPECT_EQ(100000840, metric.get_sum_usec());
+  std::vector<uint64_t> le_counts = metric.get_le_counts();
+  ASSERT_EQ(S3LatencyMetric::le_boundaries_usec.size(), le_counts.size());
+  EXPECT_EQ(1, le_counts[0]);
+  EXPECT_EQ(2, le_counts[1]);
+  EXPECT_EQ(2, le_counts.back());
+  EXPECT_EQ(40, metric.get_percentile_usec(10));
+
+  // Percentiles cover the current and the previous window only.
+  metric.rotate_window();
+  EXPECT_EQ(40, metric.get_percentile_usec(10));
+  metric.rotate_window();
+  EXPECT_EQ(0, metric.get_percentile_usec(10));
+  EXPECT_EQ(3, metric.get_count());
+}
+
+TEST_F(S3MetricsTest, InFlightGauges) {
+  metrics.request_started();
+  metrics.request_started();
+  metrics.motr_op_started();
+  EXPECT_EQ(2, metrics.get_requests_in_flight());
+  EXPECT_EQ(1, metrics.get_motr_ops_in_flight());
+
+  metrics.request_finished("GetObject", -1);
+  metrics.motr_op_finished("motr_obj_read", true, 10);
+  EXPECT_EQ(1, metrics.get_requests_in_flight());
+  EXPECT_EQ(0, metrics.get_motr_ops_in_flight());
+
+  std::string text = metrics.render();
+  EXPECT_TRUE(contains(text, "s3_requests_in_flight 1"));
+  EXPECT_TRUE(contains(text, "s3_motr_ops_in_flight 0"));
+  // Request with unknown duration is not observed.
+  EXPECT_EQ(std::string::npos, text.find("api=\"GetObject\""));
+}
+
+TEST_F(S3MetricsTest, RenderOpenMetrics) {
+  metrics.request_started();
+  metrics.request_finished("GetObject", 2000);
+  metrics.motr_op_started();
+  metrics.motr_op_finished("motr_obj_write", false, 700);
+  metrics.add_collector([](std::string& out) {
+    S3Metrics::render_family(out, "s3_test", "gauge", "Test gauge.");
+    S3Metrics::render_sample(out, "s3_test", "", "7");
+  });
+
+  std::string text = metrics.render();
+  EXPECT_TRUE(contains(text, "# TYPE s3_request_duration_seconds histogram"));
+  EXPECT_TRUE(contains(text, "# UNIT s3_request_duration_seconds seconds"));
+  EXPECT_TRUE(contains(
+      text,
+      "s3_request_duration_seconds_bucket{api=\"GetObject\",le=\"0.001\"} 0"));
+  EXPECT_TRUE(contains(
+      text,
+      "s3_request_duration_seconds_bucket{api=\"GetObject\",le=\"0.0025\"} 1"));
+  EXPECT_TRUE(contains(
+      text,
+      "s3_request_duration_seconds_bucket{api=\"GetObject\",le=\"+Inf\"} 1"));
+  EXPECT_TRUE(
+      contains(text, "s3_request_duration_seconds_count{api=\"GetObject\"} 1"));
+  EXPECT_TRUE(contains(
+      text, "s3_request_duration_seconds_sum{api=\"GetObject\"} 0.002000"));
+  EXPECT_TRUE(contains(text, "# TYPE s3_request_latency_seconds summary"));
+  EXPECT_TRUE(contains(
+      text,
+      "s3_request_latency_seconds{api=\"GetObject\",quantile=\"0.999\"} "
+      "0.002015"));
+  EXPECT_TRUE(contains(text,
+                       "s3_motr_op_duration_seconds_count{op=\"motr_obj_"
+                       "write\",status=\"failed\"} 1"));
+  EXPECT_TRUE(contains(text, "s3_test 7"));
+
+  // Text ends with EOF marker.
+  ASSERT_GE(text.size(), 6u);
+  EXPECT_EQ("# EOF\n", text.substr(text.size() - 6));
+}
+
+TEST_F(S3MetricsTest, CachedMetricsOfThreadsAndInstances) {
+  const int threads_count = 4;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < threads_count; ++t) {
+    threads.emplace_back([this]() {
+      for (int i = 0; i < 1000; ++i) {
+        metrics.request_finished("PutObject", 100);
+        metrics.motr_op_finished("put_keyval", i % 2, 100);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  std::string text = metrics.render();
+  EXPECT_TRUE(contains(
+      text, "s3_request_duration_seconds_count{api=\"PutObject\"} 4000"));
+  EXPECT_TRUE(contains(text,
+                       "s3_motr_op_duration_seconds_count{op=\"put_keyval\","
+                       "status=\"success\"} 2000"));
+  EXPECT_TRUE(contains(text,
+                       "s3_motr_op_duration_seconds_count{op=\"put_keyval\","
+                       "status=\"failed\"} 2000"));
+
+  // Pointers cached for another instance are not used.
+  metrics.request_finished("GetObject", 100);
+  {
+    S3Metrics other;
+    other.request_finished("GetObject", 100);
+    other.request_finished("GetObject", 100);
+    EXPECT_TRUE(contains(
+        other.render(),
+        "s3_request_duration_seconds_count{api=\"GetObject\"} 2"));
+  }
+  metrics.request_finished("GetObject", 100);
+  EXPECT_TRUE(contains(
+      metrics.render(),
+      "s3_request_duration_seconds_count{api=\"GetObject\"} 2"));
+}
@@ -0,0 +1,430 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "s3_motr_emulator.h"
+
+namespace {
+
+// m0_bufvec over test owned buffers.
+struct TestBufvec {
+  std::vector<m0_bcount_t> counts;
+  std::vector<void *> bufs;
+  struct m0_bufvec bufvec;
+
+  // Empty slots for values returned by the emulator.
+  explicit TestBufvec(size_t nr) : counts(nr), bufs(nr) { init(); }
+
+  explicit TestBufvec(std::vector<std::string> &values)
+      : counts(values.size()), bufs(values.size()) {
+    for (size_t i = 0; i < values.size(); ++i) {
+      counts[i] = values[i].size();
+      bufs[i] = &values[i][0];
+    }
+    init();
+  }
+
+  void init() {
+    bufvec.ov_vec.v_nr = counts.size();
+    bufvec.ov_vec.v_count = counts.data();
+    bufvec.ov_buf = bufs.data();
+  }
+
+  std::string get(size_t i) const {
+    return std::string((const char *)bufs[i], counts[i]);
+  }
+
+  // Frees buffers allocated by the emulator.
+  void free_all() {
+    for (auto &buf : bufs) {
+      free(buf);
+      buf = nullptr;
+    }
+  }
+};
+
+struct TestIndexvec {
+  std::vector<m0_bcount_t> counts;
+  std::vector<m0_bindex_t> offsets;
+  struct m0_indexvec indexvec;
+
+  // 'extents' are pairs of offset and length.
+  explicit TestIndexvec(
+      const std::vector<std::pair<uint64_t, uint64_t>> &extents) {
+    for (const auto &extent : extents) {
+      offsets.push_back(extent.first);
+      counts.push_back(extent.second);
+    }
+    indexvec.iv_vec.v_nr = counts.size();
+    indexvec.iv_vec.v_count = counts.data();
+    indexvec.iv_index = offsets.data();
+  }
+};
+
+int gs_stable_count;
+int gs_failed_count;
+
+void count_stable(struct m0_op *) { ++gs_stable_count; }
+void count_failed(struct m0_op *) { ++gs_failed_count; }
+
+std::atomic<bool> gs_callback_started;
+std::atomic<bool> gs_callback_done;
+
+void slow_stable(struct m0_op *) {
+  gs_callback_started = true;
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  gs_callback_done = true;
+}
+
+}  // namespace
+
+class S3MotrEmulatorTest : public testing::Test {
+ protected:
+  std::unique_ptr<S3MotrEmulator> emulator;
+  struct m0_uint128 oid = {0x123, 0x456};
+
+  void SetUp() { emulator.reset(new S3MotrEmulator(2, 0, 0, "")); }
+
+  // Launches 'op', waits for its completion and frees it.
+  int run(struct m0_op *op) {
+    emulator->motr_op_launch(0, &op, 1);
+    EXPECT_EQ(0, emulator->motr_op_wait(op,
+                                        M0_BITS(M0_OS_FAILED, M0_OS_STABLE),
+                                        M0_TIME_NEVER));
+    const int rc = emulator->motr_op_rc(op);
+    EXPECT_EQ(rc == 0 ? M0_OS_STABLE : M0_OS_FAILED, op->op_sm.sm_state);
+    emulator->op_free(op);
+    return rc;
+  }
+
+  int create_object(const struct m0_uint128 &id) {
+    struct m0_obj obj;
+    struct m0_op *op = nullptr;
+    emulator->motr_obj_init(&obj, nullptr, &id, 1);
+    EXPECT_EQ(0, emulator->motr_entity_create(&obj.ob_entity, &op));
+    return run(op);
+  }
+
+  int object_io(enum m0_obj_opcode opcode, TestIndexvec &ext,
+                TestBufvec &data) {
+    struct m0_obj obj;
+    struct m0_op *op = nullptr;
+    emulator->motr_obj_init(&obj, nullptr, &oid, 1);
+    EXPECT_EQ(0, emulator->motr_obj_op(&obj, opcode, &ext.indexvec,
+                                       &data.bufvec, nullptr, 0, 0, &op));
+    return run(op);
+  }
+
+  int index_op(enum m0_idx_opcode opcode, TestBufvec *keys, TestBufvec *vals,
+               std::vector<int> *rcs, unsigned flags = 0) {
+    struct m0_idx idx;
+    struct m0_op *op = nullptr;
+    emulator->motr_idx_init(&idx, nullptr, &oid);
+    EXPECT_EQ(0, emulator->motr_idx_op(&idx, opcode,
+                                       keys ? &keys->bufvec : nullptr,
+                                       vals ? &vals->bufvec : nullptr,
+                                       rcs ? rcs->data() : nullptr, flags,
+                                       &op));
+    return run(op);
+  }
+};
+
+TEST_F(S3MotrEmulatorTest, ObjectCreateOpenDelete) {
+  struct m0_obj obj;
+  struct m0_op *op = nullptr;
+  emulator->motr_obj_init(&obj, nullptr, &oid, 9);
+  EXPECT_EQ(M0_ET_OBJ, obj.ob_entity.en_type);
+  EXPECT_EQ(9, obj.ob_attr.oa_layout_id);
+  // Teardown skips m0_obj_fini() for such entities.
+  EXPECT_EQ(0, obj.ob_entity.en_sm.sm_state);
+
+  ASSERT_EQ(0, emulator->motr_entity_open(&obj.ob_entity, &op));
+  EXPECT_EQ(-ENOENT, run(op));
+  EXPECT_EQ(0, create_object(oid));
+  EXPECT_EQ(-EEXIST, create_object(oid));
+  ASSERT_EQ(0, emulator->motr_entity_open(&obj.ob_entity, &op));
+  EXPECT_EQ(0, run(op));
+  ASSERT_EQ(0, emulator->motr_entity_delete(&obj.ob_entity, &op));
+  EXPECT_EQ(0, run(op));
+  ASSERT_EQ(0, emulator->motr_entity_delete(&obj.ob_entity, &op));
+  EXPECT_EQ(-ENOENT, run(op));
+}
+
+TEST_F(S3MotrEmulatorTest, ObjectWriteRead) {
+  std::vector<std::string> written = {std::string(4096, 'a'),
+                                      std::string(4096, 'b')};
+  TestBufvec write_data(written);
+  // Second extent crosses a 1 MiB chunk boundary.
+  TestIndexvec write_ext({{0, 4096}, {(1 << 20) - 100, 4096}});
+  EXPECT_EQ(-ENOENT, object_io(M0_OC_WRITE, write_ext, write_data));
+  ASSERT_EQ(0, create_object(oid));
+  ASSERT_EQ(0, object_io(M0_OC_WRITE, write_ext, write_data));
+
+  // One buffer over three extents, the middle one was never written.
+  std::vector<std::string> read(1, std::string(3 * 4096, 'x'));
+  TestBufvec read_data(read);
+  TestIndexvec read_ext({{0, 4096}, {8192, 4096}, {(1 << 20) - 100, 4096}});
+  ASSERT_EQ(0, object_io(M0_OC_READ, read_ext, read_data));
+  EXPECT_EQ(std::string(4096, 'a') + std::string(4096, '\0') +
+                std::string(4096, 'b'),
+            read[0]);
+}
+
+TEST_F(S3MotrEmulatorTest, SparseFiles) {
+  char dir[] = "/tmp/s3_motr_emulator_testXXXXXX";
+  ASSERT_TRUE(mkdtemp(dir));
+  emulator.reset(new S3MotrEmulator(2, 0, 0, dir));
+  ASSERT_EQ(0, create_object(oid));
+
+  std::vector<std::string> written(1, std::string(4096, 'z'));
+  TestBufvec write_data(written);
+  TestIndexvec ext({{100 << 20, 4096}});
+  ASSERT_EQ(0, object_io(M0_OC_WRITE, ext, write_data));
+
+  const std::string path =
+      std::string(dir) + "/0000000000000123-0000000000000456";
+  struct stat st;
+  ASSERT_EQ(0, stat(path.c_str(), &st));
+  EXPECT_EQ((100 << 20) + 4096, st.st_size);
+  EXPECT_LT(st.st_blocks * 512, 1 << 20);
+
+  std::vector<std::string> read(1, std::string(8192, 'x'));
+  TestBufvec read_data(read);
+  TestIndexvec read_ext({{(100 << 20) - 4096, 8192}});
+  ASSERT_EQ(0, object_io(M0_OC_READ, read_ext, read_data));
+  EXPECT_EQ(std::string(4096, '\0') + std::string(4096, 'z'), read[0]);
+
+  struct m0_obj obj;
+  struct m0_op *op = nullptr;
+  emulator->motr_obj_init(&obj, nullptr, &oid, 1);
+  ASSERT_EQ(0, emulator->motr_entity_delete(&obj.ob_entity, &op));
+  EXPECT_EQ(0, run(op));
+  EXPECT_NE(0, access(path.c_str(), F_OK));
+  EXPECT_EQ(0, rmdir(dir));
+}
+
+TEST_F(S3MotrEmulatorTest, IndexKeyValues) {
+  std::vector<std::string> keys = {"b", "a", "c"};
+  std::vector<std::string> values = {"2", "1", "3"};
+  TestBufvec put_keys(keys), put_vals(values);
+  std::vector<int> rcs(3, 1);
+  EXPECT_EQ(-ENOENT, index_op(M0_IC_PUT, &put_keys, &put_vals, &rcs));
+  EXPECT_EQ(-ENOENT, index_op(M0_IC_LOOKUP, nullptr, nullptr, nullptr));
+  ASSERT_EQ(0, emulator->create_index(oid));
+  EXPECT_EQ(-EEXIST, emulator->create_index(oid));
+  EXPECT_EQ(0, index_op(M0_IC_LOOKUP, nullptr, nullptr, nullptr));
+  ASSERT_EQ(0, index_op(M0_IC_PUT, &put_keys, &put_vals, &rcs));
+  EXPECT_EQ(std::vector<int>({0, 0, 0}), rcs);
+
+  // Existing keys are kept without M0_OIF_OVERWRITE.
+  std::vector<std::string> new_values = {"two", "one", "three"};
+  TestBufvec new_vals(new_values);
+  ASSERT_EQ(0, index_op(M0_IC_PUT, &put_keys, &new_vals, &rcs));
+  EXPECT_EQ(std::vector<int>({-EEXIST, -EEXIST, -EEXIST}), rcs);
+  std::vector<std::string> one_key = {"b"};
+  std::vector<std::string> one_value = {"22"};
+  TestBufvec overwrite_keys(one_key), overwrite_vals(one_value);
+  std::vector<int> one_rc(1, 1);
+  ASSERT_EQ(0, index_op(M0_IC_PUT, &overwrite_keys, &overwrite_vals, &one_rc,
+                        M0_OIF_OVERWRITE));
+  EXPECT_EQ(0, one_rc[0]);
+
+  std::vector<std::string> get_keys = {"a", "missing", "b"};
+  TestBufvec get_key_vec(get_keys), get_vals(3);
+  ASSERT_EQ(0, index_op(M0_IC_GET, &get_key_vec, &get_vals, &rcs));
+  EXPECT_EQ(std::vector<int>({0, -ENOENT, 0}), rcs);
+  EXPECT_EQ("1", get_vals.get(0));
+  EXPECT_EQ("22", get_vals.get(2));
+  get_vals.free_all();
+
+  // Listing from the start.
+  TestBufvec next_keys(2), next_vals(2);
+  std::vector<int> next_rcs(2, 1);
+  ASSERT_EQ(0, index_op(M0_IC_NEXT, &next_keys, &next_vals, &next_rcs));
+  EXPECT_EQ(std::vector<int>({0, 0}), next_rcs);
+  EXPECT_EQ("a", next_keys.get(0));
+  EXPECT_EQ("b", next_keys.get(1));
+  EXPECT_EQ("22", next_vals.get(1));
+  next_keys.free_all();
+  next_vals.free_all();
+
+  // Listing after "a", the start key buffer is owned by the caller.
+  std::string start_key = "a";
+  TestBufvec after_keys(3), after_vals(3);
+  after_keys.bufs[0] = &start_key[0];
+  after_keys.counts[0] = 1;
+  ASSERT_EQ(0, index_op(M0_IC_NEXT, &after_keys, &after_vals, &rcs,
+                        M0_OIF_EXCLUDE_START_KEY));
+  EXPECT_EQ(std::vector<int>({0, 0, -ENOENT}), rcs);
+  EXPECT_EQ("b", after_keys.get(0));
+  EXPECT_EQ("c", after_keys.get(1));
+  after_keys.free_all();
+  after_vals.free_all();
+
+  std::vector<std::string> del_keys = {"a", "missing"};
+  TestBufvec del_key_vec(del_keys);
+  std::vector<int> del_rcs(2, 1);
+  ASSERT_EQ(0, index_op(M0_IC_DEL, &del_key_vec, nullptr, &del_rcs));
+  EXPECT_EQ(std::vector<int>({0, -ENOENT}), del_rcs);
+}
+
+TEST_F(S3MotrEmulatorTest, Callbacks) {
+  struct m0_op_ops cbs = {};
+  cbs.oop_failed = count_failed;
+  cbs.oop_stable = count_stable;
+  gs_stable_count = gs_failed_count = 0;
+  ASSERT_EQ(0, create_object(oid));
+
+  const struct m0_uint128 missing = {0x123, 0x789};
+  struct m0_obj objs[2];
+  struct m0_op *ops[2] = {nullptr, nullptr};
+  emulator->motr_obj_init(&objs[0], nullptr, &oid, 1);
+  emulator->motr_obj_init(&objs[1], nullptr, &missing, 1);
+  for (int i = 0; i < 2; ++i) {
+    ASSERT_EQ(0, emulator->motr_entity_open(&objs[i].ob_entity, &ops[i]));
+    emulator->motr_op_setup(ops[i], &cbs, 0);
+  }
+  emulator->motr_op_launch(0, ops, 2);
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_EQ(0, emulator->motr_op_wait(
+                     ops[i], M0_BITS(M0_OS_FAILED, M0_OS_STABLE),
+                     M0_TIME_NEVER));
+    emulator->op_free(ops[i]);
+  }
+  EXPECT_EQ(1, gs_stable_count);
+  EXPECT_EQ(1, gs_failed_count);
+}
+
+TEST_F(S3MotrEmulatorTest, LatencyAndBandwidth) {
+  // 100 ms per operation, 10 MB per second.
+  emulator.reset(new S3MotrEmulator(4, 100000, 10, ""));
+  ASSERT_EQ(0, create_object(oid));
+
+  struct m0_obj obj;
+  struct m0_op *op = nullptr;
+  emulator->motr_obj_init(&obj, nullptr, &oid, 1);
+  ASSERT_EQ(0, emulator->motr_entity_open(&obj.ob_entity, &op));
+  emulator->motr_op_launch(0, &op, 1);
+  EXPECT_EQ(-ETIMEDOUT, emulator->motr_op_wait(op, M0_BITS(M0_OS_STABLE),
+                                               M0_TIME_IMMEDIATELY));
+  EXPECT_EQ(M0_OS_LAUNCHED, op->op_sm.sm_state);
+  // Freed once it completes.
+  emulator->op_free(op);
+
+  // Two 1 MiB writes share the device, 100 ms each: the second one
+  // completes 300 ms after launch.
+  std::vector<std::string> written(1, std::string(1 << 20, 'w'));
+  TestBufvec data(written);
+  TestIndexvec ext1({{0, 1 << 20}}), ext2({{1 << 20, 1 << 20}});
+  struct m0_op *ops[2] = {nullptr, nullptr};
+  ASSERT_EQ(0, emulator->motr_obj_op(&obj, M0_OC_WRITE, &ext1.indexvec,
+                                     &data.bufvec, nullptr, 0, 0, &ops[0]));
+  ASSERT_EQ(0, emulator->motr_obj_op(&obj, M0_OC_WRITE, &ext2.indexvec,
+                                     &data.bufvec, nullptr, 0, 0, &ops[1]));
+  const auto start = std::chrono::steady_clock::now();
+  emulator->motr_op_launch(0, ops, 2);
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_EQ(0, emulator->motr_op_wait(ops[i], M0_BITS(M0_OS_STABLE),
+                                        M0_TIME_NEVER));
+    emulator->op_free(ops[i]);
+  }
+  const auto elapsed_ms =
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          std::chrono::steady_clock::now() - start).count();
+  EXPECT_GE(elapsed_ms, 290);
+  EXPECT_LT(elapsed_ms, 2000);
+}
+
+TEST_F(S3MotrEmulatorTest, FreeCancelsQueuedOp) {
+  emulator.reset(new S3MotrEmulator(2, 50000, 0, ""));
+  ASSERT_EQ(0, create_object(oid));
+  struct m0_op_ops cbs = {};
+  cbs.oop_failed = count_failed;
+  cbs.oop_stable = count_stable;
+  gs_stable_count = gs_failed_count = 0;
+
+  struct m0_obj obj;
+  struct m0_op *op = nullptr;
+  emulator->motr_obj_init(&obj, nullptr, &oid, 1);
+  std::unique_ptr<std::vector<std::string>> written(
+      new std::vector<std::string>(1, std::string(4096, 'w')));
+  std::unique_ptr<TestBufvec> data(new TestBufvec(*written));
+  std::unique_ptr<TestIndexvec> ext(new TestIndexvec({{0, 4096}}));
+  ASSERT_EQ(0, emulator->motr_obj_op(&obj, M0_OC_WRITE, &ext->indexvec,
+                                     &data->bufvec, nullptr, 0, 0, &op));
+  emulator->motr_op_setup(op, &cbs, 0);
+  emulator->motr_op_launch(0, &op, 1);
+  emulator->op_free(op);
+  // The buffers are freed as after teardown of the owner.
+  ext.reset();
+  data.reset();
+  written.reset();
+  std::this_thread::sleep_for(std::chrono::milliseconds(150));
+  EXPECT_EQ(0, gs_stable_count);
+  EXPECT_EQ(0, gs_failed_count);
+
+  // Nothing has been written.
+  std::vector<std::string> read(1, std::string(4096, 'r'));
+  TestBufvec read_data(read);
+  TestIndexvec read_ext({{0, 4096}});
+  ASSERT_EQ(0, emulator->motr_obj_op(&obj, M0_OC_READ, &read_ext.indexvec,
+                                     &read_data.bufvec, nullptr, 0, 0, &op));
+  ASSERT_EQ(0, run(op));
+  EXPECT_EQ(std::string(4096, '\0'), read[0]);
+}
+
+TEST_F(S3MotrEmulatorTest, FreeWaitsForExecutingOp) {
+  struct m0_op_ops cbs = {};
+  cbs.oop_stable = slow_stable;
+  gs_callback_started = gs_callback_done = false;
+  ASSERT_EQ(0, create_object(oid));
+
+  struct m0_obj obj;
+  struct m0_op *op = nullptr;
+  emulator->motr_obj_init(&obj, nullptr, &oid, 1);
+  ASSERT_EQ(0, emulator->motr_entity_open(&obj.ob_entity, &op));
+  emulator->motr_op_setup(op, &cbs, 0);
+  emulator->motr_op_launch(0, &op, 1);
+  while (!gs_callback_started) {
+    std::this_thread::yield();
+  }
+  emulator->op_free(op);
+  EXPECT_TRUE(gs_callback_done);
+}
+
+TEST_F(S3MotrEmulatorTest, UfidsAreUnique) {
+  struct m0_uint128 ufid1, ufid2;
+  ASSERT_EQ(0, emulator->m0_h_ufid_next(&ufid1));
+  ASSERT_EQ(0, emulator->m0_h_ufid_next(&ufid2));
+  EXPECT_NE(0, ufid1.u_hi);
+  EXPECT_EQ(ufid1.u_hi, ufid2.u_hi);
+  EXPECT_NE(ufid1.u_lo, ufid2.u_lo);
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "s3_motr_context.h"
+#include "s3_motr_extents.h"
+
+class S3MotrExtentsTest : public testing::Test {
+ protected:
+  std::vector<char> memory;
+  S3BufferSequence buffers;
+  struct s3_motr_rw_op_context *rw_ctx = nullptr;
+
+  S3MotrExtentsTest() : memory(64 * 1024) {}
+
+  ~S3MotrExtentsTest() {
+    if (rw_ctx) {
+      free_basic_rw_op_ctx(rw_ctx);
+    }
+  }
+
+  void add_buffers(size_t count, size_t size) {
+    size_t used = 0;
+    for (const auto &buffer : buffers) {
+      used += buffer.second;
+    }
+    for (size_t i = 0; i < count; ++i, used += size) {
+      buffers.emplace_back(&memory[used], size);
+    }
+  }
+
+  // Segments as (offset in object, offset in memory, length).
+  std::vector<std::vector<size_t>> set_up(const S3MotrExtents &extents) {
+    const size_t count = s3_motr_extents_segment_count(buffers, extents);
+    rw_ctx = create_basic_rw_op_ctx(count, 0);
+    s3_motr_extents_set_up(buffers, extents, rw_ctx);
+
+    std::vector<std::vector<size_t>> segments;
+    for (size_t i = 0; i < count; ++i) {
+      EXPECT_EQ(rw_ctx->data->ov_vec.v_count[i],
+                rw_ctx->ext->iv_vec.v_count[i]);
+      EXPECT_EQ(0, rw_ctx->attr->ov_vec.v_count[i]);
+      segments.push_back(
+          {(size_t)rw_ctx->ext->iv_index[i],
+           (size_t)((char *)rw_ctx->data->ov_buf[i] - &memory[0]),
+           (size_t)rw_ctx->ext->iv_vec.v_count[i]});
+    }
+    return segments;
+  }
+};
+
+TEST_F(S3MotrExtentsTest, Sizes) {
+  const S3MotrExtents extents = {{8192, 4096}, {0, 4096}, {65536, 16384}};
+  EXPECT_EQ(24576, s3_motr_extents_total_size(extents));
+  EXPECT_EQ(81920, s3_motr_extents_end(extents));
+  EXPECT_EQ(0, s3_motr_extents_end({}));
+  EXPECT_TRUE(s3_motr_extents_aligned(extents, 4096));
+  EXPECT_FALSE(s3_motr_extents_aligned(extents, 8192));
+  EXPECT_FALSE(s3_motr_extents_aligned({{0, 0}}, 4096));
+}
+
+TEST_F(S3MotrExtentsTest, ExtentsOfBufferSize) {
+  add_buffers(3, 4096);
+  auto segments = set_up({{8192, 4096}, {0, 4096}, {65536, 4096}});
+  std::vector<std::vector<size_t>> expected = {
+      {8192, 0, 4096}, {0, 4096, 4096}, {65536, 8192, 4096}};
+  EXPECT_EQ(expected, segments);
+}
+
+TEST_F(S3MotrExtentsTest, ExtentsSpanBuffers) {
+  add_buffers(4, 16384);
+  auto segments = set_up({{1048576, 8192}, {0, 32768}, {4096, 16384}});
+  std::vector<std::vector<size_t>> expected = {{1048576, 0, 8192},
+                                               {0, 8192, 8192},
+                                               {8192, 16384, 16384},
+                                               {24576, 32768, 8192},
+                                               {4096, 40960, 8192},
+                                               {12288, 49152, 8192}};
+  EXPECT_EQ(expected, segments);
+}
+
+TEST_F(S3MotrExtentsTest, UnusedAndEmptyBuffers) {
+  add_buffers(1, 4096);
+  add_buffers(1, 0);
+  add_buffers(2, 4096);
+  auto segments = set_up({{4096, 8192}});
+  std::vector<std::vector<size_t>> expected = {{4096, 0, 4096},
+                                               {8192, 4096, 4096}};
+  EXPECT_EQ(expected, segments);
+}
@@ -0,0 +1,341 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "s3_callback_test_helpers.h"
+#include "s3_motr_kvs_group_commit.h"
+#include "s3_ut_common.h"
+
+#include "mock_event_wrapper.h"
+#include "mock_s3_factory.h"
+#include "mock_s3_motr_wrapper.h"
+#include "mock_s3_request_object.h"
+
+using ::testing::_;
+using ::testing::An;
+using ::testing::AtLeast;
+using ::testing::Invoke;
+using ::testing::Return;
+
+static void dummy_request_cb(evhtp_request_t *req, void *arg) {}
+
+class S3MotrKVSGroupCommitTest : public testing::Test {
+ protected:
+  S3MotrKVSGroupCommitTest() {
+    evbase = event_base_new();
+    req = evhtp_request_new(dummy_request_cb, evbase);
+    EvhtpWrapper *evhtp_obj_ptr = new EvhtpWrapper();
+    ptr_mock_request =
+        std::make_shared<MockS3RequestObject>(req, evhtp_obj_ptr);
+    ptr_mock_s3motr = std::make_shared<MockS3Motr>();
+    motr_kvs_writer_factory = std::make_shared<MockS3MotrKVSWriterFactory>(
+        ptr_mock_request, ptr_mock_s3motr);
+
+    mock_event_obj_ptr = std::make_shared<MockEventWrapper>();
+    EXPECT_CALL(*mock_event_obj_ptr, new_event(_, _, _, _, _))
+        .WillRepeatedly(Return((struct event *)&dummy_event));
+    EXPECT_CALL(*mock_event_obj_ptr, add_event(_, _)).Times(AtLeast(0));
+    EXPECT_CALL(*mock_event_obj_ptr, del_event(_)).Times(AtLeast(0));
+    EXPECT_CALL(*mock_event_obj_ptr, free_event(_)).Times(AtLeast(0));
+    EXPECT_CALL(*ptr_mock_s3motr, motr_idx_init(_, _, _)).Times(AtLeast(0));
+    EXPECT_CALL(*ptr_mock_s3motr, motr_idx_fini(_)).Times(AtLeast(0));
+
+    group_commit = std::make_shared<S3MotrKVSGroupCommit>(
+        mock_event_obj_ptr, evbase, 500, 4, motr_kvs_writer_factory);
+    oid = {0xffff, 0xfff1f};
+
+    for (int i = 0; i < 4; ++i) {
+      writers.push_back(
+          std::make_shared<S3MotrKVSWriter>(ptr_mock_request, ptr_mock_s3motr));
+    }
+  }
+
+  ~S3MotrKVSGroupCommitTest() {
+    group_commit.reset();
+    writers.clear();
+    event_base_free(evbase);
+  }
+
+  // Captures the multi-key operation issued by group commit.
+  void expect_batch_put(int times) {
+    EXPECT_CALL(*(motr_kvs_writer_factory->mock_motr_kvs_writer),
+                put_keyval(_, An<const std::map<std::string, std::string> &>(),
+                           _, _))
+        .Times(times)
+        .WillRepeatedly(Invoke(
+            [this](struct m0_uint128,
+                   const std::map<std::string, std::string> &kv_list,
+                   std::function<void(void)> on_success,
+                   std::function<void(void)> on_failed) {
+              batch_kv_list = kv_list;
+              batch_on_success = on_success;
+              batch_on_failed = on_failed;
+            }));
+  }
+
+  int dummy_event = 0;
+  evbase_t *evbase;
+  evhtp_request_t *req;
+  struct m0_uint128 oid;
+  std::shared_ptr<MockS3RequestObject> ptr_mock_request;
+  std::shared_ptr<MockS3Motr> ptr_mock_s3motr;
+  std::shared_ptr<MockEventWrapper> mock_event_obj_ptr;
+  std::shared_ptr<MockS3MotrKVSWriterFactory> motr_kvs_writer_factory;
+  std::shared_ptr<S3MotrKVSGroupCommit> group_commit;
+  std::vector<std::shared_ptr<S3MotrKVSWriter>> writers;
+  S3CallBack callbacks[4];
+
+  std::map<std::string, std::string> batch_kv_list;
+  std::function<void(void)> batch_on_success;
+  std::function<void(void)> batch_on_failed;
+};
+
+TEST_F(S3MotrKVSGroupCommitTest, QueuedUntilTimer) {
+  expect_batch_put(1);
+  for (int i = 0; i < 2; ++i) {
+    writers[i]->handler_on_success =
+        std::bind(&S3CallBack::on_success, &callbacks[i]);
+    writers[i]->handler_on_failed =
+        std::bind(&S3CallBack::on_failed, &callbacks[i]);
+  }
+  group_commit->put_keyval(writers[0].get(), oid, "key0", "value0");
+  group_commit->put_keyval(writers[1].get(), oid, "key1", "value1");
+  EXPECT_EQ(2, group_commit->get_queued_count());
+  EXPECT_TRUE(batch_kv_list.empty());
+
+  group_commit->action_callback();
+  EXPECT_EQ(0, group_commit->get_queued_count());
+  EXPECT_EQ(1, group_commit->get_inflight_batches_count());
+  ASSERT_EQ(2, batch_kv_list.size());
+  EXPECT_EQ("value0", batch_kv_list["key0"]);
+  EXPECT_EQ("value1", batch_kv_list["key1"]);
+
+  batch_on_success();
+  EXPECT_EQ(0, group_commit->get_inflight_batches_count());
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_TRUE(callbacks[i].success_called);
+    EXPECT_FALSE(callbacks[i].fail_called);
+    EXPECT_EQ(S3MotrKVSWriterOpState::created, writers[i]->get_state());
+  }
+}
+
+TEST_F(S3MotrKVSGroupCommitTest, FlushOnMaxKeys) {
+  expect_batch_put(1);
+  for (int i = 0; i < 4; ++i) {
+    writers[i]->handler_on_success =
+        std::bind(&S3CallBack::on_success, &callbacks[i]);
+    writers[i]->handler_on_failed =
+        std::bind(&S3CallBack::on_failed, &callbacks[i]);
+    group_commit->put_keyval(writers[i].get(), oid, "key" + std::to_string(i),
+                             "value");
+  }
+  // Flushed without waiting for the timer.
+  EXPECT_EQ(0, group_commit->get_queued_count());
+  EXPECT_EQ(4, batch_kv_list.size());
+
+  batch_on_success();
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_TRUE(callbacks[i].success_called);
+  }
+}
+
+TEST_F(S3MotrKVSGroupCommitTest, SeparateBatchPerIndex) {
+  expect_batch_put(0);
+  struct m0_uint128 other_oid = {0xffff, 0xfff2f};
+  group_commit->put_keyval(writers[0].get(), oid, "key", "value");
+  group_commit->put_keyval(writers[1].get(), other_oid, "key", "value");
+  group_commit->delete_keyval(writers[2].get(), oid, "key");
+  EXPECT_EQ(3, group_commit->get_queued_count());
+}
+
+TEST_F(S3MotrKVSGroupCommitTest, DuplicateKeyIsNotBatched) {
+  expect_batch_put(0);
+  for (int i = 0; i < 2; ++i) {
+    writers[i]->handler_on_success =
+        std::bind(&S3CallBack::on_success, &callbacks[i]);
+    writers[i]->handler_on_failed =
+        std::bind(&S3CallBack::on_failed, &callbacks[i]);
+  }
+  std::vector<std::string> values;
+  EXPECT_CALL(*ptr_mock_s3motr, motr_idx_op(_, M0_IC_PUT, _, _, _, _, _))
+      .Times(2)
+      .WillRepeatedly(Invoke([&](struct m0_idx *, enum m0_idx_opcode,
+                                 struct m0_bufvec *, struct m0_bufvec *vals,
+                                 int *, unsigned int, struct m0_op **) {
+        values.push_back(std::string((char *)vals->ov_buf[0],
+                                     vals->ov_vec.v_count[0]));
+        return -1;
+      }));
+
+  group_commit->put_keyval(writers[0].get(), oid, "key", "value0");
+  group_commit->put_keyval(writers[1].get(), oid, "key", "value1");
+  EXPECT_EQ(2, group_commit->get_queued_count());
+
+  // Second put of the key waits until the first one is done.
+  group_commit->action_callback();
+  EXPECT_EQ(0, group_commit->get_queued_count());
+  EXPECT_EQ((std::vector<std::string>{"value0", "value1"}), values);
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_TRUE(callbacks[i].fail_called);
+    EXPECT_EQ(S3MotrKVSWriterOpState::failed_to_launch,
+              writers[i]->get_state());
+  }
+}
+
+TEST_F(S3MotrKVSGroupCommitTest, InterleavedPutDeleteKeepOrder) {
+  expect_batch_put(1);
+  for (int i = 0; i < 4; ++i) {
+    writers[i]->handler_on_success =
+        std::bind(&S3CallBack::on_success, &callbacks[i]);
+    writers[i]->handler_on_failed =
+        std::bind(&S3CallBack::on_failed, &callbacks[i]);
+  }
+  // Set up by S3MotrKVSWriter::delete_keyval before it queues the key.
+  writers[1]->oid_list = {oid};
+  writers[1]->keys_list = {"key"};
+  std::vector<enum m0_idx_opcode> opcodes;
+  EXPECT_CALL(*ptr_mock_s3motr, motr_idx_op(_, _, _, _, _, _, _))
+      .Times(2)
+      .WillRepeatedly(Invoke([&](struct m0_idx *, enum m0_idx_opcode opcode,
+                                 struct m0_bufvec *, struct m0_bufvec *, int *,
+                                 unsigned int, struct m0_op **) {
+        opcodes.push_back(opcode);
+        return -1;
+      }));
+
+  group_commit->put_keyval(writers[0].get(), oid, "key", "value0");
+  group_commit->delete_keyval(writers[1].get(), oid, "key");
+  group_commit->put_keyval(writers[2].get(), oid, "key", "value2");
+  group_commit->put_keyval(writers[3].get(), oid, "other", "value3");
+
+  // Put of "key" is batched with the put of another key, the delete and the
+  // second put wait for it.
+  group_commit->action_callback();
+  ASSERT_EQ(2, batch_kv_list.size());
+  EXPECT_EQ("value0", batch_kv_list["key"]);
+  EXPECT_EQ(2, group_commit->get_queued_count());
+
+  // Still in flight on the next window.
+  group_commit->action_callback();
+  EXPECT_EQ(2, group_commit->get_queued_count());
+  EXPECT_EQ(1, group_commit->get_inflight_batches_count());
+  EXPECT_TRUE(opcodes.empty());
+
+  // Once the batch is done, the delete goes, then the second put.
+  batch_on_success();
+  EXPECT_TRUE(callbacks[0].success_called);
+  EXPECT_TRUE(callbacks[3].success_called);
+  EXPECT_EQ((std::vector<enum m0_idx_opcode>{M0_IC_DEL, M0_IC_PUT}), opcodes);
+  EXPECT_TRUE(callbacks[1].fail_called);
+  EXPECT_TRUE(callbacks[2].fail_called);
+  EXPECT_EQ(0, group_commit->get_queued_count());
+}
+
+TEST_F(S3MotrKVSGroupCommitTest, BatchFailedRetriesEachKey) {
+  expect_batch_put(1);
+  for (int i = 0; i < 2; ++i) {
+    writers[i]->handler_on_success =
+        std::bind(&S3CallBack::on_success, &callbacks[i]);
+    writers[i]->handler_on_failed =
+        std::bind(&S3CallBack::on_failed, &callbacks[i]);
+  }
+  group_commit->put_keyval(writers[0].get(), oid, "key0", "value0");
+  group_commit->put_keyval(writers[1].get(), oid, "key1", "value1");
+  group_commit->action_callback();
+
+  EXPECT_CALL(*ptr_mock_s3motr, motr_idx_op(_, _, _, _, _, _, _))
+      .Times(2)
+      .WillRepeatedly(Return(-1));
+  batch_on_failed();
+
+  EXPECT_EQ(0, group_commit->get_inflight_batches_count());
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_FALSE(callbacks[i].success_called);
+    EXPECT_TRUE(callbacks[i].fail_called);
+    EXPECT_EQ(S3MotrKVSWriterOpState::failed_to_launch,
+              writers[i]->get_state());
+  }
+}
+
+TEST_F(S3MotrKVSGroupCommitTest, DeleteBatch) {
+  std::vector<std::string> keys;
+  EXPECT_CALL(*(motr_kvs_writer_factory->mock_motr_kvs_writer),
+              delete_keyval(_, _, _, _))
+      .WillOnce(Invoke([&keys](struct m0_uint128,
+                               std::vector<std::string> batch_keys,
+                               std::function<void(void)>,
+                               std::function<void(void)>) {
+        keys = batch_keys;
+      }));
+  group_commit->delete_keyval(writers[0].get(), oid, "key0");
+  group_commit->delete_keyval(writers[1].get(), oid, "key1");
+  group_commit->action_callback();
+
+  EXPECT_EQ((std::vector<std::string>{"key0", "key1"}), keys);
+}
+
+TEST_F(S3MotrKVSGroupCommitTest, ForgetWriter) {
+  expect_batch_put(1);
+  for (int i = 0; i < 3; ++i) {
+    writers[i]->handler_on_success =
+        std::bind(&S3CallBack::on_success, &callbacks[i]);
+    writers[i]->handler_on_failed =
+        std::bind(&S3CallBack::on_failed, &callbacks[i]);
+    group_commit->put_keyval(writers[i].get(), oid, "key" + std::to_string(i),
+                             "value");
+  }
+  // Queued writer is dropped from the batch.
+  group_commit->forget(writers[2].get());
+  EXPECT_EQ(2, group_commit->get_queued_count());
+
+  group_commit->action_callback();
+  EXPECT_EQ(2, batch_kv_list.size());
+
+  // Writer of in-flight batch is not called back.
+  group_commit->forget(writers[0].get());
+  batch_on_success();
+  EXPECT_FALSE(callbacks[0].success_called);
+  EXPECT_TRUE(callbacks[1].success_called);
+  EXPECT_FALSE(callbacks[2].success_called);
+}
+
+TEST_F(S3MotrKVSGroupCommitTest, TimerStopsWhenIdle) {
+  EXPECT_CALL(*mock_event_obj_ptr, new_event(_, _, _, _, _))
+      .Times(1)
+      .WillOnce(Return((struct event *)&dummy_event));
+  EXPECT_CALL(*mock_event_obj_ptr, del_event(_)).Times(1);
+  EXPECT_CALL(*mock_event_obj_ptr, free_event(_)).Times(1);
+  EXPECT_CALL(*(motr_kvs_writer_factory->mock_motr_kvs_writer),
+              delete_keyval(_, _, _, _)).Times(1);
+
+  group_commit->delete_keyval(writers[0].get(), oid, "key0");
+  group_commit->delete_keyval(writers[1].get(), oid, "key1");
+  group_commit->action_callback();
+  // Nothing queued during the window.
+  group_commit->action_callback();
+}
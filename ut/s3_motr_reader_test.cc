@@ -41,6 +41,21 @@ static int s3_test_motr_obj_op(struct m0_obj *obj, enum m0_obj_opcode opcode,
   return 0;
 }
 
+// Extents of the last motr_obj_op() as (offset, length).
+static std::vector<std::pair<uint64_t, uint64_t>> s3_test_obj_op_extents;
+
+static int s3_test_motr_obj_op_save_extents(
+    struct m0_obj *obj, enum m0_obj_opcode opcode, struct m0_indexvec *ext,
+    struct m0_bufvec *data, struct m0_bufvec *attr, uint64_t mask,
+    uint32_t flags, struct m0_op **op) {
+  s3_test_obj_op_extents.clear();
+  for (uint32_t i = 0; i < ext->iv_vec.v_nr; ++i) {
+    s3_test_obj_op_extents.emplace_back(ext->iv_index[i],
+                                        ext->iv_vec.v_count[i]);
+  }
+  return s3_test_motr_obj_op(obj, opcode, ext, data, attr, mask, flags, op);
+}
+
 static int s3_test_allocate_op(struct m0_entity *entity, struct m0_op **ops) {
   *ops = (struct m0_op *)calloc(1, sizeof(struct m0_op));
   return 0;
@@ -200,6 +215,53 @@ TEST_F(S3MotrReaderTest, ReadObjectDataTest) {
   EXPECT_FALSE(s3motrreader_callbackobj.fail_called);
 }
 
+TEST_F(S3MotrReaderTest, ReadObjectExtentsTest) {
+  S3CallBack s3motrreader_callbackobj;
+
+  motr_reader_ptr->obj_ctx = (struct s3_motr_obj_context *)calloc(
+      1, sizeof(struct s3_motr_obj_context));
+  motr_reader_ptr->obj_ctx->objs =
+      (struct m0_obj *)calloc(1, sizeof(struct m0_obj));
+  motr_reader_ptr->obj_ctx->obj_count = 1;
+  motr_reader_ptr->obj_ctx->n_initialized_contexts = 1;
+  EXPECT_CALL(*s3_motr_api_mock,
+              motr_obj_op(_, M0_OC_READ, _, _, _, _, M0_OOF_NOHOLE, _))
+      .WillOnce(Invoke(s3_test_motr_obj_op_save_extents));
+  EXPECT_CALL(*s3_motr_api_mock, motr_obj_fini(_)).Times(1);
+  EXPECT_CALL(*s3_motr_api_mock, motr_op_setup(_, _, _)).Times(1);
+  EXPECT_CALL(*s3_motr_api_mock, motr_op_launch(_, _, _, _))
+      .WillRepeatedly(Invoke(s3_test_motr_op_launch));
+
+  const size_t unit_size = motr_reader_ptr->motr_unit_size;
+  motr_reader_ptr->is_object_opened = true;
+  motr_reader_ptr->read_object_extents(
+      {{4 * unit_size, unit_size}, {unit_size, unit_size}},
+      std::bind(&S3CallBack::on_success, &s3motrreader_callbackobj),
+      std::bind(&S3CallBack::on_failed, &s3motrreader_callbackobj));
+
+  EXPECT_TRUE(s3motrreader_callbackobj.success_called);
+  EXPECT_FALSE(s3motrreader_callbackobj.fail_called);
+  EXPECT_EQ(2 * unit_size, motr_reader_ptr->last_index);
+
+  // Segments split at evbuffer buffers, merged back they are the extents.
+  std::vector<std::pair<uint64_t, uint64_t>> merged;
+  for (const auto &extent : s3_test_obj_op_extents) {
+    if (!merged.empty() &&
+        merged.back().first + merged.back().second == extent.first) {
+      merged.back().second += extent.second;
+    } else {
+      merged.push_back(extent);
+    }
+  }
+  std::vector<std::pair<uint64_t, uint64_t>> expected = {
+      {4 * unit_size, unit_size}, {unit_size, unit_size}};
+  EXPECT_EQ(expected, merged);
+
+  struct evbuffer *evbuf = motr_reader_ptr->get_evbuffer_ownership();
+  EXPECT_LE(2 * unit_size, evbuffer_get_length(evbuf));
+  evbuffer_free(evbuf);
+}
+
 TEST_F(S3MotrReaderTest, ReadObjectDataCheckNoHoleFlagTest) {
   S3CallBack s3motrreader_callbackobj;
 
@@ -49,6 +49,21 @@ static int s3_test_motr_obj_op(struct m0_obj *obj, enum m0_obj_opcode opcode,
   return 0;
 }
 
+// Extents of the last motr_obj_op() as (offset, length).
+static std::vector<std::pair<uint64_t, uint64_t>> s3_test_obj_op_extents;
+
+static int s3_test_motr_obj_op_save_extents(
+    struct m0_obj *obj, enum m0_obj_opcode opcode, struct m0_indexvec *ext,
+    struct m0_bufvec *data, struct m0_bufvec *attr, uint64_t mask,
+    uint32_t flags, struct m0_op **op) {
+  s3_test_obj_op_extents.clear();
+  for (uint32_t i = 0; i < ext->iv_vec.v_nr; ++i) {
+    s3_test_obj_op_extents.emplace_back(ext->iv_index[i],
+                                        ext->iv_vec.v_count[i]);
+  }
+  return s3_test_motr_obj_op(obj, opcode, ext, data, attr, mask, flags, op);
+}
+
 static int s3_test_allocate_op(struct m0_entity *entity, struct m0_op **ops) {
   *ops = (struct m0_op *)calloc(1, sizeof(struct m0_op));
   return 0;
@@ -531,6 +546,45 @@ TEST_F(S3MotrWiterTest, WriteContentSuccessfulTest) {
   EXPECT_FALSE(S3MotrWiter_callbackobj.fail_called);
 }
 
+TEST_F(S3MotrWiterTest, WriteContentAtTest) {
+  S3CallBack S3MotrWiter_callbackobj;
+  std::vector<char> data(3 * 4096, 'A');
+
+  motr_writer_ptr = std::make_shared<S3MotrWiter>(request_mock, obj_oid, pv_id,
+                                                  0, s3_motr_api_mock);
+  motr_writer_ptr->set_layout_id(layout_id);
+
+  EXPECT_CALL(*s3_motr_api_mock, motr_obj_init(_, _, _, _));
+  EXPECT_CALL(*s3_motr_api_mock, motr_entity_open(_, _))
+      .WillOnce(Invoke(s3_test_allocate_op));
+  EXPECT_CALL(*s3_motr_api_mock, motr_obj_op(_, M0_OC_WRITE, _, _, _, _, _, _))
+      .WillOnce(Invoke(s3_test_motr_obj_op_save_extents));
+  EXPECT_CALL(*s3_motr_api_mock, motr_op_setup(_, _, _)).Times(2);
+  EXPECT_CALL(*s3_motr_api_mock, motr_op_launch(_, _, _, _))
+      .WillRepeatedly(Invoke(s3_test_motr_op_launch));
+  EXPECT_CALL(*s3_motr_api_mock, motr_obj_fini(_)).Times(1);
+
+  S3Option::get_instance()->set_eventbase(evbase);
+
+  S3BufferSequence buffers;
+  buffers.emplace_back(&data[0], 2 * 4096);
+  buffers.emplace_back(&data[2 * 4096], 4096);
+  motr_writer_ptr->write_content_at(
+      std::bind(&S3CallBack::on_success, &S3MotrWiter_callbackobj),
+      std::bind(&S3CallBack::on_failed, &S3MotrWiter_callbackobj), buffers,
+      {{1048576, 4096}, {0, 8192}});
+
+  EXPECT_TRUE(motr_writer_ptr->get_state() == S3MotrWiterOpState::saved);
+  EXPECT_EQ(data.size(), motr_writer_ptr->size_in_current_write);
+  EXPECT_EQ(0, motr_writer_ptr->last_index);
+  EXPECT_TRUE(S3MotrWiter_callbackobj.success_called);
+  EXPECT_FALSE(S3MotrWiter_callbackobj.fail_called);
+
+  std::vector<std::pair<uint64_t, uint64_t>> expected = {
+      {1048576, 4096}, {0, 4096}, {4096, 4096}};
+  EXPECT_EQ(expected, s3_test_obj_op_extents);
+}
+
 TEST_F(S3MotrWiterTest, WriteContentFailedTest) {
   S3CallBack S3MotrWiter_callbackobj;
   bool is_last_buf = true;
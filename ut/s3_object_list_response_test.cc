@@ -330,3 +330,43 @@ TEST_F(S3ObjectListResponseTest,
   CHECK_MULTIPART_XML_RESPONSE;
 }
 
+
+// Objects added after render_contents_on_add() are rendered at once and
+// their metadata is not used by get_xml().
+TEST_F(S3ObjectListResponseTest, ObjectListResponseRenderContentsOnAdd) {
+  response_under_test->set_max_keys("test_max_key_count");
+  response_under_test->render_contents_on_add("qWwZGnGYTga8gbpcuY79SA", "1",
+                                              "2");
+
+  std::shared_ptr<MockS3ObjectMetadata> mock_obj =
+      std::make_shared<MockS3ObjectMetadata>(mock_request);
+  EXPECT_CALL(*mock_obj, get_object_name()).WillOnce(Return("obj1"));
+  EXPECT_CALL(*mock_obj, get_last_modified_iso())
+      .WillOnce(Return("last_modified"));
+  EXPECT_CALL(*mock_obj, get_md5()).WillOnce(Return("abcd"));
+  EXPECT_CALL(*mock_obj, get_content_length_str()).WillOnce(Return("1024"));
+  EXPECT_CALL(*mock_obj, get_storage_class()).WillOnce(Return("STANDARD"));
+  EXPECT_CALL(*mock_obj, get_canonical_id())
+      .WillRepeatedly(Return("qWwZGnGYTga8gbpcuY79SA"));
+  EXPECT_CALL(*mock_obj, get_account_name()).WillOnce(Return("s3user"));
+
+  response_under_test->add_object(mock_obj);
+  mock_obj.reset();
+
+  EXPECT_EQ(1, response_under_test->size());
+  std::vector<std::string> keys = response_under_test->get_keys();
+  ASSERT_EQ(1, keys.size());
+  EXPECT_EQ("obj1", keys[0]);
+
+  std::string response =
+      response_under_test->get_xml("qWwZGnGYTga8gbpcuY79SA", "1", "2");
+  CHECK_XML_RESPONSE;
+  EXPECT_THAT(response,
+              HasSubstr("<Contents><Key>obj1</Key>"
+                        "<LastModified>last_modified</LastModified>"
+                        "<ETag>\"abcd\"</ETag><Size>1024</Size>"
+                        "<StorageClass>STANDARD</StorageClass><Owner>"
+                        "<ID>qWwZGnGYTga8gbpcuY79SA</ID>"
+                        "<DisplayName>s3user</DisplayName></Owner>"
+                        "</Contents></ListBucketResult>"));
+}
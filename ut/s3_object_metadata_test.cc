@@ -534,6 +534,186 @@ TEST_F(S3ObjectMetadataTest, SaveMetadataFailedToLaunch) {
             metadata_obj_under_test->state);
 }
 
+TEST_F(S3ObjectMetadataTest, SaveParallel) {
+  S3Option::get_instance()->set_parallel_metadata_save_enable(true);
+  metadata_obj_under_test_with_oid->regenerate_version_id();
+  metadata_obj_under_test_with_oid->set_replaced_metadata(nullptr);
+
+  // Both entries are written without waiting for each other.
+  EXPECT_CALL(*(motr_kvs_writer_factory->mock_motr_kvs_writer),
+              put_keyval(_, metadata_obj_under_test_with_oid
+                                    ->get_version_key_in_index(),
+                         _, _, _)).Times(1);
+  EXPECT_CALL(*(motr_kvs_writer_factory->mock_motr_kvs_writer),
+              put_keyval(_, "objectname", _, _, _))
+      .Times(1);
+  metadata_obj_under_test_with_oid->save(
+      std::bind(&S3CallBack::on_success, &s3objectmetadata_callbackobj),
+      std::bind(&S3CallBack::on_failed, &s3objectmetadata_callbackobj));
+  EXPECT_EQ(2, metadata_obj_under_test_with_oid->pending_saves);
+  S3Option::get_instance()->set_parallel_metadata_save_enable(false);
+}
+
+TEST_F(S3ObjectMetadataTest, SaveParallelNotUsedIfReplacedUnknown) {
+  S3Option::get_instance()->set_parallel_metadata_save_enable(true);
+  metadata_obj_under_test_with_oid->regenerate_version_id();
+
+  EXPECT_CALL(*(motr_kvs_writer_factory->mock_motr_kvs_writer),
+              put_keyval(_, metadata_obj_under_test_with_oid
+                                    ->get_version_key_in_index(),
+                         _, _, _)).Times(1);
+  metadata_obj_under_test_with_oid->save(
+      std::bind(&S3CallBack::on_success, &s3objectmetadata_callbackobj),
+      std::bind(&S3CallBack::on_failed, &s3objectmetadata_callbackobj));
+  EXPECT_EQ(0, metadata_obj_under_test_with_oid->pending_saves);
+  S3Option::get_instance()->set_parallel_metadata_save_enable(false);
+}
+
+TEST_F(S3ObjectMetadataTest, SaveParallelSuccess) {
+  metadata_obj_under_test->handler_on_success =
+      std::bind(&S3CallBack::on_success, &s3objectmetadata_callbackobj);
+  metadata_obj_under_test->pending_saves = 2;
+  metadata_obj_under_test->save_object_metadata_parallel_successful();
+  EXPECT_FALSE(s3objectmetadata_callbackobj.success_called);
+  metadata_obj_under_test->save_version_metadata_parallel_successful();
+  EXPECT_TRUE(s3objectmetadata_callbackobj.success_called);
+  EXPECT_EQ(S3ObjectMetadataState::saved, metadata_obj_under_test->state);
+}
+
+TEST_F(S3ObjectMetadataTest, SaveParallelBothFailed) {
+  metadata_obj_under_test->motr_kv_writer =
+      motr_kvs_writer_factory->mock_motr_kvs_writer;
+  metadata_obj_under_test->motr_kv_version_writer =
+      motr_kvs_writer_factory->mock_motr_kvs_writer;
+  metadata_obj_under_test->handler_on_failed =
+      std::bind(&S3CallBack::on_failed, &s3objectmetadata_callbackobj);
+  EXPECT_CALL(*(motr_kvs_writer_factory->mock_motr_kvs_writer), get_state())
+      .WillRepeatedly(Return(S3MotrKVSWriterOpState::failed_to_launch));
+  EXPECT_CALL(*(motr_kvs_writer_factory->mock_motr_kvs_writer),
+              delete_keyval(_, _, _, _)).Times(0);
+  EXPECT_CALL(*(motr_kvs_writer_factory->mock_motr_kvs_writer),
+              put_keyval(_, _, _, _, _)).Times(0);
+  metadata_obj_under_test->pending_saves = 2;
+  metadata_obj_under_test->save_version_metadata_parallel_failed();
+  metadata_obj_under_test->save_object_metadata_parallel_failed();
+  EXPECT_TRUE(s3objectmetadata_callbackobj.fail_called);
+  EXPECT_EQ(S3ObjectMetadataState::failed_to_launch,
+            metadata_obj_under_test->state);
+}
+
+TEST_F(S3ObjectMetadataTest, SaveParallelVersionFailedRestoresReplaced) {
+  metadata_obj_under_test_with_oid->motr_kv_writer =
+      motr_kvs_writer_factory->mock_motr_kvs_writer;
+  metadata_obj_under_test_with_oid->motr_kv_version_writer =
+      motr_kvs_writer_factory->mock_motr_kvs_writer;
+  metadata_obj_under_test_with_oid->handler_on_failed =
+      std::bind(&S3CallBack::on_failed, &s3objectmetadata_callbackobj);
+  metadata_obj_under_test_with_oid->set_replaced_metadata(
+      metadata_obj_under_test);
+  EXPECT_CALL(*(motr_kvs_writer_factory->mock_motr_kvs_writer), get_state())
+      .WillRepeatedly(Return(S3MotrKVSWriterOpState::failed));
+  // Entry is read back first.
+  EXPECT_CALL(*(motr_kvs_reader_factory->mock_motr_kvs_reader),
+              get_keyval(_, "objectname", _, _)).Times(1);
+  metadata_obj_under_test_with_oid->pending_saves = 2;
+  metadata_obj_under_test_with_oid->save_object_metadata_parallel_successful();
+  metadata_obj_under_test_with_oid->save_version_metadata_parallel_failed();
+  EXPECT_FALSE(s3objectmetadata_callbackobj.fail_called);
+  EXPECT_EQ(S3ObjectMetadataState::failed,
+            metadata_obj_under_test_with_oid->state);
+
+  EXPECT_CALL(*(motr_kvs_reader_factory->mock_motr_kvs_reader), get_value())
+      .WillOnce(Return(metadata_obj_under_test_with_oid->to_json()));
+  EXPECT_CALL(*(motr_kvs_writer_factory->mock_motr_kvs_writer),
+              put_keyval(_, "objectname", metadata_obj_under_test->to_json(),
+                         _, _)).Times(1);
+  metadata_obj_under_test_with_oid->rollback_object_metadata_loaded();
+  EXPECT_FALSE(s3objectmetadata_callbackobj.fail_called);
+
+  metadata_obj_under_test_with_oid->rollback_successful();
+  EXPECT_TRUE(s3objectmetadata_callbackobj.fail_called);
+}
+
+TEST_F(S3ObjectMetadataTest, SaveParallelVersionFailedRemovesNew) {
+  metadata_obj_under_test_with_oid->motr_kv_writer =
+      motr_kvs_writer_factory->mock_motr_kvs_writer;
+  metadata_obj_under_test_with_oid->motr_kv_version_writer =
+      motr_kvs_writer_factory->mock_motr_kvs_writer;
+  metadata_obj_under_test_with_oid->set_replaced_metadata(nullptr);
+  EXPECT_CALL(*(motr_kvs_writer_factory->mock_motr_kvs_writer), get_state())
+      .WillRepeatedly(Return(S3MotrKVSWriterOpState::failed));
+  EXPECT_CALL(*(motr_kvs_reader_factory->mock_motr_kvs_reader),
+              get_keyval(_, "objectname", _, _)).Times(1);
+  EXPECT_CALL(*(motr_kvs_reader_factory->mock_motr_kvs_reader), get_value())
+      .WillOnce(Return(metadata_obj_under_test_with_oid->to_json()));
+  EXPECT_CALL(*(motr_kvs_writer_factory->mock_motr_kvs_writer),
+              delete_keyval(_, std::vector<std::string>{"objectname"}, _, _))
+      .Times(1);
+  metadata_obj_under_test_with_oid->pending_saves = 2;
+  metadata_obj_under_test_with_oid->save_version_metadata_parallel_failed();
+  metadata_obj_under_test_with_oid->save_object_metadata_parallel_successful();
+  metadata_obj_under_test_with_oid->rollback_object_metadata_loaded();
+}
+
+TEST_F(S3ObjectMetadataTest, SaveParallelRollbackKeepsNewerEntry) {
+  // Another PUT of the same object is saved after this one, then the version
+  // entry of this one fails.
+  struct m0_uint128 oid = {0x1ffff, 0x1ffff};
+  struct m0_uint128 newer_oid = {0x2ffff, 0x2ffff};
+  metadata_obj_under_test_with_oid->set_oid(oid);
+  metadata_obj_under_test->set_oid(newer_oid);
+  metadata_obj_under_test_with_oid->motr_kv_writer =
+      motr_kvs_writer_factory->mock_motr_kvs_writer;
+  metadata_obj_under_test_with_oid->motr_kv_version_writer =
+      motr_kvs_writer_factory->mock_motr_kvs_writer;
+  metadata_obj_under_test_with_oid->handler_on_failed =
+      std::bind(&S3CallBack::on_failed, &s3objectmetadata_callbackobj);
+  metadata_obj_under_test_with_oid->set_replaced_metadata(nullptr);
+  EXPECT_CALL(*(motr_kvs_writer_factory->mock_motr_kvs_writer), get_state())
+      .WillRepeatedly(Return(S3MotrKVSWriterOpState::failed));
+  EXPECT_CALL(*(motr_kvs_reader_factory->mock_motr_kvs_reader),
+              get_keyval(_, "objectname", _, _)).Times(1);
+  EXPECT_CALL(*(motr_kvs_reader_factory->mock_motr_kvs_reader), get_value())
+      .WillOnce(Return(metadata_obj_under_test->to_json()));
+  EXPECT_CALL(*(motr_kvs_writer_factory->mock_motr_kvs_writer),
+              delete_keyval(_, _, _, _)).Times(0);
+  EXPECT_CALL(*(motr_kvs_writer_factory->mock_motr_kvs_writer),
+              put_keyval(_, _, _, _, _)).Times(0);
+  metadata_obj_under_test_with_oid->pending_saves = 2;
+  metadata_obj_under_test_with_oid->save_object_metadata_parallel_successful();
+  metadata_obj_under_test_with_oid->save_version_metadata_parallel_failed();
+  metadata_obj_under_test_with_oid->rollback_object_metadata_loaded();
+  EXPECT_TRUE(s3objectmetadata_callbackobj.fail_called);
+  EXPECT_EQ(S3ObjectMetadataState::failed,
+            metadata_obj_under_test_with_oid->state);
+}
+
+TEST_F(S3ObjectMetadataTest, SaveParallelObjectFailedRemovesVersion) {
+  metadata_obj_under_test_with_oid->motr_kv_writer =
+      motr_kvs_writer_factory->mock_motr_kvs_writer;
+  metadata_obj_under_test_with_oid->motr_kv_version_writer =
+      motr_kvs_writer_factory->mock_motr_kvs_writer;
+  EXPECT_CALL(*(motr_kvs_writer_factory->mock_motr_kvs_writer), get_state())
+      .WillRepeatedly(Return(S3MotrKVSWriterOpState::failed));
+  EXPECT_CALL(*(motr_kvs_writer_factory->mock_motr_kvs_writer),
+              delete_keyval(_, std::vector<std::string>{
+                                   metadata_obj_under_test_with_oid
+                                       ->get_version_key_in_index()},
+                            _, _)).Times(1);
+  metadata_obj_under_test_with_oid->pending_saves = 2;
+  metadata_obj_under_test_with_oid->save_version_metadata_parallel_successful();
+  metadata_obj_under_test_with_oid->save_object_metadata_parallel_failed();
+}
+
+TEST_F(S3ObjectMetadataTest, SaveParallelRollbackFailed) {
+  metadata_obj_under_test->handler_on_failed =
+      std::bind(&S3CallBack::on_failed, &s3objectmetadata_callbackobj);
+  metadata_obj_under_test->state = S3ObjectMetadataState::failed;
+  metadata_obj_under_test->rollback_failed();
+  EXPECT_TRUE(s3objectmetadata_callbackobj.fail_called);
+  EXPECT_EQ(S3ObjectMetadataState::failed, metadata_obj_under_test->state);
+}
+
 TEST_F(S3ObjectMetadataTest, Remove) {
   EXPECT_CALL(*(motr_kvs_writer_factory->mock_motr_kvs_writer),
               delete_keyval(_, _, _, _)).Times(1);
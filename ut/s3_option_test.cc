@@ -118,6 +118,14 @@ TEST_F(S3OptionsTest, GetOptionsfromFile) {
   EXPECT_FALSE(instance->is_log_buffering_enabled());
   EXPECT_FALSE(instance->is_murmurhash_oid_enabled());
   EXPECT_EQ(3, instance->get_log_flush_frequency_in_sec());
+  EXPECT_FALSE(instance->is_log_async_enabled());
+  EXPECT_EQ(1024, instance->get_log_async_buffer_size_kb());
+  EXPECT_EQ(10, instance->get_log_async_sample_rate());
+  EXPECT_EQ(100, instance->get_audit_logger_batch_max_records());
+  EXPECT_EQ(4, instance->get_audit_logger_max_requests_in_flight());
+  EXPECT_FALSE(instance->is_audit_logger_compress_enabled());
+  EXPECT_FALSE(instance->is_audit_log_async_enabled());
+  EXPECT_EQ(4096, instance->get_audit_log_async_buffer_size_kb());
   EXPECT_EQ(4, instance->get_s3_grace_period_sec());
   EXPECT_FALSE(instance->is_stats_enabled());
   EXPECT_EQ("127.9.7.5", instance->get_statsd_ip_addr());
@@ -127,6 +135,48 @@ TEST_F(S3OptionsTest, GetOptionsfromFile) {
   EXPECT_TRUE(instance->is_s3server_addb_dump_enabled());
   EXPECT_EQ("s3stats-allowlist-test.yaml",
             instance->get_stats_allowlist_filename());
+  EXPECT_FALSE(instance->is_statsd_aggregation_enabled());
+  EXPECT_EQ(1432, instance->get_statsd_max_packet_size());
+  EXPECT_FALSE(instance->is_metrics_enabled());
+  EXPECT_EQ(60, instance->get_metrics_quantile_window_sec());
+  EXPECT_FALSE(instance->is_request_trace_enabled());
+  EXPECT_EQ(1000, instance->get_request_trace_threshold_ms());
+  EXPECT_EQ(100, instance->get_request_trace_max_files());
+  EXPECT_FALSE(instance->is_inflight_requests_enabled());
+  EXPECT_EQ(60, instance->get_inflight_requests_log_interval_sec());
+  EXPECT_EQ(5, instance->get_inflight_requests_log_top_n());
+  EXPECT_EQ(5000, instance->get_inflight_requests_log_threshold_ms());
+  EXPECT_EQ("", instance->get_mgmt_api_admin_account_id());
+  EXPECT_FALSE(instance->is_parallel_metadata_save_enabled());
+  EXPECT_FALSE(instance->is_kvs_group_commit_enabled());
+  EXPECT_EQ(500, instance->get_kvs_group_commit_window_usec());
+  EXPECT_EQ(64, instance->get_kvs_group_commit_max_keys());
+  EXPECT_FALSE(instance->is_bucket_usage_enabled());
+  EXPECT_EQ(10, instance->get_bucket_usage_flush_interval_sec());
+  EXPECT_EQ(0, instance->get_bucket_usage_reconcile_interval_sec());
+  EXPECT_EQ(1000, instance->get_bucket_list_cache_max_accounts());
+  EXPECT_EQ(5, instance->get_bucket_list_cache_expire_sec());
+  EXPECT_EQ(65536, instance->get_motr_completion_queue_size());
+  EXPECT_EQ(256, instance->get_motr_completion_batch_size());
+  EXPECT_FALSE(instance->is_motr_emulator_enabled());
+  EXPECT_EQ(4, instance->get_motr_emulator_threads());
+  EXPECT_EQ(0, instance->get_motr_emulator_latency_usec());
+  EXPECT_EQ(0, instance->get_motr_emulator_bandwidth_mbps());
+  EXPECT_EQ("", instance->get_motr_emulator_dir());
+  EXPECT_FALSE(instance->is_gc_enabled());
+  EXPECT_EQ(100, instance->get_gc_batch_size());
+  EXPECT_EQ(8, instance->get_gc_max_inflight());
+  EXPECT_EQ(100, instance->get_gc_max_deletes_per_sec());
+  EXPECT_EQ(60, instance->get_gc_scan_interval_sec());
+  EXPECT_EQ(900, instance->get_gc_min_record_age_sec());
+  EXPECT_FALSE(instance->is_admission_control_enabled());
+  EXPECT_EQ(1024, instance->get_admission_queue_max_length());
+  EXPECT_EQ(2000, instance->get_admission_queue_max_wait_ms());
+  EXPECT_EQ(1048576, instance->get_admission_small_request_size());
+  EXPECT_FALSE(instance->get_motr_read_mempool_hugepage_arena());
+  EXPECT_FALSE(instance->get_motr_read_mempool_numa_local());
+  EXPECT_FALSE(instance->get_libevent_mempool_hugepage_arena());
+  EXPECT_FALSE(instance->get_libevent_mempool_numa_local());
 }
 
 TEST_F(S3OptionsTest, TestOverrideOptions) {
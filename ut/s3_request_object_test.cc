@@ -176,6 +176,23 @@ TEST_F(S3RequestObjectTest, ReturnsValidHeaderValue) {
             request->get_header_value("Content-Type"));
 }
 
+TEST_F(S3RequestObjectTest, HeaderLookupIsCaseInsensitive) {
+  std::map<std::string, std::string> input_headers;
+  input_headers["content-type"] = "application/xml";
+  input_headers["X-Amz-Decoded-Content-Length"] = "512";
+
+  fake_in_headers(input_headers);
+
+  EXPECT_EQ(std::string("application/xml"),
+            request->get_header_value("Content-Type"));
+  EXPECT_TRUE(request->is_header_present("CONTENT-TYPE"));
+  EXPECT_FALSE(request->is_header_present("Content"));
+  EXPECT_EQ(std::string("512"),
+            request->get_known_header(S3Header::x_amz_decoded_content_length));
+  EXPECT_EQ(std::string(""), request->get_known_header(S3Header::range));
+  EXPECT_EQ(512, request->get_data_length());
+}
+
 TEST_F(S3RequestObjectTest, ReturnsValidHostHeaderValue) {
   std::map<std::string, std::string> input_headers;
   input_headers["Content-Type"] = "application/xml";
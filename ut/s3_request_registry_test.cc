@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+#include <unistd.h>
+
+#include <memory>
+#include <vector>
+
+#include <json/json.h>
+
+#include "mock_s3_request_object.h"
+#include "s3_request_registry.h"
+
+class S3RequestRegistryTest : public testing::Test {
+ protected:
+  std::shared_ptr<MockS3RequestObject> create_request() {
+    evhtp_request_t *req = NULL;
+    EvhtpInterface *evhtp_obj_ptr = new EvhtpWrapper();
+    auto request = std::make_shared<MockS3RequestObject>(req, evhtp_obj_ptr);
+    registry.add(request.get());
+    return request;
+  }
+
+  S3RequestRegistry registry;
+};
+
+TEST_F(S3RequestRegistryTest, Empty) {
+  EXPECT_EQ(0, registry.get_count());
+  EXPECT_TRUE(registry.get_slowest(10).empty());
+  registry.action_callback();
+}
+
+TEST_F(S3RequestRegistryTest, SlowestFirst) {
+  auto oldest = create_request();
+  usleep(1000);
+  auto middle = create_request();
+  usleep(1000);
+  auto newest = create_request();
+  oldest->set_action_str("PutObject");
+  middle->set_action_str("GetObject");
+  newest->set_action_str("HeadBucket");
+  EXPECT_EQ(3, registry.get_count());
+
+  std::vector<S3InFlightRequestInfo> infos = registry.get_slowest(2);
+  ASSERT_EQ(2, infos.size());
+  EXPECT_EQ(oldest->get_request_id(), infos[0].request_id);
+  EXPECT_EQ("PutObject", infos[0].action);
+  EXPECT_EQ("GetObject", infos[1].action);
+  EXPECT_LT(infos[1].elapsed_us, infos[0].elapsed_us);
+
+  EXPECT_EQ(3, registry.get_slowest(10).size());
+
+  registry.remove(oldest.get());
+  EXPECT_EQ(2, registry.get_count());
+  infos = registry.get_slowest(1);
+  ASSERT_EQ(1, infos.size());
+  EXPECT_EQ("GetObject", infos[0].action);
+}
+
+TEST_F(S3RequestRegistryTest, DescribesAsyncOps) {
+  auto request = create_request();
+  request->set_current_task("S3PutObjectAction::validate_put_request");
+  request->async_op_started("get_keyval");
+  request->async_op_started("write_object");
+
+  std::vector<S3InFlightRequestInfo> infos = registry.get_slowest(1);
+  ASSERT_EQ(1, infos.size());
+  EXPECT_EQ("S3PutObjectAction::validate_put_request", infos[0].task);
+  EXPECT_EQ("write_object", infos[0].async_op);
+  EXPECT_EQ(2, infos[0].async_ops_count);
+  EXPECT_LE(infos[0].async_op_elapsed_us, infos[0].elapsed_us);
+
+  request->async_op_finished();
+  request->async_op_finished();
+  // Unbalanced completion is ignored.
+  request->async_op_finished();
+  infos = registry.get_slowest(1);
+  EXPECT_EQ("", infos[0].async_op);
+  EXPECT_EQ(0, infos[0].async_ops_count);
+  EXPECT_EQ(0, infos[0].async_op_elapsed_us);
+}
+
+TEST_F(S3RequestRegistryTest, ToJson) {
+  std::vector<S3InFlightRequestInfo> infos(2);
+  infos[0].request_id = "req-1";
+  infos[0].method = "PUT";
+  infos[0].uri = "/bucket/key";
+  infos[0].action = "PutObject";
+  infos[0].task = "S3PutObjectAction::write_object";
+  infos[0].async_op = "write_object";
+  infos[0].async_ops_count = 1;
+  infos[0].elapsed_us = 7000000;
+  infos[0].async_op_elapsed_us = 6500000;
+  infos[0].bytes_received = 1048576;
+  infos[1].request_id = "req-2";
+  infos[1].bytes_sent = 100;
+
+  Json::Value root;
+  Json::Reader reader;
+  ASSERT_TRUE(reader.parse(S3RequestRegistry::to_json(infos, 5), root));
+  EXPECT_EQ(5, root["count"].asUInt64());
+  const Json::Value &requests = root["requests"];
+  ASSERT_EQ(2, requests.size());
+
+  EXPECT_EQ("req-1", requests[0]["request_id"].asString());
+  EXPECT_EQ("PUT", requests[0]["method"].asString());
+  EXPECT_EQ("/bucket/key", requests[0]["uri"].asString());
+  EXPECT_EQ("PutObject", requests[0]["action"].asString());
+  EXPECT_EQ("S3PutObjectAction::write_object",
+            requests[0]["task"].asString());
+  EXPECT_EQ(7000, requests[0]["elapsed_ms"].asInt64());
+  EXPECT_EQ(1048576, requests[0]["bytes_received"].asUInt64());
+  EXPECT_EQ("write_object", requests[0]["async_op"].asString());
+  EXPECT_EQ(6500, requests[0]["async_op_elapsed_ms"].asInt64());
+  EXPECT_EQ(1, requests[0]["async_ops_in_flight"].asUInt());
+
+  EXPECT_EQ(100, requests[1]["bytes_sent"].asUInt64());
+  EXPECT_FALSE(requests[1].isMember("async_op"));
+}
+
+TEST_F(S3RequestRegistryTest, ToJsonEmpty) {
+  Json::Value root;
+  Json::Reader reader;
+  ASSERT_TRUE(reader.parse(S3RequestRegistry::to_json({}, 0), root));
+  EXPECT_EQ(0, root["count"].asUInt64());
+  EXPECT_TRUE(root["requests"].isArray());
+  EXPECT_EQ(0, root["requests"].size());
+}
+
+TEST_F(S3RequestRegistryTest, LogsSlowest) {
+  S3RequestRegistry logging_registry(nullptr, nullptr, 1, 0);
+  evhtp_request_t *req = NULL;
+  MockS3RequestObject request(req, new EvhtpWrapper());
+  logging_registry.add(&request);
+  logging_registry.action_callback();
+  logging_registry.remove(&request);
+  EXPECT_EQ(0, logging_registry.get_count());
+}
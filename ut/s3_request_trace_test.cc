@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <json/json.h>
+
+#include "s3_request_trace.h"
+
+TEST(S3RequestTraceTest, Disabled) {
+  S3RequestTrace trace(false);
+  EXPECT_FALSE(trace.is_enabled());
+  EXPECT_EQ(-1, trace.begin("step", S3TraceCategory::action));
+  trace.end(-1);
+  trace.responded();
+  EXPECT_EQ(0, trace.get_spans_count());
+  EXPECT_EQ(0, trace.get_response_time_us());
+}
+
+TEST(S3RequestTraceTest, Spans) {
+  S3RequestTrace trace(true);
+  ASSERT_TRUE(trace.is_enabled());
+  // Span 0 covers the whole request.
+  EXPECT_EQ(1, trace.get_spans_count());
+  EXPECT_STREQ("request", trace.get_span(0).name);
+
+  int step = trace.begin("step", S3TraceCategory::action);
+  int kvs = trace.begin("get_keyval", S3TraceCategory::kvs);
+  EXPECT_EQ(1, step);
+  EXPECT_EQ(2, kvs);
+  usleep(1000);
+  trace.end(kvs);
+  trace.end(step);
+  const int64_t kvs_end = trace.get_span(kvs).end_us;
+  trace.end(kvs);
+  EXPECT_EQ(kvs_end, trace.get_span(kvs).end_us);
+
+  EXPECT_LE(trace.get_span(step).begin_us, trace.get_span(kvs).begin_us);
+  EXPECT_LE(1000, kvs_end - trace.get_span(kvs).begin_us);
+  EXPECT_LE(kvs_end, trace.get_span(step).end_us);
+  EXPECT_EQ(S3TraceCategory::kvs, trace.get_span(kvs).category);
+
+  EXPECT_EQ(-1, trace.get_span(0).end_us);
+  trace.responded();
+  const int64_t response_time = trace.get_response_time_us();
+  EXPECT_LE(trace.get_span(step).end_us, response_time);
+  usleep(1000);
+  EXPECT_EQ(response_time, trace.get_response_time_us());
+}
+
+TEST(S3RequestTraceTest, Overflow) {
+  S3RequestTrace trace(true);
+  for (size_t i = 1; i < S3RequestTrace::max_spans; ++i) {
+    EXPECT_EQ((int)i, trace.begin("write", S3TraceCategory::io));
+  }
+  EXPECT_EQ(-1, trace.begin("write", S3TraceCategory::io));
+  EXPECT_EQ(-1, trace.begin("write", S3TraceCategory::io));
+  EXPECT_EQ(S3RequestTrace::max_spans, trace.get_spans_count());
+  EXPECT_EQ(2, trace.get_dropped_count());
+}
+
+TEST(S3RequestTraceTest, ChromeTrace) {
+  S3RequestTrace trace(true);
+  int step = trace.begin("S3PutObjectAction::create_object",
+                         S3TraceCategory::action);
+  trace.begin("write_to_motr_op", S3TraceCategory::io);
+  trace.end(step);
+
+  Json::Value root;
+  Json::Reader reader;
+  ASSERT_TRUE(reader.parse(trace.to_chrome_trace("req-1"), root));
+  EXPECT_EQ("req-1", root["otherData"]["request_id"].asString());
+  EXPECT_EQ(0, root["otherData"]["dropped_spans"].asUInt64());
+
+  const Json::Value& events = root["traceEvents"];
+  // 3 spans and a name for each of 5 categories.
+  ASSERT_EQ(8, events.size());
+
+  EXPECT_EQ("request", events[0]["name"].asString());
+  EXPECT_EQ("req-1", events[0]["args"]["request_id"].asString());
+  EXPECT_TRUE(events[0]["args"]["unfinished"].asBool());
+
+  EXPECT_EQ("S3PutObjectAction::create_object", events[1]["name"].asString());
+  EXPECT_EQ("action", events[1]["cat"].asString());
+  EXPECT_EQ("X", events[1]["ph"].asString());
+  EXPECT_EQ(trace.get_span(step).begin_us, events[1]["ts"].asInt64());
+  EXPECT_EQ(trace.get_span(step).end_us - trace.get_span(step).begin_us,
+            events[1]["dur"].asInt64());
+  EXPECT_FALSE(events[1].isMember("args"));
+  EXPECT_EQ(getpid(), events[1]["pid"].asInt());
+
+  EXPECT_EQ("io", events[2]["cat"].asString());
+  EXPECT_NE(events[1]["tid"], events[2]["tid"]);
+  EXPECT_TRUE(events[2]["args"]["unfinished"].asBool());
+
+  EXPECT_EQ("M", events[3]["ph"].asString());
+  EXPECT_EQ("thread_name", events[3]["name"].asString());
+  EXPECT_EQ("request", events[3]["args"]["name"].asString());
+}
+
+static std::string read_file(const std::string& file_name) {
+  std::ifstream file(file_name);
+  std::stringstream content;
+  content << file.rdbuf();
+  return content.str();
+}
+
+TEST(S3RequestTraceTest, Save) {
+  char dir_template[] = "/tmp/s3_request_trace_test.XXXXXX";
+  ASSERT_NE(nullptr, mkdtemp(dir_template));
+  const std::string dir = std::string(dir_template) + "/trace";
+
+  EXPECT_EQ(0, S3RequestTrace::save(dir, "req-1", "trace-1", 2));
+  EXPECT_EQ(0, S3RequestTrace::save(dir, "req-2", "trace-2", 2));
+  EXPECT_EQ("trace-1", read_file(dir + "/req-1.json"));
+  EXPECT_EQ(0, S3RequestTrace::save(dir, "req-3", "trace-3", 2));
+
+  // Oldest trace is removed.
+  EXPECT_NE(0, access((dir + "/req-1.json").c_str(), F_OK));
+  EXPECT_EQ("trace-2", read_file(dir + "/req-2.json"));
+  EXPECT_EQ("trace-3", read_file(dir + "/req-3.json"));
+
+  EXPECT_GT(0, S3RequestTrace::save(dir + "/missing/dir", "req-4", "t", 2));
+
+  unlink((dir + "/req-2.json").c_str());
+  unlink((dir + "/req-3.json").c_str());
+  rmdir(dir.c_str());
+  rmdir(dir_template);
+}
+
+TEST(S3RequestTraceTest, WriterSavesQueuedTraces) {
+  char dir_template[] = "/tmp/s3_request_trace_test.XXXXXX";
+  ASSERT_NE(nullptr, mkdtemp(dir_template));
+  const std::string dir = std::string(dir_template) + "/trace";
+
+  EXPECT_FALSE(S3RequestTrace::save_async(dir, "req-1", "trace-1", 2));
+
+  ASSERT_EQ(0, S3RequestTrace::start_writer());
+  EXPECT_GT(0, S3RequestTrace::start_writer());
+  EXPECT_TRUE(S3RequestTrace::save_async(dir, "req-1", "trace-1", 2));
+  EXPECT_TRUE(S3RequestTrace::save_async(dir, "req-2", "trace-2", 2));
+  // Queued traces are saved before the writer stops.
+  S3RequestTrace::stop_writer();
+  S3RequestTrace::stop_writer();
+
+  EXPECT_EQ("trace-1", read_file(dir + "/req-1.json"));
+  EXPECT_EQ("trace-2", read_file(dir + "/req-2.json"));
+  EXPECT_FALSE(S3RequestTrace::save_async(dir, "req-3", "trace-3", 2));
+
+  unlink((dir + "/req-1.json").c_str());
+  unlink((dir + "/req-2.json").c_str());
+  rmdir(dir.c_str());
+  rmdir(dir_template);
+}
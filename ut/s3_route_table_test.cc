@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "s3_route_table.h"
+
+static std::string to_upper(std::string name) {
+  std::transform(name.begin(), name.end(), name.begin(), ::toupper);
+  return name;
+}
+
+TEST(S3RouteTableTest, FindsEverySubResource) {
+  const S3RouteTable& route_table = S3RouteTable::get_instance();
+  for (const auto& sub_resource : S3OperationString) {
+    S3OperationCode operation_code = S3OperationCode::restore;
+    EXPECT_TRUE(
+        route_table.find_operation_code(sub_resource.first, operation_code))
+        << sub_resource.first;
+    EXPECT_EQ(sub_resource.second, operation_code);
+
+    operation_code = S3OperationCode::restore;
+    EXPECT_TRUE(route_table.find_operation_code(to_upper(sub_resource.first),
+                                                operation_code));
+    EXPECT_EQ(sub_resource.second, operation_code);
+  }
+}
+
+TEST(S3RouteTableTest, IgnoresOtherQueryParameters) {
+  const S3RouteTable& route_table = S3RouteTable::get_instance();
+  for (const char* name : {"prefix", "max-keys", "partNumber", "versionId",
+                           "", "acls", "ac", "uploadI", "delimiter"}) {
+    S3OperationCode operation_code = S3OperationCode::restore;
+    EXPECT_FALSE(route_table.find_operation_code(name, operation_code))
+        << name;
+    EXPECT_EQ(S3OperationCode::restore, operation_code);
+  }
+}
+
+TEST(S3RouteTableTest, GetOperationCode) {
+  const S3RouteTable& route_table = S3RouteTable::get_instance();
+  std::map<std::string, std::string, compare> query_params;
+  EXPECT_EQ(S3OperationCode::none,
+            route_table.get_operation_code(query_params));
+
+  query_params["prefix"] = "abc";
+  EXPECT_EQ(S3OperationCode::none,
+            route_table.get_operation_code(query_params));
+
+  query_params["partNumber"] = "1";
+  query_params["uploadId"] = "id";
+  EXPECT_EQ(S3OperationCode::multipart,
+            route_table.get_operation_code(query_params));
+
+  // The last sub-resource in the map order wins.
+  query_params["versioning"] = "";
+  EXPECT_EQ(S3OperationCode::versioning,
+            route_table.get_operation_code(query_params));
+}
+
+TEST(S3RouteTableTest, RoutePath) {
+  S3PathRoute route = S3RouteTable::route_path("/");
+  EXPECT_EQ(S3PathShape::root, route.shape);
+
+  route = S3RouteTable::route_path("/bucket");
+  EXPECT_EQ(S3PathShape::bucket, route.shape);
+  EXPECT_EQ("bucket", std::string(route.bucket, route.bucket_length));
+
+  route = S3RouteTable::route_path("/bucket/");
+  EXPECT_EQ(S3PathShape::bucket, route.shape);
+  EXPECT_EQ("bucket", std::string(route.bucket, route.bucket_length));
+
+  route = S3RouteTable::route_path("/bucket/dir/object");
+  EXPECT_EQ(S3PathShape::object, route.shape);
+  EXPECT_EQ("bucket", std::string(route.bucket, route.bucket_length));
+  EXPECT_STREQ("dir/object", route.object);
+
+  route = S3RouteTable::route_path("//");
+  EXPECT_EQ(S3PathShape::bucket, route.shape);
+  EXPECT_EQ(0, route.bucket_length);
+}
+
+// Routing as it was done before the table: map lookup of every query
+// parameter and copies of the path.
+static S3OperationCode route_with_map(
+    const std::map<std::string, std::string, compare>& query_params,
+    const std::string& path, std::string& bucket_name,
+    std::string& object_name) {
+  std::string full_uri(path);
+  if (full_uri.compare("/") != 0) {
+    std::size_t pos = full_uri.find("/", 1);
+    if (pos == std::string::npos) {
+      bucket_name = std::string(full_uri.c_str() + 1);
+    } else if (pos == full_uri.length() - 1) {
+      bucket_name = std::string(full_uri.c_str() + 1, full_uri.length() - 2);
+    } else {
+      bucket_name = std::string(full_uri.c_str() + 1, pos - 1);
+      object_name = std::string(full_uri.c_str() + pos + 1);
+    }
+  }
+  S3OperationCode operation_code = S3OperationCode::none;
+  for (const auto& it : query_params) {
+    auto op_code_it = S3OperationString.find(it.first);
+    if (op_code_it != S3OperationString.end()) {
+      operation_code = op_code_it->second;
+    }
+  }
+  return operation_code;
+}
+
+static S3OperationCode route_with_table(
+    const std::map<std::string, std::string, compare>& query_params,
+    const std::string& path, std::string& bucket_name,
+    std::string& object_name) {
+  const S3PathRoute route = S3RouteTable::route_path(path.c_str());
+  if (route.shape != S3PathShape::root) {
+    bucket_name.assign(route.bucket, route.bucket_length);
+    if (route.shape == S3PathShape::object) {
+      object_name = route.object;
+    }
+  }
+  return S3RouteTable::get_instance().get_operation_code(query_params);
+}
+
+// Every sub-resource (and none) on every path shape, with a typical
+// non sub-resource parameter, as S3 clients send them.
+static std::vector<std::map<std::string, std::string, compare>>
+matrix_queries() {
+  std::vector<std::map<std::string, std::string, compare>> queries(1);
+  for (const auto& sub_resource : S3OperationString) {
+    std::map<std::string, std::string, compare> query_params;
+    query_params[sub_resource.first] = "";
+    query_params["max-keys"] = "1000";
+    queries.push_back(query_params);
+  }
+  return queries;
+}
+
+static const std::vector<std::string> matrix_paths = {
+    "/", "/bucket", "/bucket/", "/bucket/object",
+    "/bucket/a/long/object/key/with/many/levels.dat"};
+
+TEST(S3RouteTableTest, RoutesAsMapLookup) {
+  for (const auto& query_params : matrix_queries()) {
+    for (const auto& path : matrix_paths) {
+      std::string map_bucket, map_object, table_bucket, table_object;
+      EXPECT_EQ(route_with_map(query_params, path, map_bucket, map_object),
+                route_with_table(query_params, path, table_bucket,
+                                 table_object));
+      EXPECT_EQ(map_bucket, table_bucket);
+      EXPECT_EQ(map_object, table_object);
+    }
+  }
+}
+
+// Prints the cost of routing the matrix both ways.  Disabled, run with
+// --gtest_also_run_disabled_tests.
+TEST(S3RouteTableBenchmark, DISABLED_OperationMatrix) {
+  const auto queries = matrix_queries();
+  const std::vector<std::string>& paths = matrix_paths;
+  const size_t n_rounds = 2000;
+  const size_t n_routes = n_rounds * queries.size() * paths.size();
+  auto measure = [&](S3OperationCode (*route)(
+      const std::map<std::string, std::string, compare>&, const std::string&,
+      std::string&, std::string&)) {
+    size_t checksum = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t round = 0; round < n_rounds; ++round) {
+      for (const auto& query_params : queries) {
+        for (const auto& path : paths) {
+          std::string bucket_name, object_name;
+          checksum += (size_t)route(query_params, path, bucket_name,
+                                    object_name) + bucket_name.length();
+        }
+      }
+    }
+    const std::chrono::duration<double, std::nano> elapsed =
+        std::chrono::steady_clock::now() - start;
+    EXPECT_NE(0, checksum);
+    return elapsed.count() / n_routes;
+  };
+  const double map_ns = measure(route_with_map);
+  const double table_ns = measure(route_with_table);
+  printf("Routing of %zu operations: map %.1f ns, table %.1f ns per request\n",
+         queries.size() * paths.size(), map_ns, table_ns);
+}
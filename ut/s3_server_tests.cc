@@ -32,7 +32,6 @@ extern "C" {
 
 #include "motr_helpers.h"
 #include "s3_motr_layout.h"
-#include "s3_error_messages.h"
 #include "s3_log.h"
 #include "s3_mem_pool_manager.h"
 #include "s3_option.h"
@@ -47,6 +46,7 @@ extern int s3log_level;
 struct m0_uint128 global_bucket_list_index_oid;
 struct m0_uint128 bucket_metadata_list_index_oid;
 struct m0_uint128 global_probable_dead_object_list_index_oid;
+struct m0_uint128 bucket_usage_index_oid;
 struct m0_uint128 global_instance_id;
 S3Option *g_option_instance = NULL;
 evhtp_ssl_ctx_t *g_ssl_auth_ctx;
@@ -197,8 +197,6 @@ int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
   ::testing::InitGoogleMock(&argc, argv);
 
-  S3ErrorMessages::init_messages("resources/s3_error_messages.json");
-
   // Motr Initialization
   rc = motr_ut_init();
   if (rc != 0) {
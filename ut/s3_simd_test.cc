@@ -0,0 +1,221 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <libxml/parser.h>
+
+#include "base64.h"
+#include "s3_simd.h"
+#include "s3_url_encode.h"
+#include "s3_xml_writer.h"
+
+static const S3SimdLevel all_levels[] = {
+    S3SimdLevel::scalar, S3SimdLevel::sse42, S3SimdLevel::avx2};
+
+static const char* get_level_name(S3SimdLevel level) {
+  switch (level) {
+    case S3SimdLevel::scalar:
+      return "scalar";
+    case S3SimdLevel::sse42:
+      return "sse4.2";
+    case S3SimdLevel::avx2:
+      return "avx2";
+  }
+  return "unknown";
+}
+
+// Lengths around block sizes, and long strings.
+static std::vector<size_t> get_lengths() {
+  std::vector<size_t> lengths;
+  for (size_t length = 0; length <= 100; ++length) {
+    lengths.push_back(length);
+  }
+  lengths.push_back(255);
+  lengths.push_back(1024);
+  return lengths;
+}
+
+// Random string of characters from 'alphabet', mostly the first 'common'.
+static std::string random_string(std::mt19937& random, size_t length,
+                                 const std::string& alphabet, size_t common) {
+  std::string result;
+  for (size_t i = 0; i < length; ++i) {
+    const bool rare = random() % 8 == 0;
+    result += alphabet[rare ? random() % alphabet.length()
+                            : random() % common];
+  }
+  return result;
+}
+
+class S3SimdTest : public testing::Test {
+ protected:
+  std::mt19937 random;
+
+  ~S3SimdTest() { s3_simd_set_level(s3_simd_detect_level()); }
+};
+
+TEST_F(S3SimdTest, SetLevel) {
+  EXPECT_EQ(s3_simd_detect_level(), s3_simd_level());
+  EXPECT_EQ(S3SimdLevel::scalar, s3_simd_set_level(S3SimdLevel::scalar));
+  EXPECT_EQ(S3SimdLevel::scalar, s3_simd_level());
+  EXPECT_EQ(s3_simd_detect_level(), s3_simd_set_level(S3SimdLevel::avx2));
+}
+
+TEST_F(S3SimdTest, UrlEncodeSameOnAllLevels) {
+  std::string alphabet = "abcXYZ019-._~!$'()*|";
+  for (int c = 1; c < 256; ++c) {
+    alphabet += (char)c;
+  }
+  for (size_t length : get_lengths()) {
+    for (int round = 0; round < 20; ++round) {
+      const std::string key = random_string(random, length, alphabet, 20);
+      s3_simd_set_level(S3SimdLevel::scalar);
+      const std::string expected = url_encode(key.c_str());
+      for (S3SimdLevel level : all_levels) {
+        s3_simd_set_level(level);
+        ASSERT_EQ(expected, url_encode(key.c_str()))
+            << get_level_name(level) << " " << key;
+      }
+    }
+  }
+}
+
+// Same as libxml xmlEncodeSpecialChars(), which was used before.
+TEST_F(S3SimdTest, XmlEscapeSameOnAllLevels) {
+  const std::string alphabet("abcdefgh/<>&\"\r\n'\0\xc3\xa9", 20);
+  for (size_t length : get_lengths()) {
+    for (int round = 0; round < 20; ++round) {
+      const std::string value = random_string(random, length, alphabet, 9);
+      std::string expected;
+      xmlChar* encoded = xmlEncodeSpecialChars(NULL, BAD_CAST value.c_str());
+      ASSERT_NE(nullptr, encoded);
+      expected = reinterpret_cast<char*>(encoded);
+      xmlFree(encoded);
+      for (S3SimdLevel level : all_levels) {
+        s3_simd_set_level(level);
+        std::string escaped;
+        S3XmlWriter::escape(value, escaped);
+        ASSERT_EQ(expected, escaped) << get_level_name(level);
+      }
+    }
+  }
+}
+
+TEST_F(S3SimdTest, Base64SameOnAllLevels) {
+  for (size_t length : get_lengths()) {
+    for (int round = 0; round < 20; ++round) {
+      std::string bytes;
+      for (size_t i = 0; i < length; ++i) {
+        bytes += (char)random();
+      }
+      s3_simd_set_level(S3SimdLevel::scalar);
+      const std::string encoded =
+          base64_encode((const unsigned char*)bytes.data(), bytes.length());
+      // Decoding stops at, or skips, characters which are not base64.
+      std::string damaged = encoded;
+      if (!damaged.empty()) {
+        damaged[random() % damaged.length()] = "= \n*\x80"[random() % 5];
+      }
+      const std::string decoded_damaged = base64_decode(damaged);
+
+      for (S3SimdLevel level : all_levels) {
+        s3_simd_set_level(level);
+        ASSERT_EQ(encoded, base64_encode((const unsigned char*)bytes.data(),
+                                         bytes.length()))
+            << get_level_name(level);
+        ASSERT_EQ(bytes, base64_decode(encoded)) << get_level_name(level);
+        ASSERT_EQ(decoded_damaged, base64_decode(damaged))
+            << get_level_name(level) << " " << damaged;
+      }
+    }
+  }
+}
+
+// Per key costs in listings and per request costs in auth and metadata:
+// object keys of typical lengths, in batches of a listing page.  Disabled,
+// run with --gtest_also_run_disabled_tests.
+TEST_F(S3SimdTest, DISABLED_Benchmark) {
+  const size_t n_keys = 1000;
+  const size_t n_rounds = 10;
+  const std::string alphabet = "abcdefghijklmnopqrstuvwxyz0123456789-_./ &";
+  unsigned char oid[16];
+  for (unsigned char& byte : oid) {
+    byte = (unsigned char)random();
+  }
+  const std::string oid_base64 = base64_encode(oid, sizeof(oid));
+
+  for (size_t key_length : {16, 48, 128, 512}) {
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < n_keys; ++i) {
+      // Mostly letters and digits, '/' every 12 characters or so.
+      keys.push_back(random_string(random, key_length, alphabet, 36));
+      for (size_t pos = 12; pos < key_length; pos += 12) {
+        keys.back()[pos] = '/';
+      }
+    }
+    for (S3SimdLevel level : all_levels) {
+      if (s3_simd_set_level(level) != level) {
+        continue;
+      }
+      size_t checksum = 0;
+      auto measure = [&](std::function<size_t(const std::string&)> kernel) {
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t round = 0; round < n_rounds; ++round) {
+          for (const auto& key : keys) {
+            checksum += kernel(key);
+          }
+        }
+        const std::chrono::duration<double, std::nano> elapsed =
+            std::chrono::steady_clock::now() - start;
+        return elapsed.count() / (n_rounds * n_keys);
+      };
+      const double url_ns = measure([](const std::string& key) {
+        return url_encode(key.c_str()).length();
+      });
+      const double xml_ns = measure([](const std::string& key) {
+        std::string xml;
+        S3XmlWriter::escape(key, xml);
+        return xml.length();
+      });
+      const double encode_ns = measure([](const std::string& key) {
+        return base64_encode((const unsigned char*)key.data(), key.length())
+            .length();
+      });
+      const double oid_ns = measure([&](const std::string&) {
+        return base64_decode(oid_base64).length();
+      });
+      EXPECT_NE(0, checksum);
+      printf(
+          "%-6s key %3zu bytes: url_encode %.1f ns, xml escape %.1f ns, "
+          "base64 encode %.1f ns, oid base64 decode %.1f ns per key\n",
+          get_level_name(level), key_length, url_ns, xml_ns, encode_ns,
+          oid_ns);
+    }
+  }
+}
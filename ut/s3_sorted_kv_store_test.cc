@@ -0,0 +1,221 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "s3_sorted_kv_store.h"
+
+typedef std::vector<std::pair<std::string, std::string>> KeyValues;
+
+TEST(S3SortedKvStoreTest, Empty) {
+  S3SortedKvStore store;
+  std::string value;
+  KeyValues result;
+  EXPECT_FALSE(store.get("", value));
+  EXPECT_FALSE(store.get("a", value));
+  EXPECT_FALSE(store.del("a"));
+  EXPECT_EQ(0, store.next("", false, 10, result));
+  EXPECT_EQ(0, store.size());
+}
+
+TEST(S3SortedKvStoreTest, PutGetDel) {
+  S3SortedKvStore store;
+  std::string value;
+  EXPECT_TRUE(store.put("object/b", "2"));
+  EXPECT_TRUE(store.put("object/a", "1"));
+  EXPECT_TRUE(store.put("", "empty"));
+  EXPECT_EQ(3, store.size());
+  EXPECT_TRUE(store.get("object/a", value));
+  EXPECT_EQ("1", value);
+  EXPECT_TRUE(store.get("", value));
+  EXPECT_EQ("empty", value);
+  EXPECT_FALSE(store.get("object/", value));
+  EXPECT_FALSE(store.get("object/aa", value));
+
+  // Shorter and longer values.
+  EXPECT_FALSE(store.put("object/a", ""));
+  EXPECT_TRUE(store.get("object/a", value));
+  EXPECT_EQ("", value);
+  EXPECT_FALSE(store.put("object/a", std::string(1000, 'v')));
+  EXPECT_TRUE(store.get("object/a", value));
+  EXPECT_EQ(std::string(1000, 'v'), value);
+  EXPECT_EQ(3, store.size());
+
+  // Binary keys and values.
+  const std::string binary("k\0\xff", 3);
+  EXPECT_TRUE(store.put(binary, binary));
+  EXPECT_TRUE(store.get(binary, value));
+  EXPECT_EQ(binary, value);
+  EXPECT_FALSE(store.get("k", value));
+
+  EXPECT_TRUE(store.del("object/a"));
+  EXPECT_FALSE(store.del("object/a"));
+  EXPECT_FALSE(store.get("object/a", value));
+  EXPECT_EQ(3, store.size());
+}
+
+TEST(S3SortedKvStoreTest, Next) {
+  S3SortedKvStore store(4);
+  for (int i = 0; i < 20; i += 2) {
+    char key[16];
+    snprintf(key, sizeof(key), "key%02d", i);
+    store.put(key, std::to_string(i));
+  }
+  ASSERT_GT(store.get_leaf_count(), 1);
+
+  KeyValues result;
+  EXPECT_EQ(3, store.next("", true, 3, result));
+  EXPECT_EQ(KeyValues({{"key00", "0"}, {"key02", "2"}, {"key04", "4"}}),
+            result);
+
+  // Start key is included unless excluded.
+  result.clear();
+  EXPECT_EQ(2, store.next("key04", false, 2, result));
+  EXPECT_EQ(KeyValues({{"key04", "4"}, {"key06", "6"}}), result);
+  result.clear();
+  EXPECT_EQ(2, store.next("key04", true, 2, result));
+  EXPECT_EQ(KeyValues({{"key06", "6"}, {"key08", "8"}}), result);
+
+  // Missing start key, and prefix as start key.
+  result.clear();
+  EXPECT_EQ(1, store.next("key05", true, 1, result));
+  EXPECT_EQ(KeyValues({{"key06", "6"}}), result);
+  result.clear();
+  EXPECT_EQ(5, store.next("key1", true, 100, result));
+  EXPECT_EQ("key10", result.front().first);
+  EXPECT_EQ("key18", result.back().first);
+
+  result.clear();
+  EXPECT_EQ(0, store.next("key18", true, 100, result));
+  EXPECT_EQ(0, store.next("key99", false, 100, result));
+}
+
+// Random operations compared with std::map, small leaves split and empty
+// ones are removed often.
+TEST(S3SortedKvStoreTest, MatchesStdMap) {
+  for (size_t max_leaf_entries : {2, 3, 8, 128}) {
+    S3SortedKvStore store(max_leaf_entries);
+    std::map<std::string, std::string> expected;
+    std::mt19937 random(max_leaf_entries);
+    auto random_key = [&random]() {
+      static const char *prefixes[] = {"", "a", "ab", "abc/", "abd/x", "b"};
+      return prefixes[random() % 6] + std::to_string(random() % 300);
+    };
+
+    for (int op = 0; op < 20000; ++op) {
+      const std::string key = random_key();
+      std::string value;
+      switch (random() % 4) {
+        case 0:
+        case 1:
+          value = std::string(random() % 20, 'a' + random() % 26);
+          EXPECT_EQ(expected.count(key) == 0, store.put(key, value));
+          expected[key] = value;
+          break;
+        case 2:
+          EXPECT_EQ(expected.erase(key) == 1, store.del(key));
+          break;
+        case 3: {
+          const bool exclude = random() % 2;
+          KeyValues result;
+          store.next(key, exclude, 5, result);
+          auto it = exclude ? expected.upper_bound(key)
+                            : expected.lower_bound(key);
+          KeyValues expected_result;
+          for (; it != expected.end() && expected_result.size() < 5; ++it) {
+            expected_result.push_back(*it);
+          }
+          ASSERT_EQ(expected_result, result) << key;
+          break;
+        }
+      }
+      ASSERT_EQ(expected.size(), store.size());
+    }
+
+    KeyValues all;
+    store.next("", false, expected.size() + 1, all);
+    EXPECT_EQ(KeyValues(expected.begin(), expected.end()), all);
+    for (const auto &key_value : expected) {
+      std::string value;
+      EXPECT_TRUE(store.get(key_value.first, value));
+      EXPECT_EQ(key_value.second, value);
+    }
+  }
+}
+
+TEST(S3SortedKvStoreTest, PrefixCompression) {
+  S3SortedKvStore store;
+  const std::string prefix = "bucket-with-a-long-name/photos/2020/";
+  size_t raw_size = 0;
+  for (int i = 0; i < 100000; ++i) {
+    const std::string key = prefix + std::to_string(i);
+    store.put(key, "v");
+    raw_size += key.size() + 1;
+  }
+  // The prefix is stored once per leaf.
+  EXPECT_LT(store.get_memory_usage(), raw_size * 2 / 3);
+}
+
+// Prints the cost of puts and listing pages of a large store.  Disabled, run
+// with --gtest_also_run_disabled_tests.
+TEST(S3SortedKvStoreTest, DISABLED_Benchmark) {
+  const size_t n_keys = 1000000;
+  const size_t page_size = 1000;
+  char key[64];
+  S3SortedKvStore store;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < n_keys; ++i) {
+    // Shuffled, like object names of concurrent uploads.
+    const size_t n = (i * 7919) % n_keys;
+    snprintf(key, sizeof(key), "dir%03zu/object-%08zu", n % 100, n);
+    store.put(key, "{\"Object-Size\":\"4096\"}");
+  }
+  const double put_ns = std::chrono::duration<double, std::nano>(
+                            std::chrono::steady_clock::now() - start).count();
+
+  start = std::chrono::steady_clock::now();
+  size_t listed = 0;
+  std::string last_key;
+  KeyValues page;
+  while (true) {
+    page.clear();
+    if (store.next(last_key, true, page_size, page) == 0) {
+      break;
+    }
+    listed += page.size();
+    last_key = page.back().first;
+  }
+  const double list_ns = std::chrono::duration<double, std::nano>(
+                             std::chrono::steady_clock::now() - start).count();
+  EXPECT_EQ(n_keys, listed);
+  printf(
+      "S3SortedKvStore: %.0f ns per put, %.0f ns per listed key, "
+      "%.1f bytes per key\n",
+      put_ns / n_keys, list_ns / n_keys,
+      (double)store.get_memory_usage() / n_keys);
+}
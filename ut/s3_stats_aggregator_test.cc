@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "s3_stats_aggregator.h"
+
+class S3StatsAggregatorTest : public testing::Test {
+ protected:
+  void create(size_t max_packet_size = 1432) {
+    aggregator.reset(new S3StatsAggregator(
+        {"request_count", "request_time", "queue_length"}, max_packet_size));
+  }
+
+  size_t flush() {
+    packets.clear();
+    return aggregator->flush(
+        [this](const std::string& packet) { packets.push_back(packet); });
+  }
+
+  std::unique_ptr<S3StatsAggregator> aggregator;
+  std::vector<std::string> packets;
+};
+
+TEST_F(S3StatsAggregatorTest, TimingBucket) {
+  EXPECT_EQ(0, S3StatsAggregator::timing_bucket(0));
+  EXPECT_EQ(1, S3StatsAggregator::timing_bucket(1));
+  EXPECT_EQ(2, S3StatsAggregator::timing_bucket(2));
+  EXPECT_EQ(2, S3StatsAggregator::timing_bucket(3));
+  EXPECT_EQ(3, S3StatsAggregator::timing_bucket(4));
+  EXPECT_EQ(11, S3StatsAggregator::timing_bucket(1024));
+  EXPECT_EQ(S3_STATS_TIMING_BUCKETS - 1,
+            S3StatsAggregator::timing_bucket((size_t)-2));
+}
+
+TEST_F(S3StatsAggregatorTest, UnknownKeyIsDropped) {
+  create();
+  EXPECT_FALSE(aggregator->count("xyz", 1));
+  EXPECT_FALSE(aggregator->timing("xyz", 1));
+  EXPECT_FALSE(aggregator->set_gauge("xyz", 1));
+  EXPECT_EQ(0, flush());
+}
+
+TEST_F(S3StatsAggregatorTest, AggregatesIntoOnePacket) {
+  create();
+  EXPECT_TRUE(aggregator->count("request_count", 1));
+  EXPECT_TRUE(aggregator->count("request_count", 2));
+  // Sampled event stands for 1 / sample_rate events.
+  EXPECT_TRUE(aggregator->count("request_count", 1, 0.5));
+  EXPECT_TRUE(aggregator->timing("request_time", 4));
+  EXPECT_TRUE(aggregator->timing("request_time", 6));
+  EXPECT_TRUE(aggregator->timing("request_time", 100));
+  EXPECT_TRUE(aggregator->update_gauge("queue_length", 5));
+  EXPECT_TRUE(aggregator->update_gauge("queue_length", -7));
+
+  EXPECT_EQ(1, flush());
+  EXPECT_EQ(
+      "queue_length:-2|g\n"
+      "request_count:5|c\n"
+      "request_time:5|ms|@0.500000000\n"
+      "request_time:100|ms",
+      packets[0]);
+
+  // Everything was reset.
+  EXPECT_EQ(0, flush());
+}
+
+TEST_F(S3StatsAggregatorTest, SetGaugeOverridesUpdates) {
+  create();
+  EXPECT_TRUE(aggregator->update_gauge("queue_length", 5));
+  EXPECT_TRUE(aggregator->set_gauge("queue_length", 3));
+  EXPECT_TRUE(aggregator->update_gauge("queue_length", 1));
+
+  EXPECT_EQ(1, flush());
+  EXPECT_EQ("queue_length:3|g\nqueue_length:+1|g", packets[0]);
+}
+
+TEST_F(S3StatsAggregatorTest, SplitsPacketsAtMaxSize) {
+  create(40);
+  EXPECT_TRUE(aggregator->count("request_count", 1));
+  EXPECT_TRUE(aggregator->set_gauge("queue_length", 1));
+  EXPECT_TRUE(aggregator->timing("request_time", 1));
+
+  EXPECT_EQ(2, flush());
+  EXPECT_EQ("queue_length:1|g\nrequest_count:1|c", packets[0]);
+  EXPECT_EQ("request_time:1|ms", packets[1]);
+}
+
+TEST_F(S3StatsAggregatorTest, AggregatesAcrossThreads) {
+  const int threads_count = 4;
+  const int events_count = 10000;
+  create();
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < threads_count; ++t) {
+    threads.emplace_back([this]() {
+      for (int i = 0; i < events_count; ++i) {
+        aggregator->count("request_count", 1);
+      }
+    });
+  }
+  // Concurrent flushes must not lose events.
+  std::vector<std::string> all_packets;
+  for (int i = 0; i < 10; ++i) {
+    flush();
+    all_packets.insert(all_packets.end(), packets.begin(), packets.end());
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  flush();
+  all_packets.insert(all_packets.end(), packets.begin(), packets.end());
+
+  long total = 0;
+  for (auto& packet : all_packets) {
+    total += std::stol(packet.substr(packet.find(':') + 1));
+  }
+  EXPECT_EQ(threads_count * events_count, total);
+}
@@ -281,3 +281,39 @@ TEST_F(S3StatsTest, S3StatsCountUniqueCallMustNotFailForValidSocketCalls) {
   // again calls send.
   EXPECT_NE(s3_stats_under_test->count_unique("internal_error_count", "1"), -1);
 }
+
+/* Unit test that verifies that aggregated metrics are sent in a single packet
+ * on flush and not on every metric event.*/
+TEST_F(S3StatsTest, AggregatedMetricsAreSentOnFlush) {
+  std::string packet;
+  s3_stats_under_test->aggregator.reset(
+      new S3StatsAggregator(s3_stats_under_test->metrics_allowlist, 1432));
+
+  // Only the flush below sends.
+  EXPECT_CALL(*mock_socket, sendto(_, _, _, _, _, _))
+      .WillOnce(::testing::Invoke([&packet](int, const void* buf, size_t len,
+                                            int, const struct sockaddr*,
+                                            socklen_t) {
+        packet.assign((const char*)buf, len);
+        return (ssize_t)len;
+      }));
+
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_EQ(0, s3_stats_under_test->count("internal_error_count", 1));
+    EXPECT_EQ(0, s3_stats_under_test->timing("total_request_time", 5));
+  }
+  EXPECT_EQ(0, s3_stats_under_test->set_gauge("get_service_request_count", 7));
+  // Not in the allowlist
+  EXPECT_EQ(0, s3_stats_under_test->count("xyz", 1));
+  EXPECT_TRUE(packet.empty());
+
+  EXPECT_EQ(0, s3_stats_under_test->flush());
+  EXPECT_EQ(
+      "get_service_request_count:7|g\n"
+      "internal_error_count:10|c\n"
+      "total_request_time:5|ms|@0.100000000",
+      packet);
+
+  // Nothing new to send.
+  EXPECT_EQ(0, s3_stats_under_test->flush());
+}
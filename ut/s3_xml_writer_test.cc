@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2020 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "s3_common_utilities.h"
+#include "s3_xml_writer.h"
+
+TEST(S3XmlWriterTest, Element) {
+  std::string xml;
+  S3XmlWriter writer(xml);
+  writer.raw("<?xml?>");
+  writer.open("Contents");
+  writer.element("Key", "a<b>&\"c\"\r\n");
+  writer.element("ETag", "abcd", true);
+  writer.element("Empty", "");
+  writer.element("EmptyQuoted", "", true);
+  writer.close("Contents");
+  EXPECT_EQ(
+      "<?xml?><Contents><Key>a&lt;b&gt;&amp;&quot;c&quot;&#13;\n</Key>"
+      "<ETag>\"abcd\"</ETag><Empty/><EmptyQuoted/></Contents>",
+      xml);
+}
+
+TEST(S3XmlWriterTest, EscapeStopsAtNul) {
+  std::string escaped;
+  S3XmlWriter::escape(std::string("a&b\0<c", 6), escaped);
+  EXPECT_EQ("a&amp;b", escaped);
+
+  std::string xml;
+  S3XmlWriter(xml).element("Key", std::string("\0a", 2));
+  EXPECT_EQ("<Key/>", xml);
+}
+
+// Output must not differ from format_xml_string(), so listings do not change.
+TEST(S3XmlWriterTest, SameAsFormatXmlString) {
+  const std::string values[] = {
+      "",        "key",        "dir/file.txt",
+      "a & b",   "<tag>",      "\"quoted\"",
+      "'apos'",  "&amp;",      "line1\r\nline2\ttab",
+      "\xc3\xa9t\xc3\xa9 \xe2\x82\xac", "trailing<"};
+  for (const auto& value : values) {
+    for (bool quotes : {false, true}) {
+      std::string xml;
+      S3XmlWriter(xml).element("Key", value, quotes);
+      EXPECT_EQ(S3CommonUtilities::format_xml_string("Key", value, quotes),
+                xml);
+    }
+  }
+}
@@ -23,7 +23,6 @@
 
 #include "motr_helpers.h"
 #include "s3_motr_layout.h"
-#include "s3_error_messages.h"
 #include "s3_log.h"
 #include "s3_mem_pool_manager.h"
 #include "s3_option.h"
@@ -39,6 +38,7 @@ extern int s3log_level;
 struct m0_uint128 global_bucket_list_index_oid;
 struct m0_uint128 bucket_metadata_list_index_oid;
 struct m0_uint128 global_probable_dead_object_list_index_oid;
+struct m0_uint128 bucket_usage_index_oid;
 struct m0_uint128 global_instance_id;
 pthread_t global_tid_indexop;
 pthread_t global_tid_objop;
@@ -80,8 +80,6 @@ int main(int argc, char **argv) {
     return -1;
   }
 
-  S3ErrorMessages::init_messages("resources/s3_error_messages.json");
-
   size_t libevent_pool_buffer_size =
       g_option_instance->get_libevent_pool_buffer_size();
 